@@ -1,10 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace rvrse::common
 {
+    // Fits any FormatSize() result ("16777216.0 TB") plus the terminator.
+    constexpr std::size_t kFormatSizeCapacity = 16;
+
     // Formats a byte count into a short human-readable string (e.g., "12.3 MB").
     std::wstring FormatSize(std::uint64_t bytes);
+
+    // Same text, written null-terminated into buffer without allocating, for
+    // per-row formatting on refresh paths. The view points into buffer.
+    std::wstring_view FormatSize(std::uint64_t bytes, wchar_t (&buffer)[kFormatSizeCapacity]);
 }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace rvrse::common
+{
+    struct LogWriterOptions
+    {
+        std::wstring path;
+
+        // Lines that can be queued before Write() starts dropping; rounded up
+        // to a power of two.
+        std::size_t queueCapacity = 8192;
+
+        // Rotate once the file would exceed this size (0 disables rotation).
+        // Rotated files are named <path>.1 (newest) ... <path>.<maxRotatedFiles>.
+        std::uint64_t maxFileBytes = 8ULL * 1024ULL * 1024ULL;
+        unsigned int maxRotatedFiles = 3;
+
+        // Idle data is flushed to the OS at least this often.
+        std::chrono::milliseconds flushInterval{250};
+    };
+
+    // Asynchronous UTF-8 line writer. Any number of threads call Write(); a
+    // bounded lock-free MPSC queue hands lines to a single writer thread that
+    // batches them into large fwrite calls. Write() never blocks: when the
+    // queue is full the line is dropped and counted instead.
+    class LogWriter
+    {
+    public:
+        LogWriter();
+        ~LogWriter();
+
+        LogWriter(const LogWriter &) = delete;
+        LogWriter &operator=(const LogWriter &) = delete;
+
+        bool Open(LogWriterOptions options);
+
+        // Drains every queued line, flushes and stops the writer thread.
+        void Close();
+        bool IsOpen() const { return running_.load(std::memory_order_acquire); }
+
+        // A newline is appended to each line. Wide input is converted to UTF-8.
+        bool Write(std::string_view line);
+        bool Write(std::wstring_view line);
+
+        // Blocks until every line written before the call has reached the file.
+        void Flush();
+
+        std::uint64_t LinesWritten() const { return linesWritten_.load(std::memory_order_relaxed); }
+        std::uint64_t LinesDropped() const { return linesDropped_.load(std::memory_order_relaxed); }
+        std::uint64_t BytesWritten() const { return bytesWritten_.load(std::memory_order_relaxed); }
+        std::uint64_t Rotations() const { return rotations_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Cell;
+
+        template <typename Fill>
+        bool Enqueue(Fill &&fill);
+
+        void WriterLoop();
+        bool DrainQueue();
+        bool HasReadyLine() const;
+        void WriteBatch();
+        bool OpenFile();
+        void RotateFile();
+
+        LogWriterOptions options_;
+        std::unique_ptr<Cell[]> cells_;
+        std::size_t mask_ = 0;
+
+        alignas(64) std::atomic<std::uint64_t> enqueuePosition_{0};
+        alignas(64) std::atomic<std::uint64_t> dequeuePosition_{0};
+        alignas(64) std::atomic<bool> writerSleeping_{false};
+
+        std::atomic<bool> running_{false};
+        // Producers inside Enqueue(); Close() waits for them before it frees
+        // cells_.
+        std::atomic<std::uint32_t> producers_{0};
+        std::atomic<std::uint64_t> linesWritten_{0};
+        std::atomic<std::uint64_t> linesDropped_{0};
+        std::atomic<std::uint64_t> bytesWritten_{0};
+        std::atomic<std::uint64_t> rotations_{0};
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable flushed_;
+        std::uint64_t flushTarget_ = 0;
+        std::uint64_t flushedThrough_ = 0;
+        bool stopping_ = false;
+        bool writerExited_ = false;
+
+        // Writer-thread state.
+        std::thread writer_;
+        std::FILE *file_ = nullptr;
+        std::uint64_t fileBytes_ = 0;
+        std::string batch_;
+        std::uint64_t batchLines_ = 0;
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -14,7 +15,24 @@ namespace rvrse::common
     // Normalizes Windows paths (backslashes, collapsed separators, uppercase drive letter).
     std::wstring NormalizePath(std::wstring_view input);
 
-    // UTF-8 <-> UTF-16 conversions backed by Win32 helpers.
+    // UTF-8 <-> UTF-16 conversions (UTF-32 where wchar_t is 32 bits, as on
+    // Linux). Invalid input (overlong or truncated sequences, encoded or
+    // unpaired surrogates, code points past U+10FFFF) yields an empty string.
     std::wstring Utf8ToWide(std::string_view input);
     std::string WideToUtf8(std::wstring_view input);
+
+    // The same validation without converting, for text kept as UTF-8.
+    bool IsValidUtf8(std::string_view input);
+
+    // Output bounds for the conversions into caller buffers: a UTF-8 byte
+    // never becomes more than one wchar_t, and a wchar_t never more than
+    // this many UTF-8 bytes.
+    constexpr std::size_t kMaxUtf8BytesPerWideChar = sizeof(wchar_t) == 2 ? 3 : 4;
+
+    // Same validation, converting into output without allocating. ASCII
+    // runs are converted 16 (SSE2) or 32 (AVX2 builds) bytes at a time.
+    // Returns false on invalid input or when capacity runs out; written is
+    // the number of units stored either way.
+    bool Utf8ToWide(std::string_view input, wchar_t *output, std::size_t capacity, std::size_t &written);
+    bool WideToUtf8(std::wstring_view input, char *output, std::size_t capacity, std::size_t &written);
 }
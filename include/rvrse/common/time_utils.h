@@ -1,13 +1,24 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace rvrse::common
 {
+    // Fit any FormatDuration()/FormatTimestamp() result plus the terminator.
+    constexpr std::size_t kFormatDurationCapacity = 32;
+    constexpr std::size_t kFormatTimestampCapacity = 32;
+
     // Formats durations as HH:MM:SS.mmm (with optional leading minus).
     std::wstring FormatDuration(std::chrono::milliseconds duration);
 
     // Formats a UTC timestamp as YYYY-MM-DD HH:MM:SS.
     std::wstring FormatTimestamp(std::chrono::system_clock::time_point timePoint);
+
+    // Same text as above, written null-terminated into buffer without
+    // allocating. The view points into buffer.
+    std::wstring_view FormatDuration(std::chrono::milliseconds duration, wchar_t (&buffer)[kFormatDurationCapacity]);
+    std::wstring_view FormatTimestamp(std::chrono::system_clock::time_point timePoint, wchar_t (&buffer)[kFormatTimestampCapacity]);
 }
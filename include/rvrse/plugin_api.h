@@ -10,7 +10,7 @@
 #endif
 
 #define RVRSE_PLUGIN_API_VERSION_MAJOR 1U
-#define RVRSE_PLUGIN_API_VERSION_MINOR 0U
+#define RVRSE_PLUGIN_API_VERSION_MINOR 4U
 
 #ifdef __cplusplus
 extern "C" {
@@ -58,10 +58,56 @@ typedef struct RvrseHandleInfo
     std::uint32_t grantedAccess;
 } RvrseHandleInfo;
 
+// Values for RvrseConnectionInfo::protocol and ::addressFamily.
+#define RVRSE_TRANSPORT_TCP 0U
+#define RVRSE_TRANSPORT_UDP 1U
+#define RVRSE_ADDRESS_FAMILY_IPV4 0U
+#define RVRSE_ADDRESS_FAMILY_IPV6 1U
+
+// Addresses and ports follow the core conventions: IPv4 addresses in
+// network byte order, ports in host byte order. Only the address fields of
+// addressFamily are set; the others are zero.
+typedef struct RvrseConnectionInfo
+{
+    std::uint32_t protocol;
+    std::uint32_t addressFamily;
+    std::uint32_t localAddress;
+    std::uint32_t remoteAddress;
+    std::uint8_t localAddress6[16];
+    std::uint8_t remoteAddress6[16];
+    std::uint16_t localPort;
+    std::uint16_t remotePort;
+    std::uint32_t owningProcessId;
+    std::uint8_t state;
+} RvrseConnectionInfo;
+
+// Values for RvrseNetworkSnapshotView::flags.
+#define RVRSE_NETWORK_ACCESS_DENIED 0x1U
+#define RVRSE_NETWORK_CAPTURE_FAILED 0x2U
+
+// System-wide figures computed once per refresh by the host.
+typedef struct RvrseSystemMetrics
+{
+    double cpuUsagePercent;
+    double memoryUsagePercent;
+    std::uint64_t physicalMemoryTotalBytes;
+    std::uint64_t physicalMemoryAvailableBytes;
+    std::uint64_t uptimeMilliseconds;
+    std::uint64_t processCount;
+    std::uint64_t threadCount;
+    std::uint64_t handleCount;
+    std::uint64_t connectionCount;
+} RvrseSystemMetrics;
+
 typedef struct RvrseProcessSnapshotView
 {
     const RvrseProcessInfo *processes;
     std::size_t processCount;
+
+    // API 1.4+: only read when hostServices->apiMinor >= 4. Terminated UTF-8
+    // image names, index-aligned with processes; the host keeps names as
+    // UTF-8, so these are its own text rather than a conversion.
+    const char *const *imageNamesUtf8;
 } RvrseProcessSnapshotView;
 
 typedef struct RvrseHandleSnapshotView
@@ -70,13 +116,56 @@ typedef struct RvrseHandleSnapshotView
     std::size_t handleCount;
 } RvrseHandleSnapshotView;
 
+typedef struct RvrseNetworkSnapshotView
+{
+    const RvrseConnectionInfo *connections;
+    std::size_t connectionCount;
+    std::uint32_t flags;
+} RvrseNetworkSnapshotView;
+
 typedef void (*RvrsePluginMenuCommand)(std::uint32_t processId, void *context);
 
+// Opaque handle returned by RegisterMetric; 0 means registration failed.
+typedef std::uint32_t RvrseMetricHandle;
+#define RVRSE_METRIC_INVALID_HANDLE 0U
+
+// Values for the RegisterMetric kind parameter.
+#define RVRSE_METRIC_COUNTER 0U
+#define RVRSE_METRIC_GAUGE 1U
+
+// Values for the WriteLog level parameter.
+#define RVRSE_LOG_DEBUG 0U
+#define RVRSE_LOG_INFO 1U
+#define RVRSE_LOG_WARNING 2U
+#define RVRSE_LOG_ERROR 3U
+
 typedef struct RvrseHostServices
 {
     void (*RegisterMenuItem)(const wchar_t *menuPath,
                              RvrsePluginMenuCommand command,
                              void *context);
+
+    // API 1.2+: only present when apiMinor >= 2. Plugins built against 1.2
+    // must not be loaded by older hosts.
+    std::uint32_t apiMinor;
+    void *hostContext;
+
+    // Register once (typically from RvrsePluginInitialize) and keep the handle.
+    // Registering an existing name with the same kind returns the same handle.
+    // Names should be namespaced, e.g. "plugin.sample_logger.lines_written".
+    RvrseMetricHandle (*RegisterMetric)(void *hostContext, const wchar_t *name, std::uint32_t kind);
+
+    // Lock-free updates; safe to call from any thread, including hook callbacks.
+    void (*AddToCounter)(void *hostContext, RvrseMetricHandle handle, std::uint64_t delta);
+    void (*SetGauge)(void *hostContext, RvrseMetricHandle handle, double value);
+
+    // API 1.3+: only present when apiMinor >= 3. Appends one line (no trailing
+    // newline needed) to the host log through a buffered background writer.
+    // Never blocks; returns false if the line was dropped (no host log, or the
+    // queue is full). Safe from any thread. FlushLog blocks until earlier lines
+    // have reached the file; call it sparingly (e.g. from shutdown).
+    bool (*WriteLog)(void *hostContext, std::uint32_t level, const wchar_t *message);
+    void (*FlushLog)(void *hostContext);
 } RvrseHostServices;
 
 typedef struct RvrsePluginHooks
@@ -84,6 +173,10 @@ typedef struct RvrsePluginHooks
     void (*OnProcessSnapshot)(const RvrseProcessSnapshotView *snapshot, void *context);
     void (*OnHandleSnapshot)(const RvrseHandleSnapshotView *snapshot, void *context);
     void *context;
+
+    // API 1.1+: fields appended here stay zeroed for plugins built against 1.0.
+    void (*OnNetworkSnapshot)(const RvrseNetworkSnapshotView *snapshot, void *context);
+    void (*OnSystemMetrics)(const RvrseSystemMetrics *metrics, void *context);
 } RvrsePluginHooks;
 
 typedef bool (*RvrsePluginInitializeFn)(const RvrseHostServices *hostServices,
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Builds the headless agent (rvrse-agent), the out-of-process plugin host, the
+# fleet aggregator (rvrse-aggregator), the terminal frontend (rvrse-top) and
+# the history query tool (rvrse-query) on Linux. The Visual Studio solution remains the build of record on
+# Windows; this covers the portable subset of RvrseCore/RvrseCommon.
+#
+#   scripts/build_agent_linux.sh [Debug|Release]
+#
+# Output: build/linux/<Config>/{rvrse-agent,rvrse-plugin-host,rvrse-aggregator,rvrse-top,rvrse-query,rvrse-agent.conf}
+set -euo pipefail
+
+CONFIG="${1:-Release}"
+REPO_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+OUT_DIR="${REPO_ROOT}/build/linux/${CONFIG}"
+OBJ_DIR="${OUT_DIR}/obj"
+CXX="${CXX:-g++}"
+
+case "${CONFIG}" in
+    Debug) OPT_FLAGS=(-O0 -g) ;;
+    Release) OPT_FLAGS=(-O2 -DNDEBUG) ;;
+    *) echo "Unknown configuration: ${CONFIG}" >&2; exit 1 ;;
+esac
+
+CXXFLAGS=(-std=c++17 -Wall -Wextra "${OPT_FLAGS[@]}"
+          -I"${REPO_ROOT}/include" -I"${REPO_ROOT}/src/core" -I"${REPO_ROOT}/src/common")
+LDLIBS=(-ldl -lrt -pthread)
+
+# Windows-only sources (driver control, string_utils' Win32 conversions) are
+# left out; every other file builds on both platforms.
+CORE_SOURCES=(
+    binary_codec.cpp
+    chunked_buffer.cpp
+    collector.cpp
+    collector_config.cpp
+    column_reduce.cpp
+    dynamic_library.cpp
+    fleet_aggregator.cpp
+    fleet_index.cpp
+    handle_snapshot.cpp
+    handle_snapshot_linux.cpp
+    history_query.cpp
+    history_store.cpp
+    http_server.cpp
+    json_writer.cpp
+    metrics_registry.cpp
+    name_matcher.cpp
+    ndjson_exporter.cpp
+    network_snapshot.cpp
+    network_snapshot_linux.cpp
+    openmetrics_exporter.cpp
+    out_of_process_plugin_host.cpp
+    output_sink.cpp
+    plugin_loader.cpp
+    poller.cpp
+    process_columns.cpp
+    process_order.cpp
+    process_query.cpp
+    process_snapshot.cpp
+    process_snapshot_linux.cpp
+    process_view.cpp
+    procfs.cpp
+    self_usage.cpp
+    shared_memory.cpp
+    snapshot_arena.cpp
+    snapshot_ring.cpp
+    socket.cpp
+    string_interner.cpp
+    system_metrics.cpp
+    terminal_screen.cpp
+    wire_client.cpp
+    wire_exporter.cpp
+    wire_protocol.cpp
+)
+COMMON_SOURCES=(
+    formatting.cpp
+    log_writer.cpp
+    string_utils.cpp
+    time_utils.cpp
+)
+
+mkdir -p "${OBJ_DIR}"
+
+OBJECTS=()
+compile() {
+    local source="$1"
+    local object="${OBJ_DIR}/$(basename "${source%.cpp}").o"
+    echo "  CXX ${source#"${REPO_ROOT}/"}"
+    "${CXX}" "${CXXFLAGS[@]}" -c "${source}" -o "${object}"
+    OBJECTS+=("${object}")
+}
+
+for source in "${CORE_SOURCES[@]}"; do
+    compile "${REPO_ROOT}/src/core/${source}"
+done
+for source in "${COMMON_SOURCES[@]}"; do
+    compile "${REPO_ROOT}/src/common/${source}"
+done
+LIBRARY_OBJECTS=("${OBJECTS[@]}")
+
+OBJECTS=()
+compile "${REPO_ROOT}/src/agent/main.cpp"
+mv "${OBJ_DIR}/main.o" "${OBJ_DIR}/agent_main.o"
+"${CXX}" "${OBJ_DIR}/agent_main.o" "${LIBRARY_OBJECTS[@]}" "${LDLIBS[@]}" -o "${OUT_DIR}/rvrse-agent"
+
+OBJECTS=()
+compile "${REPO_ROOT}/src/plugin_host/main.cpp"
+mv "${OBJ_DIR}/main.o" "${OBJ_DIR}/plugin_host_main.o"
+"${CXX}" "${OBJ_DIR}/plugin_host_main.o" "${LIBRARY_OBJECTS[@]}" "${LDLIBS[@]}" -o "${OUT_DIR}/rvrse-plugin-host"
+
+OBJECTS=()
+compile "${REPO_ROOT}/src/aggregator/main.cpp"
+mv "${OBJ_DIR}/main.o" "${OBJ_DIR}/aggregator_main.o"
+"${CXX}" "${OBJ_DIR}/aggregator_main.o" "${LIBRARY_OBJECTS[@]}" "${LDLIBS[@]}" -o "${OUT_DIR}/rvrse-aggregator"
+
+OBJECTS=()
+compile "${REPO_ROOT}/src/top/main.cpp"
+mv "${OBJ_DIR}/main.o" "${OBJ_DIR}/top_main.o"
+"${CXX}" "${OBJ_DIR}/top_main.o" "${LIBRARY_OBJECTS[@]}" "${LDLIBS[@]}" -o "${OUT_DIR}/rvrse-top"
+
+OBJECTS=()
+compile "${REPO_ROOT}/src/query/main.cpp"
+mv "${OBJ_DIR}/main.o" "${OBJ_DIR}/query_main.o"
+"${CXX}" "${OBJ_DIR}/query_main.o" "${LIBRARY_OBJECTS[@]}" "${LDLIBS[@]}" -o "${OUT_DIR}/rvrse-query"
+
+cp "${REPO_ROOT}/src/agent/rvrse-agent.conf" "${OUT_DIR}/"
+echo "Built ${OUT_DIR}/rvrse-agent"
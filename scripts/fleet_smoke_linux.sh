@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+# Local multi-process check of the fleet path: starts rvrse-aggregator and
+# several rvrse-agent collectors on this machine, each pushing its wire
+# stream under its own host name, then queries the aggregator over HTTP.
+#
+#   scripts/fleet_smoke_linux.sh [Debug|Release] [collectors]
+#
+# Expects scripts/build_agent_linux.sh to have run for the same config.
+set -euo pipefail
+
+CONFIG="${1:-Release}"
+COLLECTORS="${2:-8}"
+REPO_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BIN_DIR="${REPO_ROOT}/build/linux/${CONFIG}"
+WORK_DIR="$(mktemp -d)"
+INGEST_PORT="${RVRSE_FLEET_PORT:-19466}"
+HTTP_PORT="${RVRSE_FLEET_HTTP_PORT:-19467}"
+
+PIDS=()
+cleanup() {
+    for pid in "${PIDS[@]}"; do
+        kill "${pid}" 2>/dev/null || true
+    done
+    wait 2>/dev/null || true
+    rm -rf "${WORK_DIR}"
+}
+trap cleanup EXIT
+
+"${BIN_DIR}/rvrse-aggregator" --listen "tcp://127.0.0.1:${INGEST_PORT}" --http-port "${HTTP_PORT}" \
+    2>"${WORK_DIR}/aggregator.err" &
+PIDS+=($!)
+sleep 0.5
+
+for index in $(seq 1 "${COLLECTORS}"); do
+    cat >"${WORK_DIR}/sim-${index}.conf" <<EOF
+process_interval_ms = 500
+handle_interval_ms = 0
+network_interval_ms = 0
+plugins = false
+log_path =
+exporters = wire
+wire_push = tcp://127.0.0.1:${INGEST_PORT}
+wire_host_name = sim-${index}
+EOF
+    "${BIN_DIR}/rvrse-agent" --config "${WORK_DIR}/sim-${index}.conf" 2>"${WORK_DIR}/sim-${index}.err" &
+    PIDS+=($!)
+done
+
+# Collectors retry once a second; give them a few generations.
+sleep 3
+
+hosts="$(curl -sf "http://127.0.0.1:${HTTP_PORT}/hosts")"
+connected="$(grep -o '"connected":true' <<<"${hosts}" | wc -l)"
+echo "${connected}/${COLLECTORS} collectors connected"
+curl -sf "http://127.0.0.1:${HTTP_PORT}/top/private_bytes/5"
+echo
+
+if [[ "${connected}" -ne "${COLLECTORS}" ]]; then
+    echo "Fleet smoke test failed" >&2
+    cat "${WORK_DIR}"/*.err >&2
+    exit 1
+fi
+echo "Fleet smoke test passed"
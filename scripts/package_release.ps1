@@ -47,6 +47,12 @@ function Copy-Artifact {
 
 Copy-Artifact -Source (Join-Path $buildRoot 'RvrseMonitorApp.exe') -DestinationRelative 'RvrseMonitorApp.exe'
 Copy-Artifact -Source (Join-Path $buildRoot 'RvrseMonitorTests.exe') -DestinationRelative 'RvrseMonitorTests.exe'
+Copy-Artifact -Source (Join-Path $buildRoot 'rvrse-plugin-host.exe') -DestinationRelative 'rvrse-plugin-host.exe'
+Copy-Artifact -Source (Join-Path $buildRoot 'rvrse-agent.exe') -DestinationRelative 'rvrse-agent.exe'
+Copy-Artifact -Source (Join-Path $buildRoot 'rvrse-agent.conf') -DestinationRelative 'rvrse-agent.conf'
+Copy-Artifact -Source (Join-Path $buildRoot 'rvrse-aggregator.exe') -DestinationRelative 'rvrse-aggregator.exe'
+Copy-Artifact -Source (Join-Path $buildRoot 'rvrse-top.exe') -DestinationRelative 'rvrse-top.exe'
+Copy-Artifact -Source (Join-Path $buildRoot 'rvrse-query.exe') -DestinationRelative 'rvrse-query.exe'
 
 $pluginSource = Join-Path $buildRoot 'plugins'
 if (Test-Path $pluginSource) {
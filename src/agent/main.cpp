@@ -0,0 +1,337 @@
+// rvrse-agent: headless collector for machines without a desktop session.
+// Runs the same capture, plugin and metrics code as the monitor, driven by
+// a config file instead of a window timer.
+//
+//   rvrse-agent [--config <path>] [--generations <n>]
+//
+// Without --config, rvrse-agent.conf next to the executable is used when it
+// exists. Runs until SIGINT/SIGTERM (Ctrl+C / console close on Windows).
+
+#include <atomic>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "collector.h"
+#include "history_store.h"
+#include "ndjson_exporter.h"
+#include "openmetrics_exporter.h"
+#include "wire_exporter.h"
+#include "rvrse/common/formatting.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <csignal>
+#endif
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    std::atomic<bool> g_stopRequested{false};
+
+#if defined(_WIN32)
+    BOOL WINAPI ConsoleControlHandler(DWORD)
+    {
+        g_stopRequested.store(true);
+        return TRUE;
+    }
+
+    void InstallStopHandlers()
+    {
+        SetConsoleCtrlHandler(ConsoleControlHandler, TRUE);
+    }
+#else
+    void HandleStopSignal(int)
+    {
+        g_stopRequested.store(true);
+    }
+
+    void InstallStopHandlers()
+    {
+        struct sigaction action{};
+        action.sa_handler = HandleStopSignal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+    }
+#endif
+
+    fs::path ExecutableDirectory()
+    {
+#if defined(_WIN32)
+        wchar_t pathBuffer[MAX_PATH] = {0};
+        DWORD result = GetModuleFileNameW(nullptr, pathBuffer, static_cast<DWORD>(std::size(pathBuffer)));
+        if (result == 0 || result == std::size(pathBuffer))
+        {
+            return {};
+        }
+        return fs::path(pathBuffer).parent_path();
+#else
+        std::error_code ec;
+        fs::path exePath = fs::read_symlink("/proc/self/exe", ec);
+        return ec ? fs::path() : exePath.parent_path();
+#endif
+    }
+
+    // One line per generation in the collector log; the smallest useful
+    // exporter and the default when none is configured.
+    class SummaryExporter final : public rvrse::core::CollectorExporter
+    {
+    public:
+        explicit SummaryExporter(rvrse::common::LogWriter &log)
+            : log_(log)
+        {
+        }
+
+        const wchar_t *Name() const override { return L"summary"; }
+
+        void Export(const rvrse::core::CollectorFrame &frame) override
+        {
+            if (!log_.IsOpen())
+            {
+                return;
+            }
+
+            wchar_t buffer[256];
+            std::swprintf(buffer,
+                          std::size(buffer),
+                          L"[INFO] generation %llu: %llu processes, %llu threads, %llu handles, %llu connections, CPU %.1f%%, memory %.1f%%",
+                          static_cast<unsigned long long>(frame.generation),
+                          static_cast<unsigned long long>(frame.metrics.processCount),
+                          static_cast<unsigned long long>(frame.metrics.threadCount),
+                          static_cast<unsigned long long>(frame.metrics.handleCount),
+                          static_cast<unsigned long long>(frame.metrics.connectionCount),
+                          frame.metrics.cpuUsagePercent,
+                          frame.metrics.memoryUsagePercent);
+            log_.Write(std::wstring_view(buffer));
+        }
+
+    private:
+        rvrse::common::LogWriter &log_;
+    };
+
+    struct AgentOptions
+    {
+        std::wstring configPath;
+        std::uint64_t maxGenerations = 0;
+    };
+
+    bool ParseArguments(const std::vector<std::wstring> &args, AgentOptions &options)
+    {
+        for (std::size_t index = 1; index < args.size(); ++index)
+        {
+            const std::wstring &arg = args[index];
+            const bool hasValue = index + 1 < args.size();
+
+            if (arg == L"--config" && hasValue)
+            {
+                options.configPath = args[++index];
+            }
+            else if (arg == L"--generations" && hasValue)
+            {
+                options.maxGenerations = std::wcstoull(args[++index].c_str(), nullptr, 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int RunAgent(const std::vector<std::wstring> &args)
+    {
+        AgentOptions options;
+        if (!ParseArguments(args, options))
+        {
+            std::fputws(L"usage: rvrse-agent [--config <path>] [--generations <n>]\n", stderr);
+            return 2;
+        }
+
+        const fs::path exeDirectory = ExecutableDirectory();
+
+        rvrse::core::CollectorConfig config;
+        config.logPath = (exeDirectory / L"rvrse-agent.log").wstring();
+
+        std::wstring configPath = options.configPath;
+        if (configPath.empty())
+        {
+            std::error_code ec;
+            const fs::path defaultConfig = exeDirectory / L"rvrse-agent.conf";
+            if (fs::exists(defaultConfig, ec))
+            {
+                configPath = defaultConfig.wstring();
+            }
+        }
+
+        if (!configPath.empty())
+        {
+            std::wstring error;
+            if (!rvrse::core::LoadCollectorConfig(configPath, config, error))
+            {
+                std::fwprintf(stderr, L"[Agent] %ls: %ls\n", configPath.c_str(), error.c_str());
+                return 3;
+            }
+        }
+
+        if (config.exporters.empty())
+        {
+            config.exporters.push_back(L"summary");
+        }
+
+        rvrse::core::Collector collector(config);
+
+        std::vector<std::unique_ptr<rvrse::core::CollectorExporter>> exporters;
+        rvrse::core::WireExporter *wireExporter = nullptr;
+        rvrse::core::HistoryRecorder *historyRecorder = nullptr;
+        for (const auto &name : config.exporters)
+        {
+            if (name == L"summary")
+            {
+                exporters.push_back(std::make_unique<SummaryExporter>(collector.Log()));
+            }
+            else if (name == L"openmetrics")
+            {
+                rvrse::core::OpenMetricsOptions openMetricsOptions;
+                openMetricsOptions.address = config.openMetricsAddress;
+                openMetricsOptions.port = config.openMetricsPort;
+                openMetricsOptions.topProcesses = config.openMetricsTopProcesses;
+
+                auto exporter = std::make_unique<rvrse::core::OpenMetricsExporter>(std::move(openMetricsOptions));
+                if (!exporter->Start())
+                {
+                    const std::wstring address(config.openMetricsAddress.begin(), config.openMetricsAddress.end());
+                    std::fwprintf(stderr,
+                                  L"[Agent] Unable to listen on %ls:%u for openmetrics\n",
+                                  address.c_str(),
+                                  static_cast<unsigned>(config.openMetricsPort));
+                    return 4;
+                }
+                exporters.push_back(std::move(exporter));
+            }
+            else if (name == L"ndjson")
+            {
+                rvrse::core::NdjsonOptions ndjsonOptions;
+                ndjsonOptions.target = config.ndjsonTarget;
+                ndjsonOptions.keyframeInterval = config.ndjsonKeyframeInterval;
+
+                auto exporter = std::make_unique<rvrse::core::NdjsonExporter>(std::move(ndjsonOptions));
+                if (!exporter->Start())
+                {
+                    std::fwprintf(stderr, L"[Agent] Unable to open ndjson target '%ls'\n", config.ndjsonTarget.c_str());
+                    return 4;
+                }
+                exporters.push_back(std::move(exporter));
+            }
+            else if (name == L"wire")
+            {
+                rvrse::core::WireOptions wireOptions;
+                wireOptions.listen = config.wireListen;
+                wireOptions.keyframeInterval = config.wireKeyframeInterval;
+                wireOptions.push = config.wirePush;
+                wireOptions.hostName = config.wireHostName.empty() ? rvrse::core::LocalHostName() : config.wireHostName;
+
+                auto exporter = std::make_unique<rvrse::core::WireExporter>(std::move(wireOptions));
+                if (!exporter->Start())
+                {
+                    if (config.wirePush.empty())
+                    {
+                        std::fwprintf(stderr, L"[Agent] Unable to listen on '%ls' for wire\n", config.wireListen.c_str());
+                    }
+                    else
+                    {
+                        std::fwprintf(stderr, L"[Agent] Invalid wire push target '%ls'\n", config.wirePush.c_str());
+                    }
+                    return 4;
+                }
+                wireExporter = exporter.get();
+                exporters.push_back(std::move(exporter));
+            }
+            else if (name == L"history")
+            {
+                rvrse::core::HistoryOptions historyOptions;
+                historyOptions.directory = config.historyPath.empty() ? (exeDirectory / L"history").wstring() : config.historyPath;
+                historyOptions.keyframeInterval = config.historyKeyframeInterval;
+                historyOptions.retentionHours = config.historyRetentionHours;
+
+                auto exporter = std::make_unique<rvrse::core::HistoryRecorder>(std::move(historyOptions));
+                std::wstring error;
+                if (!exporter->Start(error))
+                {
+                    std::fwprintf(stderr, L"[Agent] history: %ls\n", error.c_str());
+                    return 4;
+                }
+                historyRecorder = exporter.get();
+                exporters.push_back(std::move(exporter));
+            }
+            else
+            {
+                std::fwprintf(stderr, L"[Agent] Unknown exporter '%ls'\n", name.c_str());
+                return 3;
+            }
+            collector.AddExporter(exporters.back().get());
+        }
+
+        if (!collector.Start())
+        {
+            return 4;
+        }
+
+        InstallStopHandlers();
+        collector.Run(g_stopRequested, options.maxGenerations);
+
+        const rvrse::core::SelfUsage &usage = collector.LastSelfUsage();
+        std::fwprintf(stderr,
+                      L"[Agent] %llu generations; CPU %.2f%%, RSS %ls (peak %ls)\n",
+                      static_cast<unsigned long long>(collector.Generation()),
+                      usage.cpuPercent,
+                      rvrse::common::FormatSize(usage.residentBytes).c_str(),
+                      rvrse::common::FormatSize(usage.peakResidentBytes).c_str());
+        if (wireExporter && wireExporter->FramesEncoded() > 0)
+        {
+            std::fwprintf(stderr,
+                          L"[Agent] wire: %llu frames, %ls per frame on average, %llu dropped\n",
+                          static_cast<unsigned long long>(wireExporter->FramesEncoded()),
+                          rvrse::common::FormatSize(wireExporter->BytesEncoded() / wireExporter->FramesEncoded()).c_str(),
+                          static_cast<unsigned long long>(wireExporter->GenerationsDropped()));
+        }
+
+        collector.Stop();
+        if (historyRecorder)
+        {
+            historyRecorder->Stop();
+            std::fwprintf(stderr,
+                          L"[Agent] history: %llu frames, %ls written, %llu dropped\n",
+                          static_cast<unsigned long long>(historyRecorder->FramesWritten()),
+                          rvrse::common::FormatSize(historyRecorder->BytesWritten()).c_str(),
+                          static_cast<unsigned long long>(historyRecorder->FramesDropped()));
+        }
+        return 0;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(int argc, wchar_t **argv)
+{
+    std::vector<std::wstring> args(argv, argv + argc);
+    return RunAgent(args);
+}
+#else
+int main(int argc, char **argv)
+{
+    std::vector<std::wstring> args;
+    args.reserve(static_cast<std::size_t>(argc));
+    for (int index = 0; index < argc; ++index)
+    {
+        args.push_back(std::filesystem::path(argv[index]).wstring());
+    }
+    return RunAgent(args);
+}
+#endif
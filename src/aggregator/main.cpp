@@ -0,0 +1,324 @@
+// rvrse-aggregator: fleet endpoint for rvrse-agent collectors. Agents with
+// wire_push set stream their generations here; the latest one per host is
+// kept in memory and cross-host queries are answered over HTTP as JSON:
+//
+//   GET /hosts                       every known host and its system metrics
+//   GET /top/<metric>[/<limit>]      top processes across connected hosts
+//
+// <metric> is cpu_percent, working_set_bytes, private_bytes or threads;
+// <limit> defaults to 20 and is capped at 100.
+//
+//   rvrse-aggregator [--listen <endpoint>] [--http-address <address>]
+//                    [--http-port <port>] [--workers <n>] [--max-hosts <n>]
+//
+// Runs until SIGINT/SIGTERM (Ctrl+C / console close on Windows).
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "chunked_buffer.h"
+#include "fleet_aggregator.h"
+#include "http_server.h"
+#include "json_writer.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <csignal>
+#endif
+
+namespace
+{
+    constexpr std::size_t kDefaultTopLimit = 20;
+
+    std::atomic<bool> g_stopRequested{false};
+
+#if defined(_WIN32)
+    BOOL WINAPI ConsoleControlHandler(DWORD)
+    {
+        g_stopRequested.store(true);
+        return TRUE;
+    }
+
+    void InstallStopHandlers()
+    {
+        SetConsoleCtrlHandler(ConsoleControlHandler, TRUE);
+    }
+#else
+    void HandleStopSignal(int)
+    {
+        g_stopRequested.store(true);
+    }
+
+    void InstallStopHandlers()
+    {
+        struct sigaction action{};
+        action.sa_handler = HandleStopSignal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+    }
+#endif
+
+    class StringSink final : public rvrse::core::OutputSink
+    {
+    public:
+        explicit StringSink(std::string &out) : out_(out) {}
+
+        bool Write(const char *data, std::size_t sizeBytes) override
+        {
+            out_.append(data, sizeBytes);
+            return true;
+        }
+
+    private:
+        std::string &out_;
+    };
+
+    std::int64_t TimestampMilliseconds(std::chrono::system_clock::time_point timestamp)
+    {
+        return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch()).count());
+    }
+
+    rvrse::core::HttpResponse JsonResponse(const rvrse::core::ChunkedBuffer &buffer)
+    {
+        auto body = std::make_shared<std::string>();
+        body->reserve(buffer.Size());
+        StringSink sink(*body);
+        buffer.WriteTo(sink);
+
+        rvrse::core::HttpResponse response;
+        response.contentType = "application/json";
+        response.body = std::move(body);
+        return response;
+    }
+
+    rvrse::core::HttpResponse TextResponse(int status, const char *text)
+    {
+        rvrse::core::HttpResponse response;
+        response.status = status;
+        response.body = std::make_shared<const std::string>(text);
+        return response;
+    }
+
+    rvrse::core::HttpResponse ServeHosts(const rvrse::core::FleetIndex &index)
+    {
+        rvrse::core::ChunkedBuffer buffer;
+        rvrse::core::JsonWriter json(buffer);
+        json.BeginObject();
+        json.Key("hosts");
+        json.BeginArray();
+        for (const rvrse::core::FleetHost &host : index.Hosts())
+        {
+            const rvrse::core::HostSummary &summary = *host.summary;
+            json.BeginObject();
+            json.Field("host", std::wstring_view(summary.host));
+            json.Field("connected", host.connected);
+            json.Field("generation", summary.generation);
+            json.Field("timestamp_ms", TimestampMilliseconds(summary.timestamp));
+            json.Field("processes", summary.processCount);
+            json.Field("cpu_percent", summary.metrics.cpuUsagePercent);
+            json.Field("memory_percent", summary.metrics.memoryUsagePercent);
+            json.Field("memory_total_bytes", summary.metrics.physicalMemoryTotalBytes);
+            json.Field("threads", summary.metrics.threadCount);
+            json.Field("connections", summary.metrics.connectionCount);
+            json.EndObject();
+        }
+        json.EndArray();
+        json.EndObject();
+        return JsonResponse(buffer);
+    }
+
+    rvrse::core::HttpResponse ServeTop(const rvrse::core::FleetIndex &index, std::string_view query)
+    {
+        const std::size_t slash = query.find('/');
+        const std::string_view metricName = query.substr(0, slash);
+
+        rvrse::core::FleetMetric metric;
+        if (!rvrse::core::ParseFleetMetric(metricName, metric))
+        {
+            return TextResponse(404, "metrics: cpu_percent, working_set_bytes, private_bytes, threads\n");
+        }
+
+        std::size_t limit = kDefaultTopLimit;
+        if (slash != std::string_view::npos)
+        {
+            const std::string_view limitText = query.substr(slash + 1);
+            limit = 0;
+            for (char ch : limitText)
+            {
+                if (ch < '0' || ch > '9' || limit > rvrse::core::HostSummary::kTopDepth)
+                {
+                    return TextResponse(400, "limit must be a number\n");
+                }
+                limit = limit * 10 + static_cast<std::size_t>(ch - '0');
+            }
+            if (limitText.empty())
+            {
+                return TextResponse(400, "limit must be a number\n");
+            }
+        }
+
+        rvrse::core::ChunkedBuffer buffer;
+        rvrse::core::JsonWriter json(buffer);
+        json.BeginObject();
+        json.Field("metric", rvrse::core::FleetMetricName(metric));
+        json.Key("processes");
+        json.BeginArray();
+        for (const rvrse::core::FleetTopEntry &entry : index.Top(metric, limit))
+        {
+            const rvrse::core::FleetProcess &process = *entry.process;
+            json.BeginObject();
+            json.Field("host", std::wstring_view(entry.host->host));
+            json.Field("generation", entry.host->generation);
+            json.Field("pid", process.processId);
+            json.Field("ppid", process.parentProcessId);
+            json.Field("name", std::wstring_view(process.name));
+            json.Field("cpu_percent", process.cpuPercent);
+            json.Field("working_set_bytes", process.workingSetBytes);
+            json.Field("private_bytes", process.privateBytes);
+            json.Field("threads", process.threadCount);
+            json.EndObject();
+        }
+        json.EndArray();
+        json.EndObject();
+        return JsonResponse(buffer);
+    }
+
+    struct AggregatorArguments
+    {
+        rvrse::core::FleetAggregatorOptions fleet;
+        std::string httpAddress = "127.0.0.1";
+        std::uint16_t httpPort = 9467;
+    };
+
+    bool ParseArguments(const std::vector<std::wstring> &args, AggregatorArguments &options)
+    {
+        for (std::size_t index = 1; index < args.size(); ++index)
+        {
+            const std::wstring &arg = args[index];
+            const bool hasValue = index + 1 < args.size();
+
+            if (arg == L"--listen" && hasValue)
+            {
+                options.fleet.listen = args[++index];
+            }
+            else if (arg == L"--http-address" && hasValue)
+            {
+                const std::wstring &address = args[++index];
+                options.httpAddress.assign(address.begin(), address.end());
+            }
+            else if (arg == L"--http-port" && hasValue)
+            {
+                const unsigned long long port = std::wcstoull(args[++index].c_str(), nullptr, 10);
+                if (port > 0xFFFF)
+                {
+                    return false;
+                }
+                options.httpPort = static_cast<std::uint16_t>(port);
+            }
+            else if (arg == L"--workers" && hasValue)
+            {
+                options.fleet.workerThreads = static_cast<std::size_t>(std::wcstoull(args[++index].c_str(), nullptr, 10));
+            }
+            else if (arg == L"--max-hosts" && hasValue)
+            {
+                options.fleet.maxHosts = static_cast<std::size_t>(std::wcstoull(args[++index].c_str(), nullptr, 10));
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int RunAggregator(const std::vector<std::wstring> &args)
+    {
+        AggregatorArguments options;
+        if (!ParseArguments(args, options))
+        {
+            std::fputws(L"usage: rvrse-aggregator [--listen <endpoint>] [--http-address <address>] [--http-port <port>] "
+                        L"[--workers <n>] [--max-hosts <n>]\n",
+                        stderr);
+            return 2;
+        }
+
+        rvrse::core::FleetAggregator aggregator(options.fleet);
+        if (!aggregator.Start())
+        {
+            std::fwprintf(stderr, L"[Aggregator] Unable to listen on '%ls'\n", options.fleet.listen.c_str());
+            return 4;
+        }
+
+        rvrse::core::HttpServer server;
+        const rvrse::core::FleetIndex &index = aggregator.Index();
+        const bool serving = server.Start(options.httpAddress, options.httpPort, [&index](std::string_view path)
+                                          {
+                                              constexpr std::string_view kTopPrefix = "/top/";
+                                              if (path == "/hosts")
+                                              {
+                                                  return ServeHosts(index);
+                                              }
+                                              if (path.substr(0, kTopPrefix.size()) == kTopPrefix)
+                                              {
+                                                  return ServeTop(index, path.substr(kTopPrefix.size()));
+                                              }
+                                              return TextResponse(404, "endpoints: /hosts, /top/<metric>[/<limit>]\n"); });
+        if (!serving)
+        {
+            const std::wstring address(options.httpAddress.begin(), options.httpAddress.end());
+            std::fwprintf(stderr, L"[Aggregator] Unable to serve HTTP on %ls:%u\n", address.c_str(), static_cast<unsigned>(options.httpPort));
+            return 4;
+        }
+
+        std::fwprintf(stderr,
+                      L"[Aggregator] Collectors on '%ls' (%zu workers), queries on port %u\n",
+                      options.fleet.listen.c_str(),
+                      aggregator.WorkerCount(),
+                      static_cast<unsigned>(server.Port()));
+
+        InstallStopHandlers();
+        while (!g_stopRequested.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        server.Stop();
+        aggregator.Stop();
+        std::fwprintf(stderr,
+                      L"[Aggregator] %zu hosts; %llu frames, %llu bytes received, %llu protocol errors\n",
+                      aggregator.Index().HostCount(),
+                      static_cast<unsigned long long>(aggregator.FramesApplied()),
+                      static_cast<unsigned long long>(aggregator.BytesReceived()),
+                      static_cast<unsigned long long>(aggregator.ProtocolErrors()));
+        return 0;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(int argc, wchar_t **argv)
+{
+    std::vector<std::wstring> args(argv, argv + argc);
+    return RunAggregator(args);
+}
+#else
+int main(int argc, char **argv)
+{
+    std::vector<std::wstring> args;
+    args.reserve(static_cast<std::size_t>(argc));
+    for (int index = 0; index < argc; ++index)
+    {
+        args.push_back(std::filesystem::path(argv[index]).wstring());
+    }
+    return RunAggregator(args);
+}
+#endif
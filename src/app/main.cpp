@@ -13,6 +13,7 @@
 #include <cwchar>
 #include <cwctype>
 #include <deque>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <numeric>
@@ -23,10 +24,17 @@
 
 #include "rvrse_monitor.h"
 #include "rvrse/common/formatting.h"
+#include "rvrse/common/log_writer.h"
+#include "column_reduce.h"
 #include "process_snapshot.h"
+#include "process_columns.h"
+#include "process_view.h"
 #include "network_snapshot.h"
 #include "handle_snapshot.h"
+#include "metrics_registry.h"
+#include "out_of_process_plugin_host.h"
 #include "plugin_loader.h"
+#include "system_metrics.h"
 
 #pragma comment(lib, "Comctl32.lib")
 #pragma comment(lib, "Ws2_32.lib")
@@ -59,6 +67,27 @@ namespace
     constexpr int kContextMenuPriorityBelowNormal = 0x4014;
     constexpr int kContextMenuPriorityLow = 0x4015;
 
+    std::wstring ResolveHostLogPath()
+    {
+        wchar_t pathBuffer[MAX_PATH] = {0};
+        DWORD result = GetModuleFileNameW(nullptr, pathBuffer, static_cast<DWORD>(std::size(pathBuffer)));
+        if (result == 0 || result == std::size(pathBuffer))
+        {
+            return L"rvrse-monitor.log";
+        }
+
+        return (std::filesystem::path(pathBuffer).parent_path() / L"rvrse-monitor.log").wstring();
+    }
+
+    // RVRSE_PLUGIN_ISOLATION=process runs each plugin in its own
+    // rvrse-plugin-host process instead of loading it into the monitor.
+    bool UseOutOfProcessPlugins()
+    {
+        wchar_t value[16] = {0};
+        DWORD length = GetEnvironmentVariableW(L"RVRSE_PLUGIN_ISOLATION", value, static_cast<DWORD>(std::size(value)));
+        return length > 0 && length < std::size(value) && _wcsicmp(value, L"process") == 0;
+    }
+
     class ResourceGraphView
     {
     public:
@@ -330,9 +359,9 @@ namespace
 class ModuleViewerWindow
     {
     public:
-        static void Show(HWND owner, HINSTANCE instance, const rvrse::core::ProcessEntry &process)
+        static void Show(HWND owner, HINSTANCE instance, rvrse::core::ProcessRef process)
         {
-            auto window = std::unique_ptr<ModuleViewerWindow>(new ModuleViewerWindow(instance, process));
+            auto window = std::unique_ptr<ModuleViewerWindow>(new ModuleViewerWindow(instance, std::move(process)));
             if (window->Create(owner))
             {
                 window.release();
@@ -351,10 +380,10 @@ class ModuleViewerWindow
     private:
         static constexpr const wchar_t *kClassName = L"RvrseModuleViewerWindow";
 
-        ModuleViewerWindow(HINSTANCE instance, const rvrse::core::ProcessEntry &process)
-            : instance_(instance), process_(process)
+        ModuleViewerWindow(HINSTANCE instance, rvrse::core::ProcessRef process)
+            : instance_(instance), process_(std::move(process))
         {
-            modules_ = rvrse::core::ProcessSnapshot::EnumerateModules(process.processId);
+            modules_ = rvrse::core::ProcessSnapshot::EnumerateModules(process_->processId);
         }
 
         bool Create(HWND owner)
@@ -515,12 +544,12 @@ class ModuleViewerWindow
             for (int index = 0; index < static_cast<int>(modules_.size()); ++index)
             {
                 const auto &module = modules_[index];
-                std::wstring displayName = module.name.empty() ? L"[Unknown]" : module.name;
+                const wchar_t *displayName = module.name.empty() ? L"[Unknown]" : module.name.c_str();
 
                 LVITEMW item{};
                 item.mask = LVIF_TEXT;
                 item.iItem = index;
-                item.pszText = displayName.data();
+                item.pszText = const_cast<wchar_t *>(displayName);
                 ListView_InsertItem(listView_, &item);
 
                 wchar_t baseBuffer[64];
@@ -530,8 +559,8 @@ class ModuleViewerWindow
                 std::wstring sizeText = rvrse::common::FormatSize(module.sizeBytes);
                 ListView_SetItemText(listView_, index, 2, sizeText.data());
 
-                std::wstring pathText = module.path.empty() ? L"(unknown)" : module.path;
-                ListView_SetItemText(listView_, index, 3, pathText.data());
+                const wchar_t *pathText = module.path.empty() ? L"(unknown)" : module.path.c_str();
+                ListView_SetItemText(listView_, index, 3, const_cast<wchar_t *>(pathText));
             }
         }
 
@@ -541,8 +570,8 @@ class ModuleViewerWindow
             StringCchPrintfW(title,
                              std::size(title),
                              L"Modules - %s (PID %u)",
-                             process_.imageName.empty() ? L"[Unnamed]" : process_.imageName.c_str(),
-                             process_.processId);
+                             process_->imageName.empty() ? L"[Unnamed]" : process_->imageName.c_str(),
+                             process_->processId);
             SetWindowTextW(hwnd_, title);
         }
 
@@ -562,7 +591,8 @@ class ModuleViewerWindow
         HINSTANCE instance_;
         HWND hwnd_ = nullptr;
         HWND listView_ = nullptr;
-        rvrse::core::ProcessEntry process_;
+        // Shares the snapshot the window was opened from.
+        rvrse::core::ProcessRef process_;
         std::vector<rvrse::core::ModuleEntry> modules_;
     };
 
@@ -571,12 +601,12 @@ class ModuleViewerWindow
     public:
         static void Show(HWND owner,
                          HINSTANCE instance,
-                         const rvrse::core::ProcessEntry &process,
+                         rvrse::core::ProcessRef process,
                          const rvrse::core::NetworkSnapshot &snapshot)
         {
-            auto connections = snapshot.ConnectionsForProcess(process.processId);
+            auto connections = snapshot.RowsForProcess(process->processId);
             auto window = std::unique_ptr<ConnectionViewerWindow>(
-                new ConnectionViewerWindow(instance, process, std::move(connections)));
+                new ConnectionViewerWindow(instance, std::move(process), std::move(connections)));
             if (window->Create(owner))
             {
                 window.release();
@@ -594,9 +624,9 @@ class ModuleViewerWindow
         static constexpr const wchar_t *kClassName = L"RvrseConnectionViewerWindow";
 
         ConnectionViewerWindow(HINSTANCE instance,
-                               const rvrse::core::ProcessEntry &process,
-                               std::vector<rvrse::core::ConnectionEntry> connections)
-            : instance_(instance), process_(process), connections_(std::move(connections))
+                               rvrse::core::ProcessRef process,
+                               rvrse::core::ConnectionRows connections)
+            : instance_(instance), process_(std::move(process)), connections_(std::move(connections))
         {
         }
 
@@ -772,7 +802,7 @@ class ModuleViewerWindow
             for (int index = 0; index < static_cast<int>(connections_.size()); ++index)
             {
                 const auto &connection = connections_[index];
-                std::wstring protocolText = connection.protocol == rvrse::core::TransportProtocol::Tcp ? L"TCP" : L"UDP";
+                std::wstring protocolText = connection.Protocol() == rvrse::core::TransportProtocol::Tcp ? L"TCP" : L"UDP";
 
                 LVITEMW item{};
                 item.mask = LVIF_TEXT;
@@ -780,20 +810,20 @@ class ModuleViewerWindow
                 item.pszText = protocolText.data();
                 ListView_InsertItem(listView_, &item);
 
-                auto localEndpoint = connection.addressFamily == rvrse::core::AddressFamily::IPv6
-                                          ? FormatEndpoint6(connection.localAddress6, connection.localPort)
-                                          : FormatEndpoint(connection.localAddress, connection.localPort);
+                auto localEndpoint = connection.Family() == rvrse::core::AddressFamily::IPv6
+                                          ? FormatEndpoint6(connection.LocalAddress6(), connection.localPort)
+                                          : FormatEndpoint(connection.LocalAddress(), connection.localPort);
                 ListView_SetItemText(listView_, index, 1, localEndpoint.data());
 
-                auto remoteEndpoint = connection.protocol == rvrse::core::TransportProtocol::Tcp
-                                           ? (connection.addressFamily == rvrse::core::AddressFamily::IPv6
-                                                  ? FormatEndpoint6(connection.remoteAddress6, connection.remotePort)
-                                                  : FormatEndpoint(connection.remoteAddress, connection.remotePort))
+                auto remoteEndpoint = connection.Protocol() == rvrse::core::TransportProtocol::Tcp
+                                           ? (connection.Family() == rvrse::core::AddressFamily::IPv6
+                                                  ? FormatEndpoint6(connection.RemoteAddress6(), connection.remotePort)
+                                                  : FormatEndpoint(connection.RemoteAddress(), connection.remotePort))
                                            : std::wstring(L"-");
                 ListView_SetItemText(listView_, index, 2, remoteEndpoint.data());
 
-                std::wstring stateText = connection.protocol == rvrse::core::TransportProtocol::Tcp
-                                             ? DescribeTcpState(connection.state)
+                std::wstring stateText = connection.Protocol() == rvrse::core::TransportProtocol::Tcp
+                                             ? DescribeTcpState(connection.State())
                                              : L"-";
                 ListView_SetItemText(listView_, index, 3, stateText.data());
             }
@@ -805,8 +835,8 @@ class ModuleViewerWindow
             StringCchPrintfW(title,
                              std::size(title),
                              L"Connections - %s (PID %u)",
-                             process_.imageName.empty() ? L"[Unnamed]" : process_.imageName.c_str(),
-                             process_.processId);
+                             process_->imageName.empty() ? L"[Unnamed]" : process_->imageName.c_str(),
+                             process_->processId);
             SetWindowTextW(hwnd_, title);
         }
 
@@ -927,8 +957,9 @@ class ModuleViewerWindow
         HINSTANCE instance_ = nullptr;
         HWND hwnd_ = nullptr;
         HWND listView_ = nullptr;
-        rvrse::core::ProcessEntry process_;
-        std::vector<rvrse::core::ConnectionEntry> connections_;
+        // Shares the snapshot the window was opened from.
+        rvrse::core::ProcessRef process_;
+        rvrse::core::ConnectionRows connections_;
     };
 
     class MainWindow
@@ -1041,7 +1072,28 @@ class ModuleViewerWindow
             if (!pluginLoader_)
             {
                 pluginLoader_ = std::make_unique<rvrse::core::PluginLoader>();
-                pluginLoader_->LoadPlugins();
+                pluginLoader_->SetMetricsRegistry(&metricsRegistry_);
+
+                rvrse::common::LogWriterOptions logOptions;
+                logOptions.path = ResolveHostLogPath();
+                if (hostLog_.Open(std::move(logOptions)))
+                {
+                    pluginLoader_->SetLogWriter(&hostLog_);
+                }
+
+                if (UseOutOfProcessPlugins())
+                {
+                    // No in-process fallback: isolation was requested explicitly.
+                    pluginHost_ = std::make_unique<rvrse::core::OutOfProcessPluginHost>();
+                    if (!pluginHost_->Start(pluginLoader_->DiscoverPluginPaths()))
+                    {
+                        pluginHost_.reset();
+                    }
+                }
+                else
+                {
+                    pluginLoader_->LoadPlugins();
+                }
             }
 
             INITCOMMONCONTROLSEX icex = {sizeof(icex)};
@@ -1231,6 +1283,7 @@ class ModuleViewerWindow
             }
 
             EnsureColumns();
+            processView_.SetSort(static_cast<rvrse::core::ProcessSortColumn>(sortColumn_), sortAscending_);
             RefreshProcesses();
             SetTimer(hwnd_, kRefreshTimerId, kRefreshIntervalMs, nullptr);
         }
@@ -1249,10 +1302,17 @@ class ModuleViewerWindow
 
             graphView_.Destroy();
 
+            if (pluginHost_)
+            {
+                pluginHost_->Stop();
+            }
+
             if (pluginLoader_)
             {
                 pluginLoader_->UnloadPlugins();
             }
+
+            hostLog_.Close();
         }
 
         void OnKeyDown(UINT key)
@@ -1327,9 +1387,9 @@ class ModuleViewerWindow
                 return;
 
             // Create display string with process name and PID
-            std::wstring displayName = process.imageName.empty() ? L"[Unnamed]" : process.imageName;
+            const wchar_t *displayName = process.imageName.empty() ? L"[Unnamed]" : process.imageName.c_str();
             wchar_t nodeText[256];
-            StringCchPrintfW(nodeText, std::size(nodeText), L"%s (PID %u)", displayName.c_str(), process.processId);
+            StringCchPrintfW(nodeText, std::size(nodeText), L"%s (PID %u)", displayName, process.processId);
 
             // Insert tree item
             TV_INSERTSTRUCTW tvis{};
@@ -1438,33 +1498,25 @@ class ModuleViewerWindow
                 return;
             }
 
-            constexpr struct
-            {
-                const wchar_t *title;
-                int width;
-            } columns[] = {
-                {L"Process", 320},
-                {L"PID", 80},
-                {L"Threads", 90},
-                {L"Working Set", 140},
-                {L"Private Bytes", 140}};
-
             LVCOLUMNW column{};
             column.mask = LVCF_TEXT | LVCF_WIDTH;
 
-            for (int i = 0; i < static_cast<int>(std::size(columns)); ++i)
+            int index = 0;
+            const auto insertColumn = [this, &column, &index](const auto &descriptor)
             {
-                column.pszText = const_cast<wchar_t *>(columns[i].title);
-                column.cx = columns[i].width;
-                ListView_InsertColumn(listView_, i, &column);
-            }
+                // Titles are string literals, so they are terminated.
+                column.pszText = const_cast<wchar_t *>(descriptor.title.data());
+                column.cx = descriptor.width;
+                ListView_InsertColumn(listView_, index++, &column);
+            };
+            rvrse::core::ForEachProcessColumn(insertColumn);
 
             columnsCreated_ = true;
         }
 
         void RefreshProcesses()
         {
-            snapshot_ = rvrse::core::ProcessSnapshot::Capture();
+            snapshot_ = rvrse::core::ProcessSnapshot::Capture({}, snapshot_);
             handleSnapshot_ = rvrse::core::HandleSnapshot::Capture();
             networkSnapshot_ = rvrse::core::NetworkSnapshot::Capture();
             UpdateResourceGraphs();
@@ -1474,13 +1526,22 @@ class ModuleViewerWindow
                 EnableWindow(connectionsButton_, !(networkSnapshot_.AccessDenied() || networkSnapshot_.CaptureFailed()));
             }
 
-            if (pluginLoader_)
+            if (pluginHost_)
+            {
+                pluginHost_->Publish(snapshot_, handleSnapshot_, networkSnapshot_, systemMetrics_);
+            }
+            else if (pluginLoader_)
             {
                 pluginLoader_->BroadcastProcessSnapshot(snapshot_);
                 pluginLoader_->BroadcastHandleSnapshot(handleSnapshot_);
+                pluginLoader_->BroadcastNetworkSnapshot(networkSnapshot_);
+                pluginLoader_->BroadcastSystemMetrics(systemMetrics_);
             }
 
-            ApplyFilterAndSort();
+            // Rows point into snapshot_; the view repairs the previous
+            // order instead of sorting copies again.
+            processView_.Update(snapshot_, std::chrono::steady_clock::now(), &handleSnapshot_, &networkSnapshot_);
+            PopulateList();
             UpdateDetailsPanel();
         }
 
@@ -1491,82 +1552,83 @@ class ModuleViewerWindow
                 return;
             }
 
-            ListView_DeleteAllItems(listView_);
+            // Items are updated in place: a list row filled from the same
+            // row hash and CPU figure as before keeps its text, so a refresh
+            // only rewrites the rows that changed or moved.
+            const int selected = ListView_GetNextItem(listView_, -1, LVNI_SELECTED);
+            const std::uint32_t selectedPid =
+                selected >= 0 && static_cast<std::size_t>(selected) < listRows_.size() ? listRows_[static_cast<std::size_t>(selected)].processId : 0;
 
-            for (int index = 0; index < static_cast<int>(visibleProcesses_.size()); ++index)
+            const auto &rows = processView_.Rows();
+            const int count = static_cast<int>(rows.size());
+            int existing = ListView_GetItemCount(listView_);
+            while (existing > count)
             {
-                const auto &process = visibleProcesses_[index];
-
-                std::wstring displayName = process.imageName.empty() ? L"[Unnamed]" : process.imageName;
-                LVITEMW item{};
-                item.mask = LVIF_TEXT;
-                item.iItem = index;
-                item.pszText = displayName.data();
-                ListView_InsertItem(listView_, &item);
-
-                wchar_t pidBuffer[32];
-                StringCchPrintfW(pidBuffer, std::size(pidBuffer), L"%u", process.processId);
-                ListView_SetItemText(listView_, index, 1, pidBuffer);
-
-                wchar_t threadBuffer[32];
-                StringCchPrintfW(threadBuffer, std::size(threadBuffer), L"%u", process.threadCount);
-                ListView_SetItemText(listView_, index, 2, threadBuffer);
-
-                std::wstring workingSet = rvrse::common::FormatSize(process.workingSetBytes);
-                ListView_SetItemText(listView_, index, 3, workingSet.data());
-
-                std::wstring privateBytes = rvrse::common::FormatSize(process.privateBytes);
-                ListView_SetItemText(listView_, index, 4, privateBytes.data());
+                ListView_DeleteItem(listView_, --existing);
             }
-        }
+            listRows_.resize(rows.size());
 
-        void UpdateResourceGraphs()
-        {
-            double memoryPercent = 0.0;
-            MEMORYSTATUSEX memoryStatus{};
-            memoryStatus.dwLength = sizeof(memoryStatus);
-            if (GlobalMemoryStatusEx(&memoryStatus) && memoryStatus.ullTotalPhys > 0)
+            for (int index = 0; index < count; ++index)
             {
-                unsigned __int64 used = memoryStatus.ullTotalPhys - memoryStatus.ullAvailPhys;
-                memoryPercent = (static_cast<double>(used) / static_cast<double>(memoryStatus.ullTotalPhys)) * 100.0;
+                const auto &row = rows[index];
+                const auto &process = *row.process;
+                ListRowState &state = listRows_[static_cast<std::size_t>(index)];
+
+                const wchar_t *displayName = process.imageName.empty() ? L"[Unnamed]" : process.imageName.c_str();
+                if (index >= existing)
+                {
+                    LVITEMW item{};
+                    item.mask = LVIF_TEXT;
+                    item.iItem = index;
+                    item.pszText = const_cast<wchar_t *>(displayName);
+                    ListView_InsertItem(listView_, &item);
+                }
+                else if (state.rowHash == row.rowHash && state.processId == process.processId &&
+                         state.cpuPercent == row.cpuPercent)
+                {
+                    continue;
+                }
+                else
+                {
+                    ListView_SetItemText(listView_, index, 0, const_cast<wchar_t *>(displayName));
+                }
+                state.processId = process.processId;
+                state.rowHash = row.rowHash;
+                state.cpuPercent = row.cpuPercent;
+
+                // Numbers are formatted into text; text columns are the
+                // entry's own terminated strings.
+                wchar_t buffer[rvrse::core::kProcessColumnTextCapacity];
+                for (std::size_t column = 1; column < rvrse::core::kProcessColumnCount; ++column)
+                {
+                    const std::wstring_view text =
+                        rvrse::core::FormatProcessColumn(process, static_cast<rvrse::core::ProcessSortColumn>(column), buffer);
+                    ListView_SetItemText(listView_, index, static_cast<int>(column), const_cast<wchar_t *>(text.data()));
+                }
             }
 
-            double cpuPercent = cpuUsagePercent_;
-            FILETIME idle{}, kernel{}, user{};
-            if (GetSystemTimes(&idle, &kernel, &user))
+            // The selection follows the process rather than the position,
+            // so a refresh never leaves a different process selected.
+            if (selected >= 0 && (selected >= count || listRows_[static_cast<std::size_t>(selected)].processId != selectedPid))
             {
-                ULARGE_INTEGER idle64{};
-                idle64.LowPart = idle.dwLowDateTime;
-                idle64.HighPart = idle.dwHighDateTime;
-
-                ULARGE_INTEGER kernel64{};
-                kernel64.LowPart = kernel.dwLowDateTime;
-                kernel64.HighPart = kernel.dwHighDateTime;
-
-                ULARGE_INTEGER user64{};
-                user64.LowPart = user.dwLowDateTime;
-                user64.HighPart = user.dwHighDateTime;
-
-                if (hasCpuBaseline_)
+                ListView_SetItemState(listView_, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+                for (int index = 0; index < count; ++index)
                 {
-                    ULONGLONG idleDelta = idle64.QuadPart - previousIdleTime_.QuadPart;
-                    ULONGLONG kernelDelta = kernel64.QuadPart - previousKernelTime_.QuadPart;
-                    ULONGLONG userDelta = user64.QuadPart - previousUserTime_.QuadPart;
-                    ULONGLONG total = kernelDelta + userDelta;
-                    if (total > 0 && idleDelta <= total)
+                    if (listRows_[static_cast<std::size_t>(index)].processId == selectedPid)
                     {
-                        cpuPercent = (static_cast<double>(total - idleDelta) / static_cast<double>(total)) * 100.0;
+                        ListView_SetItemState(listView_, index, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
+                        break;
                     }
                 }
-
-                previousIdleTime_ = idle64;
-                previousKernelTime_ = kernel64;
-                previousUserTime_ = user64;
-                hasCpuBaseline_ = true;
             }
+        }
 
-            cpuUsagePercent_ = std::clamp(cpuPercent, 0.0, 100.0);
-            memoryUsagePercent_ = std::clamp(memoryPercent, 0.0, 100.0);
+        void UpdateResourceGraphs()
+        {
+            systemMetrics_ = metricsSampler_.Sample(snapshot_, handleSnapshot_, networkSnapshot_);
+            metricsPublisher_.Publish(systemMetrics_);
+            cpuUsagePercent_ = systemMetrics_.cpuUsagePercent;
+            memoryUsagePercent_ = systemMetrics_.memoryUsagePercent;
             graphView_.AddSample(cpuUsagePercent_, memoryUsagePercent_);
         }
 
@@ -1663,15 +1725,15 @@ class ModuleViewerWindow
             {
                 filterText_.clear();
             }
-            ApplyFilterAndSort();
-            UpdateDetailsPanel();
-        }
 
-        void ApplyFilterAndSort()
-        {
-            BuildVisibleProcesses();
-            SortVisibleProcesses();
+            // While a query is half typed ("ws>"), keep listing what the
+            // last complete one matched and say why in the summary.
+            if (processView_.SetFilter(filterText_, filterError_))
+            {
+                filterError_.clear();
+            }
             PopulateList();
+            UpdateDetailsPanel();
         }
 
         void ClearFilter()
@@ -1680,110 +1742,13 @@ class ModuleViewerWindow
             {
                 SetWindowTextW(filterEdit_, L"");
                 filterText_.clear();
-                ApplyFilterAndSort();
+                processView_.SetFilter(filterText_, filterError_);
+                filterError_.clear();
+                PopulateList();
                 UpdateDetailsPanel();
             }
         }
 
-        void BuildVisibleProcesses()
-        {
-            visibleProcesses_.clear();
-            const auto &processes = snapshot_.Processes();
-
-            std::wstring trimmedFilter = TrimWhitespace(filterText_);
-            bool digitsOnly = !trimmedFilter.empty() &&
-                              std::all_of(trimmedFilter.begin(), trimmedFilter.end(),
-                                          [](wchar_t ch) { return std::iswdigit(ch); });
-
-            std::uint32_t pidFilter = 0;
-            if (digitsOnly && !trimmedFilter.empty())
-            {
-                pidFilter = static_cast<std::uint32_t>(std::wcstoul(trimmedFilter.c_str(), nullptr, 10));
-            }
-
-            std::wstring filterLower = (!digitsOnly && !trimmedFilter.empty()) ? ToLower(trimmedFilter) : std::wstring();
-
-            for (const auto &process : processes)
-            {
-                if (trimmedFilter.empty())
-                {
-                    visibleProcesses_.push_back(process);
-                }
-                else if (digitsOnly)
-                {
-                    if (process.processId == pidFilter)
-                    {
-                        visibleProcesses_.push_back(process);
-                    }
-                }
-                else
-                {
-                    std::wstring processNameLower = ToLower(process.imageName);
-                    if (processNameLower.find(filterLower) != std::wstring::npos)
-                    {
-                        visibleProcesses_.push_back(process);
-                    }
-                }
-            }
-        }
-
-        static std::wstring ToLower(const std::wstring &value)
-        {
-            std::wstring lower = value;
-            std::transform(lower.begin(), lower.end(), lower.begin(),
-                           [](wchar_t ch) { return static_cast<wchar_t>(std::towlower(ch)); });
-            return lower;
-        }
-
-        static std::wstring TrimWhitespace(const std::wstring &value)
-        {
-            auto begin = std::find_if_not(value.begin(), value.end(), [](wchar_t ch)
-                                          { return std::iswspace(ch); });
-            auto end = std::find_if_not(value.rbegin(), value.rend(), [](wchar_t ch)
-                                        { return std::iswspace(ch); })
-                           .base();
-            if (begin >= end)
-            {
-                return std::wstring();
-            }
-            return std::wstring(begin, end);
-        }
-
-        void SortVisibleProcesses()
-        {
-            auto comparator = [this](const rvrse::core::ProcessEntry &lhs, const rvrse::core::ProcessEntry &rhs)
-            {
-                auto compare = [this](const auto &a, const auto &b) -> int
-                {
-                    switch (sortColumn_)
-                    {
-                    case 0:
-                        return _wcsicmp(a.imageName.c_str(), b.imageName.c_str());
-                    case 1:
-                        return (a.processId < b.processId) ? -1 : (a.processId > b.processId ? 1 : 0);
-                    case 2:
-                        return (a.threadCount < b.threadCount) ? -1 : (a.threadCount > b.threadCount ? 1 : 0);
-                    case 3:
-                        return (a.workingSetBytes < b.workingSetBytes) ? -1 : (a.workingSetBytes > b.workingSetBytes ? 1 : 0);
-                    case 4:
-                        return (a.privateBytes < b.privateBytes) ? -1 : (a.privateBytes > b.privateBytes ? 1 : 0);
-                    default:
-                        return 0;
-                    }
-                };
-
-                int result = compare(lhs, rhs);
-                if (result == 0)
-                {
-                    result = lhs.processId < rhs.processId ? -1 : (lhs.processId > rhs.processId ? 1 : 0);
-                }
-
-                return sortAscending_ ? (result < 0) : (result > 0);
-            };
-
-            std::sort(visibleProcesses_.begin(), visibleProcesses_.end(), comparator);
-        }
-
         void OnColumnClick(int column)
         {
             if (column == sortColumn_)
@@ -1796,7 +1761,8 @@ class ModuleViewerWindow
                 sortAscending_ = true;
             }
 
-            SortVisibleProcesses();
+            // List view columns are in ProcessSortColumn order.
+            processView_.SetSort(static_cast<rvrse::core::ProcessSortColumn>(sortColumn_), sortAscending_);
             PopulateList();
         }
 
@@ -1815,9 +1781,9 @@ class ModuleViewerWindow
             }
 
             int selectedIndex = ListView_GetNextItem(listView_, -1, LVNI_SELECTED);
-            if (selectedIndex >= 0 && selectedIndex < static_cast<int>(visibleProcesses_.size()))
+            if (selectedIndex >= 0 && selectedIndex < static_cast<int>(processView_.Rows().size()))
             {
-                const auto &process = visibleProcesses_[selectedIndex];
+                const auto &process = *processView_.Rows()[selectedIndex].process;
                 SetWindowTextW(detailsStatic_, FormatProcessDetails(process).c_str());
             }
             else
@@ -1834,7 +1800,7 @@ class ModuleViewerWindow
             }
 
             int selectedIndex = ListView_GetNextItem(listView_, -1, LVNI_SELECTED);
-            if (selectedIndex < 0 || selectedIndex >= static_cast<int>(visibleProcesses_.size()))
+            if (selectedIndex < 0 || selectedIndex >= static_cast<int>(processView_.Rows().size()))
             {
                 MessageBoxW(hwnd_,
                             L"Select a process in the list before opening the module viewer.",
@@ -1843,7 +1809,7 @@ class ModuleViewerWindow
                 return;
             }
 
-            ModuleViewerWindow::Show(hwnd_, instance_, visibleProcesses_[selectedIndex]);
+            ModuleViewerWindow::Show(hwnd_, instance_, processView_.Ref(static_cast<std::size_t>(selectedIndex)));
         }
 
         void ShowConnectionsForSelection()
@@ -1854,7 +1820,7 @@ class ModuleViewerWindow
             }
 
             int selectedIndex = ListView_GetNextItem(listView_, -1, LVNI_SELECTED);
-            if (selectedIndex < 0 || selectedIndex >= static_cast<int>(visibleProcesses_.size()))
+            if (selectedIndex < 0 || selectedIndex >= static_cast<int>(processView_.Rows().size()))
             {
                 MessageBoxW(hwnd_,
                             L"Select a process in the list before opening the connection viewer.",
@@ -1882,7 +1848,7 @@ class ModuleViewerWindow
                 return;
             }
 
-            ConnectionViewerWindow::Show(hwnd_, instance_, visibleProcesses_[selectedIndex], networkSnapshot_);
+            ConnectionViewerWindow::Show(hwnd_, instance_, processView_.Ref(static_cast<std::size_t>(selectedIndex)), networkSnapshot_);
         }
 
         void OnListViewRightClick()
@@ -1893,7 +1859,7 @@ class ModuleViewerWindow
             }
 
             int selectedIndex = ListView_GetNextItem(listView_, -1, LVNI_SELECTED);
-            if (selectedIndex < 0 || selectedIndex >= static_cast<int>(visibleProcesses_.size()))
+            if (selectedIndex < 0 || selectedIndex >= static_cast<int>(processView_.Rows().size()))
             {
                 return;
             }
@@ -1912,11 +1878,12 @@ class ModuleViewerWindow
                 return;
             }
 
-            const auto &selectedProcess = visibleProcesses_[selectedIndex];
+            // Shares the generation: a refresh while the menu is open replaces the snapshot.
+            const rvrse::core::ProcessRef selectedProcess = processView_.Ref(static_cast<std::size_t>(selectedIndex));
             std::wstring menuText = L"Terminate Process";
-            if (!selectedProcess.imageName.empty())
+            if (!selectedProcess->imageName.empty())
             {
-                menuText = L"Terminate " + selectedProcess.imageName;
+                menuText = L"Terminate " + std::wstring(selectedProcess->imageName.View());
             }
 
             AppendMenuW(contextMenu, MF_STRING, kContextMenuTerminateProcess, menuText.c_str());
@@ -1940,7 +1907,7 @@ class ModuleViewerWindow
             }
 
             // Track which process was right-clicked
-            lastSelectedPid_ = selectedProcess.processId;
+            lastSelectedPid_ = selectedProcess->processId;
 
             // Show context menu
             int menuResult = TrackPopupMenu(
@@ -2030,7 +1997,7 @@ class ModuleViewerWindow
             // Check if process is protected
             for (const auto &protectedName : protectedProcesses)
             {
-                if (processEntry->imageName.find(protectedName) != std::wstring::npos)
+                if (processEntry->imageName.View().find(protectedName) != std::wstring_view::npos)
                 {
                     MessageBoxW(hwnd_,
                                 L"Cannot terminate system-protected process. Terminating this process would destabilize the system.",
@@ -2044,12 +2011,12 @@ class ModuleViewerWindow
             std::wstring confirmMsg = L"Are you sure you want to terminate ";
             if (terminateTree)
             {
-                confirmMsg += L"the process tree starting from \"" + processEntry->imageName + L"\" (PID " +
+                confirmMsg += L"the process tree starting from \"" + std::wstring(processEntry->imageName.View()) + L"\" (PID " +
                             std::to_wstring(processEntry->processId) + L") and all child processes?";
             }
             else
             {
-                confirmMsg += L"\"" + processEntry->imageName + L"\" (PID " +
+                confirmMsg += L"\"" + std::wstring(processEntry->imageName.View()) + L"\" (PID " +
                             std::to_wstring(processEntry->processId) + L")?";
             }
 
@@ -2455,14 +2422,9 @@ class ModuleViewerWindow
             ULONGLONG uptimeHours = (uptimeMs / (1000 * 60 * 60)) % 24;
             ULONGLONG uptimeMins = (uptimeMs / (1000 * 60)) % 60;
 
-            // Count total handles and threads
-            std::uint64_t totalHandles = 0;
-            std::uint64_t totalThreads = 0;
-            for (const auto &process : snapshot_.Processes())
-            {
-                totalHandles += handleSnapshot_.HandleCountForProcess(process.processId);
-                totalThreads += process.threadCount;
-            }
+            // Totals are computed once per refresh by the metrics sampler
+            std::uint64_t totalHandles = systemMetrics_.handleCount;
+            std::uint64_t totalThreads = systemMetrics_.threadCount;
 
             wchar_t buffer[512];
             StringCchPrintfW(buffer, std::size(buffer),
@@ -2482,14 +2444,8 @@ class ModuleViewerWindow
         std::wstring FormatSummaryDetails() const
         {
             const auto totalProcesses = snapshot_.Processes().size();
-            std::uint64_t totalThreads = 0;
-            std::uint64_t totalWorkingSet = 0;
-
-            for (const auto &process : snapshot_.Processes())
-            {
-                totalThreads += process.threadCount;
-                totalWorkingSet += process.workingSetBytes;
-            }
+            const std::uint64_t totalThreads = rvrse::core::SummarizeColumn(snapshot_.Arrays().threadCounts).sum;
+            const std::uint64_t totalWorkingSet = rvrse::core::SummarizeColumn(snapshot_.Arrays().workingSetBytes).sum;
 
             std::wstring workingSet = rvrse::common::FormatSize(totalWorkingSet);
             std::wstring connectionSummary;
@@ -2515,6 +2471,10 @@ class ModuleViewerWindow
                              connectionSummary.c_str(),
                              cpuUsagePercent_,
                              memoryUsagePercent_);
+            if (!filterError_.empty())
+            {
+                return std::wstring(buffer) + L" | Filter: " + filterError_;
+            }
             return buffer;
         }
 
@@ -2535,19 +2495,33 @@ class ModuleViewerWindow
         rvrse::core::ProcessSnapshot snapshot_;
         rvrse::core::HandleSnapshot handleSnapshot_;
         rvrse::core::NetworkSnapshot networkSnapshot_;
-        std::vector<rvrse::core::ProcessEntry> visibleProcesses_;
+        rvrse::core::ProcessView processView_;
+        // Folded names of snapshot_, so filter keystrokes do not refold them.
         std::wstring filterText_;
+        std::wstring filterError_;
         int sortColumn_ = 0;
         bool sortAscending_ = true;
+        // Declared before pluginLoader_ so plugins are unloaded before the registry and log go away.
+        rvrse::core::MetricsRegistry metricsRegistry_;
+        rvrse::common::LogWriter hostLog_;
+        rvrse::core::SystemMetricsPublisher metricsPublisher_{metricsRegistry_};
         std::unique_ptr<rvrse::core::PluginLoader> pluginLoader_;
+        std::unique_ptr<rvrse::core::OutOfProcessPluginHost> pluginHost_;
         ResourceGraphView graphView_;
+        rvrse::core::SystemMetricsSampler metricsSampler_;
+        rvrse::core::SystemMetrics systemMetrics_{};
         double cpuUsagePercent_ = 0.0;
         double memoryUsagePercent_ = 0.0;
-        ULARGE_INTEGER previousIdleTime_{};
-        ULARGE_INTEGER previousKernelTime_{};
-        ULARGE_INTEGER previousUserTime_{};
-        bool hasCpuBaseline_ = false;
         std::uint32_t lastSelectedPid_ = 0;
+
+        // What each process list item was last filled from, by item index.
+        struct ListRowState
+        {
+            std::uint32_t processId = 0;
+            std::uint64_t rowHash = 0;
+            double cpuPercent = 0.0;
+        };
+        std::vector<ListRowState> listRows_;
     };
 }
 
@@ -1,16 +1,20 @@
 #include "rvrse/common/formatting.h"
 
 #include <array>
-#include <cmath>
-#include <sstream>
-#include <iomanip>
+#include <charconv>
 
 namespace rvrse::common
 {
     std::wstring FormatSize(std::uint64_t bytes)
     {
-        static constexpr std::array<const wchar_t *, 5> kUnits = {
-            L"B", L"KB", L"MB", L"GB", L"TB"};
+        wchar_t buffer[kFormatSizeCapacity];
+        return std::wstring(FormatSize(bytes, buffer));
+    }
+
+    std::wstring_view FormatSize(std::uint64_t bytes, wchar_t (&buffer)[kFormatSizeCapacity])
+    {
+        static constexpr std::array<const char *, 5> kUnits = {
+            "B", "KB", "MB", "GB", "TB"};
 
         double value = static_cast<double>(bytes);
         size_t unitIndex = 0;
@@ -21,8 +25,26 @@ namespace rvrse::common
             ++unitIndex;
         }
 
-        std::wostringstream stream;
-        stream << std::fixed << std::setprecision(unitIndex == 0 ? 0 : 1) << value << L' ' << kUnits[unitIndex];
-        return stream.str();
+        // Below 1 KB the count is printed as is; above it, one decimal rounded
+        // like printf("%.1f"), which is what std::fixed/setprecision produced.
+        char text[kFormatSizeCapacity];
+        char *end = unitIndex == 0
+                        ? std::to_chars(text, text + sizeof(text), bytes).ptr
+                        : std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, 1).ptr;
+
+        std::size_t length = 0;
+        for (const char *digit = text; digit != end; ++digit)
+        {
+            buffer[length++] = static_cast<wchar_t>(*digit);
+        }
+
+        buffer[length++] = L' ';
+        for (const char *unit = kUnits[unitIndex]; *unit != '\0'; ++unit)
+        {
+            buffer[length++] = static_cast<wchar_t>(*unit);
+        }
+
+        buffer[length] = L'\0';
+        return std::wstring_view(buffer, length);
     }
 }
@@ -0,0 +1,454 @@
+#include "rvrse/common/log_writer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+    // Lines are appended to the batch until it reaches this size, then handed
+    // to the OS in one write.
+    constexpr std::size_t kBatchBytes = 64 * 1024;
+
+    // Per-cell string capacity reserved up front so typical lines never
+    // allocate on the producer side.
+    constexpr std::size_t kCellReserveBytes = 128;
+
+    void AppendUtf8(std::string &output, std::wstring_view input)
+    {
+        for (std::size_t index = 0; index < input.size(); ++index)
+        {
+            std::uint32_t codePoint = static_cast<std::uint32_t>(input[index]);
+
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && index + 1 < input.size())
+                {
+                    const auto low = static_cast<std::uint32_t>(input[index + 1]);
+                    if (low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        ++index;
+                    }
+                }
+            }
+
+            if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+            {
+                codePoint = 0xFFFD;
+            }
+
+            if (codePoint < 0x80)
+            {
+                output.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+    }
+
+    std::wstring RotatedPath(const std::wstring &path, unsigned int index)
+    {
+        return path + L"." + std::to_wstring(index);
+    }
+}
+
+namespace rvrse::common
+{
+    namespace fs = std::filesystem;
+
+    // Bounded MPSC queue cell (Vyukov). sequence == position: free for the
+    // producer claiming that position; position + 1: holds a line for the
+    // writer; position + capacity: released for the next lap.
+    struct LogWriter::Cell
+    {
+        std::atomic<std::uint64_t> sequence{0};
+        std::string text;
+    };
+
+    LogWriter::LogWriter() = default;
+
+    LogWriter::~LogWriter()
+    {
+        Close();
+    }
+
+    bool LogWriter::Open(LogWriterOptions options)
+    {
+        Close();
+
+        options_ = std::move(options);
+        if (options_.path.empty())
+        {
+            return false;
+        }
+
+        std::size_t capacity = 2;
+        while (capacity < options_.queueCapacity)
+        {
+            capacity <<= 1;
+        }
+
+        cells_ = std::make_unique<Cell[]>(capacity);
+        for (std::size_t index = 0; index < capacity; ++index)
+        {
+            cells_[index].sequence.store(index, std::memory_order_relaxed);
+            cells_[index].text.reserve(kCellReserveBytes);
+        }
+        mask_ = capacity - 1;
+        enqueuePosition_.store(0, std::memory_order_relaxed);
+        dequeuePosition_.store(0, std::memory_order_relaxed);
+
+        if (!OpenFile())
+        {
+            cells_.reset();
+            return false;
+        }
+
+        batch_.reserve(kBatchBytes + kCellReserveBytes);
+        flushTarget_ = 0;
+        flushedThrough_ = 0;
+        stopping_ = false;
+        writerExited_ = false;
+
+        running_.store(true, std::memory_order_release);
+        writer_ = std::thread(&LogWriter::WriterLoop, this);
+        return true;
+    }
+
+    void LogWriter::Close()
+    {
+        if (!running_.exchange(false, std::memory_order_seq_cst))
+        {
+            return;
+        }
+
+        // A producer that saw running_ before the exchange may still be
+        // about to claim a cell; every later one sees it cleared and leaves.
+        // Producers never block, so this wait is short.
+        while (producers_.load(std::memory_order_seq_cst) != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+
+        if (file_)
+        {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        cells_.reset();
+    }
+
+    bool LogWriter::Write(std::string_view line)
+    {
+        return Enqueue([line](std::string &text)
+                       {
+                           text.assign(line.data(), line.size());
+                       });
+    }
+
+    bool LogWriter::Write(std::wstring_view line)
+    {
+        return Enqueue([line](std::string &text)
+                       {
+                           text.clear();
+                           AppendUtf8(text, line);
+                       });
+    }
+
+    template <typename Fill>
+    bool LogWriter::Enqueue(Fill &&fill)
+    {
+        // Registered before the running check (both seq_cst, pairing with
+        // Close()), so Close() cannot miss a producer that got past it.
+        struct ProducerScope
+        {
+            std::atomic<std::uint32_t> &producers;
+            explicit ProducerScope(std::atomic<std::uint32_t> &counter) : producers(counter)
+            {
+                producers.fetch_add(1, std::memory_order_seq_cst);
+            }
+            ~ProducerScope() { producers.fetch_sub(1, std::memory_order_release); }
+        } scope(producers_);
+
+        if (!running_.load(std::memory_order_seq_cst))
+        {
+            return false;
+        }
+
+        Cell *cell = nullptr;
+        std::uint64_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &cells_[position & mask_];
+            const std::uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::int64_t>(sequence - position);
+            if (difference == 0)
+            {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Queue full: the writer is a full lap behind. Drop rather than block.
+                linesDropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(cell->text);
+        cell->sequence.store(position + 1, std::memory_order_release);
+
+        // Pairs with the fence in WriterLoop: either the writer sees this line
+        // before it sleeps, or this thread sees the sleeping flag and wakes it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writerSleeping_.load(std::memory_order_relaxed) && writerSleeping_.exchange(false, std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_.notify_one();
+        }
+        return true;
+    }
+
+    void LogWriter::Flush()
+    {
+        if (!running_.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        const std::uint64_t target = enqueuePosition_.load(std::memory_order_acquire);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (flushedThrough_ >= target)
+        {
+            return;
+        }
+
+        flushTarget_ = std::max(flushTarget_, target);
+        wake_.notify_one();
+        flushed_.wait(lock, [&]()
+                      {
+                          return flushedThrough_ >= target || writerExited_;
+                      });
+    }
+
+    void LogWriter::WriterLoop()
+    {
+        auto lastFlush = std::chrono::steady_clock::now();
+        bool dirty = false;
+
+        while (true)
+        {
+            if (DrainQueue())
+            {
+                dirty = true;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            const std::uint64_t drainedThrough = dequeuePosition_.load(std::memory_order_relaxed);
+            const bool flushRequested = flushTarget_ > flushedThrough_ && drainedThrough >= flushTarget_;
+            const auto now = std::chrono::steady_clock::now();
+
+            if (dirty && (flushRequested || stopping_ || now - lastFlush >= options_.flushInterval))
+            {
+                if (file_)
+                {
+                    std::fflush(file_);
+                }
+                dirty = false;
+                lastFlush = now;
+            }
+
+            if (flushRequested)
+            {
+                flushedThrough_ = drainedThrough;
+                flushed_.notify_all();
+            }
+
+            // Close() sets stopping_ only after every producer has left
+            // Enqueue(), so once the claimed positions are consumed nothing
+            // else can arrive.
+            if (stopping_ && drainedThrough == enqueuePosition_.load(std::memory_order_acquire))
+            {
+                writerExited_ = true;
+                flushedThrough_ = drainedThrough;
+                flushed_.notify_all();
+                break;
+            }
+
+            writerSleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (HasReadyLine())
+            {
+                writerSleeping_.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            // A claimed-but-unpublished line or pending flush only needs a short
+            // nap; otherwise sleep until woken or the idle flush is due.
+            const bool waitingOnProducer = drainedThrough != enqueuePosition_.load(std::memory_order_acquire) &&
+                                           (stopping_ || flushTarget_ > flushedThrough_);
+            const auto timeout = waitingOnProducer ? std::chrono::milliseconds(1) : options_.flushInterval;
+            wake_.wait_for(lock, timeout);
+            writerSleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool LogWriter::HasReadyLine() const
+    {
+        const std::uint64_t position = dequeuePosition_.load(std::memory_order_relaxed);
+        return cells_[position & mask_].sequence.load(std::memory_order_acquire) == position + 1;
+    }
+
+    bool LogWriter::DrainQueue()
+    {
+        std::uint64_t position = dequeuePosition_.load(std::memory_order_relaxed);
+        const std::uint64_t start = position;
+
+        while (true)
+        {
+            Cell &cell = cells_[position & mask_];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                break;
+            }
+
+            batch_.append(cell.text);
+            batch_.push_back('\n');
+            ++batchLines_;
+            cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+            ++position;
+
+            if (batch_.size() >= kBatchBytes)
+            {
+                WriteBatch();
+            }
+        }
+
+        WriteBatch();
+        dequeuePosition_.store(position, std::memory_order_release);
+        return position != start;
+    }
+
+    void LogWriter::WriteBatch()
+    {
+        if (batch_.empty())
+        {
+            return;
+        }
+
+        if (options_.maxFileBytes != 0 && fileBytes_ > 0 && fileBytes_ + batch_.size() > options_.maxFileBytes)
+        {
+            RotateFile();
+        }
+
+        if (file_)
+        {
+            const std::size_t written = std::fwrite(batch_.data(), 1, batch_.size(), file_);
+            fileBytes_ += written;
+            bytesWritten_.fetch_add(written, std::memory_order_relaxed);
+
+            // A short write (disk full, I/O error) loses the rest of the
+            // batch; only lines whose newline reached the file count as
+            // written. The stream stays open so later batches can retry.
+            std::uint64_t linesWritten = batchLines_;
+            if (written < batch_.size())
+            {
+                linesWritten = static_cast<std::uint64_t>(std::count(batch_.data(), batch_.data() + written, '\n'));
+                std::clearerr(file_);
+            }
+            linesWritten_.fetch_add(linesWritten, std::memory_order_relaxed);
+            linesDropped_.fetch_add(batchLines_ - linesWritten, std::memory_order_relaxed);
+        }
+        else
+        {
+            linesDropped_.fetch_add(batchLines_, std::memory_order_relaxed);
+        }
+
+        batch_.clear();
+        batchLines_ = 0;
+    }
+
+    bool LogWriter::OpenFile()
+    {
+#if defined(_WIN32)
+        if (_wfopen_s(&file_, options_.path.c_str(), L"ab") != 0)
+        {
+            file_ = nullptr;
+        }
+#else
+        file_ = std::fopen(fs::path(options_.path).string().c_str(), "ab");
+#endif
+        if (!file_)
+        {
+            return false;
+        }
+
+        // Batches are already large; skip the extra copy through stdio's buffer.
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+
+        std::error_code ec;
+        const auto size = fs::file_size(options_.path, ec);
+        fileBytes_ = ec ? 0 : static_cast<std::uint64_t>(size);
+        return true;
+    }
+
+    void LogWriter::RotateFile()
+    {
+        if (file_)
+        {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+
+        std::error_code ec;
+        if (options_.maxRotatedFiles == 0)
+        {
+            fs::remove(options_.path, ec);
+        }
+        else
+        {
+            fs::remove(RotatedPath(options_.path, options_.maxRotatedFiles), ec);
+            for (unsigned int index = options_.maxRotatedFiles - 1; index >= 1; --index)
+            {
+                fs::rename(RotatedPath(options_.path, index), RotatedPath(options_.path, index + 1), ec);
+            }
+            fs::rename(options_.path, RotatedPath(options_.path, 1), ec);
+        }
+
+        rotations_.fetch_add(1, std::memory_order_relaxed);
+        OpenFile();
+    }
+}
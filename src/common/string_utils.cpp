@@ -1,13 +1,259 @@
-#define NOMINMAX
-#include <windows.h>
-
 #include "rvrse/common/string_utils.h"
 
+#include <cstdint>
 #include <cwctype>
 #include <string_view>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RVRSE_STRING_UTILS_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace rvrse::common
 {
+    namespace
+    {
+        // Converts the ASCII prefix of input, stopping at the first non-ASCII
+        // byte or when output is full; returns how many bytes it converted.
+        std::size_t WidenAscii(const unsigned char *input, std::size_t size, wchar_t *output, std::size_t capacity)
+        {
+            const std::size_t limit = size < capacity ? size : capacity;
+            std::size_t index = 0;
+
+#if defined(__AVX2__)
+            for (; index + 32 <= limit; index += 32)
+            {
+                const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + index));
+                if (_mm256_movemask_epi8(chunk) != 0)
+                {
+                    break;
+                }
+
+                const __m128i low = _mm256_castsi256_si128(chunk);
+                const __m128i high = _mm256_extracti128_si256(chunk, 1);
+                auto *out = reinterpret_cast<__m256i *>(output + index);
+                if constexpr (sizeof(wchar_t) == 2)
+                {
+                    _mm256_storeu_si256(out, _mm256_cvtepu8_epi16(low));
+                    _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi16(high));
+                }
+                else
+                {
+                    _mm256_storeu_si256(out, _mm256_cvtepu8_epi32(low));
+                    _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+                    _mm256_storeu_si256(out + 2, _mm256_cvtepu8_epi32(high));
+                    _mm256_storeu_si256(out + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+                }
+            }
+#endif
+
+#if defined(RVRSE_STRING_UTILS_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (; index + 16 <= limit; index += 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + index));
+                if (_mm_movemask_epi8(chunk) != 0)
+                {
+                    break;
+                }
+
+                const __m128i low = _mm_unpacklo_epi8(chunk, zero);
+                const __m128i high = _mm_unpackhi_epi8(chunk, zero);
+                auto *out = reinterpret_cast<__m128i *>(output + index);
+                if constexpr (sizeof(wchar_t) == 2)
+                {
+                    _mm_storeu_si128(out, low);
+                    _mm_storeu_si128(out + 1, high);
+                }
+                else
+                {
+                    _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+                }
+            }
+#endif
+
+            for (; index < limit && input[index] < 0x80; ++index)
+            {
+                output[index] = static_cast<wchar_t>(input[index]);
+            }
+
+            return index;
+        }
+
+        // The WidenAscii() counterpart for wide input.
+        std::size_t NarrowAscii(const wchar_t *input, std::size_t size, char *output, std::size_t capacity)
+        {
+            const std::size_t limit = size < capacity ? size : capacity;
+            std::size_t index = 0;
+
+#if defined(__AVX2__)
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+                for (; index + 32 <= limit; index += 32)
+                {
+                    const auto *in = reinterpret_cast<const __m256i *>(input + index);
+                    const __m256i first = _mm256_loadu_si256(in);
+                    const __m256i second = _mm256_loadu_si256(in + 1);
+                    if (!_mm256_testz_si256(_mm256_or_si256(first, second), nonAscii))
+                    {
+                        break;
+                    }
+
+                    // packus works per 128-bit lane; put the quadwords back in order.
+                    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + index), packed);
+                }
+            }
+            else
+            {
+                const __m256i nonAscii = _mm256_set1_epi32(static_cast<int>(0xFFFFFF80));
+                const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+                for (; index + 32 <= limit; index += 32)
+                {
+                    const auto *in = reinterpret_cast<const __m256i *>(input + index);
+                    const __m256i a = _mm256_loadu_si256(in);
+                    const __m256i b = _mm256_loadu_si256(in + 1);
+                    const __m256i c = _mm256_loadu_si256(in + 2);
+                    const __m256i d = _mm256_loadu_si256(in + 3);
+                    if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)), nonAscii))
+                    {
+                        break;
+                    }
+
+                    const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + index), _mm256_permutevar8x32_epi32(packed, order));
+                }
+            }
+#endif
+
+#if defined(RVRSE_STRING_UTILS_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+                for (; index + 16 <= limit; index += 16)
+                {
+                    const auto *in = reinterpret_cast<const __m128i *>(input + index);
+                    const __m128i first = _mm_loadu_si128(in);
+                    const __m128i second = _mm_loadu_si128(in + 1);
+                    const __m128i high = _mm_and_si128(_mm_or_si128(first, second), nonAscii);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF)
+                    {
+                        break;
+                    }
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + index), _mm_packus_epi16(first, second));
+                }
+            }
+            else
+            {
+                const __m128i nonAscii = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+                for (; index + 16 <= limit; index += 16)
+                {
+                    const auto *in = reinterpret_cast<const __m128i *>(input + index);
+                    const __m128i a = _mm_loadu_si128(in);
+                    const __m128i b = _mm_loadu_si128(in + 1);
+                    const __m128i c = _mm_loadu_si128(in + 2);
+                    const __m128i d = _mm_loadu_si128(in + 3);
+                    const __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), nonAscii);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF)
+                    {
+                        break;
+                    }
+
+                    const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + index), packed);
+                }
+            }
+#endif
+
+            for (; index < limit && static_cast<std::uint32_t>(input[index]) < 0x80; ++index)
+            {
+                output[index] = static_cast<char>(input[index]);
+            }
+
+            return index;
+        }
+
+        // Length of the ASCII prefix of input.
+        std::size_t AsciiPrefix(const unsigned char *input, std::size_t size)
+        {
+            std::size_t index = 0;
+
+#if defined(RVRSE_STRING_UTILS_SSE2)
+            for (; index + 16 <= size; index += 16)
+            {
+                if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + index))) != 0)
+                {
+                    break;
+                }
+            }
+#endif
+
+            while (index < size && input[index] < 0x80)
+            {
+                ++index;
+            }
+            return index;
+        }
+
+        // Decodes one multi-byte sequence at input[0]. Rejects overlong forms,
+        // encoded surrogates, code points past U+10FFFF and truncation.
+        bool DecodeSequence(const unsigned char *input, std::size_t size, std::uint32_t &codePoint, std::size_t &length)
+        {
+            const unsigned char lead = input[0];
+            std::uint32_t minimum = 0;
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                length = 2;
+                minimum = 0x80;
+                codePoint = lead & 0x1F;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                length = 3;
+                minimum = 0x800;
+                codePoint = lead & 0x0F;
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                length = 4;
+                minimum = 0x10000;
+                codePoint = lead & 0x07;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (length > size)
+            {
+                return false;
+            }
+
+            for (std::size_t offset = 1; offset < length; ++offset)
+            {
+                const unsigned char next = input[offset];
+                if ((next & 0xC0) != 0x80)
+                {
+                    return false;
+                }
+
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+
+            return codePoint >= minimum && codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF);
+        }
+    }
+
     std::wstring TrimWhitespace(std::wstring_view input)
     {
         if (input.empty())
@@ -112,24 +358,14 @@ namespace rvrse::common
             return {};
         }
 
-        int length = MultiByteToWideChar(CP_UTF8,
-                                         MB_ERR_INVALID_CHARS,
-                                         input.data(),
-                                         static_cast<int>(input.size()),
-                                         nullptr,
-                                         0);
-        if (length <= 0)
+        std::wstring wide(input.size(), L'\0');
+        std::size_t written = 0;
+        if (!Utf8ToWide(input, wide.data(), wide.size(), written))
         {
             return {};
         }
 
-        std::wstring wide(length, L'\0');
-        MultiByteToWideChar(CP_UTF8,
-                            MB_ERR_INVALID_CHARS,
-                            input.data(),
-                            static_cast<int>(input.size()),
-                            wide.data(),
-                            length);
+        wide.resize(written);
         return wide;
     }
 
@@ -140,28 +376,165 @@ namespace rvrse::common
             return {};
         }
 
-        int length = WideCharToMultiByte(CP_UTF8,
-                                         WC_ERR_INVALID_CHARS,
-                                         input.data(),
-                                         static_cast<int>(input.size()),
-                                         nullptr,
-                                         0,
-                                         nullptr,
-                                         nullptr);
-        if (length <= 0)
+        std::string utf8(input.size() * kMaxUtf8BytesPerWideChar, '\0');
+        std::size_t written = 0;
+        if (!WideToUtf8(input, utf8.data(), utf8.size(), written))
         {
             return {};
         }
 
-        std::string utf8(length, '\0');
-        WideCharToMultiByte(CP_UTF8,
-                            WC_ERR_INVALID_CHARS,
-                            input.data(),
-                            static_cast<int>(input.size()),
-                            utf8.data(),
-                            length,
-                            nullptr,
-                            nullptr);
+        utf8.resize(written);
         return utf8;
     }
+
+    bool IsValidUtf8(std::string_view input)
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(input.data());
+        const std::size_t size = input.size();
+        std::size_t index = AsciiPrefix(bytes, size);
+        while (index < size)
+        {
+            std::uint32_t codePoint = 0;
+            std::size_t length = 0;
+            if (!DecodeSequence(bytes + index, size - index, codePoint, length))
+            {
+                return false;
+            }
+            index += length;
+            index += AsciiPrefix(bytes + index, size - index);
+        }
+        return true;
+    }
+
+    bool Utf8ToWide(std::string_view input, wchar_t *output, std::size_t capacity, std::size_t &written)
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(input.data());
+        const std::size_t size = input.size();
+        std::size_t index = 0;
+        written = 0;
+
+        while (index < size)
+        {
+            const std::size_t ascii = WidenAscii(bytes + index, size - index, output + written, capacity - written);
+            index += ascii;
+            written += ascii;
+            if (index == size)
+            {
+                break;
+            }
+
+            const unsigned char lead = bytes[index];
+            if (lead < 0x80)
+            {
+                // WidenAscii stopped because output is full.
+                return false;
+            }
+
+            std::uint32_t codePoint = 0;
+            std::size_t length = 0;
+            if (!DecodeSequence(bytes + index, size - index, codePoint, length))
+            {
+                return false;
+            }
+
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (codePoint >= 0x10000)
+                {
+                    if (capacity - written < 2)
+                    {
+                        return false;
+                    }
+
+                    codePoint -= 0x10000;
+                    output[written++] = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+                    output[written++] = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+                    index += length;
+                    continue;
+                }
+            }
+
+            if (written == capacity)
+            {
+                return false;
+            }
+
+            output[written++] = static_cast<wchar_t>(codePoint);
+            index += length;
+        }
+
+        return true;
+    }
+
+    bool WideToUtf8(std::wstring_view input, char *output, std::size_t capacity, std::size_t &written)
+    {
+        const wchar_t *units = input.data();
+        const std::size_t size = input.size();
+        std::size_t index = 0;
+        written = 0;
+
+        while (index < size)
+        {
+            const std::size_t ascii = NarrowAscii(units + index, size - index, output + written, capacity - written);
+            index += ascii;
+            written += ascii;
+            if (index == size)
+            {
+                break;
+            }
+
+            std::uint32_t codePoint = static_cast<std::uint32_t>(units[index]);
+            std::size_t consumed = 1;
+            if (codePoint < 0x80)
+            {
+                return false;
+            }
+
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF && sizeof(wchar_t) == 2 && index + 1 < size)
+            {
+                const auto low = static_cast<std::uint32_t>(units[index + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    consumed = 2;
+                }
+            }
+
+            if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+            {
+                return false;
+            }
+
+            const std::size_t length = codePoint < 0x800 ? 2 : (codePoint < 0x10000 ? 3 : 4);
+            if (capacity - written < length)
+            {
+                return false;
+            }
+
+            char *out = output + written;
+            if (length == 2)
+            {
+                out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+                out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (length == 3)
+            {
+                out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+                out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+                out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+
+            written += length;
+            index += consumed;
+        }
+
+        return true;
+    }
 }
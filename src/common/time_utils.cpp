@@ -1,13 +1,52 @@
 #include "rvrse/common/time_utils.h"
 
+#include <charconv>
 #include <chrono>
+#include <cstdint>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
 
 namespace rvrse::common
 {
+    namespace
+    {
+        // Appends value in decimal, zero-padded to at least width digits
+        // (like std::setfill('0') << std::setw(width)).
+        void AppendPadded(wchar_t *buffer, std::size_t &length, long long value, int width)
+        {
+            char digits[24];
+            char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            const char *begin = digits;
+            if (*begin == '-')
+            {
+                buffer[length++] = L'-';
+                ++begin;
+            }
+
+            for (int pad = width - static_cast<int>(end - begin); pad > 0; --pad)
+            {
+                buffer[length++] = L'0';
+            }
+
+            for (; begin != end; ++begin)
+            {
+                buffer[length++] = static_cast<wchar_t>(*begin);
+            }
+        }
+    }
+
     std::wstring FormatDuration(std::chrono::milliseconds duration)
+    {
+        wchar_t buffer[kFormatDurationCapacity];
+        return std::wstring(FormatDuration(duration, buffer));
+    }
+
+    std::wstring FormatTimestamp(std::chrono::system_clock::time_point timePoint)
+    {
+        wchar_t buffer[kFormatTimestampCapacity];
+        return std::wstring(FormatTimestamp(timePoint, buffer));
+    }
+
+    std::wstring_view FormatDuration(std::chrono::milliseconds duration, wchar_t (&buffer)[kFormatDurationCapacity])
     {
         using Rep = std::chrono::milliseconds::rep;
         Rep totalMs = duration.count();
@@ -26,21 +65,26 @@ namespace rvrse::common
         std::uint64_t seconds = magnitude / 1000ULL;
         std::uint64_t milliseconds = magnitude % 1000ULL;
 
-        std::wostringstream stream;
+        std::size_t length = 0;
         if (negative)
         {
-            stream << L"-";
+            buffer[length++] = L'-';
         }
 
-        stream << std::setfill(L'0') << std::setw(2) << hours << L":"
-               << std::setw(2) << minutes << L":"
-               << std::setw(2) << seconds << L"."
-               << std::setw(3) << milliseconds;
+        // At most 2^63 ms, so hours fit a long long.
+        AppendPadded(buffer, length, static_cast<long long>(hours), 2);
+        buffer[length++] = L':';
+        AppendPadded(buffer, length, static_cast<long long>(minutes), 2);
+        buffer[length++] = L':';
+        AppendPadded(buffer, length, static_cast<long long>(seconds), 2);
+        buffer[length++] = L'.';
+        AppendPadded(buffer, length, static_cast<long long>(milliseconds), 3);
 
-        return stream.str();
+        buffer[length] = L'\0';
+        return std::wstring_view(buffer, length);
     }
 
-    std::wstring FormatTimestamp(std::chrono::system_clock::time_point timePoint)
+    std::wstring_view FormatTimestamp(std::chrono::system_clock::time_point timePoint, wchar_t (&buffer)[kFormatTimestampCapacity])
     {
         using namespace std::chrono;
         auto timeT = system_clock::to_time_t(timePoint);
@@ -52,8 +96,22 @@ namespace rvrse::common
         gmtime_r(&timeT, &utc);
 #endif
 
-        std::wostringstream stream;
-        stream << std::put_time(&utc, L"%Y-%m-%d %H:%M:%S");
-        return stream.str();
+        // The fields of "%Y-%m-%d %H:%M:%S": the year unpadded, the rest two
+        // digits.
+        std::size_t length = 0;
+        AppendPadded(buffer, length, static_cast<long long>(utc.tm_year) + 1900, 1);
+        buffer[length++] = L'-';
+        AppendPadded(buffer, length, utc.tm_mon + 1, 2);
+        buffer[length++] = L'-';
+        AppendPadded(buffer, length, utc.tm_mday, 2);
+        buffer[length++] = L' ';
+        AppendPadded(buffer, length, utc.tm_hour, 2);
+        buffer[length++] = L':';
+        AppendPadded(buffer, length, utc.tm_min, 2);
+        buffer[length++] = L':';
+        AppendPadded(buffer, length, utc.tm_sec, 2);
+
+        buffer[length] = L'\0';
+        return std::wstring_view(buffer, length);
     }
 }
@@ -0,0 +1,203 @@
+#include "binary_codec.h"
+
+#include "rvrse/common/string_utils.h"
+
+namespace rvrse::core::codec
+{
+    void PutVarint(std::string &out, std::uint64_t value)
+    {
+        char bytes[10];
+        std::size_t count = 0;
+        while (value >= 0x80)
+        {
+            bytes[count++] = static_cast<char>(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        bytes[count++] = static_cast<char>(value);
+        out.append(bytes, count);
+    }
+
+    void PutSigned(std::string &out, std::int64_t value)
+    {
+        PutVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void PutDifference(std::string &out, std::uint64_t current, std::uint64_t previous)
+    {
+        PutSigned(out, static_cast<std::int64_t>(current - previous));
+    }
+
+    void PutFixed32(std::string &out, std::uint32_t value)
+    {
+        const char bytes[4] = {
+            static_cast<char>(value),
+            static_cast<char>(value >> 8),
+            static_cast<char>(value >> 16),
+            static_cast<char>(value >> 24)};
+        out.append(bytes, sizeof(bytes));
+    }
+
+    void PutFixed64(std::string &out, std::uint64_t value)
+    {
+        PutFixed32(out, static_cast<std::uint32_t>(value));
+        PutFixed32(out, static_cast<std::uint32_t>(value >> 32));
+    }
+
+    void PutDouble(std::string &out, double value)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        PutFixed64(out, bits);
+    }
+
+    void PatchFixed32(std::string &out, std::size_t offset, std::uint32_t value)
+    {
+        out[offset] = static_cast<char>(value);
+        out[offset + 1] = static_cast<char>(value >> 8);
+        out[offset + 2] = static_cast<char>(value >> 16);
+        out[offset + 3] = static_cast<char>(value >> 24);
+    }
+
+    void PutUtf8(std::string &out, std::wstring_view text)
+    {
+        // Valid text (nearly every name) takes the vectorized transcoder;
+        // the loop below only runs to replace invalid units.
+        const std::size_t start = out.size();
+        out.resize(start + text.size() * rvrse::common::kMaxUtf8BytesPerWideChar);
+        std::size_t written = 0;
+        if (rvrse::common::WideToUtf8(text, out.data() + start, out.size() - start, written))
+        {
+            out.resize(start + written);
+            return;
+        }
+        out.resize(start);
+
+        for (std::size_t index = 0; index < text.size(); ++index)
+        {
+            std::uint32_t codePoint = static_cast<std::uint32_t>(text[index]);
+            if (codePoint < 0x80)
+            {
+                out.push_back(static_cast<char>(codePoint));
+                continue;
+            }
+
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && index + 1 < text.size())
+                {
+                    const auto low = static_cast<std::uint32_t>(text[index + 1]);
+                    if (low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        ++index;
+                    }
+                }
+            }
+
+            if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+            {
+                codePoint = 0xFFFD;
+            }
+
+            if (codePoint < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+    }
+
+    std::wstring DecodeUtf8(const std::uint8_t *data, std::size_t size)
+    {
+        std::wstring text(size, L'\0');
+        std::size_t written = 0;
+        if (rvrse::common::Utf8ToWide(std::string_view(reinterpret_cast<const char *>(data), size), text.data(), size, written))
+        {
+            text.resize(written);
+            return text;
+        }
+        text.clear();
+
+        std::size_t index = 0;
+        while (index < size)
+        {
+            const std::uint8_t lead = data[index];
+            std::uint32_t codePoint = 0xFFFD;
+            std::size_t length = 1;
+
+            if (lead < 0x80)
+            {
+                codePoint = lead;
+            }
+            else
+            {
+                std::size_t expected = 0;
+                std::uint32_t minimum = 0;
+                if ((lead & 0xE0) == 0xC0)
+                {
+                    expected = 2;
+                    minimum = 0x80;
+                    codePoint = lead & 0x1F;
+                }
+                else if ((lead & 0xF0) == 0xE0)
+                {
+                    expected = 3;
+                    minimum = 0x800;
+                    codePoint = lead & 0x0F;
+                }
+                else if ((lead & 0xF8) == 0xF0)
+                {
+                    expected = 4;
+                    minimum = 0x10000;
+                    codePoint = lead & 0x07;
+                }
+
+                bool valid = expected != 0 && index + expected <= size;
+                for (std::size_t offset = 1; valid && offset < expected; ++offset)
+                {
+                    const std::uint8_t next = data[index + offset];
+                    valid = (next & 0xC0) == 0x80;
+                    codePoint = (codePoint << 6) | (next & 0x3F);
+                }
+
+                if (valid && codePoint >= minimum && codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF))
+                {
+                    length = expected;
+                }
+                else
+                {
+                    codePoint = 0xFFFD;
+                }
+            }
+
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (codePoint >= 0x10000)
+                {
+                    codePoint -= 0x10000;
+                    text.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                    text.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+                    index += length;
+                    continue;
+                }
+            }
+
+            text.push_back(static_cast<wchar_t>(codePoint));
+            index += length;
+        }
+        return text;
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace rvrse::core::codec
+{
+    // Building blocks of the binary formats (wire stream, recorded
+    // history): little-endian fixed-width integers, LEB128 varints, zigzag
+    // differences and UTF-8 text.
+
+    void PutVarint(std::string &out, std::uint64_t value);
+    void PutSigned(std::string &out, std::int64_t value);
+
+    // Difference of two unsigned readings, zigzag-encoded so that small
+    // decreases (a shrinking working set) stay small too.
+    void PutDifference(std::string &out, std::uint64_t current, std::uint64_t previous);
+
+    void PutFixed32(std::string &out, std::uint32_t value);
+    void PutFixed64(std::string &out, std::uint64_t value);
+    void PutDouble(std::string &out, double value);
+    void PatchFixed32(std::string &out, std::size_t offset, std::uint32_t value);
+
+    void PutUtf8(std::string &out, std::wstring_view text);
+
+    // Invalid sequences become U+FFFD rather than failing the frame; names
+    // are display data.
+    std::wstring DecodeUtf8(const std::uint8_t *data, std::size_t size);
+
+    // Bounds-checked cursor over a frame body. The first failed read marks
+    // it bad; callers check Ok() once at the end instead of after each field.
+    class Reader
+    {
+    public:
+        Reader(const std::uint8_t *data, std::size_t size) : cursor_(data), end_(data + size) {}
+
+        bool Ok() const { return ok_; }
+        void Fail() { ok_ = false; }
+        bool AtEnd() const { return cursor_ == end_; }
+        std::size_t Remaining() const { return static_cast<std::size_t>(end_ - cursor_); }
+
+        std::uint8_t Byte()
+        {
+            if (!ok_ || cursor_ == end_)
+            {
+                ok_ = false;
+                return 0;
+            }
+            return *cursor_++;
+        }
+
+        std::uint64_t Varint()
+        {
+            std::uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                const std::uint8_t byte = Byte();
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            ok_ = false;
+            return 0;
+        }
+
+        std::uint32_t Varint32()
+        {
+            const std::uint64_t value = Varint();
+            if (value > 0xFFFFFFFFULL)
+            {
+                ok_ = false;
+            }
+            return static_cast<std::uint32_t>(value);
+        }
+
+        std::int64_t Signed()
+        {
+            const std::uint64_t value = Varint();
+            return static_cast<std::int64_t>((value >> 1) ^ (0 - (value & 1)));
+        }
+
+        // Applies a PutDifference() value to the previous reading.
+        std::uint64_t Difference(std::uint64_t previous)
+        {
+            return previous + static_cast<std::uint64_t>(Signed());
+        }
+
+        std::uint32_t Fixed32()
+        {
+            const std::uint8_t *bytes = Take(4);
+            if (!bytes)
+            {
+                return 0;
+            }
+            return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+                   (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+        }
+
+        std::uint64_t Fixed64()
+        {
+            const std::uint64_t low = Fixed32();
+            return low | (static_cast<std::uint64_t>(Fixed32()) << 32);
+        }
+
+        double Double()
+        {
+            const std::uint64_t bits = Fixed64();
+            double value = 0.0;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        const std::uint8_t *Take(std::size_t size)
+        {
+            if (!ok_ || Remaining() < size)
+            {
+                ok_ = false;
+                return nullptr;
+            }
+            const std::uint8_t *data = cursor_;
+            cursor_ += size;
+            return data;
+        }
+
+        // Element counts are bounded by what could possibly follow, so a
+        // corrupt count cannot trigger a huge reserve().
+        std::size_t Count()
+        {
+            const std::uint64_t count = Varint();
+            if (count > Remaining())
+            {
+                ok_ = false;
+                return 0;
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+    private:
+        const std::uint8_t *cursor_;
+        const std::uint8_t *end_;
+        bool ok_ = true;
+    };
+}
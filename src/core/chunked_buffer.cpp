@@ -0,0 +1,72 @@
+#include "chunked_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rvrse::core
+{
+    char *ChunkedBuffer::ReserveInNextChunk(std::size_t sizeBytes)
+    {
+        if (chunks_.empty())
+        {
+            chunks_.push_back(Chunk{std::make_unique<char[]>(kChunkBytes), 0});
+            active_ = 0;
+        }
+
+        if (kChunkBytes - chunks_[active_].used < sizeBytes)
+        {
+            ++active_;
+            if (active_ == chunks_.size())
+            {
+                chunks_.push_back(Chunk{std::make_unique<char[]>(kChunkBytes), 0});
+            }
+            chunks_[active_].used = 0;
+        }
+
+        return chunks_[active_].data.get() + chunks_[active_].used;
+    }
+
+    void ChunkedBuffer::Append(const char *data, std::size_t sizeBytes)
+    {
+        while (sizeBytes > 0)
+        {
+            const std::size_t piece = std::min(sizeBytes, kChunkBytes);
+            std::memcpy(Reserve(piece), data, piece);
+            Commit(piece);
+            data += piece;
+            sizeBytes -= piece;
+        }
+    }
+
+    void ChunkedBuffer::Clear()
+    {
+        for (Chunk &chunk : chunks_)
+        {
+            chunk.used = 0;
+        }
+        active_ = 0;
+    }
+
+    std::size_t ChunkedBuffer::Size() const
+    {
+        std::size_t total = 0;
+        for (std::size_t index = 0; index < chunks_.size() && index <= active_; ++index)
+        {
+            total += chunks_[index].used;
+        }
+        return total;
+    }
+
+    bool ChunkedBuffer::WriteTo(OutputSink &sink) const
+    {
+        for (std::size_t index = 0; index < chunks_.size() && index <= active_; ++index)
+        {
+            const Chunk &chunk = chunks_[index];
+            if (chunk.used > 0 && !sink.Write(chunk.data.get(), chunk.used))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
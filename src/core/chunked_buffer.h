@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "output_sink.h"
+
+namespace rvrse::core
+{
+    // Append-only byte buffer made of fixed-size chunks. Growing never moves
+    // bytes already written, and Clear() keeps the chunks, so a buffer that
+    // is refilled every generation stops allocating after the first one.
+    class ChunkedBuffer
+    {
+    public:
+        static constexpr std::size_t kChunkBytes = 64 * 1024;
+
+        // Returns room for at least sizeBytes (<= kChunkBytes) contiguous
+        // bytes; Commit() says how many were used. Moving to a fresh chunk
+        // leaves the unused tail of the previous one empty.
+        char *Reserve(std::size_t sizeBytes)
+        {
+            if (!chunks_.empty() && kChunkBytes - chunks_[active_].used >= sizeBytes)
+            {
+                return chunks_[active_].data.get() + chunks_[active_].used;
+            }
+            return ReserveInNextChunk(sizeBytes);
+        }
+        void Commit(std::size_t sizeBytes) { chunks_[active_].used += sizeBytes; }
+
+        void Append(const char *data, std::size_t sizeBytes);
+        void Clear();
+
+        std::size_t Size() const;
+        bool Empty() const { return Size() == 0; }
+
+        // Hands each chunk to the sink in order; stops at the first failure.
+        bool WriteTo(OutputSink &sink) const;
+
+    private:
+        char *ReserveInNextChunk(std::size_t sizeBytes);
+
+        struct Chunk
+        {
+            std::unique_ptr<char[]> data;
+            std::size_t used = 0;
+        };
+
+        std::vector<Chunk> chunks_;
+        std::size_t active_ = 0;
+    };
+}
@@ -0,0 +1,371 @@
+#include "collector.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cwchar>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+#include "rvrse/common/formatting.h"
+
+namespace
+{
+    // Run() sleeps at most this long between stop checks.
+    constexpr std::chrono::milliseconds kStopPollInterval{200};
+
+    // Leaving the CPU backoff needs usage well under budget, so the cadence
+    // does not flap around the threshold.
+    constexpr double kBackoffReleaseRatio = 0.5;
+
+    std::wstring FormatPercent(double value)
+    {
+        wchar_t buffer[32];
+        std::swprintf(buffer, std::size(buffer), L"%.2f%%", value);
+        return buffer;
+    }
+}
+
+namespace rvrse::core
+{
+    Collector::Collector(CollectorConfig config)
+        : config_(std::move(config))
+    {
+        passesMetric_ = metricsRegistry_.Register(L"collector.passes", MetricKind::Counter);
+        passMillisecondsMetric_ = metricsRegistry_.Register(L"collector.pass_milliseconds", MetricKind::Gauge);
+        cpuMetric_ = metricsRegistry_.Register(L"collector.cpu_usage_percent", MetricKind::Gauge);
+        residentMetric_ = metricsRegistry_.Register(L"collector.resident_bytes", MetricKind::Gauge);
+        peakResidentMetric_ = metricsRegistry_.Register(L"collector.peak_resident_bytes", MetricKind::Gauge);
+        backoffMetric_ = metricsRegistry_.Register(L"collector.backoff_factor", MetricKind::Gauge);
+        internedStringsMetric_ = metricsRegistry_.Register(L"collector.interned_strings", MetricKind::Gauge);
+        internerRejectedMetric_ = metricsRegistry_.Register(L"collector.interner_rejected", MetricKind::Counter);
+        metricsRegistry_.Set(backoffMetric_, 1.0);
+    }
+
+    Collector::~Collector()
+    {
+        Stop();
+    }
+
+    bool Collector::Start()
+    {
+        if (started_)
+        {
+            return true;
+        }
+
+        if (!config_.logPath.empty())
+        {
+            rvrse::common::LogWriterOptions logOptions;
+            logOptions.path = config_.logPath;
+            if (!log_.Open(std::move(logOptions)))
+            {
+                LogLine(L"ERROR", L"Unable to open log " + config_.logPath);
+                return false;
+            }
+        }
+
+        if (config_.pluginsEnabled)
+        {
+            pluginLoader_ = config_.pluginDirectory.empty()
+                                ? std::make_unique<PluginLoader>()
+                                : std::make_unique<PluginLoader>(config_.pluginDirectory);
+            pluginLoader_->SetMetricsRegistry(&metricsRegistry_);
+            if (log_.IsOpen())
+            {
+                pluginLoader_->SetLogWriter(&log_);
+            }
+
+            if (config_.isolatePlugins)
+            {
+                const auto pluginPaths = pluginLoader_->DiscoverPluginPaths();
+                if (!pluginPaths.empty())
+                {
+                    pluginHost_ = std::make_unique<OutOfProcessPluginHost>();
+                    if (pluginHost_->Start(pluginPaths))
+                    {
+                        LogLine(L"INFO", L"Started " + std::to_wstring(pluginHost_->RunningHostCount()) + L" plugin host processes");
+                    }
+                    else
+                    {
+                        LogLine(L"WARNING", L"Out-of-process plugin hosts failed to start; continuing without plugins");
+                        pluginHost_.reset();
+                    }
+                }
+            }
+            else
+            {
+                pluginLoader_->LoadPlugins();
+                LogLine(L"INFO", L"Loaded " + std::to_wstring(pluginLoader_->PluginCount()) + L" plugins");
+            }
+        }
+
+        const auto now = Clock::now();
+        nextPass_ = now;
+        nextHandleCapture_ = now;
+        nextNetworkCapture_ = now;
+        nextSelfReport_ = now + config_.selfReportInterval;
+
+        // Baseline, so the first pass reports CPU used since Start().
+        selfSampler_.Sample();
+        started_ = true;
+
+        LogLine(L"INFO",
+                L"Collector started: process " + std::to_wstring(config_.processInterval.count()) +
+                    L" ms, handles " + std::to_wstring(config_.handleInterval.count()) +
+                    L" ms, network " + std::to_wstring(config_.networkInterval.count()) +
+                    L" ms, CPU budget " + FormatPercent(config_.cpuBudgetPercent) +
+                    L", memory budget " + rvrse::common::FormatSize(config_.memoryBudgetBytes));
+        return true;
+    }
+
+    void Collector::Stop()
+    {
+        if (!started_)
+        {
+            return;
+        }
+        started_ = false;
+
+        if (pluginHost_)
+        {
+            pluginHost_->Stop();
+            pluginHost_.reset();
+        }
+
+        if (pluginLoader_)
+        {
+            pluginLoader_->UnloadPlugins();
+            pluginLoader_.reset();
+        }
+
+        ReportSelfUsage(Clock::now());
+        LogLine(L"INFO", L"Collector stopped after " + std::to_wstring(generation_) + L" generations");
+        log_.Close();
+    }
+
+    void Collector::AddExporter(CollectorExporter *exporter)
+    {
+        if (exporter)
+        {
+            exporters_.push_back(exporter);
+        }
+    }
+
+    std::chrono::milliseconds Collector::Tick()
+    {
+        auto now = Clock::now();
+        if (started_ && now >= nextPass_)
+        {
+            RunPass(now);
+
+            // Keep the cadence anchored to the schedule, but never try to
+            // catch up on passes missed while a slow pass ran.
+            now = Clock::now();
+            nextPass_ = std::max(nextPass_ + Scaled(config_.processInterval), now);
+        }
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::max(nextPass_ - now, Clock::duration::zero()));
+    }
+
+    void Collector::Run(const std::atomic<bool> &stopRequested, std::uint64_t maxGenerations)
+    {
+        while (!stopRequested.load(std::memory_order_relaxed) && (maxGenerations == 0 || generation_ < maxGenerations))
+        {
+            const auto wait = Tick();
+            std::this_thread::sleep_for(std::min(wait, kStopPollInterval));
+        }
+    }
+
+    void Collector::RunPass(Clock::time_point now)
+    {
+        const auto passStart = Clock::now();
+
+        processes_ = ProcessSnapshot::Capture({}, processes_);
+
+        // Handle and network captures dominate both time and memory; they are
+        // suspended while the collector is over its memory budget.
+        bool handlesRefreshed = false;
+        if (config_.handleInterval.count() > 0 && !overMemoryBudget_ && now >= nextHandleCapture_)
+        {
+            handles_ = HandleSnapshot::Capture();
+            handlesRefreshed = true;
+            nextHandleCapture_ = now + Scaled(config_.handleInterval);
+        }
+
+        bool networkRefreshed = false;
+        if (config_.networkInterval.count() > 0 && !overMemoryBudget_ && now >= nextNetworkCapture_)
+        {
+            network_ = NetworkSnapshot::Capture();
+            networkRefreshed = true;
+            nextNetworkCapture_ = now + Scaled(config_.networkInterval);
+        }
+
+        systemMetrics_ = systemSampler_.Sample(processes_, handles_, network_);
+        systemPublisher_.Publish(systemMetrics_);
+
+        PublishToPlugins();
+
+        ++generation_;
+        metricsRegistry_.Add(passesMetric_, 1);
+
+        const CollectorFrame frame{generation_,
+                                   std::chrono::system_clock::now(),
+                                   processes_,
+                                   handles_,
+                                   network_,
+                                   systemMetrics_,
+                                   metricsRegistry_,
+                                   handlesRefreshed,
+                                   networkRefreshed};
+        for (CollectorExporter *exporter : exporters_)
+        {
+            exporter->Export(frame);
+        }
+
+        // Measured after the exporters so their cost counts as overhead too;
+        // exporters therefore see the previous pass's figures.
+        const auto passEnd = Clock::now();
+        metricsRegistry_.Set(passMillisecondsMetric_, std::chrono::duration<double, std::milli>(passEnd - passStart).count());
+
+        selfUsage_ = selfSampler_.Sample();
+        metricsRegistry_.Set(cpuMetric_, selfUsage_.cpuPercent);
+        metricsRegistry_.Set(residentMetric_, static_cast<double>(selfUsage_.residentBytes));
+        metricsRegistry_.Set(peakResidentMetric_, static_cast<double>(selfUsage_.peakResidentBytes));
+        ReportInterner();
+
+        // The first window only spans Start() to the end of this pass, so its
+        // CPU figure is meaningless for budgeting.
+        if (generation_ > 1)
+        {
+            ApplyBudgets();
+        }
+
+        if (config_.selfReportInterval.count() > 0 && passEnd >= nextSelfReport_)
+        {
+            ReportSelfUsage(passEnd);
+        }
+    }
+
+    void Collector::PublishToPlugins()
+    {
+        if (pluginHost_)
+        {
+            pluginHost_->Publish(processes_, handles_, network_, systemMetrics_);
+        }
+        else if (pluginLoader_)
+        {
+            pluginLoader_->BroadcastProcessSnapshot(processes_);
+            pluginLoader_->BroadcastHandleSnapshot(handles_);
+            pluginLoader_->BroadcastNetworkSnapshot(network_);
+            pluginLoader_->BroadcastSystemMetrics(systemMetrics_);
+        }
+    }
+
+    void Collector::ReportInterner()
+    {
+        const StringInterner &interner = StringInterner::Global();
+        metricsRegistry_.Set(internedStringsMetric_, static_cast<double>(interner.Size()));
+
+        const std::uint64_t rejected = interner.Rejected();
+        if (rejected == internerRejected_)
+        {
+            return;
+        }
+
+        // Once full, every new name is captured as empty; say so once.
+        if (internerRejected_ == 0)
+        {
+            LogLine(L"WARNING",
+                    L"String pool is full at " + std::to_wstring(interner.Size()) +
+                        L" strings; new process and module names are captured empty");
+        }
+        metricsRegistry_.Add(internerRejectedMetric_, rejected - internerRejected_);
+        internerRejected_ = rejected;
+    }
+
+    void Collector::ApplyBudgets()
+    {
+        if (config_.cpuBudgetPercent > 0.0)
+        {
+            const double cpuPercent = selfUsage_.cpuPercent;
+            if (cpuPercent > config_.cpuBudgetPercent && backoffFactor_ < kMaxBackoffFactor)
+            {
+                backoffFactor_ *= 2;
+                LogLine(L"WARNING",
+                        L"Collector CPU " + FormatPercent(cpuPercent) + L" exceeds budget " +
+                            FormatPercent(config_.cpuBudgetPercent) + L"; cadences stretched x" + std::to_wstring(backoffFactor_));
+            }
+            else if (cpuPercent < config_.cpuBudgetPercent * kBackoffReleaseRatio && backoffFactor_ > 1)
+            {
+                backoffFactor_ /= 2;
+                LogLine(L"INFO",
+                        L"Collector CPU " + FormatPercent(cpuPercent) + L" back under budget; cadences x" + std::to_wstring(backoffFactor_));
+            }
+            metricsRegistry_.Set(backoffMetric_, static_cast<double>(backoffFactor_));
+        }
+
+        if (config_.memoryBudgetBytes > 0)
+        {
+            const bool overBudget = selfUsage_.residentBytes > config_.memoryBudgetBytes;
+            if (overBudget != overMemoryBudget_)
+            {
+                overMemoryBudget_ = overBudget;
+                if (overBudget)
+                {
+                    // Drop the stale optional captures too, or suspending them frees nothing.
+                    handles_ = HandleSnapshot();
+                    network_ = NetworkSnapshot();
+                    LogLine(L"WARNING",
+                            L"Collector RSS " + rvrse::common::FormatSize(selfUsage_.residentBytes) + L" exceeds budget " +
+                                rvrse::common::FormatSize(config_.memoryBudgetBytes) + L"; handle and network captures suspended");
+                }
+                else
+                {
+                    LogLine(L"INFO",
+                            L"Collector RSS " + rvrse::common::FormatSize(selfUsage_.residentBytes) +
+                                L" back under budget; handle and network captures resumed");
+                }
+            }
+        }
+    }
+
+    void Collector::ReportSelfUsage(Clock::time_point now)
+    {
+        nextSelfReport_ = now + config_.selfReportInterval;
+
+        wchar_t passBuffer[32];
+        std::swprintf(passBuffer, std::size(passBuffer), L"%.2f ms", metricsRegistry_.Value(passMillisecondsMetric_));
+
+        LogLine(L"INFO",
+                L"Collector overhead: CPU " + FormatPercent(selfUsage_.cpuPercent) +
+                    L", RSS " + rvrse::common::FormatSize(selfUsage_.residentBytes) +
+                    L" (peak " + rvrse::common::FormatSize(selfUsage_.peakResidentBytes) +
+                    L"), last pass " + passBuffer +
+                    L", generation " + std::to_wstring(generation_) +
+                    L", backoff x" + std::to_wstring(backoffFactor_));
+    }
+
+    void Collector::LogLine(const wchar_t *level, const std::wstring &message)
+    {
+        std::wstring line = L"[";
+        line += level;
+        line += L"] ";
+        line += message;
+
+        if (log_.IsOpen())
+        {
+            log_.Write(line);
+        }
+        else
+        {
+            line.push_back(L'\n');
+            std::fputws(line.c_str(), stderr);
+        }
+    }
+
+    std::chrono::milliseconds Collector::Scaled(std::chrono::milliseconds interval) const
+    {
+        return interval * backoffFactor_;
+    }
+}
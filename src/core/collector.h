@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "collector_config.h"
+#include "handle_snapshot.h"
+#include "metrics_registry.h"
+#include "network_snapshot.h"
+#include "out_of_process_plugin_host.h"
+#include "plugin_loader.h"
+#include "process_snapshot.h"
+#include "self_usage.h"
+#include "system_metrics.h"
+#include "rvrse/common/log_writer.h"
+
+namespace rvrse::core
+{
+    // One sampling pass as handed to exporters. Handle and network snapshots
+    // are refreshed on their own (slower) cadences; the flags say whether
+    // this generation carries a fresh capture or the previous one.
+    struct CollectorFrame
+    {
+        std::uint64_t generation = 0;
+        std::chrono::system_clock::time_point timestamp;
+        const ProcessSnapshot &processes;
+        const HandleSnapshot &handles;
+        const NetworkSnapshot &network;
+        const SystemMetrics &metrics;
+        const MetricsRegistry &registry;
+        bool handlesRefreshed = false;
+        bool networkRefreshed = false;
+    };
+
+    // Receives every generation on the sampling thread. Implementations must
+    // not block; anything slow (sockets, disk) belongs on their own thread.
+    class CollectorExporter
+    {
+    public:
+        virtual ~CollectorExporter() = default;
+
+        virtual const wchar_t *Name() const = 0;
+        virtual void Export(const CollectorFrame &frame) = 0;
+    };
+
+    // Headless sampling loop shared by rvrse-agent: captures snapshots at the
+    // configured cadences, feeds plugins and exporters, and keeps its own
+    // CPU/RSS overhead inside the configured budgets.
+    //
+    // Publishes built-in "collector.*" metrics next to the "system.*" ones.
+    class Collector
+    {
+    public:
+        // Upper bound on how far the CPU budget may stretch the cadences.
+        static constexpr std::uint32_t kMaxBackoffFactor = 8;
+
+        explicit Collector(CollectorConfig config);
+        ~Collector();
+
+        Collector(const Collector &) = delete;
+        Collector &operator=(const Collector &) = delete;
+
+        // Opens the log and loads plugins. Plugin failures are logged, not fatal.
+        bool Start();
+        void Stop();
+
+        // Non-owning; exporters must outlive Stop().
+        void AddExporter(CollectorExporter *exporter);
+
+        // Runs a pass if one is due and returns the time until the next one.
+        std::chrono::milliseconds Tick();
+
+        // Calls Tick() until stopRequested is set or, when maxGenerations is
+        // nonzero, that many generations have run. Sleeps in short slices so
+        // a stop request is noticed promptly even with long cadences.
+        void Run(const std::atomic<bool> &stopRequested, std::uint64_t maxGenerations = 0);
+
+        std::uint64_t Generation() const { return generation_; }
+        std::uint32_t BackoffFactor() const { return backoffFactor_; }
+        bool OverMemoryBudget() const { return overMemoryBudget_; }
+        const SelfUsage &LastSelfUsage() const { return selfUsage_; }
+
+        const CollectorConfig &Config() const { return config_; }
+        MetricsRegistry &Metrics() { return metricsRegistry_; }
+        rvrse::common::LogWriter &Log() { return log_; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void RunPass(Clock::time_point now);
+        void PublishToPlugins();
+        void ApplyBudgets();
+        void ReportInterner();
+        void ReportSelfUsage(Clock::time_point now);
+        void LogLine(const wchar_t *level, const std::wstring &message);
+
+        std::chrono::milliseconds Scaled(std::chrono::milliseconds interval) const;
+
+        CollectorConfig config_;
+
+        // Outlive the plugin hosts below, which log and publish metrics until unloaded.
+        rvrse::common::LogWriter log_;
+        MetricsRegistry metricsRegistry_;
+        SystemMetricsPublisher systemPublisher_{metricsRegistry_};
+        std::unique_ptr<PluginLoader> pluginLoader_;
+        std::unique_ptr<OutOfProcessPluginHost> pluginHost_;
+        std::vector<CollectorExporter *> exporters_;
+
+        ProcessSnapshot processes_;
+        HandleSnapshot handles_;
+        NetworkSnapshot network_;
+        SystemMetrics systemMetrics_{};
+        SystemMetricsSampler systemSampler_;
+        SelfUsageSampler selfSampler_;
+        SelfUsage selfUsage_{};
+
+        std::uint64_t generation_ = 0;
+        std::uint64_t internerRejected_ = 0;
+        std::uint32_t backoffFactor_ = 1;
+        bool overMemoryBudget_ = false;
+        bool started_ = false;
+
+        Clock::time_point nextPass_{};
+        Clock::time_point nextHandleCapture_{};
+        Clock::time_point nextNetworkCapture_{};
+        Clock::time_point nextSelfReport_{};
+
+        std::uint32_t passesMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t passMillisecondsMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t cpuMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t residentMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t peakResidentMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t backoffMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t internedStringsMetric_ = MetricsRegistry::kInvalidHandle;
+        std::uint32_t internerRejectedMetric_ = MetricsRegistry::kInvalidHandle;
+    };
+}
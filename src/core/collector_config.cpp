@@ -0,0 +1,341 @@
+#include "collector_config.h"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+#include "socket.h"
+
+namespace
+{
+    std::string_view Trim(std::string_view text)
+    {
+        const char *kWhitespace = " \t\r\n";
+        const std::size_t first = text.find_first_not_of(kWhitespace);
+        if (first == std::string_view::npos)
+        {
+            return {};
+        }
+        const std::size_t last = text.find_last_not_of(kWhitespace);
+        return text.substr(first, last - first + 1);
+    }
+
+    std::wstring Widen(std::string_view text)
+    {
+        return std::wstring(text.begin(), text.end());
+    }
+
+    bool ParseMilliseconds(std::string_view value, std::chrono::milliseconds &out)
+    {
+        std::uint64_t count = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), count);
+        if (ec != std::errc() || ptr != value.data() + value.size())
+        {
+            return false;
+        }
+        out = std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(count));
+        return true;
+    }
+
+    bool ParseUnsigned(std::string_view value, std::uint64_t &out)
+    {
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+        return ec == std::errc() && ptr == value.data() + value.size();
+    }
+
+    // std::from_chars for floating point is not available on every standard
+    // library we build with; istringstream in the classic locale is.
+    bool ParseDouble(std::string_view value, double &out)
+    {
+        std::istringstream stream{std::string(value)};
+        stream.imbue(std::locale::classic());
+        stream >> out;
+        return !stream.fail() && stream.peek() == std::char_traits<char>::eof() && out >= 0.0;
+    }
+
+    bool ParseBool(std::string_view value, bool &out)
+    {
+        if (value == "true" || value == "yes" || value == "on" || value == "1")
+        {
+            out = true;
+            return true;
+        }
+        if (value == "false" || value == "no" || value == "off" || value == "0")
+        {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParsePath(std::string_view value, std::wstring &out)
+    {
+        try
+        {
+            out = std::filesystem::u8path(value.begin(), value.end()).wstring();
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+    }
+
+    std::vector<std::wstring> SplitList(std::string_view value)
+    {
+        std::vector<std::wstring> items;
+        while (!value.empty())
+        {
+            const std::size_t comma = value.find(',');
+            const std::string_view item = Trim(value.substr(0, comma));
+            if (!item.empty())
+            {
+                items.push_back(Widen(item));
+            }
+            value.remove_prefix(comma == std::string_view::npos ? value.size() : comma + 1);
+        }
+        return items;
+    }
+
+    using CollectorConfig = rvrse::core::CollectorConfig;
+    using SocketEndpoint = rvrse::core::SocketEndpoint;
+
+    struct Setting
+    {
+        std::string_view key;
+        bool (*apply)(std::string_view value, CollectorConfig &config);
+    };
+
+    constexpr Setting kSettings[] = {
+        {"process_interval_ms", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParseMilliseconds(value, config.processInterval) && config.processInterval.count() > 0;
+         }},
+        {"handle_interval_ms", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParseMilliseconds(value, config.handleInterval);
+         }},
+        {"network_interval_ms", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParseMilliseconds(value, config.networkInterval);
+         }},
+        {"self_report_interval_ms", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParseMilliseconds(value, config.selfReportInterval);
+         }},
+        {"cpu_budget_percent", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParseDouble(value, config.cpuBudgetPercent);
+         }},
+        {"memory_budget_mb", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t megabytes = 0;
+             if (!ParseUnsigned(value, megabytes))
+             {
+                 return false;
+             }
+             config.memoryBudgetBytes = megabytes * 1024ULL * 1024ULL;
+             return true;
+         }},
+        {"plugins", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParseBool(value, config.pluginsEnabled);
+         }},
+        {"plugin_isolation", [](std::string_view value, CollectorConfig &config)
+         {
+             if (value != "process" && value != "in-process")
+             {
+                 return false;
+             }
+             config.isolatePlugins = value == "process";
+             return true;
+         }},
+        {"plugin_directory", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParsePath(value, config.pluginDirectory);
+         }},
+        {"log_path", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParsePath(value, config.logPath);
+         }},
+        {"exporters", [](std::string_view value, CollectorConfig &config)
+         {
+             config.exporters = SplitList(value);
+             return true;
+         }},
+        {"openmetrics_address", [](std::string_view value, CollectorConfig &config)
+         {
+             config.openMetricsAddress = std::string(value);
+             return !value.empty();
+         }},
+        {"openmetrics_port", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t port = 0;
+             if (!ParseUnsigned(value, port) || port > 0xFFFF)
+             {
+                 return false;
+             }
+             config.openMetricsPort = static_cast<std::uint16_t>(port);
+             return true;
+         }},
+        {"openmetrics_top_processes", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t count = 0;
+             if (!ParseUnsigned(value, count) || count > 0xFFFFFFFFULL)
+             {
+                 return false;
+             }
+             config.openMetricsTopProcesses = static_cast<std::uint32_t>(count);
+             return true;
+         }},
+        {"ndjson_target", [](std::string_view value, CollectorConfig &config)
+         {
+             return !value.empty() && ParsePath(value, config.ndjsonTarget);
+         }},
+        {"ndjson_keyframe_interval", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t interval = 0;
+             if (!ParseUnsigned(value, interval) || interval == 0 || interval > 0xFFFFFFFFULL)
+             {
+                 return false;
+             }
+             config.ndjsonKeyframeInterval = static_cast<std::uint32_t>(interval);
+             return true;
+         }},
+        {"wire_listen", [](std::string_view value, CollectorConfig &config)
+         {
+             SocketEndpoint endpoint;
+             return ParsePath(value, config.wireListen) && ParseSocketEndpoint(config.wireListen, endpoint);
+         }},
+        {"wire_keyframe_interval", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t interval = 0;
+             if (!ParseUnsigned(value, interval) || interval == 0 || interval > 0xFFFFFFFFULL)
+             {
+                 return false;
+             }
+             config.wireKeyframeInterval = static_cast<std::uint32_t>(interval);
+             return true;
+         }},
+        {"wire_push", [](std::string_view value, CollectorConfig &config)
+         {
+             SocketEndpoint endpoint;
+             if (value.empty())
+             {
+                 config.wirePush.clear();
+                 return true;
+             }
+             return ParsePath(value, config.wirePush) && ParseSocketEndpoint(config.wirePush, endpoint) &&
+                    (endpoint.kind == SocketEndpoint::Kind::Unix || endpoint.port != 0);
+         }},
+        {"wire_host_name", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParsePath(value, config.wireHostName);
+         }},
+        {"history_path", [](std::string_view value, CollectorConfig &config)
+         {
+             return ParsePath(value, config.historyPath);
+         }},
+        {"history_keyframe_interval", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t interval = 0;
+             if (!ParseUnsigned(value, interval) || interval == 0 || interval > 0xFFFFFFFFULL)
+             {
+                 return false;
+             }
+             config.historyKeyframeInterval = static_cast<std::uint32_t>(interval);
+             return true;
+         }},
+        {"history_retention_hours", [](std::string_view value, CollectorConfig &config)
+         {
+             std::uint64_t hours = 0;
+             if (!ParseUnsigned(value, hours) || hours > 0xFFFFFFFFULL)
+             {
+                 return false;
+             }
+             config.historyRetentionHours = static_cast<std::uint32_t>(hours);
+             return true;
+         }},
+    };
+
+    const Setting *FindSetting(std::string_view key)
+    {
+        for (const Setting &setting : kSettings)
+        {
+            if (setting.key == key)
+            {
+                return &setting;
+            }
+        }
+        return nullptr;
+    }
+}
+
+namespace rvrse::core
+{
+    bool ParseCollectorConfig(std::string_view text, CollectorConfig &config, std::wstring &error)
+    {
+        // Skip a UTF-8 BOM left by Windows editors.
+        if (text.size() >= 3 && text.substr(0, 3) == "\xEF\xBB\xBF")
+        {
+            text.remove_prefix(3);
+        }
+
+        std::size_t lineNumber = 0;
+        while (!text.empty())
+        {
+            ++lineNumber;
+            const std::size_t lineEnd = text.find('\n');
+            std::string_view line = text.substr(0, lineEnd);
+            text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+            // Whole-line comments only, so values (paths) may contain '#' or ';'.
+            line = Trim(line);
+            if (line.empty() || line.front() == '#' || line.front() == ';')
+            {
+                continue;
+            }
+
+            const std::size_t equals = line.find('=');
+            const std::string_view key = Trim(line.substr(0, equals));
+            const std::string_view value = equals == std::string_view::npos ? std::string_view{} : Trim(line.substr(equals + 1));
+
+            if (equals == std::string_view::npos || key.empty())
+            {
+                error = L"line " + std::to_wstring(lineNumber) + L": expected key = value";
+                return false;
+            }
+
+            const Setting *setting = FindSetting(key);
+            if (!setting)
+            {
+                error = L"line " + std::to_wstring(lineNumber) + L": unknown key '" + Widen(key) + L"'";
+                return false;
+            }
+
+            if (!setting->apply(value, config))
+            {
+                error = L"line " + std::to_wstring(lineNumber) + L": invalid value for '" + Widen(key) + L"'";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool LoadCollectorConfig(const std::wstring &path, CollectorConfig &config, std::wstring &error)
+    {
+        std::ifstream file(std::filesystem::path(path), std::ios::binary);
+        if (!file)
+        {
+            error = L"unable to open " + path;
+            return false;
+        }
+
+        const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return ParseCollectorConfig(contents, config, error);
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rvrse::core
+{
+    // Cadences and budgets for the headless collector (rvrse-agent). Loaded
+    // from a "key = value" file; see docs/headless-agent.md for the key reference.
+    struct CollectorConfig
+    {
+        // Process snapshot + system metrics cadence; every pass is one generation.
+        std::chrono::milliseconds processInterval{1000};
+
+        // Slower cadences for the expensive captures; 0 disables the capture.
+        std::chrono::milliseconds handleInterval{5000};
+        std::chrono::milliseconds networkInterval{5000};
+
+        // How often the collector logs its own CPU/RSS overhead (0 disables).
+        std::chrono::milliseconds selfReportInterval{60000};
+
+        // Overhead budgets; 0 disables the check. Exceeding the CPU budget
+        // stretches every cadence (up to Collector::kMaxBackoffFactor);
+        // exceeding the memory budget suspends handle and network captures.
+        double cpuBudgetPercent = 2.0;
+        std::uint64_t memoryBudgetBytes = 256ULL * 1024ULL * 1024ULL;
+
+        bool pluginsEnabled = true;
+        bool isolatePlugins = false;
+
+        // Empty selects the PluginLoader default (plugins/ next to the executable).
+        std::wstring pluginDirectory;
+
+        // Empty disables the collector's log.
+        std::wstring logPath;
+
+        // Exporter names, resolved by the embedding executable.
+        std::vector<std::wstring> exporters;
+
+        // "openmetrics" exporter: listen address (numeric) and port, and how
+        // many processes get their own series (0 = all).
+        std::string openMetricsAddress = "127.0.0.1";
+        std::uint16_t openMetricsPort = 9464;
+        std::uint32_t openMetricsTopProcesses = 50;
+
+        // "ndjson" exporter: "-" (stdout), a file or pipe path, or a
+        // "tcp://address:port" / "unix:/path" socket; and how often a full
+        // snapshot is written.
+        std::wstring ndjsonTarget = L"-";
+        std::uint32_t ndjsonKeyframeInterval = 60;
+
+        // "wire" exporter: "tcp://address:port" or "unix:/path" to listen
+        // on, and the most frames between keyframes. A non-empty wirePush
+        // streams to that endpoint (a fleet aggregator) instead of
+        // listening; wireHostName names this collector there (empty uses
+        // the machine's host name).
+        std::wstring wireListen = L"tcp://127.0.0.1:9465";
+        std::uint32_t wireKeyframeInterval = 60;
+        std::wstring wirePush;
+        std::wstring wireHostName;
+
+        // "history" exporter: directory of the hourly segments (empty uses
+        // history/ next to the executable), how often a full snapshot is
+        // written, and how many hours are kept (0 = all).
+        std::wstring historyPath;
+        std::uint32_t historyKeyframeInterval = 60;
+        std::uint32_t historyRetentionHours = 72;
+    };
+
+    // Parses "key = value" lines into config, leaving unspecified keys at
+    // their current values. Lines starting with '#' or ';' are comments.
+    // Unknown keys and malformed values fail with a "line N: ..." message.
+    bool ParseCollectorConfig(std::string_view text, CollectorConfig &config, std::wstring &error);
+
+    bool LoadCollectorConfig(const std::wstring &path, CollectorConfig &config, std::wstring &error);
+}
@@ -0,0 +1,313 @@
+#include "column_reduce.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RVRSE_COLUMN_REDUCE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using rvrse::core::ColumnSummary;
+
+    // TopColumnIndices() candidate buffer, in multiples of k.
+    constexpr std::size_t kTopBufferFactor = 4;
+    constexpr std::size_t kTopBufferMinimum = 256;
+
+    // The scalar pass, and all of it for 64-bit columns without AVX2:
+    // SSE2 has no 64-bit compare, and emulating one costs more than cmov.
+    template <typename T>
+    void FoldInto(ColumnSummary &summary, const T *values, std::size_t count)
+    {
+        std::uint64_t sum = 0;
+        std::uint64_t low = summary.min;
+        std::uint64_t high = summary.max;
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const std::uint64_t value = values[index];
+            sum += value;
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        summary.sum += sum;
+        summary.min = low;
+        summary.max = high;
+    }
+
+#if defined(RVRSE_COLUMN_REDUCE_SSE2)
+    __m128i Select128(__m128i mask, __m128i ifTrue, __m128i ifFalse)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, ifTrue), _mm_andnot_si128(mask, ifFalse));
+    }
+
+    // All-ones 32-bit lanes where the four flags at selected are zero.
+    __m128i UnselectedMask32(const std::uint8_t *selected)
+    {
+        int flags = 0;
+        std::memcpy(&flags, selected, sizeof(flags));
+        const __m128i bytes = _mm_cmpeq_epi8(_mm_cvtsi32_si128(flags), _mm_setzero_si128());
+        const __m128i words = _mm_unpacklo_epi8(bytes, bytes);
+        return _mm_unpacklo_epi16(words, words);
+    }
+#endif
+
+#if defined(__AVX2__)
+    __m256i GreaterU64x4(__m256i lhs, __m256i rhs)
+    {
+        const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(lhs, sign), _mm256_xor_si256(rhs, sign));
+    }
+#endif
+}
+
+namespace rvrse::core
+{
+    ColumnSummary SummarizeColumn(const std::vector<std::uint32_t> &values)
+    {
+        ColumnSummary summary;
+        if (values.empty())
+        {
+            return summary;
+        }
+
+        const std::uint32_t *data = values.data();
+        const std::size_t count = values.size();
+        summary.min = data[0];
+        summary.max = data[0];
+        std::size_t index = 0;
+
+#if defined(__AVX2__)
+        if (count >= 8)
+        {
+            __m256i sums = _mm256_setzero_si256();
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+            __m256i high = low;
+            for (; index + 8 <= count; index += 8)
+            {
+                const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + index));
+                sums = _mm256_add_epi64(sums, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(block)));
+                sums = _mm256_add_epi64(sums, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(block, 1)));
+                low = _mm256_min_epu32(low, block);
+                high = _mm256_max_epu32(high, block);
+            }
+
+            alignas(32) std::uint64_t laneSums[4];
+            alignas(32) std::uint32_t laneLow[8];
+            alignas(32) std::uint32_t laneHigh[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(laneSums), sums);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(laneLow), low);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(laneHigh), high);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                summary.sum += laneSums[lane];
+            }
+            summary.min = *std::min_element(laneLow, laneLow + 8);
+            summary.max = *std::max_element(laneHigh, laneHigh + 8);
+        }
+#endif
+
+#if defined(RVRSE_COLUMN_REDUCE_SSE2)
+        if (index + 4 <= count)
+        {
+            // min/max run on sign-flipped lanes, which order like unsigned
+            // values under SSE2's signed compare.
+            const __m128i sign = _mm_set1_epi32(static_cast<int>(0x80000000u));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i sums = zero;
+            __m128i low = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index)), sign);
+            __m128i high = low;
+            for (; index + 4 <= count; index += 4)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+                sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(block, zero));
+                sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(block, zero));
+                const __m128i biased = _mm_xor_si128(block, sign);
+                low = Select128(_mm_cmpgt_epi32(low, biased), biased, low);
+                high = Select128(_mm_cmpgt_epi32(biased, high), biased, high);
+            }
+
+            std::uint64_t laneSums[2];
+            std::uint32_t laneLow[4];
+            std::uint32_t laneHigh[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(laneSums), sums);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(laneLow), _mm_xor_si128(low, sign));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(laneHigh), _mm_xor_si128(high, sign));
+            summary.sum += laneSums[0] + laneSums[1];
+            summary.min = std::min<std::uint64_t>(summary.min, *std::min_element(laneLow, laneLow + 4));
+            summary.max = std::max<std::uint64_t>(summary.max, *std::max_element(laneHigh, laneHigh + 4));
+        }
+#endif
+
+        FoldInto(summary, data + index, count - index);
+        return summary;
+    }
+
+    ColumnSummary SummarizeColumn(const std::vector<std::uint64_t> &values)
+    {
+        ColumnSummary summary;
+        if (values.empty())
+        {
+            return summary;
+        }
+
+        const std::uint64_t *data = values.data();
+        const std::size_t count = values.size();
+        summary.min = data[0];
+        summary.max = data[0];
+        std::size_t index = 0;
+
+#if defined(__AVX2__)
+        if (count >= 4)
+        {
+            __m256i sums = _mm256_setzero_si256();
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+            __m256i high = low;
+            for (; index + 4 <= count; index += 4)
+            {
+                const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + index));
+                sums = _mm256_add_epi64(sums, block);
+                low = _mm256_blendv_epi8(low, block, GreaterU64x4(low, block));
+                high = _mm256_blendv_epi8(high, block, GreaterU64x4(block, high));
+            }
+
+            alignas(32) std::uint64_t laneSums[4];
+            alignas(32) std::uint64_t laneLow[4];
+            alignas(32) std::uint64_t laneHigh[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(laneSums), sums);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(laneLow), low);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(laneHigh), high);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                summary.sum += laneSums[lane];
+                summary.min = std::min(summary.min, laneLow[lane]);
+                summary.max = std::max(summary.max, laneHigh[lane]);
+            }
+        }
+#endif
+
+
+        FoldInto(summary, data + index, count - index);
+        return summary;
+    }
+
+    std::uint64_t SumUnselected(const std::vector<std::uint32_t> &values, const std::vector<std::uint8_t> &selected)
+    {
+        const std::size_t count = std::min(values.size(), selected.size());
+        std::uint64_t sum = 0;
+        std::size_t index = 0;
+
+#if defined(RVRSE_COLUMN_REDUCE_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sums = zero;
+        for (; index + 4 <= count; index += 4)
+        {
+            const __m128i block = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + index)),
+                                                UnselectedMask32(selected.data() + index));
+            sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(block, zero));
+            sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(block, zero));
+        }
+        std::uint64_t laneSums[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(laneSums), sums);
+        sum = laneSums[0] + laneSums[1];
+#endif
+
+        for (; index < count; ++index)
+        {
+            sum += selected[index] == 0 ? values[index] : 0;
+        }
+        return sum;
+    }
+
+    std::uint64_t SumUnselected(const std::vector<std::uint64_t> &values, const std::vector<std::uint8_t> &selected)
+    {
+        const std::size_t count = std::min(values.size(), selected.size());
+        std::uint64_t sum = 0;
+        std::size_t index = 0;
+
+#if defined(RVRSE_COLUMN_REDUCE_SSE2)
+        __m128i sums = _mm_setzero_si128();
+        for (; index + 4 <= count; index += 4)
+        {
+            // Each 32-bit flag mask, doubled, covers one 64-bit value.
+            const __m128i mask = UnselectedMask32(selected.data() + index);
+            const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + index));
+            const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + index + 2));
+            sums = _mm_add_epi64(sums, _mm_and_si128(first, _mm_unpacklo_epi32(mask, mask)));
+            sums = _mm_add_epi64(sums, _mm_and_si128(second, _mm_unpackhi_epi32(mask, mask)));
+        }
+        std::uint64_t laneSums[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(laneSums), sums);
+        sum = laneSums[0] + laneSums[1];
+#endif
+
+        for (; index < count; ++index)
+        {
+            sum += selected[index] == 0 ? values[index] : 0;
+        }
+        return sum;
+    }
+
+    void TopColumnIndices(const std::vector<std::uint64_t> &values, std::size_t k, std::vector<std::uint32_t> &indices)
+    {
+        indices.clear();
+        const std::size_t count = values.size();
+        k = std::min(k, count);
+        if (k == 0)
+        {
+            return;
+        }
+
+        // Candidates collect in indices until it holds kTopBufferFactor * k,
+        // then are cut back to the best k; the k-th best value becomes the
+        // bar for the rest. A later index only beats a kept one with a
+        // strictly larger value, as equal values keep index order.
+        const std::uint64_t *data = values.data();
+        const auto better = [data](std::uint32_t lhs, std::uint32_t rhs)
+        { return data[lhs] != data[rhs] ? data[lhs] > data[rhs] : lhs < rhs; };
+        const std::size_t capacity = std::max<std::size_t>(kTopBufferFactor * k, kTopBufferMinimum);
+        indices.reserve(capacity);
+
+        std::uint64_t threshold = 0;
+        const auto compact = [&]()
+        {
+            std::nth_element(indices.begin(), indices.begin() + static_cast<std::ptrdiff_t>(k - 1), indices.end(), better);
+            indices.resize(k);
+            threshold = data[indices[k - 1]];
+        };
+
+        // Everything is a candidate until the first cut sets the bar.
+        std::size_t index = std::min(count, capacity);
+        for (std::uint32_t first = 0; first < index; ++first)
+        {
+            indices.push_back(first);
+        }
+        if (index < count)
+        {
+            compact();
+        }
+
+        for (; index < count; ++index)
+        {
+            if (data[index] > threshold)
+            {
+                indices.push_back(static_cast<std::uint32_t>(index));
+                if (indices.size() == capacity)
+                {
+                    compact();
+                }
+            }
+        }
+
+        if (indices.size() > k)
+        {
+            compact();
+        }
+        std::sort(indices.begin(), indices.end(), better);
+    }
+}
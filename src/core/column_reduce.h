@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rvrse::core
+{
+    struct ColumnSummary
+    {
+        std::uint64_t sum = 0;
+
+        // Zero for an empty column.
+        std::uint64_t min = 0;
+        std::uint64_t max = 0;
+    };
+
+    // Reductions over one contiguous column of a ProcessArrays or
+    // ProcessTable instead of a stride over whole ProcessEntry objects.
+    // 32-bit columns go a vector at a time (SSE2, or AVX2 where the build
+    // targets it); 64-bit min/max needs AVX2's 64-bit compare, and is a
+    // scalar pass otherwise. Sums wrap at 2^64, which byte totals never
+    // reach.
+    ColumnSummary SummarizeColumn(const std::vector<std::uint32_t> &values);
+    ColumnSummary SummarizeColumn(const std::vector<std::uint64_t> &values);
+
+    // Sum of the values whose selected byte is zero: the "other" rollup
+    // beside an exported top-N. selected is index-aligned with values.
+    std::uint64_t SumUnselected(const std::vector<std::uint32_t> &values, const std::vector<std::uint8_t> &selected);
+    std::uint64_t SumUnselected(const std::vector<std::uint64_t> &values, const std::vector<std::uint8_t> &selected);
+
+    // Indices of the k largest values, largest first; equal values keep
+    // index order, so the choice is stable between refreshes. Only values
+    // above the k-th largest so far are collected, and cut back to k now
+    // and then, so the cost is close to one pass over the column rather
+    // than a selection over every index. indices keeps its capacity.
+    void TopColumnIndices(const std::vector<std::uint64_t> &values, std::size_t k, std::vector<std::uint32_t> &indices);
+}
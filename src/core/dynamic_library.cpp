@@ -0,0 +1,98 @@
+#include "dynamic_library.h"
+
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace rvrse::core
+{
+    DynamicLibrary::~DynamicLibrary()
+    {
+        Close();
+    }
+
+    DynamicLibrary::DynamicLibrary(DynamicLibrary &&other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)),
+          lastError_(std::move(other.lastError_))
+    {
+    }
+
+    DynamicLibrary &DynamicLibrary::operator=(DynamicLibrary &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            handle_ = std::exchange(other.handle_, nullptr);
+            lastError_ = std::move(other.lastError_);
+        }
+        return *this;
+    }
+
+    bool DynamicLibrary::Open(const std::wstring &path)
+    {
+        Close();
+        lastError_.clear();
+
+#if defined(_WIN32)
+        handle_ = LoadLibraryW(path.c_str());
+        if (!handle_)
+        {
+            lastError_ = L"LoadLibraryW failed with error " + std::to_wstring(GetLastError());
+        }
+#else
+        std::string nativePath = std::filesystem::path(path).string();
+        handle_ = dlopen(nativePath.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle_)
+        {
+            const char *error = dlerror();
+            std::string message = error ? error : "dlopen failed";
+            lastError_.assign(message.begin(), message.end());
+        }
+#endif
+
+        return handle_ != nullptr;
+    }
+
+    void DynamicLibrary::Close()
+    {
+        if (!handle_)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        FreeLibrary(static_cast<HMODULE>(handle_));
+#else
+        dlclose(handle_);
+#endif
+        handle_ = nullptr;
+    }
+
+    void *DynamicLibrary::Symbol(const char *name) const
+    {
+        if (!handle_)
+        {
+            return nullptr;
+        }
+
+#if defined(_WIN32)
+        return reinterpret_cast<void *>(GetProcAddress(static_cast<HMODULE>(handle_), name));
+#else
+        return dlsym(handle_, name);
+#endif
+    }
+
+    const wchar_t *DynamicLibrary::Extension()
+    {
+#if defined(_WIN32)
+        return L".dll";
+#else
+        return L".so";
+#endif
+    }
+}
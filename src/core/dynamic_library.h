@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+namespace rvrse::core
+{
+    // Owns a handle to a shared library loaded with LoadLibraryW (Windows) or
+    // dlopen (POSIX). The library is unloaded when the wrapper is destroyed.
+    class DynamicLibrary
+    {
+    public:
+        DynamicLibrary() = default;
+        ~DynamicLibrary();
+
+        DynamicLibrary(const DynamicLibrary &) = delete;
+        DynamicLibrary &operator=(const DynamicLibrary &) = delete;
+        DynamicLibrary(DynamicLibrary &&other) noexcept;
+        DynamicLibrary &operator=(DynamicLibrary &&other) noexcept;
+
+        bool Open(const std::wstring &path);
+        void Close();
+
+        bool IsOpen() const { return handle_ != nullptr; }
+        void *Symbol(const char *name) const;
+
+        // Loader diagnostic from the last failed Open(), if any.
+        const std::wstring &LastError() const { return lastError_; }
+
+        // Platform file extension for loadable plugins (".dll" or ".so").
+        static const wchar_t *Extension();
+
+    private:
+        void *handle_ = nullptr;
+        std::wstring lastError_;
+    };
+}
@@ -0,0 +1,251 @@
+#include "fleet_aggregator.h"
+
+#include <utility>
+
+namespace
+{
+    // How often the accept and worker threads look for a stop request.
+    constexpr std::chrono::milliseconds kStopPollInterval{100};
+
+    constexpr std::size_t kReceiveChunkBytes = 32 * 1024;
+
+    // Reads per readiness event before moving on to the next connection;
+    // the poller is level-triggered, so whatever is left is reported again.
+    constexpr int kMaxReadsPerWake = 16;
+}
+
+namespace rvrse::core
+{
+    FleetAggregator::FleetAggregator(FleetAggregatorOptions options)
+        : options_(std::move(options)),
+          index_(options_.maxHosts)
+    {
+    }
+
+    FleetAggregator::~FleetAggregator()
+    {
+        Stop();
+    }
+
+    bool FleetAggregator::Start()
+    {
+        Stop();
+
+        SocketEndpoint endpoint;
+        if (!ParseSocketEndpoint(options_.listen, endpoint) || !listener_.Listen(endpoint, 128))
+        {
+            return false;
+        }
+        port_ = listener_.LocalPort();
+
+        std::size_t workerCount = options_.workerThreads;
+        if (workerCount == 0)
+        {
+            workerCount = std::thread::hardware_concurrency();
+        }
+        workerCount = workerCount == 0 ? 1 : workerCount;
+
+        stopRequested_ = false;
+        for (std::size_t index = 0; index < workerCount; ++index)
+        {
+            auto worker = std::make_unique<Worker>();
+            if (!worker->poller.Open())
+            {
+                Stop();
+                return false;
+            }
+            workers_.push_back(std::move(worker));
+        }
+
+        for (auto &worker : workers_)
+        {
+            worker->thread = std::thread(&FleetAggregator::WorkerLoop, this, std::ref(*worker));
+        }
+        acceptThread_ = std::thread(&FleetAggregator::AcceptLoop, this);
+        return true;
+    }
+
+    void FleetAggregator::Stop()
+    {
+        stopRequested_ = true;
+        if (acceptThread_.joinable())
+        {
+            acceptThread_.join();
+        }
+
+        for (auto &worker : workers_)
+        {
+            worker->poller.Wake();
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+        workers_.clear();
+
+        listener_.Close();
+        port_ = 0;
+        connectionCount_.store(0, std::memory_order_relaxed);
+    }
+
+    void FleetAggregator::AcceptLoop()
+    {
+        Socket client;
+        while (!stopRequested_)
+        {
+            if (!listener_.Accept(client, kStopPollInterval))
+            {
+                continue;
+            }
+
+            if (connectionCount_.load(std::memory_order_relaxed) >= options_.maxHosts || !client.SetNonBlocking(true))
+            {
+                client.Close();
+                continue;
+            }
+
+            auto connection = std::make_unique<Connection>();
+            connection->id = nextConnectionId_++;
+            connection->socket = std::move(client);
+            connectionCount_.fetch_add(1, std::memory_order_relaxed);
+
+            Worker &worker = *workers_[nextWorker_];
+            nextWorker_ = (nextWorker_ + 1) % workers_.size();
+            {
+                std::lock_guard<std::mutex> lock(worker.adoptMutex);
+                worker.adopted.push_back(std::move(connection));
+            }
+            worker.poller.Wake();
+        }
+    }
+
+    void FleetAggregator::WorkerLoop(Worker &worker)
+    {
+        std::vector<std::uint64_t> ready;
+        while (!stopRequested_)
+        {
+            worker.poller.Wait(ready, kStopPollInterval);
+            AdoptConnections(worker);
+
+            for (const std::uint64_t token : ready)
+            {
+                const auto found = worker.connections.find(token);
+                if (found != worker.connections.end() && !ServiceConnection(*found->second))
+                {
+                    CloseConnection(worker, *found->second);
+                }
+            }
+        }
+
+        AdoptConnections(worker);
+        while (!worker.connections.empty())
+        {
+            CloseConnection(worker, *worker.connections.begin()->second);
+        }
+    }
+
+    void FleetAggregator::AdoptConnections(Worker &worker)
+    {
+        std::vector<std::unique_ptr<Connection>> adopted;
+        {
+            std::lock_guard<std::mutex> lock(worker.adoptMutex);
+            adopted.swap(worker.adopted);
+        }
+
+        for (auto &connection : adopted)
+        {
+            if (!worker.poller.Add(connection->socket.Handle(), connection->id))
+            {
+                connectionCount_.fetch_sub(1, std::memory_order_relaxed);
+                continue;
+            }
+            const std::uint64_t id = connection->id;
+            worker.connections.emplace(id, std::move(connection));
+        }
+    }
+
+    bool FleetAggregator::ServiceConnection(Connection &connection)
+    {
+        bool open = true;
+        for (int read = 0; read < kMaxReadsPerWake; ++read)
+        {
+            std::uint8_t *space = connection.reader.PrepareReceive(kReceiveChunkBytes);
+            const std::ptrdiff_t received = connection.socket.ReceiveAvailable(space, kReceiveChunkBytes);
+            if (received == Socket::kWouldBlock)
+            {
+                break;
+            }
+            if (received <= 0)
+            {
+                // Still apply what arrived before the collector hung up.
+                open = false;
+                break;
+            }
+
+            connection.reader.Commit(static_cast<std::size_t>(received));
+            bytesReceived_.fetch_add(static_cast<std::uint64_t>(received), std::memory_order_relaxed);
+            if (static_cast<std::size_t>(received) < kReceiveChunkBytes)
+            {
+                break;
+            }
+        }
+
+        bool applied = false;
+        for (;;)
+        {
+            const WireStreamReader::Status status = connection.reader.Next();
+            if (status == WireStreamReader::Status::NeedMoreData)
+            {
+                break;
+            }
+            if (status == WireStreamReader::Status::ProtocolError)
+            {
+                protocolErrors_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (status == WireStreamReader::Status::HelloReceived)
+            {
+                connection.host = connection.reader.HostName();
+                if (connection.host.empty())
+                {
+                    connection.host = L"collector-" + std::to_wstring(connection.id);
+                }
+                connection.attached = index_.Attach(connection.host, connection.id);
+                if (!connection.attached)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            framesApplied_.fetch_add(1, std::memory_order_relaxed);
+            applied = true;
+        }
+
+        if (applied)
+        {
+            const WireDecoder &state = connection.reader.State();
+            index_.Publish(connection.id,
+                           connection.builder.Build(connection.host,
+                                                    state.Generation(),
+                                                    state.Timestamp(),
+                                                    state.Metrics(),
+                                                    state.Processes(),
+                                                    [&state](std::size_t index) { return state.ImageName(index); }));
+        }
+        return open;
+    }
+
+    void FleetAggregator::CloseConnection(Worker &worker, Connection &connection)
+    {
+        if (connection.attached)
+        {
+            index_.Detach(connection.host, connection.id);
+        }
+        worker.poller.Remove(connection.socket.Handle());
+        connectionCount_.fetch_sub(1, std::memory_order_relaxed);
+
+        // Erasing destroys connection; nothing may touch it afterwards.
+        worker.connections.erase(connection.id);
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "fleet_index.h"
+#include "poller.h"
+#include "socket.h"
+#include "wire_protocol.h"
+
+namespace rvrse::core
+{
+    struct FleetAggregatorOptions
+    {
+        // Where collectors push their wire streams (their "wire_push").
+        std::wstring listen = L"tcp://127.0.0.1:9466";
+
+        // Connection threads; 0 uses one per hardware thread.
+        std::size_t workerThreads = 0;
+
+        // Distinct host names kept; further collectors are turned away.
+        std::size_t maxHosts = 1024;
+    };
+
+    // Ingests the "wire" streams of many collectors (rvrse-agent with
+    // wire_push set) and keeps each host's latest generation in a
+    // FleetIndex for cross-host queries.
+    //
+    // One thread accepts connections and hands them round-robin to the
+    // workers. Each worker owns a Poller and the non-blocking sockets it
+    // was given, decodes whatever arrived into the connection's
+    // WireStreamReader, and publishes one HostSummary per read burst, so a
+    // collector that fell behind is caught up without summarizing every
+    // intermediate generation.
+    class FleetAggregator
+    {
+    public:
+        explicit FleetAggregator(FleetAggregatorOptions options = {});
+        ~FleetAggregator();
+
+        FleetAggregator(const FleetAggregator &) = delete;
+        FleetAggregator &operator=(const FleetAggregator &) = delete;
+
+        bool Start();
+        void Stop();
+
+        // Bound TCP port (0 for Unix sockets).
+        std::uint16_t Port() const { return port_; }
+
+        const FleetIndex &Index() const { return index_; }
+
+        std::size_t WorkerCount() const { return workers_.size(); }
+        std::size_t ConnectionCount() const { return connectionCount_.load(std::memory_order_relaxed); }
+        std::uint64_t FramesApplied() const { return framesApplied_.load(std::memory_order_relaxed); }
+        std::uint64_t BytesReceived() const { return bytesReceived_.load(std::memory_order_relaxed); }
+        std::uint64_t ProtocolErrors() const { return protocolErrors_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Connection
+        {
+            std::uint64_t id = 0;
+            Socket socket;
+            WireStreamReader reader;
+            HostSummaryBuilder builder;
+            std::wstring host;
+            bool attached = false;
+        };
+
+        struct Worker
+        {
+            Poller poller;
+            std::thread thread;
+
+            // Handed over by the accept thread, picked up on the next wake.
+            std::mutex adoptMutex;
+            std::vector<std::unique_ptr<Connection>> adopted;
+
+            // Owned by the worker thread, keyed by Connection::id (the
+            // Poller token).
+            std::unordered_map<std::uint64_t, std::unique_ptr<Connection>> connections;
+        };
+
+        void AcceptLoop();
+        void WorkerLoop(Worker &worker);
+        void AdoptConnections(Worker &worker);
+
+        // Returns false once the connection should be closed.
+        bool ServiceConnection(Connection &connection);
+        void CloseConnection(Worker &worker, Connection &connection);
+
+        FleetAggregatorOptions options_;
+        FleetIndex index_;
+        Socket listener_;
+        std::uint16_t port_ = 0;
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::thread acceptThread_;
+        std::atomic<bool> stopRequested_{false};
+        std::uint64_t nextConnectionId_ = 1;
+        std::size_t nextWorker_ = 0;
+
+        std::atomic<std::size_t> connectionCount_{0};
+        std::atomic<std::uint64_t> framesApplied_{0};
+        std::atomic<std::uint64_t> bytesReceived_{0};
+        std::atomic<std::uint64_t> protocolErrors_{0};
+    };
+}
@@ -0,0 +1,303 @@
+#include "fleet_index.h"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+
+#include "binary_codec.h"
+
+namespace
+{
+    using rvrse::core::FleetMetric;
+
+    constexpr const char *kMetricNames[rvrse::core::kFleetMetricCount] = {
+        "cpu_percent",
+        "working_set_bytes",
+        "private_bytes",
+        "threads"};
+
+    struct MergeCursor
+    {
+        double value;
+        std::size_t host;
+        std::size_t rank;
+    };
+}
+
+namespace rvrse::core
+{
+    const char *FleetMetricName(FleetMetric metric)
+    {
+        return kMetricNames[static_cast<std::size_t>(metric)];
+    }
+
+    bool ParseFleetMetric(std::string_view name, FleetMetric &metric)
+    {
+        for (std::size_t index = 0; index < kFleetMetricCount; ++index)
+        {
+            if (name == kMetricNames[index])
+            {
+                metric = static_cast<FleetMetric>(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double FleetProcess::Value(FleetMetric metric) const
+    {
+        switch (metric)
+        {
+        case FleetMetric::CpuPercent:
+            return cpuPercent;
+        case FleetMetric::WorkingSetBytes:
+            return static_cast<double>(workingSetBytes);
+        case FleetMetric::PrivateBytes:
+            return static_cast<double>(privateBytes);
+        case FleetMetric::Threads:
+            return static_cast<double>(threadCount);
+        }
+        return 0.0;
+    }
+
+    std::shared_ptr<const HostSummary> HostSummaryBuilder::Build(const std::wstring &host,
+                                                                 std::uint64_t generation,
+                                                                 std::chrono::system_clock::time_point timestamp,
+                                                                 const SystemMetrics &metrics,
+                                                                 const std::vector<ProcessEntry> &processes,
+                                                                 const NameLookup &nameOf)
+    {
+        auto summary = std::make_shared<HostSummary>();
+        summary->host = host;
+        summary->generation = generation;
+        summary->timestamp = timestamp;
+        summary->metrics = metrics;
+        summary->processCount = processes.size();
+
+        const double elapsed100ns =
+            hasCpuBaseline_ ? static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp - previousTimestamp_).count()) / 100.0 : 0.0;
+
+        cpuPercent_.assign(processes.size(), 0.0);
+        currentCpuTimes_.clear();
+        currentCpuTimes_.reserve(processes.size());
+
+        auto previous = previousCpuTimes_.cbegin();
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            const std::uint64_t cpuTime = process.kernelTime100ns + process.userTime100ns;
+            currentCpuTimes_.emplace_back(process.processId, cpuTime);
+
+            while (previous != previousCpuTimes_.cend() && previous->first < process.processId)
+            {
+                ++previous;
+            }
+
+            // A reused PID shows up as time going backwards; its usage
+            // starts from the next generation.
+            if (elapsed100ns > 0.0 && previous != previousCpuTimes_.cend() && previous->first == process.processId &&
+                cpuTime >= previous->second)
+            {
+                cpuPercent_[index] = static_cast<double>(cpuTime - previous->second) / elapsed100ns * 100.0;
+            }
+        }
+
+        previousCpuTimes_.swap(currentCpuTimes_);
+        previousTimestamp_ = timestamp;
+        hasCpuBaseline_ = true;
+
+        const auto value = [&](FleetMetric metric, std::uint32_t index) -> double
+        {
+            switch (metric)
+            {
+            case FleetMetric::CpuPercent:
+                return cpuPercent_[index];
+            case FleetMetric::WorkingSetBytes:
+                return static_cast<double>(processes[index].workingSetBytes);
+            case FleetMetric::PrivateBytes:
+                return static_cast<double>(processes[index].privateBytes);
+            case FleetMetric::Threads:
+                return static_cast<double>(processes[index].threadCount);
+            }
+            return 0.0;
+        };
+
+        // Rank by each metric, then copy every ranked process once and point
+        // the rankings at the copies.
+        const std::size_t depth = std::min(HostSummary::kTopDepth, processes.size());
+        slot_.assign(processes.size(), ~0U);
+        order_.resize(processes.size());
+        for (std::size_t metricIndex = 0; metricIndex < kFleetMetricCount; ++metricIndex)
+        {
+            const auto metric = static_cast<FleetMetric>(metricIndex);
+            std::iota(order_.begin(), order_.end(), 0U);
+            std::partial_sort(order_.begin(),
+                              order_.begin() + static_cast<std::ptrdiff_t>(depth),
+                              order_.end(),
+                              [&](std::uint32_t left, std::uint32_t right)
+                              {
+                                  const double leftValue = value(metric, left);
+                                  const double rightValue = value(metric, right);
+                                  return leftValue != rightValue ? leftValue > rightValue : left < right;
+                              });
+
+            std::vector<std::uint32_t> &ranking = summary->ranking[metricIndex];
+            ranking.reserve(depth);
+            for (std::size_t rank = 0; rank < depth; ++rank)
+            {
+                const std::uint32_t index = order_[rank];
+                if (slot_[index] == ~0U)
+                {
+                    slot_[index] = static_cast<std::uint32_t>(summary->processes.size());
+
+                    const ProcessEntry &process = processes[index];
+                    FleetProcess copy;
+                    copy.processId = process.processId;
+                    copy.parentProcessId = process.parentProcessId;
+                    if (nameOf)
+                    {
+                        const std::string_view name = nameOf(index);
+                        copy.name = codec::DecodeUtf8(reinterpret_cast<const std::uint8_t *>(name.data()), name.size());
+                    }
+                    else
+                    {
+                        copy.name = process.imageName;
+                    }
+                    copy.cpuPercent = cpuPercent_[index];
+                    copy.workingSetBytes = process.workingSetBytes;
+                    copy.privateBytes = process.privateBytes;
+                    copy.threadCount = process.threadCount;
+                    summary->processes.push_back(std::move(copy));
+                }
+                ranking.push_back(slot_[index]);
+            }
+        }
+
+        return summary;
+    }
+
+    bool FleetIndex::Attach(const std::wstring &host, std::uint64_t connectionId)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto found = hosts_.find(host);
+        if (found == hosts_.end())
+        {
+            if (hosts_.size() >= maxHosts_)
+            {
+                return false;
+            }
+            found = hosts_.emplace(host, Entry{}).first;
+        }
+
+        found->second.connectionId = connectionId;
+        found->second.connected = true;
+        return true;
+    }
+
+    void FleetIndex::Detach(const std::wstring &host, std::uint64_t connectionId)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const auto found = hosts_.find(host);
+        if (found != hosts_.end() && found->second.connectionId == connectionId)
+        {
+            found->second.connected = false;
+        }
+    }
+
+    void FleetIndex::Publish(std::uint64_t connectionId, std::shared_ptr<const HostSummary> summary)
+    {
+        if (!summary)
+        {
+            return;
+        }
+
+        // The previous summary is released outside the lock; the last
+        // reference can be a large table.
+        std::shared_ptr<const HostSummary> replaced;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            const auto found = hosts_.find(summary->host);
+            if (found == hosts_.end() || found->second.connectionId != connectionId)
+            {
+                return;
+            }
+            replaced = std::exchange(found->second.summary, std::move(summary));
+        }
+    }
+
+    std::vector<FleetHost> FleetIndex::Hosts() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<FleetHost> hosts;
+        hosts.reserve(hosts_.size());
+        for (const auto &[name, entry] : hosts_)
+        {
+            if (entry.summary)
+            {
+                hosts.push_back(FleetHost{entry.summary, entry.connected});
+            }
+        }
+        return hosts;
+    }
+
+    std::size_t FleetIndex::HostCount() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return hosts_.size();
+    }
+
+    std::vector<FleetTopEntry> FleetIndex::Top(FleetMetric metric, std::size_t limit) const
+    {
+        limit = std::min(limit, HostSummary::kTopDepth);
+        const auto metricIndex = static_cast<std::size_t>(metric);
+
+        std::vector<FleetTopEntry> top;
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+
+        // hosts_ is name-ordered, so a cursor's host index doubles as the
+        // name tie-break.
+        std::vector<const std::shared_ptr<const HostSummary> *> summaries;
+        std::vector<MergeCursor> heap;
+        summaries.reserve(hosts_.size());
+        heap.reserve(hosts_.size());
+        for (const auto &[name, entry] : hosts_)
+        {
+            if (!entry.connected || !entry.summary || entry.summary->ranking[metricIndex].empty())
+            {
+                continue;
+            }
+
+            const HostSummary &summary = *entry.summary;
+            heap.push_back(MergeCursor{summary.processes[summary.ranking[metricIndex][0]].Value(metric), summaries.size(), 0});
+            summaries.push_back(&entry.summary);
+        }
+
+        // std::*_heap keep the largest element first under this "less".
+        const auto worse = [](const MergeCursor &left, const MergeCursor &right)
+        {
+            return left.value != right.value ? left.value < right.value : left.host > right.host;
+        };
+        std::make_heap(heap.begin(), heap.end(), worse);
+
+        top.reserve(limit);
+        while (top.size() < limit && !heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            MergeCursor &best = heap.back();
+            const std::shared_ptr<const HostSummary> &summary = *summaries[best.host];
+            const std::vector<std::uint32_t> &ranking = summary->ranking[metricIndex];
+            top.push_back(FleetTopEntry{summary, &summary->processes[ranking[best.rank]], best.value});
+
+            if (++best.rank < ranking.size())
+            {
+                best.value = summary->processes[ranking[best.rank]].Value(metric);
+                std::push_heap(heap.begin(), heap.end(), worse);
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+        return top;
+    }
+}
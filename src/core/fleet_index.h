@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "process_snapshot.h"
+#include "system_metrics.h"
+
+namespace rvrse::core
+{
+    enum class FleetMetric
+    {
+        CpuPercent,
+        WorkingSetBytes,
+        PrivateBytes,
+        Threads
+    };
+
+    constexpr std::size_t kFleetMetricCount = 4;
+
+    // Names as used in the aggregator's query paths: "cpu_percent",
+    // "working_set_bytes", "private_bytes", "threads".
+    const char *FleetMetricName(FleetMetric metric);
+    bool ParseFleetMetric(std::string_view name, FleetMetric &metric);
+
+    struct FleetProcess
+    {
+        std::uint32_t processId = 0;
+        std::uint32_t parentProcessId = 0;
+        std::wstring name;
+
+        // Since the host's previous generation, in percent of one core.
+        double cpuPercent = 0.0;
+        std::uint64_t workingSetBytes = 0;
+        std::uint64_t privateBytes = 0;
+        std::uint32_t threadCount = 0;
+
+        double Value(FleetMetric metric) const;
+    };
+
+    // What the fleet index keeps of one host's latest generation: system
+    // metrics plus, per metric, the kTopDepth highest-ranked processes.
+    // Cross-host queries merge these short lists instead of rescanning
+    // every host's full process table. Immutable once published.
+    struct HostSummary
+    {
+        static constexpr std::size_t kTopDepth = 100;
+
+        std::wstring host;
+        std::uint64_t generation = 0;
+        std::chrono::system_clock::time_point timestamp{};
+        SystemMetrics metrics{};
+        std::size_t processCount = 0;
+
+        // Every process that ranks in at least one top list.
+        std::vector<FleetProcess> processes;
+
+        // Per FleetMetric: indices into processes, best first. Ties go to
+        // the lower PID.
+        std::array<std::vector<std::uint32_t>, kFleetMetricCount> ranking;
+    };
+
+    // Builds a host's summaries generation after generation. Keeps the
+    // previous CPU times so per-process CPU usage is a PID-sorted merge
+    // walk, like OpenMetricsRenderer.
+    class HostSummaryBuilder
+    {
+    public:
+        // Returns the UTF-8 name of processes[index].
+        using NameLookup = std::function<std::string_view(std::size_t index)>;
+
+        // processes must be PID-sorted (ProcessSnapshot and WireDecoder
+        // order). Names come from each entry's imageName unless nameOf is
+        // given, as for WireDecoder::Processes(); only ranked processes are
+        // looked up.
+        std::shared_ptr<const HostSummary> Build(const std::wstring &host,
+                                                 std::uint64_t generation,
+                                                 std::chrono::system_clock::time_point timestamp,
+                                                 const SystemMetrics &metrics,
+                                                 const std::vector<ProcessEntry> &processes,
+                                                 const NameLookup &nameOf = {});
+
+    private:
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> previousCpuTimes_;
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> currentCpuTimes_;
+        std::chrono::system_clock::time_point previousTimestamp_{};
+        bool hasCpuBaseline_ = false;
+
+        // Per-build scratch.
+        std::vector<double> cpuPercent_;
+        std::vector<std::uint32_t> order_;
+        std::vector<std::uint32_t> slot_;
+    };
+
+    struct FleetHost
+    {
+        std::shared_ptr<const HostSummary> summary;
+        bool connected = false;
+    };
+
+    struct FleetTopEntry
+    {
+        // Keeps process valid after the host publishes a newer generation.
+        std::shared_ptr<const HostSummary> host;
+        const FleetProcess *process = nullptr;
+        double value = 0.0;
+    };
+
+    // Latest summary per host, shared between the aggregator's workers
+    // (which publish) and query handlers. Publishing swaps one pointer
+    // under an exclusive lock; queries hold a shared lock while they merge.
+    //
+    // A host name belongs to the connection that attached it last, so a
+    // collector that reconnects takes over its own entry and a stale
+    // connection cannot overwrite it. Disconnected hosts keep their last
+    // summary for Hosts() but drop out of Top().
+    class FleetIndex
+    {
+    public:
+        explicit FleetIndex(std::size_t maxHosts = 1024) : maxHosts_(maxHosts) {}
+
+        // False when maxHosts other hosts are already known.
+        bool Attach(const std::wstring &host, std::uint64_t connectionId);
+        void Detach(const std::wstring &host, std::uint64_t connectionId);
+
+        // Ignored unless connectionId still owns summary->host.
+        void Publish(std::uint64_t connectionId, std::shared_ptr<const HostSummary> summary);
+
+        // Hosts that published at least one generation, sorted by name.
+        std::vector<FleetHost> Hosts() const;
+        std::size_t HostCount() const;
+
+        // The limit highest processes by metric across connected hosts,
+        // best first; ties go to the host name, then the PID. limit is
+        // capped at HostSummary::kTopDepth. A k-way merge over the hosts'
+        // rankings: O(hosts + limit * log hosts), independent of process
+        // counts.
+        std::vector<FleetTopEntry> Top(FleetMetric metric, std::size_t limit) const;
+
+    private:
+        struct Entry
+        {
+            std::uint64_t connectionId = 0;
+            bool connected = false;
+            std::shared_ptr<const HostSummary> summary;
+        };
+
+        std::size_t maxHosts_;
+        mutable std::shared_mutex mutex_;
+        std::map<std::wstring, Entry> hosts_;
+    };
+}
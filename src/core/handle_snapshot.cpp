@@ -1,8 +1,10 @@
 #include "handle_snapshot.h"
 
 #include <cstddef>
+#include <utility>
 #include <vector>
 
+#if defined(_WIN32)
 #include <Windows.h>
 #include <winternl.h>
 
@@ -71,9 +73,11 @@ namespace
         return ntBuffer;
     }
 }
+#endif
 
 namespace rvrse::core
 {
+#if defined(_WIN32)
     HandleSnapshot HandleSnapshot::Capture()
     {
         HandleSnapshot snapshot;
@@ -103,6 +107,12 @@ namespace rvrse::core
 
         return snapshot;
     }
+#endif
+
+    HandleSnapshot::HandleSnapshot(std::vector<HandleEntry> handles)
+        : handles_(std::move(handles))
+    {
+    }
 
     std::vector<HandleEntry> HandleSnapshot::HandlesForProcess(std::uint32_t processId) const
     {
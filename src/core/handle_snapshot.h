@@ -17,6 +17,11 @@ namespace rvrse::core
     class HandleSnapshot
     {
     public:
+        HandleSnapshot() = default;
+
+        // Builds a snapshot from pre-collected entries (synthetic data, replays).
+        explicit HandleSnapshot(std::vector<HandleEntry> handles);
+
         static HandleSnapshot Capture();
 
         const std::vector<HandleEntry> &Handles() const { return handles_; }
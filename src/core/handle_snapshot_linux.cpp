@@ -0,0 +1,41 @@
+// Linux capture backend for HandleSnapshot: one entry per open file
+// descriptor under /proc/<pid>/fd. The portable parts of HandleSnapshot live
+// in handle_snapshot.cpp.
+
+#include "handle_snapshot.h"
+
+#if defined(__linux__)
+
+#include <cstdio>
+
+#include "procfs.h"
+
+namespace rvrse::core
+{
+    HandleSnapshot HandleSnapshot::Capture()
+    {
+        HandleSnapshot snapshot;
+        char path[64];
+
+        for (std::uint32_t processId : procfs::ListNumericEntries("/proc"))
+        {
+            // Other users' fd directories are unreadable without privileges;
+            // those processes simply report no handles, as on Windows.
+            std::snprintf(path, sizeof(path), "/proc/%u/fd", processId);
+            for (std::uint32_t descriptor : procfs::ListNumericEntries(path))
+            {
+                HandleEntry entry{};
+                entry.processId = processId;
+
+                // HandleEntry mirrors the 16-bit NT handle table value; raised
+                // RLIMIT_NOFILE limits can produce larger descriptors, which wrap.
+                entry.handleValue = static_cast<std::uint16_t>(descriptor);
+                snapshot.handles_.push_back(entry);
+            }
+        }
+
+        return snapshot;
+    }
+}
+
+#endif
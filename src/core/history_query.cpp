@@ -0,0 +1,609 @@
+#include "history_query.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include "binary_codec.h"
+#include "process_view.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    namespace history = rvrse::core::history;
+
+    using rvrse::core::HistoryFrameSummary;
+    using rvrse::core::HistoryMetric;
+    using rvrse::core::HistoryPeak;
+    using rvrse::core::HistoryQuery;
+    using rvrse::core::HistoryRecord;
+    using rvrse::core::HistoryScanStats;
+    using rvrse::core::HistorySegment;
+    using rvrse::core::HistorySeries;
+    using rvrse::core::ProcessFilter;
+
+    // How often the top-N bound of a peaks query is recomputed, in frames.
+    constexpr std::uint64_t kBoundRefreshFrames = 64;
+
+    std::wstring DecodeName(std::string_view name)
+    {
+        return rvrse::core::codec::DecodeUtf8(reinterpret_cast<const std::uint8_t *>(name.data()), name.size());
+    }
+
+    // Reads and decodes frames, keeping the data file of the last segment open.
+    class FrameReader
+    {
+    public:
+        bool Read(const std::wstring &path, const HistoryFrameSummary &summary, HistoryScanStats &stats, std::wstring &error)
+        {
+            if (path != path_)
+            {
+                file_.close();
+                file_.clear();
+                file_.open(fs::path(path), std::ios::binary);
+                path_ = path;
+            }
+
+            body_.resize(summary.sizeBytes);
+            file_.seekg(static_cast<std::streamoff>(summary.offset));
+            file_.read(reinterpret_cast<char *>(body_.data()), static_cast<std::streamsize>(body_.size()));
+            if (!file_)
+            {
+                error = L"cannot read '" + path + L"'";
+                path_.clear();
+                return false;
+            }
+
+            ++stats.framesRead;
+            stats.bytesRead += summary.sizeBytes;
+            if (!rvrse::core::DecodeHistoryFrame(body_.data(), body_.size(), metrics_, records_))
+            {
+                error = L"corrupt frame at offset " + std::to_wstring(summary.offset) + L" of '" + path + L"'";
+                return false;
+            }
+            return true;
+        }
+
+        const std::vector<HistoryRecord> &Records() const { return records_; }
+
+    private:
+        std::wstring path_;
+        std::ifstream file_;
+        std::vector<std::uint8_t> body_;
+        rvrse::core::SystemMetrics metrics_;
+        std::vector<HistoryRecord> records_;
+    };
+
+    // Walks the frames of the window in order, preceded by the lead-in from
+    // the keyframe before fromMs. The visitor decides per frame whether it
+    // needs the records (Wanted) or can do with the index entry (Skipped),
+    // and is told once where the window starts (BeginWindow).
+    template <typename Visitor>
+    bool ScanFrames(const std::vector<HistorySegment> &segments,
+                    const HistoryQuery &query,
+                    FrameReader &reader,
+                    HistoryScanStats &stats,
+                    Visitor &visitor,
+                    std::wstring &error)
+    {
+        std::vector<HistoryFrameSummary> frames;
+        bool windowStarted = false;
+        for (std::size_t segmentIndex = 0; segmentIndex < segments.size(); ++segmentIndex)
+        {
+            const HistorySegment &segment = segments[segmentIndex];
+            if (segment.startMs + history::kSegmentMilliseconds <= query.fromMs)
+            {
+                continue;
+            }
+            if (segment.startMs > query.toMs)
+            {
+                break;
+            }
+            if (!rvrse::core::LoadHistoryIndex(segment, frames, error))
+            {
+                return false;
+            }
+            ++stats.segments;
+
+            const std::size_t first = static_cast<std::size_t>(
+                std::lower_bound(frames.begin(), frames.end(), query.fromMs, [](const HistoryFrameSummary &frame, std::int64_t timestampMs)
+                                 { return frame.timestampMs < timestampMs; }) -
+                frames.begin());
+            const std::size_t last = static_cast<std::size_t>(
+                std::upper_bound(frames.begin(), frames.end(), query.toMs, [](std::int64_t timestampMs, const HistoryFrameSummary &frame)
+                                 { return timestampMs < frame.timestampMs; }) -
+                frames.begin());
+
+            std::size_t begin = first;
+            if (first > 0)
+            {
+                begin = first - 1;
+                while (begin > 0 && (frames[begin].flags & history::kFrameKeyframe) == 0)
+                {
+                    --begin;
+                }
+            }
+
+            for (std::size_t index = begin; index < last; ++index)
+            {
+                const bool leadIn = index < first;
+                if (!leadIn && !windowStarted)
+                {
+                    visitor.BeginWindow();
+                    windowStarted = true;
+                }
+
+                const HistoryFrameSummary &summary = frames[index];
+                ++stats.frames;
+                if (!visitor.Wanted(summary, leadIn))
+                {
+                    visitor.Skipped(segmentIndex, summary, leadIn);
+                    continue;
+                }
+                if (!reader.Read(segment.dataPath, summary, stats, error))
+                {
+                    return false;
+                }
+                visitor.Visit(summary, reader.Records(), leadIn);
+            }
+        }
+
+        if (!windowStarted)
+        {
+            visitor.BeginWindow();
+        }
+        return true;
+    }
+
+    class SeriesScan
+    {
+    public:
+        SeriesScan(const HistoryQuery &query, std::vector<HistorySeries> &series)
+            : query_(query),
+              filter_(query.process),
+              series_(series)
+        {
+        }
+
+        void BeginWindow()
+        {
+            inWindow_ = true;
+            for (const auto &[processId, tracked] : tracked_)
+            {
+                if (!std::isnan(tracked.value))
+                {
+                    series_[tracked.series].points.push_back({query_.fromMs, tracked.value});
+                }
+            }
+        }
+
+        bool Wanted(const HistoryFrameSummary &summary, bool) const
+        {
+            if (filter_.ByProcessId())
+            {
+                return summary.MayContain(filter_.ProcessId());
+            }
+
+            // Any new process might match the name.
+            if (summary.flags & history::kFrameNewProcesses)
+            {
+                return true;
+            }
+            for (const auto &entry : tracked_)
+            {
+                if (summary.MayContain(entry.first))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // None of the tracked processes has a record here: a keyframe
+        // without them means they are gone, and no record means no CPU used.
+        void Skipped(std::size_t, const HistoryFrameSummary &summary, bool)
+        {
+            if (summary.flags & history::kFrameKeyframe)
+            {
+                tracked_.clear();
+                return;
+            }
+            if (query_.metric == HistoryMetric::CpuPercent)
+            {
+                for (auto &entry : tracked_)
+                {
+                    Update(entry.second, 0.0, summary.timestampMs);
+                }
+            }
+        }
+
+        void Visit(const HistoryFrameSummary &summary, const std::vector<HistoryRecord> &records, bool)
+        {
+            const bool keyframe = (summary.flags & history::kFrameKeyframe) != 0;
+            ++frame_;
+
+            for (const HistoryRecord &record : records)
+            {
+                if (record.fields & history::kFieldExit)
+                {
+                    tracked_.erase(record.processId);
+                    continue;
+                }
+
+                auto tracked = tracked_.find(record.processId);
+                if (record.fields & history::kFieldName)
+                {
+                    if (filter_.ByProcessId() && record.processId != filter_.ProcessId())
+                    {
+                        continue;
+                    }
+
+                    // A keyframe restates running processes; anything else
+                    // with a name is a new process.
+                    std::wstring name = DecodeName(record.name);
+                    const bool restated = keyframe && tracked != tracked_.end() && series_[tracked->second.series].name == name;
+                    if (!restated)
+                    {
+                        if (tracked != tracked_.end())
+                        {
+                            tracked_.erase(tracked);
+                        }
+                        if (!filter_.Matches(record.processId, name))
+                        {
+                            continue;
+                        }
+
+                        series_.push_back(HistorySeries{record.processId, std::move(name), {}});
+                        tracked = tracked_.emplace(record.processId, Tracked{series_.size() - 1}).first;
+                    }
+                }
+                if (tracked == tracked_.end())
+                {
+                    continue;
+                }
+
+                tracked->second.frame = frame_;
+                if (query_.metric == HistoryMetric::CpuPercent || record.Has(query_.metric))
+                {
+                    Update(tracked->second, record.Value(query_.metric, summary.intervalMs), summary.timestampMs);
+                }
+            }
+
+            if (keyframe || query_.metric == HistoryMetric::CpuPercent)
+            {
+                for (auto entry = tracked_.begin(); entry != tracked_.end();)
+                {
+                    if (entry->second.frame == frame_)
+                    {
+                        ++entry;
+                    }
+                    else if (keyframe)
+                    {
+                        entry = tracked_.erase(entry);
+                    }
+                    else
+                    {
+                        Update(entry->second, 0.0, summary.timestampMs);
+                        ++entry;
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Tracked
+        {
+            std::size_t series = 0;
+            double value = std::numeric_limits<double>::quiet_NaN();
+            std::uint64_t frame = 0; // last frame with a record
+        };
+
+        void Update(Tracked &tracked, double value, std::int64_t timestampMs)
+        {
+            if (value == tracked.value)
+            {
+                return;
+            }
+            tracked.value = value;
+            if (inWindow_)
+            {
+                series_[tracked.series].points.push_back({timestampMs, value});
+            }
+        }
+
+        const HistoryQuery &query_;
+        ProcessFilter filter_;
+        std::vector<HistorySeries> &series_;
+        std::unordered_map<std::uint32_t, Tracked> tracked_;
+        std::uint64_t frame_ = 0;
+        bool inWindow_ = false;
+    };
+
+    class PeakScan
+    {
+    public:
+        explicit PeakScan(const HistoryQuery &query)
+            : query_(query),
+              filter_(query.process),
+              bound_(query.over)
+        {
+        }
+
+        void BeginWindow()
+        {
+            if (query_.metric != HistoryMetric::CpuPercent)
+            {
+                for (const auto &[processId, value] : values_)
+                {
+                    Observe(processId, value, query_.fromMs);
+                }
+            }
+            values_.clear();
+            RefreshBound();
+        }
+
+        bool Wanted(const HistoryFrameSummary &summary, bool leadIn) const
+        {
+            if (leadIn)
+            {
+                return true;
+            }
+            if (filter_.ByProcessId() && !summary.MayContain(filter_.ProcessId()))
+            {
+                return false;
+            }
+            return summary.MaxValue(query_.metric) > bound_;
+        }
+
+        void Skipped(std::size_t segment, const HistoryFrameSummary &summary, bool)
+        {
+            if (summary.flags & history::kFrameNewProcesses)
+            {
+                skippedNames_.push_back({segment, summary});
+            }
+            RefreshBoundPeriodically();
+        }
+
+        void Visit(const HistoryFrameSummary &summary, const std::vector<HistoryRecord> &records, bool leadIn)
+        {
+            if (leadIn && (summary.flags & history::kFrameKeyframe))
+            {
+                values_.clear();
+            }
+
+            for (const HistoryRecord &record : records)
+            {
+                if (record.fields & history::kFieldName)
+                {
+                    names_[record.processId] = {DecodeName(record.name), summary.timestampMs};
+                }
+                if (leadIn)
+                {
+                    if (record.fields & history::kFieldExit)
+                    {
+                        values_.erase(record.processId);
+                    }
+                    else if (record.Has(query_.metric))
+                    {
+                        values_[record.processId] = record.Value(query_.metric, summary.intervalMs);
+                    }
+                }
+                else if (record.Has(query_.metric))
+                {
+                    Observe(record.processId, record.Value(query_.metric, summary.intervalMs), summary.timestampMs);
+                }
+            }
+            if (!leadIn)
+            {
+                RefreshBoundPeriodically();
+            }
+        }
+
+        // Names processes whose peak came after a skipped frame that may
+        // have started them, then applies the name filter and the limit.
+        bool Finish(const std::vector<HistorySegment> &segments,
+                    FrameReader &reader,
+                    HistoryScanStats &stats,
+                    std::vector<HistoryPeak> &peaks,
+                    std::wstring &error)
+        {
+            peaks.clear();
+            for (auto &[processId, candidate] : candidates_)
+            {
+                for (auto skipped = skippedNames_.rbegin(); skipped != skippedNames_.rend(); ++skipped)
+                {
+                    const HistoryFrameSummary &summary = skipped->summary;
+                    if (summary.timestampMs > candidate.timestampMs || !summary.MayContain(processId))
+                    {
+                        continue;
+                    }
+                    if (summary.timestampMs <= candidate.nameMs)
+                    {
+                        break;
+                    }
+                    if (!reader.Read(segments[skipped->segment].dataPath, summary, stats, error))
+                    {
+                        return false;
+                    }
+                    const auto &records = reader.Records();
+                    const auto record = std::find_if(records.begin(), records.end(), [processId = processId](const HistoryRecord &entry)
+                                                     { return entry.processId == processId && (entry.fields & history::kFieldName); });
+                    if (record != records.end())
+                    {
+                        candidate.name = DecodeName(record->name);
+                        break;
+                    }
+                }
+
+                if (!filter_.Matches(processId, candidate.name))
+                {
+                    continue;
+                }
+
+                HistoryPeak peak;
+                peak.processId = processId;
+                peak.name = std::move(candidate.name);
+                peak.value = candidate.value;
+                peak.timestampMs = candidate.timestampMs;
+                peak.firstOverMs = candidate.firstOverMs;
+                peaks.push_back(std::move(peak));
+            }
+
+            std::sort(peaks.begin(), peaks.end(), [](const HistoryPeak &lhs, const HistoryPeak &rhs)
+                      { return lhs.value != rhs.value ? lhs.value > rhs.value : lhs.processId < rhs.processId; });
+            if (query_.limit > 0 && peaks.size() > query_.limit)
+            {
+                peaks.resize(query_.limit);
+            }
+            return true;
+        }
+
+    private:
+        struct Candidate
+        {
+            std::wstring name;
+            std::int64_t nameMs = std::numeric_limits<std::int64_t>::min();
+            double value = 0.0;
+            std::int64_t timestampMs = 0;
+            std::int64_t firstOverMs = 0;
+        };
+
+        struct KnownName
+        {
+            std::wstring name;
+            std::int64_t timestampMs = 0;
+        };
+
+        struct SkippedFrame
+        {
+            std::size_t segment = 0;
+            HistoryFrameSummary summary;
+        };
+
+        void Observe(std::uint32_t processId, double value, std::int64_t timestampMs)
+        {
+            if (value <= query_.over || (filter_.ByProcessId() && processId != filter_.ProcessId()))
+            {
+                return;
+            }
+
+            auto [entry, inserted] = candidates_.try_emplace(processId);
+            Candidate &candidate = entry->second;
+            if (inserted)
+            {
+                candidate.firstOverMs = timestampMs;
+            }
+            else if (value <= candidate.value)
+            {
+                return;
+            }
+
+            candidate.value = value;
+            candidate.timestampMs = timestampMs;
+            const auto known = names_.find(processId);
+            if (known != names_.end())
+            {
+                candidate.name = known->second.name;
+                candidate.nameMs = known->second.timestampMs;
+            }
+        }
+
+        void RefreshBoundPeriodically()
+        {
+            if (++framesSinceBound_ >= kBoundRefreshFrames)
+            {
+                RefreshBound();
+            }
+        }
+
+        // Without a threshold, frames that cannot reach the current Nth
+        // highest peak are skipped too. Only when every candidate counts
+        // toward the N: a name filter is not decided until Finish().
+        void RefreshBound()
+        {
+            framesSinceBound_ = 0;
+            if (query_.over > 0.0 || query_.limit == 0 || !(filter_.Empty() || filter_.ByProcessId()) ||
+                candidates_.size() < query_.limit)
+            {
+                return;
+            }
+
+            peakValues_.clear();
+            for (const auto &entry : candidates_)
+            {
+                peakValues_.push_back(entry.second.value);
+            }
+            const auto nth = peakValues_.begin() + static_cast<std::ptrdiff_t>(query_.limit - 1);
+            std::nth_element(peakValues_.begin(), nth, peakValues_.end(), std::greater<double>());
+            bound_ = std::max(bound_, *nth);
+        }
+
+        const HistoryQuery &query_;
+        ProcessFilter filter_;
+        double bound_;
+        std::uint64_t framesSinceBound_ = 0;
+
+        std::unordered_map<std::uint32_t, Candidate> candidates_;
+        std::unordered_map<std::uint32_t, KnownName> names_;
+        std::unordered_map<std::uint32_t, double> values_; // lead-in state
+        std::vector<SkippedFrame> skippedNames_;
+        std::vector<double> peakValues_;
+    };
+
+    bool CheckQuery(const HistoryQuery &query, std::wstring &error)
+    {
+        if (query.fromMs > query.toMs)
+        {
+            error = L"the window ends before it starts";
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace rvrse::core
+{
+    bool HistoryReader::Series(const HistoryQuery &query, std::vector<HistorySeries> &series, std::wstring &error)
+    {
+        stats_ = HistoryScanStats{};
+        series.clear();
+        if (!CheckQuery(query, error))
+        {
+            return false;
+        }
+
+        const std::vector<HistorySegment> segments = ListHistorySegments(directory_);
+        FrameReader reader;
+        SeriesScan scan(query, series);
+        if (!ScanFrames(segments, query, reader, stats_, scan, error))
+        {
+            return false;
+        }
+
+        // Processes that ended during the lead-in.
+        series.erase(std::remove_if(series.begin(), series.end(), [](const HistorySeries &entry)
+                                    { return entry.points.empty(); }),
+                     series.end());
+        return true;
+    }
+
+    bool HistoryReader::Peaks(const HistoryQuery &query, std::vector<HistoryPeak> &peaks, std::wstring &error)
+    {
+        stats_ = HistoryScanStats{};
+        peaks.clear();
+        if (!CheckQuery(query, error))
+        {
+            return false;
+        }
+
+        const std::vector<HistorySegment> segments = ListHistorySegments(directory_);
+        FrameReader reader;
+        PeakScan scan(query);
+        return ScanFrames(segments, query, reader, stats_, scan, error) && scan.Finish(segments, reader, stats_, peaks, error);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "history_store.h"
+
+namespace rvrse::core
+{
+    struct HistoryQuery
+    {
+        HistoryMetric metric = HistoryMetric::WorkingSetBytes;
+
+        // Unix milliseconds, both inclusive.
+        std::int64_t fromMs = 0;
+        std::int64_t toMs = std::numeric_limits<std::int64_t>::max();
+
+        // ProcessFilter text: a PID, an image name substring, or empty for
+        // every process.
+        std::wstring process;
+
+        // Peaks: only values above this count, and the first time each
+        // process went above it is reported.
+        double over = 0.0;
+
+        // Peaks: how many processes, highest first (0 = all).
+        std::size_t limit = 20;
+    };
+
+    struct HistoryPoint
+    {
+        std::int64_t timestampMs = 0;
+        double value = 0.0;
+    };
+
+    // One process instance: a PID reused by a new process starts a new series.
+    struct HistorySeries
+    {
+        std::uint32_t processId = 0;
+        std::wstring name;
+
+        // The value at fromMs (when the process was already running), then
+        // one point per change.
+        std::vector<HistoryPoint> points;
+    };
+
+    struct HistoryPeak
+    {
+        std::uint32_t processId = 0;
+        std::wstring name;
+        double value = 0.0;
+        std::int64_t timestampMs = 0;
+        std::int64_t firstOverMs = 0;
+    };
+
+    struct HistoryScanStats
+    {
+        std::size_t segments = 0;
+
+        // Frames in the window plus the lead-in from the keyframe before it,
+        // and how many of them had to be read and decoded.
+        std::uint64_t frames = 0;
+        std::uint64_t framesRead = 0;
+        std::uint64_t bytesRead = 0;
+    };
+
+    // Runs queries over a history directory written by HistoryRecorder.
+    // Only the segments overlapping the window are opened, and frames are
+    // ruled out from their index entries where possible: the PID filter
+    // skips frames without a record for the watched processes, and the
+    // per-metric maxima skip frames that cannot beat the threshold (or the
+    // current top N). State at fromMs is rebuilt from the keyframe before it.
+    class HistoryReader
+    {
+    public:
+        explicit HistoryReader(std::wstring directory) : directory_(std::move(directory)) {}
+
+        // Per-process values of query.metric over the window.
+        bool Series(const HistoryQuery &query, std::vector<HistorySeries> &series, std::wstring &error);
+
+        // The highest value each process reached in the window, highest
+        // first; per PID, named after the process holding it at the peak.
+        bool Peaks(const HistoryQuery &query, std::vector<HistoryPeak> &peaks, std::wstring &error);
+
+        // Of the latest query.
+        const HistoryScanStats &Stats() const { return stats_; }
+
+    private:
+        std::wstring directory_;
+        HistoryScanStats stats_;
+    };
+}
@@ -0,0 +1,873 @@
+#include "history_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "binary_codec.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+    namespace history = rvrse::core::history;
+
+    using rvrse::core::codec::PutDouble;
+    using rvrse::core::codec::PutFixed32;
+    using rvrse::core::codec::PutFixed64;
+    using rvrse::core::codec::PutVarint;
+    using rvrse::core::codec::Reader;
+
+    constexpr char kDataMagic[4] = {'R', 'V', 'R', 'H'};
+    constexpr char kIndexMagic[4] = {'R', 'V', 'R', 'X'};
+    constexpr const wchar_t *kDataExtension = L".rvh";
+    constexpr const wchar_t *kIndexExtension = L".rvx";
+    constexpr std::int64_t kDayMilliseconds = 24 * history::kSegmentMilliseconds;
+
+    constexpr const char *kMetricNames[rvrse::core::kHistoryMetricCount] = {
+        "working_set_bytes",
+        "private_bytes",
+        "threads",
+        "handles",
+        "cpu_percent",
+    };
+
+    constexpr std::uint8_t kMetricFields[rvrse::core::kHistoryMetricCount] = {
+        history::kFieldWorkingSet,
+        history::kFieldPrivate,
+        history::kFieldThreads,
+        history::kFieldHandles,
+        history::kFieldCpu,
+    };
+
+    std::size_t MetricIndex(rvrse::core::HistoryMetric metric)
+    {
+        return static_cast<std::size_t>(metric);
+    }
+
+    // Two bit positions out of 512 from one multiplicative hash.
+    std::pair<unsigned, unsigned> BloomBits(std::uint32_t processId)
+    {
+        const std::uint64_t hash = static_cast<std::uint64_t>(processId) * 0x9E3779B97F4A7C15ULL;
+        return {static_cast<unsigned>(hash >> 55), static_cast<unsigned>((hash >> 46) & 511)};
+    }
+
+    double CpuPercent(std::uint64_t cpuTime100ns, std::uint32_t intervalMs)
+    {
+        // 100 ns units over milliseconds: 1 ms = 10,000 units = 100%.
+        return intervalMs == 0 ? 0.0 : static_cast<double>(cpuTime100ns) / (static_cast<double>(intervalMs) * 100.0);
+    }
+
+    std::int64_t FloorDivide(std::int64_t value, std::int64_t divisor)
+    {
+        const std::int64_t quotient = value / divisor;
+        return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+    }
+
+    // Proleptic Gregorian calendar <-> days since 1970-01-01.
+    std::int64_t DaysFromCivil(std::int64_t year, unsigned month, unsigned day)
+    {
+        year -= month <= 2 ? 1 : 0;
+        const std::int64_t era = FloorDivide(year, 400);
+        const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+        const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+    }
+
+    void CivilFromDays(std::int64_t days, std::int64_t &year, unsigned &month, unsigned &day)
+    {
+        days += 719468;
+        const std::int64_t era = FloorDivide(days, 146097);
+        const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+        const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = static_cast<std::int64_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+    }
+
+    // "history-YYYYMMDD-HH" -> segment start, or false for anything else.
+    bool ParseSegmentStem(const std::wstring &stem, std::int64_t &startMs)
+    {
+        constexpr std::wstring_view kPrefix = L"history-";
+        if (stem.size() != kPrefix.size() + 11 || stem.compare(0, kPrefix.size(), kPrefix) != 0 ||
+            stem[kPrefix.size() + 8] != L'-')
+        {
+            return false;
+        }
+
+        unsigned digits[10] = {};
+        std::size_t digit = 0;
+        for (std::size_t index = kPrefix.size(); index < stem.size(); ++index)
+        {
+            if (index == kPrefix.size() + 8)
+            {
+                continue;
+            }
+            if (stem[index] < L'0' || stem[index] > L'9')
+            {
+                return false;
+            }
+            digits[digit++] = static_cast<unsigned>(stem[index] - L'0');
+        }
+
+        const std::int64_t year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+        const unsigned month = digits[4] * 10 + digits[5];
+        const unsigned day = digits[6] * 10 + digits[7];
+        const unsigned hour = digits[8] * 10 + digits[9];
+        if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23)
+        {
+            return false;
+        }
+
+        startMs = DaysFromCivil(year, month, day) * kDayMilliseconds + static_cast<std::int64_t>(hour) * history::kSegmentMilliseconds;
+        return true;
+    }
+
+    void PutHeader(std::string &out, const char (&magic)[4], std::uint16_t extra)
+    {
+        out.append(magic, sizeof(magic));
+        out.push_back(static_cast<char>(history::kVersion & 0xFF));
+        out.push_back(static_cast<char>(history::kVersion >> 8));
+        out.push_back(static_cast<char>(extra & 0xFF));
+        out.push_back(static_cast<char>(extra >> 8));
+    }
+
+    bool CheckHeader(const std::uint8_t *data, std::size_t size, const char (&magic)[4], std::uint16_t extra)
+    {
+        std::string expected;
+        PutHeader(expected, magic, extra);
+        return size >= history::kHeaderBytes && std::memcmp(data, expected.data(), history::kHeaderBytes) == 0;
+    }
+
+    bool ReadHeader(const fs::path &path, const char (&magic)[4], std::uint16_t extra)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::uint8_t header[history::kHeaderBytes] = {};
+        file.read(reinterpret_cast<char *>(header), sizeof(header));
+        return file && CheckHeader(header, sizeof(header), magic, extra);
+    }
+}
+
+namespace rvrse::core
+{
+    const char *HistoryMetricName(HistoryMetric metric)
+    {
+        return kMetricNames[MetricIndex(metric)];
+    }
+
+    bool ParseHistoryMetric(std::string_view name, HistoryMetric &metric)
+    {
+        for (std::size_t index = 0; index < kHistoryMetricCount; ++index)
+        {
+            if (name == kMetricNames[index])
+            {
+                metric = static_cast<HistoryMetric>(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    namespace history
+    {
+        std::int64_t SegmentStart(std::int64_t timestampMs)
+        {
+            return FloorDivide(timestampMs, kSegmentMilliseconds) * kSegmentMilliseconds;
+        }
+
+        std::wstring SegmentName(std::int64_t segmentStartMs)
+        {
+            std::int64_t year = 0;
+            unsigned month = 0;
+            unsigned day = 0;
+            CivilFromDays(FloorDivide(segmentStartMs, kDayMilliseconds), year, month, day);
+            const auto hour = static_cast<unsigned>(FloorDivide(segmentStartMs, kSegmentMilliseconds) - FloorDivide(segmentStartMs, kDayMilliseconds) * 24);
+
+            wchar_t name[32];
+            std::swprintf(name, sizeof(name) / sizeof(name[0]), L"history-%04lld%02u%02u-%02u", static_cast<long long>(year), month, day, hour);
+            return name;
+        }
+    }
+
+    void HistoryFrameSummary::AddProcess(std::uint32_t processId)
+    {
+        const auto [first, second] = BloomBits(processId);
+        processBloom[first / 64] |= 1ULL << (first % 64);
+        processBloom[second / 64] |= 1ULL << (second % 64);
+    }
+
+    bool HistoryFrameSummary::MayContain(std::uint32_t processId) const
+    {
+        const auto [first, second] = BloomBits(processId);
+        return (processBloom[first / 64] & (1ULL << (first % 64))) != 0 && (processBloom[second / 64] & (1ULL << (second % 64))) != 0;
+    }
+
+    double HistoryFrameSummary::MaxValue(HistoryMetric metric) const
+    {
+        const std::uint64_t value = maxValue[MetricIndex(metric)];
+        return metric == HistoryMetric::CpuPercent ? CpuPercent(value, intervalMs) : static_cast<double>(value);
+    }
+
+    void HistoryFrameSummary::Serialize(std::string &out) const
+    {
+        PutFixed64(out, static_cast<std::uint64_t>(timestampMs));
+        PutFixed64(out, generation);
+        PutFixed64(out, offset);
+        PutFixed32(out, sizeBytes);
+        PutFixed32(out, records);
+        PutFixed32(out, flags);
+        PutFixed32(out, intervalMs);
+        for (std::uint64_t word : processBloom)
+        {
+            PutFixed64(out, word);
+        }
+        for (std::uint64_t value : maxValue)
+        {
+            PutFixed64(out, value);
+        }
+    }
+
+    bool HistoryFrameSummary::Deserialize(const std::uint8_t *data, std::size_t size)
+    {
+        Reader reader(data, size);
+        timestampMs = static_cast<std::int64_t>(reader.Fixed64());
+        generation = reader.Fixed64();
+        offset = reader.Fixed64();
+        sizeBytes = reader.Fixed32();
+        records = reader.Fixed32();
+        flags = reader.Fixed32();
+        intervalMs = reader.Fixed32();
+        for (std::uint64_t &word : processBloom)
+        {
+            word = reader.Fixed64();
+        }
+        for (std::uint64_t &value : maxValue)
+        {
+            value = reader.Fixed64();
+        }
+        return reader.Ok();
+    }
+
+    bool HistoryRecord::Has(HistoryMetric metric) const
+    {
+        return (fields & kMetricFields[MetricIndex(metric)]) != 0;
+    }
+
+    double HistoryRecord::Value(HistoryMetric metric, std::uint32_t intervalMs) const
+    {
+        switch (metric)
+        {
+        case HistoryMetric::WorkingSetBytes:
+            return static_cast<double>(workingSetBytes);
+        case HistoryMetric::PrivateBytes:
+            return static_cast<double>(privateBytes);
+        case HistoryMetric::Threads:
+            return static_cast<double>(threadCount);
+        case HistoryMetric::Handles:
+            return static_cast<double>(handleCount);
+        case HistoryMetric::CpuPercent:
+            return CpuPercent(cpuTime100ns, intervalMs);
+        }
+        return 0.0;
+    }
+
+    bool DecodeHistoryFrame(const std::uint8_t *body, std::size_t size, SystemMetrics &metrics, std::vector<HistoryRecord> &records)
+    {
+        Reader reader(body, size);
+        metrics.cpuUsagePercent = reader.Double();
+        metrics.memoryUsagePercent = reader.Double();
+        metrics.physicalMemoryTotalBytes = reader.Varint();
+        metrics.physicalMemoryAvailableBytes = reader.Varint();
+        metrics.uptimeMilliseconds = reader.Varint();
+        metrics.processCount = reader.Varint();
+        metrics.threadCount = reader.Varint();
+        metrics.handleCount = reader.Varint();
+        metrics.connectionCount = reader.Varint();
+
+        records.resize(reader.Count());
+        std::uint32_t processId = 0;
+        for (HistoryRecord &record : records)
+        {
+            record = HistoryRecord{};
+            processId += reader.Varint32();
+            record.processId = processId;
+            record.fields = reader.Byte();
+
+            if (record.fields & history::kFieldName)
+            {
+                const std::size_t length = reader.Count();
+                const std::uint8_t *name = reader.Take(length);
+                if (name)
+                {
+                    record.name = std::string_view(reinterpret_cast<const char *>(name), length);
+                }
+            }
+            if (record.fields & history::kFieldParent)
+            {
+                record.parentProcessId = reader.Varint32();
+            }
+            if (record.fields & history::kFieldThreads)
+            {
+                record.threadCount = reader.Varint32();
+            }
+            if (record.fields & history::kFieldWorkingSet)
+            {
+                record.workingSetBytes = reader.Varint();
+            }
+            if (record.fields & history::kFieldPrivate)
+            {
+                record.privateBytes = reader.Varint();
+            }
+            if (record.fields & history::kFieldHandles)
+            {
+                record.handleCount = reader.Varint32();
+            }
+            if (record.fields & history::kFieldCpu)
+            {
+                record.cpuTime100ns = reader.Varint();
+            }
+            if (!reader.Ok())
+            {
+                return false;
+            }
+        }
+        return reader.AtEnd();
+    }
+
+    void HistoryEncoder::Encode(const CollectorFrame &frame, std::string &body, HistoryFrameSummary &summary)
+    {
+        using namespace history;
+
+        const auto &processes = frame.processes.Processes();
+        const std::int64_t timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(frame.timestamp.time_since_epoch()).count();
+        const std::int64_t segmentStartMs = SegmentStart(timestampMs);
+
+        const bool keyframe = forceKeyframe_ || segmentStartMs != segmentStartMs_ || keyframeInterval_ <= 1 ||
+                              framesSinceKeyframe_ + 1 >= keyframeInterval_;
+        forceKeyframe_ = false;
+        framesSinceKeyframe_ = keyframe ? 0 : framesSinceKeyframe_ + 1;
+        segmentStartMs_ = segmentStartMs;
+
+        if (frame.handlesRefreshed)
+        {
+            CountHandles(frame.handles);
+        }
+
+        summary = HistoryFrameSummary{};
+        summary.timestampMs = timestampMs;
+        summary.generation = frame.generation;
+        summary.flags = keyframe ? kFrameKeyframe : 0;
+        if (hasPrevious_ && timestampMs > previousTimestampMs_)
+        {
+            summary.intervalMs = static_cast<std::uint32_t>(std::min<std::int64_t>(timestampMs - previousTimestampMs_, 0xFFFFFFFFLL));
+        }
+
+        const SystemMetrics &metrics = frame.metrics;
+        body.clear();
+        PutDouble(body, metrics.cpuUsagePercent);
+        PutDouble(body, metrics.memoryUsagePercent);
+        PutVarint(body, metrics.physicalMemoryTotalBytes);
+        PutVarint(body, metrics.physicalMemoryAvailableBytes);
+        PutVarint(body, metrics.uptimeMilliseconds);
+        PutVarint(body, metrics.processCount);
+        PutVarint(body, metrics.threadCount);
+        PutVarint(body, metrics.handleCount);
+        PutVarint(body, metrics.connectionCount);
+
+        records_.clear();
+        std::uint32_t recordCount = 0;
+        std::uint32_t previousRecordId = 0;
+        const auto beginRecord = [&](std::uint32_t processId, std::uint8_t fields)
+        {
+            PutVarint(records_, processId - previousRecordId);
+            records_.push_back(static_cast<char>(fields));
+            previousRecordId = processId;
+            ++recordCount;
+            summary.AddProcess(processId);
+        };
+        const auto trackMax = [&summary](HistoryMetric metric, std::uint64_t value)
+        {
+            std::uint64_t &max = summary.maxValue[MetricIndex(metric)];
+            max = std::max(max, value);
+        };
+        const auto recordExit = [&](std::uint32_t processId)
+        {
+            beginRecord(processId, kFieldExit);
+            summary.flags |= kFrameExits;
+        };
+
+        current_.clear();
+        current_.reserve(processes.size());
+
+        auto previous = previous_.cbegin();
+        auto handles = handleCounts_.cbegin();
+        for (const ProcessEntry &process : processes)
+        {
+            // A keyframe lists every live process; readers drop whatever it
+            // leaves out, so it carries no exits.
+            for (; previous != previous_.cend() && previous->processId < process.processId; ++previous)
+            {
+                if (!keyframe)
+                {
+                    recordExit(previous->processId);
+                }
+            }
+            while (handles != handleCounts_.cend() && handles->first < process.processId)
+            {
+                ++handles;
+            }
+
+            ProcessState state;
+            state.processId = process.processId;
+            state.parentProcessId = process.parentProcessId;
+            state.threadCount = process.threadCount;
+            state.handleCount = handles != handleCounts_.cend() && handles->first == process.processId ? handles->second : 0;
+            state.workingSetBytes = process.workingSetBytes;
+            state.privateBytes = process.privateBytes;
+            state.cpuTime100ns = process.kernelTime100ns + process.userTime100ns;
+            state.nameId = process.imageName.Id();
+            current_.push_back(state);
+
+            const ProcessState *before = nullptr;
+            if (previous != previous_.cend() && previous->processId == process.processId)
+            {
+                before = &*previous;
+                ++previous;
+            }
+
+            // A process the previous frame did not have used all of its CPU
+            // time inside this interval.
+            std::uint64_t cpuUsed = 0;
+            if (summary.intervalMs > 0)
+            {
+                cpuUsed = before && state.cpuTime100ns >= before->cpuTime100ns ? state.cpuTime100ns - before->cpuTime100ns : state.cpuTime100ns;
+            }
+
+            std::uint8_t fields = 0;
+            if (keyframe || !before || before->nameId != state.nameId)
+            {
+                fields = kFieldName | kFieldParent | kFieldThreads | kFieldWorkingSet | kFieldPrivate | kFieldHandles;
+                summary.flags |= kFrameNewProcesses;
+            }
+            else
+            {
+                fields |= state.parentProcessId != before->parentProcessId ? kFieldParent : 0;
+                fields |= state.threadCount != before->threadCount ? kFieldThreads : 0;
+                fields |= state.workingSetBytes != before->workingSetBytes ? kFieldWorkingSet : 0;
+                fields |= state.privateBytes != before->privateBytes ? kFieldPrivate : 0;
+                fields |= state.handleCount != before->handleCount ? kFieldHandles : 0;
+            }
+            fields |= cpuUsed > 0 ? kFieldCpu : 0;
+            if (fields == 0)
+            {
+                continue;
+            }
+
+            beginRecord(process.processId, fields);
+            if (fields & kFieldName)
+            {
+                const std::string_view name = process.imageName.Utf8();
+                PutVarint(records_, name.size());
+                records_ += name;
+            }
+            if (fields & kFieldParent)
+            {
+                PutVarint(records_, state.parentProcessId);
+            }
+            if (fields & kFieldThreads)
+            {
+                PutVarint(records_, state.threadCount);
+                trackMax(HistoryMetric::Threads, state.threadCount);
+            }
+            if (fields & kFieldWorkingSet)
+            {
+                PutVarint(records_, state.workingSetBytes);
+                trackMax(HistoryMetric::WorkingSetBytes, state.workingSetBytes);
+            }
+            if (fields & kFieldPrivate)
+            {
+                PutVarint(records_, state.privateBytes);
+                trackMax(HistoryMetric::PrivateBytes, state.privateBytes);
+            }
+            if (fields & kFieldHandles)
+            {
+                PutVarint(records_, state.handleCount);
+                trackMax(HistoryMetric::Handles, state.handleCount);
+            }
+            if (fields & kFieldCpu)
+            {
+                PutVarint(records_, cpuUsed);
+                trackMax(HistoryMetric::CpuPercent, cpuUsed);
+            }
+        }
+        for (; previous != previous_.cend(); ++previous)
+        {
+            if (!keyframe)
+            {
+                recordExit(previous->processId);
+            }
+        }
+
+        PutVarint(body, recordCount);
+        body += records_;
+        summary.records = recordCount;
+        summary.sizeBytes = static_cast<std::uint32_t>(body.size());
+
+        previous_.swap(current_);
+        previousTimestampMs_ = timestampMs;
+        hasPrevious_ = true;
+    }
+
+    void HistoryEncoder::CountHandles(const HandleSnapshot &handles)
+    {
+        handleOwners_.clear();
+        handleOwners_.reserve(handles.Handles().size());
+        for (const HandleEntry &handle : handles.Handles())
+        {
+            handleOwners_.push_back(handle.processId);
+        }
+        std::sort(handleOwners_.begin(), handleOwners_.end());
+
+        handleCounts_.clear();
+        for (std::size_t index = 0; index < handleOwners_.size();)
+        {
+            std::size_t end = index + 1;
+            while (end < handleOwners_.size() && handleOwners_[end] == handleOwners_[index])
+            {
+                ++end;
+            }
+            handleCounts_.emplace_back(handleOwners_[index], static_cast<std::uint32_t>(end - index));
+            index = end;
+        }
+    }
+
+    HistoryWriter::HistoryWriter(std::wstring directory, std::uint32_t retentionHours)
+        : directory_(std::move(directory)),
+          retentionHours_(retentionHours)
+    {
+    }
+
+    bool HistoryWriter::Open(std::wstring &error)
+    {
+        Close();
+
+        std::error_code ec;
+        fs::create_directories(fs::path(directory_), ec);
+        if (!fs::is_directory(fs::path(directory_), ec))
+        {
+            error = L"cannot create history directory '" + directory_ + L"'";
+            return false;
+        }
+        return true;
+    }
+
+    void HistoryWriter::Close()
+    {
+        data_.Close();
+        index_.Close();
+        segmentStartMs_ = -1;
+    }
+
+    bool HistoryWriter::Append(HistoryFrameSummary summary, const std::string &body)
+    {
+        const std::int64_t segmentStartMs = history::SegmentStart(summary.timestampMs);
+        if (segmentStartMs != segmentStartMs_)
+        {
+            if ((summary.flags & history::kFrameKeyframe) == 0 || !OpenSegment(segmentStartMs))
+            {
+                return false;
+            }
+        }
+
+        summary.offset = dataSize_;
+        summary.sizeBytes = static_cast<std::uint32_t>(body.size());
+        entry_.clear();
+        summary.Serialize(entry_);
+
+        if (!data_.Write(body.data(), body.size()) || !data_.Flush())
+        {
+            Close();
+            return false;
+        }
+        dataSize_ += body.size();
+
+        if (!index_.Write(entry_.data(), entry_.size()) || !index_.Flush())
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool HistoryWriter::OpenSegment(std::int64_t segmentStartMs)
+    {
+        Close();
+
+        const fs::path base = fs::path(directory_) / history::SegmentName(segmentStartMs);
+        fs::path dataPath = base;
+        dataPath += kDataExtension;
+        fs::path indexPath = base;
+        indexPath += kIndexExtension;
+
+        // Append to a segment from an earlier run of the same hour when both
+        // files are intact; otherwise start it over.
+        std::error_code ec;
+        const std::uintmax_t dataSize = fs::file_size(dataPath, ec);
+        const bool dataValid = !ec && ReadHeader(dataPath, kDataMagic, 0);
+        const std::uintmax_t indexSize = fs::file_size(indexPath, ec);
+        const bool indexValid = !ec && ReadHeader(indexPath, kIndexMagic, static_cast<std::uint16_t>(history::kIndexEntryBytes));
+        const bool append = dataValid && indexValid;
+
+        if (append)
+        {
+            const std::uintmax_t entries = (indexSize - history::kHeaderBytes) / history::kIndexEntryBytes;
+            const std::uintmax_t complete = history::kHeaderBytes + entries * history::kIndexEntryBytes;
+            if (complete != indexSize)
+            {
+                fs::resize_file(indexPath, complete, ec);
+                if (ec)
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (!data_.Open(dataPath.wstring(), append) || !index_.Open(indexPath.wstring(), append))
+        {
+            Close();
+            return false;
+        }
+
+        if (append)
+        {
+            dataSize_ = dataSize;
+        }
+        else
+        {
+            std::string header;
+            PutHeader(header, kDataMagic, 0);
+            PutHeader(header, kIndexMagic, static_cast<std::uint16_t>(history::kIndexEntryBytes));
+            if (!data_.Write(header.data(), history::kHeaderBytes) ||
+                !index_.Write(header.data() + history::kHeaderBytes, history::kHeaderBytes))
+            {
+                Close();
+                return false;
+            }
+            dataSize_ = history::kHeaderBytes;
+        }
+
+        segmentStartMs_ = segmentStartMs;
+        RemoveExpiredSegments(segmentStartMs);
+        return true;
+    }
+
+    void HistoryWriter::RemoveExpiredSegments(std::int64_t segmentStartMs)
+    {
+        if (retentionHours_ == 0)
+        {
+            return;
+        }
+
+        const std::int64_t cutoffMs = segmentStartMs - static_cast<std::int64_t>(retentionHours_) * history::kSegmentMilliseconds;
+        for (const HistorySegment &segment : ListHistorySegments(directory_))
+        {
+            if (segment.startMs >= cutoffMs)
+            {
+                break;
+            }
+            std::error_code ec;
+            fs::remove(fs::path(segment.indexPath), ec);
+            fs::remove(fs::path(segment.dataPath), ec);
+        }
+    }
+
+    std::vector<HistorySegment> ListHistorySegments(const std::wstring &directory)
+    {
+        std::vector<HistorySegment> segments;
+
+        std::error_code ec;
+        for (fs::directory_iterator entry(fs::path(directory), ec), end; !ec && entry != end; entry.increment(ec))
+        {
+            const fs::path &path = entry->path();
+            HistorySegment segment;
+            if (path.extension() != kIndexExtension || !ParseSegmentStem(path.stem().wstring(), segment.startMs))
+            {
+                continue;
+            }
+
+            fs::path dataPath = path;
+            dataPath.replace_extension(kDataExtension);
+            std::error_code existsError;
+            if (!fs::is_regular_file(dataPath, existsError))
+            {
+                continue;
+            }
+
+            segment.indexPath = path.wstring();
+            segment.dataPath = dataPath.wstring();
+            segments.push_back(std::move(segment));
+        }
+
+        std::sort(segments.begin(), segments.end(), [](const HistorySegment &lhs, const HistorySegment &rhs)
+                  { return lhs.startMs < rhs.startMs; });
+        return segments;
+    }
+
+    bool LoadHistoryIndex(const HistorySegment &segment, std::vector<HistoryFrameSummary> &frames, std::wstring &error)
+    {
+        frames.clear();
+
+        std::ifstream file(fs::path(segment.indexPath), std::ios::binary);
+        const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const auto *bytes = reinterpret_cast<const std::uint8_t *>(contents.data());
+        if (!file.good() && !file.eof())
+        {
+            error = L"cannot read '" + segment.indexPath + L"'";
+            return false;
+        }
+        if (!CheckHeader(bytes, contents.size(), kIndexMagic, static_cast<std::uint16_t>(history::kIndexEntryBytes)))
+        {
+            error = L"'" + segment.indexPath + L"' is not a history index";
+            return false;
+        }
+
+        std::error_code ec;
+        const std::uintmax_t dataSize = fs::file_size(fs::path(segment.dataPath), ec);
+        if (ec || !ReadHeader(fs::path(segment.dataPath), kDataMagic, 0))
+        {
+            error = L"'" + segment.dataPath + L"' is not a history data file";
+            return false;
+        }
+
+        const std::size_t entries = (contents.size() - history::kHeaderBytes) / history::kIndexEntryBytes;
+        frames.reserve(entries);
+        for (std::size_t index = 0; index < entries; ++index)
+        {
+            HistoryFrameSummary summary;
+            if (!summary.Deserialize(bytes + history::kHeaderBytes + index * history::kIndexEntryBytes, history::kIndexEntryBytes) ||
+                summary.offset < history::kHeaderBytes || summary.offset + summary.sizeBytes > dataSize)
+            {
+                break;
+            }
+            frames.push_back(summary);
+        }
+        return true;
+    }
+
+    HistoryRecorder::HistoryRecorder(HistoryOptions options)
+        : options_(std::move(options)),
+          encoder_(options_.keyframeInterval),
+          writer_(options_.directory, options_.retentionHours)
+    {
+    }
+
+    HistoryRecorder::~HistoryRecorder()
+    {
+        Stop();
+    }
+
+    bool HistoryRecorder::Start(std::wstring &error)
+    {
+        Stop();
+
+        if (!writer_.Open(error))
+        {
+            return false;
+        }
+
+        encoder_.ForceKeyframe();
+        stopRequested_ = false;
+        started_ = true;
+        thread_ = std::thread(&HistoryRecorder::WriterLoop, this);
+        return true;
+    }
+
+    void HistoryRecorder::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopRequested_ = true;
+        }
+        wake_.notify_all();
+
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+
+        writer_.Close();
+        started_ = false;
+    }
+
+    void HistoryRecorder::Export(const CollectorFrame &frame)
+    {
+        if (!started_)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pendingReady_ || writing_)
+            {
+                framesDropped_.fetch_add(1, std::memory_order_relaxed);
+                encoder_.ForceKeyframe();
+                return;
+            }
+        }
+
+        if (outputLost_.exchange(false, std::memory_order_relaxed))
+        {
+            encoder_.ForceKeyframe();
+        }
+
+        encoder_.Encode(frame, encoding_, encodingSummary_);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(encoding_, pending_);
+            std::swap(encodingSummary_, pendingSummary_);
+            pendingReady_ = true;
+        }
+        wake_.notify_one();
+    }
+
+    void HistoryRecorder::WriterLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            wake_.wait(lock, [this]()
+                       { return pendingReady_ || stopRequested_; });
+            if (!pendingReady_)
+            {
+                return;
+            }
+
+            pendingReady_ = false;
+            writing_ = true;
+            lock.unlock();
+
+            if (writer_.Append(pendingSummary_, pending_))
+            {
+                framesWritten_.fetch_add(1, std::memory_order_relaxed);
+                bytesWritten_.fetch_add(pending_.size() + history::kIndexEntryBytes, std::memory_order_relaxed);
+            }
+            else
+            {
+                // The segment is closed and only a keyframe reopens it.
+                framesDropped_.fetch_add(1, std::memory_order_relaxed);
+                outputLost_.store(true, std::memory_order_relaxed);
+            }
+
+            lock.lock();
+            writing_ = false;
+        }
+    }
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "collector.h"
+#include "output_sink.h"
+
+namespace rvrse::core
+{
+    // Per-process values kept in recorded history.
+    enum class HistoryMetric
+    {
+        WorkingSetBytes,
+        PrivateBytes,
+        Threads,
+        Handles,
+
+        // Usage over the interval since the previous frame.
+        CpuPercent,
+    };
+
+    constexpr std::size_t kHistoryMetricCount = 5;
+
+    // "working_set_bytes", "private_bytes", "threads", "handles", "cpu_percent".
+    const char *HistoryMetricName(HistoryMetric metric);
+    bool ParseHistoryMetric(std::string_view name, HistoryMetric &metric);
+
+    // On-disk layout of recorded history (docs/headless-agent.md). Frames are
+    // grouped into hourly segments (UTC), each a data file of frame bodies
+    // and an index file of fixed-size frame summaries:
+    //
+    //   history-YYYYMMDD-HH.rvh  "RVRH" u16 version u16 0, then frame bodies
+    //   history-YYYYMMDD-HH.rvx  "RVRX" u16 version u16 entry size, then
+    //                            HistoryFrameSummary entries
+    //
+    // A body is the system figures followed by PID-sorted process records:
+    // a varint PID delta, a field mask and the masked fields in mask order.
+    // Every field is a full value, not a difference, so a record can be read
+    // without the frames before it; a delta frame only lists the processes
+    // that changed. Each segment starts with a keyframe listing every process.
+    namespace history
+    {
+        constexpr std::uint16_t kVersion = 1;
+        constexpr std::size_t kHeaderBytes = 8;
+        constexpr std::size_t kIndexEntryBytes = 144;
+        constexpr std::int64_t kSegmentMilliseconds = 3600 * 1000;
+
+        // 512-bit PID filter per frame.
+        constexpr std::size_t kBloomWords = 8;
+
+        // HistoryFrameSummary::flags.
+        constexpr std::uint32_t kFrameKeyframe = 0x01;
+        constexpr std::uint32_t kFrameNewProcesses = 0x02; // some record carries a name
+        constexpr std::uint32_t kFrameExits = 0x04;
+
+        // Record field mask. kFieldName marks a process the previous frame
+        // did not have (or every process of a keyframe) and comes with all
+        // fields; kFieldExit comes alone.
+        constexpr std::uint8_t kFieldName = 0x01;
+        constexpr std::uint8_t kFieldParent = 0x02;
+        constexpr std::uint8_t kFieldThreads = 0x04;
+        constexpr std::uint8_t kFieldWorkingSet = 0x08;
+        constexpr std::uint8_t kFieldPrivate = 0x10;
+        constexpr std::uint8_t kFieldHandles = 0x20;
+        constexpr std::uint8_t kFieldCpu = 0x40; // absent: no CPU used in the interval
+        constexpr std::uint8_t kFieldExit = 0x80;
+
+        // Start of the segment a Unix millisecond timestamp falls in.
+        std::int64_t SegmentStart(std::int64_t timestampMs);
+
+        // "history-YYYYMMDD-HH" for a segment start.
+        std::wstring SegmentName(std::int64_t segmentStartMs);
+    }
+
+    // Index entry of one frame: where it is and an upper bound on what it
+    // holds, so queries can rule frames out without reading them.
+    struct HistoryFrameSummary
+    {
+        std::int64_t timestampMs = 0;
+        std::uint64_t generation = 0;
+        std::uint64_t offset = 0;
+        std::uint32_t sizeBytes = 0;
+        std::uint32_t records = 0;
+        std::uint32_t flags = 0;
+
+        // Since the previous frame; CPU records cover this interval. 0 for
+        // the first frame after the recorder (re)started.
+        std::uint32_t intervalMs = 0;
+
+        // PIDs with a record in this frame (two bits per PID).
+        std::uint64_t processBloom[history::kBloomWords] = {};
+
+        // Largest value of each metric among the records, by HistoryMetric;
+        // CPU as 100 ns units used in the interval.
+        std::uint64_t maxValue[kHistoryMetricCount] = {};
+
+        void AddProcess(std::uint32_t processId);
+        bool MayContain(std::uint32_t processId) const;
+
+        // maxValue converted like HistoryRecord::Value().
+        double MaxValue(HistoryMetric metric) const;
+
+        void Serialize(std::string &out) const;
+        bool Deserialize(const std::uint8_t *data, std::size_t size);
+    };
+
+    struct HistoryRecord
+    {
+        std::uint32_t processId = 0;
+        std::uint8_t fields = 0;
+
+        // UTF-8, pointing into the decoded body.
+        std::string_view name;
+
+        std::uint32_t parentProcessId = 0;
+        std::uint32_t threadCount = 0;
+        std::uint64_t workingSetBytes = 0;
+        std::uint64_t privateBytes = 0;
+        std::uint32_t handleCount = 0;
+        std::uint64_t cpuTime100ns = 0;
+
+        bool Has(HistoryMetric metric) const;
+
+        // CPU as a percentage of one core over intervalMs.
+        double Value(HistoryMetric metric, std::uint32_t intervalMs) const;
+    };
+
+    // Decodes a frame body. records keeps its capacity across calls; names
+    // point into body, which must outlive them.
+    bool DecodeHistoryFrame(const std::uint8_t *body, std::size_t size, SystemMetrics &metrics, std::vector<HistoryRecord> &records);
+
+    // Turns collector generations into frame bodies and summaries. Keeps a
+    // compact copy of the previous generation to find what changed, and the
+    // per-process handle counts of the latest handle capture.
+    class HistoryEncoder
+    {
+    public:
+        explicit HistoryEncoder(std::uint32_t keyframeInterval = 60) : keyframeInterval_(keyframeInterval) {}
+
+        // Replaces body with the frame; summary.offset is left to the writer.
+        void Encode(const CollectorFrame &frame, std::string &body, HistoryFrameSummary &summary);
+
+        // Makes the next Encode() a keyframe, e.g. after a write failed.
+        void ForceKeyframe() { forceKeyframe_ = true; }
+
+    private:
+        struct ProcessState
+        {
+            std::uint32_t processId = 0;
+            std::uint32_t parentProcessId = 0;
+            std::uint32_t threadCount = 0;
+            std::uint32_t handleCount = 0;
+            std::uint64_t workingSetBytes = 0;
+            std::uint64_t privateBytes = 0;
+            std::uint64_t cpuTime100ns = 0;
+            std::uint32_t nameId = 0;
+        };
+
+        void CountHandles(const HandleSnapshot &handles);
+
+        std::uint32_t keyframeInterval_;
+        std::uint64_t framesSinceKeyframe_ = 0;
+        bool forceKeyframe_ = true;
+        std::int64_t segmentStartMs_ = 0;
+        std::int64_t previousTimestampMs_ = 0;
+        bool hasPrevious_ = false;
+
+        // PID-sorted like the snapshot, so changes are a merge walk.
+        std::vector<ProcessState> previous_;
+        std::vector<ProcessState> current_;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> handleCounts_;
+        std::vector<std::uint32_t> handleOwners_;
+        std::string records_;
+    };
+
+    // Appends encoded frames to the segment files of a directory. The data
+    // is flushed before its index entry is written, so an index never points
+    // past the data after a crash; a torn trailing index entry is cut off
+    // when the segment is reopened.
+    class HistoryWriter
+    {
+    public:
+        // retentionHours == 0 keeps every segment.
+        HistoryWriter(std::wstring directory, std::uint32_t retentionHours);
+
+        // Creates the directory if needed.
+        bool Open(std::wstring &error);
+        void Close();
+
+        // The first frame of a segment must be a keyframe; a frame that
+        // would start a segment otherwise is refused (returns false).
+        bool Append(HistoryFrameSummary summary, const std::string &body);
+
+    private:
+        bool OpenSegment(std::int64_t segmentStartMs);
+        void RemoveExpiredSegments(std::int64_t segmentStartMs);
+
+        std::wstring directory_;
+        std::uint32_t retentionHours_;
+        FileSink data_;
+        FileSink index_;
+        std::uint64_t dataSize_ = 0;
+        std::int64_t segmentStartMs_ = -1;
+        std::string entry_;
+    };
+
+    struct HistorySegment
+    {
+        std::int64_t startMs = 0;
+        std::wstring dataPath;
+        std::wstring indexPath;
+    };
+
+    // Segments of a history directory, oldest first; missing directory or
+    // stray files are not errors.
+    std::vector<HistorySegment> ListHistorySegments(const std::wstring &directory);
+
+    // Loads a segment's index; entries past the last complete one, or past
+    // the end of the data file, are ignored.
+    bool LoadHistoryIndex(const HistorySegment &segment, std::vector<HistoryFrameSummary> &frames, std::wstring &error);
+
+    struct HistoryOptions
+    {
+        std::wstring directory;
+        std::uint32_t keyframeInterval = 60;
+        std::uint32_t retentionHours = 72;
+    };
+
+    // "history" exporter: records every generation for rvrse-query. Frames
+    // are encoded on the sampling thread and written by a writer thread;
+    // while it is still busy with the previous frame new ones are dropped
+    // (and counted), and the next one written is a keyframe.
+    class HistoryRecorder final : public CollectorExporter
+    {
+    public:
+        explicit HistoryRecorder(HistoryOptions options);
+        ~HistoryRecorder() override;
+
+        bool Start(std::wstring &error);
+        void Stop();
+
+        const wchar_t *Name() const override { return L"history"; }
+        void Export(const CollectorFrame &frame) override;
+
+        std::uint64_t FramesWritten() const { return framesWritten_.load(std::memory_order_relaxed); }
+        std::uint64_t FramesDropped() const { return framesDropped_.load(std::memory_order_relaxed); }
+        std::uint64_t BytesWritten() const { return bytesWritten_.load(std::memory_order_relaxed); }
+
+    private:
+        void WriterLoop();
+
+        HistoryOptions options_;
+        HistoryEncoder encoder_;
+        HistoryWriter writer_;
+        bool started_ = false;
+
+        // encoding_ belongs to the sampling thread; pending_ to the writer
+        // thread while writing_ is set. They are swapped under mutex_.
+        std::string encoding_;
+        std::string pending_;
+        HistoryFrameSummary encodingSummary_;
+        HistoryFrameSummary pendingSummary_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::thread thread_;
+        bool pendingReady_ = false;
+        bool writing_ = false;
+        bool stopRequested_ = false;
+
+        std::atomic<bool> outputLost_{false};
+        std::atomic<std::uint64_t> framesWritten_{0};
+        std::atomic<std::uint64_t> framesDropped_{0};
+        std::atomic<std::uint64_t> bytesWritten_{0};
+    };
+}
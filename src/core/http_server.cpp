@@ -0,0 +1,177 @@
+#include "http_server.h"
+
+#include <chrono>
+#include <utility>
+
+namespace
+{
+    // Checked between clients, so Stop() never waits longer than this.
+    constexpr std::chrono::milliseconds kAcceptPollInterval{200};
+
+    // Scrapers send a request line and a few headers; anything slower or
+    // larger is dropped rather than tying up the only serving thread. The
+    // timeout covers the whole request, not each read, so a client trickling
+    // bytes cannot hold the thread either.
+    constexpr std::chrono::milliseconds kRequestTimeout{2000};
+    constexpr std::size_t kMaxRequestBytes = 8 * 1024;
+
+    // The same for the response: a scraper that stops reading, or reads a
+    // few bytes at a time, is dropped once this passes, which also bounds
+    // how long Stop() can wait for the serving thread. Generous enough for
+    // a large process list over a slow link.
+    constexpr std::chrono::milliseconds kResponseTimeout{5000};
+
+    const char *ReasonPhrase(int status)
+    {
+        switch (status)
+        {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 503:
+            return "Service Unavailable";
+        default:
+            return "Error";
+        }
+    }
+
+    bool SendResponse(rvrse::core::Socket &client, const rvrse::core::HttpResponse &response, bool includeBody)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + kResponseTimeout;
+        const std::size_t bodySize = response.body ? response.body->size() : 0;
+
+        std::string header = "HTTP/1.1 ";
+        header += std::to_string(response.status);
+        header += ' ';
+        header += ReasonPhrase(response.status);
+        header += "\r\nContent-Type: ";
+        header += response.contentType;
+        header += "\r\nContent-Length: ";
+        header += std::to_string(bodySize);
+        header += "\r\nConnection: close\r\n\r\n";
+
+        if (!client.SendAll(header.data(), header.size(), deadline))
+        {
+            return false;
+        }
+        return !includeBody || bodySize == 0 || client.SendAll(response.body->data(), bodySize, deadline);
+    }
+
+    rvrse::core::HttpResponse TextResponse(int status, const char *text)
+    {
+        rvrse::core::HttpResponse response;
+        response.status = status;
+        response.body = std::make_shared<const std::string>(text);
+        return response;
+    }
+}
+
+namespace rvrse::core
+{
+    HttpServer::~HttpServer()
+    {
+        Stop();
+    }
+
+    bool HttpServer::Start(const std::string &address, std::uint16_t port, Handler handler)
+    {
+        Stop();
+        if (!handler || !listener_.ListenTcp(address, port))
+        {
+            return false;
+        }
+
+        handler_ = std::move(handler);
+        port_ = listener_.LocalPort();
+        stopRequested_.store(false);
+        thread_ = std::thread(&HttpServer::ServeLoop, this);
+        return true;
+    }
+
+    void HttpServer::Stop()
+    {
+        stopRequested_.store(true);
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+        listener_.Close();
+        port_ = 0;
+    }
+
+    void HttpServer::ServeLoop()
+    {
+        Socket client;
+        while (!stopRequested_.load(std::memory_order_relaxed))
+        {
+            if (listener_.Accept(client, kAcceptPollInterval))
+            {
+                // Reads already poll; non-blocking sends let SendAll() keep
+                // to the response deadline.
+                client.SetNonBlocking(true);
+                ServeClient(client);
+                client.Close();
+            }
+        }
+    }
+
+    void HttpServer::ServeClient(Socket &client)
+    {
+        std::string request;
+        char buffer[1024];
+        const auto deadline = std::chrono::steady_clock::now() + kRequestTimeout;
+        while (request.find("\r\n\r\n") == std::string::npos)
+        {
+            if (request.size() >= kMaxRequestBytes)
+            {
+                SendResponse(client, TextResponse(400, "request too large\n"), true);
+                return;
+            }
+
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+            {
+                return;
+            }
+
+            const auto received = client.Receive(buffer, sizeof(buffer), remaining);
+            if (received <= 0)
+            {
+                return;
+            }
+            request.append(buffer, static_cast<std::size_t>(received));
+        }
+
+        // Request line: METHOD SP target SP version.
+        const std::string_view line = std::string_view(request).substr(0, request.find("\r\n"));
+        const std::size_t methodEnd = line.find(' ');
+        const std::size_t targetEnd = methodEnd == std::string_view::npos ? std::string_view::npos : line.find(' ', methodEnd + 1);
+        if (targetEnd == std::string_view::npos)
+        {
+            SendResponse(client, TextResponse(400, "malformed request line\n"), true);
+            return;
+        }
+
+        const std::string_view method = line.substr(0, methodEnd);
+        std::string_view path = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        path = path.substr(0, path.find('?'));
+
+        const bool head = method == "HEAD";
+        if (method != "GET" && !head)
+        {
+            SendResponse(client, TextResponse(405, "only GET and HEAD are supported\n"), true);
+            return;
+        }
+
+        if (SendResponse(client, handler_(path), !head))
+        {
+            requestsServed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "socket.h"
+
+namespace rvrse::core
+{
+    struct HttpResponse
+    {
+        int status = 200;
+        std::string contentType = "text/plain; charset=utf-8";
+
+        // Shared so handlers can serve a pre-rendered buffer without copying it.
+        std::shared_ptr<const std::string> body;
+    };
+
+    // Minimal HTTP/1.1 endpoint for scrapers and health checks: GET/HEAD only,
+    // one request per connection, requests handled one at a time on a single
+    // background thread. Not meant to face untrusted networks beyond that.
+    class HttpServer
+    {
+    public:
+        using Handler = std::function<HttpResponse(std::string_view path)>;
+
+        HttpServer() = default;
+        ~HttpServer();
+
+        HttpServer(const HttpServer &) = delete;
+        HttpServer &operator=(const HttpServer &) = delete;
+
+        // Binds address:port (port 0 picks one; see Port()) and starts serving.
+        bool Start(const std::string &address, std::uint16_t port, Handler handler);
+        void Stop();
+
+        bool IsRunning() const { return listener_.IsOpen(); }
+        std::uint16_t Port() const { return port_; }
+        std::uint64_t RequestsServed() const { return requestsServed_.load(std::memory_order_relaxed); }
+
+    private:
+        void ServeLoop();
+        void ServeClient(Socket &client);
+
+        Socket listener_;
+        Handler handler_;
+        std::thread thread_;
+        std::atomic<bool> stopRequested_{false};
+        std::atomic<std::uint64_t> requestsServed_{0};
+        std::uint16_t port_ = 0;
+    };
+}
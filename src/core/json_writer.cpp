@@ -0,0 +1,354 @@
+#include "json_writer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr char kHexDigits[] = "0123456789abcdef";
+
+    // Strings are escaped in slices so the worst case (6 output bytes per
+    // input unit) always fits in one reserved block.
+    constexpr std::size_t kSliceUnits = 4096;
+    constexpr std::size_t kMaxBytesPerUnit = 6;
+
+    // Writes the escape for an ASCII byte that needs one, or returns nullptr.
+    char *EscapeAscii(char *out, unsigned char ch)
+    {
+        switch (ch)
+        {
+        case '"':
+            *out++ = '\\';
+            *out++ = '"';
+            return out;
+        case '\\':
+            *out++ = '\\';
+            *out++ = '\\';
+            return out;
+        case '\n':
+            *out++ = '\\';
+            *out++ = 'n';
+            return out;
+        case '\r':
+            *out++ = '\\';
+            *out++ = 'r';
+            return out;
+        case '\t':
+            *out++ = '\\';
+            *out++ = 't';
+            return out;
+        default:
+            break;
+        }
+
+        if (ch < 0x20)
+        {
+            *out++ = '\\';
+            *out++ = 'u';
+            *out++ = '0';
+            *out++ = '0';
+            *out++ = kHexDigits[ch >> 4];
+            *out++ = kHexDigits[ch & 0xF];
+            return out;
+        }
+        return nullptr;
+    }
+
+    bool NeedsEscape(unsigned char ch)
+    {
+        return ch < 0x20 || ch == '"' || ch == '\\';
+    }
+}
+
+namespace rvrse::core
+{
+    void JsonWriter::BeginObject()
+    {
+        BeforeValue();
+        Put('{');
+        hasValue_[++depth_] = false;
+    }
+
+    void JsonWriter::EndObject()
+    {
+        Put('}');
+        --depth_;
+    }
+
+    void JsonWriter::BeginArray()
+    {
+        BeforeValue();
+        Put('[');
+        hasValue_[++depth_] = false;
+    }
+
+    void JsonWriter::EndArray()
+    {
+        Put(']');
+        --depth_;
+    }
+
+    void JsonWriter::Key(std::string_view key)
+    {
+        // Separator, quotes and colon share one reservation with the key.
+        char *const begin = out_.Reserve(key.size() + 4);
+        char *out = begin;
+        if (NeedsSeparator())
+        {
+            *out++ = ',';
+        }
+        *out++ = '"';
+        std::memcpy(out, key.data(), key.size());
+        out += key.size();
+        *out++ = '"';
+        *out++ = ':';
+        out_.Commit(static_cast<std::size_t>(out - begin));
+        afterKey_ = true;
+    }
+
+    void JsonWriter::String(std::wstring_view value)
+    {
+        BeforeValue();
+
+        // The first slice also holds the opening quote and the last one the
+        // closing quote, so a short string is a single reservation.
+        std::size_t index = 0;
+        bool first = true;
+        do
+        {
+            // One extra unit so a surrogate pair split by the slice end still
+            // fits, and one for the quotes.
+            const std::size_t sliceEnd = std::min(value.size(), index + kSliceUnits);
+            char *const begin = out_.Reserve((sliceEnd - index + 2) * kMaxBytesPerUnit);
+            char *out = begin;
+            if (first)
+            {
+                *out++ = '"';
+                first = false;
+            }
+
+            for (; index < sliceEnd; ++index)
+            {
+                std::uint32_t codePoint = static_cast<std::uint32_t>(value[index]);
+                if (codePoint < 0x80)
+                {
+                    if (NeedsEscape(static_cast<unsigned char>(codePoint)))
+                    {
+                        out = EscapeAscii(out, static_cast<unsigned char>(codePoint));
+                    }
+                    else
+                    {
+                        *out++ = static_cast<char>(codePoint);
+                    }
+                    continue;
+                }
+
+                if constexpr (sizeof(wchar_t) == 2)
+                {
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF && index + 1 < value.size())
+                    {
+                        const auto low = static_cast<std::uint32_t>(value[index + 1]);
+                        if (low >= 0xDC00 && low <= 0xDFFF)
+                        {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                            ++index;
+                        }
+                    }
+                }
+
+                if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+                {
+                    codePoint = 0xFFFD;
+                }
+
+                if (codePoint < 0x800)
+                {
+                    *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+                    *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+                    *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else
+                {
+                    *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+                    *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+            }
+
+            if (index == value.size())
+            {
+                *out++ = '"';
+            }
+            out_.Commit(static_cast<std::size_t>(out - begin));
+        } while (index < value.size());
+    }
+
+    void JsonWriter::String(std::string_view utf8)
+    {
+        BeforeValue();
+
+        // Already UTF-8: runs of plain bytes are copied as-is and only
+        // quotes, backslashes and control characters are rewritten.
+        std::size_t index = 0;
+        bool first = true;
+        do
+        {
+            const std::size_t sliceEnd = std::min(utf8.size(), index + kSliceUnits);
+            char *const begin = out_.Reserve((sliceEnd - index) * kMaxBytesPerUnit + 2);
+            char *out = begin;
+            if (first)
+            {
+                *out++ = '"';
+                first = false;
+            }
+
+            while (index < sliceEnd)
+            {
+                std::size_t run = index;
+                while (run < sliceEnd && !NeedsEscape(static_cast<unsigned char>(utf8[run])))
+                {
+                    ++run;
+                }
+
+                std::memcpy(out, utf8.data() + index, run - index);
+                out += run - index;
+                index = run;
+
+                if (index < sliceEnd)
+                {
+                    out = EscapeAscii(out, static_cast<unsigned char>(utf8[index]));
+                    ++index;
+                }
+            }
+
+            if (index == utf8.size())
+            {
+                *out++ = '"';
+            }
+            out_.Commit(static_cast<std::size_t>(out - begin));
+        } while (index < utf8.size());
+    }
+
+    void JsonWriter::Number(std::uint64_t value)
+    {
+        char *const begin = out_.Reserve(21);
+        char *out = begin;
+        if (BeforeValueNeedsSeparator())
+        {
+            *out++ = ',';
+        }
+        out_.Commit(static_cast<std::size_t>(std::to_chars(out, begin + 21, value).ptr - begin));
+    }
+
+    void JsonWriter::Number(std::int64_t value)
+    {
+        char *const begin = out_.Reserve(21);
+        char *out = begin;
+        if (BeforeValueNeedsSeparator())
+        {
+            *out++ = ',';
+        }
+        out_.Commit(static_cast<std::size_t>(std::to_chars(out, begin + 21, value).ptr - begin));
+    }
+
+    void JsonWriter::Number(double value)
+    {
+        if (!std::isfinite(value))
+        {
+            Null();
+            return;
+        }
+
+        BeforeValue();
+        constexpr std::size_t kMaxDoubleChars = 32;
+        char *const begin = out_.Reserve(kMaxDoubleChars);
+        out_.Commit(static_cast<std::size_t>(std::to_chars(begin, begin + kMaxDoubleChars, value).ptr - begin));
+    }
+
+    void JsonWriter::Bool(bool value)
+    {
+        BeforeValue();
+        Put(value ? std::string_view("true") : std::string_view("false"));
+    }
+
+    void JsonWriter::Null()
+    {
+        BeforeValue();
+        Put(std::string_view("null"));
+    }
+
+    void JsonWriter::EndLine()
+    {
+        Put('\n');
+        hasValue_[0] = false;
+    }
+
+    void JsonWriter::Field(std::string_view key, bool value)
+    {
+        Key(key);
+        Bool(value);
+    }
+
+    void JsonWriter::Field(std::string_view key, std::wstring_view value)
+    {
+        Key(key);
+        String(value);
+    }
+
+    void JsonWriter::Field(std::string_view key, std::string_view utf8)
+    {
+        Key(key);
+        String(utf8);
+    }
+
+    void JsonWriter::Field(std::string_view key, const char *value)
+    {
+        Key(key);
+        String(std::string_view(value));
+    }
+
+    void JsonWriter::BeforeValue()
+    {
+        if (BeforeValueNeedsSeparator())
+        {
+            Put(',');
+        }
+    }
+
+    bool JsonWriter::BeforeValueNeedsSeparator()
+    {
+        if (afterKey_)
+        {
+            afterKey_ = false;
+            return false;
+        }
+        return NeedsSeparator();
+    }
+
+    bool JsonWriter::NeedsSeparator()
+    {
+        const bool separator = hasValue_[depth_] && depth_ > 0;
+        hasValue_[depth_] = true;
+        return separator;
+    }
+
+    void JsonWriter::Put(char ch)
+    {
+        *out_.Reserve(1) = ch;
+        out_.Commit(1);
+    }
+
+    void JsonWriter::Put(std::string_view text)
+    {
+        std::memcpy(out_.Reserve(text.size()), text.data(), text.size());
+        out_.Commit(text.size());
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "chunked_buffer.h"
+
+namespace rvrse::core
+{
+    // Streaming JSON writer over a ChunkedBuffer. Numbers go through
+    // std::to_chars and strings are UTF-8 encoded and escaped in one pass
+    // straight into the buffer, so writing a document never allocates once
+    // the buffer's chunks exist. Commas are inserted automatically.
+    //
+    // Keys are written verbatim: pass plain ASCII literals.
+    class JsonWriter
+    {
+    public:
+        static constexpr std::size_t kMaxDepth = 32;
+
+        explicit JsonWriter(ChunkedBuffer &out) : out_(out) {}
+
+        void BeginObject();
+        void EndObject();
+        void BeginArray();
+        void EndArray();
+        void Key(std::string_view key);
+
+        void String(std::wstring_view value);
+        void String(std::string_view utf8);
+        void Number(std::uint64_t value);
+        void Number(std::int64_t value);
+
+        // Narrower (and platform-specific, e.g. DWORD) integer types.
+        template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+        void Number(T value)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                Number(static_cast<std::int64_t>(value));
+            }
+            else
+            {
+                Number(static_cast<std::uint64_t>(value));
+            }
+        }
+
+        // Shortest round-trip form; NaN and infinities become null.
+        void Number(double value);
+        void Bool(bool value);
+        void Null();
+
+        // Ends an NDJSON record; only valid between top-level values.
+        void EndLine();
+
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, int> = 0>
+        void Field(std::string_view key, T value)
+        {
+            Key(key);
+            Number(value);
+        }
+        void Field(std::string_view key, bool value);
+        void Field(std::string_view key, std::wstring_view value);
+        void Field(std::string_view key, std::string_view utf8);
+        void Field(std::string_view key, const char *value);
+
+    private:
+        void BeforeValue();
+
+        // Records that a value follows and says whether a comma must come
+        // first, for callers that write it into their own reservation.
+        bool BeforeValueNeedsSeparator();
+        bool NeedsSeparator();
+        void Put(char ch);
+        void Put(std::string_view text);
+
+        ChunkedBuffer &out_;
+
+        // Whether the container at each depth already holds a value.
+        bool hasValue_[kMaxDepth + 1] = {};
+        std::size_t depth_ = 0;
+        bool afterKey_ = false;
+    };
+}
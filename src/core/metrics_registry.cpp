@@ -0,0 +1,179 @@
+#include "metrics_registry.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+    std::uint64_t DoubleToBits(double value)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double BitsToDouble(std::uint64_t bits)
+    {
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+namespace rvrse::core
+{
+    MetricsRegistry::MetricsRegistry()
+        : slots_(std::make_unique<Slot[]>(kMaxMetrics))
+    {
+    }
+
+    std::uint32_t MetricsRegistry::Register(std::wstring_view name, MetricKind kind)
+    {
+        if (name.empty())
+        {
+            return kInvalidHandle;
+        }
+
+        std::lock_guard<std::mutex> lock(registrationMutex_);
+
+        std::uint32_t count = count_.load(std::memory_order_relaxed);
+        for (std::uint32_t index = 0; index < count; ++index)
+        {
+            if (slots_[index].name == name)
+            {
+                return slots_[index].kind == kind ? index + 1 : kInvalidHandle;
+            }
+        }
+
+        if (count >= kMaxMetrics)
+        {
+            return kInvalidHandle;
+        }
+
+        Slot &slot = slots_[count];
+        slot.name.assign(name.begin(), name.end());
+        slot.kind = kind;
+        slot.bits.store(0, std::memory_order_relaxed);
+
+        // Publishing the new count makes the slot visible to Collect() readers.
+        count_.store(count + 1, std::memory_order_release);
+        return count + 1;
+    }
+
+    MetricsRegistry::Slot *MetricsRegistry::SlotFor(std::uint32_t handle) const
+    {
+        if (handle == kInvalidHandle || handle > count_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &slots_[handle - 1];
+    }
+
+    void MetricsRegistry::Add(std::uint32_t handle, std::uint64_t delta)
+    {
+        Slot *slot = SlotFor(handle);
+        if (slot && slot->kind == MetricKind::Counter)
+        {
+            slot->bits.fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+
+    void MetricsRegistry::Set(std::uint32_t handle, double value)
+    {
+        Slot *slot = SlotFor(handle);
+        if (slot && slot->kind == MetricKind::Gauge)
+        {
+            slot->bits.store(DoubleToBits(value), std::memory_order_relaxed);
+        }
+    }
+
+    double MetricsRegistry::Value(std::uint32_t handle) const
+    {
+        const Slot *slot = SlotFor(handle);
+        if (!slot)
+        {
+            return 0.0;
+        }
+
+        std::uint64_t bits = slot->bits.load(std::memory_order_relaxed);
+        return slot->kind == MetricKind::Gauge ? BitsToDouble(bits) : static_cast<double>(bits);
+    }
+
+    void MetricsRegistry::Collect(std::vector<MetricSample> &samples) const
+    {
+        std::uint32_t count = count_.load(std::memory_order_acquire);
+        samples.reserve(samples.size() + count);
+        for (std::uint32_t index = 0; index < count; ++index)
+        {
+            const Slot &slot = slots_[index];
+            MetricSample sample;
+            sample.handle = index + 1;
+            sample.name = slot.name;
+            sample.kind = slot.kind;
+            sample.value = Value(index + 1);
+            samples.push_back(std::move(sample));
+        }
+    }
+
+    void MetricsHistory::Record(const MetricsRegistry &registry)
+    {
+        std::size_t count = registry.Count();
+        if (series_.size() < count)
+        {
+            series_.resize(count);
+        }
+
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            auto &series = series_[index];
+            if (series.size() >= capacity_)
+            {
+                series.pop_front();
+            }
+            series.push_back(registry.Value(static_cast<std::uint32_t>(index + 1)));
+        }
+    }
+
+    const std::deque<double> *MetricsHistory::Series(std::uint32_t handle) const
+    {
+        if (handle == MetricsRegistry::kInvalidHandle || handle > series_.size())
+        {
+            return nullptr;
+        }
+        return &series_[handle - 1];
+    }
+
+    SystemMetricsPublisher::SystemMetricsPublisher(MetricsRegistry &registry)
+        : registry_(registry)
+    {
+        static constexpr const wchar_t *kNames[] = {
+            L"system.cpu_usage_percent",
+            L"system.memory_usage_percent",
+            L"system.physical_memory_total_bytes",
+            L"system.physical_memory_available_bytes",
+            L"system.uptime_milliseconds",
+            L"system.process_count",
+            L"system.thread_count",
+            L"system.handle_count",
+            L"system.connection_count"};
+        static_assert(std::size(kNames) == std::tuple_size<decltype(handles_)>::value, "Publisher handle table mismatch");
+
+        for (std::size_t index = 0; index < handles_.size(); ++index)
+        {
+            handles_[index] = registry_.Register(kNames[index], MetricKind::Gauge);
+        }
+    }
+
+    void SystemMetricsPublisher::Publish(const SystemMetrics &metrics)
+    {
+        registry_.Set(handles_[0], metrics.cpuUsagePercent);
+        registry_.Set(handles_[1], metrics.memoryUsagePercent);
+        registry_.Set(handles_[2], static_cast<double>(metrics.physicalMemoryTotalBytes));
+        registry_.Set(handles_[3], static_cast<double>(metrics.physicalMemoryAvailableBytes));
+        registry_.Set(handles_[4], static_cast<double>(metrics.uptimeMilliseconds));
+        registry_.Set(handles_[5], static_cast<double>(metrics.processCount));
+        registry_.Set(handles_[6], static_cast<double>(metrics.threadCount));
+        registry_.Set(handles_[7], static_cast<double>(metrics.handleCount));
+        registry_.Set(handles_[8], static_cast<double>(metrics.connectionCount));
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "system_metrics.h"
+
+namespace rvrse::core
+{
+    enum class MetricKind : std::uint32_t
+    {
+        Counter = 0,
+        Gauge = 1
+    };
+
+    struct MetricSample
+    {
+        std::uint32_t handle = 0;
+        std::wstring name;
+        MetricKind kind = MetricKind::Counter;
+        double value = 0.0;
+    };
+
+    // Named counters and gauges shared by the host and plugins. Registration
+    // takes a lock and happens once per metric; updates go through the returned
+    // handle and are single relaxed atomic operations on a fixed-capacity slot
+    // table, so hot paths never lock or allocate.
+    class MetricsRegistry
+    {
+    public:
+        static constexpr std::uint32_t kMaxMetrics = 1024;
+        static constexpr std::uint32_t kInvalidHandle = 0;
+
+        MetricsRegistry();
+
+        // Returns the existing handle when the name is already registered with
+        // the same kind, kInvalidHandle on a kind conflict or when full.
+        std::uint32_t Register(std::wstring_view name, MetricKind kind);
+
+        void Add(std::uint32_t handle, std::uint64_t delta);
+        void Set(std::uint32_t handle, double value);
+
+        double Value(std::uint32_t handle) const;
+        std::size_t Count() const { return count_.load(std::memory_order_acquire); }
+
+        // Appends one sample per registered metric, in registration order.
+        void Collect(std::vector<MetricSample> &samples) const;
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t> bits{0};
+            MetricKind kind = MetricKind::Counter;
+            std::wstring name;
+        };
+
+        Slot *SlotFor(std::uint32_t handle) const;
+
+        std::unique_ptr<Slot[]> slots_;
+        std::atomic<std::uint32_t> count_{0};
+        std::mutex registrationMutex_;
+    };
+
+    // Bounded per-metric sample history, fed once per refresh.
+    class MetricsHistory
+    {
+    public:
+        explicit MetricsHistory(std::size_t capacity = 180) : capacity_(capacity) {}
+
+        void Record(const MetricsRegistry &registry);
+
+        // Oldest-first samples for the metric, or nullptr when none were recorded.
+        const std::deque<double> *Series(std::uint32_t handle) const;
+
+    private:
+        std::size_t capacity_;
+        std::vector<std::deque<double>> series_;
+    };
+
+    // Publishes the host's SystemMetrics as built-in "system.*" gauges so they
+    // flow through the same registry as plugin metrics.
+    class SystemMetricsPublisher
+    {
+    public:
+        explicit SystemMetricsPublisher(MetricsRegistry &registry);
+
+        void Publish(const SystemMetrics &metrics);
+
+    private:
+        MetricsRegistry &registry_;
+        std::array<std::uint32_t, 9> handles_{};
+    };
+}
@@ -0,0 +1,306 @@
+#include "name_matcher.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <cwctype>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RVRSE_NAME_MATCHER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Writes the folded name and its L'\0' separator; returns the end.
+    wchar_t *FoldInto(std::wstring_view name, wchar_t *out)
+    {
+        for (const wchar_t ch : name)
+        {
+            const auto unit = static_cast<std::uint32_t>(ch);
+            *out++ = unit < 0x80 ? static_cast<wchar_t>(unit - L'A' < 26u ? unit + (L'a' - L'A') : unit) : rvrse::core::FoldNameCase(ch);
+        }
+        *out++ = L'\0';
+        return out;
+    }
+
+    // The same for UTF-8 text (interned names, so valid): ASCII folds a
+    // byte at a time, other sequences decode to one unit, or a surrogate
+    // pair on UTF-16 builds.
+    wchar_t *FoldUtf8Into(std::string_view name, wchar_t *out)
+    {
+        for (std::size_t index = 0; index < name.size();)
+        {
+            const auto lead = static_cast<unsigned char>(name[index++]);
+            if (lead < 0x80)
+            {
+                *out++ = static_cast<wchar_t>(static_cast<unsigned>(lead - 'A') < 26u ? lead + ('a' - 'A') : lead);
+                continue;
+            }
+
+            const std::size_t extra = lead >= 0xF0 ? 3 : (lead >= 0xE0 ? 2 : 1);
+            std::uint32_t codePoint = lead & (0x3Fu >> extra);
+            for (std::size_t count = 0; count < extra && index < name.size(); ++count)
+            {
+                codePoint = (codePoint << 6) | (static_cast<unsigned char>(name[index++]) & 0x3Fu);
+            }
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (codePoint >= 0x10000)
+                {
+                    codePoint -= 0x10000;
+                    *out++ = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+                    *out++ = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+                    continue;
+                }
+            }
+            *out++ = rvrse::core::FoldNameCase(static_cast<wchar_t>(codePoint));
+        }
+        *out++ = L'\0';
+        return out;
+    }
+
+#if defined(RVRSE_NAME_MATCHER_SSE2)
+    __m128i Broadcast128(wchar_t ch)
+    {
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            return _mm_set1_epi16(static_cast<short>(ch));
+        }
+        else
+        {
+            return _mm_set1_epi32(static_cast<int>(ch));
+        }
+    }
+
+    __m128i Equal128(__m128i lhs, __m128i rhs)
+    {
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            return _mm_cmpeq_epi16(lhs, rhs);
+        }
+        else
+        {
+            return _mm_cmpeq_epi32(lhs, rhs);
+        }
+    }
+#endif
+
+#if defined(__AVX2__)
+    __m256i Broadcast256(wchar_t ch)
+    {
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            return _mm256_set1_epi16(static_cast<short>(ch));
+        }
+        else
+        {
+            return _mm256_set1_epi32(static_cast<int>(ch));
+        }
+    }
+
+    __m256i Equal256(__m256i lhs, __m256i rhs)
+    {
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            return _mm256_cmpeq_epi16(lhs, rhs);
+        }
+        else
+        {
+            return _mm256_cmpeq_epi32(lhs, rhs);
+        }
+    }
+#endif
+}
+
+namespace rvrse::core
+{
+    wchar_t FoldNameCase(wchar_t ch)
+    {
+        if (static_cast<std::uint32_t>(ch) < 0x80)
+        {
+            return (ch >= L'A' && ch <= L'Z') ? static_cast<wchar_t>(ch + (L'a' - L'A')) : ch;
+        }
+        return static_cast<wchar_t>(std::towlower(static_cast<std::wint_t>(ch)));
+    }
+
+    void FoldNameCase(std::wstring_view text, std::wstring &folded)
+    {
+        folded.resize(text.size());
+        for (std::size_t index = 0; index < text.size(); ++index)
+        {
+            folded[index] = FoldNameCase(text[index]);
+        }
+    }
+
+    void NameMatcher::Assign(const std::vector<ProcessEntry> &processes)
+    {
+        // Names are folded straight from their UTF-8, whose byte count
+        // bounds the units it decodes to, so the interner never has to make
+        // wide copies for the filter.
+        std::size_t total = 0;
+        for (const ProcessEntry &process : processes)
+        {
+            total += process.imageName.Utf8().size() + 1;
+        }
+
+        // One resize and straight writes; growing the string name by name
+        // costs more than the folding.
+        text_.resize(total);
+        starts_.resize(processes.size());
+        wchar_t *out = text_.data();
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            starts_[index] = static_cast<std::size_t>(out - text_.data());
+            out = FoldUtf8Into(processes[index].imageName.Utf8(), out);
+        }
+        text_.resize(static_cast<std::size_t>(out - text_.data()));
+    }
+
+    void NameMatcher::Clear()
+    {
+        text_.clear();
+        starts_.clear();
+    }
+
+    void NameMatcher::Add(std::wstring_view name)
+    {
+        const std::size_t start = text_.size();
+        starts_.push_back(start);
+        text_.resize(start + name.size() + 1);
+        FoldInto(name, &text_[start]);
+    }
+
+    std::wstring_view NameMatcher::Name(std::size_t index) const
+    {
+        const std::size_t start = starts_[index];
+        const std::size_t end = index + 1 < starts_.size() ? starts_[index + 1] : text_.size();
+        return std::wstring_view(text_.data() + start, end - start - 1);
+    }
+
+    void NameMatcher::Find(std::wstring_view foldedNeedle, std::vector<std::uint8_t> &matches) const
+    {
+        matches.assign(starts_.size(), foldedNeedle.empty() ? 1 : 0);
+
+        const std::size_t length = foldedNeedle.size();
+        if (length == 0 || length > text_.size() || foldedNeedle.find(L'\0') != std::wstring_view::npos)
+        {
+            return;
+        }
+
+        const wchar_t *text = text_.data();
+        const wchar_t *needle = foldedNeedle.data();
+        const wchar_t firstChar = needle[0];
+        const wchar_t lastChar = needle[length - 1];
+        const std::size_t lastStart = text_.size() - length;
+
+        // Candidates arrive in increasing order, so the owning name is found
+        // by walking starts_ forward once. After a match the scan resumes at
+        // the next name; a short needle would otherwise be verified at every
+        // occurrence.
+        std::size_t name = 0;
+        std::size_t resume = 0;
+        const auto verify = [&](std::size_t position)
+        {
+            if (position < resume)
+            {
+                return;
+            }
+            while (name + 1 < starts_.size() && starts_[name + 1] <= position)
+            {
+                ++name;
+            }
+            if (length < 3 || std::wmemcmp(text + position + 1, needle + 1, length - 2) == 0)
+            {
+                matches[name] = 1;
+                resume = name + 1 < starts_.size() ? starts_[name + 1] : text_.size();
+            }
+        };
+
+        std::size_t position = 0;
+
+#if defined(__AVX2__)
+        {
+            constexpr std::size_t kLanes = 32 / sizeof(wchar_t);
+            const __m256i first = Broadcast256(firstChar);
+            const __m256i last = Broadcast256(lastChar);
+            const auto candidates = [&](std::size_t at)
+            {
+                const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + at));
+                const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + at + length - 1));
+                return _mm256_and_si256(Equal256(head, first), Equal256(tail, last));
+            };
+
+            while (position + kLanes - 1 <= lastStart)
+            {
+                // Most blocks hold no candidate; rule them out four at a time.
+                if (position + 4 * kLanes - 1 <= lastStart &&
+                    _mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(candidates(position), candidates(position + kLanes)),
+                                                       _mm256_or_si256(candidates(position + 2 * kLanes), candidates(position + 3 * kLanes))),
+                                       _mm256_set1_epi8(-1)))
+                {
+                    position += 4 * kLanes;
+                    continue;
+                }
+
+                const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(candidates(position)));
+                for (std::size_t lane = 0; mask != 0 && lane < kLanes; ++lane)
+                {
+                    if (mask & (1u << (lane * sizeof(wchar_t))))
+                    {
+                        verify(position + lane);
+                    }
+                }
+                position = std::max(position + kLanes, resume);
+            }
+        }
+#endif
+
+#if defined(RVRSE_NAME_MATCHER_SSE2)
+        {
+            constexpr std::size_t kLanes = 16 / sizeof(wchar_t);
+            const __m128i first = Broadcast128(firstChar);
+            const __m128i last = Broadcast128(lastChar);
+            const auto candidates = [&](std::size_t at)
+            {
+                const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + at));
+                const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + at + length - 1));
+                return _mm_and_si128(Equal128(head, first), Equal128(tail, last));
+            };
+
+            while (position + kLanes - 1 <= lastStart)
+            {
+                // Most blocks hold no candidate; rule them out four at a time.
+                if (position + 4 * kLanes - 1 <= lastStart &&
+                    _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(candidates(position), candidates(position + kLanes)),
+                                                   _mm_or_si128(candidates(position + 2 * kLanes), candidates(position + 3 * kLanes)))) == 0)
+                {
+                    position += 4 * kLanes;
+                    continue;
+                }
+
+                const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(candidates(position)));
+                for (std::size_t lane = 0; mask != 0 && lane < kLanes; ++lane)
+                {
+                    if (mask & (1u << (lane * sizeof(wchar_t))))
+                    {
+                        verify(position + lane);
+                    }
+                }
+                position = std::max(position + kLanes, resume);
+            }
+        }
+#endif
+
+        for (position = std::max(position, resume); position <= lastStart; ++position)
+        {
+            if (text[position] == firstChar && text[position + length - 1] == lastChar)
+            {
+                verify(position);
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "process_snapshot.h"
+
+namespace rvrse::core
+{
+    // The case folding the process filter uses: ASCII directly, everything
+    // else through towlower, one code unit at a time.
+    wchar_t FoldNameCase(wchar_t ch);
+    void FoldNameCase(std::wstring_view text, std::wstring &folded);
+
+    // Case-folded copies of one generation's image names, packed into a
+    // single buffer so that a filter keystroke is one vectorized scan instead
+    // of folding and comparing every name again. The scan compares the
+    // needle's first and last characters a vector at a time and only
+    // verifies the positions where both match.
+    class NameMatcher
+    {
+    public:
+        // Rebuilds the folded names, reusing the buffers of the previous
+        // generation. Index i of Find() is processes[i].
+        void Assign(const std::vector<ProcessEntry> &processes);
+
+        // Same, for names that do not come from ProcessEntry.
+        void Clear();
+        void Add(std::wstring_view name);
+
+        std::size_t Size() const { return starts_.size(); }
+
+        // The folded copy of name index, without its separator.
+        std::wstring_view Name(std::size_t index) const;
+
+        // Sets matches[i] to 1 if name i contains foldedNeedle (FoldNameCase()
+        // output) and 0 otherwise; an empty needle matches every name.
+        // matches keeps its capacity, so repeated calls do not allocate.
+        void Find(std::wstring_view foldedNeedle, std::vector<std::uint8_t> &matches) const;
+
+    private:
+        // Names separated by L'\0', which a filter needle never contains,
+        // so no match can span two names.
+        std::wstring text_;
+        std::vector<std::size_t> starts_;
+    };
+}
@@ -0,0 +1,252 @@
+#include "ndjson_exporter.h"
+
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "json_writer.h"
+#include "process_columns.h"
+
+namespace
+{
+    void WriteProcess(rvrse::core::JsonWriter &json, std::uint64_t generation, const rvrse::core::ProcessEntry &process)
+    {
+        json.BeginObject();
+        json.Field("type", "process");
+        json.Field("generation", generation);
+        json.Field("pid", process.processId);
+        json.Field("ppid", process.parentProcessId);
+
+        // The list view columns under their export names; the PID leads
+        // the record above.
+        const auto writeColumn = [&json, &process](const auto &column)
+        {
+            using Column = std::decay_t<decltype(column)>;
+            if constexpr (Column::kId != rvrse::core::ProcessSortColumn::ProcessId)
+            {
+                json.Field(column.exportName, Column::Value(process));
+            }
+        };
+        rvrse::core::ForEachProcessColumn(writeColumn);
+        json.Field("kernel_time_100ns", process.kernelTime100ns);
+        json.Field("user_time_100ns", process.userTime100ns);
+        json.EndObject();
+        json.EndLine();
+    }
+
+    void WriteExit(rvrse::core::JsonWriter &json, std::uint64_t generation, std::uint32_t processId)
+    {
+        json.BeginObject();
+        json.Field("type", "exit");
+        json.Field("generation", generation);
+        json.Field("pid", processId);
+        json.EndObject();
+        json.EndLine();
+    }
+}
+
+namespace rvrse::core
+{
+    void NdjsonRenderer::Render(const CollectorFrame &frame, ChunkedBuffer &out)
+    {
+        const auto &processes = frame.processes.Processes();
+        const bool keyframe = forceKeyframe_ || keyframeInterval_ <= 1 || generationsSinceKeyframe_ + 1 >= keyframeInterval_;
+        forceKeyframe_ = false;
+        generationsSinceKeyframe_ = keyframe ? 0 : generationsSinceKeyframe_ + 1;
+
+        JsonWriter json(out);
+        const SystemMetrics &metrics = frame.metrics;
+        const auto timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(frame.timestamp.time_since_epoch()).count();
+
+        json.BeginObject();
+        json.Field("type", "generation");
+        json.Field("generation", frame.generation);
+        json.Field("timestamp_ms", static_cast<std::int64_t>(timestampMs));
+        json.Field("keyframe", keyframe);
+        json.Key("system");
+        json.BeginObject();
+        json.Field("cpu_percent", metrics.cpuUsagePercent);
+        json.Field("memory_percent", metrics.memoryUsagePercent);
+        json.Field("memory_total_bytes", metrics.physicalMemoryTotalBytes);
+        json.Field("memory_available_bytes", metrics.physicalMemoryAvailableBytes);
+        json.Field("uptime_ms", metrics.uptimeMilliseconds);
+        json.Field("processes", metrics.processCount);
+        json.Field("threads", metrics.threadCount);
+        json.Field("handles", metrics.handleCount);
+        json.Field("connections", metrics.connectionCount);
+        json.EndObject();
+        json.EndObject();
+        json.EndLine();
+
+        current_.clear();
+        current_.reserve(processes.size());
+
+        const std::vector<std::uint64_t> &rowHashes = frame.processes.Arrays().rowHashes;
+        auto previous = previous_.cbegin();
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            const ProcessState state{process.processId, rowHashes[index]};
+            current_.push_back(state);
+
+            // Processes that vanished since the previous generation.
+            for (; previous != previous_.cend() && previous->processId < process.processId; ++previous)
+            {
+                if (!keyframe)
+                {
+                    WriteExit(json, frame.generation, previous->processId);
+                }
+            }
+
+            bool unchanged = false;
+            if (previous != previous_.cend() && previous->processId == process.processId)
+            {
+                unchanged = previous->rowHash == state.rowHash;
+                ++previous;
+            }
+
+            if (keyframe || !unchanged)
+            {
+                WriteProcess(json, frame.generation, process);
+            }
+        }
+
+        for (; !keyframe && previous != previous_.cend(); ++previous)
+        {
+            WriteExit(json, frame.generation, previous->processId);
+        }
+
+        previous_.swap(current_);
+    }
+
+    NdjsonExporter::NdjsonExporter(NdjsonOptions options)
+        : options_(std::move(options)),
+          renderer_(options_.keyframeInterval)
+    {
+    }
+
+    NdjsonExporter::~NdjsonExporter()
+    {
+        Stop();
+    }
+
+    bool NdjsonExporter::Start()
+    {
+        Stop();
+
+        if (IsSocketEndpoint(options_.target))
+        {
+            SocketEndpoint endpoint;
+            if (!ParseSocketEndpoint(options_.target, endpoint) ||
+                (endpoint.kind == SocketEndpoint::Kind::Tcp && endpoint.port == 0))
+            {
+                return false;
+            }
+
+            auto socketSink = std::make_unique<SocketSink>(std::move(endpoint));
+            socketSink->Connect();
+            sink_ = std::move(socketSink);
+        }
+        else
+        {
+            auto fileSink = std::make_unique<FileSink>();
+            if (!fileSink->Open(options_.target))
+            {
+                return false;
+            }
+            sink_ = std::move(fileSink);
+        }
+
+        renderer_.ForceKeyframe();
+        stopRequested_ = false;
+        writer_ = std::thread(&NdjsonExporter::WriterLoop, this);
+        return true;
+    }
+
+    void NdjsonExporter::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopRequested_ = true;
+        }
+        wake_.notify_all();
+
+        if (writer_.joinable())
+        {
+            writer_.join();
+        }
+
+        if (sink_)
+        {
+            sink_->Flush();
+            sink_.reset();
+        }
+    }
+
+    void NdjsonExporter::Export(const CollectorFrame &frame)
+    {
+        if (!sink_)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pendingReady_ || writing_)
+            {
+                generationsDropped_.fetch_add(1, std::memory_order_relaxed);
+                renderer_.ForceKeyframe();
+                return;
+            }
+        }
+
+        if (outputLost_.exchange(false, std::memory_order_relaxed))
+        {
+            renderer_.ForceKeyframe();
+        }
+
+        rendering_.Clear();
+        renderer_.Render(frame, rendering_);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(rendering_, pending_);
+            pendingReady_ = true;
+        }
+        wake_.notify_one();
+    }
+
+    void NdjsonExporter::WriterLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            wake_.wait(lock, [this]()
+                       { return pendingReady_ || stopRequested_; });
+            if (!pendingReady_)
+            {
+                return;
+            }
+
+            pendingReady_ = false;
+            writing_ = true;
+            lock.unlock();
+
+            const bool written = pending_.WriteTo(*sink_) && sink_->Flush();
+            if (written)
+            {
+                generationsWritten_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                // Deltas after a lost generation would not apply; the
+                // sampling thread turns this into a keyframe.
+                generationsDropped_.fetch_add(1, std::memory_order_relaxed);
+                outputLost_.store(true, std::memory_order_relaxed);
+            }
+
+            lock.lock();
+            writing_ = false;
+        }
+    }
+}
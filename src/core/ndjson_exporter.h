@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chunked_buffer.h"
+#include "collector.h"
+#include "output_sink.h"
+
+namespace rvrse::core
+{
+    struct NdjsonOptions
+    {
+        // "-" (standard output), a file / FIFO / named pipe path,
+        // "tcp://address:port" with a numeric address ("[::1]" for IPv6), or
+        // "unix:/path/to.sock".
+        std::wstring target = L"-";
+
+        // Every Nth generation is a keyframe carrying every process; the ones
+        // between carry only new, changed and exited processes. 1 disables
+        // deltas.
+        std::uint32_t keyframeInterval = 60;
+    };
+
+    // Renders collector generations as NDJSON records: one "generation"
+    // record with the system figures, then "process" and "exit" records.
+    // Keeps the previous generation's PIDs and row hashes to compute deltas.
+    class NdjsonRenderer
+    {
+    public:
+        explicit NdjsonRenderer(std::uint32_t keyframeInterval = 60) : keyframeInterval_(keyframeInterval) {}
+
+        // Appends this generation's records to out.
+        void Render(const CollectorFrame &frame, ChunkedBuffer &out);
+
+        // Makes the next Render() a keyframe, e.g. after output was lost.
+        void ForceKeyframe() { forceKeyframe_ = true; }
+
+    private:
+        // ProcessRowHash() covers every field a process record carries.
+        struct ProcessState
+        {
+            std::uint32_t processId = 0;
+            std::uint64_t rowHash = 0;
+        };
+
+        std::uint32_t keyframeInterval_;
+        std::uint64_t generationsSinceKeyframe_ = 0;
+        bool forceKeyframe_ = true;
+
+        // PID-sorted like the snapshot, so deltas are a merge walk.
+        std::vector<ProcessState> previous_;
+        std::vector<ProcessState> current_;
+    };
+
+    // "ndjson" exporter. Each generation is rendered on the sampling thread
+    // into a chunked buffer and handed to a writer thread, so a slow pipe or
+    // socket never stalls sampling. While the writer is still busy with the
+    // previous generation new ones are dropped (and counted), and the next
+    // one written is a keyframe so consumers can resynchronize.
+    class NdjsonExporter final : public CollectorExporter
+    {
+    public:
+        explicit NdjsonExporter(NdjsonOptions options = {});
+        ~NdjsonExporter() override;
+
+        // Opens the target and starts the writer thread. A socket target that
+        // is not listening yet is retried on later generations.
+        bool Start();
+
+        // Writes the pending generation, flushes and closes the target.
+        void Stop();
+
+        const wchar_t *Name() const override { return L"ndjson"; }
+        void Export(const CollectorFrame &frame) override;
+
+        std::uint64_t GenerationsWritten() const { return generationsWritten_.load(std::memory_order_relaxed); }
+        std::uint64_t GenerationsDropped() const { return generationsDropped_.load(std::memory_order_relaxed); }
+
+    private:
+        void WriterLoop();
+
+        NdjsonOptions options_;
+        NdjsonRenderer renderer_;
+        std::unique_ptr<OutputSink> sink_;
+
+        // rendering_ belongs to the sampling thread; pending_ to the writer
+        // while writing_ is set. They are swapped under mutex_.
+        ChunkedBuffer rendering_;
+        ChunkedBuffer pending_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::thread writer_;
+        bool pendingReady_ = false;
+        bool writing_ = false;
+        bool stopRequested_ = false;
+
+        std::atomic<bool> outputLost_{false};
+        std::atomic<std::uint64_t> generationsWritten_{0};
+        std::atomic<std::uint64_t> generationsDropped_{0};
+    };
+}
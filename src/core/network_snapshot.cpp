@@ -1,9 +1,10 @@
 #include "network_snapshot.h"
 
 #include <algorithm>
-#include <cstring>
+#include <utility>
 #include <vector>
 
+#if defined(_WIN32)
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <Windows.h>
@@ -119,9 +120,28 @@ namespace
         return static_cast<std::uint16_t>(ntohs(static_cast<std::uint16_t>(value)));
     }
 }
+#endif
+
+namespace
+{
+    using ConnectionIterator = std::vector<rvrse::core::ConnectionEntry>::const_iterator;
+
+    std::pair<ConnectionIterator, ConnectionIterator> RangeForProcess(const std::vector<rvrse::core::ConnectionEntry> &connections,
+                                                                      std::uint32_t processId)
+    {
+        const auto first = std::lower_bound(connections.begin(), connections.end(), processId,
+                                            [](const rvrse::core::ConnectionEntry &connection, std::uint32_t id)
+                                            { return connection.owningProcessId < id; });
+        const auto last = std::upper_bound(first, connections.end(), processId,
+                                           [](std::uint32_t id, const rvrse::core::ConnectionEntry &connection)
+                                           { return id < connection.owningProcessId; });
+        return {first, last};
+    }
+}
 
 namespace rvrse::core
 {
+#if defined(_WIN32)
     NetworkSnapshot NetworkSnapshot::Capture()
     {
         NetworkSnapshot snapshot;
@@ -150,110 +170,132 @@ namespace rvrse::core
             return snapshot;
         }
 
-        snapshot.connections_.reserve(tcpRows.size() + udpRows.size() + tcp6Rows.size() + udp6Rows.size());
+        std::vector<ConnectionEntry> &connections = snapshot.Fill();
+        connections.reserve(tcpRows.size() + udpRows.size() + tcp6Rows.size() + udp6Rows.size());
 
         // IPv4 TCP
         for (const auto &row : tcpRows)
         {
             ConnectionEntry entry{};
-            entry.protocol = TransportProtocol::Tcp;
-            entry.addressFamily = AddressFamily::IPv4;
-            entry.localAddress = row.dwLocalAddr;
+            entry.SetProtocol(TransportProtocol::Tcp);
+            entry.SetFamily(AddressFamily::IPv4);
+            entry.SetLocalAddress(row.dwLocalAddr);
             entry.localPort = ConvertPort(row.dwLocalPort);
-            entry.remoteAddress = row.dwRemoteAddr;
+            entry.SetRemoteAddress(row.dwRemoteAddr);
             entry.remotePort = ConvertPort(row.dwRemotePort);
-            entry.state = static_cast<std::uint8_t>(row.dwState);
+            entry.SetState(static_cast<std::uint8_t>(row.dwState));
             entry.owningProcessId = row.dwOwningPid;
-            snapshot.connections_.push_back(entry);
+            connections.push_back(entry);
         }
 
         // IPv4 UDP
         for (const auto &row : udpRows)
         {
             ConnectionEntry entry{};
-            entry.protocol = TransportProtocol::Udp;
-            entry.addressFamily = AddressFamily::IPv4;
-            entry.localAddress = row.dwLocalAddr;
+            entry.SetProtocol(TransportProtocol::Udp);
+            entry.SetFamily(AddressFamily::IPv4);
+            entry.SetLocalAddress(row.dwLocalAddr);
             entry.localPort = ConvertPort(row.dwLocalPort);
             entry.owningProcessId = row.dwOwningPid;
-            snapshot.connections_.push_back(entry);
+            connections.push_back(entry);
         }
 
         // IPv6 TCP
         for (const auto &row : tcp6Rows)
         {
             ConnectionEntry entry{};
-            entry.protocol = TransportProtocol::Tcp;
-            entry.addressFamily = AddressFamily::IPv6;
-            std::memcpy(entry.localAddress6, &row.ucLocalAddr[0], 16);
+            entry.SetProtocol(TransportProtocol::Tcp);
+            entry.SetFamily(AddressFamily::IPv6);
+            entry.SetLocalAddress6(&row.ucLocalAddr[0]);
             entry.localPort = ConvertPort(row.dwLocalPort);
-            std::memcpy(entry.remoteAddress6, &row.ucRemoteAddr[0], 16);
+            entry.SetRemoteAddress6(&row.ucRemoteAddr[0]);
             entry.remotePort = ConvertPort(row.dwRemotePort);
-            entry.state = static_cast<std::uint8_t>(row.dwState);
+            entry.SetState(static_cast<std::uint8_t>(row.dwState));
             entry.owningProcessId = row.dwOwningPid;
-            snapshot.connections_.push_back(entry);
+            connections.push_back(entry);
         }
 
         // IPv6 UDP
         for (const auto &row : udp6Rows)
         {
             ConnectionEntry entry{};
-            entry.protocol = TransportProtocol::Udp;
-            entry.addressFamily = AddressFamily::IPv6;
-            std::memcpy(entry.localAddress6, &row.ucLocalAddr[0], 16);
+            entry.SetProtocol(TransportProtocol::Udp);
+            entry.SetFamily(AddressFamily::IPv6);
+            entry.SetLocalAddress6(&row.ucLocalAddr[0]);
             entry.localPort = ConvertPort(row.dwLocalPort);
             entry.owningProcessId = row.dwOwningPid;
-            snapshot.connections_.push_back(entry);
+            connections.push_back(entry);
         }
 
-        std::sort(snapshot.connections_.begin(), snapshot.connections_.end(),
-                  [](const ConnectionEntry &lhs, const ConnectionEntry &rhs)
+        SortConnections(connections);
+        return snapshot;
+    }
+#endif
+
+    NetworkSnapshot::NetworkSnapshot(std::vector<ConnectionEntry> connections, bool accessDenied, bool captureFailed)
+        : accessDenied_(accessDenied),
+          captureFailed_(captureFailed)
+    {
+        std::vector<ConnectionEntry> &stored = Fill();
+        stored = std::move(connections);
+        SortConnections(stored);
+    }
+
+    GenerationPool<NetworkSnapshot::Generation> &NetworkSnapshot::Pool()
+    {
+        // Never destroyed, like ProcessSnapshot's.
+        static auto *pool = new GenerationPool<Generation>();
+        return *pool;
+    }
+
+    const std::vector<ConnectionEntry> &NetworkSnapshot::Empty()
+    {
+        static const std::vector<ConnectionEntry> empty;
+        return empty;
+    }
+
+    std::vector<ConnectionEntry> &NetworkSnapshot::Fill()
+    {
+        generation_ = Pool().Acquire();
+        return generation_->connections;
+    }
+
+    void NetworkSnapshot::SortConnections(std::vector<ConnectionEntry> &connections)
+    {
+        // Everything after the PID folds into one integer, so most
+        // comparisons are two compares rather than a chain of branches.
+        const auto rest = [](const ConnectionEntry &connection)
+        {
+            return (static_cast<std::uint64_t>(connection.Protocol()) << 33) | (static_cast<std::uint64_t>(connection.Family()) << 32) |
+                   (static_cast<std::uint64_t>(connection.localPort) << 16) | connection.remotePort;
+        };
+        std::sort(connections.begin(), connections.end(),
+                  [&rest](const ConnectionEntry &lhs, const ConnectionEntry &rhs)
                   {
                       if (lhs.owningProcessId != rhs.owningProcessId)
                       {
                           return lhs.owningProcessId < rhs.owningProcessId;
                       }
-                      if (lhs.protocol != rhs.protocol)
-                      {
-                          return lhs.protocol < rhs.protocol;
-                      }
-                      if (lhs.addressFamily != rhs.addressFamily)
-                      {
-                          return static_cast<int>(lhs.addressFamily) < static_cast<int>(rhs.addressFamily);
-                      }
-                      if (lhs.localPort != rhs.localPort)
-                      {
-                          return lhs.localPort < rhs.localPort;
-                      }
-                      return lhs.remotePort < rhs.remotePort;
+                      return rest(lhs) < rest(rhs);
                   });
+    }
 
-        return snapshot;
+    ConnectionRows NetworkSnapshot::RowsForProcess(std::uint32_t processId) const
+    {
+        const std::vector<ConnectionEntry> &connections = Connections();
+        const auto [first, last] = RangeForProcess(connections, processId);
+        return ConnectionRows(*this, static_cast<std::size_t>(first - connections.begin()), static_cast<std::size_t>(last - first));
     }
 
     std::vector<ConnectionEntry> NetworkSnapshot::ConnectionsForProcess(std::uint32_t processId) const
     {
-        std::vector<ConnectionEntry> results;
-        for (const auto &connection : connections_)
-        {
-            if (connection.owningProcessId == processId)
-            {
-                results.push_back(connection);
-            }
-        }
-        return results;
+        const auto [first, last] = RangeForProcess(Connections(), processId);
+        return std::vector<ConnectionEntry>(first, last);
     }
 
     std::size_t NetworkSnapshot::ConnectionCountForProcess(std::uint32_t processId) const
     {
-        std::size_t count = 0;
-        for (const auto &connection : connections_)
-        {
-            if (connection.owningProcessId == processId)
-            {
-                ++count;
-            }
-        }
-        return count;
+        const auto [first, last] = RangeForProcess(Connections(), processId);
+        return static_cast<std::size_t>(last - first);
     }
 }
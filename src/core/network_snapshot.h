@@ -1,52 +1,118 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "snapshot_arena.h"
+
 namespace rvrse::core
 {
-    enum class TransportProtocol
+    enum class TransportProtocol : std::uint32_t
     {
         Tcp,
         Udp
     };
 
-    enum class AddressFamily
+    enum class AddressFamily : std::uint32_t
     {
         IPv4,
         IPv6
     };
 
+    // One socket in 44 bytes. Each endpoint keeps a single 16-byte address in
+    // network byte order, IPv4 as v4-mapped (::ffff:a.b.c.d), and state,
+    // protocol and family share one byte. The accessors return what the
+    // separate IPv4/IPv6 fields used to hold; RvrseConnectionInfo
+    // (plugin_api.h) keeps that wider layout, and the plugin bridge converts.
     struct ConnectionEntry
     {
-        TransportProtocol protocol = TransportProtocol::Tcp;
-        AddressFamily addressFamily = AddressFamily::IPv4;
-
-        // IPv4 addresses (4 bytes each)
-        std::uint32_t localAddress = 0;
-        std::uint32_t remoteAddress = 0;
-
-        // IPv6 addresses (16 bytes each) - stored as network byte order
-        std::uint8_t localAddress6[16] = {};
-        std::uint8_t remoteAddress6[16] = {};
-
         std::uint16_t localPort = 0;
         std::uint16_t remotePort = 0;
         std::uint32_t owningProcessId = 0;
-        std::uint8_t state = 0;
+
+        TransportProtocol Protocol() const { return (packed_ & kUdpBit) != 0 ? TransportProtocol::Udp : TransportProtocol::Tcp; }
+        AddressFamily Family() const { return (packed_ & kIPv6Bit) != 0 ? AddressFamily::IPv6 : AddressFamily::IPv4; }
+
+        // MIB_TCP_STATE values (1-12) on every platform; 0 for UDP.
+        std::uint8_t State() const { return static_cast<std::uint8_t>(packed_ & kStateMask); }
+
+        void SetProtocol(TransportProtocol protocol) { SetBit(kUdpBit, protocol == TransportProtocol::Udp); }
+        void SetFamily(AddressFamily family) { SetBit(kIPv6Bit, family == AddressFamily::IPv6); }
+        void SetState(std::uint8_t state) { packed_ = static_cast<std::uint8_t>((packed_ & ~kStateMask) | (state & kStateMask)); }
+
+        // IPv4 endpoints: the address in network byte order, read from and
+        // written to the mapped form.
+        std::uint32_t LocalAddress() const { return MappedAddress(localAddress_); }
+        std::uint32_t RemoteAddress() const { return MappedAddress(remoteAddress_); }
+        void SetLocalAddress(std::uint32_t address) { MapAddress(localAddress_, address); }
+        void SetRemoteAddress(std::uint32_t address) { MapAddress(remoteAddress_, address); }
+
+        // All 16 bytes: the IPv6 address, or the mapped IPv4 one.
+        const std::uint8_t *LocalAddress6() const { return localAddress_; }
+        const std::uint8_t *RemoteAddress6() const { return remoteAddress_; }
+        void SetLocalAddress6(const std::uint8_t *address) { std::memcpy(localAddress_, address, kAddressBytes); }
+        void SetRemoteAddress6(const std::uint8_t *address) { std::memcpy(remoteAddress_, address, kAddressBytes); }
+
+        static constexpr std::size_t kAddressBytes = 16;
+
+    private:
+        static constexpr std::uint8_t kStateMask = 0x0F;
+        static constexpr std::uint8_t kUdpBit = 0x10;
+        static constexpr std::uint8_t kIPv6Bit = 0x20;
+
+        static std::uint32_t MappedAddress(const std::uint8_t (&address)[kAddressBytes])
+        {
+            std::uint32_t value = 0;
+            std::memcpy(&value, address + 12, sizeof(value));
+            return value;
+        }
+
+        static void MapAddress(std::uint8_t (&address)[kAddressBytes], std::uint32_t value)
+        {
+            std::memset(address, 0, 10);
+            address[10] = 0xFF;
+            address[11] = 0xFF;
+            std::memcpy(address + 12, &value, sizeof(value));
+        }
+
+        void SetBit(std::uint8_t bit, bool set) { packed_ = static_cast<std::uint8_t>(set ? packed_ | bit : packed_ & ~bit); }
+
+        // Default-constructed entries hold the mapped 0.0.0.0, so IPv4
+        // addresses compare the same whether or not they were set.
+        std::uint8_t localAddress_[kAddressBytes] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0, 0, 0, 0};
+        std::uint8_t remoteAddress_[kAddressBytes] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0, 0, 0, 0};
+        std::uint8_t packed_ = 0;
     };
 
+    static_assert(sizeof(ConnectionEntry) == 44, "ConnectionEntry no longer packs into 44 bytes");
+
+    class ConnectionRows;
+
+    // Immutable, like ProcessSnapshot: the connections belong to a pooled
+    // generation that copies share, recycled with its capacity once the
+    // last copy (or ConnectionRows) is gone.
     class NetworkSnapshot
     {
     public:
         NetworkSnapshot() = default;
 
+        // Builds a snapshot from pre-collected entries (remote viewers,
+        // synthetic data); entries are sorted like Capture() output.
+        explicit NetworkSnapshot(std::vector<ConnectionEntry> connections, bool accessDenied = false, bool captureFailed = false);
+
         static NetworkSnapshot Capture();
 
-        const std::vector<ConnectionEntry> &Connections() const { return connections_; }
+        const std::vector<ConnectionEntry> &Connections() const { return generation_ ? generation_->connections : Empty(); }
 
+        // Connections are sorted by PID, so these are a binary search.
+        // RowsForProcess() shares the snapshot; ConnectionsForProcess()
+        // copies the entries out.
+        ConnectionRows RowsForProcess(std::uint32_t processId) const;
         std::vector<ConnectionEntry> ConnectionsForProcess(std::uint32_t processId) const;
         std::size_t ConnectionCountForProcess(std::uint32_t processId) const;
 
@@ -54,8 +120,51 @@ namespace rvrse::core
         bool CaptureFailed() const { return captureFailed_; }
 
     private:
-        std::vector<ConnectionEntry> connections_;
+        struct Generation
+        {
+            std::vector<ConnectionEntry> connections;
+            std::atomic<std::uint32_t> references{0};
+
+            void Recycle() { connections.clear(); }
+        };
+
+        static GenerationPool<Generation> &Pool();
+        static const std::vector<ConnectionEntry> &Empty();
+
+        // Takes a fresh generation for a capture to fill.
+        std::vector<ConnectionEntry> &Fill();
+
+        // Orders by owning PID, protocol, family, then ports; every capture
+        // backend calls this so consumers see the same ordering everywhere.
+        static void SortConnections(std::vector<ConnectionEntry> &connections);
+
+        GenerationPool<Generation>::Lease generation_;
         bool accessDenied_ = false;
         bool captureFailed_ = false;
     };
+
+    // One process's connections inside a NetworkSnapshot, which it keeps
+    // alive: a viewer holds these instead of a copied list.
+    class ConnectionRows
+    {
+    public:
+        ConnectionRows() = default;
+
+        const ConnectionEntry *begin() const { return snapshot_.Connections().data() + first_; }
+        const ConnectionEntry *end() const { return begin() + count_; }
+        const ConnectionEntry &operator[](std::size_t index) const { return begin()[index]; }
+        std::size_t size() const { return count_; }
+        bool empty() const { return count_ == 0; }
+
+    private:
+        friend class NetworkSnapshot;
+        ConnectionRows(NetworkSnapshot snapshot, std::size_t first, std::size_t count)
+            : snapshot_(std::move(snapshot)), first_(first), count_(count)
+        {
+        }
+
+        NetworkSnapshot snapshot_;
+        std::size_t first_ = 0;
+        std::size_t count_ = 0;
+    };
 }
@@ -0,0 +1,264 @@
+// Linux capture backend for NetworkSnapshot, parsed from /proc/net/{tcp,udp}
+// and their IPv6 twins. Owning processes are resolved by matching socket
+// inodes against /proc/<pid>/fd links. The portable parts of NetworkSnapshot
+// live in network_snapshot.cpp.
+
+#include "network_snapshot.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include "procfs.h"
+
+namespace
+{
+    // ConnectionEntry::State() carries MIB_TCP_STATE values on every platform;
+    // index is the kernel's TCP_* state from include/net/tcp_states.h.
+    constexpr std::uint8_t kTcpStateMap[] = {
+        0,  // unused
+        5,  // TCP_ESTABLISHED -> MIB_TCP_STATE_ESTAB
+        3,  // TCP_SYN_SENT    -> MIB_TCP_STATE_SYN_SENT
+        4,  // TCP_SYN_RECV    -> MIB_TCP_STATE_SYN_RCVD
+        6,  // TCP_FIN_WAIT1   -> MIB_TCP_STATE_FIN_WAIT1
+        7,  // TCP_FIN_WAIT2   -> MIB_TCP_STATE_FIN_WAIT2
+        11, // TCP_TIME_WAIT   -> MIB_TCP_STATE_TIME_WAIT
+        1,  // TCP_CLOSE       -> MIB_TCP_STATE_CLOSED
+        8,  // TCP_CLOSE_WAIT  -> MIB_TCP_STATE_CLOSE_WAIT
+        10, // TCP_LAST_ACK    -> MIB_TCP_STATE_LAST_ACK
+        2,  // TCP_LISTEN      -> MIB_TCP_STATE_LISTEN
+        9,  // TCP_CLOSING     -> MIB_TCP_STATE_CLOSING
+    };
+
+    enum class TableStatus
+    {
+        Ok,
+        Missing,
+        AccessDenied
+    };
+
+    // "0100007F:0035" (IPv4) or 32 hex digits + port (IPv6). The kernel
+    // prints each 32-bit word of the address in host order, so parsing the
+    // words and storing them back reproduces the network-order bytes. IPv4
+    // addresses come out v4-mapped, as ConnectionEntry stores them.
+    bool ParseEndpoint(std::string_view token,
+                       rvrse::core::AddressFamily family,
+                       std::uint8_t (&address)[rvrse::core::ConnectionEntry::kAddressBytes],
+                       std::uint16_t &port)
+    {
+        const std::size_t colon = token.find(':');
+        if (colon == std::string_view::npos)
+        {
+            return false;
+        }
+
+        const std::string_view digits = token.substr(0, colon);
+        std::uint64_t value = 0;
+        if (!rvrse::core::procfs::ParseToken(token.substr(colon + 1), value, 16))
+        {
+            return false;
+        }
+        port = static_cast<std::uint16_t>(value);
+
+        if (family == rvrse::core::AddressFamily::IPv4)
+        {
+            if (digits.size() != 8 || !rvrse::core::procfs::ParseToken(digits, value, 16))
+            {
+                return false;
+            }
+            const auto address4 = static_cast<std::uint32_t>(value);
+            std::memset(address, 0, 10);
+            address[10] = 0xFF;
+            address[11] = 0xFF;
+            std::memcpy(&address[12], &address4, sizeof(address4));
+            return true;
+        }
+
+        if (digits.size() != 32)
+        {
+            return false;
+        }
+
+        for (std::size_t word = 0; word < 4; ++word)
+        {
+            if (!rvrse::core::procfs::ParseToken(digits.substr(word * 8, 8), value, 16))
+            {
+                return false;
+            }
+            const auto word32 = static_cast<std::uint32_t>(value);
+            std::memcpy(&address[word * 4], &word32, sizeof(word32));
+        }
+        return true;
+    }
+
+    TableStatus ReadTable(const char *path,
+                          rvrse::core::TransportProtocol protocol,
+                          rvrse::core::AddressFamily family,
+                          std::string &buffer,
+                          std::vector<rvrse::core::ConnectionEntry> &connections,
+                          std::vector<std::uint64_t> &inodes)
+    {
+        if (!rvrse::core::procfs::ReadFile(path, buffer))
+        {
+            return errno == EACCES ? TableStatus::AccessDenied : TableStatus::Missing;
+        }
+
+        std::string_view text(buffer);
+
+        // Skip the column header.
+        const std::size_t headerEnd = text.find('\n');
+        text.remove_prefix(headerEnd == std::string_view::npos ? text.size() : headerEnd + 1);
+
+        while (!text.empty())
+        {
+            const std::size_t lineEnd = text.find('\n');
+            std::string_view line = text.substr(0, lineEnd);
+            text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+            // sl local_address rem_address st tx:rx tr:when retrnsmt uid timeout inode
+            rvrse::core::ConnectionEntry entry{};
+            entry.SetProtocol(protocol);
+            entry.SetFamily(family);
+
+            std::uint8_t localAddress[rvrse::core::ConnectionEntry::kAddressBytes];
+            std::uint8_t remoteAddress[rvrse::core::ConnectionEntry::kAddressBytes];
+            std::uint64_t state = 0;
+            std::uint64_t inode = 0;
+            if (!rvrse::core::procfs::SkipTokens(line, 1) ||
+                !ParseEndpoint(rvrse::core::procfs::NextToken(line), family, localAddress, entry.localPort) ||
+                !ParseEndpoint(rvrse::core::procfs::NextToken(line), family, remoteAddress, entry.remotePort) ||
+                !rvrse::core::procfs::ParseUnsigned(line, state, 16) ||
+                !rvrse::core::procfs::SkipTokens(line, 5) ||
+                !rvrse::core::procfs::ParseUnsigned(line, inode))
+            {
+                continue;
+            }
+
+            entry.SetLocalAddress6(localAddress);
+            entry.SetRemoteAddress6(remoteAddress);
+
+            // UDP rows carry no state on Windows either.
+            if (protocol == rvrse::core::TransportProtocol::Tcp && state < std::size(kTcpStateMap))
+            {
+                entry.SetState(kTcpStateMap[state]);
+            }
+
+            connections.push_back(entry);
+            inodes.push_back(inode);
+        }
+
+        return TableStatus::Ok;
+    }
+
+    // Maps socket inodes to the first process holding them open. Only inodes
+    // present in the tables are tracked, and the scan stops once all are found.
+    std::unordered_map<std::uint64_t, std::uint32_t> ResolveSocketOwners(const std::vector<std::uint64_t> &inodes)
+    {
+        std::unordered_map<std::uint64_t, std::uint32_t> owners;
+        std::size_t pending = 0;
+        for (std::uint64_t inode : inodes)
+        {
+            // Inode 0 marks TIME_WAIT and other orphaned sockets.
+            if (inode != 0 && owners.emplace(inode, 0).second)
+            {
+                ++pending;
+            }
+        }
+
+        if (pending == 0)
+        {
+            return owners;
+        }
+
+        constexpr std::string_view kSocketPrefix = "socket:[";
+        char path[64];
+        char target[64];
+
+        for (std::uint32_t processId : rvrse::core::procfs::ListNumericEntries("/proc"))
+        {
+            std::snprintf(path, sizeof(path), "/proc/%u/fd", processId);
+            for (std::uint32_t descriptor : rvrse::core::procfs::ListNumericEntries(path))
+            {
+                std::snprintf(path, sizeof(path), "/proc/%u/fd/%u", processId, descriptor);
+                const ssize_t length = readlink(path, target, sizeof(target));
+                if (length <= static_cast<ssize_t>(kSocketPrefix.size()) ||
+                    std::string_view(target, kSocketPrefix.size()) != kSocketPrefix)
+                {
+                    continue;
+                }
+
+                std::uint64_t inode = 0;
+                const std::string_view digits(target + kSocketPrefix.size(), static_cast<std::size_t>(length) - kSocketPrefix.size() - 1);
+                if (!rvrse::core::procfs::ParseToken(digits, inode))
+                {
+                    continue;
+                }
+
+                auto it = owners.find(inode);
+                if (it != owners.end() && it->second == 0)
+                {
+                    it->second = processId;
+                    if (--pending == 0)
+                    {
+                        return owners;
+                    }
+                }
+            }
+        }
+
+        return owners;
+    }
+}
+
+namespace rvrse::core
+{
+    NetworkSnapshot NetworkSnapshot::Capture()
+    {
+        NetworkSnapshot snapshot;
+        std::vector<ConnectionEntry> &connections = snapshot.Fill();
+        std::string buffer;
+        std::vector<std::uint64_t> inodes;
+
+        const TableStatus tcpStatus = ReadTable("/proc/net/tcp", TransportProtocol::Tcp, AddressFamily::IPv4, buffer, connections, inodes);
+        const TableStatus udpStatus = ReadTable("/proc/net/udp", TransportProtocol::Udp, AddressFamily::IPv4, buffer, connections, inodes);
+
+        // The IPv6 tables are absent when IPv6 is disabled; that is not a failure.
+        const TableStatus tcp6Status = ReadTable("/proc/net/tcp6", TransportProtocol::Tcp, AddressFamily::IPv6, buffer, connections, inodes);
+        const TableStatus udp6Status = ReadTable("/proc/net/udp6", TransportProtocol::Udp, AddressFamily::IPv6, buffer, connections, inodes);
+
+        snapshot.accessDenied_ = tcpStatus == TableStatus::AccessDenied || udpStatus == TableStatus::AccessDenied ||
+                                 tcp6Status == TableStatus::AccessDenied || udp6Status == TableStatus::AccessDenied;
+        snapshot.captureFailed_ = !snapshot.accessDenied_ &&
+                                  (tcpStatus != TableStatus::Ok || udpStatus != TableStatus::Ok);
+
+        if (snapshot.accessDenied_ || snapshot.captureFailed_)
+        {
+            snapshot.generation_.Reset();
+            return snapshot;
+        }
+
+        // Sockets owned by other users stay at PID 0 without privileges.
+        const auto owners = ResolveSocketOwners(inodes);
+        for (std::size_t index = 0; index < connections.size(); ++index)
+        {
+            auto it = owners.find(inodes[index]);
+            if (it != owners.end())
+            {
+                connections[index].owningProcessId = it->second;
+            }
+        }
+
+        SortConnections(connections);
+        return snapshot;
+    }
+}
+
+#endif
@@ -0,0 +1,432 @@
+#include "openmetrics_exporter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+#include "column_reduce.h"
+
+namespace
+{
+    void AppendUnsigned(std::string &out, std::uint64_t value)
+    {
+        char buffer[20];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    // Percentages are rendered with two decimals through integer formatting;
+    // per-process CPU is the one floating-point value written 5k times a pass.
+    void AppendFixed2(std::string &out, double value)
+    {
+        const auto scaled = static_cast<std::uint64_t>(std::llround(std::max(value, 0.0) * 100.0));
+        AppendUnsigned(out, scaled / 100);
+        const auto fraction = static_cast<char>(scaled % 100);
+        out.push_back('.');
+        out.push_back(static_cast<char>('0' + fraction / 10));
+        out.push_back(static_cast<char>('0' + fraction % 10));
+    }
+
+    void AppendDouble(std::string &out, double value)
+    {
+        if (std::isnan(value))
+        {
+            out += "NaN";
+            return;
+        }
+        if (std::isinf(value))
+        {
+            out += value > 0 ? "+Inf" : "-Inf";
+            return;
+        }
+
+        char buffer[32];
+        const int length = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        out.append(buffer, static_cast<std::size_t>(std::max(length, 0)));
+    }
+
+    // Applies the OpenMetrics escapes to a UTF-8 label value; the other
+    // bytes, multi-byte sequences included, are copied as they are.
+    void AppendLabelValue(std::string &out, std::string_view value)
+    {
+        for (const char ch : value)
+        {
+            switch (ch)
+            {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out.push_back(ch);
+                break;
+            }
+        }
+    }
+
+    void AppendFamilyHeader(std::string &out, std::string_view name, const char *type, const char *help)
+    {
+        out += "# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+        if (help)
+        {
+            out += "# HELP ";
+            out += name;
+            out += ' ';
+            out += help;
+            out += '\n';
+        }
+    }
+
+    struct ProcessFamily
+    {
+        const char *name;
+        const char *help;
+    };
+
+    constexpr ProcessFamily kProcessFamilies[] = {
+        {"rvrse_process_cpu_percent", "CPU usage since the previous generation, in percent of one core."},
+        {"rvrse_process_working_set_bytes", "Resident working set."},
+        {"rvrse_process_private_bytes", "Private (committed) bytes."},
+        {"rvrse_process_threads", "Thread count."}};
+
+    constexpr const char *kOtherLabels = "{pid=\"other\",name=\"other\"}";
+}
+
+namespace rvrse::core
+{
+    void OpenMetricsRenderer::Render(const CollectorFrame &frame, std::string &out)
+    {
+        out.clear();
+
+        UpdateCpuUsage(frame);
+        SelectProcesses(frame.processes);
+        RenderProcesses(frame.processes, out);
+        RenderRegistry(frame.registry, out);
+
+        out += "# EOF\n";
+    }
+
+    void OpenMetricsRenderer::UpdateCpuUsage(const CollectorFrame &frame)
+    {
+        const auto &processes = frame.processes.Processes();
+        const double elapsed100ns =
+            hasCpuBaseline_ ? static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(frame.timestamp - previousTimestamp_).count()) / 100.0 : 0.0;
+
+        cpuPercent_.assign(processes.size(), 0.0);
+        currentCpuTimes_.clear();
+        currentCpuTimes_.reserve(processes.size());
+
+        auto previous = previousCpuTimes_.cbegin();
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            const std::uint64_t cpuTime = process.kernelTime100ns + process.userTime100ns;
+            currentCpuTimes_.emplace_back(process.processId, cpuTime);
+
+            while (previous != previousCpuTimes_.cend() && previous->first < process.processId)
+            {
+                ++previous;
+            }
+
+            // A PID reused by a new process shows up as time going backwards; its
+            // usage starts from the next generation.
+            if (elapsed100ns > 0.0 && previous != previousCpuTimes_.cend() && previous->first == process.processId &&
+                cpuTime >= previous->second)
+            {
+                cpuPercent_[index] = static_cast<double>(cpuTime - previous->second) / elapsed100ns * 100.0;
+            }
+        }
+
+        previousCpuTimes_.swap(currentCpuTimes_);
+        previousTimestamp_ = frame.timestamp;
+        hasCpuBaseline_ = true;
+    }
+
+    void OpenMetricsRenderer::SelectProcesses(const ProcessSnapshot &processes)
+    {
+        const std::size_t count = processes.Processes().size();
+        if (topProcesses_ == 0 || count <= topProcesses_)
+        {
+            selected_.assign(count, 1);
+            return;
+        }
+
+        selected_.assign(count, 0);
+        ranking_.resize(count);
+
+        // Idle (or zero-sized) processes are never picked to fill a ranking:
+        // ties would be broken arbitrarily and churn the exported series.
+        std::iota(ranking_.begin(), ranking_.end(), 0U);
+        std::nth_element(ranking_.begin(),
+                         ranking_.begin() + static_cast<std::ptrdiff_t>(topProcesses_),
+                         ranking_.end(),
+                         [this](std::uint32_t left, std::uint32_t right)
+                         { return cpuPercent_[left] > cpuPercent_[right]; });
+        for (std::size_t rank = 0; rank < topProcesses_; ++rank)
+        {
+            if (cpuPercent_[ranking_[rank]] > 0)
+            {
+                selected_[ranking_[rank]] = 1;
+            }
+        }
+
+        // Working set ranks over its contiguous column, ties by PID.
+        const std::vector<std::uint64_t> &workingSet = processes.Arrays().workingSetBytes;
+        TopColumnIndices(workingSet, topProcesses_, ranking_);
+        for (const std::uint32_t index : ranking_)
+        {
+            if (workingSet[index] > 0)
+            {
+                selected_[index] = 1;
+            }
+        }
+    }
+
+    void OpenMetricsRenderer::RenderProcesses(const ProcessSnapshot &snapshot, std::string &out)
+    {
+        const std::vector<ProcessEntry> &processes = snapshot.Processes();
+
+        // Label sets are encoded once and shared by every process family.
+        labels_.clear();
+        labelOffsets_.clear();
+        labelOffsets_.push_back(0);
+
+        double otherCpu = 0.0;
+        std::uint64_t otherCount = 0;
+
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            if (selected_[index])
+            {
+                labels_ += "{pid=\"";
+                AppendUnsigned(labels_, process.processId);
+                labels_ += "\",name=\"";
+                AppendLabelValue(labels_, process.imageName.Utf8());
+                labels_ += "\"}";
+            }
+            else
+            {
+                otherCpu += cpuPercent_[index];
+                ++otherCount;
+            }
+            labelOffsets_.push_back(labels_.size());
+        }
+
+        // The "other" rollup of the integer gauges, a column at a time.
+        const ProcessArrays &arrays = snapshot.Arrays();
+        const std::uint64_t otherWorkingSet = SumUnselected(arrays.workingSetBytes, selected_);
+        const std::uint64_t otherPrivate = SumUnselected(arrays.privateBytes, selected_);
+        const std::uint64_t otherThreads = SumUnselected(arrays.threadCounts, selected_);
+
+        const std::string_view labels(labels_);
+        for (std::size_t family = 0; family < std::size(kProcessFamilies); ++family)
+        {
+            const ProcessFamily &info = kProcessFamilies[family];
+            AppendFamilyHeader(out, info.name, "gauge", info.help);
+
+            const auto appendValue = [&out, family](double cpu, std::uint64_t workingSet, std::uint64_t privateBytes, std::uint64_t threads)
+            {
+                out.push_back(' ');
+                switch (family)
+                {
+                case 0:
+                    AppendFixed2(out, cpu);
+                    break;
+                case 1:
+                    AppendUnsigned(out, workingSet);
+                    break;
+                case 2:
+                    AppendUnsigned(out, privateBytes);
+                    break;
+                default:
+                    AppendUnsigned(out, threads);
+                    break;
+                }
+                out.push_back('\n');
+            };
+
+            for (std::size_t index = 0; index < processes.size(); ++index)
+            {
+                if (!selected_[index])
+                {
+                    continue;
+                }
+
+                const ProcessEntry &process = processes[index];
+                out += info.name;
+                out += labels.substr(labelOffsets_[index], labelOffsets_[index + 1] - labelOffsets_[index]);
+                appendValue(cpuPercent_[index], process.workingSetBytes, process.privateBytes, process.threadCount);
+            }
+
+            if (otherCount > 0)
+            {
+                out += info.name;
+                out += kOtherLabels;
+                appendValue(otherCpu, otherWorkingSet, otherPrivate, otherThreads);
+            }
+        }
+
+        AppendFamilyHeader(out, "rvrse_processes_aggregated", "gauge", "Processes folded into the pid=\"other\" series.");
+        out += "rvrse_processes_aggregated ";
+        AppendUnsigned(out, otherCount);
+        out.push_back('\n');
+    }
+
+    void OpenMetricsRenderer::RenderRegistry(const MetricsRegistry &registry, std::string &out)
+    {
+        samples_.clear();
+        registry.Collect(samples_);
+
+        for (const MetricSample &sample : samples_)
+        {
+            const std::string &name = FamilyName(sample);
+            if (name.empty())
+            {
+                continue;
+            }
+
+            if (sample.kind == MetricKind::Counter)
+            {
+                AppendFamilyHeader(out, name, "counter", nullptr);
+                out += name;
+                out += "_total ";
+            }
+            else
+            {
+                AppendFamilyHeader(out, name, "gauge", nullptr);
+                out += name;
+                out.push_back(' ');
+            }
+            AppendDouble(out, sample.value);
+            out.push_back('\n');
+        }
+    }
+
+    const std::string &OpenMetricsRenderer::FamilyName(const MetricSample &sample)
+    {
+        if (sample.handle >= familyNames_.size())
+        {
+            familyNames_.resize(static_cast<std::size_t>(sample.handle) + 1);
+        }
+
+        FamilyNameEntry &entry = familyNames_[sample.handle];
+        if (entry.resolved)
+        {
+            return entry.name;
+        }
+        entry.resolved = true;
+
+        // "system.cpu_usage_percent" -> "rvrse_system_cpu_usage_percent".
+        std::string candidate = "rvrse_";
+        for (wchar_t ch : sample.name)
+        {
+            const bool valid = (ch >= L'a' && ch <= L'z') || (ch >= L'A' && ch <= L'Z') || (ch >= L'0' && ch <= L'9') || ch == L'_' || ch == L':';
+            candidate.push_back(valid ? static_cast<char>(ch) : '_');
+        }
+
+        // The _total suffix belongs to the counter sample, not the family.
+        constexpr std::string_view kTotal = "_total";
+        if (sample.kind == MetricKind::Counter && candidate.size() > kTotal.size() &&
+            std::string_view(candidate).substr(candidate.size() - kTotal.size()) == kTotal)
+        {
+            candidate.resize(candidate.size() - kTotal.size());
+        }
+
+        // Distinct registry names can sanitize to the same family (e.g.
+        // "a.b" and "a_b"); the later one is dropped rather than emitting an
+        // invalid exposition.
+        if (usedFamilyNames_.insert(candidate).second)
+        {
+            entry.name = std::move(candidate);
+        }
+        return entry.name;
+    }
+
+    OpenMetricsExporter::OpenMetricsExporter(OpenMetricsOptions options)
+        : options_(std::move(options)),
+          renderer_(options_.topProcesses)
+    {
+    }
+
+    OpenMetricsExporter::~OpenMetricsExporter()
+    {
+        Stop();
+    }
+
+    bool OpenMetricsExporter::Start()
+    {
+        return server_.Start(options_.address,
+                             options_.port,
+                             [this](std::string_view path)
+                             { return Serve(path); });
+    }
+
+    void OpenMetricsExporter::Stop()
+    {
+        server_.Stop();
+    }
+
+    void OpenMetricsExporter::Export(const CollectorFrame &frame)
+    {
+        // Reuse the previous buffer unless a scrape is still sending from it.
+        // Once unpublished nobody can take a new reference, so a use count of
+        // one means this thread is its only owner.
+        std::shared_ptr<std::string> buffer = std::move(spare_);
+        if (!buffer || buffer.use_count() != 1)
+        {
+            buffer = std::make_shared<std::string>();
+            if (published_)
+            {
+                buffer->reserve(published_->capacity());
+            }
+        }
+
+        renderer_.Render(frame, *buffer);
+
+        {
+            std::lock_guard<std::mutex> lock(publishMutex_);
+            published_.swap(buffer);
+        }
+        spare_ = std::move(buffer);
+    }
+
+    std::shared_ptr<const std::string> OpenMetricsExporter::Latest() const
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        return published_;
+    }
+
+    HttpResponse OpenMetricsExporter::Serve(std::string_view path) const
+    {
+        HttpResponse response;
+        if (path != "/metrics")
+        {
+            response.status = 404;
+            response.body = std::make_shared<const std::string>("metrics are served at /metrics\n");
+            return response;
+        }
+
+        response.body = Latest();
+        if (!response.body)
+        {
+            response.status = 503;
+            response.body = std::make_shared<const std::string>("no generation sampled yet\n");
+            return response;
+        }
+
+        response.contentType = kContentType;
+        return response;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "collector.h"
+#include "http_server.h"
+
+namespace rvrse::core
+{
+    struct OpenMetricsOptions
+    {
+        std::string address = "127.0.0.1";
+        std::uint16_t port = 9464;
+
+        // Processes exported with their own series: the top N by CPU plus the
+        // top N by working set. Everything else is summed into one
+        // pid="other" series so scrape size stays bounded. 0 exports all.
+        std::size_t topProcesses = 50;
+    };
+
+    // Renders a collector generation as OpenMetrics text: per-process gauges
+    // under the cardinality limit plus every MetricsRegistry metric (system.*,
+    // collector.* and plugin metrics). Keeps the previous generation's CPU
+    // times to derive per-process CPU usage.
+    class OpenMetricsRenderer
+    {
+    public:
+        explicit OpenMetricsRenderer(std::size_t topProcesses = 50) : topProcesses_(topProcesses) {}
+
+        // Replaces out's contents, keeping its capacity for the next generation.
+        void Render(const CollectorFrame &frame, std::string &out);
+
+    private:
+        void UpdateCpuUsage(const CollectorFrame &frame);
+        void SelectProcesses(const ProcessSnapshot &processes);
+        void RenderProcesses(const ProcessSnapshot &processes, std::string &out);
+        void RenderRegistry(const MetricsRegistry &registry, std::string &out);
+        const std::string &FamilyName(const MetricSample &sample);
+
+        std::size_t topProcesses_;
+
+        // (pid, kernel + user time) from the previous generation, PID-sorted
+        // like the snapshot so usage is a merge walk rather than a lookup.
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> previousCpuTimes_;
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> currentCpuTimes_;
+        std::chrono::system_clock::time_point previousTimestamp_{};
+        bool hasCpuBaseline_ = false;
+
+        // Per-generation scratch, reused so steady-state renders do not allocate.
+        std::vector<double> cpuPercent_;
+        std::vector<std::uint32_t> ranking_;
+        std::vector<std::uint8_t> selected_;
+        std::string labels_;
+        std::vector<std::size_t> labelOffsets_;
+        std::vector<MetricSample> samples_;
+
+        // Sanitized family names by registry handle. An empty name marks a
+        // metric that collides with an earlier one and is skipped.
+        struct FamilyNameEntry
+        {
+            bool resolved = false;
+            std::string name;
+        };
+        std::vector<FamilyNameEntry> familyNames_;
+        std::unordered_set<std::string> usedFamilyNames_;
+    };
+
+    // "openmetrics" exporter: renders each generation once on the sampling
+    // thread and serves the latest buffer at http://address:port/metrics.
+    // Scrapes only take a reference to the published buffer, so their cost
+    // does not depend on process count and never touches the sampler.
+    class OpenMetricsExporter final : public CollectorExporter
+    {
+    public:
+        static constexpr const char *kContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+        explicit OpenMetricsExporter(OpenMetricsOptions options = {});
+        ~OpenMetricsExporter() override;
+
+        bool Start();
+        void Stop();
+
+        const wchar_t *Name() const override { return L"openmetrics"; }
+        void Export(const CollectorFrame &frame) override;
+
+        // Latest rendered generation, or nullptr before the first Export().
+        std::shared_ptr<const std::string> Latest() const;
+
+        std::uint16_t Port() const { return server_.Port(); }
+        std::uint64_t ScrapesServed() const { return server_.RequestsServed(); }
+
+    private:
+        HttpResponse Serve(std::string_view path) const;
+
+        OpenMetricsOptions options_;
+        OpenMetricsRenderer renderer_;
+
+        mutable std::mutex publishMutex_;
+        std::shared_ptr<std::string> published_;
+
+        // Previous buffer, rendered into again once no scrape still holds it.
+        std::shared_ptr<std::string> spare_;
+
+        HttpServer server_;
+    };
+}
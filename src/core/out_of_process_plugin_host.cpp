@@ -0,0 +1,300 @@
+#include "out_of_process_plugin_host.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <csignal>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+namespace
+{
+    // Hosts poll the ring every 100 ms, so they notice the closed flag well
+    // within this window; anything slower is killed.
+    constexpr std::chrono::milliseconds kShutdownGracePeriod{2000};
+
+    std::atomic<std::uint32_t> g_ringCounter{0};
+
+    void LogMessage(const std::wstring &message)
+    {
+#if defined(_WIN32)
+        OutputDebugStringW(message.c_str());
+#else
+        std::fputws(message.c_str(), stderr);
+#endif
+    }
+
+    std::wstring MakeRingName()
+    {
+        const std::uint32_t sequence = g_ringCounter.fetch_add(1);
+#if defined(_WIN32)
+        return L"Local\\RvrseSnapshotRing-" + std::to_wstring(GetCurrentProcessId()) + L"-" + std::to_wstring(sequence);
+#else
+        return L"/rvrse-ring-" + std::to_wstring(getpid()) + L"-" + std::to_wstring(sequence);
+#endif
+    }
+}
+
+namespace rvrse::core
+{
+    namespace fs = std::filesystem;
+
+    OutOfProcessPluginHost::OutOfProcessPluginHost(std::wstring hostExecutable)
+        : hostExecutable_(std::move(hostExecutable))
+    {
+        if (hostExecutable_.empty())
+        {
+            hostExecutable_ = ResolveDefaultExecutable();
+        }
+    }
+
+    OutOfProcessPluginHost::~OutOfProcessPluginHost()
+    {
+        Stop();
+    }
+
+    bool OutOfProcessPluginHost::Start(const std::vector<std::wstring> &pluginPaths,
+                                       std::uint32_t slotCount,
+                                       std::size_t slotCapacityBytes)
+    {
+        Stop();
+
+        if (pluginPaths.empty() || hostExecutable_.empty())
+        {
+            return false;
+        }
+
+        ringName_ = MakeRingName();
+        if (!ring_.Create(ringName_, slotCount, slotCapacityBytes))
+        {
+            LogMessage(L"[PluginHost] Failed to create snapshot ring " + ringName_ + L"\n");
+            ringName_.clear();
+            return false;
+        }
+
+        for (const auto &path : pluginPaths)
+        {
+            HostProcess host{};
+            host.pluginPath = path;
+            Launch(host);
+            hosts_.push_back(std::move(host));
+        }
+
+        if (RunningHostCount() == 0)
+        {
+            Stop();
+            return false;
+        }
+
+        return true;
+    }
+
+    void OutOfProcessPluginHost::Stop()
+    {
+        ring_.Close();
+
+        const auto deadline = std::chrono::steady_clock::now() + kShutdownGracePeriod;
+        for (auto &host : hosts_)
+        {
+            Terminate(host, deadline);
+        }
+
+        hosts_.clear();
+        ringName_.clear();
+    }
+
+    bool OutOfProcessPluginHost::Publish(const ProcessSnapshot &processes,
+                                         const HandleSnapshot &handles,
+                                         const NetworkSnapshot &network,
+                                         const SystemMetrics &metrics)
+    {
+        if (!ring_.IsOpen())
+        {
+            return false;
+        }
+
+        ReapExitedHosts();
+        return ring_.Publish(processes, handles, network, metrics);
+    }
+
+    std::size_t OutOfProcessPluginHost::RunningHostCount() const
+    {
+        std::size_t count = 0;
+        for (const auto &host : hosts_)
+        {
+            if (host.running)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    void OutOfProcessPluginHost::ReapExitedHosts()
+    {
+        for (auto &host : hosts_)
+        {
+            if (!host.running || !PollExited(host))
+            {
+                continue;
+            }
+
+            // A crashed host may still hold a pin; free it so the slot is reusable.
+            ring_.ReleaseReader(host.processId);
+
+            if (host.restarts >= kMaxRestarts)
+            {
+                LogMessage(L"[PluginHost] Giving up on " + host.pluginPath + L" after repeated exits\n");
+                continue;
+            }
+
+            ++host.restarts;
+            LogMessage(L"[PluginHost] Restarting host for " + host.pluginPath + L"\n");
+            Launch(host);
+        }
+    }
+
+    bool OutOfProcessPluginHost::Launch(HostProcess &host)
+    {
+        host.running = false;
+        host.processId = 0;
+
+#if defined(_WIN32)
+        std::wstring commandLine = L"\"" + hostExecutable_ + L"\" --ring \"" + ringName_ + L"\" --plugin \"" + host.pluginPath + L"\"";
+
+        STARTUPINFOW startupInfo{};
+        startupInfo.cb = sizeof(startupInfo);
+        PROCESS_INFORMATION processInfo{};
+        if (!CreateProcessW(hostExecutable_.c_str(),
+                            commandLine.data(),
+                            nullptr,
+                            nullptr,
+                            FALSE,
+                            CREATE_NO_WINDOW,
+                            nullptr,
+                            nullptr,
+                            &startupInfo,
+                            &processInfo))
+        {
+            LogMessage(L"[PluginHost] Failed to launch " + hostExecutable_ + L" for " + host.pluginPath + L"\n");
+            return false;
+        }
+
+        CloseHandle(processInfo.hThread);
+        host.process = processInfo.hProcess;
+        host.processId = processInfo.dwProcessId;
+#else
+        const std::string executable = fs::path(hostExecutable_).string();
+        const std::string ring = fs::path(ringName_).string();
+        const std::string plugin = fs::path(host.pluginPath).string();
+        const char *argv[] = {executable.c_str(), "--ring", ring.c_str(), "--plugin", plugin.c_str(), nullptr};
+
+        pid_t pid = 0;
+        if (posix_spawn(&pid, executable.c_str(), nullptr, nullptr, const_cast<char *const *>(argv), environ) != 0)
+        {
+            LogMessage(L"[PluginHost] Failed to launch " + hostExecutable_ + L" for " + host.pluginPath + L"\n");
+            return false;
+        }
+
+        host.processId = static_cast<std::uint32_t>(pid);
+#endif
+
+        host.running = true;
+        return true;
+    }
+
+    bool OutOfProcessPluginHost::PollExited(HostProcess &host)
+    {
+#if defined(_WIN32)
+        if (!host.process || WaitForSingleObject(static_cast<HANDLE>(host.process), 0) != WAIT_OBJECT_0)
+        {
+            return false;
+        }
+
+        CloseHandle(static_cast<HANDLE>(host.process));
+        host.process = nullptr;
+#else
+        int status = 0;
+        if (waitpid(static_cast<pid_t>(host.processId), &status, WNOHANG) != static_cast<pid_t>(host.processId))
+        {
+            return false;
+        }
+#endif
+
+        host.running = false;
+        return true;
+    }
+
+    void OutOfProcessPluginHost::Terminate(HostProcess &host, std::chrono::steady_clock::time_point deadline)
+    {
+        if (!host.running)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        DWORD waitMs = remaining.count() > 0 ? static_cast<DWORD>(remaining.count()) : 0;
+        HANDLE process = static_cast<HANDLE>(host.process);
+        if (WaitForSingleObject(process, waitMs) != WAIT_OBJECT_0)
+        {
+            TerminateProcess(process, 1);
+            WaitForSingleObject(process, INFINITE);
+        }
+        CloseHandle(process);
+        host.process = nullptr;
+#else
+        const auto pid = static_cast<pid_t>(host.processId);
+        int status = 0;
+        while (waitpid(pid, &status, WNOHANG) == 0)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                kill(pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+#endif
+
+        host.running = false;
+    }
+
+    std::wstring OutOfProcessPluginHost::ResolveDefaultExecutable() const
+    {
+#if defined(_WIN32)
+        wchar_t pathBuffer[MAX_PATH] = {0};
+        DWORD result = GetModuleFileNameW(nullptr, pathBuffer, static_cast<DWORD>(std::size(pathBuffer)));
+        if (result == 0 || result == std::size(pathBuffer))
+        {
+            return {};
+        }
+
+        fs::path exePath(pathBuffer);
+        return (exePath.parent_path() / L"rvrse-plugin-host.exe").wstring();
+#else
+        std::error_code ec;
+        fs::path exePath = fs::read_symlink("/proc/self/exe", ec);
+        if (ec)
+        {
+            return {};
+        }
+
+        return (exePath.parent_path() / L"rvrse-plugin-host").wstring();
+#endif
+    }
+}
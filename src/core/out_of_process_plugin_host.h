@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "handle_snapshot.h"
+#include "network_snapshot.h"
+#include "process_snapshot.h"
+#include "snapshot_ring.h"
+#include "system_metrics.h"
+
+namespace rvrse::core
+{
+    // Runs each plugin in its own rvrse-plugin-host process so a crashing or
+    // stalling plugin cannot take the monitor down with it. Snapshots are
+    // serialized once per refresh into a SnapshotRingWriter; every host process
+    // reads them in place and calls its plugin's hooks.
+    //
+    // Host services are local to each plugin process: metrics registered there
+    // are not forwarded to the monitor's MetricsRegistry.
+    class OutOfProcessPluginHost
+    {
+    public:
+        // Restarts per plugin before it is left stopped.
+        static constexpr std::uint32_t kMaxRestarts = 3;
+
+        // An empty hostExecutable resolves rvrse-plugin-host next to the
+        // current executable.
+        explicit OutOfProcessPluginHost(std::wstring hostExecutable = {});
+        ~OutOfProcessPluginHost();
+
+        OutOfProcessPluginHost(const OutOfProcessPluginHost &) = delete;
+        OutOfProcessPluginHost &operator=(const OutOfProcessPluginHost &) = delete;
+
+        // Creates the ring and launches one host process per plugin path.
+        // Returns false if the ring could not be created or no host started.
+        bool Start(const std::vector<std::wstring> &pluginPaths,
+                   std::uint32_t slotCount = SnapshotRingWriter::kDefaultSlotCount,
+                   std::size_t slotCapacityBytes = SnapshotRingWriter::kDefaultSlotCapacityBytes);
+
+        // Closes the ring (hosts exit on their own) and reaps the processes.
+        void Stop();
+
+        // Publishes one generation and restarts hosts that have exited. Never
+        // waits on a plugin process.
+        bool Publish(const ProcessSnapshot &processes,
+                     const HandleSnapshot &handles,
+                     const NetworkSnapshot &network,
+                     const SystemMetrics &metrics);
+
+        std::size_t RunningHostCount() const;
+        const std::wstring &RingName() const { return ringName_; }
+        const SnapshotRingWriter &Ring() const { return ring_; }
+
+    private:
+        struct HostProcess
+        {
+            std::wstring pluginPath;
+#if defined(_WIN32)
+            void *process = nullptr;
+#endif
+            std::uint32_t processId = 0;
+            std::uint32_t restarts = 0;
+            bool running = false;
+        };
+
+        bool Launch(HostProcess &host);
+        bool PollExited(HostProcess &host);
+        void ReapExitedHosts();
+        static void Terminate(HostProcess &host, std::chrono::steady_clock::time_point deadline);
+
+        std::wstring ResolveDefaultExecutable() const;
+
+        std::wstring hostExecutable_;
+        std::wstring ringName_;
+        SnapshotRingWriter ring_;
+        std::vector<HostProcess> hosts_;
+    };
+}
@@ -0,0 +1,97 @@
+#include "output_sink.h"
+
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace rvrse::core
+{
+    FileSink::~FileSink()
+    {
+        Close();
+    }
+
+    bool FileSink::Open(const std::wstring &path, bool append)
+    {
+        Close();
+
+        if (path == L"-")
+        {
+#if defined(_WIN32)
+            // Text mode would turn every "\n" into "\r\n".
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            file_ = stdout;
+            ownsFile_ = false;
+            return true;
+        }
+
+#if defined(_WIN32)
+        file_ = _wfopen(path.c_str(), append ? L"ab" : L"wb");
+#else
+        file_ = std::fopen(std::filesystem::path(path).c_str(), append ? "ab" : "wb");
+#endif
+        if (!file_)
+        {
+            return false;
+        }
+
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+        ownsFile_ = true;
+        return true;
+    }
+
+    void FileSink::Close()
+    {
+        if (file_ && ownsFile_)
+        {
+            std::fclose(file_);
+        }
+        else if (file_)
+        {
+            std::fflush(file_);
+        }
+        file_ = nullptr;
+        ownsFile_ = false;
+    }
+
+    bool FileSink::Write(const char *data, std::size_t sizeBytes)
+    {
+        return file_ && std::fwrite(data, 1, sizeBytes, file_) == sizeBytes;
+    }
+
+    bool FileSink::Flush()
+    {
+        return file_ && std::fflush(file_) == 0;
+    }
+
+    SocketSink::SocketSink(SocketEndpoint endpoint)
+        : endpoint_(std::move(endpoint))
+    {
+    }
+
+    bool SocketSink::Connect()
+    {
+        nextAttempt_ = std::chrono::steady_clock::now() + kRetryInterval;
+        return socket_.Connect(endpoint_);
+    }
+
+    bool SocketSink::Write(const char *data, std::size_t sizeBytes)
+    {
+        if (!socket_.IsOpen() && (std::chrono::steady_clock::now() < nextAttempt_ || !Connect()))
+        {
+            return false;
+        }
+
+        if (!socket_.SendAll(data, sizeBytes))
+        {
+            socket_.Close();
+            return false;
+        }
+        return true;
+    }
+}
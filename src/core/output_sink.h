@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "socket.h"
+
+namespace rvrse::core
+{
+    // Byte stream destination for exporters. Write() consumes the whole
+    // buffer or fails; callers treat a failure as "this output was lost".
+    class OutputSink
+    {
+    public:
+        virtual ~OutputSink() = default;
+
+        virtual bool Write(const char *data, std::size_t sizeBytes) = 0;
+        virtual bool Flush() { return true; }
+    };
+
+    // Regular file, FIFO / named pipe, or standard output ("-"). Writes go
+    // straight to the C runtime without its own buffering; callers already
+    // hand over large chunks.
+    class FileSink final : public OutputSink
+    {
+    public:
+        FileSink() = default;
+        ~FileSink() override;
+
+        FileSink(const FileSink &) = delete;
+        FileSink &operator=(const FileSink &) = delete;
+
+        // "-" selects standard output (switched to binary mode on Windows).
+        bool Open(const std::wstring &path, bool append = true);
+        void Close();
+
+        bool IsOpen() const { return file_ != nullptr; }
+
+        bool Write(const char *data, std::size_t sizeBytes) override;
+        bool Flush() override;
+
+    private:
+        std::FILE *file_ = nullptr;
+        bool ownsFile_ = false;
+    };
+
+    // TCP or Unix domain socket client that reconnects on the next Write()
+    // after the peer goes away, at most once per retry interval, so a
+    // restarted receiver picks the stream back up without restarting the
+    // exporter.
+    class SocketSink final : public OutputSink
+    {
+    public:
+        static constexpr std::chrono::milliseconds kRetryInterval{1000};
+
+        explicit SocketSink(SocketEndpoint endpoint);
+
+        bool Connect();
+        bool IsConnected() const { return socket_.IsOpen(); }
+
+        bool Write(const char *data, std::size_t sizeBytes) override;
+
+    private:
+        SocketEndpoint endpoint_;
+        Socket socket_;
+        std::chrono::steady_clock::time_point nextAttempt_{};
+    };
+}
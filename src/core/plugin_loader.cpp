@@ -1,17 +1,73 @@
 #include "plugin_loader.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <iterator>
+#include <optional>
 #include <string_view>
 #include <system_error>
+#include <thread>
 #include <utility>
 
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
 namespace
 {
-    void LogMessage(const std::wstring &message)
+    // Metrics views are handed to plugins without copying, which relies on
+    // the core struct matching the ABI layout exactly. Connections are
+    // packed and go through ToConnectionInfo().
+    using rvrse::core::SystemMetrics;
+
+    static_assert(static_cast<std::uint32_t>(rvrse::core::TransportProtocol::Tcp) == RVRSE_TRANSPORT_TCP, "Transport value mismatch");
+    static_assert(static_cast<std::uint32_t>(rvrse::core::TransportProtocol::Udp) == RVRSE_TRANSPORT_UDP, "Transport value mismatch");
+    static_assert(static_cast<std::uint32_t>(rvrse::core::AddressFamily::IPv4) == RVRSE_ADDRESS_FAMILY_IPV4, "Address family value mismatch");
+    static_assert(static_cast<std::uint32_t>(rvrse::core::AddressFamily::IPv6) == RVRSE_ADDRESS_FAMILY_IPV6, "Address family value mismatch");
+
+    static_assert(sizeof(SystemMetrics) == sizeof(RvrseSystemMetrics), "SystemMetrics/RvrseSystemMetrics size mismatch");
+    static_assert(offsetof(SystemMetrics, cpuUsagePercent) == offsetof(RvrseSystemMetrics, cpuUsagePercent), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, memoryUsagePercent) == offsetof(RvrseSystemMetrics, memoryUsagePercent), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, physicalMemoryTotalBytes) == offsetof(RvrseSystemMetrics, physicalMemoryTotalBytes), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, physicalMemoryAvailableBytes) == offsetof(RvrseSystemMetrics, physicalMemoryAvailableBytes), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, uptimeMilliseconds) == offsetof(RvrseSystemMetrics, uptimeMilliseconds), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, processCount) == offsetof(RvrseSystemMetrics, processCount), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, threadCount) == offsetof(RvrseSystemMetrics, threadCount), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, handleCount) == offsetof(RvrseSystemMetrics, handleCount), "SystemMetrics layout mismatch");
+    static_assert(offsetof(SystemMetrics, connectionCount) == offsetof(RvrseSystemMetrics, connectionCount), "SystemMetrics layout mismatch");
+
+    void LogMessage(rvrse::common::LogWriter *logWriter, const std::wstring &message)
+    {
+        if (logWriter && logWriter->Write(std::wstring_view(message)))
+        {
+            return;
+        }
+
+        std::wstring line = message + L"\n";
+#if defined(_WIN32)
+        OutputDebugStringW(line.c_str());
+#else
+        std::fputws(line.c_str(), stderr);
+#endif
+    }
+
+    const wchar_t *LogLevelPrefix(std::uint32_t level)
     {
-        OutputDebugStringW(message.c_str());
+        switch (level)
+        {
+        case RVRSE_LOG_DEBUG:
+            return L"[DEBUG] ";
+        case RVRSE_LOG_WARNING:
+            return L"[WARN] ";
+        case RVRSE_LOG_ERROR:
+            return L"[ERROR] ";
+        default:
+            return L"[INFO] ";
+        }
     }
 }
 
@@ -19,16 +75,18 @@ namespace rvrse::core
 {
     namespace fs = std::filesystem;
 
+    constexpr unsigned int kMinDefaultInitializationThreads = 4;
+
     PluginLoader::PluginLoader()
         : pluginDirectory_(ResolveDefaultDirectory())
     {
-        hostServices_.RegisterMenuItem = &PluginLoader::RegisterMenuItemStub;
+        InitializeHostServices();
     }
 
     PluginLoader::PluginLoader(std::wstring pluginDirectory)
         : pluginDirectory_(std::move(pluginDirectory))
     {
-        hostServices_.RegisterMenuItem = &PluginLoader::RegisterMenuItemStub;
+        InitializeHostServices();
     }
 
     PluginLoader::~PluginLoader()
@@ -40,15 +98,67 @@ namespace rvrse::core
     {
         UnloadPlugins();
 
-        if (pluginDirectory_.empty())
+        std::vector<std::wstring> paths = DiscoverPluginPaths();
+        if (paths.empty())
         {
             return;
         }
 
+        std::vector<std::optional<PluginInstance>> results(paths.size());
+        std::atomic<std::size_t> nextIndex{0};
+        auto worker = [&]()
+        {
+            for (std::size_t index = nextIndex.fetch_add(1); index < paths.size(); index = nextIndex.fetch_add(1))
+            {
+                PluginInstance instance{};
+                if (LoadPluginFromPath(paths[index], instance))
+                {
+                    results[index].emplace(std::move(instance));
+                }
+            }
+        };
+
+        // Init routines commonly block on I/O (config files, log files), so the
+        // default does not drop below kMinDefaultInitializationThreads even on
+        // small machines.
+        unsigned int threadCount = maxInitializationThreads_ != 0
+                                       ? maxInitializationThreads_
+                                       : std::max(kMinDefaultInitializationThreads, std::thread::hardware_concurrency());
+        threadCount = std::max(1U, std::min(threadCount, static_cast<unsigned int>(paths.size())));
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+        for (unsigned int i = 1; i < threadCount; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : workers)
+        {
+            thread.join();
+        }
+
+        for (auto &result : results)
+        {
+            if (result)
+            {
+                plugins_.push_back(std::move(*result));
+            }
+        }
+    }
+
+    std::vector<std::wstring> PluginLoader::DiscoverPluginPaths() const
+    {
+        std::vector<std::wstring> paths;
+        if (pluginDirectory_.empty())
+        {
+            return paths;
+        }
+
         std::error_code ec;
         if (!fs::exists(pluginDirectory_, ec) || !fs::is_directory(pluginDirectory_, ec))
         {
-            return;
+            return paths;
         }
 
         for (const auto &entry : fs::directory_iterator(pluginDirectory_, ec))
@@ -58,13 +168,30 @@ namespace rvrse::core
                 continue;
             }
 
-            if (!entry.path().has_extension() || entry.path().extension() != L".dll")
+            if (!entry.path().has_extension() || entry.path().extension() != DynamicLibrary::Extension())
             {
                 continue;
             }
 
-            LoadPluginFromPath(entry.path().wstring());
+            paths.push_back(entry.path().wstring());
         }
+
+        // Directory iteration order is unspecified; sort so registration order
+        // (and therefore broadcast order) is stable across runs.
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    bool PluginLoader::LoadPlugin(const std::wstring &path)
+    {
+        PluginInstance instance{};
+        if (!LoadPluginFromPath(path, instance))
+        {
+            return false;
+        }
+
+        plugins_.push_back(std::move(instance));
+        return true;
     }
 
     void PluginLoader::UnloadPlugins()
@@ -75,14 +202,33 @@ namespace rvrse::core
             {
                 plugin.shutdown();
             }
-            if (plugin.module)
-            {
-                FreeLibrary(plugin.module);
-            }
+            plugin.library.Close();
         }
         plugins_.clear();
     }
 
+    RvrseConnectionInfo ToConnectionInfo(const ConnectionEntry &connection)
+    {
+        RvrseConnectionInfo info{};
+        info.protocol = static_cast<std::uint32_t>(connection.Protocol());
+        info.addressFamily = static_cast<std::uint32_t>(connection.Family());
+        if (connection.Family() == AddressFamily::IPv6)
+        {
+            std::memcpy(info.localAddress6, connection.LocalAddress6(), sizeof(info.localAddress6));
+            std::memcpy(info.remoteAddress6, connection.RemoteAddress6(), sizeof(info.remoteAddress6));
+        }
+        else
+        {
+            info.localAddress = connection.LocalAddress();
+            info.remoteAddress = connection.RemoteAddress();
+        }
+        info.localPort = connection.localPort;
+        info.remotePort = connection.remotePort;
+        info.owningProcessId = connection.owningProcessId;
+        info.state = connection.State();
+        return info;
+    }
+
     void PluginLoader::BroadcastProcessSnapshot(const ProcessSnapshot &snapshot)
     {
         if (plugins_.empty())
@@ -90,20 +236,25 @@ namespace rvrse::core
             return;
         }
 
+        // Interned names are terminated and outlive the snapshot, so the
+        // view points at them directly: the UTF-8 text as stored, and the
+        // wide copy the interner makes the first time a name is asked for.
         struct ProcessBridge
         {
-            std::wstring imageName;
             std::vector<RvrseThreadInfo> threads;
             RvrseProcessInfo info{};
         };
 
         std::vector<ProcessBridge> bridges;
         bridges.reserve(snapshot.Processes().size());
+        std::vector<const char *> imageNamesUtf8;
+        imageNamesUtf8.reserve(snapshot.Processes().size());
 
         for (const auto &process : snapshot.Processes())
         {
             ProcessBridge bridge;
-            bridge.imageName = process.imageName;
+            bridge.info.imageName = process.imageName.c_str();
+            imageNamesUtf8.push_back(process.imageName.Utf8().data());
             bridge.info.processId = process.processId;
             bridge.info.threadCount = process.threadCount;
             bridge.info.workingSetBytes = process.workingSetBytes;
@@ -132,7 +283,6 @@ namespace rvrse::core
         processInfos.reserve(bridges.size());
         for (auto &bridge : bridges)
         {
-            bridge.info.imageName = bridge.imageName.c_str();
             bridge.info.threads = bridge.threads.empty() ? nullptr : bridge.threads.data();
             bridge.info.threadEntryCount = bridge.threads.size();
             processInfos.push_back(bridge.info);
@@ -141,14 +291,9 @@ namespace rvrse::core
         RvrseProcessSnapshotView view{};
         view.processes = processInfos.empty() ? nullptr : processInfos.data();
         view.processCount = processInfos.size();
+        view.imageNamesUtf8 = imageNamesUtf8.empty() ? nullptr : imageNamesUtf8.data();
 
-        for (auto &plugin : plugins_)
-        {
-            if (plugin.hooks.OnProcessSnapshot)
-            {
-                plugin.hooks.OnProcessSnapshot(&view, plugin.hooks.context);
-            }
-        }
+        DispatchProcessSnapshot(view);
     }
 
     void PluginLoader::BroadcastHandleSnapshot(const HandleSnapshot &snapshot)
@@ -176,6 +321,57 @@ namespace rvrse::core
         view.handles = handleInfos.empty() ? nullptr : handleInfos.data();
         view.handleCount = handleInfos.size();
 
+        DispatchHandleSnapshot(view);
+    }
+
+    void PluginLoader::BroadcastNetworkSnapshot(const NetworkSnapshot &snapshot)
+    {
+        if (plugins_.empty())
+        {
+            return;
+        }
+
+        // ConnectionEntry is packed, so the ABI view needs a converted copy;
+        // the buffer keeps its capacity across broadcasts.
+        const auto &connections = snapshot.Connections();
+        connectionInfos_.resize(connections.size());
+        for (std::size_t index = 0; index < connections.size(); ++index)
+        {
+            connectionInfos_[index] = ToConnectionInfo(connections[index]);
+        }
+
+        RvrseNetworkSnapshotView view{};
+        view.connections = connectionInfos_.empty() ? nullptr : connectionInfos_.data();
+        view.connectionCount = connectionInfos_.size();
+        view.flags = (snapshot.AccessDenied() ? RVRSE_NETWORK_ACCESS_DENIED : 0U) |
+                     (snapshot.CaptureFailed() ? RVRSE_NETWORK_CAPTURE_FAILED : 0U);
+
+        DispatchNetworkSnapshot(view);
+    }
+
+    void PluginLoader::BroadcastSystemMetrics(const SystemMetrics &metrics)
+    {
+        if (plugins_.empty())
+        {
+            return;
+        }
+
+        DispatchSystemMetrics(*reinterpret_cast<const RvrseSystemMetrics *>(&metrics));
+    }
+
+    void PluginLoader::DispatchProcessSnapshot(const RvrseProcessSnapshotView &view)
+    {
+        for (auto &plugin : plugins_)
+        {
+            if (plugin.hooks.OnProcessSnapshot)
+            {
+                plugin.hooks.OnProcessSnapshot(&view, plugin.hooks.context);
+            }
+        }
+    }
+
+    void PluginLoader::DispatchHandleSnapshot(const RvrseHandleSnapshotView &view)
+    {
         for (auto &plugin : plugins_)
         {
             if (plugin.hooks.OnHandleSnapshot)
@@ -185,8 +381,31 @@ namespace rvrse::core
         }
     }
 
+    void PluginLoader::DispatchNetworkSnapshot(const RvrseNetworkSnapshotView &view)
+    {
+        for (auto &plugin : plugins_)
+        {
+            if (plugin.hooks.OnNetworkSnapshot)
+            {
+                plugin.hooks.OnNetworkSnapshot(&view, plugin.hooks.context);
+            }
+        }
+    }
+
+    void PluginLoader::DispatchSystemMetrics(const RvrseSystemMetrics &metrics)
+    {
+        for (auto &plugin : plugins_)
+        {
+            if (plugin.hooks.OnSystemMetrics)
+            {
+                plugin.hooks.OnSystemMetrics(&metrics, plugin.hooks.context);
+            }
+        }
+    }
+
     std::wstring PluginLoader::ResolveDefaultDirectory() const
     {
+#if defined(_WIN32)
         wchar_t pathBuffer[MAX_PATH] = {0};
         DWORD result = GetModuleFileNameW(nullptr, pathBuffer, static_cast<DWORD>(std::size(pathBuffer)));
         if (result == 0 || result == std::size(pathBuffer))
@@ -195,67 +414,142 @@ namespace rvrse::core
         }
 
         fs::path exePath(pathBuffer);
+#else
+        std::error_code ec;
+        fs::path exePath = fs::read_symlink("/proc/self/exe", ec);
+        if (ec)
+        {
+            return {};
+        }
+#endif
         fs::path pluginsPath = exePath.parent_path() / L"plugins";
         return pluginsPath.wstring();
     }
 
-    void PluginLoader::LoadPluginFromPath(const std::wstring &path)
+    bool PluginLoader::LoadPluginFromPath(const std::wstring &path, PluginInstance &instance) const
     {
-        HMODULE module = LoadLibraryW(path.c_str());
-        if (!module)
+        if (!instance.library.Open(path))
         {
             std::wstring message = L"[PluginLoader] Failed to load ";
             message += path;
-            message += L"\n";
-            LogMessage(message);
-            return;
+            message += L" (";
+            message += instance.library.LastError();
+            message += L")";
+            LogMessage(logWriter_, message);
+            return false;
         }
 
         auto initialize = reinterpret_cast<RvrsePluginInitializeFn>(
-            GetProcAddress(module, "RvrsePluginInitialize"));
+            instance.library.Symbol("RvrsePluginInitialize"));
         if (!initialize)
         {
             std::wstring message = L"[PluginLoader] Missing RvrsePluginInitialize in ";
             message += path;
-            message += L"\n";
-            LogMessage(message);
-            FreeLibrary(module);
-            return;
+            LogMessage(logWriter_, message);
+            instance.library.Close();
+            return false;
         }
 
         auto shutdown = reinterpret_cast<RvrsePluginShutdownFn>(
-            GetProcAddress(module, "RvrsePluginShutdown"));
+            instance.library.Symbol("RvrsePluginShutdown"));
 
-        PluginInstance instance{};
-        instance.module = module;
         instance.path = path;
 
         if (!initialize(&hostServices_, &instance.info, &instance.hooks))
         {
             std::wstring message = L"[PluginLoader] Initialization failed for ";
             message += path;
-            message += L"\n";
-            LogMessage(message);
-            FreeLibrary(module);
-            return;
+            LogMessage(logWriter_, message);
+            instance.library.Close();
+            return false;
         }
 
-        if (instance.info.apiMajor != RVRSE_PLUGIN_API_VERSION_MAJOR)
+        if (instance.info.apiMajor != RVRSE_PLUGIN_API_VERSION_MAJOR ||
+            instance.info.apiMinor > RVRSE_PLUGIN_API_VERSION_MINOR)
         {
             std::wstring message = L"[PluginLoader] API version mismatch for ";
             message += path;
-            message += L"\n";
-            LogMessage(message);
+            LogMessage(logWriter_, message);
             if (shutdown)
             {
                 shutdown();
             }
-            FreeLibrary(module);
-            return;
+            instance.library.Close();
+            return false;
         }
 
         instance.shutdown = shutdown;
-        plugins_.push_back(std::move(instance));
+        return true;
+    }
+
+    void PluginLoader::InitializeHostServices()
+    {
+        hostServices_.RegisterMenuItem = &PluginLoader::RegisterMenuItemStub;
+        hostServices_.apiMinor = RVRSE_PLUGIN_API_VERSION_MINOR;
+        hostServices_.hostContext = this;
+        hostServices_.RegisterMetric = &PluginLoader::RegisterMetricThunk;
+        hostServices_.AddToCounter = &PluginLoader::AddToCounterThunk;
+        hostServices_.SetGauge = &PluginLoader::SetGaugeThunk;
+        hostServices_.WriteLog = &PluginLoader::WriteLogThunk;
+        hostServices_.FlushLog = &PluginLoader::FlushLogThunk;
+    }
+
+    RvrseMetricHandle PluginLoader::RegisterMetricThunk(void *hostContext, const wchar_t *name, std::uint32_t kind)
+    {
+        auto *self = static_cast<PluginLoader *>(hostContext);
+        if (!self || !self->metricsRegistry_ || !name)
+        {
+            return RVRSE_METRIC_INVALID_HANDLE;
+        }
+
+        if (kind != RVRSE_METRIC_COUNTER && kind != RVRSE_METRIC_GAUGE)
+        {
+            return RVRSE_METRIC_INVALID_HANDLE;
+        }
+
+        return self->metricsRegistry_->Register(name, kind == RVRSE_METRIC_GAUGE ? MetricKind::Gauge : MetricKind::Counter);
+    }
+
+    void PluginLoader::AddToCounterThunk(void *hostContext, RvrseMetricHandle handle, std::uint64_t delta)
+    {
+        auto *self = static_cast<PluginLoader *>(hostContext);
+        if (self && self->metricsRegistry_)
+        {
+            self->metricsRegistry_->Add(handle, delta);
+        }
+    }
+
+    void PluginLoader::SetGaugeThunk(void *hostContext, RvrseMetricHandle handle, double value)
+    {
+        auto *self = static_cast<PluginLoader *>(hostContext);
+        if (self && self->metricsRegistry_)
+        {
+            self->metricsRegistry_->Set(handle, value);
+        }
+    }
+
+    bool PluginLoader::WriteLogThunk(void *hostContext, std::uint32_t level, const wchar_t *message)
+    {
+        auto *self = static_cast<PluginLoader *>(hostContext);
+        if (!self || !self->logWriter_ || !message)
+        {
+            return false;
+        }
+
+        // Reused per thread so steady-state logging does not allocate.
+        thread_local std::wstring line;
+        line.assign(LogLevelPrefix(level));
+        line.append(message);
+        return self->logWriter_->Write(std::wstring_view(line));
+    }
+
+    void PluginLoader::FlushLogThunk(void *hostContext)
+    {
+        auto *self = static_cast<PluginLoader *>(hostContext);
+        if (self && self->logWriter_)
+        {
+            self->logWriter_->Flush();
+        }
     }
 
     void PluginLoader::RegisterMenuItemStub(const wchar_t *menuPath,
@@ -264,7 +558,6 @@ namespace rvrse::core
     {
         std::wstring message = L"[PluginLoader] Menu registration stub called for ";
         message += (menuPath ? menuPath : L"(null)");
-        message += L"\n";
-        LogMessage(message);
+        LogMessage(nullptr, message);
     }
 }
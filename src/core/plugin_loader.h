@@ -4,14 +4,21 @@
 #include <string>
 #include <vector>
 
-#include <windows.h>
-
+#include "dynamic_library.h"
 #include "handle_snapshot.h"
+#include "metrics_registry.h"
+#include "network_snapshot.h"
 #include "process_snapshot.h"
+#include "system_metrics.h"
+#include "rvrse/common/log_writer.h"
 #include "rvrse/plugin_api.h"
 
 namespace rvrse::core
 {
+    // The ABI form of a connection: ConnectionEntry packs its addresses,
+    // RvrseConnectionInfo keeps separate IPv4 and IPv6 fields.
+    RvrseConnectionInfo ToConnectionInfo(const ConnectionEntry &connection);
+
     class PluginLoader
     {
     public:
@@ -19,16 +26,49 @@ namespace rvrse::core
         explicit PluginLoader(std::wstring pluginDirectory);
         ~PluginLoader();
 
+        // Scans the plugin directory and initializes every plugin found. Plugin
+        // initialization runs on up to maxInitializationThreads workers; plugins
+        // are registered in directory order regardless of completion order.
         void LoadPlugins();
         void UnloadPlugins();
 
+        // Loads a single plugin in addition to any already loaded. Used by the
+        // out-of-process plugin host, which runs one plugin per process.
+        bool LoadPlugin(const std::wstring &path);
+
+        // Plugin files LoadPlugins() would consider, sorted by path.
+        std::vector<std::wstring> DiscoverPluginPaths() const;
+
+        // 0 selects a default based on std::thread::hardware_concurrency(); 1 loads serially.
+        void SetMaxInitializationThreads(unsigned int threadCount) { maxInitializationThreads_ = threadCount; }
+        std::size_t PluginCount() const { return plugins_.size(); }
+
+        // Registry backing the RegisterMetric/AddToCounter/SetGauge host
+        // services. Must be set before LoadPlugins(); the registry must outlive
+        // the loaded plugins. Without one, metric registration fails.
+        void SetMetricsRegistry(MetricsRegistry *registry) { metricsRegistry_ = registry; }
+
+        // Host log backing the WriteLog/FlushLog host services and the loader's
+        // own diagnostics. Same lifetime rules as the metrics registry. Without
+        // one, diagnostics go to the debugger/stderr and WriteLog drops lines.
+        void SetLogWriter(rvrse::common::LogWriter *logWriter) { logWriter_ = logWriter; }
+
         void BroadcastProcessSnapshot(const ProcessSnapshot &snapshot);
         void BroadcastHandleSnapshot(const HandleSnapshot &snapshot);
+        void BroadcastNetworkSnapshot(const NetworkSnapshot &snapshot);
+        void BroadcastSystemMetrics(const SystemMetrics &metrics);
+
+        // Hand pre-built ABI views to every plugin (e.g. views backed by a
+        // SnapshotRingFrame); the Broadcast* overloads above build these.
+        void DispatchProcessSnapshot(const RvrseProcessSnapshotView &view);
+        void DispatchHandleSnapshot(const RvrseHandleSnapshotView &view);
+        void DispatchNetworkSnapshot(const RvrseNetworkSnapshotView &view);
+        void DispatchSystemMetrics(const RvrseSystemMetrics &metrics);
 
     private:
         struct PluginInstance
         {
-            HMODULE module = nullptr;
+            DynamicLibrary library;
             std::wstring path;
             RvrsePluginInfo info{};
             RvrsePluginHooks hooks{};
@@ -36,14 +76,26 @@ namespace rvrse::core
         };
 
         std::wstring ResolveDefaultDirectory() const;
-        void LoadPluginFromPath(const std::wstring &path);
+        bool LoadPluginFromPath(const std::wstring &path, PluginInstance &instance) const;
+
+        void InitializeHostServices();
 
         static void RegisterMenuItemStub(const wchar_t *menuPath,
                                          RvrsePluginMenuCommand command,
                                          void *context);
+        static RvrseMetricHandle RegisterMetricThunk(void *hostContext, const wchar_t *name, std::uint32_t kind);
+        static void AddToCounterThunk(void *hostContext, RvrseMetricHandle handle, std::uint64_t delta);
+        static void SetGaugeThunk(void *hostContext, RvrseMetricHandle handle, double value);
+        static bool WriteLogThunk(void *hostContext, std::uint32_t level, const wchar_t *message);
+        static void FlushLogThunk(void *hostContext);
 
         std::wstring pluginDirectory_;
         std::vector<PluginInstance> plugins_;
+        // BroadcastNetworkSnapshot()'s converted view, reused across calls.
+        std::vector<RvrseConnectionInfo> connectionInfos_;
         RvrseHostServices hostServices_{};
+        unsigned int maxInitializationThreads_ = 0;
+        MetricsRegistry *metricsRegistry_ = nullptr;
+        rvrse::common::LogWriter *logWriter_ = nullptr;
     };
 }
@@ -0,0 +1,240 @@
+#if defined(_WIN32)
+#define NOMINMAX
+#endif
+
+#include "poller.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+
+#pragma comment(lib, "Ws2_32.lib")
+#elif defined(__linux__)
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#include <cerrno>
+
+#include <poll.h>
+#endif
+
+namespace
+{
+#if defined(__linux__)
+    // Token reserved for the wake eventfd; socket tokens never reach it.
+    constexpr std::uint64_t kWakeToken = ~0ULL;
+    constexpr int kMaxEventsPerWait = 256;
+#endif
+}
+
+namespace rvrse::core
+{
+    Poller::~Poller()
+    {
+        Close();
+    }
+
+#if defined(__linux__)
+    bool Poller::Open()
+    {
+        Close();
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeEvent_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (epoll_ < 0 || wakeEvent_ < 0)
+        {
+            Close();
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = kWakeToken;
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeEvent_, &event) != 0)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Poller::Close()
+    {
+        if (wakeEvent_ >= 0)
+        {
+            ::close(wakeEvent_);
+            wakeEvent_ = -1;
+        }
+        if (epoll_ >= 0)
+        {
+            ::close(epoll_);
+            epoll_ = -1;
+        }
+    }
+
+    bool Poller::IsOpen() const
+    {
+        return epoll_ >= 0;
+    }
+
+    bool Poller::Add(Socket::NativeHandle handle, std::uint64_t token)
+    {
+        if (epoll_ < 0 || token == kWakeToken)
+        {
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = token;
+        return epoll_ctl(epoll_, EPOLL_CTL_ADD, handle, &event) == 0;
+    }
+
+    void Poller::Remove(Socket::NativeHandle handle)
+    {
+        if (epoll_ >= 0)
+        {
+            epoll_ctl(epoll_, EPOLL_CTL_DEL, handle, nullptr);
+        }
+    }
+
+    std::size_t Poller::Wait(std::vector<std::uint64_t> &ready, std::chrono::milliseconds timeout)
+    {
+        ready.clear();
+        if (epoll_ < 0)
+        {
+            return 0;
+        }
+
+        epoll_event events[kMaxEventsPerWait];
+        int count;
+        do
+        {
+            count = epoll_wait(epoll_, events, kMaxEventsPerWait, static_cast<int>(timeout.count()));
+        } while (count < 0 && errno == EINTR);
+
+        for (int index = 0; index < count; ++index)
+        {
+            if (events[index].data.u64 == kWakeToken)
+            {
+                std::uint64_t value = 0;
+                while (::read(wakeEvent_, &value, sizeof(value)) > 0)
+                {
+                }
+                continue;
+            }
+            ready.push_back(events[index].data.u64);
+        }
+        return ready.size();
+    }
+
+    void Poller::Wake()
+    {
+        if (wakeEvent_ >= 0)
+        {
+            const std::uint64_t value = 1;
+            [[maybe_unused]] const auto written = ::write(wakeEvent_, &value, sizeof(value));
+        }
+    }
+#else
+    bool Poller::Open()
+    {
+        Close();
+        open_ = true;
+        return true;
+    }
+
+    void Poller::Close()
+    {
+        registrations_.clear();
+        open_ = false;
+    }
+
+    bool Poller::IsOpen() const
+    {
+        return open_;
+    }
+
+    bool Poller::Add(Socket::NativeHandle handle, std::uint64_t token)
+    {
+        if (!open_)
+        {
+            return false;
+        }
+        registrations_.push_back({handle, token});
+        return true;
+    }
+
+    void Poller::Remove(Socket::NativeHandle handle)
+    {
+        registrations_.erase(std::remove_if(registrations_.begin(),
+                                            registrations_.end(),
+                                            [handle](const Registration &registration)
+                                            { return registration.handle == handle; }),
+                             registrations_.end());
+    }
+
+    std::size_t Poller::Wait(std::vector<std::uint64_t> &ready, std::chrono::milliseconds timeout)
+    {
+        ready.clear();
+
+        // No portable way to interrupt poll(), so wait in short slices and
+        // check for a wake request between them.
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::vector<pollfd> descriptors(registrations_.size());
+        for (std::size_t index = 0; index < registrations_.size(); ++index)
+        {
+            descriptors[index].fd = static_cast<decltype(pollfd::fd)>(registrations_[index].handle);
+            descriptors[index].events = POLLIN;
+        }
+
+        for (;;)
+        {
+            if (wakeRequested_.exchange(false))
+            {
+                return 0;
+            }
+
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            const auto slice = std::max(std::chrono::milliseconds(0), std::min(remaining, kFallbackWakeLatency));
+#if defined(_WIN32)
+            if (descriptors.empty())
+            {
+                // WSAPoll() rejects an empty set.
+                Sleep(static_cast<DWORD>(slice.count()));
+            }
+            const int count = descriptors.empty() ? 0 : WSAPoll(descriptors.data(), static_cast<ULONG>(descriptors.size()), static_cast<int>(slice.count()));
+#else
+            int count;
+            do
+            {
+                count = ::poll(descriptors.data(), static_cast<nfds_t>(descriptors.size()), static_cast<int>(slice.count()));
+            } while (count < 0 && errno == EINTR);
+#endif
+            if (count > 0)
+            {
+                for (std::size_t index = 0; index < descriptors.size(); ++index)
+                {
+                    if (descriptors[index].revents != 0)
+                    {
+                        ready.push_back(registrations_[index].token);
+                    }
+                }
+                return ready.size();
+            }
+            if (count < 0 || remaining <= kFallbackWakeLatency)
+            {
+                return 0;
+            }
+        }
+    }
+
+    void Poller::Wake()
+    {
+        wakeRequested_.store(true);
+    }
+#endif
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "socket.h"
+
+namespace rvrse::core
+{
+    // Readiness notification for many sockets on one thread: epoll on Linux
+    // (level-triggered, with an eventfd for Wake()), poll()/WSAPoll()
+    // elsewhere. Sockets are registered with a caller-chosen token, which is
+    // what Wait() reports back.
+    //
+    // Add/Remove/Wait belong to the owning thread; Wake() may be called from
+    // any thread.
+    class Poller
+    {
+    public:
+        Poller() = default;
+        ~Poller();
+
+        Poller(const Poller &) = delete;
+        Poller &operator=(const Poller &) = delete;
+
+        bool Open();
+        void Close();
+        bool IsOpen() const;
+
+        // Reports the socket whenever it has data (or a hang-up) pending.
+        bool Add(Socket::NativeHandle handle, std::uint64_t token);
+        void Remove(Socket::NativeHandle handle);
+
+        // Waits up to timeout, or until Wake(), and replaces ready with the
+        // tokens of readable sockets. Returns ready.size().
+        std::size_t Wait(std::vector<std::uint64_t> &ready, std::chrono::milliseconds timeout);
+
+        // Makes a pending or the next Wait() return early. Without epoll the
+        // wait is only cut short at kFallbackWakeLatency.
+        void Wake();
+
+        static constexpr std::chrono::milliseconds kFallbackWakeLatency{20};
+
+    private:
+#if defined(__linux__)
+        int epoll_ = -1;
+        int wakeEvent_ = -1;
+#else
+        struct Registration
+        {
+            Socket::NativeHandle handle;
+            std::uint64_t token;
+        };
+        std::vector<Registration> registrations_;
+        bool open_ = false;
+        std::atomic<bool> wakeRequested_{false};
+#endif
+    };
+}
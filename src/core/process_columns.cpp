@@ -0,0 +1,129 @@
+#include "process_columns.h"
+
+#include <algorithm>
+#include <array>
+#include <cwchar>
+
+#include "name_matcher.h"
+#include "rvrse/common/formatting.h"
+
+namespace
+{
+    using rvrse::core::ProcessEntry;
+    using rvrse::core::ProcessSortColumn;
+    using rvrse::core::kProcessColumnTextCapacity;
+
+    using ColumnFormatter = std::wstring_view (*)(const ProcessEntry &, wchar_t (&)[kProcessColumnTextCapacity]);
+
+    template <std::size_t... Index>
+    constexpr std::array<ColumnFormatter, sizeof...(Index)> MakeFormatters(std::index_sequence<Index...>)
+    {
+        return {&rvrse::core::FormatProcessColumnAs<static_cast<ProcessSortColumn>(Index)>...};
+    }
+
+    constexpr auto kFormatters = MakeFormatters(std::make_index_sequence<rvrse::core::kProcessColumnCount>{});
+
+    static_assert(kProcessColumnTextCapacity >= rvrse::common::kFormatSizeCapacity,
+                  "FormatSize() results must fit a column buffer");
+
+    std::uint32_t FoldAscii(std::uint32_t ch)
+    {
+        return ch - 'A' < 26u ? ch + ('a' - 'A') : ch;
+    }
+
+    // The next code point of UTF-8 text, folded like FoldNameCase(); past
+    // the BMP on UTF-16 builds there is nothing to fold.
+    std::uint32_t NextFoldedCodePoint(std::string_view text, std::size_t &index)
+    {
+        const auto lead = static_cast<unsigned char>(text[index++]);
+        if (lead < 0x80)
+        {
+            return FoldAscii(lead);
+        }
+
+        const std::size_t extra = lead >= 0xF0 ? 3 : (lead >= 0xE0 ? 2 : 1);
+        std::uint32_t codePoint = lead & (0x3Fu >> extra);
+        for (std::size_t count = 0; count < extra && index < text.size(); ++count)
+        {
+            codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[index++]) & 0x3Fu);
+        }
+        if (codePoint > static_cast<std::uint32_t>(WCHAR_MAX))
+        {
+            return codePoint;
+        }
+        return static_cast<std::uint32_t>(rvrse::core::FoldNameCase(static_cast<wchar_t>(codePoint)));
+    }
+}
+
+namespace rvrse::core
+{
+    int CompareProcessNames(std::string_view lhs, std::string_view rhs)
+    {
+        if (lhs.data() == rhs.data() && lhs.size() == rhs.size())
+        {
+            return 0;
+        }
+
+        std::size_t left = 0;
+        std::size_t right = 0;
+        while (left < lhs.size() && right < rhs.size())
+        {
+            const auto leftByte = static_cast<unsigned char>(lhs[left]);
+            const auto rightByte = static_cast<unsigned char>(rhs[right]);
+            std::uint32_t leftFolded = 0;
+            std::uint32_t rightFolded = 0;
+            if ((leftByte | rightByte) < 0x80)
+            {
+                leftFolded = FoldAscii(leftByte);
+                rightFolded = FoldAscii(rightByte);
+                ++left;
+                ++right;
+            }
+            else
+            {
+                leftFolded = NextFoldedCodePoint(lhs, left);
+                rightFolded = NextFoldedCodePoint(rhs, right);
+            }
+            if (leftFolded != rightFolded)
+            {
+                return leftFolded < rightFolded ? -1 : 1;
+            }
+        }
+        return static_cast<int>(left < lhs.size()) - static_cast<int>(right < rhs.size());
+    }
+
+    std::wstring_view FormatProcessDecimal(std::uint64_t value, wchar_t (&buffer)[kProcessColumnTextCapacity])
+    {
+        // Digits from the end of the buffer backwards, terminated for
+        // callers that want a C string.
+        wchar_t *end = buffer + kProcessColumnTextCapacity - 1;
+        *end = L'\0';
+        wchar_t *begin = end;
+        do
+        {
+            *--begin = static_cast<wchar_t>(L'0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        return std::wstring_view(begin, static_cast<std::size_t>(end - begin));
+    }
+
+    std::wstring_view FormatProcessSize(std::uint64_t bytes, wchar_t (&buffer)[kProcessColumnTextCapacity])
+    {
+        wchar_t sized[rvrse::common::kFormatSizeCapacity];
+        const std::wstring_view text = rvrse::common::FormatSize(bytes, sized);
+        std::copy(text.begin(), text.end(), buffer);
+        buffer[text.size()] = L'\0';
+        return std::wstring_view(buffer, text.size());
+    }
+
+    std::wstring_view FormatProcessColumn(const ProcessEntry &process, ProcessSortColumn column, wchar_t (&buffer)[kProcessColumnTextCapacity])
+    {
+        const auto index = static_cast<std::size_t>(column);
+        if (index >= kFormatters.size())
+        {
+            buffer[0] = L'\0';
+            return std::wstring_view();
+        }
+        return kFormatters[index](process, buffer);
+    }
+}
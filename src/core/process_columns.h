@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "process_snapshot.h"
+
+namespace rvrse::core
+{
+    // Sort keys of the process list: the kProcessColumns entries in order,
+    // then the ones only ProcessView has.
+    enum class ProcessSortColumn
+    {
+        Name,
+        ProcessId,
+        Threads,
+        WorkingSet,
+        PrivateBytes,
+
+        // Usage since the previous generation; only ProcessView has it.
+        CpuPercent,
+    };
+
+    enum class ProcessColumnFormat
+    {
+        Text,
+        Decimal,
+        Size,
+    };
+
+    // Room for the longest formatted value: a 20-digit decimal.
+    constexpr std::size_t kProcessColumnTextCapacity = 24;
+
+    // One process list column: the ProcessEntry field behind it, its list
+    // view title and width, and its name in exports. Everything per column
+    // (comparison, formatting) is a template over the descriptor type, so
+    // each column gets its own code at compile time instead of a switch on
+    // the column in every call.
+    template <ProcessSortColumn Id, auto Member, ProcessColumnFormat Format>
+    struct ProcessColumn
+    {
+        static constexpr ProcessSortColumn kId = Id;
+        static constexpr ProcessColumnFormat kFormat = Format;
+        static constexpr auto kMember = Member;
+
+        std::wstring_view title;
+        int width = 0;
+        std::string_view exportName;
+
+        // Text columns as their interned UTF-8, numbers as they are stored.
+        static auto Value(const ProcessEntry &process)
+        {
+            if constexpr (Format == ProcessColumnFormat::Text)
+            {
+                return (process.*Member).Utf8();
+            }
+            else
+            {
+                return process.*Member;
+            }
+        }
+    };
+
+    // The monitor's list view columns, in order. Adding an entry adds the
+    // list view column, its sort, its text and its NDJSON field.
+    inline constexpr auto kProcessColumns = std::make_tuple(
+        ProcessColumn<ProcessSortColumn::Name, &ProcessEntry::imageName, ProcessColumnFormat::Text>{L"Process", 320, "name"},
+        ProcessColumn<ProcessSortColumn::ProcessId, &ProcessEntry::processId, ProcessColumnFormat::Decimal>{L"PID", 80, "pid"},
+        ProcessColumn<ProcessSortColumn::Threads, &ProcessEntry::threadCount, ProcessColumnFormat::Decimal>{L"Threads", 90, "threads"},
+        ProcessColumn<ProcessSortColumn::WorkingSet, &ProcessEntry::workingSetBytes, ProcessColumnFormat::Size>{L"Working Set", 140, "working_set_bytes"},
+        ProcessColumn<ProcessSortColumn::PrivateBytes, &ProcessEntry::privateBytes, ProcessColumnFormat::Size>{L"Private Bytes", 140, "private_bytes"});
+
+    constexpr std::size_t kProcessColumnCount = std::tuple_size_v<std::decay_t<decltype(kProcessColumns)>>;
+
+    template <ProcessSortColumn Column>
+    using ProcessColumnType = std::decay_t<std::tuple_element_t<static_cast<std::size_t>(Column), std::decay_t<decltype(kProcessColumns)>>>;
+
+    namespace detail
+    {
+        template <std::size_t... Index>
+        constexpr bool ProcessColumnsInOrder(std::index_sequence<Index...>)
+        {
+            return ((ProcessColumnType<static_cast<ProcessSortColumn>(Index)>::kId == static_cast<ProcessSortColumn>(Index)) && ...);
+        }
+
+        template <typename Visitor, std::size_t... Index>
+        bool VisitProcessColumn(ProcessSortColumn column, Visitor &visitor, std::index_sequence<Index...>)
+        {
+            return ((column == static_cast<ProcessSortColumn>(Index)
+                         ? (visitor(std::integral_constant<ProcessSortColumn, static_cast<ProcessSortColumn>(Index)>{}), true)
+                         : false) ||
+                    ...);
+        }
+    }
+
+    static_assert(detail::ProcessColumnsInOrder(std::make_index_sequence<kProcessColumnCount>{}),
+                  "kProcessColumns must be in ProcessSortColumn order");
+    static_assert(static_cast<std::size_t>(ProcessSortColumn::CpuPercent) == kProcessColumnCount,
+                  "ProcessSortColumn values past kProcessColumns are view-only");
+
+    // Case-insensitive, as the filter folds names, over UTF-8 code points.
+    // Interned text is compared by pointer first: equal names are one
+    // string, so most ties cost no decoding.
+    int CompareProcessNames(std::string_view lhs, std::string_view rhs);
+
+    std::wstring_view FormatProcessDecimal(std::uint64_t value, wchar_t (&buffer)[kProcessColumnTextCapacity]);
+    std::wstring_view FormatProcessSize(std::uint64_t bytes, wchar_t (&buffer)[kProcessColumnTextCapacity]);
+
+    // Three-way comparison on one column with PID as the tie-break. Numbers
+    // compare without branches.
+    template <ProcessSortColumn Column>
+    int CompareProcessColumn(const ProcessEntry &lhs, const ProcessEntry &rhs)
+    {
+        using Descriptor = ProcessColumnType<Column>;
+        const auto compare = [](auto left, auto right)
+        { return static_cast<int>(left > right) - static_cast<int>(left < right); };
+
+        int result = 0;
+        if constexpr (Descriptor::kFormat == ProcessColumnFormat::Text)
+        {
+            result = CompareProcessNames(Descriptor::Value(lhs), Descriptor::Value(rhs));
+        }
+        else
+        {
+            result = compare(Descriptor::Value(lhs), Descriptor::Value(rhs));
+        }
+        return result != 0 ? result : compare(lhs.processId, rhs.processId);
+    }
+
+    // std::sort ordering for one column and direction. Descending is the
+    // exact reverse, PID tie-break included.
+    template <ProcessSortColumn Column, bool Ascending>
+    struct ProcessColumnLess
+    {
+        bool operator()(const ProcessEntry &lhs, const ProcessEntry &rhs) const
+        {
+            const int result = CompareProcessColumn<Column>(lhs, rhs);
+            return Ascending ? result < 0 : result > 0;
+        }
+    };
+
+    template <ProcessSortColumn Column>
+    std::wstring_view FormatProcessColumnAs(const ProcessEntry &process, wchar_t (&buffer)[kProcessColumnTextCapacity])
+    {
+        using Descriptor = ProcessColumnType<Column>;
+        if constexpr (Descriptor::kFormat == ProcessColumnFormat::Text)
+        {
+            return (process.*Descriptor::kMember).View();
+        }
+        else if constexpr (Descriptor::kFormat == ProcessColumnFormat::Decimal)
+        {
+            return FormatProcessDecimal(Descriptor::Value(process), buffer);
+        }
+        else
+        {
+            return FormatProcessSize(Descriptor::Value(process), buffer);
+        }
+    }
+
+    // The list view text of a column. Text columns return the interned
+    // wide text; the rest are written into buffer.
+    std::wstring_view FormatProcessColumn(const ProcessEntry &process, ProcessSortColumn column, wchar_t (&buffer)[kProcessColumnTextCapacity]);
+
+    // Calls visitor(descriptor) for every kProcessColumns entry, in order.
+    template <typename Visitor>
+    void ForEachProcessColumn(Visitor &&visitor)
+    {
+        std::apply([&visitor](const auto &...column)
+                   { (visitor(column), ...); },
+                   kProcessColumns);
+    }
+
+    // Resolves column once and calls visitor with it as a
+    // std::integral_constant, so the code inside is specialized for that
+    // column. Returns false for columns outside kProcessColumns.
+    template <typename Visitor>
+    bool VisitProcessColumn(ProcessSortColumn column, Visitor &&visitor)
+    {
+        return detail::VisitProcessColumn(column, visitor, std::make_index_sequence<kProcessColumnCount>{});
+    }
+}
@@ -0,0 +1,259 @@
+#include "process_order.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+    using rvrse::core::ProcessSortColumn;
+
+    constexpr int kRadixBits = 8;
+    constexpr std::size_t kRadixBuckets = std::size_t{1} << kRadixBits;
+    constexpr int kRadixPasses = 64 / kRadixBits;
+
+    // At most this share of the rows may be out of place for Repair() to
+    // beat a full sort.
+    constexpr std::size_t kRepairDivisor = 8;
+
+    // Non-negative doubles order like their bit patterns.
+    std::uint64_t CpuKey(double value)
+    {
+        std::uint64_t bits = 0;
+        value = value > 0.0 ? value : 0.0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    template <typename T>
+    void FillKeys(const std::vector<T> &column, const std::vector<std::uint32_t> &rows, std::uint64_t invert, std::vector<std::uint64_t> &keys)
+    {
+        for (const std::uint32_t row : rows)
+        {
+            keys[row] = static_cast<std::uint64_t>(column[row]) ^ invert;
+        }
+    }
+}
+
+namespace rvrse::core
+{
+    void ProcessOrder::Sort(const ProcessTable &table,
+                            const std::vector<double> &cpuPercent,
+                            const std::vector<std::uint32_t> &rows,
+                            ProcessSortColumn column,
+                            bool ascending,
+                            std::size_t limit)
+    {
+        const bool sameOrder = previousValid_ && column == column_ && ascending == ascending_;
+        column_ = column;
+        ascending_ = ascending;
+
+        // Descending inverts the keys, so every path sorts ascending.
+        const std::uint64_t invert = ascending ? 0 : ~std::uint64_t{0};
+        keys_.resize(table.Size());
+        switch (column)
+        {
+        case ProcessSortColumn::Name:
+            break;
+        case ProcessSortColumn::ProcessId:
+            FillKeys(table.ProcessIds(), rows, invert, keys_);
+            break;
+        case ProcessSortColumn::Threads:
+            FillKeys(table.ThreadCounts(), rows, invert, keys_);
+            break;
+        case ProcessSortColumn::WorkingSet:
+            FillKeys(table.WorkingSetBytes(), rows, invert, keys_);
+            break;
+        case ProcessSortColumn::PrivateBytes:
+            FillKeys(table.PrivateBytes(), rows, invert, keys_);
+            break;
+        case ProcessSortColumn::CpuPercent:
+            for (const std::uint32_t row : rows)
+            {
+                keys_[row] = CpuKey(cpuPercent[row]) ^ invert;
+            }
+            break;
+        }
+
+        const auto less = [this, &table](std::uint32_t lhs, std::uint32_t rhs)
+        { return Less(table, lhs, rhs); };
+
+        if (limit != 0 && limit < rows.size())
+        {
+            order_.assign(rows.begin(), rows.end());
+            std::partial_sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(limit), order_.end(), less);
+            previousValid_ = false;
+            strategy_ = ProcessOrderStrategy::Partial;
+            return;
+        }
+
+        if (sameOrder && Repair(table, rows))
+        {
+            strategy_ = ProcessOrderStrategy::Repaired;
+        }
+        else if (column == ProcessSortColumn::Name)
+        {
+            order_.assign(rows.begin(), rows.end());
+            std::sort(order_.begin(), order_.end(), less);
+            strategy_ = ProcessOrderStrategy::Comparison;
+        }
+        else
+        {
+            RadixSort(rows);
+            strategy_ = ProcessOrderStrategy::Radix;
+        }
+
+        previous_.assign(order_.begin(), order_.end());
+        previousProcessIds_.assign(table.ProcessIds().begin(), table.ProcessIds().end());
+        previousValid_ = true;
+    }
+
+    bool ProcessOrder::Less(const ProcessTable &table, std::uint32_t lhs, std::uint32_t rhs) const
+    {
+        // Rows are in PID order, so the row index is the PID tie-break.
+        if (column_ == ProcessSortColumn::Name)
+        {
+            const int result = table.Names().Name(lhs).compare(table.Names().Name(rhs));
+            if (result != 0)
+            {
+                return ascending_ ? result < 0 : result > 0;
+            }
+        }
+        else if (keys_[lhs] != keys_[rhs])
+        {
+            return keys_[lhs] < keys_[rhs];
+        }
+        return ascending_ ? lhs < rhs : lhs > rhs;
+    }
+
+    bool ProcessOrder::Repair(const ProcessTable &table, const std::vector<std::uint32_t> &rows)
+    {
+        constexpr std::uint32_t kGone = ~std::uint32_t{0};
+        const std::size_t budget = rows.size() / kRepairDivisor + 1;
+
+        // Both generations are sorted by PID, so one merge maps previous
+        // rows to current ones instead of a lookup per PID.
+        const std::vector<std::uint32_t> &processIds = table.ProcessIds();
+        remap_.assign(previousProcessIds_.size(), kGone);
+        std::size_t current = 0;
+        for (std::size_t row = 0; row < previousProcessIds_.size() && current < processIds.size(); ++row)
+        {
+            while (current < processIds.size() && processIds[current] < previousProcessIds_[row])
+            {
+                ++current;
+            }
+            if (current < processIds.size() && processIds[current] == previousProcessIds_[row])
+            {
+                remap_[row] = static_cast<std::uint32_t>(current);
+            }
+        }
+
+        // 1 = selected, 2 = placed by the replay.
+        state_.assign(table.Size(), 0);
+        for (const std::uint32_t row : rows)
+        {
+            state_[row] = 1;
+        }
+
+        // Replay the previous order. A row smaller than the last kept one
+        // broke the order; it and that last row are set aside, which keeps
+        // kept_ sorted whether the row rose or fell since.
+        kept_.clear();
+        moved_.clear();
+        for (const std::uint32_t previous : previous_)
+        {
+            const std::uint32_t row = remap_[previous];
+            if (row == kGone || state_[row] != 1)
+            {
+                continue;
+            }
+            state_[row] = 2;
+
+            if (kept_.empty() || !Less(table, row, kept_.back()))
+            {
+                kept_.push_back(row);
+                continue;
+            }
+            moved_.push_back(kept_.back());
+            kept_.pop_back();
+            moved_.push_back(row);
+            if (moved_.size() > budget)
+            {
+                return false;
+            }
+        }
+
+        // Processes that are new, or newly match the filter.
+        for (const std::uint32_t row : rows)
+        {
+            if (state_[row] == 1)
+            {
+                moved_.push_back(row);
+            }
+        }
+        if (moved_.size() > budget)
+        {
+            return false;
+        }
+
+        const auto less = [this, &table](std::uint32_t lhs, std::uint32_t rhs)
+        { return Less(table, lhs, rhs); };
+        std::sort(moved_.begin(), moved_.end(), less);
+        order_.resize(kept_.size() + moved_.size());
+        std::merge(kept_.begin(), kept_.end(), moved_.begin(), moved_.end(), order_.begin(), less);
+        return true;
+    }
+
+    void ProcessOrder::RadixSort(const std::vector<std::uint32_t> &rows)
+    {
+        // Rows arrive in PID order; descending ties go highest PID first,
+        // so start from the reverse. Every pass is stable.
+        if (ascending_)
+        {
+            order_.assign(rows.begin(), rows.end());
+        }
+        else
+        {
+            order_.assign(rows.rbegin(), rows.rend());
+        }
+        buffer_.resize(order_.size());
+
+        std::array<std::array<std::uint32_t, kRadixBuckets>, kRadixPasses> counts{};
+        for (const std::uint32_t row : order_)
+        {
+            const std::uint64_t key = keys_[row];
+            for (int pass = 0; pass < kRadixPasses; ++pass)
+            {
+                ++counts[pass][(key >> (pass * kRadixBits)) & (kRadixBuckets - 1)];
+            }
+        }
+
+        for (int pass = 0; pass < kRadixPasses; ++pass)
+        {
+            std::array<std::uint32_t, kRadixBuckets> &count = counts[pass];
+
+            // Skip digits every key shares, such as the high bytes of
+            // thread counts.
+            if (std::any_of(count.begin(), count.end(), [this](std::uint32_t bucket)
+                            { return bucket == order_.size(); }))
+            {
+                continue;
+            }
+
+            std::uint32_t offset = 0;
+            for (std::uint32_t &bucket : count)
+            {
+                const std::uint32_t size = bucket;
+                bucket = offset;
+                offset += size;
+            }
+
+            const int shift = pass * kRadixBits;
+            for (const std::uint32_t row : order_)
+            {
+                buffer_[count[(keys_[row] >> shift) & (kRadixBuckets - 1)]++] = row;
+            }
+            order_.swap(buffer_);
+        }
+    }
+}
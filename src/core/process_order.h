@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "process_columns.h"
+#include "process_query.h"
+
+namespace rvrse::core
+{
+    // How the last ProcessOrder::Sort() arrived at its order.
+    enum class ProcessOrderStrategy
+    {
+        // The previous generation's order, carried over by PID, needed at
+        // most a few rows moved: they were pulled out, sorted and merged
+        // back.
+        Repaired,
+        // A full LSD radix sort of the numeric keys.
+        Radix,
+        // A full comparison sort (names).
+        Comparison,
+        // Only the first `limit` rows were ordered.
+        Partial,
+    };
+
+    // Rows of a generation in list order, as indices into its ProcessTable.
+    // Every row's key is computed once per Sort() into an integer that
+    // orders like the column (CPU% through its IEEE bit pattern; names
+    // compare the table's folded copies), so the comparisons never dispatch
+    // on the column. Ties fall back to the PID, and descending is the exact
+    // reverse of ascending, as with CompareProcesses().
+    //
+    // Between generations most rows keep their place. When the column and
+    // direction did not change, the previous order is mapped onto the new
+    // generation by PID and replayed, and only the rows that broke it are
+    // sorted and merged back in. Larger changes, and new columns, take a
+    // full radix sort (or a comparison sort for names).
+    class ProcessOrder
+    {
+    public:
+        // Orders rows (ascending indices into table, such as a
+        // ProcessQuery selection). cpuPercent is index-aligned with table
+        // and only read for CpuPercent. A non-zero limit below the row
+        // count only guarantees the first limit positions, which is all a
+        // terminal screen shows; the rest follow in no particular order.
+        void Sort(const ProcessTable &table,
+                  const std::vector<double> &cpuPercent,
+                  const std::vector<std::uint32_t> &rows,
+                  ProcessSortColumn column,
+                  bool ascending,
+                  std::size_t limit = 0);
+
+        const std::vector<std::uint32_t> &Rows() const { return order_; }
+        ProcessOrderStrategy LastStrategy() const { return strategy_; }
+
+    private:
+        bool Less(const ProcessTable &table, std::uint32_t lhs, std::uint32_t rhs) const;
+        bool Repair(const ProcessTable &table, const std::vector<std::uint32_t> &rows);
+        void RadixSort(const std::vector<std::uint32_t> &rows);
+
+        ProcessSortColumn column_ = ProcessSortColumn::CpuPercent;
+        bool ascending_ = false;
+
+        // Index-aligned with the table; inverted when descending.
+        std::vector<std::uint64_t> keys_;
+        std::vector<std::uint32_t> order_;
+
+        // The last complete order and the PIDs of the table it indexed, for
+        // the next Repair().
+        std::vector<std::uint32_t> previous_;
+        std::vector<std::uint32_t> previousProcessIds_;
+        bool previousValid_ = false;
+
+        // Scratch, kept between calls so that sorting does not allocate.
+        std::vector<std::uint32_t> remap_;
+        std::vector<std::uint8_t> state_;
+        std::vector<std::uint32_t> kept_;
+        std::vector<std::uint32_t> moved_;
+        std::vector<std::uint32_t> buffer_;
+
+        ProcessOrderStrategy strategy_ = ProcessOrderStrategy::Comparison;
+    };
+}
@@ -0,0 +1,674 @@
+#include "process_query.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    using rvrse::core::FoldNameCase;
+    using rvrse::core::ProcessQueryField;
+
+    constexpr std::uint64_t kMaxValue = std::numeric_limits<std::uint64_t>::max();
+
+    // Below this share of the table, a name predicate tests the survivors
+    // one by one; above it, one NameMatcher scan is cheaper.
+    constexpr std::size_t kNameScanDivisor = 8;
+
+    struct FieldName
+    {
+        std::wstring_view name;
+        ProcessQueryField field;
+    };
+
+    constexpr FieldName kFieldNames[] = {
+        {L"name", ProcessQueryField::Name},
+        {L"pid", ProcessQueryField::ProcessId},
+        {L"parent", ProcessQueryField::ParentProcessId},
+        {L"ppid", ProcessQueryField::ParentProcessId},
+        {L"threads", ProcessQueryField::Threads},
+        {L"handles", ProcessQueryField::Handles},
+        {L"conn", ProcessQueryField::Connections},
+        {L"ws", ProcessQueryField::WorkingSet},
+        {L"private", ProcessQueryField::PrivateBytes},
+    };
+
+    enum class Operator
+    {
+        Colon,
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+    };
+
+    struct Term
+    {
+        std::wstring_view field;
+        Operator op = Operator::Colon;
+        std::wstring value;
+        bool hasField = false;
+    };
+
+    bool IsSpace(wchar_t ch)
+    {
+        return std::iswspace(static_cast<std::wint_t>(ch)) != 0;
+    }
+
+    bool IsDigit(wchar_t ch)
+    {
+        return ch >= L'0' && ch <= L'9';
+    }
+
+    bool IsFieldChar(wchar_t ch)
+    {
+        return (ch >= L'a' && ch <= L'z') || (ch >= L'A' && ch <= L'Z');
+    }
+
+    bool EqualsIgnoringCase(std::wstring_view lhs, std::wstring_view rhs)
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](wchar_t left, wchar_t right)
+                                                      { return FoldNameCase(left) == FoldNameCase(right); });
+    }
+
+    const FieldName *FindField(std::wstring_view name)
+    {
+        for (const FieldName &field : kFieldNames)
+        {
+            if (EqualsIgnoringCase(name, field.name))
+            {
+                return &field;
+            }
+        }
+        return nullptr;
+    }
+
+    bool IsSizeField(ProcessQueryField field)
+    {
+        return field == ProcessQueryField::WorkingSet || field == ProcessQueryField::PrivateBytes;
+    }
+
+    // Splits "field<op>" off the front of token; false if it has none.
+    bool SplitOperator(std::wstring_view token, std::wstring_view &field, Operator &op, std::wstring_view &rest)
+    {
+        std::size_t length = 0;
+        while (length < token.size() && IsFieldChar(token[length]))
+        {
+            ++length;
+        }
+        if (length == 0 || length == token.size())
+        {
+            return false;
+        }
+
+        const std::wstring_view tail = token.substr(length);
+        struct Spelling
+        {
+            std::wstring_view text;
+            Operator op;
+        };
+        // Two-character operators first, so ">=" is not read as ">".
+        static constexpr Spelling kSpellings[] = {
+            {L"!=", Operator::NotEqual},
+            {L">=", Operator::GreaterEqual},
+            {L"<=", Operator::LessEqual},
+            {L":", Operator::Colon},
+            {L"=", Operator::Equal},
+            {L">", Operator::Greater},
+            {L"<", Operator::Less},
+        };
+        for (const Spelling &spelling : kSpellings)
+        {
+            if (tail.substr(0, spelling.text.size()) == spelling.text)
+            {
+                field = token.substr(0, length);
+                op = spelling.op;
+                rest = tail.substr(spelling.text.size());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whitespace-separated terms; double quotes group spaces into a value
+    // and are dropped.
+    bool Tokenize(std::wstring_view text, std::vector<std::wstring> &tokens, std::wstring &error)
+    {
+        std::wstring token;
+        bool inToken = false;
+        bool quoted = false;
+        for (const wchar_t ch : text)
+        {
+            if (ch == L'"')
+            {
+                quoted = !quoted;
+                inToken = true;
+            }
+            else if (!quoted && IsSpace(ch))
+            {
+                if (inToken)
+                {
+                    tokens.push_back(std::move(token));
+                    token.clear();
+                    inToken = false;
+                }
+            }
+            else
+            {
+                token.push_back(ch);
+                inToken = true;
+            }
+        }
+        if (quoted)
+        {
+            error = L"missing closing quote";
+            return false;
+        }
+        if (inToken)
+        {
+            tokens.push_back(std::move(token));
+        }
+        return true;
+    }
+
+    // Digits with an optional fraction and unit for sizes ("1.5G", "500MB").
+    bool ParseValue(std::wstring_view text, bool size, std::uint64_t &value)
+    {
+        std::size_t position = 0;
+        std::uint64_t whole = 0;
+        while (position < text.size() && IsDigit(text[position]))
+        {
+            const auto digit = static_cast<std::uint64_t>(text[position] - L'0');
+            if (whole > (kMaxValue - digit) / 10)
+            {
+                return false;
+            }
+            whole = whole * 10 + digit;
+            ++position;
+        }
+        if (position == 0)
+        {
+            return false;
+        }
+        if (!size)
+        {
+            value = whole;
+            return position == text.size();
+        }
+
+        double fraction = 0.0;
+        if (position < text.size() && text[position] == L'.')
+        {
+            double scale = 0.1;
+            ++position;
+            const std::size_t firstDecimal = position;
+            while (position < text.size() && IsDigit(text[position]))
+            {
+                fraction += static_cast<double>(text[position] - L'0') * scale;
+                scale /= 10.0;
+                ++position;
+            }
+            if (position == firstDecimal)
+            {
+                return false;
+            }
+        }
+
+        std::wstring_view unit = text.substr(position);
+        if (!unit.empty() && (unit.back() == L'B' || unit.back() == L'b'))
+        {
+            unit.remove_suffix(1);
+        }
+        int shift = 0;
+        if (unit.size() > 1)
+        {
+            return false;
+        }
+        if (unit.size() == 1)
+        {
+            switch (FoldNameCase(unit.front()))
+            {
+            case L'k':
+                shift = 10;
+                break;
+            case L'm':
+                shift = 20;
+                break;
+            case L'g':
+                shift = 30;
+                break;
+            case L't':
+                shift = 40;
+                break;
+            default:
+                return false;
+            }
+        }
+
+        if (whole > (kMaxValue >> shift))
+        {
+            return false;
+        }
+        value = (whole << shift) + static_cast<std::uint64_t>(fraction * static_cast<double>(std::uint64_t{1} << shift));
+        return true;
+    }
+
+    template <typename T>
+    bool InRange(T value, std::uint64_t low, std::uint64_t span)
+    {
+        return static_cast<std::uint64_t>(value) - low <= span;
+    }
+
+    // The first predicate: every row in, the matching indices out. The
+    // store is unconditional and only the count depends on the test, so
+    // the loop has no branch to mispredict.
+    template <typename T>
+    void ScanRange(const std::vector<T> &column, std::uint64_t low, std::uint64_t high, bool exclude, std::vector<std::uint32_t> &selection)
+    {
+        const std::uint64_t span = high - low;
+        selection.resize(column.size());
+        std::uint32_t *out = selection.data();
+        std::size_t count = 0;
+        for (std::size_t index = 0; index < column.size(); ++index)
+        {
+            out[count] = static_cast<std::uint32_t>(index);
+            count += InRange(column[index], low, span) != exclude;
+        }
+        selection.resize(count);
+    }
+
+    // A later predicate: only the survivors are tested, compacted in place.
+    template <typename T>
+    void FilterRange(const std::vector<T> &column, std::uint64_t low, std::uint64_t high, bool exclude, std::vector<std::uint32_t> &selection)
+    {
+        const std::uint64_t span = high - low;
+        std::uint32_t *rows = selection.data();
+        std::size_t count = 0;
+        for (std::size_t index = 0; index < selection.size(); ++index)
+        {
+            const std::uint32_t row = rows[index];
+            rows[count] = row;
+            count += InRange(column[row], low, span) != exclude;
+        }
+        selection.resize(count);
+    }
+}
+
+namespace rvrse::core
+{
+    void ProcessTable::Assign(const std::vector<ProcessEntry> &processes)
+    {
+        const std::size_t count = processes.size();
+        names_.Assign(processes);
+        processIds_.resize(count);
+        parentProcessIds_.resize(count);
+        threadCounts_.resize(count);
+        workingSetBytes_.resize(count);
+        privateBytes_.resize(count);
+        handleCounts_.assign(count, 0);
+        connectionCounts_.assign(count, 0);
+
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            processIds_[index] = process.processId;
+            parentProcessIds_[index] = process.parentProcessId;
+            threadCounts_[index] = process.threadCount;
+            workingSetBytes_[index] = process.workingSetBytes;
+            privateBytes_[index] = process.privateBytes;
+        }
+    }
+
+    void ProcessTable::AssignHandles(const HandleSnapshot &handles)
+    {
+        handleCounts_.assign(Size(), 0);
+
+        // Handles come grouped by owner, so the lookup is mostly skipped.
+        std::uint32_t lastProcessId = 0;
+        std::size_t lastIndex = IndexOf(0);
+        for (const HandleEntry &handle : handles.Handles())
+        {
+            if (handle.processId != lastProcessId)
+            {
+                lastProcessId = handle.processId;
+                lastIndex = IndexOf(lastProcessId);
+            }
+            if (lastIndex < Size())
+            {
+                ++handleCounts_[lastIndex];
+            }
+        }
+    }
+
+    void ProcessTable::AssignConnections(const NetworkSnapshot &network)
+    {
+        connectionCounts_.assign(Size(), 0);
+
+        // Connections are sorted by owner, so each PID is looked up once.
+        std::uint32_t lastProcessId = 0;
+        std::size_t lastIndex = IndexOf(0);
+        for (const ConnectionEntry &connection : network.Connections())
+        {
+            if (connection.owningProcessId != lastProcessId)
+            {
+                lastProcessId = connection.owningProcessId;
+                lastIndex = IndexOf(lastProcessId);
+            }
+            if (lastIndex < Size())
+            {
+                ++connectionCounts_[lastIndex];
+            }
+        }
+    }
+
+    std::size_t ProcessTable::IndexOf(std::uint32_t processId) const
+    {
+        const auto found = std::lower_bound(processIds_.begin(), processIds_.end(), processId);
+        return found != processIds_.end() && *found == processId ? static_cast<std::size_t>(found - processIds_.begin()) : Size();
+    }
+
+    bool ProcessQuery::Compile(std::wstring_view text, ProcessQuery &query, std::wstring &error)
+    {
+        std::vector<std::wstring> tokens;
+        if (!Tokenize(text, tokens, error))
+        {
+            return false;
+        }
+
+        std::vector<Term> terms;
+        terms.reserve(tokens.size());
+        bool anyField = false;
+        for (const std::wstring &token : tokens)
+        {
+            Term term;
+            std::wstring_view rest;
+            if (SplitOperator(token, term.field, term.op, rest))
+            {
+                term.hasField = FindField(term.field) != nullptr;
+                anyField |= term.hasField;
+                if (term.hasField)
+                {
+                    term.value = rest;
+                }
+            }
+            if (!term.hasField)
+            {
+                term.value = token;
+            }
+            terms.push_back(std::move(term));
+        }
+
+        // No field anywhere: the whole text is a ProcessFilter, spaces and
+        // quotes included.
+        if (!anyField)
+        {
+            terms.clear();
+            std::wstring_view trimmed = text;
+            while (!trimmed.empty() && IsSpace(trimmed.front()))
+            {
+                trimmed.remove_prefix(1);
+            }
+            while (!trimmed.empty() && IsSpace(trimmed.back()))
+            {
+                trimmed.remove_suffix(1);
+            }
+            if (!trimmed.empty())
+            {
+                Term term;
+                term.value = trimmed;
+                terms.push_back(std::move(term));
+            }
+        }
+
+        ProcessQuery compiled;
+        for (std::size_t index = 0; index < terms.size(); ++index)
+        {
+            const Term &term = terms[index];
+            const std::wstring &token = anyField ? tokens[index] : term.value;
+
+            Predicate predicate;
+            if (!term.hasField)
+            {
+                if (anyField && !term.field.empty())
+                {
+                    error = L"unknown field '" + std::wstring(term.field) + L"' in '" + token + L"'";
+                    return false;
+                }
+
+                // Bare terms, as in the plain filter box.
+                if (std::all_of(term.value.begin(), term.value.end(), IsDigit) &&
+                    ParseValue(term.value, false, predicate.low))
+                {
+                    predicate.field = ProcessQueryField::ProcessId;
+                    predicate.high = predicate.low;
+                }
+                else
+                {
+                    FoldNameCase(term.value, predicate.needle);
+                }
+                compiled.predicates_.push_back(std::move(predicate));
+                continue;
+            }
+
+            predicate.field = FindField(term.field)->field;
+            if (term.value.empty())
+            {
+                error = L"missing value in '" + token + L"'";
+                return false;
+            }
+
+            if (predicate.field == ProcessQueryField::Name)
+            {
+                if (term.op != Operator::Colon && term.op != Operator::Equal)
+                {
+                    error = L"name takes ':' or '=' in '" + token + L"'";
+                    return false;
+                }
+                FoldNameCase(term.value, predicate.needle);
+                predicate.exact = term.op == Operator::Equal;
+                compiled.predicates_.push_back(std::move(predicate));
+                continue;
+            }
+
+            std::uint64_t value = 0;
+            if (!ParseValue(term.value, IsSizeField(predicate.field), value))
+            {
+                error = L"invalid number in '" + token + L"'";
+                return false;
+            }
+
+            predicate.low = 0;
+            predicate.high = kMaxValue;
+            switch (term.op)
+            {
+            case Operator::Colon:
+            case Operator::Equal:
+                predicate.low = predicate.high = value;
+                break;
+            case Operator::NotEqual:
+                predicate.low = predicate.high = value;
+                predicate.exclude = true;
+                break;
+            case Operator::Less:
+                if (value == 0)
+                {
+                    compiled.matchesNothing_ = true;
+                    continue;
+                }
+                predicate.high = value - 1;
+                break;
+            case Operator::LessEqual:
+                predicate.high = value;
+                break;
+            case Operator::Greater:
+                if (value == kMaxValue)
+                {
+                    compiled.matchesNothing_ = true;
+                    continue;
+                }
+                predicate.low = value + 1;
+                break;
+            case Operator::GreaterEqual:
+                predicate.low = value;
+                break;
+            }
+
+            // ws>500MB ws<2GB is one range test, not two passes.
+            const auto merge = std::find_if(compiled.predicates_.begin(), compiled.predicates_.end(), [&predicate](const Predicate &existing)
+                                            { return existing.field == predicate.field && !existing.exclude; });
+            if (!predicate.exclude && merge != compiled.predicates_.end())
+            {
+                merge->low = std::max(merge->low, predicate.low);
+                merge->high = std::min(merge->high, predicate.high);
+                compiled.matchesNothing_ |= merge->low > merge->high;
+                continue;
+            }
+            compiled.predicates_.push_back(std::move(predicate));
+        }
+
+        if (compiled.matchesNothing_)
+        {
+            compiled.predicates_.clear();
+        }
+        std::stable_sort(compiled.predicates_.begin(), compiled.predicates_.end(), [](const Predicate &lhs, const Predicate &rhs)
+                         { return Cost(lhs) < Cost(rhs); });
+        query = std::move(compiled);
+        return true;
+    }
+
+    int ProcessQuery::Cost(const Predicate &predicate)
+    {
+        switch (predicate.field)
+        {
+        case ProcessQueryField::Name:
+            return predicate.exact ? 3 : 4;
+        case ProcessQueryField::WorkingSet:
+        case ProcessQueryField::PrivateBytes:
+            return 2;
+        default:
+            // A single value (pid:1234) leaves almost nothing for the rest.
+            return predicate.low == predicate.high && !predicate.exclude ? 0 : 1;
+        }
+    }
+
+    bool ProcessQuery::Uses(ProcessQueryField field) const
+    {
+        return std::any_of(predicates_.begin(), predicates_.end(), [field](const Predicate &predicate)
+                           { return predicate.field == field; });
+    }
+
+    void ProcessQuery::Evaluate(const ProcessTable &table, std::vector<std::uint32_t> &selection) const
+    {
+        selection.clear();
+        if (matchesNothing_)
+        {
+            return;
+        }
+        if (predicates_.empty())
+        {
+            selection.resize(table.Size());
+            std::iota(selection.begin(), selection.end(), std::uint32_t{0});
+            return;
+        }
+
+        const NameMatcher &names = table.Names();
+        bool first = true;
+        for (const Predicate &predicate : predicates_)
+        {
+            if (!first && selection.empty())
+            {
+                return;
+            }
+
+            const auto range = [&](const auto &column)
+            {
+                if (first)
+                {
+                    ScanRange(column, predicate.low, predicate.high, predicate.exclude, selection);
+                }
+                else
+                {
+                    FilterRange(column, predicate.low, predicate.high, predicate.exclude, selection);
+                }
+            };
+
+            switch (predicate.field)
+            {
+            case ProcessQueryField::ProcessId:
+                range(table.ProcessIds());
+                break;
+            case ProcessQueryField::ParentProcessId:
+                range(table.ParentProcessIds());
+                break;
+            case ProcessQueryField::Threads:
+                range(table.ThreadCounts());
+                break;
+            case ProcessQueryField::Handles:
+                range(table.HandleCounts());
+                break;
+            case ProcessQueryField::Connections:
+                range(table.ConnectionCounts());
+                break;
+            case ProcessQueryField::WorkingSet:
+                range(table.WorkingSetBytes());
+                break;
+            case ProcessQueryField::PrivateBytes:
+                range(table.PrivateBytes());
+                break;
+            case ProcessQueryField::Name:
+            {
+                const std::wstring_view needle = predicate.needle;
+                const bool exact = predicate.exact;
+                const auto matches = [&](std::uint32_t row)
+                {
+                    const std::wstring_view name = names.Name(row);
+                    return exact ? name == needle : name.find(needle) != std::wstring_view::npos;
+                };
+
+                if (first && !exact)
+                {
+                    names.Find(needle, nameMatches_);
+                    for (std::size_t row = 0; row < nameMatches_.size(); ++row)
+                    {
+                        if (nameMatches_[row])
+                        {
+                            selection.push_back(static_cast<std::uint32_t>(row));
+                        }
+                    }
+                    break;
+                }
+                if (first)
+                {
+                    selection.resize(names.Size());
+                    std::iota(selection.begin(), selection.end(), std::uint32_t{0});
+                }
+
+                std::size_t count = 0;
+                if (!exact && selection.size() > names.Size() / kNameScanDivisor)
+                {
+                    names.Find(needle, nameMatches_);
+                    for (const std::uint32_t row : selection)
+                    {
+                        selection[count] = row;
+                        count += nameMatches_[row];
+                    }
+                }
+                else
+                {
+                    for (const std::uint32_t row : selection)
+                    {
+                        selection[count] = row;
+                        count += matches(row) ? 1 : 0;
+                    }
+                }
+                selection.resize(count);
+                break;
+            }
+            }
+            first = false;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "handle_snapshot.h"
+#include "name_matcher.h"
+#include "network_snapshot.h"
+#include "process_snapshot.h"
+
+namespace rvrse::core
+{
+    // One generation's processes as columns, index-aligned with the vector
+    // they were assigned from, so that a query predicate is a loop over one
+    // contiguous array instead of a walk over ProcessEntry objects and their
+    // strings. Assigning again reuses the buffers.
+    class ProcessTable
+    {
+    public:
+        // processes must be sorted by PID, as ProcessSnapshot keeps them.
+        // Handle and connection counts are zero until assigned.
+        void Assign(const std::vector<ProcessEntry> &processes);
+        void AssignHandles(const HandleSnapshot &handles);
+        void AssignConnections(const NetworkSnapshot &network);
+
+        std::size_t Size() const { return processIds_.size(); }
+
+        const NameMatcher &Names() const { return names_; }
+        const std::vector<std::uint32_t> &ProcessIds() const { return processIds_; }
+        const std::vector<std::uint32_t> &ParentProcessIds() const { return parentProcessIds_; }
+        const std::vector<std::uint32_t> &ThreadCounts() const { return threadCounts_; }
+        const std::vector<std::uint32_t> &HandleCounts() const { return handleCounts_; }
+        const std::vector<std::uint32_t> &ConnectionCounts() const { return connectionCounts_; }
+        const std::vector<std::uint64_t> &WorkingSetBytes() const { return workingSetBytes_; }
+        const std::vector<std::uint64_t> &PrivateBytes() const { return privateBytes_; }
+
+        // Index of processId, or Size() if it is not in this generation.
+        std::size_t IndexOf(std::uint32_t processId) const;
+
+    private:
+        NameMatcher names_;
+        std::vector<std::uint32_t> processIds_;
+        std::vector<std::uint32_t> parentProcessIds_;
+        std::vector<std::uint32_t> threadCounts_;
+        std::vector<std::uint32_t> handleCounts_;
+        std::vector<std::uint32_t> connectionCounts_;
+        std::vector<std::uint64_t> workingSetBytes_;
+        std::vector<std::uint64_t> privateBytes_;
+    };
+
+    enum class ProcessQueryField
+    {
+        Name,
+        ProcessId,
+        ParentProcessId,
+        Threads,
+        Handles,
+        Connections,
+        WorkingSet,
+        PrivateBytes,
+    };
+
+    // The process list filter box, compiled. Terms are separated by
+    // whitespace and all have to match:
+    //
+    //   name:chrome      image name contains "chrome" (case-insensitive)
+    //   name=chrome.exe  image name is exactly "chrome.exe"
+    //   pid:1234         also parent:, threads:, handles:, conn:, ws:, private:
+    //   ws>500MB         also >=, <, <=, = and !=; sizes take K, M, G or T
+    //                    (optionally followed by B), in powers of 1024
+    //
+    // ppid is another name for parent. Values with spaces go in double
+    // quotes. Text without any field term keeps the ProcessFilter meaning:
+    // digits only match that PID, anything else is a name substring, so the
+    // old filter box contents still select the same processes.
+    //
+    // Compiling folds the terms into one inclusive range per field and
+    // orders them by cost: integer columns before the name scan, exact PIDs
+    // first. Evaluation scans the first column into a selection of indices
+    // and every later predicate only tests the survivors, so a selective
+    // term makes the rest nearly free.
+    class ProcessQuery
+    {
+    public:
+        // Replaces query with the compiled text, or leaves it unchanged and
+        // fails with a message naming the offending term.
+        static bool Compile(std::wstring_view text, ProcessQuery &query, std::wstring &error);
+
+        bool Empty() const { return predicates_.empty() && !matchesNothing_; }
+        bool Uses(ProcessQueryField field) const;
+
+        // Indices into table of the matching processes, ascending. selection
+        // keeps its capacity, so repeated calls do not allocate.
+        void Evaluate(const ProcessTable &table, std::vector<std::uint32_t> &selection) const;
+
+    private:
+        struct Predicate
+        {
+            ProcessQueryField field = ProcessQueryField::Name;
+
+            // Integer fields: low <= value <= high, inverted by exclude.
+            std::uint64_t low = 0;
+            std::uint64_t high = 0;
+            bool exclude = false;
+
+            // Name: folded needle, matched as a substring or exactly.
+            std::wstring needle;
+            bool exact = false;
+        };
+
+        static int Cost(const Predicate &predicate);
+
+        std::vector<Predicate> predicates_;
+
+        // Contradictory ranges (ws>1G ws<1M) compile to a query that
+        // selects nothing without touching the table.
+        bool matchesNothing_ = false;
+
+        // Scratch for NameMatcher::Find() in Evaluate(); a query is owned by
+        // one view and not shared between threads.
+        mutable std::vector<std::uint8_t> nameMatches_;
+    };
+}
@@ -2,9 +2,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
+#if defined(_WIN32)
 #include <Windows.h>
 #include <winternl.h>
 #include <psapi.h>
@@ -72,23 +75,19 @@ namespace
         ULONG WaitReason;
     } SYSTEM_THREAD_INFORMATION_EX, *PSYSTEM_THREAD_INFORMATION_EX;
 
-    class NtBuffer
+    // Fills buffer with SystemProcessInformation, growing it as the kernel
+    // asks. The buffer is kept by the caller, so it only grows when the
+    // process list does.
+    bool QuerySystemProcessInformation(std::vector<std::byte> &buffer)
     {
-    public:
-        std::vector<std::byte> buffer;
-    };
-
-    NtBuffer QuerySystemProcessInformation()
-    {
-        NtBuffer ntBuffer;
-        ULONG bufferSize = 0x40000; // start with 256 KB
+        ULONG bufferSize = static_cast<ULONG>(std::max<std::size_t>(buffer.size(), 0x40000)); // at least 256 KB
 
         while (true)
         {
-            ntBuffer.buffer.resize(bufferSize);
+            buffer.resize(bufferSize);
             ULONG returnLength = 0;
             NTSTATUS status = NtQuerySystemInformation(SystemProcessInformation,
-                                                       ntBuffer.buffer.data(),
+                                                       buffer.data(),
                                                        bufferSize,
                                                        &returnLength);
 
@@ -98,31 +97,26 @@ namespace
                 continue;
             }
 
-            if (!NT_SUCCESS(status))
-            {
-                ntBuffer.buffer.clear();
-            }
-
-            break;
+            return NT_SUCCESS(status);
         }
-
-        return ntBuffer;
     }
 
-    std::wstring CaptureImageName(const UNICODE_STRING &imageName)
+    // Views into the capture buffer; interning copies them only the first
+    // time a name is seen.
+    std::wstring_view CaptureImageName(const UNICODE_STRING &imageName)
     {
         if (imageName.Length == 0 || imageName.Buffer == nullptr)
         {
             return L"System Idle Process";
         }
 
-        return std::wstring(imageName.Buffer, imageName.Length / sizeof(wchar_t));
+        return std::wstring_view(imageName.Buffer, imageName.Length / sizeof(wchar_t));
     }
 
-    std::wstring ExtractFileName(const std::wstring &path)
+    std::wstring_view ExtractFileName(std::wstring_view path)
     {
         auto position = path.find_last_of(L"\\/");
-        if (position == std::wstring::npos)
+        if (position == std::wstring_view::npos)
         {
             return path;
         }
@@ -183,11 +177,7 @@ namespace
 
             wchar_t pathBuffer[MAX_PATH];
             DWORD pathLength = GetModuleFileNameExW(process, moduleHandle, pathBuffer, static_cast<DWORD>(std::size(pathBuffer)));
-            std::wstring fullPath;
-            if (pathLength > 0)
-            {
-                fullPath.assign(pathBuffer, pathLength);
-            }
+            const std::wstring_view fullPath(pathBuffer, pathLength);
 
             rvrse::core::ModuleEntry entry{};
             entry.baseAddress = reinterpret_cast<std::uintptr_t>(moduleInfo.lpBaseOfDll);
@@ -212,24 +202,175 @@ namespace
         return modules;
     }
 }
+#endif
+
+namespace
+{
+    // Columns of a recycled generation keep their capacity; a quarter of
+    // headroom keeps a few new processes from reallocating them.
+    template <typename T>
+    void ResizeColumn(std::vector<T> &column, std::size_t count)
+    {
+        if (column.capacity() < count)
+        {
+            column.reserve(count + count / 4);
+        }
+        column.resize(count);
+    }
+
+    // Source of ProcessSnapshot::Sequence(). Process-wide rather than
+    // previous + 1, so a snapshot sealed against an empty one (a failed
+    // capture, a decoded wire frame) still never reuses a sequence.
+    std::atomic<std::uint64_t> g_lastSequence{0};
+}
 
 namespace rvrse::core
 {
-    ProcessSnapshot ProcessSnapshot::Capture()
+    std::uint64_t ProcessRowHash(const ProcessEntry &process)
     {
-        ProcessSnapshot snapshot;
-        NtBuffer buffer = QuerySystemProcessInformation();
+        // Eight bytes per multiply, as in StringInterner::Hash().
+        std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+        const auto mix = [&hash](std::uint64_t value)
+        {
+            hash = (hash ^ value) * 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 32;
+        };
+        mix((static_cast<std::uint64_t>(process.processId) << 32) | process.parentProcessId);
+        mix((static_cast<std::uint64_t>(process.imageName.Id()) << 32) | process.threadCount);
+        mix(process.workingSetBytes);
+        mix(process.privateBytes);
+        mix(process.kernelTime100ns);
+        mix(process.userTime100ns);
+        return hash ^ (hash >> 29);
+    }
 
-        if (buffer.buffer.empty())
+    void ProcessArrays::Assign(const std::vector<ProcessEntry> &processes)
+    {
+        const std::size_t count = processes.size();
+        ResizeColumn(processIds, count);
+        ResizeColumn(threadCounts, count);
+        ResizeColumn(workingSetBytes, count);
+        ResizeColumn(privateBytes, count);
+        ResizeColumn(kernelTime100ns, count);
+        ResizeColumn(userTime100ns, count);
+        ResizeColumn(rowHashes, count);
+
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            processIds[index] = process.processId;
+            threadCounts[index] = process.threadCount;
+            workingSetBytes[index] = process.workingSetBytes;
+            privateBytes[index] = process.privateBytes;
+            kernelTime100ns[index] = process.kernelTime100ns;
+            userTime100ns[index] = process.userTime100ns;
+            rowHashes[index] = ProcessRowHash(process);
+        }
+    }
+
+    ProcessSnapshot::ProcessSnapshot(std::vector<ProcessEntry> processes, const ProcessSnapshot &previous)
+        : generation_(Pool().Acquire())
+    {
+        generation_->processes = std::move(processes);
+        Seal(previous);
+    }
+
+    void ProcessSnapshot::Generation::Recycle()
+    {
+        // The thread lists point into the arena, so they go first.
+        processes.clear();
+        arena.Reset();
+    }
+
+    GenerationPool<ProcessSnapshot::Generation> &ProcessSnapshot::Pool()
+    {
+        // Never destroyed: a snapshot in a static may outlive any static pool.
+        static auto *pool = new GenerationPool<Generation>();
+        return *pool;
+    }
+
+    const ProcessSnapshot::Generation &ProcessSnapshot::Empty()
+    {
+        static const Generation empty;
+        return empty;
+    }
+
+    ProcessRef ProcessSnapshot::At(std::size_t index) const
+    {
+        return index < Processes().size() ? ProcessRef(*this, index) : ProcessRef();
+    }
+
+    ProcessRef ProcessSnapshot::Find(std::uint32_t processId) const
+    {
+        const std::vector<std::uint32_t> &ids = Arrays().processIds;
+        const auto it = std::lower_bound(ids.begin(), ids.end(), processId);
+        if (it == ids.end() || *it != processId)
+        {
+            return ProcessRef();
+        }
+        return ProcessRef(*this, static_cast<std::size_t>(it - ids.begin()));
+    }
+
+    std::size_t ProcessSnapshot::PooledGenerations()
+    {
+        return Pool().Size();
+    }
+
+    void ProcessSnapshot::Seal(const ProcessSnapshot &previous)
+    {
+        std::vector<ProcessEntry> &processes = generation_->processes;
+        std::sort(processes.begin(), processes.end(),
+                  [](const ProcessEntry &lhs, const ProcessEntry &rhs)
+                  {
+                      return lhs.processId < rhs.processId;
+                  });
+
+        ProcessArrays &arrays = generation_->arrays;
+        arrays.Assign(processes);
+
+        // Both sides are PID-sorted, so one pass pairs each row with its
+        // previous self; a row keeps its stamp only if it hashes the same.
+        const std::uint64_t sequence = g_lastSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+        generation_->sequence = sequence;
+        const ProcessArrays &before = previous.Arrays();
+        const std::size_t count = processes.size();
+        const std::size_t beforeCount = before.processIds.size();
+        ResizeColumn(arrays.changedSequences, count);
+        std::size_t match = 0;
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            const std::uint32_t processId = arrays.processIds[index];
+            while (match < beforeCount && before.processIds[match] < processId)
+            {
+                ++match;
+            }
+            const bool unchanged = match < beforeCount && before.processIds[match] == processId &&
+                                   before.rowHashes[match] == arrays.rowHashes[index];
+            arrays.changedSequences[index] = unchanged ? before.changedSequences[match] : sequence;
+        }
+    }
+
+#if defined(_WIN32)
+    ProcessSnapshot ProcessSnapshot::Capture(const ProcessCaptureOptions &options, const ProcessSnapshot &previous)
+    {
+        // Reused by every capture on this thread.
+        thread_local std::vector<std::byte> buffer;
+
+        ProcessSnapshot snapshot;
+        if (!QuerySystemProcessInformation(buffer))
         {
             return snapshot;
         }
 
-        auto *current = reinterpret_cast<SYSTEM_PROCESS_INFORMATION_EX *>(buffer.buffer.data());
+        snapshot.generation_ = Pool().Acquire();
+        std::vector<ProcessEntry> &processes = snapshot.generation_->processes;
+        std::pmr::memory_resource *arena = snapshot.generation_->arena.Resource();
+
+        auto *current = reinterpret_cast<SYSTEM_PROCESS_INFORMATION_EX *>(buffer.data());
 
         while (true)
         {
-            ProcessEntry entry{};
+            ProcessEntry entry(arena);
             entry.processId = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(current->UniqueProcessId));
             entry.parentProcessId = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(current->InheritedFromUniqueProcessId));
             entry.threadCount = current->NumberOfThreads;
@@ -240,7 +381,9 @@ namespace rvrse::core
             entry.userTime100ns = static_cast<std::uint64_t>(current->UserTime.QuadPart);
 
             auto *threads = reinterpret_cast<SYSTEM_THREAD_INFORMATION_EX *>(current + 1);
-            for (ULONG threadIndex = 0; threadIndex < current->NumberOfThreads; ++threadIndex)
+            const ULONG threadEntries = options.threads ? current->NumberOfThreads : 0;
+            entry.threads.reserve(threadEntries);
+            for (ULONG threadIndex = 0; threadIndex < threadEntries; ++threadIndex)
             {
                 const auto &nativeThread = threads[threadIndex];
                 ThreadEntry threadEntry{};
@@ -251,10 +394,15 @@ namespace rvrse::core
                 threadEntry.waitReason = nativeThread.WaitReason;
                 threadEntry.kernelTime100ns = static_cast<std::uint64_t>(nativeThread.KernelTime.QuadPart);
                 threadEntry.userTime100ns = static_cast<std::uint64_t>(nativeThread.UserTime.QuadPart);
-                entry.threads.push_back(std::move(threadEntry));
+                entry.threads.push_back(threadEntry);
             }
 
-            snapshot.processes_.push_back(std::move(entry));
+            // A recycled generation keeps its capacity; grow it with headroom.
+            if (processes.size() == processes.capacity())
+            {
+                processes.reserve(processes.size() + processes.size() / 4 + 64);
+            }
+            processes.push_back(std::move(entry));
 
             if (current->NextEntryOffset == 0)
             {
@@ -265,12 +413,7 @@ namespace rvrse::core
                 reinterpret_cast<std::byte *>(current) + current->NextEntryOffset);
         }
 
-        std::sort(snapshot.processes_.begin(), snapshot.processes_.end(),
-                  [](const ProcessEntry &lhs, const ProcessEntry &rhs)
-                  {
-                      return lhs.processId < rhs.processId;
-                  });
-
+        snapshot.Seal(previous);
         return snapshot;
     }
 
@@ -278,11 +421,12 @@ namespace rvrse::core
     {
         return EnumerateModulesInternal(processId);
     }
+#endif
 
     std::vector<std::uint32_t> ProcessSnapshot::GetChildProcesses(std::uint32_t parentProcessId) const
     {
         std::vector<std::uint32_t> children;
-        for (const auto &process : processes_)
+        for (const auto &process : Processes())
         {
             if (process.parentProcessId == parentProcessId)
             {
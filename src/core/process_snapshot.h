@@ -1,15 +1,24 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "snapshot_arena.h"
+#include "string_interner.h"
+
 namespace rvrse::core
 {
+    // Names and paths are interned: the same DLL loaded by hundreds of
+    // processes, or the same image captured every refresh, is one stored
+    // string.
     struct ModuleEntry
     {
-        std::wstring name;
-        std::wstring path;
+        InternedString name;
+        InternedString path;
         std::uintptr_t baseAddress = 0;
         std::uint32_t sizeBytes = 0;
     };
@@ -27,7 +36,10 @@ namespace rvrse::core
 
     struct ProcessEntry
     {
-        std::wstring imageName;
+        ProcessEntry() = default;
+        explicit ProcessEntry(std::pmr::memory_resource *resource) : threads(resource) {}
+
+        InternedString imageName;
         std::uint32_t processId = 0;
         std::uint32_t parentProcessId = 0;
         std::uint32_t threadCount = 0;
@@ -35,24 +47,137 @@ namespace rvrse::core
         std::uint64_t privateBytes = 0;
         std::uint64_t kernelTime100ns = 0;
         std::uint64_t userTime100ns = 0;
-        std::vector<ThreadEntry> threads;
+
+        // A captured entry's threads live in its generation's SnapshotArena;
+        // a copy allocates from the default resource, so it may outlive the
+        // snapshot it came from.
+        std::pmr::vector<ThreadEntry> threads;
     };
 
+    // Hash of everything a process row shows or derives from (name, PIDs,
+    // thread count, memory, CPU times; not the thread list), so equal hashes
+    // mean a row can be left as it was drawn or sent.
+    std::uint64_t ProcessRowHash(const ProcessEntry &process);
+
+    // The numeric fields of a snapshot's processes as contiguous arrays,
+    // index-aligned with Processes(), for totals and rankings that would
+    // otherwise stride over whole ProcessEntry objects (see
+    // column_reduce.h).
+    struct ProcessArrays
+    {
+        std::vector<std::uint32_t> processIds;
+        std::vector<std::uint32_t> threadCounts;
+        std::vector<std::uint64_t> workingSetBytes;
+        std::vector<std::uint64_t> privateBytes;
+        std::vector<std::uint64_t> kernelTime100ns;
+        std::vector<std::uint64_t> userTime100ns;
+
+        // ProcessRowHash() of each row, and the ProcessSnapshot::Sequence()
+        // at which the row last hashed differently (or appeared).
+        std::vector<std::uint64_t> rowHashes;
+        std::vector<std::uint64_t> changedSequences;
+
+        // Fills every column but changedSequences, which ProcessSnapshot
+        // derives from the previous snapshot.
+        void Assign(const std::vector<ProcessEntry> &processes);
+    };
+
+    struct ProcessCaptureOptions
+    {
+        // Per-thread entries; threadCount is filled either way. On Linux
+        // every thread is a /proc read, which dominates the capture.
+        bool threads = true;
+    };
+
+    class ProcessRef;
+
+    // An immutable, PID-sorted capture. The entries, their columns and their
+    // thread lists belong to a generation from a process-wide
+    // GenerationPool: copies of a snapshot share it, and when the last one
+    // goes the generation is recycled with its capacity intact, so a steady
+    // capture loop reuses the same memory instead of reallocating it.
     class ProcessSnapshot
     {
     public:
         ProcessSnapshot() = default;
 
-        static ProcessSnapshot Capture();
+        // Builds a snapshot from pre-collected entries (synthetic data, replays);
+        // entries are sorted by PID like Capture() output.
+        explicit ProcessSnapshot(std::vector<ProcessEntry> processes, const ProcessSnapshot &previous = {});
+
+        // previous is the snapshot this one replaces: the row change stamps
+        // come from a merge join against it by PID. Without one, every row
+        // counts as changed.
+        static ProcessSnapshot Capture(const ProcessCaptureOptions &options = {}, const ProcessSnapshot &previous = {});
         static std::vector<ModuleEntry> EnumerateModules(std::uint32_t processId);
 
-        const std::vector<ProcessEntry> &Processes() const { return processes_; }
+        const std::vector<ProcessEntry> &Processes() const { return generation_ ? generation_->processes : Empty().processes; }
+        const ProcessArrays &Arrays() const { return generation_ ? generation_->arrays : Empty().arrays; }
+
+        // Increases with every snapshot built in this process, whatever it
+        // was sealed against; 0 for a default-constructed one. A consumer
+        // that drew or sent sequence n can skip the rows with
+        // Arrays().changedSequences[i] <= n. The in-tree consumers keep
+        // per-row state anyway and compare Arrays().rowHashes instead.
+        std::uint64_t Sequence() const { return generation_ ? generation_->sequence : 0; }
+        bool RowChangedSince(std::size_t index, std::uint64_t sequence) const { return Arrays().changedSequences[index] > sequence; }
+
+        // A handle on one process that shares this snapshot's generation;
+        // Find() is a binary search, and both are empty when nothing matches.
+        ProcessRef At(std::size_t index) const;
+        ProcessRef Find(std::uint32_t processId) const;
+
+        // Generations created so far, counting those snapshots still hold.
+        static std::size_t PooledGenerations();
 
         // Process tree enumeration
         std::vector<std::uint32_t> GetChildProcesses(std::uint32_t parentProcessId) const;
         void CollectChildProcesses(std::uint32_t processId, std::vector<std::uint32_t> &childProcesses) const;
 
     private:
-        std::vector<ProcessEntry> processes_;
+        struct Generation
+        {
+            SnapshotArena arena;
+            std::vector<ProcessEntry> processes;
+            ProcessArrays arrays;
+            std::uint64_t sequence = 0;
+            std::atomic<std::uint32_t> references{0};
+
+            void Recycle();
+        };
+        using GenerationLease = GenerationPool<Generation>::Lease;
+
+        static GenerationPool<Generation> &Pool();
+        static const Generation &Empty();
+
+        // Orders the entries by PID, fills the columns and stamps the rows
+        // that changed since previous.
+        void Seal(const ProcessSnapshot &previous);
+
+        GenerationLease generation_;
+    };
+
+    // One process of a ProcessSnapshot. Holding it keeps the generation
+    // alive, so a viewer can keep a process open across refreshes for the
+    // cost of a refcount rather than a copy of the entry and its threads.
+    class ProcessRef
+    {
+    public:
+        ProcessRef() = default;
+
+        const ProcessEntry &operator*() const { return snapshot_.Processes()[index_]; }
+        const ProcessEntry *operator->() const { return &snapshot_.Processes()[index_]; }
+        explicit operator bool() const { return index_ < snapshot_.Processes().size(); }
+
+        // Position in Snapshot().Processes() and Snapshot().Arrays().
+        std::size_t Index() const { return index_; }
+        const ProcessSnapshot &Snapshot() const { return snapshot_; }
+
+    private:
+        friend class ProcessSnapshot;
+        ProcessRef(ProcessSnapshot snapshot, std::size_t index) : snapshot_(std::move(snapshot)), index_(index) {}
+
+        ProcessSnapshot snapshot_;
+        std::size_t index_ = 0;
     };
 }
@@ -0,0 +1,249 @@
+// Linux capture backend for ProcessSnapshot, built from /proc. The portable
+// parts of ProcessSnapshot live in process_snapshot.cpp.
+
+#include "process_snapshot.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "procfs.h"
+
+namespace
+{
+    // ThreadEntry::state/waitReason carry the Windows KTHREAD_STATE and
+    // KWAIT_REASON values everywhere else; map /proc states onto them.
+    constexpr std::uint32_t kThreadStateRunning = 2;
+    constexpr std::uint32_t kThreadStateTerminated = 4;
+    constexpr std::uint32_t kThreadStateWaiting = 5;
+
+    constexpr std::uint32_t kWaitReasonExecutive = 0;
+    constexpr std::uint32_t kWaitReasonSuspended = 5;
+    constexpr std::uint32_t kWaitReasonUserRequest = 6;
+
+    void MapThreadState(char state, rvrse::core::ThreadEntry &thread)
+    {
+        switch (state)
+        {
+        case 'R':
+            thread.state = kThreadStateRunning;
+            break;
+        case 'Z':
+        case 'X':
+            thread.state = kThreadStateTerminated;
+            break;
+        case 'D':
+            thread.state = kThreadStateWaiting;
+            thread.waitReason = kWaitReasonExecutive;
+            break;
+        case 'T':
+        case 't':
+            thread.state = kThreadStateWaiting;
+            thread.waitReason = kWaitReasonSuspended;
+            break;
+        default:
+            thread.state = kThreadStateWaiting;
+            thread.waitReason = kWaitReasonUserRequest;
+            break;
+        }
+    }
+
+    // /proc/<pid>/statm field 6 ("data") counts private writable pages,
+    // the closest match for Windows' private commit.
+    std::uint64_t ReadPrivateBytes(const char *path, std::string &buffer)
+    {
+        if (!rvrse::core::procfs::ReadFile(path, buffer))
+        {
+            return 0;
+        }
+
+        std::string_view text(buffer);
+        std::uint64_t dataPages = 0;
+        if (!rvrse::core::procfs::SkipTokens(text, 5) || !rvrse::core::procfs::ParseUnsigned(text, dataPages))
+        {
+            return 0;
+        }
+        return dataPages * rvrse::core::procfs::PageSize();
+    }
+
+    // Buffers reused by every capture on a thread, so that once they have
+    // grown to fit, reading /proc allocates nothing.
+    struct CaptureScratch
+    {
+        std::string buffer;
+        std::string statmBuffer;
+        std::vector<std::uint32_t> processIds;
+        std::vector<std::uint32_t> threadIds;
+    };
+
+    void CaptureThreads(std::uint32_t processId, rvrse::core::ProcessEntry &entry, CaptureScratch &scratch)
+    {
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/%u/task", processId);
+
+        std::string &buffer = scratch.buffer;
+        rvrse::core::procfs::ListNumericEntries(path, scratch.threadIds);
+        for (std::uint32_t threadId : scratch.threadIds)
+        {
+            std::snprintf(path, sizeof(path), "/proc/%u/task/%u/stat", processId, threadId);
+            rvrse::core::procfs::StatFields fields;
+            if (!rvrse::core::procfs::ReadFile(path, buffer) || !rvrse::core::procfs::ParseStat(buffer, fields))
+            {
+                continue;
+            }
+
+            rvrse::core::ThreadEntry thread{};
+            thread.threadId = threadId;
+            thread.owningProcessId = processId;
+            thread.priority = static_cast<std::int32_t>(fields.priority);
+            thread.kernelTime100ns = rvrse::core::procfs::ClockTicksTo100ns(fields.kernelTicks);
+            thread.userTime100ns = rvrse::core::procfs::ClockTicksTo100ns(fields.userTicks);
+            MapThreadState(fields.state, thread);
+            entry.threads.push_back(thread);
+        }
+    }
+}
+
+namespace rvrse::core
+{
+    ProcessSnapshot ProcessSnapshot::Capture(const ProcessCaptureOptions &options, const ProcessSnapshot &previous)
+    {
+        thread_local CaptureScratch scratch;
+        char path[64];
+
+        ProcessSnapshot snapshot;
+        snapshot.generation_ = Pool().Acquire();
+        std::vector<ProcessEntry> &processes = snapshot.generation_->processes;
+        std::pmr::memory_resource *arena = snapshot.generation_->arena.Resource();
+
+        procfs::ListNumericEntries("/proc", scratch.processIds);
+        // A recycled generation keeps its capacity; grow it with headroom.
+        if (processes.capacity() < scratch.processIds.size())
+        {
+            processes.reserve(scratch.processIds.size() + scratch.processIds.size() / 4);
+        }
+
+        for (std::uint32_t processId : scratch.processIds)
+        {
+            std::snprintf(path, sizeof(path), "/proc/%u/stat", processId);
+            procfs::StatFields fields;
+
+            // Processes exit between the directory scan and the read; skip them.
+            if (!procfs::ReadFile(path, scratch.buffer) || !procfs::ParseStat(scratch.buffer, fields))
+            {
+                continue;
+            }
+
+            ProcessEntry entry(arena);
+            entry.processId = processId;
+            entry.parentProcessId = static_cast<std::uint32_t>(fields.parentProcessId);
+            // comm is cut at 15 bytes, possibly mid-sequence; the interner
+            // turns what is left of a broken sequence into U+FFFD.
+            entry.imageName = InternedString::FromUtf8(fields.name);
+            entry.threadCount = static_cast<std::uint32_t>(fields.threadCount);
+            entry.workingSetBytes = fields.residentPages * procfs::PageSize();
+            entry.kernelTime100ns = procfs::ClockTicksTo100ns(fields.kernelTicks);
+            entry.userTime100ns = procfs::ClockTicksTo100ns(fields.userTicks);
+
+            std::snprintf(path, sizeof(path), "/proc/%u/statm", processId);
+            entry.privateBytes = ReadPrivateBytes(path, scratch.statmBuffer);
+
+            if (options.threads)
+            {
+                entry.threads.reserve(entry.threadCount);
+                CaptureThreads(processId, entry, scratch);
+            }
+            processes.push_back(std::move(entry));
+        }
+
+        snapshot.Seal(previous);
+        return snapshot;
+    }
+
+    std::vector<ModuleEntry> ProcessSnapshot::EnumerateModules(std::uint32_t processId)
+    {
+        std::vector<ModuleEntry> modules;
+        if (processId == 0)
+        {
+            return modules;
+        }
+
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/%u/maps", processId);
+        std::string contents;
+        if (!procfs::ReadFile(path, contents))
+        {
+            return modules;
+        }
+
+        // Each file-backed image is mapped as several segments; fold them
+        // into one module spanning the lowest to the highest address.
+        std::map<std::string_view, std::pair<std::uint64_t, std::uint64_t>> ranges;
+        std::string_view text(contents);
+        while (!text.empty())
+        {
+            const std::size_t lineEnd = text.find('\n');
+            std::string_view line = text.substr(0, lineEnd);
+            text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+            // start-end perms offset dev inode pathname
+            const std::string_view range = procfs::NextToken(line);
+            if (!procfs::SkipTokens(line, 3))
+            {
+                continue;
+            }
+            std::uint64_t inode = 0;
+            if (!procfs::ParseUnsigned(line, inode) || inode == 0)
+            {
+                continue;
+            }
+
+            const std::size_t pathStart = line.find('/');
+            const std::size_t dash = range.find('-');
+            std::uint64_t start = 0;
+            std::uint64_t end = 0;
+            if (pathStart == std::string_view::npos || dash == std::string_view::npos ||
+                !procfs::ParseToken(range.substr(0, dash), start, 16) ||
+                !procfs::ParseToken(range.substr(dash + 1), end, 16))
+            {
+                continue;
+            }
+
+            auto [it, inserted] = ranges.try_emplace(line.substr(pathStart), start, end);
+            if (!inserted)
+            {
+                it->second.first = std::min(it->second.first, start);
+                it->second.second = std::max(it->second.second, end);
+            }
+        }
+
+        modules.reserve(ranges.size());
+        for (const auto &[modulePath, range] : ranges)
+        {
+            ModuleEntry entry{};
+            entry.path = InternedString::FromUtf8(modulePath);
+            entry.name = InternedString::FromUtf8(modulePath.substr(modulePath.find_last_of('/') + 1));
+            entry.baseAddress = static_cast<std::uintptr_t>(range.first);
+            entry.sizeBytes = static_cast<std::uint32_t>(std::min<std::uint64_t>(range.second - range.first,
+                                                                                  std::numeric_limits<std::uint32_t>::max()));
+            modules.push_back(std::move(entry));
+        }
+
+        std::sort(modules.begin(), modules.end(),
+                  [](const ModuleEntry &lhs, const ModuleEntry &rhs)
+                  {
+                      return lhs.baseAddress < rhs.baseAddress;
+                  });
+
+        return modules;
+    }
+}
+
+#endif
@@ -0,0 +1,267 @@
+#include "process_view.h"
+
+#include <algorithm>
+#include <array>
+#include <cwchar>
+#include <cwctype>
+
+namespace
+{
+    using rvrse::core::FoldNameCase;
+    using rvrse::core::ProcessEntry;
+    using rvrse::core::ProcessSortColumn;
+
+    using ProcessComparer = int (*)(const ProcessEntry &, const ProcessEntry &);
+
+    template <std::size_t... Index>
+    constexpr std::array<ProcessComparer, sizeof...(Index)> MakeComparers(std::index_sequence<Index...>)
+    {
+        return {&rvrse::core::CompareProcessColumn<static_cast<ProcessSortColumn>(Index)>...};
+    }
+
+    constexpr auto kComparers = MakeComparers(std::make_index_sequence<rvrse::core::kProcessColumnCount>{});
+
+    // Case-insensitive substring search without lower-casing a copy of the
+    // haystack; needle is already folded. NameMatcher does the same for a
+    // whole generation at once.
+    bool ContainsFolded(std::wstring_view haystack, const std::wstring &needle)
+    {
+        if (needle.size() > haystack.size())
+        {
+            return false;
+        }
+
+        const std::size_t last = haystack.size() - needle.size();
+        for (std::size_t start = 0; start <= last; ++start)
+        {
+            std::size_t matched = 0;
+            while (matched < needle.size() && FoldNameCase(haystack[start + matched]) == needle[matched])
+            {
+                ++matched;
+            }
+            if (matched == needle.size())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+namespace rvrse::core
+{
+    ProcessFilter::ProcessFilter(std::wstring_view text)
+    {
+        const auto isSpace = [](wchar_t ch)
+        { return std::iswspace(ch) != 0; };
+        while (!text.empty() && isSpace(text.front()))
+        {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && isSpace(text.back()))
+        {
+            text.remove_suffix(1);
+        }
+        if (text.empty())
+        {
+            return;
+        }
+
+        byProcessId_ = std::all_of(text.begin(), text.end(), [](wchar_t ch)
+                                   { return std::iswdigit(ch) != 0; });
+        if (byProcessId_)
+        {
+            const std::wstring digits(text);
+            processId_ = static_cast<std::uint32_t>(std::wcstoul(digits.c_str(), nullptr, 10));
+            return;
+        }
+
+        FoldNameCase(text, needle_);
+    }
+
+    bool ProcessFilter::Matches(const ProcessEntry &process) const
+    {
+        return Matches(process.processId, process.imageName);
+    }
+
+    bool ProcessFilter::Matches(std::uint32_t processId, std::wstring_view imageName) const
+    {
+        if (byProcessId_)
+        {
+            return processId == processId_;
+        }
+        return needle_.empty() || ContainsFolded(imageName, needle_);
+    }
+
+    void ProcessFilter::Apply(const std::vector<ProcessEntry> &processes, const NameMatcher &names, std::vector<std::uint8_t> &matches) const
+    {
+        if (!byProcessId_)
+        {
+            names.Find(needle_, matches);
+            return;
+        }
+
+        matches.assign(processes.size(), 0);
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            matches[index] = processes[index].processId == processId_ ? 1 : 0;
+        }
+    }
+
+    int CompareProcesses(const ProcessEntry &lhs, const ProcessEntry &rhs, ProcessSortColumn column)
+    {
+        // CpuPercent is not a kProcessColumns entry; it orders by PID here.
+        const auto index = static_cast<std::size_t>(column);
+        return kComparers[index < kComparers.size() ? index : static_cast<std::size_t>(ProcessSortColumn::ProcessId)](lhs, rhs);
+    }
+
+    void SortProcesses(std::vector<ProcessEntry> &processes, ProcessSortColumn column, bool ascending)
+    {
+        // The column and direction are resolved once, outside std::sort, so
+        // each comparison is the column's own specialized code.
+        const auto sort = [&processes, ascending](auto id)
+        {
+            if (ascending)
+            {
+                std::sort(processes.begin(), processes.end(), ProcessColumnLess<decltype(id)::value, true>{});
+            }
+            else
+            {
+                std::sort(processes.begin(), processes.end(), ProcessColumnLess<decltype(id)::value, false>{});
+            }
+        };
+        if (!VisitProcessColumn(column, sort))
+        {
+            sort(std::integral_constant<ProcessSortColumn, ProcessSortColumn::ProcessId>{});
+        }
+    }
+
+    void ProcessView::Update(const std::vector<ProcessEntry> &processes,
+                             std::chrono::steady_clock::time_point timestamp,
+                             const HandleSnapshot *handles,
+                             const NetworkSnapshot *network)
+    {
+        // A vector from elsewhere lets go of the snapshot shared before.
+        if (&processes != &snapshot_.Processes())
+        {
+            snapshot_ = ProcessSnapshot();
+        }
+        processes_ = &processes;
+        if (&processes == &snapshot_.Processes())
+        {
+            rowHashes_ = &snapshot_.Arrays().rowHashes;
+        }
+        else
+        {
+            ownRowHashes_.resize(processes.size());
+            for (std::size_t index = 0; index < processes.size(); ++index)
+            {
+                ownRowHashes_[index] = ProcessRowHash(processes[index]);
+            }
+            rowHashes_ = &ownRowHashes_;
+        }
+
+        const double elapsed100ns =
+            hasCpuBaseline_ ? static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp - previousTimestamp_).count()) / 100.0 : 0.0;
+
+        cpuPercent_.assign(processes.size(), 0.0);
+        currentCpuTimes_.clear();
+        currentCpuTimes_.reserve(processes.size());
+
+        auto previous = previousCpuTimes_.cbegin();
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            const std::uint64_t cpuTime = process.kernelTime100ns + process.userTime100ns;
+            currentCpuTimes_.emplace_back(process.processId, cpuTime);
+
+            while (previous != previousCpuTimes_.cend() && previous->first < process.processId)
+            {
+                ++previous;
+            }
+
+            if (elapsed100ns > 0.0 && previous != previousCpuTimes_.cend() && previous->first == process.processId &&
+                cpuTime >= previous->second)
+            {
+                cpuPercent_[index] = static_cast<double>(cpuTime - previous->second) / elapsed100ns * 100.0;
+            }
+        }
+
+        previousCpuTimes_.swap(currentCpuTimes_);
+        previousTimestamp_ = timestamp;
+        hasCpuBaseline_ = true;
+        table_.Assign(processes);
+        if (handles)
+        {
+            table_.AssignHandles(*handles);
+        }
+        if (network)
+        {
+            table_.AssignConnections(*network);
+        }
+
+        Rebuild();
+    }
+
+    void ProcessView::Update(const ProcessSnapshot &snapshot,
+                             std::chrono::steady_clock::time_point timestamp,
+                             const HandleSnapshot *handles,
+                             const NetworkSnapshot *network)
+    {
+        snapshot_ = snapshot;
+        Update(snapshot_.Processes(), timestamp, handles, network);
+    }
+
+    ProcessRef ProcessView::Ref(std::size_t row) const
+    {
+        if (row >= rows_.size() || processes_ != &snapshot_.Processes())
+        {
+            return ProcessRef();
+        }
+        return snapshot_.At(static_cast<std::size_t>(rows_[row].process - processes_->data()));
+    }
+
+    bool ProcessView::SetFilter(std::wstring_view text, std::wstring &error)
+    {
+        if (!ProcessQuery::Compile(text, query_, error))
+        {
+            return false;
+        }
+        Rebuild();
+        return true;
+    }
+
+    void ProcessView::SetSort(ProcessSortColumn column, bool ascending)
+    {
+        column_ = column;
+        ascending_ = ascending;
+        Rebuild();
+    }
+
+    void ProcessView::SetSortLimit(std::size_t rows)
+    {
+        if (rows != sortLimit_)
+        {
+            sortLimit_ = rows;
+            Rebuild();
+        }
+    }
+
+    void ProcessView::Rebuild()
+    {
+        rows_.clear();
+        if (!processes_)
+        {
+            return;
+        }
+
+        const std::vector<ProcessEntry> &processes = *processes_;
+        query_.Evaluate(table_, selection_);
+        order_.Sort(table_, cpuPercent_, selection_, column_, ascending_, sortLimit_);
+        rows_.reserve(selection_.size());
+        for (const std::uint32_t index : order_.Rows())
+        {
+            rows_.push_back(ProcessRow{&processes[index], cpuPercent_[index], (*rowHashes_)[index]});
+        }
+    }
+}
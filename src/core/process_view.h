@@ -0,0 +1,143 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "name_matcher.h"
+#include "process_order.h"
+#include "process_query.h"
+#include "process_snapshot.h"
+
+namespace rvrse::core
+{
+    // The process list filter box: blank matches everything, digits only
+    // match that PID exactly, anything else is a case-insensitive substring
+    // of the image name. Surrounding whitespace is ignored.
+    class ProcessFilter
+    {
+    public:
+        ProcessFilter() = default;
+        explicit ProcessFilter(std::wstring_view text);
+
+        bool Empty() const { return !byProcessId_ && needle_.empty(); }
+        bool Matches(const ProcessEntry &process) const;
+        bool Matches(std::uint32_t processId, std::wstring_view imageName) const;
+
+        // Set when the filter names a single PID, which then needs no image
+        // name to decide (recorded history only stores names now and then).
+        bool ByProcessId() const { return byProcessId_; }
+        std::uint32_t ProcessId() const { return processId_; }
+
+        // The name substring, folded with FoldNameCase(); empty for a PID
+        // or blank filter.
+        const std::wstring &Needle() const { return needle_; }
+
+        // Matches() over a whole generation: matches[i] is set for
+        // processes[i]. Name filters go through names, which must have been
+        // assigned the same processes.
+        void Apply(const std::vector<ProcessEntry> &processes, const NameMatcher &names, std::vector<std::uint8_t> &matches) const;
+
+    private:
+        std::wstring needle_;
+        std::uint32_t processId_ = 0;
+        bool byProcessId_ = false;
+    };
+
+    // Three-way comparison on one column with PID as the tie-break, so every
+    // order is total and stable across refreshes. Names compare
+    // case-insensitively. CpuPercent compares PIDs only.
+    int CompareProcesses(const ProcessEntry &lhs, const ProcessEntry &rhs, ProcessSortColumn column);
+
+    void SortProcesses(std::vector<ProcessEntry> &processes, ProcessSortColumn column, bool ascending);
+
+    struct ProcessRow
+    {
+        const ProcessEntry *process = nullptr;
+        double cpuPercent = 0.0;
+
+        // ProcessRowHash() of *process: with cpuPercent, all a drawn row
+        // depends on, so a row whose pair matches the last one drawn in
+        // its place can be left alone.
+        std::uint64_t rowHash = 0;
+    };
+
+    // Filtered, sorted rows over the processes of the latest Update(),
+    // which the caller keeps alive until the next one unless the view was
+    // given the ProcessSnapshot itself to share. Rows point into that
+    // vector instead of copying entries (and their thread lists), and CPU
+    // usage is derived per process from the previous Update() the same way
+    // HostSummaryBuilder does, so the first generation reports 0%. The
+    // filter is a ProcessQuery over a ProcessTable of the generation, and a
+    // ProcessOrder keeps the rows sorted, repairing the previous order
+    // rather than sorting again when a refresh changed little.
+    class ProcessView
+    {
+    public:
+        // processes must be sorted by PID, as ProcessSnapshot keeps them.
+        // Without handles or network, the query sees zero handles or
+        // connections; Filter().Uses() tells whether capturing them matters.
+        void Update(const std::vector<ProcessEntry> &processes,
+                    std::chrono::steady_clock::time_point timestamp,
+                    const HandleSnapshot *handles = nullptr,
+                    const NetworkSnapshot *network = nullptr);
+
+        // Same, but the view shares the snapshot, so its rows stay valid
+        // whatever the caller does with its copy, and Ref() works.
+        void Update(const ProcessSnapshot &snapshot,
+                    std::chrono::steady_clock::time_point timestamp,
+                    const HandleSnapshot *handles = nullptr,
+                    const NetworkSnapshot *network = nullptr);
+
+        // Both re-derive Rows() from the current generation. A filter that
+        // does not compile leaves the previous one in place.
+        bool SetFilter(std::wstring_view text, std::wstring &error);
+        void SetSort(ProcessSortColumn column, bool ascending);
+
+        // Only the first rows of Rows() need to be in order, as on a
+        // terminal that shows a page at a time; 0 (the default) sorts all.
+        void SetSortLimit(std::size_t rows);
+
+        const ProcessQuery &Filter() const { return query_; }
+        ProcessSortColumn SortColumn() const { return column_; }
+        bool SortAscending() const { return ascending_; }
+
+        const std::vector<ProcessRow> &Rows() const { return rows_; }
+
+        // The process behind Rows()[row], sharing the generation; empty if
+        // the current generation did not come from a ProcessSnapshot.
+        ProcessRef Ref(std::size_t row) const;
+
+        // Processes in the current generation before filtering.
+        std::size_t TotalCount() const { return processes_ ? processes_->size() : 0; }
+
+    private:
+        void Rebuild();
+
+        const std::vector<ProcessEntry> *processes_ = nullptr;
+        ProcessSnapshot snapshot_;
+        ProcessQuery query_;
+        ProcessTable table_;
+        std::vector<std::uint32_t> selection_;
+        ProcessOrder order_;
+        ProcessSortColumn column_ = ProcessSortColumn::CpuPercent;
+        bool ascending_ = false;
+        std::size_t sortLimit_ = 0;
+        std::vector<ProcessRow> rows_;
+
+        // Index-aligned with *processes_. Row hashes are the snapshot's
+        // column when there is one, else computed into ownRowHashes_.
+        std::vector<double> cpuPercent_;
+        const std::vector<std::uint64_t> *rowHashes_ = nullptr;
+        std::vector<std::uint64_t> ownRowHashes_;
+
+        // (pid, kernel + user time) of the previous and current generation.
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> previousCpuTimes_;
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> currentCpuTimes_;
+        std::chrono::steady_clock::time_point previousTimestamp_{};
+        bool hasCpuBaseline_ = false;
+    };
+}
@@ -0,0 +1,222 @@
+#include "procfs.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <charconv>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::size_t kReadChunkBytes = 4096;
+
+    bool IsSpace(char ch)
+    {
+        return ch == ' ' || ch == '\t' || ch == '\n';
+    }
+}
+
+namespace rvrse::core::procfs
+{
+    bool ReadFile(const char *path, std::string &contents)
+    {
+        contents.clear();
+
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        bool ok = true;
+        while (true)
+        {
+            const std::size_t used = contents.size();
+            contents.resize(used + kReadChunkBytes);
+            const ssize_t count = read(fd, contents.data() + used, kReadChunkBytes);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    contents.resize(used);
+                    continue;
+                }
+                contents.resize(used);
+                ok = false;
+                break;
+            }
+
+            contents.resize(used + static_cast<std::size_t>(count));
+            if (count == 0)
+            {
+                break;
+            }
+        }
+
+        const int savedErrno = errno;
+        close(fd);
+        errno = savedErrno;
+        return ok;
+    }
+
+    std::vector<std::uint32_t> ListNumericEntries(const char *path)
+    {
+        std::vector<std::uint32_t> entries;
+        ListNumericEntries(path, entries);
+        return entries;
+    }
+
+    void ListNumericEntries(const char *path, std::vector<std::uint32_t> &entries)
+    {
+        entries.clear();
+
+        DIR *directory = opendir(path);
+        if (!directory)
+        {
+            return;
+        }
+
+        while (dirent *entry = readdir(directory))
+        {
+            const char *name = entry->d_name;
+            if (*name < '0' || *name > '9')
+            {
+                continue;
+            }
+
+            std::uint32_t value = 0;
+            const char *end = name;
+            while (*end)
+            {
+                ++end;
+            }
+            auto [ptr, ec] = std::from_chars(name, end, value);
+            if (ec == std::errc() && ptr == end)
+            {
+                entries.push_back(value);
+            }
+        }
+
+        closedir(directory);
+    }
+
+    std::string_view NextToken(std::string_view &text)
+    {
+        std::size_t start = 0;
+        while (start < text.size() && IsSpace(text[start]))
+        {
+            ++start;
+        }
+
+        std::size_t end = start;
+        while (end < text.size() && !IsSpace(text[end]))
+        {
+            ++end;
+        }
+
+        std::string_view token = text.substr(start, end - start);
+        text.remove_prefix(end);
+        return token;
+    }
+
+    bool ParseToken(std::string_view token, std::uint64_t &value, int base)
+    {
+        if (token.empty())
+        {
+            return false;
+        }
+
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value, base);
+        return ec == std::errc() && ptr == token.data() + token.size();
+    }
+
+    bool ParseUnsigned(std::string_view &text, std::uint64_t &value, int base)
+    {
+        return ParseToken(NextToken(text), value, base);
+    }
+
+    bool ParseSigned(std::string_view &text, std::int64_t &value)
+    {
+        const std::string_view token = NextToken(text);
+        if (token.empty())
+        {
+            return false;
+        }
+
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        return ec == std::errc() && ptr == token.data() + token.size();
+    }
+
+    bool SkipTokens(std::string_view &text, std::size_t count)
+    {
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            if (NextToken(text).empty())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ParseStat(std::string_view contents, StatFields &fields)
+    {
+        const std::size_t open = contents.find('(');
+        const std::size_t close = contents.rfind(')');
+        if (open == std::string_view::npos || close == std::string_view::npos || close < open)
+        {
+            return false;
+        }
+
+        fields.name = contents.substr(open + 1, close - open - 1);
+        std::string_view rest = contents.substr(close + 1);
+
+        const std::string_view state = NextToken(rest);
+        if (state.empty())
+        {
+            return false;
+        }
+        fields.state = state.front();
+
+        // Field numbers follow proc(5).
+        std::uint64_t ignored = 0;
+        return ParseUnsigned(rest, fields.parentProcessId) &&  // 4  ppid
+               SkipTokens(rest, 9) &&                          // 5-13
+               ParseUnsigned(rest, fields.userTicks) &&        // 14 utime
+               ParseUnsigned(rest, fields.kernelTicks) &&      // 15 stime
+               SkipTokens(rest, 2) &&                          // 16-17
+               ParseSigned(rest, fields.priority) &&           // 18 priority
+               SkipTokens(rest, 1) &&                          // 19 nice
+               ParseUnsigned(rest, fields.threadCount) &&      // 20 num_threads
+               SkipTokens(rest, 2) &&                          // 21-22
+               ParseUnsigned(rest, ignored) &&                 // 23 vsize
+               ParseUnsigned(rest, fields.residentPages);      // 24 rss
+    }
+
+    std::uint64_t ClockTicksTo100ns(std::uint64_t ticks)
+    {
+        static const std::uint64_t ticksPerSecond = []()
+        {
+            const long value = sysconf(_SC_CLK_TCK);
+            return value > 0 ? static_cast<std::uint64_t>(value) : 100ULL;
+        }();
+
+        return ticks * (10'000'000ULL / ticksPerSecond);
+    }
+
+    std::uint64_t PageSize()
+    {
+        static const std::uint64_t pageSize = []()
+        {
+            const long value = sysconf(_SC_PAGESIZE);
+            return value > 0 ? static_cast<std::uint64_t>(value) : 4096ULL;
+        }();
+
+        return pageSize;
+    }
+}
+
+#endif
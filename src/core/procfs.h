@@ -0,0 +1,69 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Small /proc readers shared by the Linux capture backends
+// (*_linux.cpp). Everything here is allocation-light: callers pass in
+// buffers that are reused across files.
+namespace rvrse::core::procfs
+{
+    // Reads a whole file into contents, reusing its capacity. /proc files
+    // report a size of 0, so this reads until EOF instead of trusting stat.
+    // On failure errno is left as set by open/read.
+    bool ReadFile(const char *path, std::string &contents);
+
+    // Numeric entries of a directory such as /proc, /proc/<pid>/task or
+    // /proc/<pid>/fd, in directory order. Empty if the directory is gone.
+    std::vector<std::uint32_t> ListNumericEntries(const char *path);
+
+    // Same, into entries, reusing its capacity.
+    void ListNumericEntries(const char *path, std::vector<std::uint32_t> &entries);
+
+    // Splits off the next whitespace-separated token, or returns an empty view.
+    std::string_view NextToken(std::string_view &text);
+
+    // Parses a whole token as an unsigned number in the given base.
+    bool ParseToken(std::string_view token, std::uint64_t &value, int base = 10);
+
+    // NextToken() + ParseToken().
+    bool ParseUnsigned(std::string_view &text, std::uint64_t &value, int base = 10);
+
+    // Same for a decimal token that may carry a leading '-'.
+    bool ParseSigned(std::string_view &text, std::int64_t &value);
+
+    // Skips count tokens; returns false if the text ran out first.
+    bool SkipTokens(std::string_view &text, std::size_t count);
+
+    // The fields of /proc/<pid>/stat and /proc/<pid>/task/<tid>/stat the
+    // capture backends use. name points into the parsed contents.
+    struct StatFields
+    {
+        std::string_view name;
+        char state = '?';
+        std::uint64_t parentProcessId = 0;
+        std::uint64_t userTicks = 0;
+        std::uint64_t kernelTicks = 0;
+        // Negative (-2 to -100) for real-time tasks.
+        std::int64_t priority = 0;
+        std::uint64_t threadCount = 0;
+        std::uint64_t residentPages = 0;
+    };
+
+    // "pid (comm) state ppid ...". comm may contain spaces and parentheses,
+    // so fields are counted from the last ')'.
+    bool ParseStat(std::string_view contents, StatFields &fields);
+
+    // Converts clock ticks (/proc/<pid>/stat times) to the 100 ns units the
+    // snapshot structures use.
+    std::uint64_t ClockTicksTo100ns(std::uint64_t ticks);
+
+    std::uint64_t PageSize();
+}
+
+#endif
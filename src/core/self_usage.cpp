@@ -0,0 +1,106 @@
+#include "self_usage.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <psapi.h>
+
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <string>
+#include <string_view>
+
+#include <sys/resource.h>
+
+#include "procfs.h"
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    std::uint64_t ToUInt64(const FILETIME &time)
+    {
+        ULARGE_INTEGER value{};
+        value.LowPart = time.dwLowDateTime;
+        value.HighPart = time.dwHighDateTime;
+        return value.QuadPart;
+    }
+
+    void QueryUsage(rvrse::core::SelfUsage &usage)
+    {
+        FILETIME creation{}, exit{}, kernel{}, user{};
+        if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        {
+            usage.kernelTime100ns = ToUInt64(kernel);
+            usage.userTime100ns = ToUInt64(user);
+        }
+
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            usage.residentBytes = counters.WorkingSetSize;
+            usage.peakResidentBytes = counters.PeakWorkingSetSize;
+        }
+    }
+#else
+    std::uint64_t ToUInt64(const timeval &time)
+    {
+        return static_cast<std::uint64_t>(time.tv_sec) * 10'000'000ULL + static_cast<std::uint64_t>(time.tv_usec) * 10ULL;
+    }
+
+    void QueryUsage(rvrse::core::SelfUsage &usage)
+    {
+        rusage resources{};
+        if (getrusage(RUSAGE_SELF, &resources) == 0)
+        {
+            usage.kernelTime100ns = ToUInt64(resources.ru_stime);
+            usage.userTime100ns = ToUInt64(resources.ru_utime);
+
+            // ru_maxrss is in kilobytes on Linux.
+            usage.peakResidentBytes = static_cast<std::uint64_t>(resources.ru_maxrss) * 1024ULL;
+        }
+
+        // getrusage has no current RSS; statm field 2 is resident pages.
+        std::string contents;
+        if (rvrse::core::procfs::ReadFile("/proc/self/statm", contents))
+        {
+            std::string_view text(contents);
+            std::uint64_t residentPages = 0;
+            if (rvrse::core::procfs::SkipTokens(text, 1) && rvrse::core::procfs::ParseUnsigned(text, residentPages))
+            {
+                usage.residentBytes = residentPages * rvrse::core::procfs::PageSize();
+            }
+        }
+    }
+#endif
+}
+
+namespace rvrse::core
+{
+    SelfUsage SelfUsageSampler::Sample()
+    {
+        SelfUsage usage{};
+        QueryUsage(usage);
+
+        // The two figures come from separate queries; keep them consistent.
+        usage.peakResidentBytes = std::max(usage.peakResidentBytes, usage.residentBytes);
+
+        const auto now = std::chrono::steady_clock::now();
+        const std::uint64_t cpuTime = usage.kernelTime100ns + usage.userTime100ns;
+
+        if (hasBaseline_)
+        {
+            const auto elapsed100ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - previousSampleTime_).count() / 100;
+            if (elapsed100ns > 0 && cpuTime >= previousCpuTime100ns_)
+            {
+                usage.cpuPercent = (static_cast<double>(cpuTime - previousCpuTime100ns_) / static_cast<double>(elapsed100ns)) * 100.0;
+            }
+        }
+
+        previousCpuTime100ns_ = cpuTime;
+        previousSampleTime_ = now;
+        hasBaseline_ = true;
+        return usage;
+    }
+}
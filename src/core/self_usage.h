@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace rvrse::core
+{
+    struct SelfUsage
+    {
+        // Share of one core used since the previous Sample(); a process
+        // saturating two cores reports 200%.
+        double cpuPercent = 0.0;
+        std::uint64_t kernelTime100ns = 0;
+        std::uint64_t userTime100ns = 0;
+        std::uint64_t residentBytes = 0;
+        std::uint64_t peakResidentBytes = 0;
+    };
+
+    // Measures the current process's own CPU time and resident memory via
+    // GetProcessTimes/GetProcessMemoryInfo (Windows) or getrusage +
+    // /proc/self/statm (Linux). The first sample reports 0% CPU.
+    class SelfUsageSampler
+    {
+    public:
+        SelfUsage Sample();
+
+    private:
+        std::uint64_t previousCpuTime100ns_ = 0;
+        std::chrono::steady_clock::time_point previousSampleTime_{};
+        bool hasBaseline_ = false;
+    };
+}
@@ -0,0 +1,205 @@
+#include "shared_memory.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if !defined(_WIN32)
+    std::string ToPosixName(const std::wstring &name)
+    {
+        // Shared memory names are ASCII identifiers chosen by the host.
+        std::string narrow;
+        narrow.reserve(name.size());
+        for (wchar_t ch : name)
+        {
+            narrow.push_back(static_cast<char>(ch));
+        }
+        return narrow;
+    }
+#endif
+}
+
+namespace rvrse::core
+{
+    SharedMemoryRegion::~SharedMemoryRegion()
+    {
+        Close();
+    }
+
+    SharedMemoryRegion::SharedMemoryRegion(SharedMemoryRegion &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    SharedMemoryRegion &SharedMemoryRegion::operator=(SharedMemoryRegion &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            owner_ = std::exchange(other.owner_, false);
+#if defined(_WIN32)
+            mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+            posixName_ = std::move(other.posixName_);
+            other.posixName_.clear();
+#endif
+        }
+        return *this;
+    }
+
+    bool SharedMemoryRegion::Create(const std::wstring &name, std::size_t sizeBytes)
+    {
+        Close();
+
+#if defined(_WIN32)
+        ULARGE_INTEGER size{};
+        size.QuadPart = sizeBytes;
+        HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE,
+                                            nullptr,
+                                            PAGE_READWRITE,
+                                            size.HighPart,
+                                            size.LowPart,
+                                            name.c_str());
+        if (!mapping)
+        {
+            return false;
+        }
+
+        if (GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeBytes);
+        if (!view)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        mapping_ = mapping;
+        data_ = view;
+#else
+        std::string posixName = ToPosixName(name);
+        int fd = shm_open(posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        if (ftruncate(fd, static_cast<off_t>(sizeBytes)) != 0)
+        {
+            ::close(fd);
+            shm_unlink(posixName.c_str());
+            return false;
+        }
+
+        void *view = mmap(nullptr, sizeBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+        {
+            shm_unlink(posixName.c_str());
+            return false;
+        }
+
+        posixName_ = std::move(posixName);
+        data_ = view;
+#endif
+
+        size_ = sizeBytes;
+        owner_ = true;
+        return true;
+    }
+
+    bool SharedMemoryRegion::Open(const std::wstring &name)
+    {
+        Close();
+
+#if defined(_WIN32)
+        HANDLE mapping = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name.c_str());
+        if (!mapping)
+        {
+            return false;
+        }
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+        if (!view)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        MEMORY_BASIC_INFORMATION info{};
+        VirtualQuery(view, &info, sizeof(info));
+
+        mapping_ = mapping;
+        data_ = view;
+        size_ = info.RegionSize;
+#else
+        std::string posixName = ToPosixName(name);
+        int fd = shm_open(posixName.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        std::size_t sizeBytes = static_cast<std::size_t>(info.st_size);
+        void *view = mmap(nullptr, sizeBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+        {
+            return false;
+        }
+
+        data_ = view;
+        size_ = sizeBytes;
+#endif
+
+        owner_ = false;
+        return true;
+    }
+
+    void SharedMemoryRegion::Close()
+    {
+        if (!data_)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+        CloseHandle(static_cast<HANDLE>(mapping_));
+        mapping_ = nullptr;
+#else
+        munmap(data_, size_);
+        if (owner_)
+        {
+            shm_unlink(posixName_.c_str());
+        }
+        posixName_.clear();
+#endif
+
+        data_ = nullptr;
+        size_ = 0;
+        owner_ = false;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace rvrse::core
+{
+    // Named shared memory region backed by CreateFileMappingW (Windows) or
+    // shm_open + mmap (POSIX). The creating side owns the name and removes it
+    // on Close(); openers only unmap.
+    class SharedMemoryRegion
+    {
+    public:
+        SharedMemoryRegion() = default;
+        ~SharedMemoryRegion();
+
+        SharedMemoryRegion(const SharedMemoryRegion &) = delete;
+        SharedMemoryRegion &operator=(const SharedMemoryRegion &) = delete;
+        SharedMemoryRegion(SharedMemoryRegion &&other) noexcept;
+        SharedMemoryRegion &operator=(SharedMemoryRegion &&other) noexcept;
+
+        // Names follow platform rules: "Local\\Name" on Windows, "/name" on POSIX.
+        bool Create(const std::wstring &name, std::size_t sizeBytes);
+        bool Open(const std::wstring &name);
+        void Close();
+
+        bool IsOpen() const { return data_ != nullptr; }
+        void *Data() const { return data_; }
+        std::size_t Size() const { return size_; }
+
+    private:
+        void *data_ = nullptr;
+        std::size_t size_ = 0;
+        bool owner_ = false;
+#if defined(_WIN32)
+        void *mapping_ = nullptr;
+#else
+        std::string posixName_;
+#endif
+    };
+}
@@ -0,0 +1,37 @@
+#include "snapshot_arena.h"
+
+namespace rvrse::core
+{
+    void *SnapshotArena::Upstream::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        this->bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void SnapshotArena::Upstream::do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment)
+    {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    SnapshotArena::SnapshotArena()
+    {
+        resource_.emplace(&upstream_);
+    }
+
+    void SnapshotArena::Reset()
+    {
+        // Hands the overflow chunks back and rewinds to the start of the block.
+        resource_->release();
+        if (upstream_.bytes > 0)
+        {
+            // The monotonic resource grows its chunks geometrically, so this
+            // overshoots what was used by less than one chunk.
+            const std::size_t used = capacity_ + upstream_.bytes;
+            capacity_ = used + used / 4;
+            resource_.reset();
+            block_.reset(new std::byte[capacity_]);
+            resource_.emplace(block_.get(), capacity_, &upstream_);
+        }
+        upstream_.bytes = 0;
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace rvrse::core
+{
+    // Monotonic memory for one snapshot generation. Everything a capture
+    // allocates from Resource() is a pointer bump into one block, and all of
+    // it is dropped at once by Reset() when the generation is recycled.
+    //
+    // The block starts empty; whatever a generation needed beyond it came
+    // from the global heap, and Reset() regrows the block to cover that
+    // plus a quarter, so once the process list stops growing a capture
+    // takes nothing from the heap. The block never shrinks.
+    class SnapshotArena
+    {
+    public:
+        SnapshotArena();
+        SnapshotArena(const SnapshotArena &) = delete;
+        SnapshotArena &operator=(const SnapshotArena &) = delete;
+
+        std::pmr::memory_resource *Resource() { return &*resource_; }
+
+        // Bytes of the block, and bytes the heap supplied past it since the
+        // last Reset().
+        std::size_t CapacityBytes() const { return capacity_; }
+        std::size_t OverflowBytes() const { return upstream_.bytes; }
+
+        // Invalidates everything allocated from Resource().
+        void Reset();
+
+    private:
+        // The global heap, counting what it hands out.
+        class Upstream final : public std::pmr::memory_resource
+        {
+        public:
+            std::size_t bytes = 0;
+
+        private:
+            void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+        };
+
+        std::unique_ptr<std::byte[]> block_;
+        std::size_t capacity_ = 0;
+        Upstream upstream_;
+        std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    };
+
+    // Recycled snapshot generations. Acquire() hands out a Lease, a
+    // refcounted handle that copies share; when the last copy goes, the
+    // generation's Recycle() runs on that thread and the generation waits
+    // in the pool for the next Acquire(). A steady capture loop therefore
+    // cycles through two generations, plus one per snapshot a reader still
+    // holds.
+    //
+    // Generation needs a std::atomic<std::uint32_t> references member and a
+    // Recycle() that drops its contents but keeps its capacity. Generations
+    // live as long as the pool.
+    template <typename Generation>
+    class GenerationPool
+    {
+    public:
+        class Lease
+        {
+        public:
+            Lease() = default;
+            Lease(const Lease &other) : pool_(other.pool_), generation_(other.generation_)
+            {
+                if (generation_)
+                {
+                    generation_->references.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            Lease(Lease &&other) noexcept
+                : pool_(std::exchange(other.pool_, nullptr)), generation_(std::exchange(other.generation_, nullptr))
+            {
+            }
+            Lease &operator=(Lease other) noexcept
+            {
+                std::swap(pool_, other.pool_);
+                std::swap(generation_, other.generation_);
+                return *this;
+            }
+            ~Lease() { Reset(); }
+
+            void Reset()
+            {
+                if (generation_ && generation_->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    pool_->Release(generation_);
+                }
+                pool_ = nullptr;
+                generation_ = nullptr;
+            }
+
+            Generation *Get() const { return generation_; }
+            Generation *operator->() const { return generation_; }
+            explicit operator bool() const { return generation_ != nullptr; }
+
+        private:
+            friend class GenerationPool;
+            Lease(GenerationPool *pool, Generation *generation) : pool_(pool), generation_(generation) {}
+
+            GenerationPool *pool_ = nullptr;
+            Generation *generation_ = nullptr;
+        };
+
+        Lease Acquire()
+        {
+            Generation *generation = nullptr;
+            {
+                std::lock_guard lock(mutex_);
+                if (!idle_.empty())
+                {
+                    generation = idle_.back();
+                    idle_.pop_back();
+                }
+                else
+                {
+                    owned_.push_back(std::make_unique<Generation>());
+                    generation = owned_.back().get();
+                    // Release() must not allocate.
+                    idle_.reserve(owned_.size());
+                }
+            }
+            generation->references.store(1, std::memory_order_relaxed);
+            return Lease(this, generation);
+        }
+
+        // Generations created, and those waiting for an Acquire().
+        std::size_t Size() const
+        {
+            std::lock_guard lock(mutex_);
+            return owned_.size();
+        }
+        std::size_t IdleCount() const
+        {
+            std::lock_guard lock(mutex_);
+            return idle_.size();
+        }
+
+    private:
+        void Release(Generation *generation)
+        {
+            generation->Recycle();
+            std::lock_guard lock(mutex_);
+            idle_.push_back(generation);
+        }
+
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<Generation>> owned_;
+        std::vector<Generation *> idle_;
+    };
+}
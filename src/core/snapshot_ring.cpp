@@ -0,0 +1,626 @@
+#include "snapshot_ring.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "plugin_loader.h"
+
+namespace rvrse::core
+{
+    constexpr std::uint32_t kRingMagic = 0x47525652; // "RVRG"
+    constexpr std::uint32_t kRingLayoutVersion = 2;
+    constexpr std::uint32_t kMaxRingReaders = 32;
+    constexpr std::uint32_t kMaxRingSlots = 255;
+    constexpr unsigned int kSlotIndexBits = 8;
+    constexpr std::uint64_t kSlotIndexMask = (1ULL << kSlotIndexBits) - 1;
+    constexpr int kMaxReadAttempts = 8;
+
+    struct SnapshotRingReaderPin
+    {
+        std::atomic<std::uint32_t> ownerProcessId{0};
+        // Slot index + 1 of the frame being read; 0 when idle.
+        std::atomic<std::uint32_t> pinnedSlot{0};
+    };
+
+    struct alignas(64) SnapshotRingHeader
+    {
+        std::uint32_t magic = 0;
+        std::uint32_t layoutVersion = 0;
+        std::uint32_t slotCount = 0;
+        std::uint32_t producerProcessId = 0;
+        std::uint64_t slotCapacityBytes = 0;
+        std::uint64_t slotStrideBytes = 0;
+        // Readers and producer must agree on wchar_t for the name blob.
+        std::uint32_t wcharSize = 0;
+        std::atomic<std::uint32_t> closed{0};
+        // (generation << kSlotIndexBits) | slot index; 0 until the first Publish().
+        std::atomic<std::uint64_t> latest{0};
+        SnapshotRingReaderPin pins[kMaxRingReaders];
+    };
+
+    struct alignas(64) SnapshotRingSlotHeader
+    {
+        // Odd while being written, 2 * generation once published, 0 if never used.
+        std::atomic<std::uint64_t> sequence{0};
+        std::uint64_t payloadBytes = 0;
+    };
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Ring atomics must be lock-free to live in shared memory");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Ring atomics must be lock-free to live in shared memory");
+}
+
+namespace
+{
+    using rvrse::core::SnapshotRingHeader;
+    using rvrse::core::SnapshotRingSlotHeader;
+
+    // Offsets are relative to the start of the slot payload; counts and
+    // offsets are fixed-width so the layout does not depend on the build.
+    struct RingFrameHeader
+    {
+        std::uint64_t processCount;
+        std::uint64_t threadCount;
+        std::uint64_t handleCount;
+        std::uint64_t connectionCount;
+        std::uint64_t nameChars;
+        std::uint64_t processOffset;
+        std::uint64_t threadOffset;
+        std::uint64_t handleOffset;
+        std::uint64_t connectionOffset;
+        std::uint64_t nameOffset;
+        // Version 2: the same names as terminated UTF-8, after the wide blob.
+        std::uint64_t nameUtf8Bytes;
+        std::uint64_t nameUtf8Offset;
+        std::uint32_t networkFlags;
+        std::uint32_t reserved;
+        RvrseSystemMetrics metrics;
+    };
+
+    struct RingProcessRecord
+    {
+        std::uint32_t processId;
+        std::uint32_t threadCount;
+        std::uint64_t workingSetBytes;
+        std::uint64_t privateBytes;
+        std::uint64_t kernelTime100ns;
+        std::uint64_t userTime100ns;
+        std::uint64_t nameOffset;
+        std::uint64_t nameUtf8Offset;
+        std::uint64_t firstThread;
+        std::uint64_t threadEntryCount;
+    };
+
+    // Metrics are copied as raw bytes; plugin_loader.cpp checks the
+    // field-by-field layout. Connections are written in their ABI form.
+    static_assert(sizeof(rvrse::core::SystemMetrics) == sizeof(RvrseSystemMetrics), "SystemMetrics/RvrseSystemMetrics size mismatch");
+
+    constexpr std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    std::uint32_t CurrentProcessId()
+    {
+#if defined(_WIN32)
+        return static_cast<std::uint32_t>(GetCurrentProcessId());
+#else
+        return static_cast<std::uint32_t>(getpid());
+#endif
+    }
+
+    SnapshotRingSlotHeader *SlotAt(SnapshotRingHeader *header, std::uint32_t slotIndex)
+    {
+        auto *base = reinterpret_cast<std::byte *>(header) + sizeof(SnapshotRingHeader);
+        return reinterpret_cast<SnapshotRingSlotHeader *>(base + header->slotStrideBytes * slotIndex);
+    }
+
+    std::byte *PayloadOf(SnapshotRingSlotHeader *slot)
+    {
+        return reinterpret_cast<std::byte *>(slot + 1);
+    }
+}
+
+namespace rvrse::core
+{
+    SnapshotRingWriter::~SnapshotRingWriter()
+    {
+        Close();
+    }
+
+    bool SnapshotRingWriter::Create(const std::wstring &name, std::uint32_t slotCount, std::size_t slotCapacityBytes)
+    {
+        Close();
+
+        if (slotCount < 2 || slotCount > kMaxRingSlots || slotCapacityBytes < sizeof(RingFrameHeader))
+        {
+            return false;
+        }
+
+        const std::uint64_t capacity = AlignUp(slotCapacityBytes, alignof(SnapshotRingSlotHeader));
+        const std::uint64_t stride = sizeof(SnapshotRingSlotHeader) + capacity;
+        const std::uint64_t totalBytes = sizeof(SnapshotRingHeader) + stride * slotCount;
+
+        if (!region_.Create(name, static_cast<std::size_t>(totalBytes)))
+        {
+            return false;
+        }
+
+        header_ = new (region_.Data()) SnapshotRingHeader();
+        header_->layoutVersion = kRingLayoutVersion;
+        header_->slotCount = slotCount;
+        header_->producerProcessId = CurrentProcessId();
+        header_->slotCapacityBytes = capacity;
+        header_->slotStrideBytes = stride;
+        header_->wcharSize = sizeof(wchar_t);
+
+        for (std::uint32_t index = 0; index < slotCount; ++index)
+        {
+            new (SlotAt(header_, index)) SnapshotRingSlotHeader();
+        }
+
+        // Readers validate the magic first; publish it once everything else is set.
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->magic = kRingMagic;
+
+        generation_ = 0;
+        latestSlot_ = 0;
+        droppedFrames_ = 0;
+        forcedOverwrites_ = 0;
+        return true;
+    }
+
+    void SnapshotRingWriter::Close()
+    {
+        if (!header_)
+        {
+            return;
+        }
+
+        header_->closed.store(1, std::memory_order_release);
+        header_ = nullptr;
+        region_.Close();
+    }
+
+    bool SnapshotRingWriter::Publish(const ProcessSnapshot &processes,
+                                     const HandleSnapshot &handles,
+                                     const NetworkSnapshot &network,
+                                     const SystemMetrics &metrics)
+    {
+        if (!header_)
+        {
+            return false;
+        }
+
+        const auto &processList = processes.Processes();
+        const auto &handleList = handles.Handles();
+        const auto &connectionList = network.Connections();
+
+        std::uint64_t threadTotal = 0;
+        std::uint64_t nameChars = 0;
+        std::uint64_t nameUtf8Bytes = 0;
+        for (const auto &process : processList)
+        {
+            threadTotal += process.threads.size();
+            nameChars += process.imageName.size() + 1;
+            nameUtf8Bytes += process.imageName.Utf8().size() + 1;
+        }
+
+        RingFrameHeader frame{};
+        frame.processCount = processList.size();
+        frame.threadCount = threadTotal;
+        frame.handleCount = handleList.size();
+        frame.connectionCount = connectionList.size();
+        frame.nameChars = nameChars;
+        frame.nameUtf8Bytes = nameUtf8Bytes;
+        frame.processOffset = AlignUp(sizeof(RingFrameHeader), 8);
+        frame.threadOffset = AlignUp(frame.processOffset + frame.processCount * sizeof(RingProcessRecord), 8);
+        frame.handleOffset = AlignUp(frame.threadOffset + frame.threadCount * sizeof(RvrseThreadInfo), 8);
+        frame.connectionOffset = AlignUp(frame.handleOffset + frame.handleCount * sizeof(RvrseHandleInfo), 8);
+        frame.nameOffset = AlignUp(frame.connectionOffset + frame.connectionCount * sizeof(RvrseConnectionInfo), 8);
+        frame.nameUtf8Offset = frame.nameOffset + nameChars * sizeof(wchar_t);
+        frame.networkFlags = (network.AccessDenied() ? RVRSE_NETWORK_ACCESS_DENIED : 0U) |
+                             (network.CaptureFailed() ? RVRSE_NETWORK_CAPTURE_FAILED : 0U);
+        std::memcpy(&frame.metrics, &metrics, sizeof(frame.metrics));
+
+        const std::uint64_t payloadBytes = frame.nameUtf8Offset + nameUtf8Bytes;
+        if (payloadBytes > header_->slotCapacityBytes)
+        {
+            ++droppedFrames_;
+            return false;
+        }
+
+        const std::uint64_t generation = generation_ + 1;
+        const std::uint32_t slotIndex = AcquireSlot(generation * 2 - 1);
+        SnapshotRingSlotHeader *slot = Slot(slotIndex);
+        std::byte *payload = PayloadOf(slot);
+
+        std::memcpy(payload, &frame, sizeof(frame));
+
+        auto *records = reinterpret_cast<RingProcessRecord *>(payload + frame.processOffset);
+        auto *threads = reinterpret_cast<RvrseThreadInfo *>(payload + frame.threadOffset);
+        auto *names = reinterpret_cast<wchar_t *>(payload + frame.nameOffset);
+        auto *namesUtf8 = reinterpret_cast<char *>(payload + frame.nameUtf8Offset);
+
+        std::uint64_t threadCursor = 0;
+        std::uint64_t nameCursor = 0;
+        std::uint64_t nameUtf8Cursor = 0;
+        for (const auto &process : processList)
+        {
+            RingProcessRecord &record = *records++;
+            record.processId = process.processId;
+            record.threadCount = process.threadCount;
+            record.workingSetBytes = process.workingSetBytes;
+            record.privateBytes = process.privateBytes;
+            record.kernelTime100ns = process.kernelTime100ns;
+            record.userTime100ns = process.userTime100ns;
+            record.nameOffset = nameCursor;
+            record.nameUtf8Offset = nameUtf8Cursor;
+            record.firstThread = threadCursor;
+            record.threadEntryCount = process.threads.size();
+
+            if (!process.imageName.empty())
+            {
+                std::memcpy(names + nameCursor, process.imageName.data(), process.imageName.size() * sizeof(wchar_t));
+            }
+            nameCursor += process.imageName.size();
+            names[nameCursor++] = L'\0';
+
+            const std::string_view nameUtf8 = process.imageName.Utf8();
+            std::memcpy(namesUtf8 + nameUtf8Cursor, nameUtf8.data(), nameUtf8.size());
+            nameUtf8Cursor += nameUtf8.size();
+            namesUtf8[nameUtf8Cursor++] = '\0';
+
+            for (const auto &thread : process.threads)
+            {
+                RvrseThreadInfo &info = threads[threadCursor++];
+                info.threadId = thread.threadId;
+                info.owningProcessId = thread.owningProcessId;
+                info.priority = thread.priority;
+                info.state = thread.state;
+                info.waitReason = thread.waitReason;
+                info.kernelTime100ns = thread.kernelTime100ns;
+                info.userTime100ns = thread.userTime100ns;
+            }
+        }
+
+        auto *handleInfos = reinterpret_cast<RvrseHandleInfo *>(payload + frame.handleOffset);
+        for (const auto &handle : handleList)
+        {
+            RvrseHandleInfo &info = *handleInfos++;
+            info.processId = handle.processId;
+            info.handleValue = handle.handleValue;
+            info.objectTypeIndex = handle.objectTypeIndex;
+            info.attributes = handle.attributes;
+            info.grantedAccess = handle.grantedAccess;
+        }
+
+        auto *connectionInfos = reinterpret_cast<RvrseConnectionInfo *>(payload + frame.connectionOffset);
+        for (const auto &connection : connectionList)
+        {
+            *connectionInfos++ = ToConnectionInfo(connection);
+        }
+
+        slot->payloadBytes = payloadBytes;
+        slot->sequence.store(generation * 2, std::memory_order_release);
+        header_->latest.store((generation << kSlotIndexBits) | slotIndex, std::memory_order_release);
+
+        generation_ = generation;
+        latestSlot_ = slotIndex;
+        return true;
+    }
+
+    void SnapshotRingWriter::ReleaseReader(std::uint32_t processId)
+    {
+        if (!header_ || processId == 0)
+        {
+            return;
+        }
+
+        for (auto &pin : header_->pins)
+        {
+            if (pin.ownerProcessId.load(std::memory_order_acquire) == processId)
+            {
+                pin.pinnedSlot.store(0, std::memory_order_release);
+                pin.ownerProcessId.store(0, std::memory_order_release);
+            }
+        }
+    }
+
+    std::uint32_t SnapshotRingWriter::AcquireSlot(std::uint64_t sequenceWhileWriting)
+    {
+        const std::uint32_t slotCount = header_->slotCount;
+
+        for (std::uint32_t step = 1; step <= slotCount; ++step)
+        {
+            const std::uint32_t candidate = (latestSlot_ + step) % slotCount;
+            if (generation_ != 0 && candidate == latestSlot_)
+            {
+                continue;
+            }
+
+            if (IsSlotPinned(candidate))
+            {
+                continue;
+            }
+
+            // Mark the slot busy, then re-check the pins: a reader that pinned
+            // it in between either sees the odd sequence and retries, or pinned
+            // early enough for this second check to see it.
+            SnapshotRingSlotHeader *slot = Slot(candidate);
+            const std::uint64_t previous = slot->sequence.load(std::memory_order_relaxed);
+            slot->sequence.store(sequenceWhileWriting, std::memory_order_seq_cst);
+            if (!IsSlotPinned(candidate))
+            {
+                std::atomic_thread_fence(std::memory_order_release);
+                return candidate;
+            }
+
+            slot->sequence.store(previous, std::memory_order_seq_cst);
+        }
+
+        // Every spare slot is pinned (more slow readers than slots). Overwrite
+        // the oldest rather than stall; affected readers see IsIntact() == false.
+        ++forcedOverwrites_;
+        const std::uint32_t fallback = (latestSlot_ + 1) % slotCount;
+        Slot(fallback)->sequence.store(sequenceWhileWriting, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_release);
+        return fallback;
+    }
+
+    bool SnapshotRingWriter::IsSlotPinned(std::uint32_t slotIndex) const
+    {
+        for (const auto &pin : header_->pins)
+        {
+            if (pin.pinnedSlot.load(std::memory_order_seq_cst) == slotIndex + 1)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    SnapshotRingSlotHeader *SnapshotRingWriter::Slot(std::uint32_t slotIndex) const
+    {
+        return SlotAt(header_, slotIndex);
+    }
+
+    SnapshotRingReader::~SnapshotRingReader()
+    {
+        Close();
+    }
+
+    bool SnapshotRingReader::Open(const std::wstring &name)
+    {
+        Close();
+
+        if (!region_.Open(name) || region_.Size() < sizeof(SnapshotRingHeader))
+        {
+            region_.Close();
+            return false;
+        }
+
+        auto *header = static_cast<SnapshotRingHeader *>(region_.Data());
+        if (header->magic != kRingMagic)
+        {
+            region_.Close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        const std::uint64_t requiredBytes = sizeof(SnapshotRingHeader) + header->slotStrideBytes * header->slotCount;
+        if (header->layoutVersion != kRingLayoutVersion ||
+            header->wcharSize != sizeof(wchar_t) ||
+            header->slotCount < 2 || header->slotCount > kMaxRingSlots ||
+            header->slotStrideBytes != sizeof(SnapshotRingSlotHeader) + header->slotCapacityBytes ||
+            requiredBytes > region_.Size())
+        {
+            region_.Close();
+            return false;
+        }
+
+        const std::uint32_t processId = CurrentProcessId();
+        for (std::uint32_t index = 0; index < kMaxRingReaders; ++index)
+        {
+            std::uint32_t expected = 0;
+            if (header->pins[index].ownerProcessId.compare_exchange_strong(expected, processId))
+            {
+                header_ = header;
+                pinIndex_ = index;
+                pinnedSlot_ = 0;
+                lastGeneration_ = 0;
+                skippedGenerations_ = 0;
+                return true;
+            }
+        }
+
+        region_.Close();
+        return false;
+    }
+
+    void SnapshotRingReader::Close()
+    {
+        if (!header_)
+        {
+            return;
+        }
+
+        Release();
+        header_->pins[pinIndex_].ownerProcessId.store(0, std::memory_order_release);
+        header_ = nullptr;
+        region_.Close();
+    }
+
+    SnapshotRingReader::ReadStatus SnapshotRingReader::TryReadLatest(SnapshotRingFrame &frame)
+    {
+        if (!header_)
+        {
+            return ReadStatus::Closed;
+        }
+
+        SnapshotRingReaderPin &pin = header_->pins[pinIndex_];
+
+        for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt)
+        {
+            const std::uint64_t latest = header_->latest.load(std::memory_order_acquire);
+            const std::uint64_t generation = latest >> kSlotIndexBits;
+            if (generation == 0 || generation == lastGeneration_)
+            {
+                // Deliver everything that was published before reporting Closed.
+                return header_->closed.load(std::memory_order_acquire) != 0 ? ReadStatus::Closed : ReadStatus::NoNewFrame;
+            }
+
+            const auto slotIndex = static_cast<std::uint32_t>(latest & kSlotIndexMask);
+            if (slotIndex >= header_->slotCount)
+            {
+                return ReadStatus::NoNewFrame;
+            }
+
+            Release();
+            pin.pinnedSlot.store(slotIndex + 1, std::memory_order_seq_cst);
+            pinnedSlot_ = slotIndex + 1;
+
+            SnapshotRingSlotHeader *slot = Slot(slotIndex);
+            if (slot->sequence.load(std::memory_order_seq_cst) != generation * 2)
+            {
+                // The producer moved on between reading `latest` and pinning.
+                continue;
+            }
+
+            const std::byte *payload = PayloadOf(slot);
+            RingFrameHeader header{};
+            std::memcpy(&header, payload, sizeof(header));
+
+            const std::uint64_t capacity = header_->slotCapacityBytes;
+            const bool layoutValid =
+                slot->payloadBytes <= capacity &&
+                header.processOffset + header.processCount * sizeof(RingProcessRecord) <= header.threadOffset &&
+                header.threadOffset + header.threadCount * sizeof(RvrseThreadInfo) <= header.handleOffset &&
+                header.handleOffset + header.handleCount * sizeof(RvrseHandleInfo) <= header.connectionOffset &&
+                header.connectionOffset + header.connectionCount * sizeof(RvrseConnectionInfo) <= header.nameOffset &&
+                header.nameOffset + header.nameChars * sizeof(wchar_t) <= header.nameUtf8Offset &&
+                header.nameUtf8Offset + header.nameUtf8Bytes <= slot->payloadBytes;
+            if (!layoutValid)
+            {
+                Release();
+                lastGeneration_ = generation;
+                return ReadStatus::NoNewFrame;
+            }
+
+            const auto *records = reinterpret_cast<const RingProcessRecord *>(payload + header.processOffset);
+            const auto *threads = reinterpret_cast<const RvrseThreadInfo *>(payload + header.threadOffset);
+            const auto *names = reinterpret_cast<const wchar_t *>(payload + header.nameOffset);
+            const auto *namesUtf8 = reinterpret_cast<const char *>(payload + header.nameUtf8Offset);
+
+            frame.processInfos_.clear();
+            frame.processInfos_.reserve(static_cast<std::size_t>(header.processCount));
+            frame.imageNamesUtf8_.clear();
+            frame.imageNamesUtf8_.reserve(static_cast<std::size_t>(header.processCount));
+            for (std::uint64_t index = 0; index < header.processCount; ++index)
+            {
+                const RingProcessRecord &record = records[index];
+                if (record.nameOffset >= header.nameChars ||
+                    record.nameUtf8Offset >= header.nameUtf8Bytes ||
+                    record.firstThread + record.threadEntryCount > header.threadCount)
+                {
+                    continue;
+                }
+
+                RvrseProcessInfo info{};
+                info.imageName = names + record.nameOffset;
+                info.processId = record.processId;
+                info.threadCount = record.threadCount;
+                info.workingSetBytes = record.workingSetBytes;
+                info.privateBytes = record.privateBytes;
+                info.kernelTime100ns = record.kernelTime100ns;
+                info.userTime100ns = record.userTime100ns;
+                info.threads = record.threadEntryCount == 0 ? nullptr : threads + record.firstThread;
+                info.threadEntryCount = static_cast<std::size_t>(record.threadEntryCount);
+                frame.processInfos_.push_back(info);
+                frame.imageNamesUtf8_.push_back(namesUtf8 + record.nameUtf8Offset);
+            }
+
+            frame.generation_ = generation;
+            frame.processView_.processes = frame.processInfos_.empty() ? nullptr : frame.processInfos_.data();
+            frame.processView_.processCount = frame.processInfos_.size();
+            frame.processView_.imageNamesUtf8 = frame.imageNamesUtf8_.empty() ? nullptr : frame.imageNamesUtf8_.data();
+            frame.handleView_.handles = header.handleCount == 0
+                                            ? nullptr
+                                            : reinterpret_cast<const RvrseHandleInfo *>(payload + header.handleOffset);
+            frame.handleView_.handleCount = static_cast<std::size_t>(header.handleCount);
+            frame.networkView_.connections = header.connectionCount == 0
+                                                 ? nullptr
+                                                 : reinterpret_cast<const RvrseConnectionInfo *>(payload + header.connectionOffset);
+            frame.networkView_.connectionCount = static_cast<std::size_t>(header.connectionCount);
+            frame.networkView_.flags = header.networkFlags;
+            frame.metrics_ = header.metrics;
+
+            if (lastGeneration_ != 0 && generation > lastGeneration_ + 1)
+            {
+                skippedGenerations_ += generation - lastGeneration_ - 1;
+            }
+            lastGeneration_ = generation;
+            return ReadStatus::FrameReady;
+        }
+
+        Release();
+        return ReadStatus::NoNewFrame;
+    }
+
+    void SnapshotRingReader::Release()
+    {
+        if (header_ && pinnedSlot_ != 0)
+        {
+            header_->pins[pinIndex_].pinnedSlot.store(0, std::memory_order_release);
+            pinnedSlot_ = 0;
+        }
+    }
+
+    bool SnapshotRingReader::IsIntact(const SnapshotRingFrame &frame) const
+    {
+        if (!header_ || pinnedSlot_ == 0)
+        {
+            return false;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return Slot(pinnedSlot_ - 1)->sequence.load(std::memory_order_acquire) == frame.generation_ * 2;
+    }
+
+    bool SnapshotRingReader::IsProducerAlive() const
+    {
+        if (!header_ || header_->closed.load(std::memory_order_acquire) != 0)
+        {
+            return false;
+        }
+
+        const std::uint32_t producerId = header_->producerProcessId;
+#if defined(_WIN32)
+        HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, producerId);
+        if (!process)
+        {
+            return GetLastError() == ERROR_ACCESS_DENIED;
+        }
+
+        const bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return running;
+#else
+        return kill(static_cast<pid_t>(producerId), 0) == 0 || errno == EPERM;
+#endif
+    }
+
+    SnapshotRingSlotHeader *SnapshotRingReader::Slot(std::uint32_t slotIndex) const
+    {
+        return SlotAt(header_, slotIndex);
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "handle_snapshot.h"
+#include "network_snapshot.h"
+#include "process_snapshot.h"
+#include "shared_memory.h"
+#include "system_metrics.h"
+#include "rvrse/plugin_api.h"
+
+namespace rvrse::core
+{
+    struct SnapshotRingHeader;
+    struct SnapshotRingSlotHeader;
+
+    // One published generation as seen by a reader. Thread, handle, connection
+    // and metrics views point straight into the shared mapping; only the
+    // RvrseProcessInfo array and the UTF-8 name pointers are rebuilt (to turn
+    // offsets into pointers). A frame stays valid until the next
+    // TryReadLatest()/Release() on its reader.
+    class SnapshotRingFrame
+    {
+    public:
+        std::uint64_t Generation() const { return generation_; }
+
+        const RvrseProcessSnapshotView &Processes() const { return processView_; }
+        const RvrseHandleSnapshotView &Handles() const { return handleView_; }
+        const RvrseNetworkSnapshotView &Network() const { return networkView_; }
+        const RvrseSystemMetrics &Metrics() const { return metrics_; }
+
+    private:
+        friend class SnapshotRingReader;
+
+        std::uint64_t generation_ = 0;
+        std::vector<RvrseProcessInfo> processInfos_;
+        std::vector<const char *> imageNamesUtf8_;
+        RvrseProcessSnapshotView processView_{};
+        RvrseHandleSnapshotView handleView_{};
+        RvrseNetworkSnapshotView networkView_{};
+        RvrseSystemMetrics metrics_{};
+    };
+
+    // Single-producer ring of snapshot generations in shared memory. Each
+    // generation is serialized once into a slot; any number of readers (up to
+    // kMaxReaders) consume it in place.
+    //
+    // Protocol: every slot carries a sequence number that is odd while the
+    // producer writes it and 2 * generation once published. Readers pin the
+    // slot they are reading and the producer never reuses a pinned slot or the
+    // latest one, so it never waits on a reader. A reader that falls behind
+    // simply jumps to the newest generation and counts the ones it skipped.
+    class SnapshotRingWriter
+    {
+    public:
+        static constexpr std::uint32_t kDefaultSlotCount = 4;
+        static constexpr std::size_t kDefaultSlotCapacityBytes = 8U * 1024U * 1024U;
+
+        SnapshotRingWriter() = default;
+        ~SnapshotRingWriter();
+
+        SnapshotRingWriter(const SnapshotRingWriter &) = delete;
+        SnapshotRingWriter &operator=(const SnapshotRingWriter &) = delete;
+
+        // slotCount must be at least 2 and at most 255.
+        bool Create(const std::wstring &name,
+                    std::uint32_t slotCount = kDefaultSlotCount,
+                    std::size_t slotCapacityBytes = kDefaultSlotCapacityBytes);
+
+        // Marks the ring closed so readers shut down, then unmaps it.
+        void Close();
+        bool IsOpen() const { return header_ != nullptr; }
+
+        // Serializes one generation. Returns false (and counts a dropped frame)
+        // when the generation does not fit in a slot.
+        bool Publish(const ProcessSnapshot &processes,
+                     const HandleSnapshot &handles,
+                     const NetworkSnapshot &network,
+                     const SystemMetrics &metrics);
+
+        // Clears pins left behind by a reader process that exited without
+        // closing its reader, so the producer can reuse those slots.
+        void ReleaseReader(std::uint32_t processId);
+
+        std::uint64_t Generation() const { return generation_; }
+        std::uint64_t DroppedFrames() const { return droppedFrames_; }
+
+        // Number of times every candidate slot was pinned and the producer had
+        // to overwrite one anyway; readers on that slot detect it via IsIntact().
+        std::uint64_t ForcedOverwrites() const { return forcedOverwrites_; }
+
+    private:
+        std::uint32_t AcquireSlot(std::uint64_t sequenceWhileWriting);
+        bool IsSlotPinned(std::uint32_t slotIndex) const;
+        SnapshotRingSlotHeader *Slot(std::uint32_t slotIndex) const;
+
+        SharedMemoryRegion region_;
+        SnapshotRingHeader *header_ = nullptr;
+        std::uint64_t generation_ = 0;
+        std::uint32_t latestSlot_ = 0;
+        std::uint64_t droppedFrames_ = 0;
+        std::uint64_t forcedOverwrites_ = 0;
+    };
+
+    class SnapshotRingReader
+    {
+    public:
+        enum class ReadStatus
+        {
+            NoNewFrame,
+            FrameReady,
+            Closed
+        };
+
+        SnapshotRingReader() = default;
+        ~SnapshotRingReader();
+
+        SnapshotRingReader(const SnapshotRingReader &) = delete;
+        SnapshotRingReader &operator=(const SnapshotRingReader &) = delete;
+
+        // Fails if the ring does not exist, has an unknown layout version, or
+        // all reader pins are taken.
+        bool Open(const std::wstring &name);
+        void Close();
+        bool IsOpen() const { return header_ != nullptr; }
+
+        // Never blocks. On FrameReady, frame refers to the newest published
+        // generation and the previous frame's slot is released.
+        ReadStatus TryReadLatest(SnapshotRingFrame &frame);
+
+        // Drops the pin on the current frame's slot.
+        void Release();
+
+        // True while the producer has not reused the slot behind frame. Only
+        // false after a forced overwrite (more pinned readers than spare slots).
+        bool IsIntact(const SnapshotRingFrame &frame) const;
+
+        bool IsProducerAlive() const;
+
+        std::uint64_t SkippedGenerations() const { return skippedGenerations_; }
+
+    private:
+        SnapshotRingSlotHeader *Slot(std::uint32_t slotIndex) const;
+
+        SharedMemoryRegion region_;
+        SnapshotRingHeader *header_ = nullptr;
+        std::uint32_t pinIndex_ = 0;
+        std::uint32_t pinnedSlot_ = 0;
+        std::uint64_t lastGeneration_ = 0;
+        std::uint64_t skippedGenerations_ = 0;
+    };
+}
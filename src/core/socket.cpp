@@ -0,0 +1,625 @@
+#include "socket.h"
+
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#include <Windows.h>
+
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <cerrno>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    using NativeHandle = rvrse::core::Socket::NativeHandle;
+
+    bool EnsureWinsock()
+    {
+        static const bool initialized = []()
+        {
+            WSADATA data{};
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return initialized;
+    }
+
+    void CloseNative(NativeHandle handle)
+    {
+        closesocket(static_cast<SOCKET>(handle));
+    }
+
+    int PollNative(pollfd *fds, unsigned long count, int timeoutMs)
+    {
+        return WSAPoll(fds, count, timeoutMs);
+    }
+
+    bool LastErrorWouldBlock()
+    {
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+    }
+
+    constexpr int kSendFlags = 0;
+#else
+    bool EnsureWinsock()
+    {
+        return true;
+    }
+
+    void CloseNative(int handle)
+    {
+        ::close(handle);
+    }
+
+    int PollNative(pollfd *fds, nfds_t count, int timeoutMs)
+    {
+        int result;
+        do
+        {
+            result = ::poll(fds, count, timeoutMs);
+        } while (result < 0 && errno == EINTR);
+        return result;
+    }
+
+    bool LastErrorWouldBlock()
+    {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+#if defined(MSG_NOSIGNAL)
+    constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kSendFlags = 0;
+#endif
+#endif
+
+    // Numeric hosts only: the agent binds configured addresses and the tests
+    // use loopback, so there is never a reason to block on DNS here.
+    addrinfo *ResolveNumeric(const std::string &address, std::uint16_t port, bool passive)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV | (passive ? AI_PASSIVE : 0);
+
+        const std::string service = std::to_string(port);
+        addrinfo *result = nullptr;
+        if (getaddrinfo(address.empty() ? nullptr : address.c_str(), service.c_str(), &hints, &result) != 0)
+        {
+            return nullptr;
+        }
+        return result;
+    }
+
+    constexpr std::wstring_view kTcpScheme = L"tcp://";
+    constexpr std::wstring_view kUnixScheme = L"unix:";
+
+    bool FillUnixAddress(const std::string &path, sockaddr_un &address)
+    {
+        address = {};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path))
+        {
+            return false;
+        }
+        std::memcpy(address.sun_path, path.data(), path.size());
+        return true;
+    }
+
+    // Removes the socket file a previous listener left behind; bind() fails
+    // on an existing path. Anything that is not a socket is left alone.
+    void RemoveStaleUnixSocket(const std::string &path)
+    {
+#if defined(_WIN32)
+        // AF_UNIX sockets show up as reparse points on NTFS.
+        const DWORD attributes = GetFileAttributesA(path.c_str());
+        if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0)
+        {
+            DeleteFileA(path.c_str());
+        }
+#else
+        struct stat info{};
+        if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        {
+            ::unlink(path.c_str());
+        }
+#endif
+    }
+}
+
+namespace rvrse::core
+{
+    bool IsSocketEndpoint(std::wstring_view text)
+    {
+        return text.substr(0, kTcpScheme.size()) == kTcpScheme || text.substr(0, kUnixScheme.size()) == kUnixScheme;
+    }
+
+    bool ParseSocketEndpoint(std::wstring_view text, SocketEndpoint &endpoint)
+    {
+        if (text.substr(0, kUnixScheme.size()) == kUnixScheme)
+        {
+            text.remove_prefix(kUnixScheme.size());
+            if (text.empty())
+            {
+                return false;
+            }
+
+            // Native narrow encoding, which is what the sockets API expects.
+            try
+            {
+                endpoint.address = std::filesystem::path(std::wstring(text)).string();
+            }
+            catch (const std::system_error &)
+            {
+                return false;
+            }
+            endpoint.kind = SocketEndpoint::Kind::Unix;
+            endpoint.port = 0;
+            return true;
+        }
+
+        if (text.substr(0, kTcpScheme.size()) != kTcpScheme)
+        {
+            return false;
+        }
+        text.remove_prefix(kTcpScheme.size());
+
+        std::wstring_view host;
+        std::wstring_view portText;
+        if (!text.empty() && text.front() == L'[')
+        {
+            const std::size_t close = text.find(L']');
+            if (close == std::wstring_view::npos || close + 1 >= text.size() || text[close + 1] != L':')
+            {
+                return false;
+            }
+            host = text.substr(1, close - 1);
+            portText = text.substr(close + 2);
+        }
+        else
+        {
+            const std::size_t colon = text.rfind(L':');
+            if (colon == std::wstring_view::npos)
+            {
+                return false;
+            }
+            host = text.substr(0, colon);
+            portText = text.substr(colon + 1);
+        }
+
+        std::uint32_t value = 0;
+        for (wchar_t ch : portText)
+        {
+            if (ch < L'0' || ch > L'9' || (value = value * 10 + static_cast<std::uint32_t>(ch - L'0')) > 0xFFFF)
+            {
+                return false;
+            }
+        }
+        if (host.empty() || portText.empty())
+        {
+            return false;
+        }
+
+        endpoint.kind = SocketEndpoint::Kind::Tcp;
+        endpoint.address.assign(host.begin(), host.end());
+        endpoint.port = static_cast<std::uint16_t>(value);
+        return true;
+    }
+
+    std::wstring LocalHostName()
+    {
+        if (!EnsureWinsock())
+        {
+            return {};
+        }
+
+        char name[256] = {};
+        if (gethostname(name, static_cast<int>(sizeof(name) - 1)) != 0)
+        {
+            return {};
+        }
+
+        try
+        {
+            return std::filesystem::path(std::string(name)).wstring();
+        }
+        catch (const std::system_error &)
+        {
+            return {};
+        }
+    }
+
+#if defined(_WIN32)
+    const Socket::NativeHandle Socket::kInvalidHandle = static_cast<Socket::NativeHandle>(INVALID_SOCKET);
+#else
+    const Socket::NativeHandle Socket::kInvalidHandle = -1;
+#endif
+
+    Socket::~Socket()
+    {
+        Close();
+    }
+
+    Socket::Socket(Socket &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    Socket &Socket::operator=(Socket &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            handle_ = std::exchange(other.handle_, kInvalidHandle);
+            unixPath_ = std::move(other.unixPath_);
+            other.unixPath_.clear();
+        }
+        return *this;
+    }
+
+    bool Socket::ListenTcp(const std::string &address, std::uint16_t port, int backlog)
+    {
+        Close();
+        if (!EnsureWinsock())
+        {
+            return false;
+        }
+
+        addrinfo *resolved = ResolveNumeric(address, port, true);
+        if (!resolved)
+        {
+            return false;
+        }
+
+        for (addrinfo *candidate = resolved; candidate && !IsOpen(); candidate = candidate->ai_next)
+        {
+            const NativeHandle handle = static_cast<NativeHandle>(socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol));
+            if (handle == kInvalidHandle)
+            {
+                continue;
+            }
+
+#if defined(_WIN32)
+            // Windows' SO_REUSEADDR lets another process steal the port.
+            BOOL exclusive = TRUE;
+            setsockopt(static_cast<SOCKET>(handle), SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char *>(&exclusive), sizeof(exclusive));
+#else
+            // Allows an immediate restart while old connections sit in TIME_WAIT.
+            int reuse = 1;
+            setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+            if (bind(handle, candidate->ai_addr, static_cast<int>(candidate->ai_addrlen)) == 0 && listen(handle, backlog) == 0)
+            {
+                handle_ = handle;
+            }
+            else
+            {
+                CloseNative(handle);
+            }
+        }
+
+        freeaddrinfo(resolved);
+        return IsOpen();
+    }
+
+    bool Socket::ConnectTcp(const std::string &address, std::uint16_t port)
+    {
+        Close();
+        if (!EnsureWinsock())
+        {
+            return false;
+        }
+
+        addrinfo *resolved = ResolveNumeric(address, port, false);
+        if (!resolved)
+        {
+            return false;
+        }
+
+        for (addrinfo *candidate = resolved; candidate && !IsOpen(); candidate = candidate->ai_next)
+        {
+            const NativeHandle handle = static_cast<NativeHandle>(socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol));
+            if (handle == kInvalidHandle)
+            {
+                continue;
+            }
+
+            if (connect(handle, candidate->ai_addr, static_cast<int>(candidate->ai_addrlen)) == 0)
+            {
+                handle_ = handle;
+            }
+            else
+            {
+                CloseNative(handle);
+            }
+        }
+
+        freeaddrinfo(resolved);
+        return IsOpen();
+    }
+
+    bool Socket::ListenUnix(const std::string &path, int backlog)
+    {
+        Close();
+        sockaddr_un address{};
+        if (!EnsureWinsock() || !FillUnixAddress(path, address))
+        {
+            return false;
+        }
+
+        const NativeHandle handle = static_cast<NativeHandle>(socket(AF_UNIX, SOCK_STREAM, 0));
+        if (handle == kInvalidHandle)
+        {
+            return false;
+        }
+
+        RemoveStaleUnixSocket(path);
+        if (bind(handle, reinterpret_cast<const sockaddr *>(&address), static_cast<int>(sizeof(address))) != 0 || listen(handle, backlog) != 0)
+        {
+            CloseNative(handle);
+            return false;
+        }
+
+        handle_ = handle;
+        unixPath_ = path;
+        return true;
+    }
+
+    bool Socket::ConnectUnix(const std::string &path)
+    {
+        Close();
+        sockaddr_un address{};
+        if (!EnsureWinsock() || !FillUnixAddress(path, address))
+        {
+            return false;
+        }
+
+        const NativeHandle handle = static_cast<NativeHandle>(socket(AF_UNIX, SOCK_STREAM, 0));
+        if (handle == kInvalidHandle)
+        {
+            return false;
+        }
+
+        if (connect(handle, reinterpret_cast<const sockaddr *>(&address), static_cast<int>(sizeof(address))) != 0)
+        {
+            CloseNative(handle);
+            return false;
+        }
+
+        handle_ = handle;
+        return true;
+    }
+
+    bool Socket::Listen(const SocketEndpoint &endpoint, int backlog)
+    {
+        return endpoint.kind == SocketEndpoint::Kind::Unix ? ListenUnix(endpoint.address, backlog)
+                                                           : ListenTcp(endpoint.address, endpoint.port, backlog);
+    }
+
+    bool Socket::Connect(const SocketEndpoint &endpoint)
+    {
+        return endpoint.kind == SocketEndpoint::Kind::Unix ? ConnectUnix(endpoint.address)
+                                                           : ConnectTcp(endpoint.address, endpoint.port);
+    }
+
+    bool Socket::SetSendTimeout(std::chrono::milliseconds timeout)
+    {
+        if (!IsOpen())
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        const DWORD value = static_cast<DWORD>(timeout.count());
+        return setsockopt(static_cast<SOCKET>(handle_), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&value), sizeof(value)) == 0;
+#else
+        timeval value{};
+        value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        value.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+        return setsockopt(handle_, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value)) == 0;
+#endif
+    }
+
+    bool Socket::SetNonBlocking(bool enabled)
+    {
+        if (!IsOpen())
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        u_long value = enabled ? 1 : 0;
+        return ioctlsocket(static_cast<SOCKET>(handle_), FIONBIO, &value) == 0;
+#else
+        const int flags = fcntl(handle_, F_GETFL, 0);
+        if (flags < 0)
+        {
+            return false;
+        }
+        return fcntl(handle_, F_SETFL, enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
+#endif
+    }
+
+    bool Socket::Accept(Socket &client, std::chrono::milliseconds timeout)
+    {
+        client.Close();
+        if (!IsOpen() || !WaitReadable(timeout))
+        {
+            return false;
+        }
+
+        const NativeHandle handle = static_cast<NativeHandle>(accept(handle_, nullptr, nullptr));
+        if (handle == kInvalidHandle)
+        {
+            return false;
+        }
+
+        client = Socket(handle);
+        return true;
+    }
+
+    bool Socket::SendAll(const void *data, std::size_t sizeBytes)
+    {
+        const char *cursor = static_cast<const char *>(data);
+        while (sizeBytes > 0 && IsOpen())
+        {
+            // Winsock takes an int length; chunk so huge buffers cannot overflow it.
+            const int chunk = static_cast<int>(sizeBytes < (1U << 30) ? sizeBytes : (1U << 30));
+            const auto sent = send(handle_, cursor, chunk, kSendFlags);
+            if (sent <= 0)
+            {
+#if !defined(_WIN32)
+                if (sent < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+#endif
+                return false;
+            }
+
+            cursor += sent;
+            sizeBytes -= static_cast<std::size_t>(sent);
+        }
+        return sizeBytes == 0;
+    }
+
+    bool Socket::SendAll(const void *data, std::size_t sizeBytes, std::chrono::steady_clock::time_point deadline)
+    {
+        const char *cursor = static_cast<const char *>(data);
+        while (sizeBytes > 0 && IsOpen())
+        {
+            const int chunk = static_cast<int>(sizeBytes < (1U << 30) ? sizeBytes : (1U << 30));
+            const auto sent = send(handle_, cursor, chunk, kSendFlags);
+            if (sent > 0)
+            {
+                cursor += sent;
+                sizeBytes -= static_cast<std::size_t>(sent);
+                continue;
+            }
+
+#if !defined(_WIN32)
+            if (sent < 0 && errno == EINTR)
+            {
+                continue;
+            }
+#endif
+            if (sent == 0 || !LastErrorWouldBlock())
+            {
+                return false;
+            }
+
+            // The peer's window is full; wait for room with the time left.
+            const auto remaining =
+                std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0 || !WaitWritable(remaining))
+            {
+                return false;
+            }
+        }
+        return sizeBytes == 0;
+    }
+
+    std::ptrdiff_t Socket::Receive(void *buffer, std::size_t sizeBytes, std::chrono::milliseconds timeout)
+    {
+        if (!IsOpen() || !WaitReadable(timeout))
+        {
+            return -1;
+        }
+
+        const int chunk = static_cast<int>(sizeBytes < (1U << 30) ? sizeBytes : (1U << 30));
+        const auto received = recv(handle_, static_cast<char *>(buffer), chunk, 0);
+        return received < 0 ? -1 : static_cast<std::ptrdiff_t>(received);
+    }
+
+    std::ptrdiff_t Socket::ReceiveAvailable(void *buffer, std::size_t sizeBytes)
+    {
+        if (!IsOpen())
+        {
+            return -1;
+        }
+
+        const int chunk = static_cast<int>(sizeBytes < (1U << 30) ? sizeBytes : (1U << 30));
+        for (;;)
+        {
+            const auto received = recv(handle_, static_cast<char *>(buffer), chunk, 0);
+            if (received >= 0)
+            {
+                return static_cast<std::ptrdiff_t>(received);
+            }
+#if !defined(_WIN32)
+            if (errno == EINTR)
+            {
+                continue;
+            }
+#endif
+            return LastErrorWouldBlock() ? kWouldBlock : -1;
+        }
+    }
+
+    void Socket::Close()
+    {
+        if (handle_ != kInvalidHandle)
+        {
+            CloseNative(handle_);
+            handle_ = kInvalidHandle;
+        }
+        if (!unixPath_.empty())
+        {
+            RemoveStaleUnixSocket(unixPath_);
+            unixPath_.clear();
+        }
+    }
+
+    std::uint16_t Socket::LocalPort() const
+    {
+        sockaddr_storage address{};
+        socklen_t length = sizeof(address);
+        if (!IsOpen() || getsockname(handle_, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+        {
+            return 0;
+        }
+
+        if (address.ss_family == AF_INET)
+        {
+            return ntohs(reinterpret_cast<const sockaddr_in *>(&address)->sin_port);
+        }
+        if (address.ss_family == AF_INET6)
+        {
+            return ntohs(reinterpret_cast<const sockaddr_in6 *>(&address)->sin6_port);
+        }
+        return 0;
+    }
+
+    bool Socket::WaitReadable(std::chrono::milliseconds timeout) const
+    {
+        pollfd descriptor{};
+        descriptor.fd = handle_;
+        descriptor.events = POLLIN;
+        return PollNative(&descriptor, 1, static_cast<int>(timeout.count())) > 0;
+    }
+
+    bool Socket::WaitWritable(std::chrono::milliseconds timeout) const
+    {
+        pollfd descriptor{};
+        descriptor.fd = handle_;
+        descriptor.events = POLLOUT;
+        return PollNative(&descriptor, 1, static_cast<int>(timeout.count())) > 0;
+    }
+}
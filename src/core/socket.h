@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace rvrse::core
+{
+    // Where a stream socket listens or connects: a numeric TCP address and
+    // port, or a Unix domain socket path (AF_UNIX on Windows 10 1803+ too).
+    struct SocketEndpoint
+    {
+        enum class Kind
+        {
+            Tcp,
+            Unix
+        };
+
+        Kind kind = Kind::Tcp;
+        std::string address; // numeric host, or the socket path for Kind::Unix
+        std::uint16_t port = 0;
+    };
+
+    // True when text names a socket rather than a file: "tcp://" or "unix:".
+    bool IsSocketEndpoint(std::wstring_view text);
+
+    // Parses "tcp://127.0.0.1:9000", "tcp://[::1]:9000" or "unix:/run/x.sock".
+    // Port 0 is accepted (listen on an ephemeral port).
+    bool ParseSocketEndpoint(std::wstring_view text, SocketEndpoint &endpoint);
+
+    // This machine's host name, or an empty string if it cannot be read.
+    std::wstring LocalHostName();
+
+    // Owns a stream socket: Winsock on Windows (initialized on first use),
+    // BSD sockets on POSIX. Blocking, with poll-based timeouts so server
+    // threads can notice a stop request between clients.
+    class Socket
+    {
+    public:
+#if defined(_WIN32)
+        using NativeHandle = std::uintptr_t;
+#else
+        using NativeHandle = int;
+#endif
+        static const NativeHandle kInvalidHandle;
+
+        // ReceiveAvailable() result when nothing is pending.
+        static constexpr std::ptrdiff_t kWouldBlock = -2;
+
+        Socket() = default;
+        ~Socket();
+
+        Socket(const Socket &) = delete;
+        Socket &operator=(const Socket &) = delete;
+        Socket(Socket &&other) noexcept;
+        Socket &operator=(Socket &&other) noexcept;
+
+        // Binds a listening TCP socket to a numeric IPv4/IPv6 address.
+        // Port 0 picks an ephemeral port; see LocalPort().
+        bool ListenTcp(const std::string &address, std::uint16_t port, int backlog = 16);
+        bool ConnectTcp(const std::string &address, std::uint16_t port);
+
+        // Unix domain socket. Listening replaces a stale socket file left by
+        // a previous run (never a regular file) and Close() removes it again.
+        bool ListenUnix(const std::string &path, int backlog = 16);
+        bool ConnectUnix(const std::string &path);
+
+        bool Listen(const SocketEndpoint &endpoint, int backlog = 16);
+        bool Connect(const SocketEndpoint &endpoint);
+
+        // Makes SendAll() fail instead of blocking forever on a peer that
+        // stopped reading.
+        bool SetSendTimeout(std::chrono::milliseconds timeout);
+
+        // For sockets driven by a Poller: reads never wait, see
+        // ReceiveAvailable().
+        bool SetNonBlocking(bool enabled);
+
+        // Waits up to timeout for a pending connection. Returns false on
+        // timeout or error; client is left closed in that case.
+        bool Accept(Socket &client, std::chrono::milliseconds timeout);
+
+        // Sends the whole buffer or fails; a peer that hung up is an error,
+        // never a SIGPIPE.
+        bool SendAll(const void *data, std::size_t sizeBytes);
+
+        // Same, but fails once deadline passes. On a non-blocking socket the
+        // deadline covers the whole buffer, so a peer draining a few bytes at
+        // a time cannot stretch it the way it can a per-call send timeout.
+        bool SendAll(const void *data, std::size_t sizeBytes, std::chrono::steady_clock::time_point deadline);
+
+        // Returns the bytes read, 0 when the peer closed the connection, or
+        // -1 on error or when nothing arrived within timeout.
+        std::ptrdiff_t Receive(void *buffer, std::size_t sizeBytes, std::chrono::milliseconds timeout);
+
+        // Reads whatever already arrived without waiting: the bytes read, 0
+        // when the peer closed the connection, kWouldBlock when nothing is
+        // pending, or -1 on error.
+        std::ptrdiff_t ReceiveAvailable(void *buffer, std::size_t sizeBytes);
+
+        void Close();
+
+        bool IsOpen() const { return handle_ != kInvalidHandle; }
+        NativeHandle Handle() const { return handle_; }
+        std::uint16_t LocalPort() const;
+
+    private:
+        explicit Socket(NativeHandle handle) : handle_(handle) {}
+
+        bool WaitReadable(std::chrono::milliseconds timeout) const;
+        bool WaitWritable(std::chrono::milliseconds timeout) const;
+
+        NativeHandle handle_ = kInvalidHandle;
+
+        // Set on Unix listeners only, so Close() can remove the socket file.
+        std::string unixPath_;
+    };
+}
@@ -0,0 +1,249 @@
+#include "string_interner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "binary_codec.h"
+#include "rvrse/common/string_utils.h"
+
+namespace
+{
+    // Text is packed into chunks of this many characters; longer strings get
+    // a chunk of their own.
+    constexpr std::size_t kChunkChars = 16 * 1024;
+
+    constexpr std::size_t kInitialSlots = 1024;
+
+    // Wide text up to this many units is transcoded on the stack.
+    constexpr std::size_t kStackUnits = 256;
+}
+
+namespace rvrse::core
+{
+    template <typename Char>
+    const Char *StringInterner::Arena<Char>::Store(std::basic_string_view<Char> text)
+    {
+        const std::size_t needed = text.size() + 1;
+        Char *stored = nullptr;
+        if (needed > kChunkChars)
+        {
+            // Too long to share a chunk; the current one stays open.
+            chunks.push_back(std::make_unique<Char[]>(needed));
+            bytes += needed * sizeof(Char);
+            stored = chunks.back().get();
+        }
+        else
+        {
+            if (needed > remaining)
+            {
+                chunks.push_back(std::make_unique<Char[]>(kChunkChars));
+                bytes += kChunkChars * sizeof(Char);
+                cursor = chunks.back().get();
+                remaining = kChunkChars;
+            }
+            stored = cursor;
+            cursor += needed;
+            remaining -= needed;
+        }
+
+        std::copy(text.begin(), text.end(), stored);
+        stored[text.size()] = Char{};
+        return stored;
+    }
+
+    StringInterner::StringInterner(std::uint32_t maxStrings)
+        : slots_(kInitialSlots),
+          maxStrings_(std::min(maxStrings, kMaxStrings))
+    {
+        blocks_[0] = std::make_unique<Entry[]>(kBlockSize);
+        Entry &empty = blocks_[0][kEmptyId];
+        empty.text = "";
+        empty.wide.store(L"", std::memory_order_relaxed);
+        count_ = 1;
+    }
+
+    std::uint32_t StringInterner::Intern(std::wstring_view text)
+    {
+        if (text.empty())
+        {
+            return kEmptyId;
+        }
+
+        char buffer[kStackUnits * rvrse::common::kMaxUtf8BytesPerWideChar];
+        std::size_t written = 0;
+        if (text.size() <= kStackUnits && rvrse::common::WideToUtf8(text, buffer, sizeof(buffer), written))
+        {
+            return InternValid(std::string_view(buffer, written));
+        }
+
+        // Long text, or unpaired surrogates to replace.
+        std::string utf8;
+        codec::PutUtf8(utf8, text);
+        return InternValid(utf8);
+    }
+
+    std::uint32_t StringInterner::InternUtf8(std::string_view text)
+    {
+        if (rvrse::common::IsValidUtf8(text))
+        {
+            return InternValid(text);
+        }
+        const std::wstring repaired = codec::DecodeUtf8(reinterpret_cast<const std::uint8_t *>(text.data()), text.size());
+        return Intern(repaired);
+    }
+
+    std::size_t StringInterner::Size() const
+    {
+        std::shared_lock lock(mutex_);
+        return count_;
+    }
+
+    std::size_t StringInterner::Utf8Bytes() const
+    {
+        std::shared_lock lock(mutex_);
+        return text_.bytes;
+    }
+
+    std::size_t StringInterner::WideBytes() const
+    {
+        std::shared_lock lock(mutex_);
+        return wideText_.bytes;
+    }
+
+    std::uint32_t StringInterner::Hash(std::string_view text)
+    {
+        // Eight bytes per multiply rather than one byte: lookups are the
+        // steady-state cost of a capture, and hashing is most of them.
+        const auto *bytes = reinterpret_cast<const unsigned char *>(text.data());
+        std::size_t remaining = text.size();
+        std::uint64_t hash = 0x9E3779B97F4A7C15ull ^ remaining;
+        for (; remaining >= sizeof(std::uint64_t); remaining -= sizeof(std::uint64_t), bytes += sizeof(std::uint64_t))
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes, sizeof(word));
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 32;
+        }
+        if (remaining > 0)
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes, remaining);
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 32;
+        }
+        return static_cast<std::uint32_t>(hash ^ (hash >> 29));
+    }
+
+    std::uint32_t StringInterner::InternValid(std::string_view text)
+    {
+        if (text.empty())
+        {
+            return kEmptyId;
+        }
+
+        const std::uint32_t hash = Hash(text);
+        {
+            std::shared_lock lock(mutex_);
+            const std::uint32_t id = Find(text, hash);
+            if (id != kEmptyId)
+            {
+                return id;
+            }
+        }
+
+        std::unique_lock lock(mutex_);
+        // Another thread may have added it between the two locks.
+        std::uint32_t id = Find(text, hash);
+        if (id != kEmptyId)
+        {
+            return id;
+        }
+        if (count_ >= maxStrings_)
+        {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return kEmptyId;
+        }
+
+        id = count_;
+        std::unique_ptr<Entry[]> &block = blocks_[id / kBlockSize];
+        if (!block)
+        {
+            block = std::make_unique<Entry[]>(kBlockSize);
+        }
+        Entry &entry = block[id % kBlockSize];
+        entry.text = text_.Store(text);
+        entry.length = static_cast<std::uint32_t>(text.size());
+        entry.hash = hash;
+        ++count_;
+
+        // Kept at most half full, so probes stay short.
+        if (count_ * 2 > slots_.size())
+        {
+            Grow();
+        }
+        else
+        {
+            const std::size_t mask = slots_.size() - 1;
+            std::size_t index = hash & mask;
+            while (slots_[index].id != kEmptyId)
+            {
+                index = (index + 1) & mask;
+            }
+            slots_[index] = Slot{hash, id};
+        }
+        return id;
+    }
+
+    std::uint32_t StringInterner::Find(std::string_view text, std::uint32_t hash) const
+    {
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t index = hash & mask; slots_[index].id != kEmptyId; index = (index + 1) & mask)
+        {
+            const Slot &slot = slots_[index];
+            if (slot.hash == hash && Utf8(slot.id) == text)
+            {
+                return slot.id;
+            }
+        }
+        return kEmptyId;
+    }
+
+    std::wstring_view StringInterner::Widen(const Entry &entry) const
+    {
+        std::unique_lock lock(mutex_);
+        if (const wchar_t *wide = entry.wide.load(std::memory_order_relaxed))
+        {
+            return std::wstring_view(wide, entry.wideLength);
+        }
+
+        // Stored text is valid, so the conversion cannot fail, and a UTF-8
+        // byte never becomes more than one unit.
+        std::wstring converted(entry.length, L'\0');
+        std::size_t written = 0;
+        rvrse::common::Utf8ToWide(std::string_view(entry.text, entry.length), converted.data(), converted.size(), written);
+        converted.resize(written);
+
+        const wchar_t *stored = wideText_.Store(std::wstring_view(converted));
+        entry.wideLength = static_cast<std::uint32_t>(written);
+        entry.wide.store(stored, std::memory_order_release);
+        return std::wstring_view(stored, written);
+    }
+
+    void StringInterner::Grow()
+    {
+        std::vector<Slot> slots(slots_.size() * 2);
+        const std::size_t mask = slots.size() - 1;
+        for (std::uint32_t id = 1; id < count_; ++id)
+        {
+            const std::uint32_t hash = EntryFor(id).hash;
+            std::size_t index = hash & mask;
+            while (slots[index].id != kEmptyId)
+            {
+                index = (index + 1) & mask;
+            }
+            slots[index] = Slot{hash, id};
+        }
+        slots_.swap(slots);
+    }
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rvrse::core
+{
+    // Process-lifetime pool of immutable strings. Each distinct text is
+    // stored once, terminated, in chunks that never move, and is named by a
+    // 32-bit id, so snapshots hold ids instead of copies and equal names
+    // compare as integers. Interning text the pool already has (every name
+    // after the first capture) takes a shared lock and allocates nothing;
+    // reading an id's text takes no lock at all.
+    //
+    // Text is kept as UTF-8, which exporters write as is. A wide copy, for
+    // the Win32 UI and the wchar_t plugin views, is converted the first time
+    // Wide() asks for it and kept beside the UTF-8, so a headless agent
+    // never pays for one.
+    //
+    // Nothing is ever released: image names and module paths on a host are
+    // a small, slowly growing set, so the pool is bounded by the distinct
+    // strings seen rather than by the number of captures. That only holds
+    // for text captured locally; names decoded from other hosts belong in
+    // a table their connection owns (see WireDecoder), not in Global().
+    class StringInterner
+    {
+    public:
+        // Id 0 is the empty string.
+        static constexpr std::uint32_t kEmptyId = 0;
+        static constexpr std::uint32_t kBlockSize = 4096;
+        static constexpr std::uint32_t kMaxBlocks = 4096;
+        static constexpr std::uint32_t kMaxStrings = kBlockSize * kMaxBlocks;
+
+        // maxStrings, counting the empty string, is capped at kMaxStrings.
+        explicit StringInterner(std::uint32_t maxStrings = kMaxStrings);
+        StringInterner(const StringInterner &) = delete;
+        StringInterner &operator=(const StringInterner &) = delete;
+
+        // The pool behind InternedString.
+        static StringInterner &Global();
+
+        // Return kEmptyId for empty text, and also for new text once the
+        // pool is full; Rejected() counts the latter. Invalid UTF-8 and
+        // unpaired surrogates become U+FFFD, so every stored string is valid
+        // UTF-8.
+        std::uint32_t Intern(std::wstring_view text);
+        std::uint32_t InternUtf8(std::string_view text);
+
+        // Terminated text of an id returned by Intern(); the pointers stay
+        // valid for the life of the pool.
+        std::string_view Utf8(std::uint32_t id) const;
+        std::wstring_view Wide(std::uint32_t id) const;
+
+        // Distinct strings stored, counting the empty one; bytes allocated
+        // for their UTF-8 text and for the wide copies made so far.
+        std::size_t Size() const;
+        std::size_t Utf8Bytes() const;
+        std::size_t WideBytes() const;
+
+        // Interns of new text refused because the pool was full.
+        std::uint64_t Rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Entry
+        {
+            const char *text = nullptr;
+            std::uint32_t length = 0;
+            std::uint32_t hash = 0;
+
+            // Null until the first Wide(); wideLength is written before the
+            // pointer is published.
+            mutable std::atomic<const wchar_t *> wide{nullptr};
+            mutable std::uint32_t wideLength = 0;
+        };
+
+        // Open-addressed table of ids; the hash is kept beside the id so a
+        // probe only touches the text of likely matches.
+        struct Slot
+        {
+            std::uint32_t hash = 0;
+            std::uint32_t id = kEmptyId;
+        };
+
+        // Bump allocator of terminated strings over chunks that never move.
+        template <typename Char>
+        struct Arena
+        {
+            std::vector<std::unique_ptr<Char[]>> chunks;
+            Char *cursor = nullptr;
+            std::size_t remaining = 0;
+            std::size_t bytes = 0;
+
+            const Char *Store(std::basic_string_view<Char> text);
+        };
+
+        static std::uint32_t Hash(std::string_view text);
+
+        const Entry &EntryFor(std::uint32_t id) const { return blocks_[id / kBlockSize][id % kBlockSize]; }
+        std::uint32_t InternValid(std::string_view text);
+        std::uint32_t Find(std::string_view text, std::uint32_t hash) const;
+        std::wstring_view Widen(const Entry &entry) const;
+        void Grow();
+
+        // Blocks are allocated under the lock and never move, so a reader
+        // holding an id reaches its entry without one.
+        std::array<std::unique_ptr<Entry[]>, kMaxBlocks> blocks_;
+        std::vector<Slot> slots_;
+        Arena<char> text_;
+        mutable Arena<wchar_t> wideText_;
+        std::uint32_t count_ = 0;
+        std::uint32_t maxStrings_;
+        std::atomic<std::uint64_t> rejected_{0};
+        mutable std::shared_mutex mutex_;
+    };
+
+    inline StringInterner &StringInterner::Global()
+    {
+        static StringInterner interner;
+        return interner;
+    }
+
+    inline std::string_view StringInterner::Utf8(std::uint32_t id) const
+    {
+        const Entry &entry = EntryFor(id);
+        return std::string_view(entry.text, entry.length);
+    }
+
+    inline std::wstring_view StringInterner::Wide(std::uint32_t id) const
+    {
+        const Entry &entry = EntryFor(id);
+        const wchar_t *wide = entry.wide.load(std::memory_order_acquire);
+        return wide ? std::wstring_view(wide, entry.wideLength) : Widen(entry);
+    }
+
+    // A string held in StringInterner::Global() by id: four bytes, copied
+    // and compared as an integer. Utf8() is the stored text; the wide
+    // accessors, and the conversion to std::wstring_view that lets it stand
+    // in for the std::wstring fields it replaced, go through Wide().
+    class InternedString
+    {
+    public:
+        InternedString() = default;
+        InternedString(std::wstring_view text) : id_(StringInterner::Global().Intern(text)) {}
+        InternedString(const std::wstring &text) : InternedString(std::wstring_view(text)) {}
+        InternedString(const wchar_t *text) : InternedString(std::wstring_view(text)) {}
+
+        static InternedString FromUtf8(std::string_view text)
+        {
+            InternedString result;
+            result.id_ = StringInterner::Global().InternUtf8(text);
+            return result;
+        }
+
+        std::uint32_t Id() const { return id_; }
+
+        // Terminated UTF-8.
+        std::string_view Utf8() const { return StringInterner::Global().Utf8(id_); }
+
+        std::wstring_view View() const { return StringInterner::Global().Wide(id_); }
+        operator std::wstring_view() const { return View(); }
+
+        const wchar_t *c_str() const { return View().data(); }
+        const wchar_t *data() const { return c_str(); }
+        std::size_t size() const { return View().size(); }
+        bool empty() const { return id_ == StringInterner::kEmptyId; }
+
+        friend bool operator==(InternedString lhs, InternedString rhs) { return lhs.id_ == rhs.id_; }
+        friend bool operator!=(InternedString lhs, InternedString rhs) { return lhs.id_ != rhs.id_; }
+
+    private:
+        std::uint32_t id_ = StringInterner::kEmptyId;
+    };
+}
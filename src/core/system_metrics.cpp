@@ -0,0 +1,193 @@
+#include "system_metrics.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include "procfs.h"
+#endif
+
+#include "column_reduce.h"
+
+namespace
+{
+#if defined(_WIN32)
+    std::uint64_t ToUInt64(const FILETIME &time)
+    {
+        ULARGE_INTEGER value{};
+        value.LowPart = time.dwLowDateTime;
+        value.HighPart = time.dwHighDateTime;
+        return value.QuadPart;
+    }
+
+    bool QueryPhysicalMemory(std::uint64_t &total, std::uint64_t &available)
+    {
+        MEMORYSTATUSEX memoryStatus{};
+        memoryStatus.dwLength = sizeof(memoryStatus);
+        if (!GlobalMemoryStatusEx(&memoryStatus))
+        {
+            return false;
+        }
+
+        total = memoryStatus.ullTotalPhys;
+        available = memoryStatus.ullAvailPhys;
+        return true;
+    }
+
+    // Kernel time includes idle time, matching GetSystemTimes().
+    bool QueryCpuTimes(std::uint64_t &idle, std::uint64_t &kernel, std::uint64_t &user)
+    {
+        FILETIME idleTime{}, kernelTime{}, userTime{};
+        if (!GetSystemTimes(&idleTime, &kernelTime, &userTime))
+        {
+            return false;
+        }
+
+        idle = ToUInt64(idleTime);
+        kernel = ToUInt64(kernelTime);
+        user = ToUInt64(userTime);
+        return true;
+    }
+
+    std::uint64_t QueryUptimeMilliseconds()
+    {
+        return GetTickCount64();
+    }
+#else
+    bool QueryPhysicalMemory(std::uint64_t &total, std::uint64_t &available)
+    {
+        std::string contents;
+        if (!rvrse::core::procfs::ReadFile("/proc/meminfo", contents))
+        {
+            return false;
+        }
+
+        // "MemTotal:  16318480 kB"
+        bool haveTotal = false;
+        bool haveAvailable = false;
+        std::string_view text(contents);
+        while (!text.empty() && !(haveTotal && haveAvailable))
+        {
+            const std::string_view key = rvrse::core::procfs::NextToken(text);
+            std::uint64_t kilobytes = 0;
+            if (!rvrse::core::procfs::ParseUnsigned(text, kilobytes))
+            {
+                break;
+            }
+            rvrse::core::procfs::SkipTokens(text, 1);
+
+            if (key == "MemTotal:")
+            {
+                total = kilobytes * 1024;
+                haveTotal = true;
+            }
+            else if (key == "MemAvailable:")
+            {
+                available = kilobytes * 1024;
+                haveAvailable = true;
+            }
+        }
+
+        return haveTotal && haveAvailable;
+    }
+
+    // Reshapes the aggregate "cpu" line of /proc/stat into GetSystemTimes()
+    // terms: idle includes iowait and kernel includes idle.
+    bool QueryCpuTimes(std::uint64_t &idle, std::uint64_t &kernel, std::uint64_t &user)
+    {
+        std::string contents;
+        if (!rvrse::core::procfs::ReadFile("/proc/stat", contents))
+        {
+            return false;
+        }
+
+        std::string_view text(contents);
+        if (rvrse::core::procfs::NextToken(text) != "cpu")
+        {
+            return false;
+        }
+
+        // user nice system idle iowait irq softirq steal
+        std::uint64_t fields[8] = {};
+        for (auto &field : fields)
+        {
+            if (!rvrse::core::procfs::ParseUnsigned(text, field))
+            {
+                return false;
+            }
+        }
+
+        idle = fields[3] + fields[4];
+        user = fields[0] + fields[1];
+        kernel = fields[2] + fields[5] + fields[6] + fields[7] + idle;
+        return true;
+    }
+
+    std::uint64_t QueryUptimeMilliseconds()
+    {
+        timespec now{};
+        clock_gettime(CLOCK_BOOTTIME, &now);
+        return static_cast<std::uint64_t>(now.tv_sec) * 1000ULL + static_cast<std::uint64_t>(now.tv_nsec) / 1'000'000ULL;
+    }
+#endif
+}
+
+namespace rvrse::core
+{
+    SystemMetrics SystemMetricsSampler::Sample(const ProcessSnapshot &processes,
+                                               const HandleSnapshot &handles,
+                                               const NetworkSnapshot &network)
+    {
+        SystemMetrics metrics{};
+
+        std::uint64_t totalMemory = 0;
+        std::uint64_t availableMemory = 0;
+        if (QueryPhysicalMemory(totalMemory, availableMemory) && totalMemory > 0)
+        {
+            std::uint64_t used = totalMemory - std::min(availableMemory, totalMemory);
+            metrics.physicalMemoryTotalBytes = totalMemory;
+            metrics.physicalMemoryAvailableBytes = availableMemory;
+            metrics.memoryUsagePercent = (static_cast<double>(used) / static_cast<double>(totalMemory)) * 100.0;
+        }
+
+        double cpuPercent = lastCpuPercent_;
+        std::uint64_t idle64 = 0;
+        std::uint64_t kernel64 = 0;
+        std::uint64_t user64 = 0;
+        if (QueryCpuTimes(idle64, kernel64, user64))
+        {
+            if (hasCpuBaseline_)
+            {
+                // Kernel time includes idle time, so busy = (kernel + user) - idle.
+                std::uint64_t idleDelta = idle64 - previousIdleTime_;
+                std::uint64_t total = (kernel64 - previousKernelTime_) + (user64 - previousUserTime_);
+                if (total > 0 && idleDelta <= total)
+                {
+                    cpuPercent = (static_cast<double>(total - idleDelta) / static_cast<double>(total)) * 100.0;
+                }
+            }
+
+            previousIdleTime_ = idle64;
+            previousKernelTime_ = kernel64;
+            previousUserTime_ = user64;
+            hasCpuBaseline_ = true;
+        }
+
+        lastCpuPercent_ = std::clamp(cpuPercent, 0.0, 100.0);
+        metrics.cpuUsagePercent = lastCpuPercent_;
+        metrics.memoryUsagePercent = std::clamp(metrics.memoryUsagePercent, 0.0, 100.0);
+        metrics.uptimeMilliseconds = QueryUptimeMilliseconds();
+
+        metrics.processCount = processes.Processes().size();
+        metrics.threadCount = SummarizeColumn(processes.Arrays().threadCounts).sum;
+        metrics.handleCount = handles.Handles().size();
+        metrics.connectionCount = network.Connections().size();
+
+        return metrics;
+    }
+}
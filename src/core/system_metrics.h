@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "handle_snapshot.h"
+#include "network_snapshot.h"
+#include "process_snapshot.h"
+
+namespace rvrse::core
+{
+    // Layout is shared with RvrseSystemMetrics (plugin_api.h); keep the two in sync.
+    struct SystemMetrics
+    {
+        double cpuUsagePercent = 0.0;
+        double memoryUsagePercent = 0.0;
+        std::uint64_t physicalMemoryTotalBytes = 0;
+        std::uint64_t physicalMemoryAvailableBytes = 0;
+        std::uint64_t uptimeMilliseconds = 0;
+        std::uint64_t processCount = 0;
+        std::uint64_t threadCount = 0;
+        std::uint64_t handleCount = 0;
+        std::uint64_t connectionCount = 0;
+    };
+
+    // Computes system-wide CPU/memory figures. CPU usage is derived from the
+    // delta against the previous Sample() call, so the first sample reports 0%.
+    class SystemMetricsSampler
+    {
+    public:
+        SystemMetrics Sample(const ProcessSnapshot &processes,
+                             const HandleSnapshot &handles,
+                             const NetworkSnapshot &network);
+
+    private:
+        std::uint64_t previousIdleTime_ = 0;
+        std::uint64_t previousKernelTime_ = 0;
+        std::uint64_t previousUserTime_ = 0;
+        bool hasCpuBaseline_ = false;
+        double lastCpuPercent_ = 0.0;
+    };
+}
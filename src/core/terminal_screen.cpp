@@ -0,0 +1,248 @@
+#include "terminal_screen.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    // Unchanged cells inside a run are rewritten rather than skipped when
+    // the gap is shorter than a cursor move ("\x1b[rr;ccH").
+    constexpr int kMaxRewrittenGap = 6;
+
+    char32_t Printable(char32_t ch)
+    {
+        if (ch < 0x20 || (ch >= 0x7F && ch < 0xA0) || (ch >= 0xD800 && ch < 0xE000) || ch > 0x10FFFF)
+        {
+            return U'?';
+        }
+        return ch;
+    }
+
+    void AppendUtf8(std::string &out, char32_t ch)
+    {
+        if (ch < 0x80)
+        {
+            out.push_back(static_cast<char>(ch));
+        }
+        else if (ch < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (ch >> 6)));
+            out.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+        }
+        else if (ch < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (ch >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (ch >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+        }
+    }
+
+    void AppendCursorMove(std::string &out, int column, int row)
+    {
+        char sequence[32];
+        const int length = std::snprintf(sequence, sizeof(sequence), "\x1b[%d;%dH", row + 1, column + 1);
+        out.append(sequence, static_cast<std::size_t>(length));
+    }
+
+    void AppendAttributes(std::string &out, std::uint8_t attributes)
+    {
+        out += "\x1b[0";
+        if (attributes & rvrse::core::kScreenBold)
+        {
+            out += ";1";
+        }
+        if (attributes & rvrse::core::kScreenDim)
+        {
+            out += ";2";
+        }
+        if (attributes & rvrse::core::kScreenReverse)
+        {
+            out += ";7";
+        }
+        out.push_back('m');
+    }
+}
+
+namespace rvrse::core
+{
+    void TerminalScreen::Resize(int columns, int rows)
+    {
+        columns_ = std::max(columns, 0);
+        rows_ = std::max(rows, 0);
+        const std::size_t cells = static_cast<std::size_t>(columns_) * static_cast<std::size_t>(rows_);
+        front_.assign(cells, ScreenCell{});
+        back_.assign(cells, ScreenCell{});
+        fullRedraw_ = true;
+    }
+
+    void TerminalScreen::Clear()
+    {
+        std::fill(back_.begin(), back_.end(), ScreenCell{});
+    }
+
+    int TerminalScreen::Put(int column, int row, std::wstring_view text, std::uint8_t attributes)
+    {
+        if (row < 0 || row >= rows_ || column < 0)
+        {
+            return 0;
+        }
+
+        int written = 0;
+        for (std::size_t index = 0; index < text.size() && column + written < columns_; ++index)
+        {
+            char32_t ch = static_cast<char32_t>(text[index]);
+
+            // UTF-16 wchar_t (Windows): join surrogate pairs.
+            if (sizeof(wchar_t) == 2 && ch >= 0xD800 && ch < 0xDC00 && index + 1 < text.size())
+            {
+                const char32_t low = static_cast<char32_t>(text[index + 1]);
+                if (low >= 0xDC00 && low < 0xE000)
+                {
+                    ch = 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+                    ++index;
+                }
+            }
+
+            back_[Offset(column + written, row)] = ScreenCell{Printable(ch), attributes};
+            ++written;
+        }
+        return written;
+    }
+
+    int TerminalScreen::PutUtf8(int column, int row, std::string_view text, std::uint8_t attributes)
+    {
+        if (row < 0 || row >= rows_ || column < 0)
+        {
+            return 0;
+        }
+
+        int written = 0;
+        for (std::size_t index = 0; index < text.size() && column + written < columns_;)
+        {
+            const auto lead = static_cast<unsigned char>(text[index++]);
+            char32_t ch = lead;
+            if (lead >= 0x80)
+            {
+                const std::size_t extra = lead >= 0xF8 ? 0 : (lead >= 0xF0 ? 3 : (lead >= 0xE0 ? 2 : (lead >= 0xC0 ? 1 : 0)));
+                ch = extra == 0 ? U'?' : static_cast<char32_t>(lead & (0x3Fu >> extra));
+                for (std::size_t count = 0; count < extra; ++count)
+                {
+                    if (index == text.size() || (static_cast<unsigned char>(text[index]) & 0xC0) != 0x80)
+                    {
+                        ch = U'?';
+                        break;
+                    }
+                    ch = (ch << 6) | (static_cast<unsigned char>(text[index++]) & 0x3Fu);
+                }
+            }
+
+            back_[Offset(column + written, row)] = ScreenCell{Printable(ch), attributes};
+            ++written;
+        }
+        return written;
+    }
+
+    void TerminalScreen::Fill(int column, int row, int count, char32_t ch, std::uint8_t attributes)
+    {
+        if (row < 0 || row >= rows_)
+        {
+            return;
+        }
+
+        const int begin = std::max(column, 0);
+        const int end = std::min(column + count, columns_);
+        const ScreenCell cell{Printable(ch), attributes};
+        for (int current = begin; current < end; ++current)
+        {
+            back_[Offset(current, row)] = cell;
+        }
+    }
+
+    std::size_t TerminalScreen::Render(std::string &out)
+    {
+        if (fullRedraw_)
+        {
+            // After the clear the terminal shows blank cells, which is what
+            // front_ is reset to; only non-blank cells are written below.
+            out += "\x1b[0m\x1b[2J";
+            std::fill(front_.begin(), front_.end(), ScreenCell{});
+            fullRedraw_ = false;
+        }
+
+        // Where the cursor is and which attributes are active are not
+        // assumed across frames; the first run of a frame sets both.
+        int cursorColumn = -1;
+        int cursorRow = -1;
+        int activeAttributes = -1;
+        std::size_t changed = 0;
+
+        for (int row = 0; row < rows_; ++row)
+        {
+            const std::size_t rowOffset = Offset(0, row);
+            int column = 0;
+            while (column < columns_)
+            {
+                if (back_[rowOffset + column] == front_[rowOffset + column])
+                {
+                    ++column;
+                    continue;
+                }
+
+                int end = column + 1;
+                for (int next = end, gap = 0; next < columns_ && gap <= kMaxRewrittenGap; ++next)
+                {
+                    if (back_[rowOffset + next] != front_[rowOffset + next])
+                    {
+                        end = next + 1;
+                        gap = 0;
+                    }
+                    else
+                    {
+                        ++gap;
+                    }
+                }
+
+                if (cursorRow != row || cursorColumn != column)
+                {
+                    AppendCursorMove(out, column, row);
+                }
+
+                for (int current = column; current < end; ++current)
+                {
+                    ScreenCell &shown = front_[rowOffset + current];
+                    const ScreenCell &wanted = back_[rowOffset + current];
+                    if (shown != wanted)
+                    {
+                        ++changed;
+                    }
+                    if (activeAttributes != wanted.attributes)
+                    {
+                        AppendAttributes(out, wanted.attributes);
+                        activeAttributes = wanted.attributes;
+                    }
+                    AppendUtf8(out, wanted.ch);
+                    shown = wanted;
+                }
+
+                // The terminal's cursor is left pending-wrap after the last
+                // column; don't guess where it went.
+                cursorRow = row;
+                cursorColumn = end < columns_ ? end : -1;
+                column = end;
+            }
+        }
+
+        if (activeAttributes > 0)
+        {
+            out += "\x1b[0m";
+        }
+        return changed;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rvrse::core
+{
+    // Cell attributes; combine with |.
+    enum ScreenAttribute : std::uint8_t
+    {
+        kScreenNormal = 0x00,
+        kScreenBold = 0x01,
+        kScreenDim = 0x02,
+        kScreenReverse = 0x04,
+    };
+
+    struct ScreenCell
+    {
+        char32_t ch = U' ';
+        std::uint8_t attributes = kScreenNormal;
+
+        bool operator==(const ScreenCell &other) const { return ch == other.ch && attributes == other.attributes; }
+        bool operator!=(const ScreenCell &other) const { return !(*this == other); }
+    };
+
+    // Damage-tracked character grid for ANSI/VT terminals. Callers redraw
+    // the whole frame into the back buffer every refresh; Render() compares
+    // it with what the terminal already shows and emits cursor moves, SGR
+    // attribute changes and UTF-8 text for the changed cells only, so an
+    // unchanged frame costs no output at all.
+    //
+    // Every code point takes one column; control characters and unpaired
+    // surrogates are shown as '?'.
+    class TerminalScreen
+    {
+    public:
+        // Clears both buffers and forces a full redraw.
+        void Resize(int columns, int rows);
+
+        int Columns() const { return columns_; }
+        int Rows() const { return rows_; }
+
+        // Blanks the back buffer; the terminal is untouched until Render().
+        void Clear();
+
+        // Writes text from (column, row), clipped at the right edge.
+        // Returns the number of columns written.
+        int Put(int column, int row, std::wstring_view text, std::uint8_t attributes = kScreenNormal);
+
+        // The same for UTF-8, such as interned process names, without a
+        // wide copy; malformed sequences are shown as '?'.
+        int PutUtf8(int column, int row, std::string_view text, std::uint8_t attributes = kScreenNormal);
+        void Fill(int column, int row, int count, char32_t ch, std::uint8_t attributes = kScreenNormal);
+
+        const ScreenCell &At(int column, int row) const { return back_[Offset(column, row)]; }
+
+        // The next Render() clears the terminal and repaints everything; for
+        // when something else wrote to it.
+        void Invalidate() { fullRedraw_ = true; }
+
+        // Appends the escape sequences that bring the terminal up to date
+        // with the back buffer and returns the number of cells that changed.
+        std::size_t Render(std::string &out);
+
+    private:
+        std::size_t Offset(int column, int row) const
+        {
+            return static_cast<std::size_t>(row) * static_cast<std::size_t>(columns_) + static_cast<std::size_t>(column);
+        }
+
+        int columns_ = 0;
+        int rows_ = 0;
+        std::vector<ScreenCell> front_;
+        std::vector<ScreenCell> back_;
+        bool fullRedraw_ = true;
+    };
+}
@@ -0,0 +1,111 @@
+#include "wire_client.h"
+
+namespace
+{
+    constexpr std::size_t kReceiveChunkBytes = 64 * 1024;
+}
+
+namespace rvrse::core
+{
+    bool WireClient::Connect(const SocketEndpoint &endpoint, std::chrono::milliseconds timeout)
+    {
+        Close();
+        if (!socket_.Connect(endpoint))
+        {
+            return false;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            const WireStreamReader::Status parsed = reader_.Next();
+            if (parsed == WireStreamReader::Status::HelloReceived)
+            {
+                return true;
+            }
+            if (parsed == WireStreamReader::Status::ProtocolError)
+            {
+                Close();
+                return false;
+            }
+
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            ReadStatus status = ReadStatus::Timeout;
+            if (remaining.count() <= 0 || !Fill(remaining, status))
+            {
+                Close();
+                return false;
+            }
+        }
+    }
+
+    void WireClient::Close()
+    {
+        socket_.Close();
+        reader_.Reset();
+    }
+
+    WireClient::ReadStatus WireClient::ReadFrame(std::chrono::milliseconds timeout)
+    {
+        if (!socket_.IsOpen())
+        {
+            return ReadStatus::Disconnected;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            switch (reader_.Next())
+            {
+            case WireStreamReader::Status::FrameApplied:
+                ++framesApplied_;
+                return ReadStatus::FrameApplied;
+            case WireStreamReader::Status::ProtocolError:
+            case WireStreamReader::Status::HelloReceived:
+                // A second hello cannot happen on a healthy stream.
+                socket_.Close();
+                return ReadStatus::ProtocolError;
+            case WireStreamReader::Status::NeedMoreData:
+                break;
+            }
+
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+            {
+                return ReadStatus::Timeout;
+            }
+
+            ReadStatus status = ReadStatus::Timeout;
+            if (!Fill(remaining, status))
+            {
+                return status;
+            }
+        }
+    }
+
+    bool WireClient::Fill(std::chrono::milliseconds timeout, ReadStatus &status)
+    {
+        std::uint8_t *space = reader_.PrepareReceive(kReceiveChunkBytes);
+
+        const auto started = std::chrono::steady_clock::now();
+        const std::ptrdiff_t received = socket_.Receive(space, kReceiveChunkBytes, timeout);
+        if (received > 0)
+        {
+            reader_.Commit(static_cast<std::size_t>(received));
+            bytesReceived_ += static_cast<std::uint64_t>(received);
+            return true;
+        }
+
+        // Receive() reports both timeouts and errors as -1; returning well
+        // before the timeout means the socket failed.
+        if (received == 0 || std::chrono::steady_clock::now() - started + std::chrono::milliseconds(1) < timeout)
+        {
+            socket_.Close();
+            status = ReadStatus::Disconnected;
+            return false;
+        }
+
+        status = ReadStatus::Timeout;
+        return false;
+    }
+}
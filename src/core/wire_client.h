@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "socket.h"
+#include "wire_protocol.h"
+
+namespace rvrse::core
+{
+    // Viewer end of the "wire" exporter's stream: connects, checks the
+    // hello, and reads frames into a WireDecoder, which keeps the
+    // reconstructed process and connection tables. After a disconnect or
+    // protocol error State() keeps the last good tables until the next
+    // Connect().
+    class WireClient
+    {
+    public:
+        enum class ReadStatus
+        {
+            FrameApplied,
+            Timeout,
+            Disconnected,
+            ProtocolError
+        };
+
+        // Fails if nothing listens at endpoint, or it does not answer with a
+        // wire hello of a supported version within timeout.
+        bool Connect(const SocketEndpoint &endpoint, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+        void Close();
+        bool IsConnected() const { return socket_.IsOpen(); }
+
+        // Waits up to timeout for the next frame and applies it. After
+        // ProtocolError or Disconnected the connection is closed.
+        ReadStatus ReadFrame(std::chrono::milliseconds timeout);
+
+        const WireDecoder &State() const { return reader_.State(); }
+
+        // The host name the collector sent in its hello, if any.
+        const std::wstring &HostName() const { return reader_.HostName(); }
+        std::uint64_t BytesReceived() const { return bytesReceived_; }
+        std::uint64_t FramesApplied() const { return framesApplied_; }
+
+    private:
+        bool Fill(std::chrono::milliseconds timeout, ReadStatus &status);
+
+        Socket socket_;
+        WireStreamReader reader_;
+
+        std::uint64_t bytesReceived_ = 0;
+        std::uint64_t framesApplied_ = 0;
+    };
+}
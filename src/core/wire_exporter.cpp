@@ -0,0 +1,226 @@
+#include "wire_exporter.h"
+
+#include <utility>
+
+namespace
+{
+    // How often the server thread looks for new viewers while idle.
+    constexpr std::chrono::milliseconds kAcceptPollInterval{100};
+}
+
+namespace rvrse::core
+{
+    WireExporter::WireExporter(WireOptions options)
+        : options_(std::move(options)),
+          encoder_(options_.keyframeInterval)
+    {
+    }
+
+    WireExporter::~WireExporter()
+    {
+        Stop();
+    }
+
+    bool WireExporter::Start()
+    {
+        Stop();
+
+        if (options_.push.empty())
+        {
+            SocketEndpoint endpoint;
+            if (!ParseSocketEndpoint(options_.listen, endpoint) || !listener_.Listen(endpoint))
+            {
+                return false;
+            }
+            port_ = listener_.LocalPort();
+        }
+        else if (!ParseSocketEndpoint(options_.push, upstream_) ||
+                 (upstream_.kind == SocketEndpoint::Kind::Tcp && upstream_.port == 0))
+        {
+            return false;
+        }
+
+        hello_.clear();
+        wire::AppendHello(hello_, options_.hostName);
+        nextConnectAttempt_ = {};
+        encoder_.ForceKeyframe();
+        stopRequested_ = false;
+        running_ = true;
+        thread_ = std::thread(&WireExporter::ServeLoop, this);
+        return true;
+    }
+
+    void WireExporter::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopRequested_ = true;
+        }
+        wake_.notify_all();
+
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+
+        viewers_.clear();
+        joining_.clear();
+        viewerCount_.store(0, std::memory_order_relaxed);
+        listener_.Close();
+        port_ = 0;
+        running_ = false;
+    }
+
+    void WireExporter::Export(const CollectorFrame &frame)
+    {
+        if (!running_)
+        {
+            return;
+        }
+
+        // Nobody to send to: skip the encode and start the next viewer's
+        // stream with a keyframe.
+        if (viewerCount_.load(std::memory_order_relaxed) == 0)
+        {
+            encoder_.ForceKeyframe();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pendingReady_ || sending_)
+            {
+                generationsDropped_.fetch_add(1, std::memory_order_relaxed);
+                encoder_.ForceKeyframe();
+                return;
+            }
+        }
+
+        if (keyframeRequested_.exchange(false, std::memory_order_relaxed))
+        {
+            encoder_.ForceKeyframe();
+        }
+
+        encoding_.clear();
+        const bool keyframe = encoder_.Encode(frame, encoding_);
+        framesEncoded_.fetch_add(1, std::memory_order_relaxed);
+        bytesEncoded_.fetch_add(encoding_.size(), std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(encoding_, pending_);
+            pendingKeyframe_ = keyframe;
+            pendingReady_ = true;
+        }
+        wake_.notify_one();
+    }
+
+    void WireExporter::ServeLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            wake_.wait_for(lock, kAcceptPollInterval, [this]()
+                           { return pendingReady_ || stopRequested_; });
+            if (stopRequested_)
+            {
+                return;
+            }
+
+            const bool haveFrame = pendingReady_;
+            pendingReady_ = false;
+            sending_ = haveFrame;
+            lock.unlock();
+
+            if (options_.push.empty())
+            {
+                AcceptViewers();
+            }
+            else
+            {
+                ConnectUpstream();
+            }
+            if (haveFrame)
+            {
+                SendFrame(pending_, pendingKeyframe_);
+            }
+
+            lock.lock();
+            sending_ = false;
+        }
+    }
+
+    void WireExporter::AcceptViewers()
+    {
+        Socket viewer;
+        while (listener_.Accept(viewer, std::chrono::milliseconds(0)))
+        {
+            if (viewers_.size() + joining_.size() >= options_.maxViewers)
+            {
+                viewer.Close();
+                continue;
+            }
+            AddViewer(std::move(viewer));
+        }
+        viewerCount_.store(viewers_.size() + joining_.size(), std::memory_order_relaxed);
+    }
+
+    void WireExporter::ConnectUpstream()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (!viewers_.empty() || !joining_.empty() || now < nextConnectAttempt_)
+        {
+            return;
+        }
+
+        nextConnectAttempt_ = now + kReconnectInterval;
+        Socket upstream;
+        if (upstream.Connect(upstream_))
+        {
+            AddViewer(std::move(upstream));
+        }
+        viewerCount_.store(viewers_.size() + joining_.size(), std::memory_order_relaxed);
+    }
+
+    void WireExporter::AddViewer(Socket viewer)
+    {
+        viewer.SetSendTimeout(kSendTimeout);
+        if (viewer.SendAll(hello_.data(), hello_.size()))
+        {
+            joining_.push_back(std::move(viewer));
+            keyframeRequested_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void WireExporter::SendFrame(const std::string &frame, bool keyframe)
+    {
+        // Joining viewers start at a keyframe; deltas would not apply.
+        if (keyframe)
+        {
+            for (Socket &viewer : joining_)
+            {
+                viewers_.push_back(std::move(viewer));
+            }
+            joining_.clear();
+        }
+
+        std::size_t kept = 0;
+        for (std::size_t index = 0; index < viewers_.size(); ++index)
+        {
+            if (!viewers_[index].SendAll(frame.data(), frame.size()))
+            {
+                viewers_[index].Close();
+                continue;
+            }
+
+            bytesSent_.fetch_add(frame.size(), std::memory_order_relaxed);
+            if (kept != index)
+            {
+                viewers_[kept] = std::move(viewers_[index]);
+            }
+            ++kept;
+        }
+        viewers_.resize(kept);
+        viewerCount_.store(viewers_.size() + joining_.size(), std::memory_order_relaxed);
+    }
+}
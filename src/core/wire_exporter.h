@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "collector.h"
+#include "socket.h"
+#include "wire_protocol.h"
+
+namespace rvrse::core
+{
+    struct WireOptions
+    {
+        // "tcp://address:port" (numeric address, "[::1]" for IPv6; port 0
+        // picks one) or "unix:/path/to.sock".
+        std::wstring listen = L"tcp://127.0.0.1:9465";
+
+        // When set, the exporter does not listen: it connects out to this
+        // endpoint (a fleet aggregator) and streams to it, reconnecting
+        // every kReconnectInterval while the connection is down.
+        std::wstring push;
+
+        // Sent in the hello so aggregators and viewers can tell collectors
+        // apart; empty sends none.
+        std::wstring hostName;
+
+        // Upper bound on frames between keyframes; joins and drops force
+        // one earlier.
+        std::uint32_t keyframeInterval = 60;
+
+        std::size_t maxViewers = 16;
+    };
+
+    // "wire" exporter: serves the binary snapshot + delta stream from
+    // wire_protocol.h to remote viewers. Each generation is encoded once on
+    // the sampling thread, and only while someone is connected; a server
+    // thread accepts viewers and sends the frame to all of them.
+    //
+    // Every viewer follows the same keyframe-delta chain. A viewer that
+    // joins is held back until the next frame, which is forced to be a
+    // keyframe; a frame that arrives while the previous one is still being
+    // sent is dropped and the next one is a keyframe too, so the sampler
+    // never waits on a slow network. A viewer that stops reading for
+    // kSendTimeout is disconnected.
+    //
+    // In push mode the one upstream connection is treated like a viewer
+    // that joins whenever it (re)connects.
+    class WireExporter final : public CollectorExporter
+    {
+    public:
+        static constexpr std::chrono::milliseconds kSendTimeout{2000};
+        static constexpr std::chrono::milliseconds kReconnectInterval{1000};
+
+        explicit WireExporter(WireOptions options = {});
+        ~WireExporter() override;
+
+        bool Start();
+        void Stop();
+
+        const wchar_t *Name() const override { return L"wire"; }
+        void Export(const CollectorFrame &frame) override;
+
+        // Bound TCP port (0 for Unix sockets and in push mode).
+        std::uint16_t Port() const { return port_; }
+
+        std::size_t ViewerCount() const { return viewerCount_.load(std::memory_order_relaxed); }
+        std::uint64_t FramesEncoded() const { return framesEncoded_.load(std::memory_order_relaxed); }
+        std::uint64_t BytesEncoded() const { return bytesEncoded_.load(std::memory_order_relaxed); }
+        std::uint64_t BytesSent() const { return bytesSent_.load(std::memory_order_relaxed); }
+        std::uint64_t GenerationsDropped() const { return generationsDropped_.load(std::memory_order_relaxed); }
+
+    private:
+        void ServeLoop();
+        void AcceptViewers();
+        void ConnectUpstream();
+        void AddViewer(Socket viewer);
+        void SendFrame(const std::string &frame, bool keyframe);
+
+        WireOptions options_;
+        WireEncoder encoder_;
+        Socket listener_;
+        std::uint16_t port_ = 0;
+        bool running_ = false;
+
+        // Owned by the server thread.
+        std::vector<Socket> viewers_;
+        std::vector<Socket> joining_;
+        std::string hello_;
+        SocketEndpoint upstream_;
+        std::chrono::steady_clock::time_point nextConnectAttempt_{};
+
+        // encoding_ belongs to the sampling thread; pending_ to the server
+        // thread while sending_ is set. They are swapped under mutex_.
+        std::string encoding_;
+        std::string pending_;
+        bool pendingKeyframe_ = false;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::thread thread_;
+        bool pendingReady_ = false;
+        bool sending_ = false;
+        bool stopRequested_ = false;
+
+        std::atomic<bool> keyframeRequested_{false};
+        std::atomic<std::size_t> viewerCount_{0};
+        std::atomic<std::uint64_t> framesEncoded_{0};
+        std::atomic<std::uint64_t> bytesEncoded_{0};
+        std::atomic<std::uint64_t> bytesSent_{0};
+        std::atomic<std::uint64_t> generationsDropped_{0};
+    };
+}
@@ -0,0 +1,868 @@
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "binary_codec.h"
+#include "rvrse/common/string_utils.h"
+
+namespace
+{
+    using rvrse::core::AddressFamily;
+    using rvrse::core::ConnectionEntry;
+    using rvrse::core::TransportProtocol;
+    using rvrse::core::codec::DecodeUtf8;
+    using rvrse::core::codec::PatchFixed32;
+    using rvrse::core::codec::PutDifference;
+    using rvrse::core::codec::PutDouble;
+    using rvrse::core::codec::PutFixed32;
+    using rvrse::core::codec::PutSigned;
+    using rvrse::core::codec::PutUtf8;
+    using rvrse::core::codec::PutVarint;
+    using rvrse::core::codec::Reader;
+
+    // Decoder name index of a process whose record never named it.
+    constexpr std::uint32_t kNoName = 0xFFFFFFFFU;
+
+    constexpr std::uint8_t kFrameKeyframe = 0x01;
+    constexpr std::uint8_t kFrameHasNetwork = 0x02;
+
+    // Delta record field mask, in the order the fields follow the mask.
+    constexpr std::uint8_t kFieldParent = 0x01;
+    constexpr std::uint8_t kFieldName = 0x02;
+    constexpr std::uint8_t kFieldThreads = 0x04;
+    constexpr std::uint8_t kFieldWorkingSet = 0x08;
+    constexpr std::uint8_t kFieldPrivate = 0x10;
+    constexpr std::uint8_t kFieldKernelTime = 0x20;
+    constexpr std::uint8_t kFieldUserTime = 0x40;
+    constexpr std::uint8_t kAllFields = 0x7F;
+
+    constexpr std::uint8_t kNetworkAccessDenied = 0x01;
+    constexpr std::uint8_t kNetworkCaptureFailed = 0x02;
+
+    constexpr std::uint8_t kConnectionUdp = 0x01;
+    constexpr std::uint8_t kConnectionIPv6 = 0x02;
+
+    // Wire order for connections: a total order over exactly the fields the
+    // stream carries, so producer and viewer diff the same way. (The
+    // NetworkSnapshot order stops at the ports.)
+    int CompareConnections(const ConnectionEntry &lhs, const ConnectionEntry &rhs)
+    {
+        if (lhs.owningProcessId != rhs.owningProcessId)
+        {
+            return lhs.owningProcessId < rhs.owningProcessId ? -1 : 1;
+        }
+        if (lhs.Protocol() != rhs.Protocol())
+        {
+            return lhs.Protocol() < rhs.Protocol() ? -1 : 1;
+        }
+        if (lhs.Family() != rhs.Family())
+        {
+            return lhs.Family() < rhs.Family() ? -1 : 1;
+        }
+        if (lhs.localPort != rhs.localPort)
+        {
+            return lhs.localPort < rhs.localPort ? -1 : 1;
+        }
+        if (lhs.remotePort != rhs.remotePort)
+        {
+            return lhs.remotePort < rhs.remotePort ? -1 : 1;
+        }
+        if (lhs.State() != rhs.State())
+        {
+            return lhs.State() < rhs.State() ? -1 : 1;
+        }
+
+        if (lhs.Family() == AddressFamily::IPv6)
+        {
+            const int local = std::memcmp(lhs.LocalAddress6(), rhs.LocalAddress6(), ConnectionEntry::kAddressBytes);
+            return local != 0 ? local : std::memcmp(lhs.RemoteAddress6(), rhs.RemoteAddress6(), ConnectionEntry::kAddressBytes);
+        }
+        if (lhs.LocalAddress() != rhs.LocalAddress())
+        {
+            return lhs.LocalAddress() < rhs.LocalAddress() ? -1 : 1;
+        }
+        if (lhs.RemoteAddress() != rhs.RemoteAddress())
+        {
+            return lhs.RemoteAddress() < rhs.RemoteAddress() ? -1 : 1;
+        }
+        return 0;
+    }
+
+    bool ConnectionWireLess(const ConnectionEntry &lhs, const ConnectionEntry &rhs)
+    {
+        return CompareConnections(lhs, rhs) < 0;
+    }
+
+    void PutConnection(std::string &out, const ConnectionEntry &connection)
+    {
+        const bool ipv6 = connection.Family() == AddressFamily::IPv6;
+        std::uint8_t flags = 0;
+        flags |= connection.Protocol() == TransportProtocol::Udp ? kConnectionUdp : 0;
+        flags |= ipv6 ? kConnectionIPv6 : 0;
+
+        out.push_back(static_cast<char>(flags));
+        out.push_back(static_cast<char>(connection.State()));
+        PutVarint(out, connection.owningProcessId);
+        PutVarint(out, connection.localPort);
+        PutVarint(out, connection.remotePort);
+        if (ipv6)
+        {
+            out.append(reinterpret_cast<const char *>(connection.LocalAddress6()), ConnectionEntry::kAddressBytes);
+            out.append(reinterpret_cast<const char *>(connection.RemoteAddress6()), ConnectionEntry::kAddressBytes);
+        }
+        else
+        {
+            PutFixed32(out, connection.LocalAddress());
+            PutFixed32(out, connection.RemoteAddress());
+        }
+    }
+
+    ConnectionEntry ReadConnection(Reader &reader)
+    {
+        ConnectionEntry connection;
+        const std::uint8_t flags = reader.Byte();
+        connection.SetProtocol((flags & kConnectionUdp) != 0 ? TransportProtocol::Udp : TransportProtocol::Tcp);
+        connection.SetFamily((flags & kConnectionIPv6) != 0 ? AddressFamily::IPv6 : AddressFamily::IPv4);
+        connection.SetState(reader.Byte());
+        connection.owningProcessId = reader.Varint32();
+
+        const std::uint32_t localPort = reader.Varint32();
+        const std::uint32_t remotePort = reader.Varint32();
+        if (localPort > 0xFFFF || remotePort > 0xFFFF)
+        {
+            reader.Fail();
+        }
+        connection.localPort = static_cast<std::uint16_t>(localPort);
+        connection.remotePort = static_cast<std::uint16_t>(remotePort);
+
+        if (connection.Family() == AddressFamily::IPv6)
+        {
+            if (const std::uint8_t *bytes = reader.Take(2 * ConnectionEntry::kAddressBytes))
+            {
+                connection.SetLocalAddress6(bytes);
+                connection.SetRemoteAddress6(bytes + ConnectionEntry::kAddressBytes);
+            }
+        }
+        else
+        {
+            connection.SetLocalAddress(reader.Fixed32());
+            connection.SetRemoteAddress(reader.Fixed32());
+        }
+        return connection;
+    }
+}
+
+namespace rvrse::core
+{
+    namespace wire
+    {
+        void AppendHello(std::string &out, const std::wstring &hostName)
+        {
+            std::string name;
+            PutUtf8(name, hostName);
+            if (name.size() > kMaxHostNameBytes)
+            {
+                // Cut at a character boundary.
+                std::size_t length = kMaxHostNameBytes;
+                while (length > 0 && (static_cast<std::uint8_t>(name[length]) & 0xC0) == 0x80)
+                {
+                    --length;
+                }
+                name.resize(length);
+            }
+
+            const std::uint16_t flags = name.empty() ? 0 : kHelloHostName;
+            PutFixed32(out, kMagic);
+            out.push_back(static_cast<char>(kVersion & 0xFF));
+            out.push_back(static_cast<char>(kVersion >> 8));
+            out.push_back(static_cast<char>(flags & 0xFF));
+            out.push_back(static_cast<char>(flags >> 8));
+            if (!name.empty())
+            {
+                out.push_back(static_cast<char>(name.size()));
+                out += name;
+            }
+        }
+    }
+
+    bool WireEncoder::Encode(const CollectorFrame &frame, std::string &out)
+    {
+        const bool keyframe = forceKeyframe_ || keyframeInterval_ <= 1 || framesSinceKeyframe_ + 1 >= keyframeInterval_;
+        forceKeyframe_ = false;
+        framesSinceKeyframe_ = keyframe ? 0 : framesSinceKeyframe_ + 1;
+        const bool hasNetwork = keyframe || frame.networkRefreshed;
+
+        const std::size_t lengthOffset = out.size();
+        PutFixed32(out, 0);
+        const std::size_t bodyOffset = out.size();
+
+        out.push_back(static_cast<char>((keyframe ? kFrameKeyframe : 0) | (hasNetwork ? kFrameHasNetwork : 0)));
+        PutVarint(out, frame.generation);
+        PutSigned(out, std::chrono::duration_cast<std::chrono::milliseconds>(frame.timestamp.time_since_epoch()).count());
+
+        const SystemMetrics &metrics = frame.metrics;
+        PutDouble(out, metrics.cpuUsagePercent);
+        PutDouble(out, metrics.memoryUsagePercent);
+        PutVarint(out, metrics.physicalMemoryTotalBytes);
+        PutVarint(out, metrics.physicalMemoryAvailableBytes);
+        PutVarint(out, metrics.uptimeMilliseconds);
+        PutVarint(out, metrics.processCount);
+        PutVarint(out, metrics.threadCount);
+        PutVarint(out, metrics.handleCount);
+        PutVarint(out, metrics.connectionCount);
+
+        EncodeProcesses(frame.processes, keyframe, out);
+        if (hasNetwork)
+        {
+            EncodeConnections(frame.network, keyframe, out);
+        }
+
+        PatchFixed32(out, lengthOffset, static_cast<std::uint32_t>(out.size() - bodyOffset));
+        return keyframe;
+    }
+
+    std::uint32_t WireEncoder::InternName(InternedString name, std::string &definitions, std::uint32_t &definitionCount)
+    {
+        const auto found = nameIndices_.find(name.Id());
+        if (found != nameIndices_.end())
+        {
+            return found->second;
+        }
+
+        const auto index = static_cast<std::uint32_t>(names_.size());
+        names_.push_back(name);
+        nameIndices_.emplace(name.Id(), index);
+
+        const std::string_view utf8 = name.Utf8();
+        PutVarint(definitions, utf8.size());
+        definitions += utf8;
+
+        ++definitionCount;
+        return index;
+    }
+
+    void WireEncoder::EncodeProcesses(const ProcessSnapshot &snapshot, bool keyframe, std::string &out)
+    {
+        const std::vector<ProcessEntry> &processes = snapshot.Processes();
+        const std::vector<std::uint64_t> &rowHashes = snapshot.Arrays().rowHashes;
+
+        if (keyframe)
+        {
+            names_.clear();
+            nameIndices_.clear();
+        }
+
+        nameDefinitions_.clear();
+        processRecords_.clear();
+        std::uint32_t definitionCount = 0;
+        std::size_t recordCount = 0;
+
+        current_.clear();
+        current_.reserve(processes.size());
+
+        exitRecords_.clear();
+        std::size_t exitCount = 0;
+        std::uint32_t lastExitId = 0;
+        std::uint32_t lastRecordId = 0;
+
+        auto previous = previous_.cbegin();
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            const ProcessEntry &process = processes[index];
+            for (; previous != previous_.cend() && previous->processId < process.processId; ++previous)
+            {
+                if (!keyframe)
+                {
+                    PutVarint(exitRecords_, previous->processId - lastExitId);
+                    lastExitId = previous->processId;
+                    ++exitCount;
+                }
+            }
+
+            const ProcessState *before = nullptr;
+            if (previous != previous_.cend() && previous->processId == process.processId)
+            {
+                before = &*previous;
+                ++previous;
+            }
+
+            // Same hash, same fields: nothing to diff or send.
+            if (!keyframe && before && before->rowHash == rowHashes[index])
+            {
+                current_.push_back(*before);
+                continue;
+            }
+
+            ProcessState state;
+            state.rowHash = rowHashes[index];
+            state.processId = process.processId;
+            state.parentProcessId = process.parentProcessId;
+            state.threadCount = process.threadCount;
+            state.workingSetBytes = process.workingSetBytes;
+            state.privateBytes = process.privateBytes;
+            state.kernelTime100ns = process.kernelTime100ns;
+            state.userTime100ns = process.userTime100ns;
+
+            // The previous index stays valid until the next keyframe, so an
+            // id compare replaces the table lookup for known processes.
+            if (!keyframe && before && names_[before->nameIndex] == process.imageName)
+            {
+                state.nameIndex = before->nameIndex;
+            }
+            else
+            {
+                state.nameIndex = InternName(process.imageName, nameDefinitions_, definitionCount);
+            }
+            current_.push_back(state);
+
+            if (keyframe)
+            {
+                PutVarint(processRecords_, state.processId - lastRecordId);
+                PutVarint(processRecords_, state.parentProcessId);
+                PutVarint(processRecords_, state.nameIndex);
+                PutVarint(processRecords_, state.threadCount);
+                PutVarint(processRecords_, state.workingSetBytes);
+                PutVarint(processRecords_, state.privateBytes);
+                PutVarint(processRecords_, state.kernelTime100ns);
+                PutVarint(processRecords_, state.userTime100ns);
+                lastRecordId = state.processId;
+                ++recordCount;
+                continue;
+            }
+
+            // New processes are diffed against all-zero fields.
+            const ProcessState base = before ? *before : ProcessState{};
+            std::uint8_t mask = before ? 0 : kAllFields;
+            mask |= state.parentProcessId != base.parentProcessId ? kFieldParent : 0;
+            mask |= state.nameIndex != base.nameIndex ? kFieldName : 0;
+            mask |= state.threadCount != base.threadCount ? kFieldThreads : 0;
+            mask |= state.workingSetBytes != base.workingSetBytes ? kFieldWorkingSet : 0;
+            mask |= state.privateBytes != base.privateBytes ? kFieldPrivate : 0;
+            mask |= state.kernelTime100ns != base.kernelTime100ns ? kFieldKernelTime : 0;
+            mask |= state.userTime100ns != base.userTime100ns ? kFieldUserTime : 0;
+            if (mask == 0)
+            {
+                continue;
+            }
+
+            PutVarint(processRecords_, state.processId - lastRecordId);
+            processRecords_.push_back(static_cast<char>(mask));
+            if (mask & kFieldParent)
+            {
+                PutVarint(processRecords_, state.parentProcessId);
+            }
+            if (mask & kFieldName)
+            {
+                PutVarint(processRecords_, state.nameIndex);
+            }
+            if (mask & kFieldThreads)
+            {
+                PutDifference(processRecords_, state.threadCount, base.threadCount);
+            }
+            if (mask & kFieldWorkingSet)
+            {
+                PutDifference(processRecords_, state.workingSetBytes, base.workingSetBytes);
+            }
+            if (mask & kFieldPrivate)
+            {
+                PutDifference(processRecords_, state.privateBytes, base.privateBytes);
+            }
+            if (mask & kFieldKernelTime)
+            {
+                PutDifference(processRecords_, state.kernelTime100ns, base.kernelTime100ns);
+            }
+            if (mask & kFieldUserTime)
+            {
+                PutDifference(processRecords_, state.userTime100ns, base.userTime100ns);
+            }
+            lastRecordId = state.processId;
+            ++recordCount;
+        }
+
+        for (; !keyframe && previous != previous_.cend(); ++previous)
+        {
+            PutVarint(exitRecords_, previous->processId - lastExitId);
+            lastExitId = previous->processId;
+            ++exitCount;
+        }
+
+        PutVarint(out, exitCount);
+        out += exitRecords_;
+        PutVarint(out, definitionCount);
+        out += nameDefinitions_;
+        PutVarint(out, recordCount);
+        out += processRecords_;
+
+        previous_.swap(current_);
+    }
+
+    void WireEncoder::EncodeConnections(const NetworkSnapshot &network, bool keyframe, std::string &out)
+    {
+        std::uint8_t flags = 0;
+        flags |= network.AccessDenied() ? kNetworkAccessDenied : 0;
+        flags |= network.CaptureFailed() ? kNetworkCaptureFailed : 0;
+        out.push_back(static_cast<char>(flags));
+
+        const auto &connections = network.Connections();
+        currentConnections_.assign(connections.begin(), connections.end());
+        std::sort(currentConnections_.begin(), currentConnections_.end(), ConnectionWireLess);
+
+        if (keyframe)
+        {
+            PutVarint(out, 0);
+            PutVarint(out, currentConnections_.size());
+            for (const ConnectionEntry &connection : currentConnections_)
+            {
+                PutConnection(out, connection);
+            }
+            previousConnections_.swap(currentConnections_);
+            return;
+        }
+
+        // Multiset difference of two sorted lists: removals are indices into
+        // the viewer's current list (gap-encoded), additions full entries.
+        std::size_t removedCount = 0;
+        std::size_t addedCount = 0;
+        std::size_t before = 0;
+        std::size_t after = 0;
+        while (before < previousConnections_.size() || after < currentConnections_.size())
+        {
+            const int order = before == previousConnections_.size()  ? 1
+                              : after == currentConnections_.size() ? -1
+                                                                     : CompareConnections(previousConnections_[before], currentConnections_[after]);
+            if (order < 0)
+            {
+                ++removedCount;
+                ++before;
+            }
+            else if (order > 0)
+            {
+                ++addedCount;
+                ++after;
+            }
+            else
+            {
+                ++before;
+                ++after;
+            }
+        }
+
+        PutVarint(out, removedCount);
+        std::size_t nextIndex = 0;
+        before = 0;
+        after = 0;
+        while (before < previousConnections_.size())
+        {
+            const int order = after == currentConnections_.size() ? -1 : CompareConnections(previousConnections_[before], currentConnections_[after]);
+            if (order < 0)
+            {
+                PutVarint(out, before - nextIndex);
+                nextIndex = before + 1;
+                ++before;
+            }
+            else
+            {
+                before += order == 0 ? 1 : 0;
+                ++after;
+            }
+        }
+
+        PutVarint(out, addedCount);
+        before = 0;
+        after = 0;
+        while (after < currentConnections_.size())
+        {
+            const int order = before == previousConnections_.size() ? 1 : CompareConnections(previousConnections_[before], currentConnections_[after]);
+            if (order > 0)
+            {
+                PutConnection(out, currentConnections_[after]);
+                ++after;
+            }
+            else
+            {
+                after += order == 0 ? 1 : 0;
+                ++before;
+            }
+        }
+
+        previousConnections_.swap(currentConnections_);
+    }
+
+    bool WireDecoder::Apply(const std::uint8_t *body, std::size_t size)
+    {
+        Reader reader(body, size);
+        const std::uint8_t flags = reader.Byte();
+        const bool keyframe = (flags & kFrameKeyframe) != 0;
+        const bool hasNetwork = (flags & kFrameHasNetwork) != 0;
+        if (!reader.Ok() || (!keyframe && !hasState_))
+        {
+            return false;
+        }
+
+        if (keyframe)
+        {
+            names_.clear();
+            processes_.clear();
+            nameIndices_.clear();
+            connections_.clear();
+        }
+
+        const std::uint64_t generation = reader.Varint();
+        const std::int64_t timestampMs = reader.Signed();
+
+        SystemMetrics metrics;
+        metrics.cpuUsagePercent = reader.Double();
+        metrics.memoryUsagePercent = reader.Double();
+        metrics.physicalMemoryTotalBytes = reader.Varint();
+        metrics.physicalMemoryAvailableBytes = reader.Varint();
+        metrics.uptimeMilliseconds = reader.Varint();
+        metrics.processCount = reader.Varint();
+        metrics.threadCount = reader.Varint();
+        metrics.handleCount = reader.Varint();
+        metrics.connectionCount = reader.Varint();
+
+        // Exited PIDs, gap-encoded and ascending.
+        exits_.assign(reader.Count(), 0);
+        std::uint32_t pid = 0;
+        for (std::uint32_t &exitId : exits_)
+        {
+            pid += reader.Varint32();
+            exitId = pid;
+        }
+
+        const std::size_t definitionCount = reader.Count();
+        for (std::size_t index = 0; index < definitionCount && reader.Ok(); ++index)
+        {
+            const std::size_t length = reader.Count();
+            if (const std::uint8_t *bytes = reader.Take(length))
+            {
+                const std::string_view text(reinterpret_cast<const char *>(bytes), length);
+                if (rvrse::common::IsValidUtf8(text))
+                {
+                    names_.emplace_back(text);
+                }
+                else
+                {
+                    // Stored repaired, like StringInterner::InternUtf8().
+                    names_.emplace_back();
+                    PutUtf8(names_.back(), DecodeUtf8(bytes, length));
+                }
+            }
+        }
+
+        // Merge the PID-ordered records into the PID-ordered table, dropping
+        // exited processes on the way.
+        nextProcesses_.clear();
+        nextProcesses_.reserve(processes_.size() + 16);
+        nextNameIndices_.clear();
+        nextNameIndices_.reserve(processes_.size() + 16);
+        std::size_t old = 0;
+        std::size_t exit = 0;
+        const auto copyOldBelow = [&](std::uint64_t limit)
+        {
+            for (; old < processes_.size() && processes_[old].processId < limit; ++old)
+            {
+                while (exit < exits_.size() && exits_[exit] < processes_[old].processId)
+                {
+                    ++exit;
+                }
+                if (exit < exits_.size() && exits_[exit] == processes_[old].processId)
+                {
+                    continue;
+                }
+                nextProcesses_.push_back(std::move(processes_[old]));
+                nextNameIndices_.push_back(nameIndices_[old]);
+            }
+        };
+
+        const std::size_t recordCount = reader.Count();
+        pid = 0;
+        for (std::size_t index = 0; index < recordCount && reader.Ok(); ++index)
+        {
+            const std::uint32_t gap = reader.Varint32();
+            if ((index > 0 && gap == 0) || gap > 0xFFFFFFFFU - pid)
+            {
+                reader.Fail();
+                break;
+            }
+            pid += gap;
+            copyOldBelow(pid);
+
+            ProcessEntry entry;
+            std::uint32_t nameIndex = kNoName;
+            if (old < processes_.size() && processes_[old].processId == pid)
+            {
+                entry = std::move(processes_[old]);
+                nameIndex = nameIndices_[old];
+                ++old;
+            }
+            entry.processId = pid;
+
+            const std::uint8_t mask = keyframe ? kAllFields : reader.Byte();
+            if (keyframe)
+            {
+                entry.parentProcessId = reader.Varint32();
+                nameIndex = reader.Varint32();
+                entry.threadCount = reader.Varint32();
+                entry.workingSetBytes = reader.Varint();
+                entry.privateBytes = reader.Varint();
+                entry.kernelTime100ns = reader.Varint();
+                entry.userTime100ns = reader.Varint();
+                if (nameIndex >= names_.size())
+                {
+                    reader.Fail();
+                }
+            }
+            else
+            {
+                if (mask & kFieldParent)
+                {
+                    entry.parentProcessId = reader.Varint32();
+                }
+                if (mask & kFieldName)
+                {
+                    nameIndex = reader.Varint32();
+                    if (nameIndex >= names_.size())
+                    {
+                        reader.Fail();
+                    }
+                }
+                if (mask & kFieldThreads)
+                {
+                    entry.threadCount = static_cast<std::uint32_t>(reader.Difference(entry.threadCount));
+                }
+                if (mask & kFieldWorkingSet)
+                {
+                    entry.workingSetBytes = reader.Difference(entry.workingSetBytes);
+                }
+                if (mask & kFieldPrivate)
+                {
+                    entry.privateBytes = reader.Difference(entry.privateBytes);
+                }
+                if (mask & kFieldKernelTime)
+                {
+                    entry.kernelTime100ns = reader.Difference(entry.kernelTime100ns);
+                }
+                if (mask & kFieldUserTime)
+                {
+                    entry.userTime100ns = reader.Difference(entry.userTime100ns);
+                }
+            }
+            nextProcesses_.push_back(std::move(entry));
+            nextNameIndices_.push_back(nameIndex);
+        }
+        copyOldBelow(0x100000000ULL);
+
+        if (hasNetwork && reader.Ok())
+        {
+            const std::uint8_t networkFlags = reader.Byte();
+            nextConnections_.clear();
+            nextConnections_.reserve(connections_.size() + 16);
+
+            // Removals are indices into the current list.
+            const std::size_t removedCount = reader.Count();
+            std::size_t kept = 0;
+            for (std::size_t index = 0; index < removedCount && reader.Ok(); ++index)
+            {
+                const std::uint64_t removed = kept + reader.Varint();
+                if (removed >= connections_.size())
+                {
+                    reader.Fail();
+                    break;
+                }
+                nextConnections_.insert(nextConnections_.end(), connections_.begin() + static_cast<std::ptrdiff_t>(kept), connections_.begin() + static_cast<std::ptrdiff_t>(removed));
+                kept = static_cast<std::size_t>(removed) + 1;
+            }
+            if (kept < connections_.size())
+            {
+                nextConnections_.insert(nextConnections_.end(), connections_.begin() + static_cast<std::ptrdiff_t>(kept), connections_.end());
+            }
+
+            // Additions arrive in wire order; merge them in.
+            const std::size_t addedCount = reader.Count();
+            const std::size_t keptCount = nextConnections_.size();
+            for (std::size_t index = 0; index < addedCount && reader.Ok(); ++index)
+            {
+                nextConnections_.push_back(ReadConnection(reader));
+            }
+            std::inplace_merge(nextConnections_.begin(), nextConnections_.begin() + static_cast<std::ptrdiff_t>(keptCount), nextConnections_.end(), ConnectionWireLess);
+
+            networkAccessDenied_ = (networkFlags & kNetworkAccessDenied) != 0;
+            networkCaptureFailed_ = (networkFlags & kNetworkCaptureFailed) != 0;
+            connections_.swap(nextConnections_);
+        }
+
+        if (!reader.Ok() || !reader.AtEnd())
+        {
+            Reset();
+            return false;
+        }
+
+        processes_.swap(nextProcesses_);
+        nameIndices_.swap(nextNameIndices_);
+        generation_ = generation;
+        timestamp_ = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(timestampMs)));
+        metrics_ = metrics;
+        hasState_ = true;
+        lastKeyframe_ = keyframe;
+        lastHadNetwork_ = hasNetwork;
+        return true;
+    }
+
+    std::string_view WireDecoder::ImageName(std::size_t index) const
+    {
+        if (index >= nameIndices_.size() || nameIndices_[index] == kNoName)
+        {
+            return {};
+        }
+        return names_[nameIndices_[index]];
+    }
+
+    ProcessSnapshot WireDecoder::BuildProcessSnapshot() const
+    {
+        std::vector<ProcessEntry> processes(processes_);
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            processes[index].imageName = InternedString::FromUtf8(ImageName(index));
+        }
+        return ProcessSnapshot(std::move(processes));
+    }
+
+    NetworkSnapshot WireDecoder::BuildNetworkSnapshot() const
+    {
+        return NetworkSnapshot(connections_, networkAccessDenied_, networkCaptureFailed_);
+    }
+
+    void WireDecoder::Reset()
+    {
+        hasState_ = false;
+        lastKeyframe_ = false;
+        lastHadNetwork_ = false;
+        names_.clear();
+        processes_.clear();
+        nameIndices_.clear();
+        connections_.clear();
+        nextProcesses_.clear();
+        nextNameIndices_.clear();
+        nextConnections_.clear();
+    }
+
+    std::uint8_t *WireStreamReader::PrepareReceive(std::size_t sizeBytes)
+    {
+        // Move unconsumed bytes to the front before growing, so a long-lived
+        // connection's buffer stays around one frame in size.
+        if (readOffset_ > 0)
+        {
+            std::memmove(buffer_.data(), buffer_.data() + readOffset_, used_ - readOffset_);
+            used_ -= readOffset_;
+            readOffset_ = 0;
+        }
+
+        if (buffer_.size() < used_ + sizeBytes)
+        {
+            buffer_.resize(used_ + sizeBytes);
+        }
+        return buffer_.data() + used_;
+    }
+
+    void WireStreamReader::Commit(std::size_t sizeBytes)
+    {
+        used_ += sizeBytes;
+    }
+
+    WireStreamReader::Status WireStreamReader::Next()
+    {
+        if (failed_)
+        {
+            return Status::ProtocolError;
+        }
+        if (!helloReceived_)
+        {
+            return ParseHello();
+        }
+
+        const std::size_t available = used_ - readOffset_;
+        if (available < wire::kFrameHeaderBytes)
+        {
+            return Status::NeedMoreData;
+        }
+
+        Reader header(buffer_.data() + readOffset_, wire::kFrameHeaderBytes);
+        const std::uint32_t bodyBytes = header.Fixed32();
+        if (bodyBytes == 0 || bodyBytes > wire::kMaxFrameBytes)
+        {
+            failed_ = true;
+            return Status::ProtocolError;
+        }
+        if (available < wire::kFrameHeaderBytes + bodyBytes)
+        {
+            return Status::NeedMoreData;
+        }
+
+        if (!decoder_.Apply(buffer_.data() + readOffset_ + wire::kFrameHeaderBytes, bodyBytes))
+        {
+            failed_ = true;
+            return Status::ProtocolError;
+        }
+
+        readOffset_ += wire::kFrameHeaderBytes + bodyBytes;
+        if (readOffset_ == used_)
+        {
+            used_ = 0;
+            readOffset_ = 0;
+        }
+        return Status::FrameApplied;
+    }
+
+    void WireStreamReader::Reset()
+    {
+        decoder_ = WireDecoder();
+        helloReceived_ = false;
+        failed_ = false;
+        hostName_.clear();
+        used_ = 0;
+        readOffset_ = 0;
+    }
+
+    WireStreamReader::Status WireStreamReader::ParseHello()
+    {
+        const std::size_t available = used_ - readOffset_;
+        if (available < wire::kHelloBytes)
+        {
+            return Status::NeedMoreData;
+        }
+
+        Reader reader(buffer_.data() + readOffset_, available);
+        const std::uint32_t magic = reader.Fixed32();
+        const std::uint32_t version = static_cast<std::uint32_t>(reader.Byte()) | (static_cast<std::uint32_t>(reader.Byte()) << 8);
+        const std::uint32_t flags = static_cast<std::uint32_t>(reader.Byte()) | (static_cast<std::uint32_t>(reader.Byte()) << 8);
+        if (magic != wire::kMagic || version != wire::kVersion || (flags & ~static_cast<std::uint32_t>(wire::kHelloHostName)) != 0)
+        {
+            failed_ = true;
+            return Status::ProtocolError;
+        }
+
+        std::size_t helloBytes = wire::kHelloBytes;
+        if ((flags & wire::kHelloHostName) != 0)
+        {
+            if (reader.AtEnd())
+            {
+                return Status::NeedMoreData;
+            }
+            const std::size_t nameBytes = reader.Byte();
+            const std::uint8_t *name = reader.Take(nameBytes);
+            if (!name)
+            {
+                return Status::NeedMoreData;
+            }
+            hostName_ = DecodeUtf8(name, nameBytes);
+            helloBytes += 1 + nameBytes;
+        }
+
+        readOffset_ += helloBytes;
+        helloReceived_ = true;
+        return Status::HelloReceived;
+    }
+}
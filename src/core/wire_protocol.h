@@ -0,0 +1,212 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "collector.h"
+
+namespace rvrse::core
+{
+    // Binary stream served to remote viewers (see docs/headless-agent.md).
+    //
+    // A connection starts with an 8-byte hello (magic "RVRW", u16 version,
+    // u16 flags), optionally followed by the sender's host name, and then
+    // frames: u32 little-endian body length, then the body. Every body is a keyframe carrying the full process and
+    // connection tables or a delta against the previous frame. Integers are
+    // LEB128 varints, changed numeric fields are sent as zigzag differences,
+    // and process names go through a string table that each keyframe resets,
+    // so a steady-state delta costs a few bytes per changed process.
+    namespace wire
+    {
+        constexpr std::uint32_t kMagic = 0x57525652; // "RVRW"
+        constexpr std::uint16_t kVersion = 1;
+        constexpr std::size_t kHelloBytes = 8;
+        constexpr std::size_t kFrameHeaderBytes = 4;
+
+        // Hello flag: a u8 length and that many bytes of UTF-8 host name
+        // follow the fixed part.
+        constexpr std::uint16_t kHelloHostName = 0x0001;
+        constexpr std::size_t kMaxHostNameBytes = 255;
+
+        // Frames larger than this are treated as a corrupt stream.
+        constexpr std::uint32_t kMaxFrameBytes = 64U * 1024U * 1024U;
+
+        // A non-empty hostName is sent along (truncated to
+        // kMaxHostNameBytes), so a collector pushing to an aggregator can
+        // say who it is.
+        void AppendHello(std::string &out, const std::wstring &hostName = {});
+    }
+
+    // Producer side. Keeps a compact copy of what the last frame described
+    // so the next one can be a delta; one encoder serves every connected
+    // viewer because they all follow the same keyframe-delta chain.
+    class WireEncoder
+    {
+    public:
+        explicit WireEncoder(std::uint32_t keyframeInterval = 60) : keyframeInterval_(keyframeInterval) {}
+
+        // Appends one length-prefixed frame to out and returns whether it is
+        // a keyframe. The connection table is only sent when the frame's
+        // network capture is fresh (or on keyframes).
+        bool Encode(const CollectorFrame &frame, std::string &out);
+
+        // Makes the next frame a keyframe, e.g. when a viewer joins or a
+        // frame was dropped.
+        void ForceKeyframe() { forceKeyframe_ = true; }
+
+    private:
+        struct ProcessState
+        {
+            std::uint32_t processId = 0;
+            std::uint32_t parentProcessId = 0;
+            std::uint32_t nameIndex = 0;
+            std::uint32_t threadCount = 0;
+            std::uint64_t workingSetBytes = 0;
+            std::uint64_t privateBytes = 0;
+            std::uint64_t kernelTime100ns = 0;
+            std::uint64_t userTime100ns = 0;
+            std::uint64_t rowHash = 0;
+        };
+
+        std::uint32_t InternName(InternedString name, std::string &definitions, std::uint32_t &definitionCount);
+        void EncodeProcesses(const ProcessSnapshot &snapshot, bool keyframe, std::string &out);
+        void EncodeConnections(const NetworkSnapshot &network, bool keyframe, std::string &out);
+
+        std::uint32_t keyframeInterval_;
+        std::uint64_t framesSinceKeyframe_ = 0;
+        bool forceKeyframe_ = true;
+
+        // String table as the viewers know it, indexed by interned id;
+        // reset on every keyframe.
+        std::vector<InternedString> names_;
+        std::unordered_map<std::uint32_t, std::uint32_t> nameIndices_;
+
+        // PID-sorted like the snapshot, so deltas are a merge walk.
+        std::vector<ProcessState> previous_;
+        std::vector<ProcessState> current_;
+
+        // Connections in wire order (see wire_protocol.cpp).
+        std::vector<ConnectionEntry> previousConnections_;
+        std::vector<ConnectionEntry> currentConnections_;
+
+        // Per-frame scratch, reused so steady-state frames do not allocate.
+        std::string exitRecords_;
+        std::string processRecords_;
+        std::string nameDefinitions_;
+    };
+
+    // Viewer side: applies frames in order and keeps the reconstructed
+    // state. A delta without the keyframe it builds on, or a malformed
+    // frame, is rejected and leaves the decoder waiting for a keyframe.
+    class WireDecoder
+    {
+    public:
+        // body/size is one frame body, without the length prefix.
+        bool Apply(const std::uint8_t *body, std::size_t size);
+
+        bool HasState() const { return hasState_; }
+        bool LastFrameWasKeyframe() const { return lastKeyframe_; }
+        bool LastFrameHadNetwork() const { return lastHadNetwork_; }
+
+        std::uint64_t Generation() const { return generation_; }
+        std::chrono::system_clock::time_point Timestamp() const { return timestamp_; }
+        const SystemMetrics &Metrics() const { return metrics_; }
+
+        // PID-sorted, like ProcessSnapshot::Processes(). Thread lists are
+        // not part of the stream and stay empty; so do image names, which
+        // ImageName() reads from the decoder's own table.
+        const std::vector<ProcessEntry> &Processes() const { return processes_; }
+        const std::vector<ConnectionEntry> &Connections() const { return connections_; }
+
+        // UTF-8 image name of Processes()[index], valid until the next Apply().
+        std::string_view ImageName(std::size_t index) const;
+
+        // The processes with their names interned in StringInterner::Global(),
+        // for a viewer that shows the remote host like a local one.
+        ProcessSnapshot BuildProcessSnapshot() const;
+        NetworkSnapshot BuildNetworkSnapshot() const;
+
+    private:
+        void Reset();
+
+        bool hasState_ = false;
+        bool lastKeyframe_ = false;
+        bool lastHadNetwork_ = false;
+        std::uint64_t generation_ = 0;
+        std::chrono::system_clock::time_point timestamp_{};
+        SystemMetrics metrics_{};
+        bool networkAccessDenied_ = false;
+        bool networkCaptureFailed_ = false;
+
+        // Names defined since the last keyframe, in wire order. Held here
+        // rather than in StringInterner::Global(), which never frees: an
+        // aggregator decodes many hosts at once, and their deltas keep
+        // defining names until the next keyframe or disconnect drops them.
+        std::vector<std::string> names_;
+        std::vector<ProcessEntry> processes_;
+        // Index into names_ of each process, parallel to processes_.
+        std::vector<std::uint32_t> nameIndices_;
+        std::vector<ConnectionEntry> connections_;
+
+        // Scratch for rebuilding the tables while applying a delta.
+        std::vector<std::uint32_t> exits_;
+        std::vector<ProcessEntry> nextProcesses_;
+        std::vector<std::uint32_t> nextNameIndices_;
+        std::vector<ConnectionEntry> nextConnections_;
+    };
+
+    // Incremental parser for one connection: the hello, then frames applied
+    // to a WireDecoder. Bytes may arrive split anywhere, so the same reader
+    // serves WireClient's blocking reads and the aggregator's non-blocking
+    // workers.
+    class WireStreamReader
+    {
+    public:
+        enum class Status
+        {
+            NeedMoreData,
+            HelloReceived,
+            FrameApplied,
+            ProtocolError
+        };
+
+        // Room for at least sizeBytes more bytes; Commit() says how many of
+        // them were filled.
+        std::uint8_t *PrepareReceive(std::size_t sizeBytes);
+        void Commit(std::size_t sizeBytes);
+
+        // Consumes the hello or the next complete frame. ProtocolError is
+        // sticky until Reset(): an unknown magic or version, an oversized
+        // frame, or a frame the decoder rejects. The sender starts every
+        // stream at a keyframe, so a delta that does not apply means the
+        // stream is corrupt.
+        Status Next();
+
+        void Reset();
+
+        bool HelloReceived() const { return helloReceived_; }
+
+        // Empty when the sender did not name itself.
+        const std::wstring &HostName() const { return hostName_; }
+        const WireDecoder &State() const { return decoder_; }
+
+    private:
+        Status ParseHello();
+
+        WireDecoder decoder_;
+        bool helloReceived_ = false;
+        bool failed_ = false;
+        std::wstring hostName_;
+
+        // buffer_[readOffset_, used_) holds bytes received but not consumed
+        // yet; the rest is room for the next receive.
+        std::vector<std::uint8_t> buffer_;
+        std::size_t readOffset_ = 0;
+        std::size_t used_ = 0;
+    };
+}
@@ -0,0 +1,159 @@
+// rvrse-plugin-host: runs a single plugin in its own process, feeding it
+// snapshots from the monitor's shared-memory ring.
+//
+//   rvrse-plugin-host --ring <name> --plugin <path> [--poll-ms <n>]
+//
+// Exits when the ring is closed or the producing monitor process is gone.
+
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plugin_loader.h"
+#include "snapshot_ring.h"
+#include "rvrse/common/log_writer.h"
+
+namespace
+{
+    constexpr unsigned long kDefaultPollIntervalMs = 100;
+
+    // Checking the producer's liveness is a syscall; do it every N idle polls.
+    constexpr int kLivenessCheckInterval = 10;
+
+    struct HostOptions
+    {
+        std::wstring ringName;
+        std::wstring pluginPath;
+        unsigned long pollIntervalMs = kDefaultPollIntervalMs;
+    };
+
+    bool ParseArguments(const std::vector<std::wstring> &args, HostOptions &options)
+    {
+        for (std::size_t index = 1; index < args.size(); ++index)
+        {
+            const std::wstring &arg = args[index];
+            const bool hasValue = index + 1 < args.size();
+
+            if (arg == L"--ring" && hasValue)
+            {
+                options.ringName = args[++index];
+            }
+            else if (arg == L"--plugin" && hasValue)
+            {
+                options.pluginPath = args[++index];
+            }
+            else if (arg == L"--poll-ms" && hasValue)
+            {
+                options.pollIntervalMs = std::wcstoul(args[++index].c_str(), nullptr, 10);
+                if (options.pollIntervalMs == 0)
+                {
+                    options.pollIntervalMs = kDefaultPollIntervalMs;
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return !options.ringName.empty() && !options.pluginPath.empty();
+    }
+
+    int RunHost(const std::vector<std::wstring> &args)
+    {
+        HostOptions options;
+        if (!ParseArguments(args, options))
+        {
+            std::fputws(L"usage: rvrse-plugin-host --ring <name> --plugin <path> [--poll-ms <n>]\n", stderr);
+            return 2;
+        }
+
+        rvrse::core::SnapshotRingReader reader;
+        if (!reader.Open(options.ringName))
+        {
+            std::fwprintf(stderr, L"[PluginHost] Unable to open snapshot ring %ls\n", options.ringName.c_str());
+            return 3;
+        }
+
+        // Each host gets its own log next to the plugin; the monitor's log is
+        // not shared across processes.
+        const std::filesystem::path pluginPath(options.pluginPath);
+        rvrse::common::LogWriter hostLog;
+        rvrse::common::LogWriterOptions logOptions;
+        logOptions.path = (pluginPath.parent_path() / (pluginPath.stem().wstring() + L".host.log")).wstring();
+        hostLog.Open(std::move(logOptions));
+
+        rvrse::core::PluginLoader loader(pluginPath.parent_path().wstring());
+        if (hostLog.IsOpen())
+        {
+            loader.SetLogWriter(&hostLog);
+        }
+
+        if (!loader.LoadPlugin(options.pluginPath))
+        {
+            return 4;
+        }
+
+        rvrse::core::SnapshotRingFrame frame;
+        int idlePolls = 0;
+        while (true)
+        {
+            auto status = reader.TryReadLatest(frame);
+            if (status == rvrse::core::SnapshotRingReader::ReadStatus::Closed)
+            {
+                break;
+            }
+
+            if (status == rvrse::core::SnapshotRingReader::ReadStatus::FrameReady)
+            {
+                idlePolls = 0;
+                loader.DispatchProcessSnapshot(frame.Processes());
+                loader.DispatchHandleSnapshot(frame.Handles());
+                loader.DispatchNetworkSnapshot(frame.Network());
+                loader.DispatchSystemMetrics(frame.Metrics());
+
+                // Unpin right away so the producer has the slot back while we sleep.
+                reader.Release();
+                continue;
+            }
+
+            if (++idlePolls >= kLivenessCheckInterval)
+            {
+                idlePolls = 0;
+                if (!reader.IsProducerAlive())
+                {
+                    break;
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.pollIntervalMs));
+        }
+
+        loader.UnloadPlugins();
+        return 0;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(int argc, wchar_t **argv)
+{
+    std::vector<std::wstring> args(argv, argv + argc);
+    return RunHost(args);
+}
+#else
+int main(int argc, char **argv)
+{
+    std::vector<std::wstring> args;
+    args.reserve(static_cast<std::size_t>(argc));
+    for (int index = 0; index < argc; ++index)
+    {
+        args.push_back(std::filesystem::path(argv[index]).wstring());
+    }
+    return RunHost(args);
+}
+#endif
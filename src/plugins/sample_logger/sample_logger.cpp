@@ -11,6 +11,20 @@
 
 namespace
 {
+    const RvrseHostServices *g_hostServices = nullptr;
+    RvrseMetricHandle g_linesWritten = RVRSE_METRIC_INVALID_HANDLE;
+    RvrseMetricHandle g_lastProcessCount = RVRSE_METRIC_INVALID_HANDLE;
+
+    bool HostSupportsMetrics()
+    {
+        return g_hostServices && g_hostServices->apiMinor >= 2 && g_hostServices->RegisterMetric;
+    }
+
+    bool HostSupportsLogging()
+    {
+        return g_hostServices && g_hostServices->apiMinor >= 3 && g_hostServices->WriteLog;
+    }
+
     std::wstring GetLogPath()
     {
         wchar_t modulePath[MAX_PATH] = {0};
@@ -28,7 +42,8 @@ namespace
         return (path.parent_path() / L"sample_logger.log").wstring();
     }
 
-    void AppendLogLine(const std::wstring &line)
+    // Fallback for hosts older than API 1.3, which have no buffered host log.
+    void AppendLogLineToFile(const std::wstring &line)
     {
         static const std::wstring logPath = GetLogPath();
         FILE *file = nullptr;
@@ -42,9 +57,28 @@ namespace
         std::fclose(file);
     }
 
+    void AppendLogLine(const std::wstring &line)
+    {
+        if (!HostSupportsLogging() ||
+            !g_hostServices->WriteLog(g_hostServices->hostContext, RVRSE_LOG_INFO, line.c_str()))
+        {
+            AppendLogLineToFile(line);
+        }
+
+        if (HostSupportsMetrics())
+        {
+            g_hostServices->AddToCounter(g_hostServices->hostContext, g_linesWritten, 1);
+        }
+    }
+
     void OnProcessSnapshot(const RvrseProcessSnapshotView *snapshot, void *)
     {
         std::size_t processCount = snapshot ? snapshot->processCount : 0;
+        if (HostSupportsMetrics())
+        {
+            g_hostServices->SetGauge(g_hostServices->hostContext, g_lastProcessCount, static_cast<double>(processCount));
+        }
+
         wchar_t buffer[128];
         std::swprintf(buffer,
                       std::size(buffer),
@@ -63,9 +97,36 @@ namespace
                       handleCount);
         AppendLogLine(buffer);
     }
+
+    void OnNetworkSnapshot(const RvrseNetworkSnapshotView *snapshot, void *)
+    {
+        std::size_t connectionCount = snapshot ? snapshot->connectionCount : 0;
+        wchar_t buffer[128];
+        std::swprintf(buffer,
+                      std::size(buffer),
+                      L"[SampleLogger] Connections observed: %zu",
+                      connectionCount);
+        AppendLogLine(buffer);
+    }
+
+    void OnSystemMetrics(const RvrseSystemMetrics *metrics, void *)
+    {
+        if (!metrics)
+        {
+            return;
+        }
+
+        wchar_t buffer[128];
+        std::swprintf(buffer,
+                      std::size(buffer),
+                      L"[SampleLogger] CPU: %.1f%% | Memory: %.1f%%",
+                      metrics->cpuUsagePercent,
+                      metrics->memoryUsagePercent);
+        AppendLogLine(buffer);
+    }
 }
 
-RVRSE_PLUGIN_EXPORT bool RvrsePluginInitialize(const RvrseHostServices *,
+RVRSE_PLUGIN_EXPORT bool RvrsePluginInitialize(const RvrseHostServices *hostServices,
                                                RvrsePluginInfo *outInfo,
                                                RvrsePluginHooks *outHooks)
 {
@@ -86,8 +147,21 @@ RVRSE_PLUGIN_EXPORT bool RvrsePluginInitialize(const RvrseHostServices *,
 
     outHooks->OnProcessSnapshot = &OnProcessSnapshot;
     outHooks->OnHandleSnapshot = &OnHandleSnapshot;
+    outHooks->OnNetworkSnapshot = &OnNetworkSnapshot;
+    outHooks->OnSystemMetrics = &OnSystemMetrics;
     outHooks->context = nullptr;
 
+    g_hostServices = hostServices;
+    if (HostSupportsMetrics())
+    {
+        g_linesWritten = g_hostServices->RegisterMetric(g_hostServices->hostContext,
+                                                        L"plugin.sample_logger.lines_written",
+                                                        RVRSE_METRIC_COUNTER);
+        g_lastProcessCount = g_hostServices->RegisterMetric(g_hostServices->hostContext,
+                                                            L"plugin.sample_logger.process_count",
+                                                            RVRSE_METRIC_GAUGE);
+    }
+
     AppendLogLine(L"[SampleLogger] Initialized");
     return true;
 }
@@ -95,4 +169,9 @@ RVRSE_PLUGIN_EXPORT bool RvrsePluginInitialize(const RvrseHostServices *,
 RVRSE_PLUGIN_EXPORT void RvrsePluginShutdown()
 {
     AppendLogLine(L"[SampleLogger] Shutdown");
+
+    if (HostSupportsLogging())
+    {
+        g_hostServices->FlushLog(g_hostServices->hostContext);
+    }
 }
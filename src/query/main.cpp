@@ -0,0 +1,474 @@
+// rvrse-query: offline queries over the history recorded by rvrse-agent's
+// "history" exporter.
+//
+//   rvrse-query [--history <dir>] [--utc] series <metric> --process <pid|name>
+//               [--from <time>] [--to <time>]
+//   rvrse-query [--history <dir>] [--utc] peaks <metric> [--over <value>]
+//               [--process <pid|name>] [--limit <n>] [--from <time>] [--to <time>]
+//
+// <metric> is working_set_bytes, private_bytes, threads, handles or
+// cpu_percent. Times are local (UTC with --utc): "HH:MM[:SS]" today,
+// "YYYY-MM-DD[ HH:MM[:SS]]", "today", "now" or "-<n>s|m|h|d" before now; the
+// window defaults to today so far. --over takes K/M/G/T suffixes (x1024).
+// --history defaults to history/ next to the executable, like the agent.
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <cwchar>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "history_query.h"
+#include "rvrse/common/formatting.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    fs::path ExecutableDirectory()
+    {
+#if defined(_WIN32)
+        wchar_t pathBuffer[MAX_PATH] = {0};
+        DWORD result = GetModuleFileNameW(nullptr, pathBuffer, static_cast<DWORD>(std::size(pathBuffer)));
+        if (result == 0 || result == std::size(pathBuffer))
+        {
+            return {};
+        }
+        return fs::path(pathBuffer).parent_path();
+#else
+        std::error_code ec;
+        fs::path exePath = fs::read_symlink("/proc/self/exe", ec);
+        return ec ? fs::path() : exePath.parent_path();
+#endif
+    }
+
+    enum class Command
+    {
+        Series,
+        Peaks,
+    };
+
+    struct QueryOptions
+    {
+        std::wstring historyDirectory;
+        bool utc = false;
+        Command command = Command::Series;
+        rvrse::core::HistoryQuery query;
+        std::wstring from = L"today";
+        std::wstring to = L"now";
+        bool hasOver = false;
+    };
+
+    std::int64_t NowMilliseconds()
+    {
+        return static_cast<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    std::tm BreakDown(std::int64_t timestampMs, bool utc)
+    {
+        const std::time_t seconds = static_cast<std::time_t>(timestampMs / 1000);
+        std::tm fields{};
+#if defined(_WIN32)
+        utc ? gmtime_s(&fields, &seconds) : localtime_s(&fields, &seconds);
+#else
+        utc ? gmtime_r(&seconds, &fields) : localtime_r(&seconds, &fields);
+#endif
+        return fields;
+    }
+
+    std::int64_t Assemble(std::tm fields, bool utc)
+    {
+        fields.tm_isdst = -1;
+#if defined(_WIN32)
+        const std::time_t seconds = utc ? _mkgmtime(&fields) : std::mktime(&fields);
+#else
+        const std::time_t seconds = utc ? timegm(&fields) : std::mktime(&fields);
+#endif
+        return static_cast<std::int64_t>(seconds) * 1000;
+    }
+
+    // Reads exactly `digits` digits.
+    bool ReadNumber(std::wstring_view &text, std::size_t digits, int &value)
+    {
+        if (text.size() < digits)
+        {
+            return false;
+        }
+        value = 0;
+        for (std::size_t index = 0; index < digits; ++index)
+        {
+            if (text[index] < L'0' || text[index] > L'9')
+            {
+                return false;
+            }
+            value = value * 10 + (text[index] - L'0');
+        }
+        text.remove_prefix(digits);
+        return true;
+    }
+
+    bool ReadSeparator(std::wstring_view &text, wchar_t separator)
+    {
+        if (text.empty() || text.front() != separator)
+        {
+            return false;
+        }
+        text.remove_prefix(1);
+        return true;
+    }
+
+    // "HH:MM[:SS]" into fields; the whole text must be consumed.
+    bool ParseClock(std::wstring_view text, std::tm &fields)
+    {
+        int hour = 0;
+        int minute = 0;
+        int second = 0;
+        if (!ReadNumber(text, 2, hour) || !ReadSeparator(text, L':') || !ReadNumber(text, 2, minute))
+        {
+            return false;
+        }
+        if (!text.empty() && (!ReadSeparator(text, L':') || !ReadNumber(text, 2, second) || !text.empty()))
+        {
+            return false;
+        }
+        if (hour > 23 || minute > 59 || second > 59)
+        {
+            return false;
+        }
+        fields.tm_hour = hour;
+        fields.tm_min = minute;
+        fields.tm_sec = second;
+        return true;
+    }
+
+    bool ParseTime(std::wstring_view text, bool utc, std::int64_t nowMs, std::int64_t &timestampMs)
+    {
+        if (text == L"now")
+        {
+            timestampMs = nowMs;
+            return true;
+        }
+
+        std::tm fields = BreakDown(nowMs, utc);
+        fields.tm_hour = 0;
+        fields.tm_min = 0;
+        fields.tm_sec = 0;
+        if (text == L"today")
+        {
+            timestampMs = Assemble(fields, utc);
+            return true;
+        }
+
+        if (!text.empty() && text.front() == L'-')
+        {
+            wchar_t *end = nullptr;
+            const std::wstring amount(text.substr(1));
+            const unsigned long long count = std::wcstoull(amount.c_str(), &end, 10);
+            const std::wstring_view unit(end);
+            const std::int64_t unitMs = unit == L"s" ? 1000 : unit == L"m" ? 60000
+                                                          : unit == L"h"   ? 3600000
+                                                          : unit == L"d"   ? 86400000
+                                                                           : 0;
+            if (end == amount.c_str() || unitMs == 0)
+            {
+                return false;
+            }
+            timestampMs = nowMs - static_cast<std::int64_t>(count) * unitMs;
+            return true;
+        }
+
+        if (text.size() >= 10 && text[4] == L'-')
+        {
+            int year = 0;
+            int month = 0;
+            int day = 0;
+            if (!ReadNumber(text, 4, year) || !ReadSeparator(text, L'-') || !ReadNumber(text, 2, month) ||
+                !ReadSeparator(text, L'-') || !ReadNumber(text, 2, day) || month < 1 || month > 12 || day < 1 || day > 31)
+            {
+                return false;
+            }
+            fields.tm_year = year - 1900;
+            fields.tm_mon = month - 1;
+            fields.tm_mday = day;
+            if (!text.empty() && ((text.front() != L' ' && text.front() != L'T') || !ParseClock(text.substr(1), fields)))
+            {
+                return false;
+            }
+            timestampMs = Assemble(fields, utc);
+            return true;
+        }
+
+        if (!ParseClock(text, fields))
+        {
+            return false;
+        }
+        timestampMs = Assemble(fields, utc);
+        return true;
+    }
+
+    bool ParseValue(const std::wstring &text, double &value)
+    {
+        wchar_t *end = nullptr;
+        value = std::wcstod(text.c_str(), &end);
+        if (end == text.c_str() || value < 0.0)
+        {
+            return false;
+        }
+
+        const std::wstring_view suffix(end);
+        if (suffix.empty())
+        {
+            return true;
+        }
+        constexpr std::wstring_view kSuffixes = L"KMGT";
+        const std::size_t power = kSuffixes.find(suffix.front());
+        if (suffix.size() != 1 || power == std::wstring_view::npos)
+        {
+            return false;
+        }
+        for (std::size_t step = 0; step <= power; ++step)
+        {
+            value *= 1024.0;
+        }
+        return true;
+    }
+
+    bool ParseArguments(const std::vector<std::wstring> &args, QueryOptions &options)
+    {
+        std::size_t index = 1;
+        for (; index < args.size() && args[index].rfind(L"--", 0) == 0; ++index)
+        {
+            if (args[index] == L"--history" && index + 1 < args.size())
+            {
+                options.historyDirectory = args[++index];
+            }
+            else if (args[index] == L"--utc")
+            {
+                options.utc = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        if (index + 2 > args.size())
+        {
+            return false;
+        }
+        if (args[index] == L"series")
+        {
+            options.command = Command::Series;
+        }
+        else if (args[index] == L"peaks")
+        {
+            options.command = Command::Peaks;
+        }
+        else
+        {
+            return false;
+        }
+
+        const std::wstring &metricName = args[index + 1];
+        if (!rvrse::core::ParseHistoryMetric(std::string(metricName.begin(), metricName.end()), options.query.metric))
+        {
+            return false;
+        }
+
+        for (index += 2; index < args.size(); ++index)
+        {
+            const std::wstring &arg = args[index];
+            const bool hasValue = index + 1 < args.size();
+
+            if (arg == L"--process" && hasValue)
+            {
+                options.query.process = args[++index];
+            }
+            else if (arg == L"--from" && hasValue)
+            {
+                options.from = args[++index];
+            }
+            else if (arg == L"--to" && hasValue)
+            {
+                options.to = args[++index];
+            }
+            else if (arg == L"--over" && hasValue && options.command == Command::Peaks)
+            {
+                if (!ParseValue(args[++index], options.query.over))
+                {
+                    return false;
+                }
+                options.hasOver = true;
+            }
+            else if (arg == L"--limit" && hasValue && options.command == Command::Peaks)
+            {
+                options.query.limit = static_cast<std::size_t>(std::wcstoull(args[++index].c_str(), nullptr, 10));
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        // A series of every process is rarely what anyone wants.
+        return options.command != Command::Series || !options.query.process.empty();
+    }
+
+    std::wstring FormatTime(std::int64_t timestampMs, bool utc)
+    {
+        const std::tm fields = BreakDown(timestampMs, utc);
+        wchar_t text[32];
+        const std::size_t length = std::wcsftime(text, std::size(text), L"%Y-%m-%d %H:%M:%S", &fields);
+        return std::wstring(text, length);
+    }
+
+    std::wstring FormatValue(rvrse::core::HistoryMetric metric, double value)
+    {
+        switch (metric)
+        {
+        case rvrse::core::HistoryMetric::WorkingSetBytes:
+        case rvrse::core::HistoryMetric::PrivateBytes:
+            return rvrse::common::FormatSize(static_cast<std::uint64_t>(value));
+        case rvrse::core::HistoryMetric::CpuPercent:
+        {
+            wchar_t text[32];
+            std::swprintf(text, std::size(text), L"%.1f%%", value);
+            return text;
+        }
+        case rvrse::core::HistoryMetric::Threads:
+        case rvrse::core::HistoryMetric::Handles:
+            break;
+        }
+        return std::to_wstring(static_cast<std::uint64_t>(value));
+    }
+
+    void PrintSeries(const QueryOptions &options, const std::vector<rvrse::core::HistorySeries> &series)
+    {
+        for (const rvrse::core::HistorySeries &entry : series)
+        {
+            std::wprintf(L"%u %ls\n", entry.processId, entry.name.c_str());
+            for (const rvrse::core::HistoryPoint &point : entry.points)
+            {
+                std::wprintf(L"  %ls  %ls\n",
+                             FormatTime(point.timestampMs, options.utc).c_str(),
+                             FormatValue(options.query.metric, point.value).c_str());
+            }
+        }
+    }
+
+    void PrintPeaks(const QueryOptions &options, const std::vector<rvrse::core::HistoryPeak> &peaks)
+    {
+        std::wprintf(options.hasOver ? L"%8ls  %-24ls %12ls  %-19ls  %ls\n" : L"%8ls  %-24ls %12ls  %ls\n",
+                     L"PID", L"NAME", L"PEAK", L"AT", L"FIRST OVER");
+        for (const rvrse::core::HistoryPeak &peak : peaks)
+        {
+            const std::wstring name = peak.name.empty() ? L"?" : peak.name;
+            std::wprintf(L"%8u  %-24ls %12ls  %ls",
+                         peak.processId,
+                         name.c_str(),
+                         FormatValue(options.query.metric, peak.value).c_str(),
+                         FormatTime(peak.timestampMs, options.utc).c_str());
+            if (options.hasOver)
+            {
+                std::wprintf(L"  %ls", FormatTime(peak.firstOverMs, options.utc).c_str());
+            }
+            std::fputws(L"\n", stdout);
+        }
+    }
+
+    int RunQuery(const std::vector<std::wstring> &args)
+    {
+        QueryOptions options;
+        if (!ParseArguments(args, options))
+        {
+            std::fputws(L"usage: rvrse-query [--history <dir>] [--utc] series <metric> --process <pid|name> [--from <time>] [--to <time>]\n"
+                        L"       rvrse-query [--history <dir>] [--utc] peaks <metric> [--over <value>] [--process <pid|name>] "
+                        L"[--limit <n>] [--from <time>] [--to <time>]\n"
+                        L"metrics: working_set_bytes, private_bytes, threads, handles, cpu_percent\n",
+                        stderr);
+            return 2;
+        }
+
+        const std::int64_t nowMs = NowMilliseconds();
+        if (!ParseTime(options.from, options.utc, nowMs, options.query.fromMs))
+        {
+            std::fwprintf(stderr, L"[Query] Cannot read time '%ls'\n", options.from.c_str());
+            return 2;
+        }
+        if (!ParseTime(options.to, options.utc, nowMs, options.query.toMs))
+        {
+            std::fwprintf(stderr, L"[Query] Cannot read time '%ls'\n", options.to.c_str());
+            return 2;
+        }
+
+        if (options.historyDirectory.empty())
+        {
+            options.historyDirectory = (ExecutableDirectory() / L"history").wstring();
+        }
+
+        const auto started = std::chrono::steady_clock::now();
+        rvrse::core::HistoryReader reader(options.historyDirectory);
+        std::wstring error;
+        bool succeeded = false;
+        if (options.command == Command::Series)
+        {
+            std::vector<rvrse::core::HistorySeries> series;
+            succeeded = reader.Series(options.query, series, error);
+            PrintSeries(options, series);
+        }
+        else
+        {
+            std::vector<rvrse::core::HistoryPeak> peaks;
+            succeeded = reader.Peaks(options.query, peaks, error);
+            PrintPeaks(options, peaks);
+        }
+
+        if (!succeeded)
+        {
+            std::fwprintf(stderr, L"[Query] %ls\n", error.c_str());
+            return 3;
+        }
+
+        const rvrse::core::HistoryScanStats &stats = reader.Stats();
+        std::fwprintf(stderr,
+                      L"[Query] %llu of %llu frames read (%ls) from %zu segments in %.2f s\n",
+                      static_cast<unsigned long long>(stats.framesRead),
+                      static_cast<unsigned long long>(stats.frames),
+                      rvrse::common::FormatSize(stats.bytesRead).c_str(),
+                      stats.segments,
+                      std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+        if (stats.segments == 0)
+        {
+            std::fwprintf(stderr, L"[Query] No recorded history in '%ls' for that window\n", options.historyDirectory.c_str());
+        }
+        return 0;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(int argc, wchar_t **argv)
+{
+    std::vector<std::wstring> args(argv, argv + argc);
+    return RunQuery(args);
+}
+#else
+int main(int argc, char **argv)
+{
+    std::vector<std::wstring> args;
+    args.reserve(static_cast<std::size_t>(argc));
+    for (int index = 0; index < argc; ++index)
+    {
+        args.push_back(std::filesystem::path(argv[index]).wstring());
+    }
+    return RunQuery(args);
+}
+#endif
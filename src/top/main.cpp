@@ -0,0 +1,940 @@
+// rvrse-top: top-style terminal frontend for servers without a desktop
+// session. Uses the monitor's filter and sort (ProcessView) over the same
+// process capture and redraws through a damage-tracked TerminalScreen, so a
+// refresh only writes the cells that changed.
+//
+//   rvrse-top [--interval <ms>] [--sort <cpu|memory|private|threads|name|pid>]
+//             [--filter <query>] [--frames <n>]
+//
+// The filter is a ProcessQuery ("name:nginx ws>100MB conn>0"); handles and
+// connections are only captured while it refers to them.
+//
+// Keys: c/m/v/t/n/i sort by CPU, working set, private bytes, threads, name
+// or PID (again to reverse); / edits the filter (Enter keeps it, Esc clears
+// it); arrows, PgUp/PgDn, Home/End scroll; Ctrl+L repaints; q quits.
+// --frames exits after that many refreshes and prints what they cost.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <cwchar>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "handle_snapshot.h"
+#include "network_snapshot.h"
+#include "process_snapshot.h"
+#include "process_view.h"
+#include "self_usage.h"
+#include "socket.h"
+#include "system_metrics.h"
+#include "terminal_screen.h"
+#include "rvrse/common/formatting.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <csignal>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keys beyond the Unicode range for the ones without a character.
+    constexpr char32_t kKeyUp = 0x110000;
+    constexpr char32_t kKeyDown = 0x110001;
+    constexpr char32_t kKeyPageUp = 0x110002;
+    constexpr char32_t kKeyPageDown = 0x110003;
+    constexpr char32_t kKeyHome = 0x110004;
+    constexpr char32_t kKeyEnd = 0x110005;
+    constexpr char32_t kKeyEscape = 0x1B;
+    constexpr char32_t kKeyRepaint = 0x0C;  // Ctrl+L
+
+    // Lines above and below the process rows.
+    constexpr int kHeaderRows = 4;
+    constexpr int kFooterRows = 1;
+
+    std::atomic<bool> g_stopRequested{false};
+    std::atomic<bool> g_resized{false};
+
+#if defined(_WIN32)
+    BOOL WINAPI ConsoleControlHandler(DWORD)
+    {
+        g_stopRequested.store(true);
+        return TRUE;
+    }
+
+    void InstallSignalHandlers()
+    {
+        SetConsoleCtrlHandler(ConsoleControlHandler, TRUE);
+    }
+
+    // VT output and raw key events on the Windows console.
+    class Terminal
+    {
+    public:
+        ~Terminal() { Close(); }
+
+        bool Open()
+        {
+            input_ = GetStdHandle(STD_INPUT_HANDLE);
+            output_ = GetStdHandle(STD_OUTPUT_HANDLE);
+            if (!GetConsoleMode(input_, &inputMode_) || !GetConsoleMode(output_, &outputMode_))
+            {
+                return false;
+            }
+            outputCodePage_ = GetConsoleOutputCP();
+
+            if (!SetConsoleMode(output_, outputMode_ | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN))
+            {
+                return false;
+            }
+            SetConsoleMode(input_, ENABLE_WINDOW_INPUT);
+            SetConsoleOutputCP(CP_UTF8);
+            open_ = true;
+            return true;
+        }
+
+        void Close()
+        {
+            if (!open_)
+            {
+                return;
+            }
+            SetConsoleMode(input_, inputMode_);
+            SetConsoleMode(output_, outputMode_);
+            SetConsoleOutputCP(outputCodePage_);
+            open_ = false;
+        }
+
+        bool Size(int &columns, int &rows) const
+        {
+            CONSOLE_SCREEN_BUFFER_INFO info{};
+            if (!GetConsoleScreenBufferInfo(output_, &info))
+            {
+                return false;
+            }
+            columns = info.srWindow.Right - info.srWindow.Left + 1;
+            rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+            return true;
+        }
+
+        void Write(const std::string &text) const
+        {
+            std::size_t offset = 0;
+            while (offset < text.size())
+            {
+                DWORD written = 0;
+                const DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(text.size() - offset, 1 << 20));
+                if (!WriteFile(output_, text.data() + offset, chunk, &written, nullptr) || written == 0)
+                {
+                    return;
+                }
+                offset += written;
+            }
+        }
+
+        // Waits up to timeout for input and appends the keys pressed.
+        void ReadKeys(std::chrono::milliseconds timeout, std::vector<char32_t> &keys)
+        {
+            if (WaitForSingleObject(input_, static_cast<DWORD>(std::max<long long>(timeout.count(), 0))) != WAIT_OBJECT_0)
+            {
+                return;
+            }
+
+            INPUT_RECORD records[32];
+            DWORD count = 0;
+            if (!ReadConsoleInputW(input_, records, static_cast<DWORD>(std::size(records)), &count))
+            {
+                return;
+            }
+
+            for (DWORD index = 0; index < count; ++index)
+            {
+                const INPUT_RECORD &record = records[index];
+                if (record.EventType == WINDOW_BUFFER_SIZE_EVENT)
+                {
+                    g_resized.store(true);
+                    continue;
+                }
+                if (record.EventType != KEY_EVENT || !record.Event.KeyEvent.bKeyDown)
+                {
+                    continue;
+                }
+
+                switch (record.Event.KeyEvent.wVirtualKeyCode)
+                {
+                case VK_UP:
+                    keys.push_back(kKeyUp);
+                    break;
+                case VK_DOWN:
+                    keys.push_back(kKeyDown);
+                    break;
+                case VK_PRIOR:
+                    keys.push_back(kKeyPageUp);
+                    break;
+                case VK_NEXT:
+                    keys.push_back(kKeyPageDown);
+                    break;
+                case VK_HOME:
+                    keys.push_back(kKeyHome);
+                    break;
+                case VK_END:
+                    keys.push_back(kKeyEnd);
+                    break;
+                default:
+                    if (record.Event.KeyEvent.uChar.UnicodeChar != 0)
+                    {
+                        keys.push_back(static_cast<char32_t>(record.Event.KeyEvent.uChar.UnicodeChar));
+                    }
+                    break;
+                }
+            }
+        }
+
+    private:
+        HANDLE input_ = nullptr;
+        HANDLE output_ = nullptr;
+        DWORD inputMode_ = 0;
+        DWORD outputMode_ = 0;
+        UINT outputCodePage_ = 0;
+        bool open_ = false;
+    };
+#else
+    void HandleStopSignal(int)
+    {
+        g_stopRequested.store(true);
+    }
+
+    void HandleResizeSignal(int)
+    {
+        g_resized.store(true);
+    }
+
+    void InstallSignalHandlers()
+    {
+        // No SA_RESTART: a signal should cut the input wait short.
+        struct sigaction action{};
+        sigemptyset(&action.sa_mask);
+        action.sa_handler = HandleStopSignal;
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        action.sa_handler = HandleResizeSignal;
+        sigaction(SIGWINCH, &action, nullptr);
+    }
+
+    // Raw (non-canonical, no echo) input and VT output on a tty.
+    class Terminal
+    {
+    public:
+        ~Terminal() { Close(); }
+
+        bool Open()
+        {
+            if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO) || tcgetattr(STDIN_FILENO, &saved_) != 0)
+            {
+                return false;
+            }
+
+            termios raw = saved_;
+            raw.c_lflag &= static_cast<tcflag_t>(~(ICANON | ECHO));
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+            if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0)
+            {
+                return false;
+            }
+            open_ = true;
+            return true;
+        }
+
+        void Close()
+        {
+            if (open_)
+            {
+                tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_);
+                open_ = false;
+            }
+        }
+
+        bool Size(int &columns, int &rows) const
+        {
+            winsize size{};
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 || size.ws_row == 0)
+            {
+                return false;
+            }
+            columns = size.ws_col;
+            rows = size.ws_row;
+            return true;
+        }
+
+        void Write(const std::string &text) const
+        {
+            std::size_t offset = 0;
+            while (offset < text.size())
+            {
+                const ssize_t written = write(STDOUT_FILENO, text.data() + offset, text.size() - offset);
+                if (written <= 0)
+                {
+                    return;
+                }
+                offset += static_cast<std::size_t>(written);
+            }
+        }
+
+        void ReadKeys(std::chrono::milliseconds timeout, std::vector<char32_t> &keys)
+        {
+            pollfd descriptor{STDIN_FILENO, POLLIN, 0};
+            if (poll(&descriptor, 1, static_cast<int>(std::max<long long>(timeout.count(), 0))) <= 0)
+            {
+                return;
+            }
+
+            char buffer[64];
+            const ssize_t received = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (received > 0)
+            {
+                ParseKeys(std::string_view(buffer, static_cast<std::size_t>(received)), keys);
+            }
+        }
+
+    private:
+        // Decodes UTF-8 and the common xterm/VT cursor key sequences. A
+        // sequence split across reads comes out as Esc plus characters.
+        static void ParseKeys(std::string_view input, std::vector<char32_t> &keys)
+        {
+            std::size_t index = 0;
+            while (index < input.size())
+            {
+                const auto byte = static_cast<unsigned char>(input[index]);
+                if (byte == 0x1B && index + 2 < input.size() && (input[index + 1] == '[' || input[index + 1] == 'O'))
+                {
+                    std::size_t end = index + 2;
+                    while (end < input.size() && input[end] >= '0' && input[end] <= '9')
+                    {
+                        ++end;
+                    }
+                    if (end == input.size())
+                    {
+                        return;
+                    }
+
+                    const std::string_view parameter = input.substr(index + 2, end - index - 2);
+                    switch (input[end])
+                    {
+                    case 'A':
+                        keys.push_back(kKeyUp);
+                        break;
+                    case 'B':
+                        keys.push_back(kKeyDown);
+                        break;
+                    case 'H':
+                        keys.push_back(kKeyHome);
+                        break;
+                    case 'F':
+                        keys.push_back(kKeyEnd);
+                        break;
+                    case '~':
+                        if (parameter == "5")
+                        {
+                            keys.push_back(kKeyPageUp);
+                        }
+                        else if (parameter == "6")
+                        {
+                            keys.push_back(kKeyPageDown);
+                        }
+                        else if (parameter == "1" || parameter == "7")
+                        {
+                            keys.push_back(kKeyHome);
+                        }
+                        else if (parameter == "4" || parameter == "8")
+                        {
+                            keys.push_back(kKeyEnd);
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                    index = end + 1;
+                    continue;
+                }
+
+                std::size_t length = 1;
+                char32_t ch = byte;
+                if (byte >= 0xF0)
+                {
+                    length = 4;
+                    ch = byte & 0x07;
+                }
+                else if (byte >= 0xE0)
+                {
+                    length = 3;
+                    ch = byte & 0x0F;
+                }
+                else if (byte >= 0xC0)
+                {
+                    length = 2;
+                    ch = byte & 0x1F;
+                }
+                if (index + length > input.size())
+                {
+                    return;
+                }
+                for (std::size_t next = 1; next < length; ++next)
+                {
+                    ch = (ch << 6) | (static_cast<unsigned char>(input[index + next]) & 0x3F);
+                }
+                keys.push_back(ch);
+                index += length;
+            }
+        }
+
+        termios saved_{};
+        bool open_ = false;
+    };
+#endif
+
+    struct TopOptions
+    {
+        std::chrono::milliseconds interval{1000};
+        rvrse::core::ProcessSortColumn sortColumn = rvrse::core::ProcessSortColumn::CpuPercent;
+        std::wstring filter;
+        std::uint64_t maxFrames = 0;
+    };
+
+    struct SortKey
+    {
+        wchar_t key;
+        const wchar_t *argument;
+        const wchar_t *title;
+        rvrse::core::ProcessSortColumn column;
+        bool ascending;
+    };
+
+    // Numbers start largest-first like top; name and PID alphabetical.
+    constexpr SortKey kSortKeys[] = {
+        {L'c', L"cpu", L"CPU%", rvrse::core::ProcessSortColumn::CpuPercent, false},
+        {L'm', L"memory", L"working set", rvrse::core::ProcessSortColumn::WorkingSet, false},
+        {L'v', L"private", L"private bytes", rvrse::core::ProcessSortColumn::PrivateBytes, false},
+        {L't', L"threads", L"threads", rvrse::core::ProcessSortColumn::Threads, false},
+        {L'n', L"name", L"name", rvrse::core::ProcessSortColumn::Name, true},
+        {L'i', L"pid", L"PID", rvrse::core::ProcessSortColumn::ProcessId, true},
+    };
+
+    const SortKey *FindSortKey(rvrse::core::ProcessSortColumn column)
+    {
+        for (const SortKey &sortKey : kSortKeys)
+        {
+            if (sortKey.column == column)
+            {
+                return &sortKey;
+            }
+        }
+        return &kSortKeys[0];
+    }
+
+    class TopApp
+    {
+    public:
+        TopApp(const TopOptions &options, Terminal &terminal)
+            : options_(options),
+              terminal_(terminal),
+              host_(rvrse::core::LocalHostName())
+        {
+            view_.SetSort(options.sortColumn, FindSortKey(options.sortColumn)->ascending);
+            view_.SetFilter(options.filter, filterError_);
+            filterText_ = options.filter;
+        }
+
+        int Run()
+        {
+            terminal_.Write("\x1b[?1049h\x1b[?25l");
+            Resize();
+
+            Clock::time_point nextRefresh = Clock::now();
+            std::vector<char32_t> keys;
+            bool dirty = true;
+            while (!g_stopRequested.load() && !quit_)
+            {
+                const Clock::time_point now = Clock::now();
+                if (now >= nextRefresh || refreshNow_)
+                {
+                    refreshNow_ = false;
+                    Refresh();
+                    ++refreshes_;
+                    dirty = true;
+
+                    // Stay on the interval grid; after a stall, skip ahead.
+                    nextRefresh += options_.interval;
+                    if (nextRefresh <= now)
+                    {
+                        nextRefresh = now + options_.interval;
+                    }
+                }
+
+                if (g_resized.exchange(false))
+                {
+                    Resize();
+                    dirty = true;
+                }
+
+                if (dirty)
+                {
+                    Draw();
+                    frame_.clear();
+                    screen_.Render(frame_);
+                    terminal_.Write(frame_);
+                    bytesWritten_ += frame_.size();
+                    dirty = false;
+                }
+
+                if (options_.maxFrames != 0 && refreshes_ >= options_.maxFrames)
+                {
+                    break;
+                }
+
+                keys.clear();
+                terminal_.ReadKeys(std::chrono::duration_cast<std::chrono::milliseconds>(nextRefresh - Clock::now()), keys);
+                for (char32_t key : keys)
+                {
+                    dirty |= HandleKey(key);
+                }
+            }
+
+            terminal_.Write("\x1b[0m\x1b[?25h\x1b[?1049l");
+            return 0;
+        }
+
+        std::uint64_t Refreshes() const { return refreshes_; }
+        std::uint64_t BytesWritten() const { return bytesWritten_; }
+
+    private:
+        void Refresh()
+        {
+            // Thread lists are not shown; skipping them is most of the cost
+            // of a capture on Linux.
+            rvrse::core::ProcessCaptureOptions capture;
+            capture.threads = false;
+            snapshot_ = rvrse::core::ProcessSnapshot::Capture(capture, snapshot_);
+
+            // Handles and connections only feed the filter; capture them
+            // while it needs them.
+            capturedHandles_ = view_.Filter().Uses(rvrse::core::ProcessQueryField::Handles);
+            capturedConnections_ = view_.Filter().Uses(rvrse::core::ProcessQueryField::Connections);
+            handles_ = capturedHandles_ ? rvrse::core::HandleSnapshot::Capture() : rvrse::core::HandleSnapshot();
+            network_ = capturedConnections_ ? rvrse::core::NetworkSnapshot::Capture() : rvrse::core::NetworkSnapshot();
+
+            metrics_ = systemSampler_.Sample(snapshot_, handles_, network_);
+            view_.Update(snapshot_,
+                         Clock::now(),
+                         capturedHandles_ ? &handles_ : nullptr,
+                         capturedConnections_ ? &network_ : nullptr);
+            // The first sample is only the baseline; from the second refresh
+            // on, the figure covers a whole interval.
+            self_ = selfSampler_.Sample();
+            selfMeasured_ = refreshes_ > 0;
+        }
+
+        void Resize()
+        {
+            int columns = 80;
+            int rows = 24;
+            terminal_.Size(columns, rows);
+            screen_.Resize(columns, rows);
+        }
+
+        int ListRows() const
+        {
+            return std::max(screen_.Rows() - kHeaderRows - kFooterRows, 0);
+        }
+
+        void Scroll(long long delta)
+        {
+            const long long last = std::max<long long>(static_cast<long long>(view_.Rows().size()) - ListRows(), 0);
+            firstRow_ = static_cast<std::size_t>(std::clamp(static_cast<long long>(firstRow_) + delta, 0LL, last));
+        }
+
+        // Returns whether the screen needs redrawing.
+        bool HandleKey(char32_t key)
+        {
+            if (editingFilter_)
+            {
+                if (key == U'\r' || key == U'\n')
+                {
+                    editingFilter_ = false;
+                }
+                else if (key == kKeyEscape)
+                {
+                    editingFilter_ = false;
+                    filterText_.clear();
+                }
+                else if (key == 0x7F || key == 0x08)
+                {
+                    if (!filterText_.empty())
+                    {
+                        filterText_.pop_back();
+                    }
+                }
+                else if (key >= 0x20 && key < 0x110000)
+                {
+                    filterText_.push_back(static_cast<wchar_t>(key));
+                }
+                else
+                {
+                    return false;
+                }
+
+                // Filter as you type, like the monitor's filter box. A query
+                // that does not compile yet keeps the last one that did.
+                ApplyFilter();
+                firstRow_ = 0;
+                return true;
+            }
+
+            switch (key)
+            {
+            case U'q':
+            case U'Q':
+                quit_ = true;
+                return false;
+            case U'/':
+                editingFilter_ = true;
+                return true;
+            case kKeyEscape:
+                filterText_.clear();
+                ApplyFilter();
+                return true;
+            case kKeyUp:
+                Scroll(-1);
+                return true;
+            case kKeyDown:
+                Scroll(1);
+                return true;
+            case kKeyPageUp:
+                Scroll(-ListRows());
+                return true;
+            case kKeyPageDown:
+                Scroll(ListRows());
+                return true;
+            case kKeyHome:
+                firstRow_ = 0;
+                return true;
+            case kKeyEnd:
+                Scroll(static_cast<long long>(view_.Rows().size()));
+                return true;
+            case kKeyRepaint:
+                screen_.Invalidate();
+                return true;
+            default:
+                break;
+            }
+
+            for (const SortKey &sortKey : kSortKeys)
+            {
+                if (key == static_cast<char32_t>(sortKey.key))
+                {
+                    // Same key again reverses, like clicking a list view column.
+                    const bool ascending = view_.SortColumn() == sortKey.column ? !view_.SortAscending() : sortKey.ascending;
+                    view_.SetSort(sortKey.column, ascending);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void ApplyFilter()
+        {
+            if (view_.SetFilter(filterText_, filterError_))
+            {
+                filterError_.clear();
+            }
+
+            // A new reference to handles or connections should not wait a
+            // whole interval for its first capture.
+            refreshNow_ = (view_.Filter().Uses(rvrse::core::ProcessQueryField::Handles) && !capturedHandles_) ||
+                          (view_.Filter().Uses(rvrse::core::ProcessQueryField::Connections) && !capturedConnections_);
+        }
+
+        void PutRight(int row, const std::wstring &text, std::uint8_t attributes = rvrse::core::kScreenNormal)
+        {
+            screen_.Put(std::max(screen_.Columns() - static_cast<int>(text.size()), 0), row, text, attributes);
+        }
+
+        void Draw()
+        {
+            screen_.Clear();
+            wchar_t line[512];
+
+            const std::time_t now = std::time(nullptr);
+            wchar_t clock[16] = L"";
+            if (const std::tm *local = std::localtime(&now))
+            {
+                std::wcsftime(clock, std::size(clock), L"%H:%M:%S", local);
+            }
+            const std::uint64_t uptimeSeconds = metrics_.uptimeMilliseconds / 1000;
+            std::swprintf(line,
+                          std::size(line),
+                          L"rvrse-top  %ls  %ls  up %llud %02llu:%02llu",
+                          host_.c_str(),
+                          clock,
+                          static_cast<unsigned long long>(uptimeSeconds / 86400),
+                          static_cast<unsigned long long>(uptimeSeconds / 3600 % 24),
+                          static_cast<unsigned long long>(uptimeSeconds / 60 % 60));
+            screen_.Put(0, 0, line, rvrse::core::kScreenBold);
+
+            if (selfMeasured_)
+            {
+                std::swprintf(line, std::size(line), L"self %.1f%% CPU", self_.cpuPercent);
+                PutRight(0, line, rvrse::core::kScreenDim);
+            }
+
+            std::swprintf(line,
+                          std::size(line),
+                          L"CPU %5.1f%%   Memory %5.1f%% of %ls   Processes %llu   Threads %llu",
+                          metrics_.cpuUsagePercent,
+                          metrics_.memoryUsagePercent,
+                          rvrse::common::FormatSize(metrics_.physicalMemoryTotalBytes).c_str(),
+                          static_cast<unsigned long long>(metrics_.processCount),
+                          static_cast<unsigned long long>(metrics_.threadCount));
+            screen_.Put(0, 1, line);
+
+            const SortKey *sortKey = FindSortKey(view_.SortColumn());
+            int column = screen_.Put(0, 2, L"Sort: ");
+            std::swprintf(line, std::size(line), L"%ls %ls", sortKey->title, view_.SortAscending() ? L"ascending" : L"descending");
+            column += screen_.Put(column, 2, line, rvrse::core::kScreenBold);
+            column += screen_.Put(column, 2, L"   Filter: ");
+            if (editingFilter_)
+            {
+                column += screen_.Put(column, 2, filterText_, rvrse::core::kScreenReverse);
+                screen_.Put(column, 2, L" ", rvrse::core::kScreenReverse);
+            }
+            else
+            {
+                screen_.Put(column, 2, filterText_.empty() ? std::wstring_view(L"(none)") : std::wstring_view(filterText_), rvrse::core::kScreenBold);
+            }
+            std::swprintf(line, std::size(line), L"%zu of %zu", view_.Rows().size(), view_.TotalCount());
+            PutRight(2, line);
+
+            std::swprintf(line,
+                          std::size(line),
+                          L"%7ls %6ls %5ls %4ls %12ls %14ls  %-*ls",
+                          L"PID",
+                          L"PPID",
+                          L"CPU%",
+                          L"THR",
+                          L"WORKING SET",
+                          L"PRIVATE BYTES",
+                          std::max(screen_.Columns(), 0),
+                          L"NAME");
+            screen_.Put(0, kHeaderRows - 1, line, rvrse::core::kScreenReverse);
+
+            // Scrolled past the end after the list shrank: pull back. Only
+            // the rows up to the bottom of the screen need sorting.
+            Scroll(0);
+            view_.SetSortLimit(firstRow_ + static_cast<std::size_t>(ListRows()));
+            const std::vector<rvrse::core::ProcessRow> &rows = view_.Rows();
+            const std::size_t visible = std::min(rows.size() - std::min(firstRow_, rows.size()), static_cast<std::size_t>(ListRows()));
+            // A screen row showing the same process with the same figures as
+            // last frame keeps its text; only changed rows are formatted.
+            rowText_.resize(visible);
+            for (std::size_t index = 0; index < visible; ++index)
+            {
+                const rvrse::core::ProcessRow &row = rows[firstRow_ + index];
+                const rvrse::core::ProcessEntry &process = *row.process;
+                RowText &text = rowText_[index];
+                if (!text.valid || text.rowHash != row.rowHash || text.cpuPercent != row.cpuPercent)
+                {
+                    wchar_t workingSet[rvrse::common::kFormatSizeCapacity];
+                    wchar_t privateBytes[rvrse::common::kFormatSizeCapacity];
+                    const int length = std::swprintf(line,
+                                                     std::size(line),
+                                                     L"%7u %6u %5.1f %4u %12ls %14ls  ",
+                                                     process.processId,
+                                                     process.parentProcessId,
+                                                     row.cpuPercent,
+                                                     process.threadCount,
+                                                     rvrse::common::FormatSize(process.workingSetBytes, workingSet).data(),
+                                                     rvrse::common::FormatSize(process.privateBytes, privateBytes).data());
+                    text.text.assign(line, static_cast<std::size_t>(std::max(length, 0)));
+                    text.rowHash = row.rowHash;
+                    text.cpuPercent = row.cpuPercent;
+                    text.valid = true;
+                }
+                const int screenRow = kHeaderRows + static_cast<int>(index);
+                const int nameColumn = screen_.Put(0, screenRow, text.text);
+                screen_.PutUtf8(nameColumn, screenRow, process.imageName.Utf8());
+            }
+
+            if (!filterError_.empty())
+            {
+                screen_.Put(0, screen_.Rows() - 1, L"Filter: " + filterError_, rvrse::core::kScreenBold);
+            }
+            else
+            {
+                screen_.Put(0,
+                            screen_.Rows() - 1,
+                            L"q quit  c/m/v/t/n/i sort  / filter  Esc clear  \x2191\x2193 PgUp PgDn scroll",
+                            rvrse::core::kScreenDim);
+            }
+        }
+
+        TopOptions options_;
+        Terminal &terminal_;
+        std::wstring host_;
+
+        rvrse::core::ProcessSnapshot snapshot_;
+        rvrse::core::HandleSnapshot handles_;
+        rvrse::core::NetworkSnapshot network_;
+        rvrse::core::SystemMetricsSampler systemSampler_;
+        rvrse::core::SystemMetrics metrics_;
+        rvrse::core::SelfUsageSampler selfSampler_;
+        rvrse::core::SelfUsage self_;
+        bool selfMeasured_ = false;
+        rvrse::core::ProcessView view_;
+
+        // Formatted figures of each list row on screen, keyed by what they
+        // were formatted from.
+        struct RowText
+        {
+            std::wstring text;
+            std::uint64_t rowHash = 0;
+            double cpuPercent = 0.0;
+            bool valid = false;
+        };
+
+        rvrse::core::TerminalScreen screen_;
+        std::vector<RowText> rowText_;
+        std::string frame_;
+        std::size_t firstRow_ = 0;
+        std::wstring filterText_;
+        std::wstring filterError_;
+        bool editingFilter_ = false;
+        bool capturedHandles_ = false;
+        bool capturedConnections_ = false;
+        bool refreshNow_ = false;
+        bool quit_ = false;
+
+        std::uint64_t refreshes_ = 0;
+        std::uint64_t bytesWritten_ = 0;
+    };
+
+    bool ParseArguments(const std::vector<std::wstring> &args, TopOptions &options)
+    {
+        for (std::size_t index = 1; index < args.size(); ++index)
+        {
+            const std::wstring &arg = args[index];
+            const bool hasValue = index + 1 < args.size();
+
+            if (arg == L"--interval" && hasValue)
+            {
+                const unsigned long long interval = std::wcstoull(args[++index].c_str(), nullptr, 10);
+                if (interval == 0)
+                {
+                    return false;
+                }
+                options.interval = std::chrono::milliseconds(interval);
+            }
+            else if (arg == L"--sort" && hasValue)
+            {
+                const std::wstring &name = args[++index];
+                const auto found = std::find_if(std::begin(kSortKeys), std::end(kSortKeys), [&name](const SortKey &sortKey)
+                                                { return name == sortKey.argument; });
+                if (found == std::end(kSortKeys))
+                {
+                    return false;
+                }
+                options.sortColumn = found->column;
+            }
+            else if (arg == L"--filter" && hasValue)
+            {
+                options.filter = args[++index];
+            }
+            else if (arg == L"--frames" && hasValue)
+            {
+                options.maxFrames = std::wcstoull(args[++index].c_str(), nullptr, 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int RunTop(const std::vector<std::wstring> &args)
+    {
+        TopOptions options;
+        if (!ParseArguments(args, options))
+        {
+            std::fputws(L"usage: rvrse-top [--interval <ms>] [--sort <cpu|memory|private|threads|name|pid>] "
+                        L"[--filter <query>] [--frames <n>]\n",
+                        stderr);
+            return 2;
+        }
+
+        rvrse::core::ProcessQuery query;
+        std::wstring error;
+        if (!rvrse::core::ProcessQuery::Compile(options.filter, query, error))
+        {
+            std::fwprintf(stderr, L"[Top] Invalid filter: %ls\n", error.c_str());
+            return 2;
+        }
+
+        Terminal terminal;
+        if (!terminal.Open())
+        {
+            std::fputws(L"[Top] Standard input and output must be a terminal\n", stderr);
+            return 3;
+        }
+
+        InstallSignalHandlers();
+        rvrse::core::SelfUsageSampler usage;
+        usage.Sample();
+
+        TopApp app(options, terminal);
+        const int result = app.Run();
+        terminal.Close();
+
+        if (options.maxFrames != 0)
+        {
+            const std::uint64_t refreshes = std::max<std::uint64_t>(app.Refreshes(), 1);
+            std::fwprintf(stderr,
+                          L"[Top] %llu refreshes, %llu bytes written (%llu per refresh), %.2f%% CPU\n",
+                          static_cast<unsigned long long>(app.Refreshes()),
+                          static_cast<unsigned long long>(app.BytesWritten()),
+                          static_cast<unsigned long long>(app.BytesWritten() / refreshes),
+                          usage.Sample().cpuPercent);
+        }
+        return result;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(int argc, wchar_t **argv)
+{
+    std::vector<std::wstring> args(argv, argv + argc);
+    return RunTop(args);
+}
+#else
+int main(int argc, char **argv)
+{
+    std::vector<std::wstring> args;
+    args.reserve(static_cast<std::size_t>(argc));
+    for (int index = 0; index < argc; ++index)
+    {
+        args.push_back(std::filesystem::path(argv[index]).wstring());
+    }
+    return RunTop(args);
+}
+#endif
@@ -3,31 +3,101 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <cwchar>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <system_error>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "process_snapshot.h"
+#include "ndjson_exporter.h"
 #include "network_snapshot.h"
+#include "openmetrics_exporter.h"
+#include "collector.h"
+#include "collector_config.h"
+#include "column_reduce.h"
 #include "driver_interface.h"
 #include "driver_service.h"
+#include "dynamic_library.h"
+#include "fleet_aggregator.h"
+#include "fleet_index.h"
 #include "handle_snapshot.h"
+#include "history_query.h"
+#include "json_writer.h"
+#include "metrics_registry.h"
+#include "name_matcher.h"
 #include "plugin_loader.h"
+#include "process_columns.h"
+#include "process_order.h"
+#include "process_query.h"
+#include "process_view.h"
+#include "procfs.h"
+#include "self_usage.h"
+#include "snapshot_arena.h"
+#include "snapshot_ring.h"
+#include "socket.h"
+#include "string_interner.h"
+#include "system_metrics.h"
+#include "terminal_screen.h"
+#include "wire_client.h"
+#include "wire_exporter.h"
+#include "wire_protocol.h"
 #include "rvrse/common/formatting.h"
+#include "rvrse/common/log_writer.h"
 #include "rvrse/common/string_utils.h"
 #include "rvrse/common/time_utils.h"
 
+namespace
+{
+    // Set by a HeapAllocationCounter on its thread; counts every global
+    // operator new that thread makes while it is alive.
+    thread_local std::size_t *g_heapAllocations = nullptr;
+}
+
+void *operator new(std::size_t size)
+{
+    if (g_heapAllocations)
+    {
+        ++*g_heapAllocations;
+    }
+    if (void *pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
 namespace
 {
     int g_failures = 0;
@@ -101,11 +171,11 @@ namespace
         int ipv4Count = 0;
         for (const auto &connection : connections)
         {
-            if (connection.addressFamily == rvrse::core::AddressFamily::IPv4)
+            if (connection.Family() == rvrse::core::AddressFamily::IPv4)
             {
                 ipv4Count++;
                 // IPv4 should use localAddress field
-                if (connection.localAddress == 0 && connection.localPort == 0)
+                if (connection.LocalAddress() == 0 && connection.localPort == 0)
                 {
                     // Listening on any address is valid
                 }
@@ -116,14 +186,14 @@ namespace
         int ipv6Count = 0;
         for (const auto &connection : connections)
         {
-            if (connection.addressFamily == rvrse::core::AddressFamily::IPv6)
+            if (connection.Family() == rvrse::core::AddressFamily::IPv6)
             {
                 ipv6Count++;
                 // IPv6 should use localAddress6 field (at least one byte should be non-zero)
                 bool hasValidAddr = false;
                 for (int i = 0; i < 16; ++i)
                 {
-                    if (connection.localAddress6[i] != 0)
+                    if (connection.LocalAddress6()[i] != 0)
                     {
                         hasValidAddr = true;
                         break;
@@ -297,6 +367,82 @@ namespace
         return (elapsedSeconds * 1000.0) / iterations;
     }
 
+    // The std::wostringstream formatting FormatSize/FormatDuration/
+    // FormatTimestamp used before they moved to std::to_chars: reference
+    // output for the buffer overloads and the baseline of BenchmarkFormatting.
+    std::wstring StreamFormatSize(std::uint64_t bytes)
+    {
+        static constexpr std::array<const wchar_t *, 5> kUnits = {
+            L"B", L"KB", L"MB", L"GB", L"TB"};
+
+        double value = static_cast<double>(bytes);
+        size_t unitIndex = 0;
+        while (value >= 1024.0 && unitIndex + 1 < kUnits.size())
+        {
+            value /= 1024.0;
+            ++unitIndex;
+        }
+
+        std::wostringstream stream;
+        stream << std::fixed << std::setprecision(unitIndex == 0 ? 0 : 1) << value << L' ' << kUnits[unitIndex];
+        return stream.str();
+    }
+
+    std::wstring StreamFormatDuration(std::chrono::milliseconds duration)
+    {
+        const auto totalMs = duration.count();
+        const bool negative = totalMs < 0;
+        std::uint64_t magnitude = negative ? static_cast<std::uint64_t>(-(totalMs + 1)) + 1 : static_cast<std::uint64_t>(totalMs);
+
+        const std::uint64_t hours = magnitude / 3600000ULL;
+        magnitude %= 3600000ULL;
+        const std::uint64_t minutes = magnitude / 60000ULL;
+        magnitude %= 60000ULL;
+
+        std::wostringstream stream;
+        if (negative)
+        {
+            stream << L"-";
+        }
+
+        stream << std::setfill(L'0') << std::setw(2) << hours << L":"
+               << std::setw(2) << minutes << L":"
+               << std::setw(2) << magnitude / 1000ULL << L"."
+               << std::setw(3) << magnitude % 1000ULL;
+        return stream.str();
+    }
+
+    std::wstring StreamFormatTimestamp(std::chrono::system_clock::time_point timePoint)
+    {
+        const auto timeT = std::chrono::system_clock::to_time_t(timePoint);
+        std::tm utc{};
+        gmtime_s(&utc, &timeT);
+
+        std::wostringstream stream;
+        stream << std::put_time(&utc, L"%Y-%m-%d %H:%M:%S");
+        return stream.str();
+    }
+
+    // Byte counts around every unit boundary and the ".x5" rounding edges.
+    std::vector<std::uint64_t> MakeFormatSizeSamples()
+    {
+        std::vector<std::uint64_t> samples = {0, 1, 999, 1000, 1023, 1024, 1025, 1535, 1536, 1587, 1588, 1638, 1639,
+                                              1048524, 1048525, 1048526, 1048575, 1048576,
+                                              std::numeric_limits<std::uint64_t>::max() - 1,
+                                              std::numeric_limits<std::uint64_t>::max()};
+        for (int shift = 10; shift < 64; ++shift)
+        {
+            const std::uint64_t power = static_cast<std::uint64_t>(1) << shift;
+            samples.push_back(power - 1);
+            samples.push_back(power);
+            samples.push_back(power + 1);
+            samples.push_back(power + power / 20);
+            samples.push_back(power * 3 / 2);
+        }
+
+        return samples;
+    }
+
     void TestFormatSize()
     {
         struct TestCase
@@ -353,6 +499,29 @@ namespace
                               test.expected);
                 ReportFailure(buffer);
             }
+
+            wchar_t sizeBuffer[rvrse::common::kFormatSizeCapacity];
+            if (rvrse::common::FormatSize(test.bytes, sizeBuffer) != test.expected || std::wcscmp(sizeBuffer, test.expected) != 0)
+            {
+                ReportFailure(L"FormatSize buffer overload differs from the string overload.");
+            }
+        }
+
+        for (const std::uint64_t bytes : MakeFormatSizeSamples())
+        {
+            wchar_t sizeBuffer[rvrse::common::kFormatSizeCapacity];
+            const std::wstring expected = StreamFormatSize(bytes);
+            if (rvrse::common::FormatSize(bytes, sizeBuffer) != expected || rvrse::common::FormatSize(bytes) != expected)
+            {
+                wchar_t buffer[256];
+                std::swprintf(buffer,
+                              std::size(buffer),
+                              L"[FormatSize] %llu => %s (stream formatting gives %s)",
+                              static_cast<unsigned long long>(bytes),
+                              sizeBuffer,
+                              expected.c_str());
+                ReportFailure(buffer);
+            }
         }
     }
 
@@ -418,6 +587,87 @@ namespace
         }
     }
 
+    void TestUtfTranscoding()
+    {
+        // A non-ASCII character at every offset of a 70-byte ASCII run, so the
+        // 16- and 32-byte fast paths hand over to the scalar code everywhere.
+        const std::wstring specials[] = {L"\u00e9", L"\u2603", L"\U0001F680"};
+        for (const std::wstring &special : specials)
+        {
+            for (std::size_t offset = 0; offset <= 70; ++offset)
+            {
+                std::wstring text(70, L'a');
+                for (std::size_t index = 0; index < text.size(); ++index)
+                {
+                    text[index] = static_cast<wchar_t>(L'a' + index % 26);
+                }
+                text.insert(offset, special);
+
+                const std::string utf8 = rvrse::common::WideToUtf8(text);
+                if (utf8.size() != 70 + rvrse::common::WideToUtf8(special).size() || rvrse::common::Utf8ToWide(utf8) != text)
+                {
+                    ReportFailure(L"UTF-8 round trip failed around a fast-path boundary.");
+                    return;
+                }
+            }
+        }
+
+        if (rvrse::common::WideToUtf8(L"\U0001F680") != "\xF0\x9F\x9A\x80" || rvrse::common::WideToUtf8(L"\u00e9t\u00e9") != "\xC3\xA9t\xC3\xA9")
+        {
+            ReportFailure(L"WideToUtf8 produced the wrong bytes.");
+        }
+
+        const char *invalidUtf8[] = {
+            "\xC0\xAF",             // overlong '/'
+            "\xE0\x80\xAF",         // overlong '/'
+            "\xED\xA0\x80",         // encoded surrogate
+            "\xF4\x90\x80\x80",     // past U+10FFFF
+            "\xF8\x88\x80\x80\x80", // five-byte form
+            "\xE2\x82",             // truncated
+            "\x80",                 // stray continuation byte
+            "0123456789abcdef0123456789abcdef0123456789\xFF",
+        };
+        for (const char *input : invalidUtf8)
+        {
+            if (!rvrse::common::Utf8ToWide(input).empty())
+            {
+                ReportFailure(L"Utf8ToWide accepted invalid UTF-8.");
+            }
+            if (rvrse::common::IsValidUtf8(input))
+            {
+                ReportFailure(L"IsValidUtf8 accepted invalid UTF-8.");
+            }
+        }
+        if (!rvrse::common::IsValidUtf8("") || !rvrse::common::IsValidUtf8("0123456789abcdef0123456789abcdef caf\xC3\xA9 \xF0\x9F\x98\x80"))
+        {
+            ReportFailure(L"IsValidUtf8 rejected valid UTF-8.");
+        }
+
+        std::wstring loneSurrogate = L"0123456789abcdef0123456789abcdef!";
+        loneSurrogate.push_back(static_cast<wchar_t>(0xD800));
+        if (!rvrse::common::WideToUtf8(loneSurrogate).empty())
+        {
+            ReportFailure(L"WideToUtf8 accepted an unpaired surrogate.");
+        }
+
+        // Bulk conversions stop at the end of the caller's buffer.
+        const std::string sample = "Rvrse \xE2\x98\x83";
+        wchar_t wide[8];
+        std::size_t written = 0;
+        if (rvrse::common::Utf8ToWide(sample, wide, 6, written) || written != 6 ||
+            !rvrse::common::Utf8ToWide(sample, wide, 7, written) || written != 7 || std::wstring_view(wide, written) != L"Rvrse \u2603")
+        {
+            ReportFailure(L"Utf8ToWide into a buffer mishandled its capacity.");
+        }
+
+        char narrow[16];
+        if (rvrse::common::WideToUtf8(L"Rvrse \u2603", narrow, 8, written) || written != 6 ||
+            !rvrse::common::WideToUtf8(L"Rvrse \u2603", narrow, 9, written) || std::string_view(narrow, written) != sample)
+        {
+            ReportFailure(L"WideToUtf8 into a buffer mishandled its capacity.");
+        }
+    }
+
     void TestTimeFormatting()
     {
         using namespace std::chrono;
@@ -452,6 +702,134 @@ namespace
         {
             ReportFailure(L"FormatTimestamp failed for unix epoch.");
         }
+
+        const milliseconds durations[] = {milliseconds(0), milliseconds(3723456), milliseconds(-1890), milliseconds(999),
+                                          hours(99) + minutes(59) + seconds(59), hours(100), hours(-123456) - milliseconds(7),
+                                          milliseconds(std::numeric_limits<milliseconds::rep>::max()),
+                                          milliseconds(std::numeric_limits<milliseconds::rep>::min())};
+        for (const milliseconds &span : durations)
+        {
+            wchar_t buffer[rvrse::common::kFormatDurationCapacity];
+            if (rvrse::common::FormatDuration(span, buffer) != StreamFormatDuration(span) ||
+                rvrse::common::FormatDuration(span) != StreamFormatDuration(span))
+            {
+                ReportFailure(L"FormatDuration differs from stream formatting.");
+            }
+        }
+
+        const std::int64_t instants[] = {0, 59, 951782400, 1609459199, 1609459200, 1709251199, 4102444800};
+        for (const std::int64_t instant : instants)
+        {
+            const system_clock::time_point timePoint{seconds(instant)};
+            wchar_t buffer[rvrse::common::kFormatTimestampCapacity];
+            if (rvrse::common::FormatTimestamp(timePoint, buffer) != StreamFormatTimestamp(timePoint) ||
+                rvrse::common::FormatTimestamp(timePoint) != StreamFormatTimestamp(timePoint))
+            {
+                ReportFailure(L"FormatTimestamp differs from stream formatting.");
+            }
+        }
+    }
+
+    void BenchmarkFormatting()
+    {
+        // The byte counts of TestFormatSizeMaxValues, each formatted kRepeats
+        // times per iteration.
+        const std::uint64_t samples[] = {0, 1023, 1024, 1048576, static_cast<std::uint64_t>(1) << 40,
+                                         std::numeric_limits<std::uint64_t>::max()};
+        constexpr int kRepeats = 1000;
+        constexpr double kCalls = kRepeats * static_cast<double>(std::size(samples));
+        const int iterations = 50;
+        std::size_t checksum = 0;
+
+        const double streamMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (int repeat = 0; repeat < kRepeats; ++repeat)
+                {
+                    for (const std::uint64_t bytes : samples)
+                    {
+                        checksum += StreamFormatSize(bytes).size();
+                    }
+                }
+            },
+            iterations);
+
+        const double stringMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (int repeat = 0; repeat < kRepeats; ++repeat)
+                {
+                    for (const std::uint64_t bytes : samples)
+                    {
+                        checksum += rvrse::common::FormatSize(bytes).size();
+                    }
+                }
+            },
+            iterations);
+
+        const double bufferMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                wchar_t buffer[rvrse::common::kFormatSizeCapacity];
+                for (int repeat = 0; repeat < kRepeats; ++repeat)
+                {
+                    for (const std::uint64_t bytes : samples)
+                    {
+                        checksum += rvrse::common::FormatSize(bytes, buffer).size();
+                    }
+                }
+            },
+            iterations);
+
+        const auto now = std::chrono::system_clock::now();
+        const double streamTimeMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (int repeat = 0; repeat < kRepeats; ++repeat)
+                {
+                    checksum += StreamFormatDuration(std::chrono::milliseconds(3723456 + repeat)).size();
+                    checksum += StreamFormatTimestamp(now).size();
+                }
+            },
+            iterations);
+
+        const double bufferTimeMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                wchar_t durationBuffer[rvrse::common::kFormatDurationCapacity];
+                wchar_t timestampBuffer[rvrse::common::kFormatTimestampCapacity];
+                for (int repeat = 0; repeat < kRepeats; ++repeat)
+                {
+                    checksum += rvrse::common::FormatDuration(std::chrono::milliseconds(3723456 + repeat), durationBuffer).size();
+                    checksum += rvrse::common::FormatTimestamp(now, timestampBuffer).size();
+                }
+            },
+            iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] FormatSize per call: %.1f ns buffer, %.1f ns string, %.1f ns wostringstream; "
+                      L"FormatDuration+FormatTimestamp per pair: %.1f ns buffer, %.1f ns wostringstream (checksum %zu)\n",
+                      bufferMs * 1e6 / kCalls,
+                      stringMs * 1e6 / kCalls,
+                      streamMs * 1e6 / kCalls,
+                      bufferTimeMs * 1e6 / kRepeats,
+                      streamTimeMs * 1e6 / kRepeats,
+                      checksum);
+
+        // 6,000 calls: well under a millisecond unless something allocates
+        // or goes through a stream again.
+        const double thresholdMs = 1.0;
+        const bool passed = bufferMs <= thresholdMs && bufferMs < streamMs && bufferTimeMs < streamTimeMs;
+        if (!passed)
+        {
+            ReportFailure(L"Buffer formatting is not faster than stream formatting.");
+        }
+
+        RecordBenchmarkResult(L"FormatSizeBuffer",
+                              bufferMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
     }
 
     void TestProcessSnapshot()
@@ -572,90 +950,425 @@ namespace
         }
     }
 
-    void TestHandleSnapshot()
+    class HeapAllocationCounter
     {
-        auto handles = rvrse::core::HandleSnapshot::Capture();
-        if (handles.Handles().empty())
+    public:
+        HeapAllocationCounter() { g_heapAllocations = &count_; }
+        ~HeapAllocationCounter() { g_heapAllocations = nullptr; }
+        HeapAllocationCounter(const HeapAllocationCounter &) = delete;
+        HeapAllocationCounter &operator=(const HeapAllocationCounter &) = delete;
+
+        std::size_t Count() const { return count_; }
+
+    private:
+        std::size_t count_ = 0;
+    };
+
+#if defined(__linux__)
+    void TestProcStatParsing()
+    {
+        // A real-time task (SCHED_FIFO 99) reports priority -100 in field 18.
+        const std::string_view realTime =
+            "18 (migration/0) S 2 0 0 0 -1 69238848 0 0 0 0 0 7 0 0 -100 0 1 0 3 0 0 18446744073709551615 "
+            "0 0 0 0 0 0 0 2147483647 0 0 0 0 0 0 99 1 0 0 0 0 0 0 0 0 0 0\n";
+        rvrse::core::procfs::StatFields fields;
+        if (!rvrse::core::procfs::ParseStat(realTime, fields) || fields.name != "migration/0" || fields.state != 'S' ||
+            fields.parentProcessId != 2 || fields.kernelTicks != 7 || fields.priority != -100 || fields.threadCount != 1)
         {
-            ReportFailure(L"Handle snapshot returned zero handles.");
-            return;
+            ReportFailure(L"ParseStat() rejected or misread a real-time task with a negative priority.");
         }
 
-        DWORD pid = GetCurrentProcessId();
-        auto handleCount = handles.HandleCountForProcess(pid);
-        if (handleCount == 0)
+        // comm may hold spaces and parentheses; fields count from the last ')'.
+        const std::string_view tricky =
+            "4242 (a) b (c) R 1 4242 4242 0 -1 4194304 10 0 0 0 12 34 0 0 20 0 3 0 100 4096 25 "
+            "18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 2 0 0 0 0 0\n";
+        if (!rvrse::core::procfs::ParseStat(tricky, fields) || fields.name != "a) b (c" || fields.state != 'R' ||
+            fields.userTicks != 12 || fields.kernelTicks != 34 || fields.priority != 20 || fields.threadCount != 3 ||
+            fields.residentPages != 25)
         {
-            ReportFailure(L"Handle snapshot did not include any handles for current process.");
+            ReportFailure(L"ParseStat() misread a command name containing parentheses.");
+        }
+
+        if (rvrse::core::procfs::ParseStat("12 (truncated) S 1 2", fields) ||
+            rvrse::core::procfs::ParseStat("12 (bad) S 1 0 0 0 -1 0 0 0 0 0 1 1 0 0 x 0 1 0 0 0 0", fields))
+        {
+            ReportFailure(L"ParseStat() accepted a malformed stat line.");
         }
     }
+#endif
 
-    void TestHandleSnapshotAccessDenied()
+    void TestProcessSnapshotGenerations()
     {
-        auto handles = rvrse::core::HandleSnapshot::Capture();
-        if (handles.Handles().empty())
+        // An arena regrows to cover what it overflowed, so the same
+        // allocations after Reset() fit in its block.
         {
-            ReportFailure(L"Handle snapshot returned zero handles for access coverage.");
-            return;
+            rvrse::core::SnapshotArena arena;
+            std::pmr::vector<std::uint64_t> first(4096, 1, arena.Resource());
+            if (arena.OverflowBytes() < first.size() * sizeof(std::uint64_t))
+            {
+                ReportFailure(L"SnapshotArena did not count the bytes it overflowed into.");
+            }
+            first = std::pmr::vector<std::uint64_t>(arena.Resource());
+            arena.Reset();
+            if (arena.CapacityBytes() < 4096 * sizeof(std::uint64_t) || arena.OverflowBytes() != 0)
+            {
+                ReportFailure(L"SnapshotArena::Reset() did not grow its block to the last generation.");
+            }
+
+            HeapAllocationCounter counter;
+            std::pmr::vector<std::uint64_t> second(4096, 2, arena.Resource());
+            if (counter.Count() != 0 || arena.OverflowBytes() != 0)
+            {
+                ReportFailure(L"A recycled SnapshotArena went to the heap for what fit in its block.");
+            }
         }
 
-        DWORD currentPid = GetCurrentProcessId();
-        auto handlesForSelf = handles.HandlesForProcess(currentPid);
-        auto countForSelf = handles.HandleCountForProcess(currentPid);
-        if (handlesForSelf.size() != countForSelf)
+        // Copies share a generation, which outlives the snapshot it came from.
         {
-            ReportFailure(L"Handle snapshot count and filtered size diverged for current process.");
+            std::vector<rvrse::core::ProcessEntry> entries(3);
+            for (std::size_t index = 0; index < entries.size(); ++index)
+            {
+                entries[index].processId = static_cast<std::uint32_t>(30 - index * 10);
+                entries[index].threads.resize(index + 1);
+            }
+
+            rvrse::core::ProcessSnapshot original(entries);
+            rvrse::core::ProcessSnapshot copy = original;
+            if (&copy.Processes() != &original.Processes())
+            {
+                ReportFailure(L"Copying a ProcessSnapshot did not share its generation.");
+            }
+            original = rvrse::core::ProcessSnapshot();
+            if (copy.Processes().size() != 3 || copy.Processes().front().processId != 10 ||
+                copy.Processes().back().threads.size() != 1 || copy.Arrays().processIds.back() != 30 ||
+                !original.Processes().empty() || !original.Arrays().processIds.empty())
+            {
+                ReportFailure(L"A ProcessSnapshot copy lost its entries when the original was dropped.");
+            }
+
+            // Dropping and rebuilding reuses the generation.
+            copy = rvrse::core::ProcessSnapshot();
+            const std::size_t generations = rvrse::core::ProcessSnapshot::PooledGenerations();
+            for (int round = 0; round < 8; ++round)
+            {
+                rvrse::core::ProcessSnapshot rebuilt(entries);
+            }
+            if (rvrse::core::ProcessSnapshot::PooledGenerations() != generations)
+            {
+                ReportFailure(L"Dropped process snapshot generations were not recycled.");
+            }
         }
 
-        const std::uint32_t invalidPid = std::numeric_limits<std::uint32_t>::max();
-        if (!handles.HandlesForProcess(invalidPid).empty() || handles.HandleCountForProcess(invalidPid) != 0)
+        // A capture loop settles on two generations and no heap allocations.
+        // Processes starting between captures can still grow a generation,
+        // so the zero-allocation capture gets a few attempts.
+        rvrse::core::ProcessSnapshot snapshot;
+        for (int warmup = 0; warmup < 3; ++warmup)
         {
-            ReportFailure(L"Handle snapshot returned entries for an invalid PID.");
+            snapshot = rvrse::core::ProcessSnapshot::Capture();
         }
-    }
 
-    void BenchmarkProcessSnapshot()
-    {
-        const int iterations = 5;
-        const double thresholdMs = 150.0;
-        double averageMs = MeasureAverageMilliseconds(
-            []()
+        constexpr int kAttempts = 5;
+        std::size_t allocations = 0;
+        for (int attempt = 0; attempt < kAttempts; ++attempt)
+        {
+            HeapAllocationCounter counter;
+            snapshot = rvrse::core::ProcessSnapshot::Capture();
+            allocations = counter.Count();
+            if (allocations == 0)
             {
-                auto snapshot = rvrse::core::ProcessSnapshot::Capture();
-                std::wstring lastName;
-                if (!snapshot.Processes().empty())
-                {
-                    lastName = snapshot.Processes().back().imageName;
-                }
-                (void)lastName;
-            },
-            iterations);
+                break;
+            }
+        }
+        if (allocations != 0)
+        {
+            wchar_t buffer[160];
+            std::swprintf(buffer, std::size(buffer), L"A steady-state process capture made %zu heap allocations.", allocations);
+            ReportFailure(buffer);
+        }
 
-        std::fwprintf(stdout, L"[PERF] ProcessSnapshot avg: %.2f ms\n", averageMs);
-        const bool passed = averageMs <= thresholdMs;
-        if (!passed)
+        // A reader holding a generation keeps its entries intact while the
+        // loop moves on, at the cost of one more generation.
+        const std::size_t generations = rvrse::core::ProcessSnapshot::PooledGenerations();
+        const rvrse::core::ProcessSnapshot held = snapshot;
+        const std::vector<std::uint32_t> heldIds = held.Arrays().processIds;
+        std::size_t heldThreads = 0;
+        for (const auto &process : held.Processes())
         {
-            ReportFailure(L"ProcessSnapshot performance regression detected.");
+            heldThreads += process.threads.size();
+        }
+        for (int round = 0; round < 3; ++round)
+        {
+            snapshot = rvrse::core::ProcessSnapshot::Capture();
         }
 
-        RecordBenchmarkResult(L"ProcessSnapshot",
-                              averageMs,
-                              thresholdMs,
-                              iterations,
-                              passed);
+        std::size_t threadsAfter = 0;
+        bool idsMatch = held.Processes().size() == heldIds.size();
+        for (std::size_t index = 0; idsMatch && index < heldIds.size(); ++index)
+        {
+            const auto &process = held.Processes()[index];
+            idsMatch = process.processId == heldIds[index];
+            threadsAfter += process.threads.size();
+        }
+        if (!idsMatch || threadsAfter != heldThreads)
+        {
+            ReportFailure(L"A held process snapshot changed while later captures ran.");
+        }
+        if (rvrse::core::ProcessSnapshot::PooledGenerations() > generations + 1)
+        {
+            ReportFailure(L"Holding one process snapshot cost more than one extra generation.");
+        }
     }
 
-    void BenchmarkHandleSnapshot()
+    void TestSnapshotHandles()
     {
-        const int iterations = 5;
-        const double thresholdMs = 200.0;
-        double averageMs = MeasureAverageMilliseconds(
-            []()
-            {
-                auto handles = rvrse::core::HandleSnapshot::Capture();
-                volatile std::size_t count = handles.Handles().size();
-                (void)count;
-            },
-            iterations);
+        std::vector<rvrse::core::ProcessEntry> entries(4);
+        for (std::size_t index = 0; index < entries.size(); ++index)
+        {
+            entries[index].processId = static_cast<std::uint32_t>(400 - index * 100);
+            entries[index].imageName = index % 2 == 0 ? L"even.exe" : L"odd.exe";
+            entries[index].threads.resize(index + 1);
+        }
+
+        rvrse::core::ProcessSnapshot snapshot(entries);
+        const rvrse::core::ProcessRef found = snapshot.Find(300);
+        if (!found || found.Index() != 2 || found->threads.size() != 2 || &*found != &snapshot.Processes()[2] ||
+            snapshot.Find(250) || snapshot.Find(500) || snapshot.At(4) || !snapshot.At(0) ||
+            rvrse::core::ProcessRef())
+        {
+            ReportFailure(L"ProcessSnapshot::Find()/At() returned the wrong process handle.");
+        }
+
+        // A handle outlives the snapshot it came from, without a copy.
+        const rvrse::core::ProcessEntry *entry = &*found;
+        snapshot = rvrse::core::ProcessSnapshot();
+        if (&*found != entry || found->processId != 300 || found->imageName.View() != L"odd.exe" ||
+            found.Snapshot().Processes().size() != 4)
+        {
+            ReportFailure(L"A ProcessRef did not keep its generation alive.");
+        }
+
+        // Rows of a view updated from a snapshot map back to shared handles.
+        rvrse::core::ProcessView view;
+        std::wstring error;
+        view.SetSort(rvrse::core::ProcessSortColumn::ProcessId, false);
+        view.Update(found.Snapshot(), std::chrono::steady_clock::now());
+        const rvrse::core::ProcessRef first = view.Ref(0);
+        if (view.Rows().size() != 4 || !first || first->processId != 400 || &*first != view.Rows()[0].process ||
+            view.Ref(4))
+        {
+            ReportFailure(L"ProcessView::Ref() did not map rows back to the shared snapshot.");
+        }
+        if (!view.SetFilter(L"name:odd", error) || view.Rows().size() != 2 || view.Ref(1)->processId != 100)
+        {
+            ReportFailure(L"ProcessView::Ref() did not follow the filtered rows.");
+        }
+        view.Update(entries, std::chrono::steady_clock::now());
+        if (view.Ref(0))
+        {
+            ReportFailure(L"ProcessView::Ref() returned a handle for rows not taken from a snapshot.");
+        }
+
+        // A process's connections stay readable after the snapshot is replaced.
+        std::vector<rvrse::core::ConnectionEntry> connections(5);
+        for (std::size_t index = 0; index < connections.size(); ++index)
+        {
+            connections[index].owningProcessId = index < 3 ? 7 : 9;
+            connections[index].localPort = static_cast<std::uint16_t>(1000 + index);
+        }
+        rvrse::core::NetworkSnapshot network(connections);
+        const rvrse::core::NetworkSnapshot sharedNetwork = network;
+        const rvrse::core::ConnectionRows rows = network.RowsForProcess(7);
+        const rvrse::core::ConnectionEntry *firstConnection = &network.Connections()[0];
+        network = rvrse::core::NetworkSnapshot();
+        if (rows.size() != 3 || rows.begin() != firstConnection || rows[2].localPort != 1002 ||
+            &sharedNetwork.Connections()[0] != firstConnection || !network.Connections().empty() ||
+            !sharedNetwork.RowsForProcess(8).empty() || sharedNetwork.RowsForProcess(9).size() != 2)
+        {
+            ReportFailure(L"ConnectionRows did not share the network snapshot's connections.");
+        }
+    }
+
+    void TestRowChangeTracking()
+    {
+        std::vector<rvrse::core::ProcessEntry> entries(3);
+        for (std::size_t index = 0; index < entries.size(); ++index)
+        {
+            entries[index].processId = static_cast<std::uint32_t>(10 + index);
+            entries[index].parentProcessId = 1;
+            entries[index].imageName = L"row.exe";
+            entries[index].threadCount = 2;
+            entries[index].workingSetBytes = 4096;
+        }
+
+        // Every displayed field feeds the row hash; the thread list does not.
+        const std::uint64_t baseline = rvrse::core::ProcessRowHash(entries[0]);
+        const auto hashChanges = [&](auto &&mutate)
+        {
+            rvrse::core::ProcessEntry changed = entries[0];
+            mutate(changed);
+            return rvrse::core::ProcessRowHash(changed) != baseline;
+        };
+        if (!hashChanges([](auto &entry) { entry.processId = 99; }) ||
+            !hashChanges([](auto &entry) { entry.parentProcessId = 2; }) ||
+            !hashChanges([](auto &entry) { entry.imageName = L"other.exe"; }) ||
+            !hashChanges([](auto &entry) { entry.threadCount = 3; }) ||
+            !hashChanges([](auto &entry) { entry.workingSetBytes = 8192; }) ||
+            !hashChanges([](auto &entry) { entry.privateBytes = 1; }) ||
+            !hashChanges([](auto &entry) { entry.kernelTime100ns = 1; }) ||
+            !hashChanges([](auto &entry) { entry.userTime100ns = 1; }) ||
+            hashChanges([](auto &entry) { entry.threads.resize(4); }))
+        {
+            ReportFailure(L"ProcessRowHash() did not track exactly the displayed fields.");
+        }
+
+        const rvrse::core::ProcessSnapshot first(entries);
+        const std::uint64_t s1 = first.Sequence();
+        if (rvrse::core::ProcessSnapshot().Sequence() != 0 || s1 == 0 ||
+            first.Arrays().rowHashes.size() != 3 || first.Arrays().changedSequences.size() != 3 ||
+            first.Arrays().rowHashes[0] != baseline || !first.RowChangedSince(0, s1 - 1) || first.RowChangedSince(2, s1))
+        {
+            ReportFailure(L"A snapshot without a previous one did not stamp every row as new.");
+        }
+
+        // PID 10 is unchanged, 11 grows, 12 exits and 13 starts.
+        entries[1].workingSetBytes = 8192;
+        entries[2].processId = 13;
+        const rvrse::core::ProcessSnapshot second(entries, first);
+        const std::uint64_t s2 = second.Sequence();
+        const auto &changed = second.Arrays().changedSequences;
+        if (s2 <= s1 || changed.size() != 3 || changed[0] != s1 || changed[1] != s2 || changed[2] != s2 ||
+            second.RowChangedSince(0, s1) || !second.RowChangedSince(1, s1) || !second.RowChangedSince(2, s1))
+        {
+            ReportFailure(L"Row change stamps did not follow the previous snapshot.");
+        }
+
+        // An unchanged row keeps its stamp across further generations.
+        const rvrse::core::ProcessSnapshot third(entries, second);
+        if (third.Sequence() <= s2 || third.Arrays().changedSequences[0] != s1 ||
+            third.Arrays().changedSequences[1] != s2 || third.RowChangedSince(1, s2))
+        {
+            ReportFailure(L"An unchanged row lost its change stamp.");
+        }
+
+        // Sealed against an empty snapshot (a failed capture, a decoded wire
+        // frame), the sequence still moves forward, so a consumer that drew
+        // the third one redraws every row instead of skipping them all.
+        const rvrse::core::ProcessSnapshot restarted(entries, rvrse::core::ProcessSnapshot());
+        bool allChanged = restarted.Sequence() > third.Sequence();
+        for (std::size_t index = 0; index < restarted.Processes().size(); ++index)
+        {
+            allChanged = allChanged && restarted.RowChangedSince(index, third.Sequence());
+        }
+        if (!allChanged)
+        {
+            ReportFailure(L"A snapshot sealed against an empty one reused an earlier sequence.");
+        }
+
+        // View rows carry the hash, whether taken from a snapshot or a vector.
+        rvrse::core::ProcessView view;
+        view.SetSort(rvrse::core::ProcessSortColumn::ProcessId, false);
+        view.Update(third, std::chrono::steady_clock::now());
+        bool hashesMatch = view.Rows().size() == 3;
+        for (const auto &row : view.Rows())
+        {
+            hashesMatch = hashesMatch && row.rowHash == rvrse::core::ProcessRowHash(*row.process);
+        }
+        view.Update(entries, std::chrono::steady_clock::now());
+        for (const auto &row : view.Rows())
+        {
+            hashesMatch = hashesMatch && row.rowHash == rvrse::core::ProcessRowHash(*row.process);
+        }
+        if (!hashesMatch)
+        {
+            ReportFailure(L"ProcessView rows did not carry the process row hash.");
+        }
+    }
+
+    void TestHandleSnapshot()
+    {
+        auto handles = rvrse::core::HandleSnapshot::Capture();
+        if (handles.Handles().empty())
+        {
+            ReportFailure(L"Handle snapshot returned zero handles.");
+            return;
+        }
+
+        DWORD pid = GetCurrentProcessId();
+        auto handleCount = handles.HandleCountForProcess(pid);
+        if (handleCount == 0)
+        {
+            ReportFailure(L"Handle snapshot did not include any handles for current process.");
+        }
+    }
+
+    void TestHandleSnapshotAccessDenied()
+    {
+        auto handles = rvrse::core::HandleSnapshot::Capture();
+        if (handles.Handles().empty())
+        {
+            ReportFailure(L"Handle snapshot returned zero handles for access coverage.");
+            return;
+        }
+
+        DWORD currentPid = GetCurrentProcessId();
+        auto handlesForSelf = handles.HandlesForProcess(currentPid);
+        auto countForSelf = handles.HandleCountForProcess(currentPid);
+        if (handlesForSelf.size() != countForSelf)
+        {
+            ReportFailure(L"Handle snapshot count and filtered size diverged for current process.");
+        }
+
+        const std::uint32_t invalidPid = std::numeric_limits<std::uint32_t>::max();
+        if (!handles.HandlesForProcess(invalidPid).empty() || handles.HandleCountForProcess(invalidPid) != 0)
+        {
+            ReportFailure(L"Handle snapshot returned entries for an invalid PID.");
+        }
+    }
+
+    void BenchmarkProcessSnapshot()
+    {
+        const int iterations = 5;
+        const double thresholdMs = 150.0;
+        double averageMs = MeasureAverageMilliseconds(
+            []()
+            {
+                auto snapshot = rvrse::core::ProcessSnapshot::Capture();
+                std::wstring lastName;
+                if (!snapshot.Processes().empty())
+                {
+                    lastName = snapshot.Processes().back().imageName;
+                }
+                (void)lastName;
+            },
+            iterations);
+
+        std::fwprintf(stdout, L"[PERF] ProcessSnapshot avg: %.2f ms\n", averageMs);
+        const bool passed = averageMs <= thresholdMs;
+        if (!passed)
+        {
+            ReportFailure(L"ProcessSnapshot performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"ProcessSnapshot",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    void BenchmarkHandleSnapshot()
+    {
+        const int iterations = 5;
+        const double thresholdMs = 200.0;
+        double averageMs = MeasureAverageMilliseconds(
+            []()
+            {
+                auto handles = rvrse::core::HandleSnapshot::Capture();
+                volatile std::size_t count = handles.Handles().size();
+                (void)count;
+            },
+            iterations);
 
         std::fwprintf(stdout, L"[PERF] HandleSnapshot avg: %.2f ms\n", averageMs);
         const bool passed = averageMs <= thresholdMs;
@@ -747,16 +1460,4557 @@ namespace
                               widePassed);
     }
 
+    // Image names and full paths as a process list sees them: mostly ASCII,
+    // some with accented, CJK or emoji characters.
+    std::vector<std::wstring> MakeTranscodingCorpus(bool paths)
+    {
+        static const wchar_t *kNames[] = {
+            L"svchost.exe", L"explorer.exe", L"chrome.exe", L"RuntimeBroker.exe", L"MsMpEng.exe",
+            L"SearchIndexer.exe", L"Microsoft.Photos.exe", L"nginx", L"systemd-journald", L"postgres",
+            L"Caf\u00e9Manager.exe", L"\u00dcberwachung.exe", L"\u5fae\u4fe1.exe", L"\U0001F680launcher.exe",
+            L"WmiPrvSE.exe", L"dotnet", L"code", L"kworker/u16:3-events_unbound"};
+        static const wchar_t *kDirectories[] = {
+            L"C:\\Windows\\System32\\", L"C:\\Program Files\\Google\\Chrome\\Application\\",
+            L"C:\\Users\\J\u00fcrgen\\AppData\\Local\\Programs\\Microsoft VS Code\\",
+            L"C:\\Program Files\\WindowsApps\\Microsoft.Windows.Photos_2024.11050.3002.0_x64__8wekyb3d8bbwe\\",
+            L"/usr/lib/systemd/", L"/home/\u7530\u4e2d/.local/share/", L"/usr/sbin/"};
+
+        std::vector<std::wstring> corpus;
+        for (std::size_t index = 0; index < 2000; ++index)
+        {
+            std::wstring name = kNames[index % std::size(kNames)];
+            corpus.push_back(paths ? kDirectories[index % std::size(kDirectories)] + name : name);
+        }
+        return corpus;
+    }
+
+    void BenchmarkUtfTranscoding()
+    {
+        const int iterations = 50;
+        const double thresholdMs = 2.0;
+        bool passed = true;
+
+        for (const bool paths : {false, true})
+        {
+            const std::vector<std::wstring> wideCorpus = MakeTranscodingCorpus(paths);
+            std::vector<std::string> utf8Corpus;
+            std::size_t utf8Bytes = 0;
+            for (const std::wstring &text : wideCorpus)
+            {
+                utf8Corpus.push_back(rvrse::common::WideToUtf8(text));
+                utf8Bytes += utf8Corpus.back().size();
+            }
+
+            std::vector<wchar_t> wideBuffer(1024);
+            std::vector<char> utf8Buffer(1024 * rvrse::common::kMaxUtf8BytesPerWideChar);
+            std::size_t checksum = 0;
+
+            const double toWideMs = MeasureAverageMilliseconds(
+                [&]()
+                {
+                    for (const std::string &text : utf8Corpus)
+                    {
+                        std::size_t written = 0;
+                        rvrse::common::Utf8ToWide(text, wideBuffer.data(), wideBuffer.size(), written);
+                        checksum += written;
+                    }
+                },
+                iterations);
+
+            const double toUtf8Ms = MeasureAverageMilliseconds(
+                [&]()
+                {
+                    for (const std::wstring &text : wideCorpus)
+                    {
+                        std::size_t written = 0;
+                        rvrse::common::WideToUtf8(text, utf8Buffer.data(), utf8Buffer.size(), written);
+                        checksum += written;
+                    }
+                },
+                iterations);
+
+            // Baseline: the Win32 conversions the string overloads used to wrap,
+            // sizing pass included.
+            const double win32ToWideMs = MeasureAverageMilliseconds(
+                [&]()
+                {
+                    for (const std::string &text : utf8Corpus)
+                    {
+                        const int length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.data(), static_cast<int>(text.size()), nullptr, 0);
+                        checksum += static_cast<std::size_t>(
+                            MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.data(), static_cast<int>(text.size()), wideBuffer.data(), length));
+                    }
+                },
+                iterations);
+
+            const double win32ToUtf8Ms = MeasureAverageMilliseconds(
+                [&]()
+                {
+                    for (const std::wstring &text : wideCorpus)
+                    {
+                        const int length = WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, text.data(), static_cast<int>(text.size()), nullptr, 0, nullptr, nullptr);
+                        checksum += static_cast<std::size_t>(WideCharToMultiByte(CP_UTF8,
+                                                                                 WC_ERR_INVALID_CHARS,
+                                                                                 text.data(),
+                                                                                 static_cast<int>(text.size()),
+                                                                                 utf8Buffer.data(),
+                                                                                 length,
+                                                                                 nullptr,
+                                                                                 nullptr));
+                    }
+                },
+                iterations);
+
+            const double megabytes = static_cast<double>(utf8Bytes) / (1024.0 * 1024.0);
+            std::fwprintf(stdout,
+                          L"[PERF] UTF transcoding, 2,000 %ls (%.0f KB): UTF-8 to wide %.0f MB/s (Win32 %.0f MB/s), wide to UTF-8 %.0f MB/s (Win32 %.0f MB/s) (checksum %zu)\n",
+                          paths ? L"paths" : L"image names",
+                          static_cast<double>(utf8Bytes) / 1024.0,
+                          toWideMs > 0.0 ? megabytes * 1000.0 / toWideMs : 0.0,
+                          win32ToWideMs > 0.0 ? megabytes * 1000.0 / win32ToWideMs : 0.0,
+                          toUtf8Ms > 0.0 ? megabytes * 1000.0 / toUtf8Ms : 0.0,
+                          win32ToUtf8Ms > 0.0 ? megabytes * 1000.0 / win32ToUtf8Ms : 0.0,
+                          checksum);
+
+            const bool corpusPassed = toWideMs <= thresholdMs && toUtf8Ms <= thresholdMs;
+            RecordBenchmarkResult(paths ? L"Utf8ToWidePaths" : L"Utf8ToWideNames", toWideMs, thresholdMs, iterations, toWideMs <= thresholdMs);
+            RecordBenchmarkResult(paths ? L"WideToUtf8Paths" : L"WideToUtf8Names", toUtf8Ms, thresholdMs, iterations, toUtf8Ms <= thresholdMs);
+            passed = passed && corpusPassed;
+        }
+
+        if (!passed)
+        {
+            ReportFailure(L"Bulk UTF transcoding performance regression detected.");
+        }
+    }
+
     void TestPluginLoaderInitialization()
     {
         rvrse::core::PluginLoader loader(L".\\nonexistent_plugins_path");
         loader.LoadPlugins();
+        if (loader.PluginCount() != 0)
+        {
+            ReportFailure(L"PluginLoader registered plugins from a nonexistent directory.");
+        }
 
         auto snapshot = rvrse::core::ProcessSnapshot::Capture();
         auto handles = rvrse::core::HandleSnapshot::Capture();
+        auto network = rvrse::core::NetworkSnapshot::Capture();
+        rvrse::core::SystemMetricsSampler sampler;
+        auto metrics = sampler.Sample(snapshot, handles, network);
 
         loader.BroadcastProcessSnapshot(snapshot);
         loader.BroadcastHandleSnapshot(handles);
+        loader.BroadcastNetworkSnapshot(network);
+        loader.BroadcastSystemMetrics(metrics);
+    }
+
+    void TestPluginLoaderParallelLoad()
+    {
+        // RvrseTestPlugin is built next to the test binary; see
+        // tests/test_plugin/test_plugin.cpp for how each copy behaves.
+        wchar_t executablePath[MAX_PATH] = {0};
+        GetModuleFileNameW(nullptr, executablePath, static_cast<DWORD>(std::size(executablePath)));
+        const auto fixture = std::filesystem::path(executablePath).parent_path() /
+                             (std::wstring(L"RvrseTestPlugin") + rvrse::core::DynamicLibrary::Extension());
+
+        std::error_code ec;
+        const auto directory = std::filesystem::temp_directory_path(ec) /
+                               (L"RvrsePluginTest-" + std::to_wstring(GetCurrentProcessId()));
+        std::filesystem::remove_all(directory, ec);
+        std::filesystem::create_directories(directory, ec);
+
+        // Copied out of sorted order, so directory order is unlikely to match.
+        const wchar_t *const names[] = {L"plugin_d", L"plugin_b", L"plugin_c_fail", L"plugin_e", L"plugin_a", L"plugin_c"};
+        for (const wchar_t *name : names)
+        {
+            if (!std::filesystem::copy_file(fixture, directory / (std::wstring(name) + rvrse::core::DynamicLibrary::Extension()), ec))
+            {
+                ReportFailure(L"Could not stage copies of the RvrseTestPlugin fixture.");
+                std::filesystem::remove_all(directory, ec);
+                return;
+            }
+        }
+
+        rvrse::core::MetricsRegistry registry;
+        rvrse::common::LogWriter log;
+        rvrse::common::LogWriterOptions logOptions;
+        logOptions.path = (directory / L"host.log").wstring();
+        if (!log.Open(logOptions))
+        {
+            ReportFailure(L"LogWriter failed to open its log file.");
+            std::filesystem::remove_all(directory, ec);
+            return;
+        }
+
+        {
+            rvrse::core::PluginLoader loader(directory.wstring());
+            loader.SetMetricsRegistry(&registry);
+            loader.SetLogWriter(&log);
+            loader.SetMaxInitializationThreads(static_cast<unsigned int>(std::size(names)));
+
+            // Each init sleeps 100 ms; six of them one after another would take 600 ms.
+            const auto start = std::chrono::steady_clock::now();
+            loader.LoadPlugins();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            const auto attempts = registry.Register(L"plugin.test_plugin.attempts", rvrse::core::MetricKind::Counter);
+            const auto initialized = registry.Register(L"plugin.test_plugin.initialized", rvrse::core::MetricKind::Counter);
+            if (registry.Value(attempts) != 6.0 || registry.Value(initialized) != 5.0)
+            {
+                ReportFailure(L"PluginLoader did not run every plugin's initialization.");
+            }
+            if (elapsed > std::chrono::milliseconds(400))
+            {
+                ReportFailure(L"PluginLoader initialized plugins serially despite a worker pool.");
+            }
+            if (loader.PluginCount() != 5)
+            {
+                ReportFailure(L"PluginLoader registered a plugin whose initialization failed.");
+            }
+
+            // Each plugin logs its name when called; the loader calls them in
+            // registration order, which must be sorted path order.
+            loader.BroadcastProcessSnapshot(rvrse::core::ProcessSnapshot());
+            log.Flush();
+        }
+        log.Close();
+
+        std::ifstream stream(std::filesystem::path(logOptions.path), std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        std::size_t position = 0;
+        bool ordered = true;
+        for (const char *name : {"plugin_a\n", "plugin_b\n", "plugin_c\n", "plugin_d\n", "plugin_e\n"})
+        {
+            const std::size_t found = contents.find(name, position);
+            ordered = ordered && found != std::string::npos;
+            position = found == std::string::npos ? position : found;
+        }
+        if (!ordered || contents.find("plugin_c_fail\n") != std::string::npos)
+        {
+            ReportFailure(L"PluginLoader did not register plugins in sorted path order.");
+        }
+
+        std::filesystem::remove_all(directory, ec);
+    }
+
+    void TestDynamicLibrary()
+    {
+        rvrse::core::DynamicLibrary missing;
+        if (missing.Open(L"rvrse_nonexistent_library.dll") || missing.LastError().empty())
+        {
+            ReportFailure(L"DynamicLibrary did not report a failure for a missing library.");
+        }
+
+        rvrse::core::DynamicLibrary kernel;
+        if (!kernel.Open(L"kernel32.dll"))
+        {
+            ReportFailure(L"DynamicLibrary failed to open kernel32.dll.");
+            return;
+        }
+
+        if (!kernel.Symbol("GetCurrentProcessId") || kernel.Symbol("RvrseMissingExport"))
+        {
+            ReportFailure(L"DynamicLibrary symbol lookup returned unexpected results.");
+        }
+
+        rvrse::core::DynamicLibrary moved(std::move(kernel));
+        if (kernel.IsOpen() || !moved.IsOpen())
+        {
+            ReportFailure(L"DynamicLibrary move did not transfer ownership of the module handle.");
+        }
+    }
+
+    void TestMetricsRegistry()
+    {
+        rvrse::core::MetricsRegistry registry;
+        auto counter = registry.Register(L"test.counter", rvrse::core::MetricKind::Counter);
+        auto gauge = registry.Register(L"test.gauge", rvrse::core::MetricKind::Gauge);
+
+        if (counter == rvrse::core::MetricsRegistry::kInvalidHandle ||
+            gauge == rvrse::core::MetricsRegistry::kInvalidHandle || counter == gauge)
+        {
+            ReportFailure(L"MetricsRegistry failed to register distinct metrics.");
+            return;
+        }
+
+        if (registry.Register(L"test.counter", rvrse::core::MetricKind::Counter) != counter)
+        {
+            ReportFailure(L"MetricsRegistry re-registration did not return the existing handle.");
+        }
+
+        if (registry.Register(L"test.counter", rvrse::core::MetricKind::Gauge) != rvrse::core::MetricsRegistry::kInvalidHandle)
+        {
+            ReportFailure(L"MetricsRegistry accepted a kind conflict for an existing name.");
+        }
+
+        constexpr int kThreads = 4;
+        constexpr int kIncrements = 10000;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i)
+        {
+            threads.emplace_back([&]()
+                                 {
+                                     for (int j = 0; j < kIncrements; ++j)
+                                     {
+                                         registry.Add(counter, 1);
+                                     }
+                                 });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        registry.Set(gauge, 42.5);
+        registry.Add(gauge, 1);   // ignored: wrong kind
+        registry.Set(counter, 7); // ignored: wrong kind
+        registry.Add(999, 1);     // ignored: unknown handle
+
+        if (registry.Value(counter) != static_cast<double>(kThreads * kIncrements))
+        {
+            ReportFailure(L"MetricsRegistry lost concurrent counter increments.");
+        }
+
+        if (registry.Value(gauge) != 42.5)
+        {
+            ReportFailure(L"MetricsRegistry gauge did not hold the last value set.");
+        }
+
+        std::vector<rvrse::core::MetricSample> samples;
+        registry.Collect(samples);
+        if (samples.size() != 2 || samples[0].name != L"test.counter" || samples[1].value != 42.5)
+        {
+            ReportFailure(L"MetricsRegistry Collect returned unexpected samples.");
+        }
+
+        rvrse::core::MetricsHistory history(2);
+        history.Record(registry);
+        registry.Set(gauge, 1.0);
+        history.Record(registry);
+        registry.Set(gauge, 2.0);
+        history.Record(registry);
+        const auto *series = history.Series(gauge);
+        if (!series || series->size() != 2 || series->front() != 1.0 || series->back() != 2.0)
+        {
+            ReportFailure(L"MetricsHistory did not retain the most recent samples.");
+        }
+
+        rvrse::core::SystemMetricsPublisher publisher(registry);
+        rvrse::core::SystemMetrics metrics{};
+        metrics.processCount = 123;
+        publisher.Publish(metrics);
+        auto processHandle = registry.Register(L"system.process_count", rvrse::core::MetricKind::Gauge);
+        if (registry.Value(processHandle) != 123.0)
+        {
+            ReportFailure(L"SystemMetricsPublisher did not publish built-in gauges.");
+        }
+    }
+
+    void BenchmarkMetricsRegistry()
+    {
+        rvrse::core::MetricsRegistry registry;
+        auto counter = registry.Register(L"bench.counter", rvrse::core::MetricKind::Counter);
+
+        const int iterations = 100;
+        const double thresholdMs = 1.0;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (int i = 0; i < 10000; ++i)
+                {
+                    registry.Add(counter, 1);
+                }
+            },
+            iterations);
+
+        std::fwprintf(stdout, L"[PERF] MetricsRegistry 10k increments avg: %.4f ms\n", averageMs);
+        const bool passed = averageMs <= thresholdMs;
+        if (!passed)
+        {
+            ReportFailure(L"MetricsRegistry counter update performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"MetricsRegistryAdd10k",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    std::filesystem::path MakeTestLogDirectory(const wchar_t *name)
+    {
+        std::error_code ec;
+        auto directory = std::filesystem::temp_directory_path(ec) /
+                         (std::wstring(L"RvrseLogTest-") + std::to_wstring(GetCurrentProcessId()) + L"-" + name);
+        std::filesystem::remove_all(directory, ec);
+        std::filesystem::create_directories(directory, ec);
+        return directory;
+    }
+
+    std::size_t CountFileLines(const std::filesystem::path &path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        std::string line;
+        std::size_t count = 0;
+        while (std::getline(stream, line))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    void TestLogWriter()
+    {
+        const auto directory = MakeTestLogDirectory(L"basic");
+
+        rvrse::common::LogWriter writer;
+        rvrse::common::LogWriterOptions options;
+        options.path = (directory / L"host.log").wstring();
+        if (!writer.Open(options))
+        {
+            ReportFailure(L"LogWriter failed to open its log file.");
+            return;
+        }
+
+        constexpr int kThreads = 4;
+        constexpr int kLinesPerThread = 2000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            threads.emplace_back([&writer, t]()
+                                 {
+                                     for (int i = 0; i < kLinesPerThread; ++i)
+                                     {
+                                         std::wstring line = L"thread " + std::to_wstring(t) + L" line " + std::to_wstring(i);
+                                         while (!writer.Write(std::wstring_view(line)))
+                                         {
+                                             std::this_thread::yield();
+                                         }
+                                     }
+                                 });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        writer.Flush();
+        if (CountFileLines(std::filesystem::path(options.path)) != static_cast<std::size_t>(kThreads * kLinesPerThread))
+        {
+            ReportFailure(L"LogWriter Flush returned before every queued line reached the file.");
+        }
+
+        writer.Write(std::wstring_view(L"caf\u00e9"));
+        writer.Close();
+        if (writer.Write(std::string_view("after close")))
+        {
+            ReportFailure(L"LogWriter accepted a line after Close.");
+        }
+
+        std::ifstream stream(std::filesystem::path(options.path), std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        if (contents.size() < 6 || contents.compare(contents.size() - 6, 6, "caf\xc3\xa9\n") != 0)
+        {
+            ReportFailure(L"LogWriter did not encode wide input as UTF-8.");
+        }
+
+        // Close() while producers are still writing: every accepted line is
+        // written, and no producer touches the queue after it is freed.
+        for (int round = 0; round < 20; ++round)
+        {
+            rvrse::common::LogWriter racing;
+            rvrse::common::LogWriterOptions racingOptions;
+            racingOptions.path = (directory / (L"racing" + std::to_wstring(round) + L".log")).wstring();
+            racingOptions.queueCapacity = 64;
+            if (!racing.Open(racingOptions))
+            {
+                ReportFailure(L"LogWriter failed to open its log file.");
+                break;
+            }
+
+            std::atomic<std::size_t> accepted{0};
+            std::atomic<bool> go{false};
+            std::vector<std::thread> producers;
+            for (int t = 0; t < kThreads; ++t)
+            {
+                producers.emplace_back([&]()
+                                       {
+                                           while (!go.load())
+                                           {
+                                               std::this_thread::yield();
+                                           }
+                                           for (int i = 0; i < kLinesPerThread; ++i)
+                                           {
+                                               if (racing.Write(std::string_view("racing line")))
+                                               {
+                                                   accepted.fetch_add(1);
+                                               }
+                                           }
+                                       });
+            }
+            go.store(true);
+            std::this_thread::sleep_for(std::chrono::microseconds(100 * round));
+            racing.Close();
+            for (auto &producer : producers)
+            {
+                producer.join();
+            }
+
+            if (CountFileLines(std::filesystem::path(racingOptions.path)) != accepted.load())
+            {
+                ReportFailure(L"LogWriter Close lost lines that producers racing it had been told were accepted.");
+                break;
+            }
+        }
+
+#if defined(__linux__)
+        // Every write to /dev/full fails with ENOSPC: nothing may be counted
+        // as written, and every line must show up as dropped.
+        rvrse::common::LogWriter full;
+        rvrse::common::LogWriterOptions fullOptions;
+        fullOptions.path = L"/dev/full";
+        if (full.Open(fullOptions))
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                full.Write(std::string_view("lost line"));
+            }
+            full.Flush();
+            full.Close();
+            if (full.LinesWritten() != 0 || full.LinesDropped() != 100)
+            {
+                ReportFailure(L"LogWriter counted lines from a failed write as written.");
+            }
+        }
+#endif
+
+        rvrse::common::LogWriter rotating;
+        rvrse::common::LogWriterOptions rotatingOptions;
+        rotatingOptions.path = (directory / L"rotating.log").wstring();
+        rotatingOptions.maxFileBytes = 16 * 1024;
+        rotatingOptions.maxRotatedFiles = 2;
+        rotating.Open(rotatingOptions);
+
+        const std::string line(100, 'x');
+        for (int i = 0; i < 2000; ++i)
+        {
+            rotating.Write(std::string_view(line));
+            if (i % 100 == 0)
+            {
+                rotating.Flush();
+            }
+        }
+        rotating.Close();
+
+        std::error_code ec;
+        if (rotating.Rotations() == 0 ||
+            !std::filesystem::exists(rotatingOptions.path + L".2", ec) ||
+            std::filesystem::exists(rotatingOptions.path + L".3", ec) ||
+            std::filesystem::file_size(rotatingOptions.path, ec) > rotatingOptions.maxFileBytes)
+        {
+            ReportFailure(L"LogWriter size-based rotation did not keep the configured files.");
+        }
+
+        std::filesystem::remove_all(directory, ec);
+    }
+
+    void BenchmarkLogWriter()
+    {
+        const auto directory = MakeTestLogDirectory(L"bench");
+        const std::wstring line = L"[SampleLogger] Processes observed: 312";
+
+        // Baseline: the open/append/close-per-line approach plugins used before
+        // the host log existed.
+        const std::wstring legacyPath = (directory / L"legacy.log").wstring();
+        constexpr int kLegacyLines = 500;
+        double legacyMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (int i = 0; i < kLegacyLines; ++i)
+                {
+                    FILE *file = nullptr;
+                    _wfopen_s(&file, legacyPath.c_str(), L"a+, ccs=UTF-8");
+                    if (file)
+                    {
+                        std::fwprintf(file, L"%s\n", line.c_str());
+                        std::fclose(file);
+                    }
+                }
+            },
+            1);
+
+        rvrse::common::LogWriter writer;
+        rvrse::common::LogWriterOptions options;
+        options.path = (directory / L"buffered.log").wstring();
+        options.maxFileBytes = 0;
+        options.queueCapacity = 32768;
+        writer.Open(options);
+
+        constexpr int kBufferedLines = 20000;
+        const int iterations = 5;
+        const double thresholdMs = 50.0;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (int i = 0; i < kBufferedLines; ++i)
+                {
+                    writer.Write(std::wstring_view(line));
+                }
+                writer.Flush();
+            },
+            iterations);
+        writer.Close();
+
+        const double legacyLinesPerSecond = legacyMs > 0.0 ? kLegacyLines * 1000.0 / legacyMs : 0.0;
+        const double bufferedLinesPerSecond = averageMs > 0.0 ? kBufferedLines * 1000.0 / averageMs : 0.0;
+        std::fwprintf(stdout,
+                      L"[PERF] LogWriter 20k lines + flush avg: %.3f ms (%.0f lines/s buffered vs %.0f lines/s open-per-line)\n",
+                      averageMs,
+                      bufferedLinesPerSecond,
+                      legacyLinesPerSecond);
+
+        const bool passed = averageMs <= thresholdMs && writer.LinesDropped() == 0;
+        if (!passed)
+        {
+            ReportFailure(L"LogWriter throughput regression detected.");
+        }
+
+        RecordBenchmarkResult(L"LogWriter20kLines",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    }
+
+    std::wstring MakeTestRingName(const wchar_t *suffix)
+    {
+        return L"Local\\RvrseTestRing-" + std::to_wstring(GetCurrentProcessId()) + L"-" + suffix;
+    }
+
+    void TestSnapshotRing()
+    {
+        std::vector<rvrse::core::ProcessEntry> entries(2);
+        entries[0].processId = 200;
+        entries[0].imageName = L"second.exe";
+        entries[1].processId = 100;
+        entries[1].imageName = L"first.exe";
+        entries[1].threadCount = 1;
+        entries[1].threads.resize(1);
+        entries[1].threads[0].threadId = 101;
+        entries[1].threads[0].owningProcessId = 100;
+
+        rvrse::core::ProcessSnapshot processes(std::move(entries));
+        rvrse::core::HandleSnapshot handles;
+        std::vector<rvrse::core::ConnectionEntry> connections(1);
+        connections[0].owningProcessId = 100;
+        connections[0].localPort = 443;
+        connections[0].SetLocalAddress(0x0100007F);
+        connections[0].SetState(2);
+        rvrse::core::NetworkSnapshot network(std::move(connections));
+        rvrse::core::SystemMetrics metrics{};
+        metrics.processCount = 2;
+
+        const std::wstring name = MakeTestRingName(L"basic");
+        rvrse::core::SnapshotRingWriter writer;
+        if (!writer.Create(name, 3, 64 * 1024))
+        {
+            ReportFailure(L"SnapshotRingWriter failed to create the shared memory ring.");
+            return;
+        }
+
+        rvrse::core::SnapshotRingReader reader;
+        if (!reader.Open(name))
+        {
+            ReportFailure(L"SnapshotRingReader failed to open an existing ring.");
+            return;
+        }
+
+        rvrse::core::SnapshotRingFrame frame;
+        if (reader.TryReadLatest(frame) != rvrse::core::SnapshotRingReader::ReadStatus::NoNewFrame)
+        {
+            ReportFailure(L"SnapshotRingReader reported a frame before anything was published.");
+        }
+
+        writer.Publish(processes, handles, network, metrics);
+        if (reader.TryReadLatest(frame) != rvrse::core::SnapshotRingReader::ReadStatus::FrameReady)
+        {
+            ReportFailure(L"SnapshotRingReader did not see the first published generation.");
+            return;
+        }
+
+        const auto &view = frame.Processes();
+        if (view.processCount != 2 || view.processes[0].processId != 100 ||
+            std::wcscmp(view.processes[0].imageName, L"first.exe") != 0 ||
+            view.processes[0].threadEntryCount != 1 || view.processes[0].threads[0].threadId != 101 ||
+            frame.Network().connectionCount != 1 || frame.Network().connections[0].localAddress != 0x0100007F ||
+            frame.Network().connections[0].localPort != 443 || frame.Network().connections[0].state != 2 ||
+            frame.Metrics().processCount != 2)
+        {
+            ReportFailure(L"SnapshotRingFrame contents do not match the published snapshot.");
+        }
+
+        // The reader still holds generation 1; the producer must route around
+        // the pinned slot instead of waiting or overwriting it.
+        for (int i = 0; i < 10; ++i)
+        {
+            writer.Publish(processes, handles, network, metrics);
+        }
+
+        if (!reader.IsIntact(frame) || writer.ForcedOverwrites() != 0)
+        {
+            ReportFailure(L"SnapshotRingWriter overwrote a slot pinned by a reader.");
+        }
+
+        if (reader.TryReadLatest(frame) != rvrse::core::SnapshotRingReader::ReadStatus::FrameReady ||
+            frame.Generation() != 11 || reader.SkippedGenerations() != 9)
+        {
+            ReportFailure(L"SnapshotRingReader did not skip to the latest generation.");
+        }
+
+        rvrse::core::SnapshotRingWriter duplicate;
+        if (duplicate.Create(name, 3, 64 * 1024))
+        {
+            ReportFailure(L"SnapshotRingWriter created a ring over an existing name.");
+        }
+
+        writer.Close();
+        if (reader.TryReadLatest(frame) != rvrse::core::SnapshotRingReader::ReadStatus::Closed)
+        {
+            ReportFailure(L"SnapshotRingReader did not report a closed ring.");
+        }
+    }
+
+    void BenchmarkSnapshotRingPublish()
+    {
+        auto processes = rvrse::core::ProcessSnapshot::Capture();
+        auto handles = rvrse::core::HandleSnapshot::Capture();
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+
+        rvrse::core::SnapshotRingWriter writer;
+        if (!writer.Create(MakeTestRingName(L"bench"), rvrse::core::SnapshotRingWriter::kDefaultSlotCount, 64U * 1024U * 1024U))
+        {
+            ReportFailure(L"SnapshotRingWriter failed to create the benchmark ring.");
+            return;
+        }
+
+        const int iterations = 20;
+        const double thresholdMs = 20.0;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                writer.Publish(processes, handles, network, metrics);
+            },
+            iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] SnapshotRing publish avg: %.3f ms (%zu processes, %zu handles)\n",
+                      averageMs,
+                      processes.Processes().size(),
+                      handles.Handles().size());
+        const bool passed = averageMs <= thresholdMs && writer.DroppedFrames() == 0;
+        if (!passed)
+        {
+            ReportFailure(L"SnapshotRing publish performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"SnapshotRingPublish",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    void TestSystemMetricsSampler()
+    {
+        auto snapshot = rvrse::core::ProcessSnapshot::Capture();
+        auto handles = rvrse::core::HandleSnapshot::Capture();
+        auto network = rvrse::core::NetworkSnapshot::Capture();
+
+        rvrse::core::SystemMetricsSampler sampler;
+        auto first = sampler.Sample(snapshot, handles, network);
+        if (first.cpuUsagePercent != 0.0)
+        {
+            ReportFailure(L"SystemMetricsSampler reported CPU usage without a baseline.");
+        }
+
+        Sleep(50);
+        auto second = sampler.Sample(snapshot, handles, network);
+        if (second.cpuUsagePercent < 0.0 || second.cpuUsagePercent > 100.0 ||
+            second.memoryUsagePercent < 0.0 || second.memoryUsagePercent > 100.0)
+        {
+            ReportFailure(L"SystemMetricsSampler produced percentages outside [0, 100].");
+        }
+
+        if (second.physicalMemoryTotalBytes == 0 ||
+            second.physicalMemoryAvailableBytes > second.physicalMemoryTotalBytes)
+        {
+            ReportFailure(L"SystemMetricsSampler reported inconsistent physical memory totals.");
+        }
+
+        if (second.processCount != snapshot.Processes().size() ||
+            second.handleCount != handles.Handles().size() ||
+            second.connectionCount != network.Connections().size())
+        {
+            ReportFailure(L"SystemMetricsSampler totals did not match the supplied snapshots.");
+        }
+    }
+
+    void TestCollectorConfig()
+    {
+        rvrse::core::CollectorConfig config;
+        std::wstring error;
+        const char *text =
+            "\xEF\xBB\xBF# sample\n"
+            "process_interval_ms = 250\n"
+            "; handles off\n"
+            "handle_interval_ms = 0\n"
+            "  cpu_budget_percent=1.5  \n"
+            "memory_budget_mb = 64\n"
+            "plugins = off\n"
+            "plugin_isolation = process\n"
+            "exporters = summary, openmetrics\n";
+        if (!rvrse::core::ParseCollectorConfig(text, config, error))
+        {
+            ReportFailure(L"ParseCollectorConfig rejected a valid config.");
+            return;
+        }
+
+        if (config.processInterval.count() != 250 || config.handleInterval.count() != 0 ||
+            config.networkInterval.count() != 5000 || config.cpuBudgetPercent != 1.5 ||
+            config.memoryBudgetBytes != 64ULL * 1024ULL * 1024ULL || config.pluginsEnabled || !config.isolatePlugins)
+        {
+            ReportFailure(L"ParseCollectorConfig did not apply the configured values.");
+        }
+
+        if (config.exporters.size() != 2 || config.exporters[0] != L"summary" || config.exporters[1] != L"openmetrics")
+        {
+            ReportFailure(L"ParseCollectorConfig did not split the exporter list.");
+        }
+
+        rvrse::core::CollectorConfig rejected;
+        if (rvrse::core::ParseCollectorConfig("process_interval_ms = 100\nsample_rate = 5\n", rejected, error) ||
+            error.find(L"line 2") == std::wstring::npos)
+        {
+            ReportFailure(L"ParseCollectorConfig accepted an unknown key.");
+        }
+
+        if (rvrse::core::ParseCollectorConfig("process_interval_ms = fast\n", rejected, error) ||
+            rvrse::core::ParseCollectorConfig("plugins = maybe\n", rejected, error) ||
+            rvrse::core::ParseCollectorConfig("process_interval_ms\n", rejected, error))
+        {
+            ReportFailure(L"ParseCollectorConfig accepted a malformed line.");
+        }
+    }
+
+    void TestSelfUsageSampler()
+    {
+        rvrse::core::SelfUsageSampler sampler;
+        auto first = sampler.Sample();
+        if (first.cpuPercent != 0.0)
+        {
+            ReportFailure(L"SelfUsageSampler reported CPU usage without a baseline.");
+        }
+
+        if (first.residentBytes == 0 || first.peakResidentBytes < first.residentBytes)
+        {
+            ReportFailure(L"SelfUsageSampler reported inconsistent resident set figures.");
+        }
+
+        // Burn some CPU so the second window is measurably nonzero.
+        volatile std::uint64_t sink = 0;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(30);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            sink = sink + 1;
+        }
+
+        auto second = sampler.Sample();
+        if (second.cpuPercent <= 0.0 || second.kernelTime100ns + second.userTime100ns < first.kernelTime100ns + first.userTime100ns)
+        {
+            ReportFailure(L"SelfUsageSampler did not observe the process's own CPU time.");
+        }
+    }
+
+    class CountingExporter final : public rvrse::core::CollectorExporter
+    {
+    public:
+        const wchar_t *Name() const override { return L"counting"; }
+
+        void Export(const rvrse::core::CollectorFrame &frame) override
+        {
+            ++frames;
+            lastGeneration = frame.generation;
+            processCount = frame.processes.Processes().size();
+        }
+
+        int frames = 0;
+        std::uint64_t lastGeneration = 0;
+        std::size_t processCount = 0;
+    };
+
+    void TestCollector()
+    {
+        rvrse::core::CollectorConfig config;
+        config.processInterval = std::chrono::milliseconds(10);
+        config.handleInterval = std::chrono::milliseconds(0);
+        config.networkInterval = std::chrono::milliseconds(0);
+        config.selfReportInterval = std::chrono::milliseconds(0);
+        config.cpuBudgetPercent = 0.0;
+        config.pluginsEnabled = false;
+        config.logPath = (MakeTestLogDirectory(L"collector") / L"agent.log").wstring();
+
+        CountingExporter exporter;
+        rvrse::core::Collector collector(config);
+        collector.AddExporter(&exporter);
+        if (!collector.Start())
+        {
+            ReportFailure(L"Collector failed to start.");
+            return;
+        }
+
+        std::atomic<bool> stop{false};
+        collector.Run(stop, 3);
+        collector.Stop();
+
+        if (collector.Generation() != 3 || exporter.frames != 3 || exporter.lastGeneration != 3)
+        {
+            ReportFailure(L"Collector did not hand every generation to its exporters.");
+        }
+
+        if (exporter.processCount == 0)
+        {
+            ReportFailure(L"Collector exported an empty process snapshot.");
+        }
+
+        auto &registry = collector.Metrics();
+        if (registry.Value(registry.Register(L"collector.passes", rvrse::core::MetricKind::Counter)) != 3.0 ||
+            registry.Value(registry.Register(L"collector.resident_bytes", rvrse::core::MetricKind::Gauge)) <= 0.0)
+        {
+            ReportFailure(L"Collector did not publish its collector.* metrics.");
+        }
+
+        if (CountFileLines(std::filesystem::path(config.logPath)) < 2)
+        {
+            ReportFailure(L"Collector did not log its start and stop lines.");
+        }
+    }
+
+    std::vector<rvrse::core::ProcessEntry> MakeSyntheticProcesses(std::size_t count)
+    {
+        std::vector<rvrse::core::ProcessEntry> processes(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            auto &process = processes[index];
+            process.processId = static_cast<std::uint32_t>((index + 1) * 4);
+            process.imageName = L"process" + std::to_wstring(index) + L".exe";
+            process.threadCount = 4;
+            process.workingSetBytes = static_cast<std::uint64_t>(index % 997 + 1) * 1024ULL * 1024ULL;
+            process.privateBytes = process.workingSetBytes / 2;
+            process.kernelTime100ns = static_cast<std::uint64_t>(index) * 1000ULL;
+            process.userTime100ns = static_cast<std::uint64_t>(index) * 3000ULL;
+        }
+        return processes;
+    }
+
+    // Plays the part of a Prometheus scraper: one request per connection,
+    // reading until the server closes.
+    std::string ScrapeOnce(std::uint16_t port, const char *request)
+    {
+        rvrse::core::Socket client;
+        if (!client.ConnectTcp("127.0.0.1", port) || !client.SendAll(request, std::strlen(request)))
+        {
+            return {};
+        }
+
+        std::string response;
+        char buffer[16 * 1024];
+        for (;;)
+        {
+            const auto received = client.Receive(buffer, sizeof(buffer), std::chrono::milliseconds(2000));
+            if (received <= 0)
+            {
+                break;
+            }
+            response.append(buffer, static_cast<std::size_t>(received));
+        }
+        return response;
+    }
+
+    std::size_t CountLinesWithPrefix(const std::string &text, std::string_view prefix)
+    {
+        std::size_t count = 0;
+        for (std::size_t start = 0; start < text.size();)
+        {
+            const std::size_t end = text.find('\n', start);
+            if (text.compare(start, prefix.size(), prefix) == 0)
+            {
+                ++count;
+            }
+            start = end == std::string::npos ? text.size() : end + 1;
+        }
+        return count;
+    }
+
+    void TestOpenMetricsExporter()
+    {
+        rvrse::core::OpenMetricsOptions options;
+        options.port = 0;
+        options.topProcesses = 2;
+
+        rvrse::core::OpenMetricsExporter exporter(options);
+        if (!exporter.Start() || exporter.Port() == 0)
+        {
+            ReportFailure(L"OpenMetricsExporter failed to listen on loopback.");
+            return;
+        }
+
+        if (ScrapeOnce(exporter.Port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n").rfind("HTTP/1.1 503", 0) != 0)
+        {
+            ReportFailure(L"OpenMetricsExporter served metrics before the first generation.");
+        }
+
+        // Processes 0 and 1 burn CPU between generations and 8 and 9 have the
+        // largest working sets, so with topProcesses = 2 those four get their
+        // own series and the other six are summed.
+        auto entries = MakeSyntheticProcesses(10);
+        entries[9].imageName = L"quote\"back\\slash";
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+        registry.Add(registry.Register(L"collector.passes", rvrse::core::MetricKind::Counter), 7);
+        registry.Set(registry.Register(L"plugin.queue-depth", rvrse::core::MetricKind::Gauge), 2.5);
+
+        const auto start = std::chrono::system_clock::now();
+        const rvrse::core::ProcessSnapshot first(entries);
+        exporter.Export({1, start, first, handles, network, metrics, registry, false, false});
+
+        entries[0].userTime100ns += 5'000'000;
+        entries[1].userTime100ns += 2'500'000;
+        const rvrse::core::ProcessSnapshot second(entries);
+        exporter.Export({2, start + std::chrono::seconds(1), second, handles, network, metrics, registry, false, false});
+
+        auto body = exporter.Latest();
+        if (!body)
+        {
+            ReportFailure(L"OpenMetricsExporter did not publish a rendered generation.");
+            return;
+        }
+
+        const std::string &text = *body;
+        if (text.find("rvrse_process_cpu_percent{pid=\"4\",name=\"process0.exe\"} 50.00\n") == std::string::npos ||
+            text.find("rvrse_process_cpu_percent{pid=\"8\",name=\"process1.exe\"} 25.00\n") == std::string::npos)
+        {
+            ReportFailure(L"OpenMetricsExporter computed wrong per-process CPU usage.");
+        }
+
+        if (CountLinesWithPrefix(text, "rvrse_process_threads{") != 5 ||
+            text.find("rvrse_process_threads{pid=\"other\",name=\"other\"} 24\n") == std::string::npos ||
+            text.find("rvrse_processes_aggregated 6\n") == std::string::npos)
+        {
+            ReportFailure(L"OpenMetricsExporter did not apply the top-N cardinality limit.");
+        }
+
+        if (text.find("name=\"quote\\\"back\\\\slash\"") == std::string::npos)
+        {
+            ReportFailure(L"OpenMetricsExporter did not escape label values.");
+        }
+
+        if (text.find("# TYPE rvrse_collector_passes counter\nrvrse_collector_passes_total 7\n") == std::string::npos ||
+            text.find("rvrse_plugin_queue_depth 2.5\n") == std::string::npos)
+        {
+            ReportFailure(L"OpenMetricsExporter did not expose registry metrics.");
+        }
+
+        if (text.size() < 6 || text.compare(text.size() - 6, 6, "# EOF\n") != 0)
+        {
+            ReportFailure(L"OpenMetricsExporter output is not terminated by # EOF.");
+        }
+
+        const std::string response = ScrapeOnce(exporter.Port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\nAccept: application/openmetrics-text\r\n\r\n");
+        const std::size_t headerEnd = response.find("\r\n\r\n");
+        if (response.rfind("HTTP/1.1 200", 0) != 0 || headerEnd == std::string::npos ||
+            response.find(rvrse::core::OpenMetricsExporter::kContentType) > headerEnd ||
+            response.compare(headerEnd + 4, std::string::npos, text) != 0)
+        {
+            ReportFailure(L"OpenMetricsExporter scrape did not return the published buffer.");
+        }
+
+        if (ScrapeOnce(exporter.Port(), "GET /other HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0) != 0 ||
+            ScrapeOnce(exporter.Port(), "POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0) != 0)
+        {
+            ReportFailure(L"OpenMetricsExporter answered an unsupported request.");
+        }
+
+        // A client trickling its request a byte at a time is cut off once
+        // the whole-request timeout passes, and a scrape queued behind it
+        // is still answered.
+        std::atomic<bool> slowClientDropped{false};
+        std::thread slowClient([&]()
+                               {
+                                   rvrse::core::Socket socket;
+                                   const char prefix[] = "GET /metrics HTTP/1.1\r\nX-Slow: ";
+                                   if (!socket.ConnectTcp("127.0.0.1", exporter.Port()) || !socket.SendAll(prefix, sizeof(prefix) - 1))
+                                   {
+                                       return;
+                                   }
+                                   char byte = 'a';
+                                   for (int drip = 0; drip < 40; ++drip)
+                                   {
+                                       if (!socket.SendAll(&byte, 1) ||
+                                           socket.Receive(&byte, 1, std::chrono::milliseconds(200)) == 0)
+                                       {
+                                           slowClientDropped.store(true);
+                                           return;
+                                       }
+                                       byte = 'a';
+                                   }
+                               });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const auto queuedAt = std::chrono::steady_clock::now();
+        std::string queued;
+        rvrse::core::Socket scraper;
+        const char scrape[] = "GET /metrics HTTP/1.1\r\n\r\n";
+        if (scraper.ConnectTcp("127.0.0.1", exporter.Port()) && scraper.SendAll(scrape, sizeof(scrape) - 1))
+        {
+            char buffer[4096];
+            std::ptrdiff_t received = 0;
+            while ((received = scraper.Receive(buffer, sizeof(buffer), std::chrono::milliseconds(5000))) > 0)
+            {
+                queued.append(buffer, static_cast<std::size_t>(received));
+            }
+        }
+        const auto queuedWait = std::chrono::steady_clock::now() - queuedAt;
+        slowClient.join();
+        if (!slowClientDropped.load() || queued.rfind("HTTP/1.1 200", 0) != 0 || queuedWait > std::chrono::seconds(4))
+        {
+            ReportFailure(L"OpenMetricsExporter let a slow client hold the serving thread past the request timeout.");
+        }
+
+        // A scraper that drains a large response a little at a time, each
+        // read well inside any per-send timeout, is still dropped once the
+        // whole-response deadline passes, and the server answers the next
+        // request and stops promptly.
+        {
+            auto largeBody = std::make_shared<const std::string>(std::size_t{64} << 20, 'x');
+            rvrse::core::HttpServer server;
+            const bool started = server.Start("127.0.0.1", 0, [&](std::string_view path)
+                                              {
+                                                  rvrse::core::HttpResponse response;
+                                                  response.body = path == "/large" ? largeBody : std::make_shared<const std::string>("ok\n");
+                                                  return response;
+                                              });
+            std::atomic<bool> stopReading{false};
+            std::thread reader([&]()
+                               {
+                                   rvrse::core::Socket socket;
+                                   const char request[] = "GET /large HTTP/1.1\r\n\r\n";
+                                   if (!started || !socket.ConnectTcp("127.0.0.1", server.Port()) ||
+                                       !socket.SendAll(request, sizeof(request) - 1))
+                                   {
+                                       return;
+                                   }
+                                   std::vector<char> buffer(64 * 1024);
+                                   while (!stopReading.load() &&
+                                          socket.Receive(buffer.data(), buffer.size(), std::chrono::milliseconds(1000)) > 0)
+                                   {
+                                       std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                                   }
+                               });
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            // Queued behind the slow reader; answered once the server gives up on it.
+            const auto queuedAt = std::chrono::steady_clock::now();
+            std::string next;
+            rvrse::core::Socket scraper;
+            const char scrape[] = "GET /small HTTP/1.1\r\n\r\n";
+            if (started && scraper.ConnectTcp("127.0.0.1", server.Port()) && scraper.SendAll(scrape, sizeof(scrape) - 1))
+            {
+                char buffer[1024];
+                std::ptrdiff_t received = 0;
+                while ((received = scraper.Receive(buffer, sizeof(buffer), std::chrono::milliseconds(15000))) > 0)
+                {
+                    next.append(buffer, static_cast<std::size_t>(received));
+                }
+            }
+            const auto queuedWait = std::chrono::steady_clock::now() - queuedAt;
+            stopReading.store(true);
+            reader.join();
+
+            const auto stopStart = std::chrono::steady_clock::now();
+            server.Stop();
+            const auto stopTook = std::chrono::steady_clock::now() - stopStart;
+            if (!started || next.rfind("HTTP/1.1 200", 0) != 0 || queuedWait > std::chrono::seconds(8) ||
+                stopTook > std::chrono::seconds(1))
+            {
+                ReportFailure(L"HttpServer let a slow reader hold the serving thread past the response deadline.");
+            }
+        }
+
+        // With no reader holding a buffer the two alternate instead of
+        // allocating a new one per generation.
+        body.reset();
+        const std::string *published = exporter.Latest().get();
+        exporter.Export({3, start + std::chrono::seconds(2), second, handles, network, metrics, registry, false, false});
+        exporter.Export({4, start + std::chrono::seconds(3), second, handles, network, metrics, registry, false, false});
+        if (exporter.Latest().get() != published)
+        {
+            ReportFailure(L"OpenMetricsExporter did not reuse its render buffers.");
+        }
+
+        exporter.Stop();
+    }
+
+    void BenchmarkOpenMetricsRender()
+    {
+        // One snapshot per generation with CPU time advancing unevenly, so
+        // both top-N rankings have real work to do.
+        const int iterations = 20;
+        auto entries = MakeSyntheticProcesses(5000);
+        std::vector<rvrse::core::ProcessSnapshot> snapshots;
+        snapshots.reserve(iterations);
+        for (int generation = 0; generation < iterations; ++generation)
+        {
+            for (std::size_t index = 0; index < entries.size(); ++index)
+            {
+                entries[index].userTime100ns += (index * 7919) % 10007;
+            }
+            snapshots.emplace_back(entries);
+        }
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+        rvrse::core::SystemMetricsPublisher publisher(registry);
+        publisher.Publish(metrics);
+
+        rvrse::core::OpenMetricsOptions options;
+        options.topProcesses = 50;
+        rvrse::core::OpenMetricsExporter exporter(options);
+
+        const auto start = std::chrono::system_clock::now();
+        std::uint64_t generation = 0;
+        const double thresholdMs = 10.0;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                ++generation;
+                exporter.Export({generation,
+                                 start + std::chrono::seconds(generation),
+                                 snapshots[generation - 1],
+                                 handles,
+                                 network,
+                                 metrics,
+                                 registry,
+                                 false,
+                                 false});
+            },
+            iterations);
+
+        const auto body = exporter.Latest();
+        std::fwprintf(stdout,
+                      L"[PERF] OpenMetrics render avg: %.3f ms (%zu processes, %zu bytes)\n",
+                      averageMs,
+                      entries.size(),
+                      body ? body->size() : 0);
+        const bool passed = averageMs <= thresholdMs;
+        if (!passed)
+        {
+            ReportFailure(L"OpenMetrics render performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"OpenMetricsRender",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // Collects sink output in memory (or only counts it) for writer tests.
+    class MemorySink final : public rvrse::core::OutputSink
+    {
+    public:
+        explicit MemorySink(bool keepBytes = true) : keepBytes_(keepBytes) {}
+
+        bool Write(const char *data, std::size_t sizeBytes) override
+        {
+            if (keepBytes_)
+            {
+                bytes.append(data, sizeBytes);
+            }
+            totalBytes += sizeBytes;
+            return true;
+        }
+
+        std::string bytes;
+        std::size_t totalBytes = 0;
+
+    private:
+        bool keepBytes_;
+    };
+
+    std::string BufferContents(const rvrse::core::ChunkedBuffer &buffer)
+    {
+        MemorySink sink;
+        buffer.WriteTo(sink);
+        return sink.bytes;
+    }
+
+    void TestJsonWriter()
+    {
+        rvrse::core::ChunkedBuffer buffer;
+        rvrse::core::JsonWriter json(buffer);
+
+        json.BeginObject();
+        json.Field("text", std::wstring_view(L"a\"b\\c\n\x01 café \U0001F600"));
+        json.Field("utf8", "tab\there");
+        json.Field("max", std::numeric_limits<std::uint64_t>::max());
+        json.Field("min", std::numeric_limits<std::int64_t>::min());
+        json.Field("ratio", 0.1);
+        json.Field("nan", std::numeric_limits<double>::quiet_NaN());
+        json.Field("flag", true);
+        json.Key("list");
+        json.BeginArray();
+        json.Number(1U);
+        json.BeginObject();
+        json.EndObject();
+        json.Null();
+        json.EndArray();
+        json.EndObject();
+        json.EndLine();
+
+        const std::string expected =
+            "{\"text\":\"a\\\"b\\\\c\\n\\u0001 caf\xc3\xa9 \xf0\x9f\x98\x80\",\"utf8\":\"tab\\there\","
+            "\"max\":18446744073709551615,\"min\":-9223372036854775808,\"ratio\":0.1,\"nan\":null,"
+            "\"flag\":true,\"list\":[1,{},null]}\n";
+        if (BufferContents(buffer) != expected)
+        {
+            ReportFailure(L"JsonWriter produced unexpected output.");
+        }
+
+        // Strings longer than a chunk are split across chunks without losing bytes.
+        buffer.Clear();
+        const std::wstring longText(3 * rvrse::core::ChunkedBuffer::kChunkBytes, L'é');
+        json.String(longText);
+        json.EndLine();
+        if (buffer.Size() != longText.size() * 2 + 3 || BufferContents(buffer).size() != buffer.Size())
+        {
+            ReportFailure(L"JsonWriter lost bytes on a string spanning several chunks.");
+        }
+    }
+
+    bool WaitForNdjsonWrites(const rvrse::core::NdjsonExporter &exporter, std::uint64_t generations)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (exporter.GenerationsWritten() + exporter.GenerationsDropped() < generations)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    void TestNdjsonExporter()
+    {
+        const auto outputPath = MakeTestLogDirectory(L"ndjson") / L"frames.ndjson";
+
+        rvrse::core::NdjsonOptions options;
+        options.target = outputPath.wstring();
+        options.keyframeInterval = 3;
+
+        rvrse::core::NdjsonExporter exporter(options);
+        if (!exporter.Start())
+        {
+            ReportFailure(L"NdjsonExporter failed to open its target file.");
+            return;
+        }
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+        const auto start = std::chrono::system_clock::now();
+
+        // Generation 2 changes process 4, drops process 8 and adds process 16;
+        // generation 3 changes nothing; generation 4 is the next keyframe.
+        auto entries = MakeSyntheticProcesses(3);
+        const rvrse::core::ProcessSnapshot first(entries);
+        entries[0].workingSetBytes += 4096;
+        entries.erase(entries.begin() + 1);
+        entries.push_back(entries.back());
+        entries.back().processId = 16;
+        const rvrse::core::ProcessSnapshot second(entries);
+
+        const rvrse::core::ProcessSnapshot *generations[] = {&first, &second, &second, &second};
+        for (std::uint64_t generation = 1; generation <= std::size(generations); ++generation)
+        {
+            exporter.Export({generation, start, *generations[generation - 1], handles, network, metrics, registry, false, false});
+            if (!WaitForNdjsonWrites(exporter, generation))
+            {
+                ReportFailure(L"NdjsonExporter did not write a generation in time.");
+                return;
+            }
+        }
+        exporter.Stop();
+
+        std::ifstream stream(outputPath, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        if (exporter.GenerationsDropped() != 0 ||
+            CountLinesWithPrefix(contents, "{\"type\":\"generation\"") != 4 ||
+            CountLinesWithPrefix(contents, "{\"type\":\"generation\",\"generation\":1,") != 1)
+        {
+            ReportFailure(L"NdjsonExporter did not write one generation record per generation.");
+        }
+
+        // 3 (keyframe) + 2 (changed, new) + 0 + 3 (keyframe).
+        if (CountLinesWithPrefix(contents, "{\"type\":\"process\"") != 8 ||
+            CountLinesWithPrefix(contents, "{\"type\":\"exit\",\"generation\":2,\"pid\":8}") != 1 ||
+            CountLinesWithPrefix(contents, "{\"type\":\"exit\"") != 1)
+        {
+            ReportFailure(L"NdjsonExporter wrote incorrect delta records.");
+        }
+
+        if (contents.find("\"keyframe\":true") == std::string::npos ||
+            CountLinesWithPrefix(contents, "{\"type\":\"process\",\"generation\":2,\"pid\":4,") != 1 ||
+            CountLinesWithPrefix(contents, "{\"type\":\"process\",\"generation\":4,") != 3)
+        {
+            ReportFailure(L"NdjsonExporter did not emit keyframes on schedule.");
+        }
+    }
+
+    void BenchmarkNdjsonExport()
+    {
+        const auto entries = MakeSyntheticProcesses(2000);
+        const rvrse::core::ProcessSnapshot snapshot(entries);
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+
+        // Keyframes only: the worst case, every process written every generation.
+        rvrse::core::NdjsonRenderer renderer(1);
+        rvrse::core::ChunkedBuffer buffer;
+        MemorySink sink(false);
+        std::uint64_t generation = 0;
+
+        const int iterations = 50;
+        const double thresholdMs = 1.0;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                ++generation;
+                buffer.Clear();
+                renderer.Render({generation, std::chrono::system_clock::now(), snapshot, handles, network, metrics, registry, false, false},
+                                buffer);
+                buffer.WriteTo(sink);
+            },
+            iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] NDJSON export avg: %.3f ms (%zu processes, %zu bytes)\n",
+                      averageMs,
+                      entries.size(),
+                      sink.totalBytes / static_cast<std::size_t>(iterations));
+        const bool passed = averageMs <= thresholdMs;
+        if (!passed)
+        {
+            ReportFailure(L"NDJSON export performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"NdjsonExport",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    std::vector<rvrse::core::ConnectionEntry> MakeSyntheticConnections(std::size_t count)
+    {
+        std::vector<rvrse::core::ConnectionEntry> connections(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            auto &connection = connections[index];
+            connection.owningProcessId = static_cast<std::uint32_t>((index % 50 + 1) * 4);
+            connection.SetProtocol(index % 3 == 0 ? rvrse::core::TransportProtocol::Udp : rvrse::core::TransportProtocol::Tcp);
+            connection.localPort = static_cast<std::uint16_t>(10000 + index);
+            connection.remotePort = static_cast<std::uint16_t>(443);
+            connection.SetState(static_cast<std::uint8_t>(index % 12));
+            if (index % 4 == 0)
+            {
+                std::uint8_t localAddress[16] = {};
+                std::uint8_t remoteAddress[16] = {};
+                localAddress[15] = 1;
+                remoteAddress[0] = 0x20;
+                remoteAddress[15] = static_cast<std::uint8_t>(index);
+                connection.SetFamily(rvrse::core::AddressFamily::IPv6);
+                connection.SetLocalAddress6(localAddress);
+                connection.SetRemoteAddress6(remoteAddress);
+            }
+            else
+            {
+                connection.SetLocalAddress(0x0100007F);
+                connection.SetRemoteAddress(0x0A000000U | static_cast<std::uint32_t>(index));
+            }
+        }
+        return connections;
+    }
+
+    void TestConnectionEntry()
+    {
+        rvrse::core::ConnectionEntry entry;
+        const std::uint8_t mappedAny[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0, 0, 0, 0};
+        if (sizeof(rvrse::core::ConnectionEntry) >= sizeof(RvrseConnectionInfo) || entry.LocalAddress() != 0 ||
+            std::memcmp(entry.LocalAddress6(), mappedAny, sizeof(mappedAny)) != 0 ||
+            entry.Protocol() != rvrse::core::TransportProtocol::Tcp || entry.Family() != rvrse::core::AddressFamily::IPv4 || entry.State() != 0)
+        {
+            ReportFailure(L"ConnectionEntry should default to a packed TCP/IPv4 entry on the mapped 0.0.0.0.");
+        }
+
+        // The packed fields are independent of each other.
+        entry.SetState(12);
+        entry.SetProtocol(rvrse::core::TransportProtocol::Udp);
+        entry.SetFamily(rvrse::core::AddressFamily::IPv6);
+        entry.SetState(5);
+        entry.SetProtocol(rvrse::core::TransportProtocol::Tcp);
+        if (entry.State() != 5 || entry.Protocol() != rvrse::core::TransportProtocol::Tcp || entry.Family() != rvrse::core::AddressFamily::IPv6)
+        {
+            ReportFailure(L"ConnectionEntry state, protocol and family should share a byte without overlapping.");
+        }
+
+        // IPv4 addresses are stored v4-mapped and read back as before, and the
+        // ABI form fills only the fields of the entry's family.
+        entry.SetFamily(rvrse::core::AddressFamily::IPv4);
+        entry.SetLocalAddress(0x0100007F);
+        entry.SetRemoteAddress(0x0A0B0C0D);
+        entry.localPort = 80;
+        entry.owningProcessId = 42;
+        const std::uint8_t mappedLoopback[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 127, 0, 0, 1};
+        const RvrseConnectionInfo info = rvrse::core::ToConnectionInfo(entry);
+        const std::uint8_t zeros[16] = {};
+        if (entry.LocalAddress() != 0x0100007F || entry.RemoteAddress() != 0x0A0B0C0D ||
+            std::memcmp(entry.LocalAddress6(), mappedLoopback, sizeof(mappedLoopback)) != 0 ||
+            info.localAddress != 0x0100007F || info.remoteAddress != 0x0A0B0C0D || info.localPort != 80 || info.owningProcessId != 42 ||
+            info.state != 5 || info.addressFamily != RVRSE_ADDRESS_FAMILY_IPV4 || std::memcmp(info.localAddress6, zeros, sizeof(zeros)) != 0)
+        {
+            ReportFailure(L"ConnectionEntry IPv4 addresses should round-trip through the mapped form and the ABI.");
+        }
+
+        const std::uint8_t address6[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7};
+        entry.SetFamily(rvrse::core::AddressFamily::IPv6);
+        entry.SetProtocol(rvrse::core::TransportProtocol::Udp);
+        entry.SetLocalAddress6(address6);
+        const RvrseConnectionInfo info6 = rvrse::core::ToConnectionInfo(entry);
+        if (std::memcmp(entry.LocalAddress6(), address6, sizeof(address6)) != 0 || std::memcmp(info6.localAddress6, address6, sizeof(address6)) != 0 ||
+            info6.localAddress != 0 || info6.protocol != RVRSE_TRANSPORT_UDP || info6.addressFamily != RVRSE_ADDRESS_FAMILY_IPV6)
+        {
+            ReportFailure(L"ConnectionEntry IPv6 addresses should round-trip through the ABI.");
+        }
+
+        // Per-process lookups over the PID-sorted table match a full scan,
+        // including PIDs with no connections.
+        const rvrse::core::NetworkSnapshot network(MakeSyntheticConnections(500));
+        const auto &connections = network.Connections();
+        bool sorted = std::is_sorted(connections.begin(), connections.end(),
+                                     [](const rvrse::core::ConnectionEntry &lhs, const rvrse::core::ConnectionEntry &rhs)
+                                     { return lhs.owningProcessId < rhs.owningProcessId; });
+        for (std::uint32_t processId = 0; processId <= 210 && sorted; ++processId)
+        {
+            const auto expected = static_cast<std::size_t>(std::count_if(connections.begin(), connections.end(),
+                                                                         [processId](const rvrse::core::ConnectionEntry &connection)
+                                                                         { return connection.owningProcessId == processId; }));
+            const auto forProcess = network.ConnectionsForProcess(processId);
+            sorted = network.ConnectionCountForProcess(processId) == expected && forProcess.size() == expected &&
+                     std::all_of(forProcess.begin(), forProcess.end(),
+                                 [processId](const rvrse::core::ConnectionEntry &connection)
+                                 { return connection.owningProcessId == processId; });
+        }
+        if (!sorted)
+        {
+            ReportFailure(L"NetworkSnapshot per-process lookups should match a scan of the PID-sorted table.");
+        }
+    }
+
+    void BenchmarkConnectionTable()
+    {
+        // 100,000 sockets across 2,000 processes, three in four IPv4, in
+        // the scattered order the kernel tables list them.
+        const std::size_t count = 100000;
+        std::vector<rvrse::core::ConnectionEntry> source(count);
+        std::uint32_t seed = 12345;
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            auto &connection = source[index];
+            connection.owningProcessId = (seed >> 8) % 2000 * 4 + 4;
+            connection.SetProtocol(index % 3 == 0 ? rvrse::core::TransportProtocol::Udp : rvrse::core::TransportProtocol::Tcp);
+            connection.SetState(static_cast<std::uint8_t>(index % 12 + 1));
+            connection.localPort = static_cast<std::uint16_t>(seed >> 16);
+            connection.remotePort = 443;
+            if (index % 4 == 0)
+            {
+                std::uint8_t address[16] = {0x20, 0x01, 0x0d, 0xb8};
+                std::memcpy(address + 12, &seed, sizeof(seed));
+                connection.SetFamily(rvrse::core::AddressFamily::IPv6);
+                connection.SetLocalAddress6(address);
+                connection.SetRemoteAddress6(address);
+            }
+            else
+            {
+                connection.SetLocalAddress(0x0100007F);
+                connection.SetRemoteAddress(seed);
+            }
+        }
+
+        // The previous layout is still the ABI struct, so it stands in for
+        // the old entries: same fill and sort, 60 bytes each.
+        std::vector<RvrseConnectionInfo> legacySource;
+        legacySource.reserve(count);
+        for (const auto &connection : source)
+        {
+            legacySource.push_back(rvrse::core::ToConnectionInfo(connection));
+        }
+
+        const auto legacyLess = [](const RvrseConnectionInfo &lhs, const RvrseConnectionInfo &rhs)
+        {
+            if (lhs.owningProcessId != rhs.owningProcessId)
+            {
+                return lhs.owningProcessId < rhs.owningProcessId;
+            }
+            if (lhs.protocol != rhs.protocol)
+            {
+                return lhs.protocol < rhs.protocol;
+            }
+            if (lhs.addressFamily != rhs.addressFamily)
+            {
+                return lhs.addressFamily < rhs.addressFamily;
+            }
+            if (lhs.localPort != rhs.localPort)
+            {
+                return lhs.localPort < rhs.localPort;
+            }
+            return lhs.remotePort < rhs.remotePort;
+        };
+
+        // Building a snapshot: copy the captured rows and sort them by PID.
+        const int iterations = 20;
+        std::vector<RvrseConnectionInfo> legacy;
+        const double legacyBuildMs = MeasureAverageMilliseconds([&]()
+                                                                {
+                                                                    legacy = legacySource;
+                                                                    std::sort(legacy.begin(), legacy.end(), legacyLess);
+                                                                },
+                                                                iterations);
+        rvrse::core::NetworkSnapshot network;
+        const double buildMs = MeasureAverageMilliseconds([&]()
+                                                          { network = rvrse::core::NetworkSnapshot(source); },
+                                                          iterations);
+
+        // Every process's connection count, as the process table gathers
+        // them: a scan per PID before, a binary search now.
+        std::size_t legacyCounted = 0;
+        const double legacyLookupMs = MeasureAverageMilliseconds([&]()
+                                                                 {
+                                                                     legacyCounted = 0;
+                                                                     for (std::uint32_t processId = 4; processId <= 8000; processId += 4)
+                                                                     {
+                                                                         legacyCounted += static_cast<std::size_t>(std::count_if(legacy.begin(), legacy.end(),
+                                                                                                                                 [processId](const RvrseConnectionInfo &connection)
+                                                                                                                                 { return connection.owningProcessId == processId; }));
+                                                                     }
+                                                                 },
+                                                                 2);
+        std::size_t counted = 0;
+        const double lookupMs = MeasureAverageMilliseconds([&]()
+                                                           {
+                                                               counted = 0;
+                                                               for (std::uint32_t processId = 4; processId <= 8000; processId += 4)
+                                                               {
+                                                                   counted += network.ConnectionCountForProcess(processId);
+                                                               }
+                                                           },
+                                                           iterations);
+
+        const std::size_t packedBytes = count * sizeof(rvrse::core::ConnectionEntry);
+        const std::size_t legacyBytes = count * sizeof(RvrseConnectionInfo);
+        std::fwprintf(stdout,
+                      L"[PERF] Connection table at 100,000 sockets: %zu bytes/entry, %.1f MB (was %zu, %.1f MB); build %.2f ms (was %.2f ms), 2,000 per-process counts %.3f ms (was %.1f ms)\n",
+                      sizeof(rvrse::core::ConnectionEntry),
+                      packedBytes / (1024.0 * 1024.0),
+                      sizeof(RvrseConnectionInfo),
+                      legacyBytes / (1024.0 * 1024.0),
+                      buildMs,
+                      legacyBuildMs,
+                      lookupMs,
+                      legacyLookupMs);
+
+        const double thresholdMs = 25.0;
+        const bool passed = packedBytes < legacyBytes && counted == count && legacyCounted == count && buildMs <= thresholdMs;
+        if (!passed)
+        {
+            ReportFailure(L"Connection table size or build performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"ConnectionTable100k",
+                              buildMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    bool SameProcesses(const std::vector<rvrse::core::ProcessEntry> &lhs, const std::vector<rvrse::core::ProcessEntry> &rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](const rvrse::core::ProcessEntry &a, const rvrse::core::ProcessEntry &b)
+                          {
+                              return a.processId == b.processId && a.parentProcessId == b.parentProcessId &&
+                                     a.imageName == b.imageName && a.threadCount == b.threadCount &&
+                                     a.workingSetBytes == b.workingSetBytes && a.privateBytes == b.privateBytes &&
+                                     a.kernelTime100ns == b.kernelTime100ns && a.userTime100ns == b.userTime100ns;
+                          });
+    }
+
+    // Synthetic connections are unique in (pid, protocol, family, ports), so
+    // both snapshots sort identically.
+    bool SameConnections(const rvrse::core::NetworkSnapshot &lhs, const rvrse::core::NetworkSnapshot &rhs)
+    {
+        return std::equal(lhs.Connections().begin(), lhs.Connections().end(), rhs.Connections().begin(), rhs.Connections().end(),
+                          [](const rvrse::core::ConnectionEntry &a, const rvrse::core::ConnectionEntry &b)
+                          {
+                              return a.owningProcessId == b.owningProcessId && a.Protocol() == b.Protocol() &&
+                                     a.Family() == b.Family() && a.localPort == b.localPort &&
+                                     a.remotePort == b.remotePort && a.State() == b.State() &&
+                                     std::memcmp(a.LocalAddress6(), b.LocalAddress6(), rvrse::core::ConnectionEntry::kAddressBytes) == 0 &&
+                                     std::memcmp(a.RemoteAddress6(), b.RemoteAddress6(), rvrse::core::ConnectionEntry::kAddressBytes) == 0;
+                          });
+    }
+
+    // Decoded entries carry no names; the decoder keeps those itself.
+    bool SameProcesses(const rvrse::core::WireDecoder &decoder, const std::vector<rvrse::core::ProcessEntry> &expected)
+    {
+        const auto &decoded = decoder.Processes();
+        if (decoded.size() != expected.size())
+        {
+            return false;
+        }
+        for (std::size_t index = 0; index < decoded.size(); ++index)
+        {
+            rvrse::core::ProcessEntry named = decoded[index];
+            named.imageName = expected[index].imageName;
+            if (decoder.ImageName(index) != expected[index].imageName.Utf8() || !decoded[index].imageName.empty() ||
+                !SameProcesses({named}, {expected[index]}))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ApplyWireFrame(rvrse::core::WireDecoder &decoder, const std::string &frame)
+    {
+        return frame.size() > rvrse::core::wire::kFrameHeaderBytes &&
+               decoder.Apply(reinterpret_cast<const std::uint8_t *>(frame.data()) + rvrse::core::wire::kFrameHeaderBytes,
+                             frame.size() - rvrse::core::wire::kFrameHeaderBytes);
+    }
+
+    void TestWireProtocol()
+    {
+        rvrse::core::SocketEndpoint endpoint;
+        if (!rvrse::core::ParseSocketEndpoint(L"tcp://[::1]:9465", endpoint) || endpoint.address != "::1" || endpoint.port != 9465 ||
+            !rvrse::core::ParseSocketEndpoint(L"unix:/run/rvrse.sock", endpoint) ||
+            endpoint.kind != rvrse::core::SocketEndpoint::Kind::Unix || endpoint.address != "/run/rvrse.sock" ||
+            rvrse::core::ParseSocketEndpoint(L"tcp://127.0.0.1", endpoint) ||
+            rvrse::core::ParseSocketEndpoint(L"udp://127.0.0.1:9465", endpoint))
+        {
+            ReportFailure(L"ParseSocketEndpoint accepted or rejected the wrong endpoints.");
+        }
+
+        auto entries = MakeSyntheticProcesses(50);
+        entries[3].imageName = L"café \U0001F600.exe";
+        entries[7].parentProcessId = 4;
+        auto connections = MakeSyntheticConnections(20);
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::SystemMetrics metrics{};
+        metrics.cpuUsagePercent = 12.5;
+        metrics.physicalMemoryTotalBytes = 16ULL << 30;
+        rvrse::core::MetricsRegistry registry;
+        const auto start = std::chrono::system_clock::now();
+
+        rvrse::core::WireEncoder encoder(60);
+        rvrse::core::WireDecoder decoder;
+        std::string keyframe;
+        std::string delta;
+        std::string idle;
+
+        const rvrse::core::ProcessSnapshot first(entries);
+        const rvrse::core::NetworkSnapshot firstNetwork(connections);
+        if (!encoder.Encode({1, start, first, handles, firstNetwork, metrics, registry, false, true}, keyframe) ||
+            !ApplyWireFrame(decoder, keyframe) || !decoder.LastFrameWasKeyframe() ||
+            !SameProcesses(decoder, first.Processes()) ||
+            !SameConnections(decoder.BuildNetworkSnapshot(), firstNetwork) ||
+            decoder.Metrics().cpuUsagePercent != 12.5 || decoder.Metrics().physicalMemoryTotalBytes != (16ULL << 30))
+        {
+            ReportFailure(L"Wire keyframe did not round-trip.");
+            return;
+        }
+
+        // Generation 2: two processes change, one exits, one starts, one is
+        // renamed; one connection closes and one opens.
+        entries[0].workingSetBytes += 8192;
+        entries[1].kernelTime100ns += 50000;
+        entries[1].threadCount -= 1;
+        entries[5].imageName = L"renamed.exe";
+        entries.erase(entries.begin() + 10);
+        entries.push_back(entries.back());
+        entries.back().processId = 100000;
+        entries.back().imageName = L"newcomer.exe";
+        connections.erase(connections.begin() + 2);
+        connections.push_back(connections.back());
+        connections.back().localPort = 20000;
+
+        const rvrse::core::ProcessSnapshot second(entries);
+        const rvrse::core::NetworkSnapshot secondNetwork(connections);
+        if (encoder.Encode({2, start, second, handles, secondNetwork, metrics, registry, false, true}, delta) ||
+            !ApplyWireFrame(decoder, delta) || decoder.LastFrameWasKeyframe() || decoder.Generation() != 2 ||
+            !SameProcesses(decoder, second.Processes()) ||
+            !SameConnections(decoder.BuildNetworkSnapshot(), secondNetwork))
+        {
+            ReportFailure(L"Wire delta did not reconstruct the snapshot.");
+            return;
+        }
+
+        // Generation 3: nothing changed and no fresh network capture.
+        if (encoder.Encode({3, start, second, handles, secondNetwork, metrics, registry, false, false}, idle) ||
+            !ApplyWireFrame(decoder, idle) || decoder.LastFrameHadNetwork() ||
+            !SameProcesses(decoder, second.Processes()) ||
+            decoder.Connections().size() != connections.size())
+        {
+            ReportFailure(L"Wire idle delta did not apply.");
+        }
+
+        if (delta.size() * 4 > keyframe.size() || idle.size() > 64)
+        {
+            ReportFailure(L"Wire deltas are not smaller than keyframes.");
+        }
+
+        // A delta needs its keyframe, and a truncated frame is rejected and
+        // resets the viewer.
+        rvrse::core::WireDecoder fresh;
+        if (ApplyWireFrame(fresh, delta) ||
+            ApplyWireFrame(fresh, keyframe.substr(0, keyframe.size() / 2)) || fresh.HasState() ||
+            !ApplyWireFrame(fresh, keyframe) || !SameProcesses(fresh, first.Processes()))
+        {
+            ReportFailure(L"WireDecoder accepted a frame it cannot apply.");
+        }
+
+        // Remote names stay in the decoder: a name only another host has
+        // seen never reaches the process-wide pool.
+        std::vector<rvrse::core::ProcessEntry> remote(1);
+        remote[0].processId = 42;
+        remote[0].imageName = L"wire-remote-A.exe";
+        rvrse::core::WireEncoder remoteEncoder(60);
+        std::string remoteFrame;
+        remoteEncoder.Encode({1, start, rvrse::core::ProcessSnapshot(remote), handles, firstNetwork, metrics, registry, false, false}, remoteFrame);
+        const std::size_t nameAt = remoteFrame.find("wire-remote-A.exe");
+        if (nameAt != std::string::npos)
+        {
+            remoteFrame[nameAt + std::strlen("wire-remote-")] = 'Z';
+        }
+        const std::size_t pooled = rvrse::core::StringInterner::Global().Size();
+        rvrse::core::WireDecoder remoteDecoder;
+        if (nameAt == std::string::npos || !ApplyWireFrame(remoteDecoder, remoteFrame) ||
+            remoteDecoder.ImageName(0) != "wire-remote-Z.exe" || !remoteDecoder.Processes()[0].imageName.empty() ||
+            rvrse::core::StringInterner::Global().Size() != pooled ||
+            remoteDecoder.BuildProcessSnapshot().Processes()[0].imageName.View() != L"wire-remote-Z.exe")
+        {
+            ReportFailure(L"WireDecoder should keep remote names out of the global string pool.");
+        }
+
+        // The stream reader takes bytes split anywhere, including inside the
+        // hello's host name.
+        std::string stream;
+        rvrse::core::wire::AppendHello(stream, L"web-01.café");
+        stream += keyframe;
+        stream += delta;
+        rvrse::core::WireStreamReader reader;
+        std::size_t hellos = 0;
+        std::size_t frames = 0;
+        for (char ch : stream)
+        {
+            *reader.PrepareReceive(1) = static_cast<std::uint8_t>(ch);
+            reader.Commit(1);
+            for (auto status = reader.Next(); status != rvrse::core::WireStreamReader::Status::NeedMoreData; status = reader.Next())
+            {
+                hellos += status == rvrse::core::WireStreamReader::Status::HelloReceived ? 1 : 0;
+                frames += status == rvrse::core::WireStreamReader::Status::FrameApplied ? 1 : 0;
+                if (status == rvrse::core::WireStreamReader::Status::ProtocolError)
+                {
+                    ReportFailure(L"WireStreamReader rejected a valid byte stream.");
+                    return;
+                }
+            }
+        }
+        if (hellos != 1 || frames != 2 || reader.HostName() != L"web-01.café" ||
+            !SameProcesses(reader.State(), second.Processes()))
+        {
+            ReportFailure(L"WireStreamReader did not reassemble the hello and frames.");
+        }
+    }
+
+    // Exports until the viewer has applied a frame for the given generation
+    // or later; the exporter only notices a new viewer between generations.
+    bool PumpWireExporter(rvrse::core::WireExporter &exporter,
+                          rvrse::core::WireClient &client,
+                          const rvrse::core::ProcessSnapshot &snapshot,
+                          const rvrse::core::NetworkSnapshot &network,
+                          std::uint64_t &generation)
+    {
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        const std::uint64_t target = generation + 1;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            ++generation;
+            exporter.Export({generation, std::chrono::system_clock::now(), snapshot, handles, network, metrics, registry, false, true});
+
+            auto status = client.ReadFrame(std::chrono::milliseconds(50));
+            while (status == rvrse::core::WireClient::ReadStatus::FrameApplied && client.State().Generation() < target)
+            {
+                status = client.ReadFrame(std::chrono::milliseconds(50));
+            }
+            if (status == rvrse::core::WireClient::ReadStatus::FrameApplied)
+            {
+                return true;
+            }
+            if (status != rvrse::core::WireClient::ReadStatus::Timeout)
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    void TestWireExporter()
+    {
+        rvrse::core::WireOptions options;
+        options.listen = L"tcp://127.0.0.1:0";
+
+        rvrse::core::WireExporter exporter(options);
+        if (!exporter.Start() || exporter.Port() == 0)
+        {
+            ReportFailure(L"WireExporter failed to listen on loopback.");
+            return;
+        }
+
+        rvrse::core::SocketEndpoint endpoint;
+        endpoint.address = "127.0.0.1";
+        endpoint.port = exporter.Port();
+
+        rvrse::core::WireClient client;
+        if (!client.Connect(endpoint))
+        {
+            ReportFailure(L"WireClient could not connect or rejected the hello.");
+            return;
+        }
+
+        auto entries = MakeSyntheticProcesses(200);
+        const rvrse::core::ProcessSnapshot first(entries);
+        const rvrse::core::NetworkSnapshot network(MakeSyntheticConnections(30));
+        std::uint64_t generation = 0;
+        if (!PumpWireExporter(exporter, client, first, network, generation) ||
+            !client.State().LastFrameWasKeyframe() ||
+            !SameProcesses(client.State().BuildProcessSnapshot().Processes(), first.Processes()) ||
+            !SameConnections(client.State().BuildNetworkSnapshot(), network))
+        {
+            ReportFailure(L"Wire viewer did not start from a keyframe matching the collector.");
+            return;
+        }
+
+        entries[42].workingSetBytes *= 2;
+        entries.erase(entries.begin() + 7);
+        const rvrse::core::ProcessSnapshot second(entries);
+        if (!PumpWireExporter(exporter, client, second, network, generation) ||
+            !SameProcesses(client.State(), second.Processes()))
+        {
+            ReportFailure(L"Wire viewer did not follow a delta.");
+        }
+
+        if (exporter.ViewerCount() != 1 || exporter.BytesSent() == 0)
+        {
+            ReportFailure(L"WireExporter did not account for its viewer.");
+        }
+
+        exporter.Stop();
+        if (client.ReadFrame(std::chrono::milliseconds(2000)) != rvrse::core::WireClient::ReadStatus::Disconnected)
+        {
+            ReportFailure(L"Wire viewer did not notice the exporter stopping.");
+        }
+    }
+
+    // A minute of a 1,000-process host at the default 1 s cadence: 10% of
+    // processes accumulate CPU time each second, a few working sets move,
+    // one process is replaced every 20 s and the 5 s network capture sees
+    // one connection change. One keyframe per minute.
+    void BenchmarkWireProtocol()
+    {
+        constexpr std::size_t kProcesses = 1000;
+        constexpr std::uint64_t kGenerations = 60;
+
+        auto entries = MakeSyntheticProcesses(kProcesses);
+        auto connections = MakeSyntheticConnections(200);
+        std::vector<rvrse::core::ProcessSnapshot> snapshots;
+        std::vector<rvrse::core::NetworkSnapshot> networks;
+        snapshots.reserve(kGenerations);
+        networks.reserve(kGenerations);
+        for (std::uint64_t generation = 0; generation < kGenerations; ++generation)
+        {
+            for (std::size_t index = generation % 10; index < entries.size(); index += 10)
+            {
+                entries[index].kernelTime100ns += 1000 * (index % 7 + 1);
+                entries[index].userTime100ns += 25000;
+            }
+            for (std::size_t index = generation % 50; index < entries.size(); index += 50)
+            {
+                entries[index].workingSetBytes += 4096 * (generation % 3) - 4096;
+            }
+            if (generation % 20 == 19)
+            {
+                entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(generation));
+                entries.push_back(entries.back());
+                entries.back().processId += 4;
+                entries.back().imageName = L"worker" + std::to_wstring(generation) + L".exe";
+            }
+            if (generation % 5 == 4)
+            {
+                connections[generation % connections.size()].remotePort += 1;
+            }
+            snapshots.emplace_back(entries);
+            networks.emplace_back(connections);
+        }
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+        rvrse::core::WireEncoder encoder(kGenerations);
+        std::string frame;
+        std::size_t totalBytes = 0;
+        std::size_t keyframeBytes = 0;
+        std::uint64_t generation = 0;
+
+        const int iterations = static_cast<int>(kGenerations);
+        const double thresholdMs = 1.0;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                const std::size_t index = static_cast<std::size_t>(generation++);
+                frame.clear();
+                const bool networkRefreshed = index % 5 == 4;
+                if (encoder.Encode({generation, std::chrono::system_clock::now(), snapshots[index], handles, networks[index], metrics, registry, false, networkRefreshed}, frame))
+                {
+                    keyframeBytes = frame.size();
+                }
+                totalBytes += frame.size();
+            },
+            iterations);
+
+        // One generation per second, so bytes per generation is bytes/s.
+        const double bytesPerSecond = static_cast<double>(totalBytes) / static_cast<double>(kGenerations);
+        const double bytesPerSecondBudget = 4096.0;
+        std::fwprintf(stdout,
+                      L"[PERF] Wire encode avg: %.3f ms, %.0f bytes/s per host at 1 s cadence (%zu processes, keyframe %zu bytes)\n",
+                      averageMs,
+                      bytesPerSecond,
+                      kProcesses,
+                      keyframeBytes);
+        const bool passed = averageMs <= thresholdMs && bytesPerSecond <= bytesPerSecondBudget;
+        if (!passed)
+        {
+            ReportFailure(L"Wire protocol encode time or bandwidth regression detected.");
+        }
+
+        RecordBenchmarkResult(L"WireProtocol",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // Host h's processes: the synthetic table with private bytes skewed per
+    // host, so rankings interleave across hosts and include ties.
+    std::vector<rvrse::core::ProcessEntry> MakeFleetHostProcesses(std::size_t host, std::size_t count)
+    {
+        auto entries = MakeSyntheticProcesses(count);
+        for (std::size_t index = 0; index < entries.size(); ++index)
+        {
+            entries[index].privateBytes += static_cast<std::uint64_t>((index * 7 + host * 13) % 31) * 65536ULL;
+            entries[index].threadCount = static_cast<std::uint32_t>((index + host) % 40 + 1);
+        }
+        return entries;
+    }
+
+    struct FleetBruteForceEntry
+    {
+        double value;
+        std::wstring host;
+        std::uint32_t processId;
+    };
+
+    // What FleetIndex::Top() must return, by scanning every process.
+    std::vector<FleetBruteForceEntry> FleetTopByScan(const std::vector<std::pair<std::wstring, std::vector<rvrse::core::ProcessEntry>>> &hosts,
+                                                     std::size_t limit)
+    {
+        std::vector<FleetBruteForceEntry> all;
+        for (const auto &[host, processes] : hosts)
+        {
+            for (const auto &process : processes)
+            {
+                all.push_back({static_cast<double>(process.privateBytes), host, process.processId});
+            }
+        }
+        std::sort(all.begin(), all.end(), [](const FleetBruteForceEntry &lhs, const FleetBruteForceEntry &rhs)
+                  {
+                      if (lhs.value != rhs.value)
+                      {
+                          return lhs.value > rhs.value;
+                      }
+                      return lhs.host != rhs.host ? lhs.host < rhs.host : lhs.processId < rhs.processId;
+                  });
+        all.resize(std::min(limit, all.size()));
+        return all;
+    }
+
+    bool SameFleetTop(const std::vector<rvrse::core::FleetTopEntry> &top, const std::vector<FleetBruteForceEntry> &expected)
+    {
+        return std::equal(top.begin(), top.end(), expected.begin(), expected.end(),
+                          [](const rvrse::core::FleetTopEntry &entry, const FleetBruteForceEntry &want)
+                          {
+                              return entry.value == want.value && entry.host->host == want.host && entry.process->processId == want.processId &&
+                                     static_cast<double>(entry.process->privateBytes) == want.value;
+                          });
+    }
+
+    void TestFleetIndex()
+    {
+        rvrse::core::FleetMetric metric = rvrse::core::FleetMetric::CpuPercent;
+        if (!rvrse::core::ParseFleetMetric("private_bytes", metric) || metric != rvrse::core::FleetMetric::PrivateBytes ||
+            rvrse::core::ParseFleetMetric("bogus", metric) ||
+            std::string_view(rvrse::core::FleetMetricName(rvrse::core::FleetMetric::Threads)) != "threads")
+        {
+            ReportFailure(L"Fleet metric names did not round-trip.");
+        }
+
+        // CPU usage comes from the difference between two generations.
+        auto entries = MakeSyntheticProcesses(300);
+        const auto start = std::chrono::system_clock::now();
+        rvrse::core::HostSummaryBuilder builder;
+        builder.Build(L"alpha", 1, start, {}, entries);
+        entries[17].userTime100ns += 5'000'000; // half a second of CPU in one second
+        const auto summary = builder.Build(L"alpha", 2, start + std::chrono::seconds(1), {}, entries);
+
+        const auto &cpuRanking = summary->ranking[static_cast<std::size_t>(rvrse::core::FleetMetric::CpuPercent)];
+        if (summary->processCount != 300 || cpuRanking.size() != rvrse::core::HostSummary::kTopDepth ||
+            summary->processes[cpuRanking[0]].processId != entries[17].processId ||
+            std::abs(summary->processes[cpuRanking[0]].cpuPercent - 50.0) > 0.01 ||
+            summary->processes.size() > rvrse::core::kFleetMetricCount * rvrse::core::HostSummary::kTopDepth)
+        {
+            ReportFailure(L"HostSummaryBuilder ranked CPU usage incorrectly.");
+        }
+
+        rvrse::core::FleetIndex index(3);
+        std::vector<std::pair<std::wstring, std::vector<rvrse::core::ProcessEntry>>> hosts;
+        for (std::size_t host = 0; host < 3; ++host)
+        {
+            hosts.emplace_back(L"host-" + std::to_wstring(host), MakeFleetHostProcesses(host, 400));
+            rvrse::core::HostSummaryBuilder hostBuilder;
+            if (!index.Attach(hosts.back().first, host + 1))
+            {
+                ReportFailure(L"FleetIndex refused a host below its limit.");
+                return;
+            }
+            index.Publish(host + 1, hostBuilder.Build(hosts.back().first, 1, start, {}, hosts.back().second));
+        }
+
+        for (const std::size_t limit : {std::size_t{1}, std::size_t{20}, std::size_t{100}})
+        {
+            if (!SameFleetTop(index.Top(rvrse::core::FleetMetric::PrivateBytes, limit), FleetTopByScan(hosts, limit)))
+            {
+                ReportFailure(L"FleetIndex::Top disagrees with a full scan.");
+            }
+        }
+        if (index.Top(rvrse::core::FleetMetric::PrivateBytes, 1000).size() != rvrse::core::HostSummary::kTopDepth)
+        {
+            ReportFailure(L"FleetIndex::Top did not cap the limit at the ranking depth.");
+        }
+
+        // A fourth host is over the limit; a reconnecting host takes over
+        // its entry and the old connection can no longer publish to it.
+        rvrse::core::HostSummaryBuilder staleBuilder;
+        if (index.Attach(L"host-3", 9) || !index.Attach(L"host-0", 7))
+        {
+            ReportFailure(L"FleetIndex did not enforce its host limit.");
+        }
+        index.Publish(1, staleBuilder.Build(L"host-0", 99, start, {}, {}));
+        index.Detach(L"host-0", 1);
+        const auto listed = index.Hosts();
+        if (listed.size() != 3 || listed[0].summary->host != L"host-0" || listed[0].summary->generation != 1 || !listed[0].connected)
+        {
+            ReportFailure(L"A stale connection overwrote or detached a host it no longer owns.");
+        }
+
+        index.Detach(L"host-0", 7);
+        hosts.erase(hosts.begin());
+        if (index.Hosts()[0].connected || !SameFleetTop(index.Top(rvrse::core::FleetMetric::PrivateBytes, 20), FleetTopByScan(hosts, 20)))
+        {
+            ReportFailure(L"A disconnected host still shows up in fleet queries.");
+        }
+    }
+
+    // Waits until every named host has published at least the given
+    // generation.
+    bool WaitForFleet(const rvrse::core::FleetIndex &index, std::size_t hostCount, std::uint64_t generation)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            const auto hosts = index.Hosts();
+            std::size_t current = 0;
+            for (const auto &host : hosts)
+            {
+                current += host.connected && host.summary->generation >= generation ? 1 : 0;
+            }
+            if (current == hostCount)
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    // Simulated collectors: push-mode wire exporters, one per host, streaming
+    // to an aggregator on loopback.
+    void TestFleetAggregator()
+    {
+        rvrse::core::CollectorConfig config;
+        std::wstring error;
+        if (rvrse::core::ParseCollectorConfig("wire_push = tcp://127.0.0.1:0\n", config, error) ||
+            !rvrse::core::ParseCollectorConfig("wire_push = tcp://10.0.0.2:9466\nwire_host_name = web-01\n", config, error) ||
+            config.wirePush != L"tcp://10.0.0.2:9466" || config.wireHostName != L"web-01")
+        {
+            ReportFailure(L"wire_push / wire_host_name were not parsed as documented.");
+        }
+
+        rvrse::core::FleetAggregatorOptions options;
+        options.listen = L"tcp://127.0.0.1:0";
+        options.workerThreads = 2;
+        rvrse::core::FleetAggregator aggregator(options);
+        if (!aggregator.Start() || aggregator.Port() == 0 || aggregator.WorkerCount() != 2)
+        {
+            ReportFailure(L"FleetAggregator failed to listen on loopback.");
+            return;
+        }
+
+        constexpr std::size_t kHosts = 6;
+        std::vector<std::pair<std::wstring, std::vector<rvrse::core::ProcessEntry>>> hosts;
+        std::vector<std::unique_ptr<rvrse::core::WireExporter>> collectors;
+        for (std::size_t host = 0; host < kHosts; ++host)
+        {
+            rvrse::core::WireOptions wireOptions;
+            wireOptions.push = L"tcp://127.0.0.1:" + std::to_wstring(aggregator.Port());
+            wireOptions.hostName = L"sim-" + std::to_wstring(host);
+            hosts.emplace_back(wireOptions.hostName, MakeFleetHostProcesses(host, 300));
+            collectors.push_back(std::make_unique<rvrse::core::WireExporter>(std::move(wireOptions)));
+            if (!collectors.back()->Start())
+            {
+                ReportFailure(L"WireExporter rejected a push target.");
+                return;
+            }
+        }
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+        const auto exportAll = [&](std::uint64_t generation)
+        {
+            for (std::size_t host = 0; host < kHosts; ++host)
+            {
+                const rvrse::core::ProcessSnapshot snapshot(hosts[host].second);
+                collectors[host]->Export({generation, std::chrono::system_clock::now(), snapshot, handles, network, metrics, registry, false, false});
+            }
+        };
+
+        // Collectors connect from their server threads; keep producing
+        // generations until all of them are streaming.
+        std::uint64_t generation = 0;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (aggregator.Index().Hosts().size() < kHosts && std::chrono::steady_clock::now() < deadline)
+        {
+            exportAll(++generation);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        // One more generation with a change on every host, as a delta.
+        for (std::size_t host = 0; host < kHosts; ++host)
+        {
+            hosts[host].second[host * 11].privateBytes = (8ULL << 30) + host;
+            hosts[host].second.erase(hosts[host].second.begin() + 3);
+        }
+        exportAll(++generation);
+        if (!WaitForFleet(aggregator.Index(), kHosts, generation) || aggregator.ConnectionCount() != kHosts)
+        {
+            ReportFailure(L"FleetAggregator did not receive every simulated collector.");
+            return;
+        }
+
+        if (!SameFleetTop(aggregator.Index().Top(rvrse::core::FleetMetric::PrivateBytes, 20), FleetTopByScan(hosts, 20)))
+        {
+            ReportFailure(L"Fleet top processes disagree with a scan of every collector.");
+        }
+
+        // Names come from each connection's decoder, not the global pool.
+        bool namesMatch = true;
+        for (const rvrse::core::FleetTopEntry &entry : aggregator.Index().Top(rvrse::core::FleetMetric::PrivateBytes, 20))
+        {
+            for (const auto &[host, processes] : hosts)
+            {
+                for (const rvrse::core::ProcessEntry &process : processes)
+                {
+                    if (host == entry.host->host && process.processId == entry.process->processId)
+                    {
+                        namesMatch = namesMatch && entry.process->name == process.imageName.View();
+                    }
+                }
+            }
+        }
+        if (!namesMatch)
+        {
+            ReportFailure(L"Fleet top processes lost their names on the way through the aggregator.");
+        }
+
+        // A collector going away drops out of queries but keeps its last
+        // generation in the host list.
+        collectors[0]->Stop();
+        hosts.erase(hosts.begin());
+        const auto stopDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (aggregator.Index().Hosts()[0].connected && std::chrono::steady_clock::now() < stopDeadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (aggregator.Index().Hosts()[0].connected || aggregator.Index().Hosts().size() != kHosts ||
+            !SameFleetTop(aggregator.Index().Top(rvrse::core::FleetMetric::PrivateBytes, 20), FleetTopByScan(hosts, 20)))
+        {
+            ReportFailure(L"A disconnected collector was not marked as such.");
+        }
+
+        // Something that is not a collector is turned away.
+        rvrse::core::Socket intruder;
+        const char garbage[] = "GET / HTTP/1.1\r\n\r\n";
+        char byte = 0;
+        if (!intruder.ConnectTcp("127.0.0.1", aggregator.Port()) || !intruder.SendAll(garbage, sizeof(garbage) - 1) ||
+            intruder.Receive(&byte, 1, std::chrono::milliseconds(2000)) != 0 || aggregator.ProtocolErrors() != 1)
+        {
+            ReportFailure(L"FleetAggregator accepted a stream without a wire hello.");
+        }
+
+        collectors.clear();
+        aggregator.Stop();
+    }
+
+    // A 200-host fleet of 1,000-process collectors: the top 20 processes by
+    // private bytes, answered from the per-host rankings versus a scan of
+    // every process.
+    void BenchmarkFleetQuery()
+    {
+        constexpr std::size_t kHosts = 200;
+        constexpr std::size_t kProcesses = 1000;
+
+        rvrse::core::FleetIndex index(kHosts);
+        std::vector<std::vector<rvrse::core::ProcessEntry>> tables;
+        tables.reserve(kHosts);
+        const auto now = std::chrono::system_clock::now();
+        for (std::size_t host = 0; host < kHosts; ++host)
+        {
+            const std::wstring name = L"host-" + std::to_wstring(host);
+            tables.push_back(MakeFleetHostProcesses(host, kProcesses));
+            rvrse::core::HostSummaryBuilder builder;
+            index.Attach(name, host + 1);
+            index.Publish(host + 1, builder.Build(name, 1, now, {}, tables.back()));
+        }
+
+        std::size_t checksum = 0;
+        const int iterations = 500;
+        const double thresholdMs = 0.1;
+        double averageMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                checksum += index.Top(rvrse::core::FleetMetric::PrivateBytes, 20).size();
+            },
+            iterations);
+
+        std::vector<std::uint64_t> scan;
+        double scanMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                scan.clear();
+                for (const auto &table : tables)
+                {
+                    for (const auto &process : table)
+                    {
+                        scan.push_back(process.privateBytes);
+                    }
+                }
+                std::partial_sort(scan.begin(), scan.begin() + 20, scan.end(), std::greater<std::uint64_t>());
+                checksum += scan.size();
+            },
+            10);
+
+        std::fwprintf(stdout,
+                      L"[PERF] Fleet top-20 query avg: %.4f ms (%zu hosts x %zu processes; full scan %.3f ms)\n",
+                      averageMs,
+                      kHosts,
+                      kProcesses,
+                      scanMs);
+        const bool passed = averageMs <= thresholdMs && checksum > 0;
+        if (!passed)
+        {
+            ReportFailure(L"Fleet query performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"FleetQuery",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // Replays TerminalScreen output the way a VT terminal would: cursor
+    // moves, clears, SGR attributes and UTF-8 text. Returns false on
+    // anything TerminalScreen is not expected to emit.
+    bool ApplyTerminalOutput(std::vector<rvrse::core::ScreenCell> &cells, int columns, const std::string &output)
+    {
+        int row = 0;
+        int column = 0;
+        std::uint8_t attributes = rvrse::core::kScreenNormal;
+        std::size_t index = 0;
+        while (index < output.size())
+        {
+            const auto byte = static_cast<unsigned char>(output[index]);
+            if (byte == 0x1B)
+            {
+                if (index + 1 >= output.size() || output[index + 1] != '[')
+                {
+                    return false;
+                }
+                std::size_t end = index + 2;
+                while (end < output.size() && ((output[end] >= '0' && output[end] <= '9') || output[end] == ';'))
+                {
+                    ++end;
+                }
+                if (end == output.size())
+                {
+                    return false;
+                }
+
+                std::vector<int> parameters;
+                std::string_view text(output.data() + index + 2, end - index - 2);
+                while (!text.empty())
+                {
+                    const std::size_t separator = text.find(';');
+                    parameters.push_back(std::atoi(std::string(text.substr(0, separator)).c_str()));
+                    text.remove_prefix(separator == std::string_view::npos ? text.size() : separator + 1);
+                }
+
+                switch (output[end])
+                {
+                case 'H':
+                    if (parameters.size() != 2)
+                    {
+                        return false;
+                    }
+                    row = parameters[0] - 1;
+                    column = parameters[1] - 1;
+                    break;
+                case 'J':
+                    std::fill(cells.begin(), cells.end(), rvrse::core::ScreenCell{});
+                    break;
+                case 'm':
+                    attributes = rvrse::core::kScreenNormal;
+                    for (int parameter : parameters)
+                    {
+                        attributes |= parameter == 1 ? rvrse::core::kScreenBold : 0;
+                        attributes |= parameter == 2 ? rvrse::core::kScreenDim : 0;
+                        attributes |= parameter == 7 ? rvrse::core::kScreenReverse : 0;
+                    }
+                    break;
+                default:
+                    return false;
+                }
+                index = end + 1;
+                continue;
+            }
+
+            std::size_t length = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+            char32_t ch = length == 1 ? byte : byte & (0x7F >> length);
+            for (std::size_t next = 1; next < length; ++next)
+            {
+                ch = (ch << 6) | (static_cast<unsigned char>(output[index + next]) & 0x3F);
+            }
+            index += length;
+
+            if (column < 0 || column >= columns || row < 0 || static_cast<std::size_t>(row * columns + column) >= cells.size())
+            {
+                return false;
+            }
+            cells[static_cast<std::size_t>(row * columns + column)] = rvrse::core::ScreenCell{ch, attributes};
+            ++column;
+        }
+        return true;
+    }
+
+    bool SameScreen(const rvrse::core::TerminalScreen &screen, const std::vector<rvrse::core::ScreenCell> &cells)
+    {
+        for (int row = 0; row < screen.Rows(); ++row)
+        {
+            for (int column = 0; column < screen.Columns(); ++column)
+            {
+                if (screen.At(column, row) != cells[static_cast<std::size_t>(row * screen.Columns() + column)])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void TestProcessView()
+    {
+        using rvrse::core::ProcessSortColumn;
+
+        auto entries = MakeSyntheticProcesses(50);
+        entries[7].imageName = L"Chrome.exe";
+        entries[8].imageName = L"chromedriver";
+        entries[9].imageName = L"xCHROMEx";
+        for (std::size_t index = 0; index < entries.size(); ++index)
+        {
+            entries[index].threadCount = static_cast<std::uint32_t>(index % 3);
+        }
+
+        const auto countMatches = [&entries](std::wstring_view text)
+        {
+            const rvrse::core::ProcessFilter filter(text);
+            return std::count_if(entries.begin(), entries.end(), [&filter](const rvrse::core::ProcessEntry &process)
+                                 { return filter.Matches(process); });
+        };
+
+        if (!rvrse::core::ProcessFilter(L" \t ").Empty() || countMatches(L"") != 50)
+        {
+            ReportFailure(L"A blank process filter should match every process.");
+        }
+        if (countMatches(L"  chrome ") != 3 || countMatches(L"CHROMED") != 1 || countMatches(L"firefox") != 0)
+        {
+            ReportFailure(L"Process name filter should be a trimmed, case-insensitive substring match.");
+        }
+        if (countMatches(L" 32 ") != 1 || countMatches(L"3") != 0)
+        {
+            ReportFailure(L"A digits-only process filter should match the PID exactly.");
+        }
+
+        // Every column, both directions: adjacent rows in order, ties by PID.
+        const ProcessSortColumn columns[] = {ProcessSortColumn::Name,
+                                             ProcessSortColumn::ProcessId,
+                                             ProcessSortColumn::Threads,
+                                             ProcessSortColumn::WorkingSet,
+                                             ProcessSortColumn::PrivateBytes};
+        for (ProcessSortColumn column : columns)
+        {
+            for (bool ascending : {true, false})
+            {
+                auto sorted = entries;
+                rvrse::core::SortProcesses(sorted, column, ascending);
+                for (std::size_t index = 1; index < sorted.size(); ++index)
+                {
+                    const int order = rvrse::core::CompareProcesses(sorted[index - 1], sorted[index], column);
+                    if (order == 0 || (ascending ? order > 0 : order < 0))
+                    {
+                        ReportFailure(L"SortProcesses produced an out-of-order list.");
+                        break;
+                    }
+                }
+            }
+        }
+
+        auto byThreads = entries;
+        rvrse::core::SortProcesses(byThreads, ProcessSortColumn::Threads, true);
+        if (byThreads[0].processId != 4 || byThreads[1].processId != 16 || byThreads.back().processId != 192)
+        {
+            ReportFailure(L"Equal sort keys should be ordered by PID.");
+        }
+
+        auto byName = entries;
+        rvrse::core::SortProcesses(byName, ProcessSortColumn::Name, true);
+        if (byName[0].imageName != L"Chrome.exe" || byName[1].imageName != L"chromedriver" || byName.back().imageName != L"xCHROMEx")
+        {
+            ReportFailure(L"Name sort should ignore case.");
+        }
+
+        // CPU usage is the delta to the previous generation over wall time.
+        rvrse::core::ProcessView view;
+        const auto start = std::chrono::steady_clock::now();
+        view.Update(entries, start);
+        if (view.Rows().size() != 50 || view.TotalCount() != 50 || view.Rows()[0].cpuPercent != 0.0)
+        {
+            ReportFailure(L"ProcessView should list every process at 0% CPU after one generation.");
+        }
+
+        auto next = entries;
+        next[3].userTime100ns += 5'000'000;   // 0.5 s of a 1 s interval
+        next[5].kernelTime100ns += 1'000'000; // 0.1 s
+        next[4].userTime100ns = 0;            // PID reused: time went backwards
+        view.Update(next, start + std::chrono::seconds(1));
+        const auto &rows = view.Rows();
+        if (rows.size() != 50 || rows[0].process != &next[3] || std::fabs(rows[0].cpuPercent - 50.0) > 0.01 ||
+            rows[1].process != &next[5] || std::fabs(rows[1].cpuPercent - 10.0) > 0.01)
+        {
+            ReportFailure(L"ProcessView CPU usage or CPU sort is wrong.");
+        }
+        for (const auto &row : rows)
+        {
+            if (row.process == &next[4] && row.cpuPercent != 0.0)
+            {
+                ReportFailure(L"ProcessView should not report usage for a reused PID.");
+            }
+        }
+
+        std::wstring filterError;
+        view.SetFilter(L"process1", filterError);
+        view.SetSort(ProcessSortColumn::ProcessId, true);
+        if (view.Rows().size() != 11 || view.Rows()[0].process->imageName != L"process1.exe" || view.TotalCount() != 50)
+        {
+            ReportFailure(L"ProcessView filter or PID sort is wrong.");
+        }
+    }
+
+    std::vector<rvrse::core::ProcessEntry> MakeNamedProcesses(std::size_t count)
+    {
+        static const wchar_t *kNames[] = {
+            L"svchost.exe", L"chrome.exe", L"Code.exe", L"RuntimeBroker.exe", L"MsMpEng.exe", L"SearchIndexer.exe",
+            L"Microsoft.Photos.exe", L"nginx", L"systemd-journald", L"postgres", L"Überwachung.EXE", L"ÄRGER.exe",
+            L"微信.exe", L"ΣΊΣΥΦΟΣ", L"", L"kworker/u16:3-events_unbound",
+            L"Microsoft.WindowsTerminal.PreviewWithAVeryLongPackageNameThatSpansSeveralVectors.exe"};
+
+        std::vector<rvrse::core::ProcessEntry> processes(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            processes[index].processId = static_cast<std::uint32_t>(4 * (index + 1));
+            std::wstring name = kNames[index % std::size(kNames)];
+            if (index % 3 == 0 && !name.empty())
+            {
+                name += std::to_wstring(index);
+            }
+            processes[index].imageName = name;
+        }
+        return processes;
+    }
+
+    void TestNameMatcher()
+    {
+        const auto processes = MakeNamedProcesses(200);
+        rvrse::core::NameMatcher names;
+        names.Assign(processes);
+        if (names.Size() != processes.size())
+        {
+            ReportFailure(L"NameMatcher did not keep one entry per process.");
+            return;
+        }
+
+        // Every substring (in both cases) of a few names, plus text that only
+        // exists across two neighbouring names.
+        std::vector<std::wstring> needles = {L"", L"E", L"exe", L"EXE1", L"über", L"微", L"journald", L"xeüb",
+                                             L"exesvc", L"nginxpostgres", L"s", L"zzz", L"exe.", L"3-EVENTS_UNBOUND"};
+        for (const wchar_t *source : {L"Microsoft.WindowsTerminal.PreviewWithAVeryLongPackageNameThatSpansSeveralVectors.exe", L"RuntimeBroker.exe"})
+        {
+            const std::wstring name = source;
+            for (std::size_t start = 0; start < name.size(); start += 3)
+            {
+                for (std::size_t length = 1; start + length <= name.size(); length += 5)
+                {
+                    needles.push_back(name.substr(start, length));
+                    needles.push_back(rvrse::common::ToLower(name.substr(start, length)));
+                }
+            }
+        }
+
+        std::vector<std::uint8_t> matches;
+        for (const std::wstring &text : needles)
+        {
+            const rvrse::core::ProcessFilter filter(text);
+            if (filter.ByProcessId())
+            {
+                continue;
+            }
+
+            names.Find(filter.Needle(), matches);
+            for (std::size_t index = 0; index < processes.size(); ++index)
+            {
+                if ((matches[index] != 0) != filter.Matches(processes[index]))
+                {
+                    ReportFailure(L"NameMatcher disagrees with ProcessFilter::Matches.");
+                    return;
+                }
+            }
+        }
+
+        // PID filters and ProcessView go through the same path.
+        std::vector<std::uint8_t> byPid;
+        rvrse::core::ProcessFilter(L"40").Apply(processes, names, byPid);
+        if (std::count(byPid.begin(), byPid.end(), 1) != 1 || byPid[9] != 1)
+        {
+            ReportFailure(L"ProcessFilter::Apply mishandled a PID filter.");
+        }
+
+        rvrse::core::ProcessView view;
+        view.Update(processes, std::chrono::steady_clock::now());
+        std::wstring filterError;
+        view.SetFilter(L"CHROME", filterError);
+        const auto expected = std::count_if(processes.begin(), processes.end(), [](const rvrse::core::ProcessEntry &process)
+                                            { return process.imageName.View().rfind(L"chrome", 0) == 0; });
+        if (static_cast<std::ptrdiff_t>(view.Rows().size()) != expected)
+        {
+            ReportFailure(L"ProcessView filter did not match the expected rows.");
+        }
+    }
+
+    void BenchmarkNameMatcher()
+    {
+        const auto processes = MakeNamedProcesses(10000);
+        const wchar_t *keystrokes[] = {L"c", L"ch", L"chr", L"chro", L"chrom", L"chrome"};
+
+        rvrse::core::NameMatcher names;
+        const int iterations = 50;
+        const double assignMs = MeasureAverageMilliseconds([&]()
+                                                           { names.Assign(processes); },
+                                                           iterations);
+
+        std::vector<rvrse::core::ProcessFilter> filters;
+        for (const wchar_t *text : keystrokes)
+        {
+            filters.emplace_back(text);
+        }
+
+        std::vector<std::uint8_t> matches;
+        std::size_t matched = 0;
+        const double matcherMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (const auto &filter : filters)
+                {
+                    filter.Apply(processes, names, matches);
+                    matched += static_cast<std::size_t>(std::count(matches.begin(), matches.end(), 1));
+                }
+            },
+            iterations);
+
+        const double perNameMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (const auto &filter : filters)
+                {
+                    for (const auto &process : processes)
+                    {
+                        matched += filter.Matches(process) ? 1 : 0;
+                    }
+                }
+            },
+            iterations);
+
+        const double perKeystrokeUs = matcherMs * 1000.0 / std::size(keystrokes);
+        std::fwprintf(stdout,
+                      L"[PERF] Name filter over 10,000 processes: %.1f us per keystroke (per-name fold and search %.1f us), folding a generation %.1f us (%zu matches)\n",
+                      perKeystrokeUs,
+                      perNameMs * 1000.0 / std::size(keystrokes),
+                      assignMs * 1000.0,
+                      matched);
+
+        // Six keystrokes.
+        const double thresholdMs = 2.0;
+        const bool passed = matcherMs <= thresholdMs && matcherMs < perNameMs;
+        if (!passed)
+        {
+            ReportFailure(L"Name filter performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"NameMatcher10kProcesses",
+                              matcherMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // MakeNamedProcesses with every column a query reads filled in, plus a
+    // few handles per process and connections for every third one.
+    std::vector<rvrse::core::ProcessEntry> MakeQueryProcesses(std::size_t count,
+                                                              rvrse::core::HandleSnapshot &handles,
+                                                              rvrse::core::NetworkSnapshot &network)
+    {
+        auto processes = MakeNamedProcesses(count);
+        std::vector<rvrse::core::HandleEntry> handleEntries;
+        std::vector<rvrse::core::ConnectionEntry> connections;
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            auto &process = processes[index];
+            process.parentProcessId = index < 8 ? 0 : processes[index % 8].processId;
+            process.threadCount = static_cast<std::uint32_t>(index % 151);
+            process.workingSetBytes = static_cast<std::uint64_t>(index % 1013) * 1024ULL * 1024ULL;
+            process.privateBytes = process.workingSetBytes / 3;
+
+            for (std::size_t handle = 0; handle < index % 5; ++handle)
+            {
+                rvrse::core::HandleEntry entry;
+                entry.processId = process.processId;
+                entry.handleValue = static_cast<std::uint16_t>(4 * (handle + 1));
+                handleEntries.push_back(entry);
+            }
+            for (std::size_t connection = 0; index % 3 == 0 && connection <= index % 4; ++connection)
+            {
+                rvrse::core::ConnectionEntry entry;
+                entry.owningProcessId = process.processId;
+                entry.localPort = static_cast<std::uint16_t>(1024 + connection);
+                connections.push_back(entry);
+            }
+        }
+
+        // A connection whose owner already exited.
+        rvrse::core::ConnectionEntry stray;
+        stray.owningProcessId = 3;
+        connections.push_back(stray);
+
+        handles = rvrse::core::HandleSnapshot(std::move(handleEntries));
+        network = rvrse::core::NetworkSnapshot(std::move(connections));
+        return processes;
+    }
+
+    void TestProcessQuery()
+    {
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        const auto processes = MakeQueryProcesses(600, handles, network);
+
+        rvrse::core::ProcessTable table;
+        table.Assign(processes);
+        table.AssignHandles(handles);
+        table.AssignConnections(network);
+        if (table.Size() != processes.size() || table.HandleCounts()[7] != 2 || table.ConnectionCounts()[3] != 4 ||
+            table.ConnectionCounts()[1] != 0 || table.ParentProcessIds()[9] != 8)
+        {
+            ReportFailure(L"ProcessTable columns do not match the processes.");
+            return;
+        }
+
+        constexpr std::uint64_t kMiB = 1024ULL * 1024ULL;
+        const auto hasName = [&](std::size_t index, const wchar_t *needle)
+        { return rvrse::core::ProcessFilter(needle).Matches(processes[index]); };
+        const auto connections = [&](std::size_t index)
+        { return network.ConnectionCountForProcess(processes[index].processId); };
+
+        struct QueryCase
+        {
+            const wchar_t *text;
+            std::function<bool(std::size_t)> expected;
+        };
+        const QueryCase cases[] = {
+            {L"", [](std::size_t)
+             { return true; }},
+            {L"  CHROME ", [&](std::size_t index)
+             { return hasName(index, L"chrome"); }},
+            {L"40", [&](std::size_t index)
+             { return processes[index].processId == 40; }},
+            {L"Code exe", [&](std::size_t index)
+             { return hasName(index, L"code exe"); }},
+            {L"name:chrome ws>500MB", [&](std::size_t index)
+             { return hasName(index, L"chrome") && processes[index].workingSetBytes > 500 * kMiB; }},
+            {L"threads>=100 parent:8 conn>0", [&](std::size_t index)
+             { return processes[index].threadCount >= 100 && processes[index].parentProcessId == 8 && connections(index) > 0; }},
+            {L"PPID=12 threads<10 handles!=0", [&](std::size_t index)
+             { return processes[index].parentProcessId == 12 && processes[index].threadCount < 10 && handles.HandleCountForProcess(processes[index].processId) != 0; }},
+            {L"ws>=0.5g private<=200mb", [&](std::size_t index)
+             { return processes[index].workingSetBytes >= 512 * kMiB && processes[index].privateBytes <= 200 * kMiB; }},
+            {L"name=NGINX", [&](std::size_t index)
+             { return processes[index].imageName == L"nginx"; }},
+            {L"svchost conn>1", [&](std::size_t index)
+             { return hasName(index, L"svchost") && connections(index) > 1; }},
+            {L"name:\"kworker/u16:3-events\" pid>100", [&](std::size_t index)
+             { return hasName(index, L"kworker/u16:3-events") && processes[index].processId > 100; }},
+            {L"40 threads>0", [&](std::size_t index)
+             { return processes[index].processId == 40; }},
+            {L"ws>100M ws<=200M ws!=150M", [&](std::size_t index)
+             { return processes[index].workingSetBytes > 100 * kMiB && processes[index].workingSetBytes <= 200 * kMiB && processes[index].workingSetBytes != 150 * kMiB; }},
+            {L"ws>1G ws<1M", [](std::size_t)
+             { return false; }},
+            {L"threads<0", [](std::size_t)
+             { return false; }},
+        };
+
+        std::vector<std::uint32_t> selection;
+        for (const QueryCase &queryCase : cases)
+        {
+            rvrse::core::ProcessQuery query;
+            std::wstring error;
+            if (!rvrse::core::ProcessQuery::Compile(queryCase.text, query, error))
+            {
+                ReportFailure(L"ProcessQuery rejected a valid query.");
+                continue;
+            }
+
+            query.Evaluate(table, selection);
+            std::vector<std::uint32_t> expected;
+            for (std::size_t index = 0; index < processes.size(); ++index)
+            {
+                if (queryCase.expected(index))
+                {
+                    expected.push_back(static_cast<std::uint32_t>(index));
+                }
+            }
+            if (selection != expected)
+            {
+                ReportFailure(L"ProcessQuery selected different processes than expected.");
+            }
+        }
+
+        // A query that fails to compile leaves the previous one in place.
+        rvrse::core::ProcessQuery query;
+        std::wstring error;
+        if (!rvrse::core::ProcessQuery::Compile(L"pid:40 conn>0", query, error) || !query.Uses(rvrse::core::ProcessQueryField::Connections) ||
+            query.Uses(rvrse::core::ProcessQueryField::Handles))
+        {
+            ReportFailure(L"ProcessQuery did not report the fields it uses.");
+        }
+        for (const wchar_t *invalid : {L"ws>", L"ws>5X", L"threads>1.5", L"name>3", L"colour:red pid:4", L"name:\"chrome", L"pid:99999999999999999999"})
+        {
+            error.clear();
+            if (rvrse::core::ProcessQuery::Compile(invalid, query, error) || error.empty())
+            {
+                ReportFailure(L"ProcessQuery accepted an invalid query.");
+            }
+        }
+        query.Evaluate(table, selection);
+        if (selection.size() != 1 || selection[0] != 9)
+        {
+            ReportFailure(L"A failed compile should keep the previous ProcessQuery.");
+        }
+
+        rvrse::core::ProcessView view;
+        view.Update(processes, std::chrono::steady_clock::now(), &handles, &network);
+        const auto withConnections = std::count_if(processes.begin(), processes.end(), [&](const rvrse::core::ProcessEntry &process)
+                                                   { return network.ConnectionCountForProcess(process.processId) > 2; });
+        if (!view.SetFilter(L"conn>2", error) || static_cast<std::ptrdiff_t>(view.Rows().size()) != withConnections ||
+            view.SetFilter(L"conn>", error) || static_cast<std::ptrdiff_t>(view.Rows().size()) != withConnections)
+        {
+            ReportFailure(L"ProcessView did not apply its compiled filter.");
+        }
+    }
+
+    void BenchmarkProcessQuery()
+    {
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        const auto processes = MakeQueryProcesses(10000, handles, network);
+
+        rvrse::core::ProcessTable table;
+        const int iterations = 50;
+        const double assignMs = MeasureAverageMilliseconds([&]()
+                                                           {
+                                                               table.Assign(processes);
+                                                               table.AssignHandles(handles);
+                                                               table.AssignConnections(network); },
+                                                           iterations);
+
+        // Each query with the same test written row at a time over
+        // ProcessEntry, terms in the order they were typed.
+        constexpr std::uint64_t kMiB = 1024ULL * 1024ULL;
+        const rvrse::core::ProcessFilter chrome(L"chrome");
+        const rvrse::core::ProcessFilter svchost(L"svchost");
+        const rvrse::core::ProcessFilter exe(L"exe");
+        const auto &handleCounts = table.HandleCounts();
+        const auto &connectionCounts = table.ConnectionCounts();
+        struct QueryCase
+        {
+            const wchar_t *text;
+            std::function<bool(const rvrse::core::ProcessEntry &, std::size_t)> matches;
+        };
+        const QueryCase cases[] = {
+            {L"name:chrome ws>500MB threads>=100 parent:8 conn>0", [&](const rvrse::core::ProcessEntry &process, std::size_t index)
+             { return chrome.Matches(process) && process.workingSetBytes > 500 * kMiB && process.threadCount >= 100 &&
+                      process.parentProcessId == 8 && connectionCounts[index] > 0; }},
+            {L"ws>200MB private<100MB threads>=50", [&](const rvrse::core::ProcessEntry &process, std::size_t)
+             { return process.workingSetBytes > 200 * kMiB && process.privateBytes < 100 * kMiB && process.threadCount >= 50; }},
+            {L"svchost conn>0", [&](const rvrse::core::ProcessEntry &process, std::size_t index)
+             { return svchost.Matches(process) && connectionCounts[index] > 0; }},
+            {L"name:exe handles>=3 ppid=12", [&](const rvrse::core::ProcessEntry &process, std::size_t index)
+             { return exe.Matches(process) && handleCounts[index] >= 3 && process.parentProcessId == 12; }},
+            {L"pid:4000", [&](const rvrse::core::ProcessEntry &process, std::size_t)
+             { return process.processId == 4000; }},
+        };
+
+        std::vector<rvrse::core::ProcessQuery> queries(std::size(cases));
+        for (std::size_t index = 0; index < std::size(cases); ++index)
+        {
+            std::wstring error;
+            if (!rvrse::core::ProcessQuery::Compile(cases[index].text, queries[index], error))
+            {
+                ReportFailure(L"ProcessQuery rejected a benchmark query.");
+                return;
+            }
+        }
+
+        std::vector<std::uint32_t> selection;
+        std::size_t compiledMatches = 0;
+        const double compiledMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (const auto &query : queries)
+                {
+                    query.Evaluate(table, selection);
+                    compiledMatches += selection.size();
+                }
+            },
+            iterations);
+
+        std::size_t rowMatches = 0;
+        const double rowMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                for (const QueryCase &queryCase : cases)
+                {
+                    for (std::size_t index = 0; index < processes.size(); ++index)
+                    {
+                        rowMatches += queryCase.matches(processes[index], index) ? 1 : 0;
+                    }
+                }
+            },
+            iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] Compiled filter queries over 10,000 processes: %.1f us per query (row at a time %.1f us), building the table %.1f us (%zu matches)\n",
+                      compiledMs * 1000.0 / std::size(cases),
+                      rowMs * 1000.0 / std::size(cases),
+                      assignMs * 1000.0,
+                      compiledMatches / iterations);
+
+        if (compiledMatches != rowMatches)
+        {
+            ReportFailure(L"Compiled and row-at-a-time filter queries disagree.");
+        }
+
+        // Five queries.
+        const double thresholdMs = 1.0;
+        const bool passed = compiledMs <= thresholdMs && compiledMs < rowMs;
+        if (!passed)
+        {
+            ReportFailure(L"Filter query performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"ProcessQuery10kProcesses",
+                              compiledMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // Reference order for ProcessOrder: CompareProcesses, with CPU% first
+    // for that column, as ProcessView sorted before.
+    std::vector<std::uint32_t> ReferenceOrder(const std::vector<rvrse::core::ProcessEntry> &processes,
+                                              const std::vector<double> &cpuPercent,
+                                              std::vector<std::uint32_t> rows,
+                                              rvrse::core::ProcessSortColumn column,
+                                              bool ascending)
+    {
+        std::sort(rows.begin(), rows.end(), [&](std::uint32_t lhs, std::uint32_t rhs)
+                  {
+                      int result = 0;
+                      if (column == rvrse::core::ProcessSortColumn::CpuPercent)
+                      {
+                          result = cpuPercent[lhs] < cpuPercent[rhs] ? -1 : (cpuPercent[lhs] > cpuPercent[rhs] ? 1 : 0);
+                      }
+                      if (result == 0)
+                      {
+                          result = rvrse::core::CompareProcesses(processes[lhs], processes[rhs], column);
+                      }
+                      return ascending ? result < 0 : result > 0; });
+        return rows;
+    }
+
+    // The next generation: working sets and CPU of `changed` processes move
+    // by varying amounts, every 97th process exits and a few new ones start.
+    void AdvanceGeneration(std::vector<rvrse::core::ProcessEntry> &processes, std::vector<double> &cpuPercent, std::size_t changed, std::size_t generation)
+    {
+        for (std::size_t step = 0; step < changed; ++step)
+        {
+            const std::size_t index = (generation * 7919 + step * 104729) % processes.size();
+            processes[index].workingSetBytes += (step % 5) * 4096 * (generation % 3 + 1);
+            cpuPercent[index] = static_cast<double>((step * 31 + generation) % 400) / 4.0;
+        }
+        if (changed == 0)
+        {
+            return;
+        }
+
+        std::vector<rvrse::core::ProcessEntry> next;
+        std::vector<double> nextCpu;
+        next.reserve(processes.size() + 4);
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            if ((index + generation) % 97 != 0)
+            {
+                next.push_back(std::move(processes[index]));
+                nextCpu.push_back(cpuPercent[index]);
+            }
+        }
+        for (std::size_t added = 0; added < 4; ++added)
+        {
+            rvrse::core::ProcessEntry process;
+            process.processId = next.back().processId + 4;
+            process.imageName = L"new" + std::to_wstring(generation) + L".exe";
+            process.threadCount = static_cast<std::uint32_t>(added + 1);
+            process.workingSetBytes = (added + generation) * 1024 * 1024;
+            next.push_back(std::move(process));
+            nextCpu.push_back(static_cast<double>(added));
+        }
+        processes.swap(next);
+        cpuPercent.swap(nextCpu);
+    }
+
+    void TestProcessOrder()
+    {
+        using rvrse::core::ProcessOrderStrategy;
+        using rvrse::core::ProcessSortColumn;
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        auto processes = MakeQueryProcesses(700, handles, network);
+        std::vector<double> cpuPercent(processes.size());
+        for (std::size_t index = 0; index < processes.size(); ++index)
+        {
+            cpuPercent[index] = static_cast<double>(index % 13) * 2.5;
+        }
+
+        const ProcessSortColumn columns[] = {ProcessSortColumn::Name,
+                                             ProcessSortColumn::ProcessId,
+                                             ProcessSortColumn::Threads,
+                                             ProcessSortColumn::WorkingSet,
+                                             ProcessSortColumn::PrivateBytes,
+                                             ProcessSortColumn::CpuPercent};
+        for (ProcessSortColumn column : columns)
+        {
+            for (bool ascending : {true, false})
+            {
+                auto generation = processes;
+                auto cpu = cpuPercent;
+                rvrse::core::ProcessTable table;
+                rvrse::core::ProcessOrder order;
+                std::vector<std::uint32_t> rows;
+
+                // Descending runs see a filtered subset, chosen by PID so
+                // that it stays the same across generations.
+                const auto select = [&]()
+                {
+                    table.Assign(generation);
+                    rows.clear();
+                    for (std::uint32_t index = 0; index < generation.size(); ++index)
+                    {
+                        if (ascending || generation[index].processId % 3 != 0)
+                        {
+                            rows.push_back(index);
+                        }
+                    }
+                };
+                for (std::size_t step = 0; step < 6; ++step)
+                {
+                    select();
+
+                    order.Sort(table, cpu, rows, column, ascending);
+                    if (order.Rows() != ReferenceOrder(generation, cpu, rows, column, ascending))
+                    {
+                        ReportFailure(L"ProcessOrder disagrees with CompareProcesses.");
+                        break;
+                    }
+
+                    const ProcessOrderStrategy expected =
+                        step != 0 ? ProcessOrderStrategy::Repaired
+                                  : (column == ProcessSortColumn::Name ? ProcessOrderStrategy::Comparison : ProcessOrderStrategy::Radix);
+                    if (order.LastStrategy() != expected)
+                    {
+                        ReportFailure(L"ProcessOrder did not repair a slightly changed order.");
+                    }
+                    AdvanceGeneration(generation, cpu, 8, step);
+                }
+
+                // Everything moved: a full sort again, still correct.
+                for (std::size_t index = 0; index < generation.size(); ++index)
+                {
+                    generation[index].workingSetBytes = (index * 7727) % 1000 * 1024;
+                    generation[index].privateBytes = (index * 5683) % 1000 * 1024;
+                    generation[index].threadCount = static_cast<std::uint32_t>((index * 31) % 211);
+                    cpu[index] = static_cast<double>((index * 13) % 101);
+                }
+                select();
+                order.Sort(table, cpu, rows, column, ascending);
+                const auto reference = ReferenceOrder(generation, cpu, rows, column, ascending);
+                if (order.Rows() != reference ||
+                    (column != ProcessSortColumn::Name && column != ProcessSortColumn::ProcessId && order.LastStrategy() == ProcessOrderStrategy::Repaired))
+                {
+                    ReportFailure(L"ProcessOrder mishandled a generation where every row moved.");
+                }
+
+                // Top-K: the first rows are exact, the rest is a permutation.
+                order.Sort(table, cpu, rows, column, ascending, 25);
+                auto sorted = order.Rows();
+                std::sort(sorted.begin(), sorted.end());
+                if (order.LastStrategy() != ProcessOrderStrategy::Partial || sorted != rows ||
+                    !std::equal(reference.begin(), reference.begin() + 25, order.Rows().begin()))
+                {
+                    ReportFailure(L"ProcessOrder top-K ordering is wrong.");
+                }
+            }
+        }
+
+        // ProcessView with a sort limit keeps every row but orders the page.
+        rvrse::core::ProcessView view;
+        view.Update(processes, std::chrono::steady_clock::now());
+        view.SetSort(ProcessSortColumn::WorkingSet, false);
+        const auto full = view.Rows();
+        view.SetSortLimit(10);
+        if (view.Rows().size() != full.size() ||
+            !std::equal(full.begin(), full.begin() + 10, view.Rows().begin(), [](const rvrse::core::ProcessRow &lhs, const rvrse::core::ProcessRow &rhs)
+                        { return lhs.process == rhs.process; }))
+        {
+            ReportFailure(L"ProcessView sort limit changed the visible rows.");
+        }
+    }
+
+    void BenchmarkProcessOrder()
+    {
+        using rvrse::core::ProcessSortColumn;
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        const auto first = MakeQueryProcesses(10000, handles, network);
+        std::vector<double> firstCpu(first.size());
+        for (std::size_t index = 0; index < first.size(); ++index)
+        {
+            firstCpu[index] = static_cast<double>(index % 211) / 8.0;
+        }
+
+        // Two generations a refresh apart: 1% of the rows changed, a few
+        // exited or started. Sorting them alternately is a refresh each.
+        auto second = first;
+        auto secondCpu = firstCpu;
+        AdvanceGeneration(second, secondCpu, first.size() / 100, 1);
+
+        rvrse::core::ProcessTable tables[2];
+        tables[0].Assign(first);
+        tables[1].Assign(second);
+        const std::vector<double> *cpu[2] = {&firstCpu, &secondCpu};
+        std::vector<std::uint32_t> rows[2];
+        for (int generation = 0; generation < 2; ++generation)
+        {
+            rows[generation].resize(tables[generation].Size());
+            std::iota(rows[generation].begin(), rows[generation].end(), std::uint32_t{0});
+        }
+
+        const int iterations = 50;
+        rvrse::core::ProcessOrder order;
+        std::size_t repaired = 0;
+        int tick = 0;
+        const auto refresh = [&](ProcessSortColumn column, bool ascending, std::size_t limit)
+        {
+            const int generation = tick++ % 2;
+            order.Sort(tables[generation], *cpu[generation], rows[generation], column, ascending, limit);
+            repaired += order.LastStrategy() == rvrse::core::ProcessOrderStrategy::Repaired ? 1 : 0;
+        };
+
+        refresh(ProcessSortColumn::WorkingSet, false, 0);
+        repaired = 0;
+        const double repairMs = MeasureAverageMilliseconds([&]()
+                                                           { refresh(ProcessSortColumn::WorkingSet, false, 0); },
+                                                           iterations);
+        refresh(ProcessSortColumn::CpuPercent, false, 0);
+        const std::size_t workingSetRepairs = repaired;
+        repaired = 0;
+        const double cpuRepairMs = MeasureAverageMilliseconds([&]()
+                                                              { refresh(ProcessSortColumn::CpuPercent, false, 0); },
+                                                              iterations);
+        repaired += workingSetRepairs;
+
+        // A new column or direction every time: always a full radix sort.
+        bool ascending = false;
+        const double radixMs = MeasureAverageMilliseconds([&]()
+                                                          {
+                                                              ascending = !ascending;
+                                                              refresh(ProcessSortColumn::WorkingSet, ascending, 0); },
+                                                          iterations);
+        const double partialMs = MeasureAverageMilliseconds([&]()
+                                                            { refresh(ProcessSortColumn::WorkingSet, false, 50); },
+                                                            iterations);
+
+        // What ProcessView did before: rows pointing at entries, a full
+        // std::sort through CompareProcesses().
+        std::vector<rvrse::core::ProcessRow> processRows;
+        const double comparisonMs = MeasureAverageMilliseconds(
+            [&]()
+            {
+                const auto &entries = tick++ % 2 == 0 ? first : second;
+                const auto &usage = tick % 2 == 0 ? secondCpu : firstCpu;
+                processRows.clear();
+                for (std::size_t index = 0; index < entries.size(); ++index)
+                {
+                    processRows.push_back(rvrse::core::ProcessRow{&entries[index], usage[index]});
+                }
+                std::sort(processRows.begin(), processRows.end(), [](const rvrse::core::ProcessRow &lhs, const rvrse::core::ProcessRow &rhs)
+                          { return rvrse::core::CompareProcesses(*lhs.process, *rhs.process, ProcessSortColumn::WorkingSet) > 0; });
+            },
+            iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] Sorting 10,000 processes per refresh: repaired %.1f us (CPU%% %.1f us), radix %.1f us, top 50 %.1f us, std::sort %.1f us (%zu of %d repaired)\n",
+                      repairMs * 1000.0,
+                      cpuRepairMs * 1000.0,
+                      radixMs * 1000.0,
+                      partialMs * 1000.0,
+                      comparisonMs * 1000.0,
+                      repaired,
+                      2 * iterations);
+
+        if (repaired != static_cast<std::size_t>(2 * iterations))
+        {
+            ReportFailure(L"ProcessOrder fell back to a full sort for a 1% change.");
+        }
+
+        const double thresholdMs = 1.0;
+        const bool passed = repairMs <= thresholdMs && repairMs < comparisonMs && radixMs < comparisonMs;
+        if (!passed)
+        {
+            ReportFailure(L"Process sort performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"ProcessOrder10kProcesses",
+                              repairMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // The comparator the columns replaced: one switch on the column inside
+    // every comparison.
+    int SwitchCompareProcesses(const rvrse::core::ProcessEntry &lhs, const rvrse::core::ProcessEntry &rhs, rvrse::core::ProcessSortColumn column)
+    {
+        using rvrse::core::ProcessSortColumn;
+        const auto compare = [](auto left, auto right)
+        { return left < right ? -1 : (left > right ? 1 : 0); };
+
+        int result = 0;
+        switch (column)
+        {
+        case ProcessSortColumn::Name:
+        {
+            const std::wstring_view left = lhs.imageName;
+            const std::wstring_view right = rhs.imageName;
+            const std::size_t length = std::min(left.size(), right.size());
+            for (std::size_t index = 0; index < length && result == 0; ++index)
+            {
+                result = compare(rvrse::core::FoldNameCase(left[index]), rvrse::core::FoldNameCase(right[index]));
+            }
+            result = result != 0 ? result : compare(left.size(), right.size());
+            break;
+        }
+        case ProcessSortColumn::Threads:
+            result = compare(lhs.threadCount, rhs.threadCount);
+            break;
+        case ProcessSortColumn::WorkingSet:
+            result = compare(lhs.workingSetBytes, rhs.workingSetBytes);
+            break;
+        case ProcessSortColumn::PrivateBytes:
+            result = compare(lhs.privateBytes, rhs.privateBytes);
+            break;
+        case ProcessSortColumn::ProcessId:
+        case ProcessSortColumn::CpuPercent:
+            break;
+        }
+        return result != 0 ? result : compare(lhs.processId, rhs.processId);
+    }
+
+    void TestProcessColumns()
+    {
+        using rvrse::core::ProcessSortColumn;
+
+        std::vector<std::wstring> titles;
+        std::vector<std::string> exportNames;
+        rvrse::core::ForEachProcessColumn([&](const auto &column)
+                                          {
+                                              titles.emplace_back(column.title);
+                                              exportNames.emplace_back(column.exportName); });
+        const std::vector<std::wstring> expectedTitles = {L"Process", L"PID", L"Threads", L"Working Set", L"Private Bytes"};
+        const std::vector<std::string> expectedExportNames = {"name", "pid", "threads", "working_set_bytes", "private_bytes"};
+        if (rvrse::core::kProcessColumnCount != 5 || titles != expectedTitles || exportNames != expectedExportNames)
+        {
+            ReportFailure(L"Process columns are not the list view columns in order.");
+        }
+
+        rvrse::core::ProcessEntry process;
+        process.processId = 4242;
+        process.imageName = L"svchost.exe";
+        process.threadCount = 17;
+        process.workingSetBytes = 5ULL * 1024 * 1024 + 123456;
+        process.privateBytes = 0;
+
+        wchar_t buffer[rvrse::core::kProcessColumnTextCapacity];
+        const std::wstring expectedText[] = {L"svchost.exe",
+                                             L"4242",
+                                             L"17",
+                                             rvrse::common::FormatSize(process.workingSetBytes),
+                                             rvrse::common::FormatSize(process.privateBytes)};
+        for (std::size_t column = 0; column < rvrse::core::kProcessColumnCount; ++column)
+        {
+            const std::wstring_view text = rvrse::core::FormatProcessColumn(process, static_cast<ProcessSortColumn>(column), buffer);
+            if (text != expectedText[column] || text.data()[text.size()] != L'\0')
+            {
+                ReportFailure(L"FormatProcessColumn() does not match the list view text.");
+            }
+        }
+        if (rvrse::core::FormatProcessDecimal(0, buffer) != L"0" ||
+            rvrse::core::FormatProcessDecimal(~std::uint64_t{0}, buffer) != L"18446744073709551615" ||
+            !rvrse::core::FormatProcessColumn(process, ProcessSortColumn::CpuPercent, buffer).empty())
+        {
+            ReportFailure(L"Process column decimals are wrong.");
+        }
+
+        // Every column and direction sorts like the switch comparator,
+        // ties and all.
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        const auto processes = MakeQueryProcesses(600, handles, network);
+        for (int column = 0; column <= static_cast<int>(ProcessSortColumn::CpuPercent); ++column)
+        {
+            const auto sortColumn = static_cast<ProcessSortColumn>(column);
+            for (const bool ascending : {true, false})
+            {
+                auto sorted = processes;
+                rvrse::core::SortProcesses(sorted, sortColumn, ascending);
+                auto expected = processes;
+                std::sort(expected.begin(), expected.end(), [&](const auto &lhs, const auto &rhs)
+                          {
+                              const int result = SwitchCompareProcesses(lhs, rhs, sortColumn);
+                              return ascending ? result < 0 : result > 0; });
+
+                bool same = sorted.size() == expected.size();
+                for (std::size_t index = 0; same && index < sorted.size(); ++index)
+                {
+                    same = sorted[index].processId == expected[index].processId;
+                }
+                if (!same)
+                {
+                    ReportFailure(L"SortProcesses() disagrees with the switch comparator.");
+                }
+            }
+
+            for (std::size_t index = 0; index + 1 < processes.size(); index += 7)
+            {
+                const auto &lhs = processes[index];
+                const auto &rhs = processes[(index * 31 + 5) % processes.size()];
+                if (rvrse::core::CompareProcesses(lhs, rhs, sortColumn) != SwitchCompareProcesses(lhs, rhs, sortColumn))
+                {
+                    ReportFailure(L"CompareProcesses() disagrees with the switch comparator.");
+                    break;
+                }
+            }
+        }
+    }
+
+    void BenchmarkProcessColumns()
+    {
+        using rvrse::core::ProcessSortColumn;
+
+        rvrse::core::HandleSnapshot handles;
+        rvrse::core::NetworkSnapshot network;
+        const auto processes = MakeQueryProcesses(10000, handles, network);
+
+        // Column clicks: each sort starts from the other column's order.
+        // The switch comparator takes the column at run time, as the old
+        // CompareProcesses() did from its own translation unit.
+        const int iterations = 20;
+        auto sorted = processes;
+        int clicks = 0;
+        const auto nextColumn = [&clicks]()
+        { return ++clicks % 2 == 0 ? ProcessSortColumn::WorkingSet : ProcessSortColumn::Threads; };
+        const double columnSortMs = MeasureAverageMilliseconds([&]()
+                                                               {
+                                                                   const ProcessSortColumn column = nextColumn();
+                                                                   rvrse::core::SortProcesses(sorted, column, column == ProcessSortColumn::Threads); },
+                                                               iterations);
+        const double switchSortMs = MeasureAverageMilliseconds([&]()
+                                                               {
+                                                                   const ProcessSortColumn column = nextColumn();
+                                                                   const bool ascending = column == ProcessSortColumn::Threads;
+                                                                   std::sort(sorted.begin(), sorted.end(), [column, ascending](const auto &lhs, const auto &rhs)
+                                                                             {
+                                                                                 const int result = SwitchCompareProcesses(lhs, rhs, column);
+                                                                                 return ascending ? result < 0 : result > 0; }); },
+                                                               iterations);
+
+        // A list view fill: every non-name column of every row.
+        std::size_t characters = 0;
+        const double columnFormatMs = MeasureAverageMilliseconds([&]()
+                                                                 {
+                                                                     wchar_t buffer[rvrse::core::kProcessColumnTextCapacity];
+                                                                     for (const auto &process : processes)
+                                                                     {
+                                                                         for (std::size_t column = 1; column < rvrse::core::kProcessColumnCount; ++column)
+                                                                         {
+                                                                             characters += rvrse::core::FormatProcessColumn(process, static_cast<ProcessSortColumn>(column), buffer).size();
+                                                                         }
+                                                                     } },
+                                                                 iterations);
+        const double printfFormatMs = MeasureAverageMilliseconds([&]()
+                                                                 {
+                                                                     wchar_t buffer[32];
+                                                                     for (const auto &process : processes)
+                                                                     {
+                                                                         characters += static_cast<std::size_t>(std::swprintf(buffer, std::size(buffer), L"%u", process.processId));
+                                                                         characters += static_cast<std::size_t>(std::swprintf(buffer, std::size(buffer), L"%u", process.threadCount));
+                                                                         wchar_t sizeBuffer[rvrse::common::kFormatSizeCapacity];
+                                                                         characters += rvrse::common::FormatSize(process.workingSetBytes, sizeBuffer).size();
+                                                                         characters += rvrse::common::FormatSize(process.privateBytes, sizeBuffer).size();
+                                                                     } },
+                                                                 iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] Process columns over 10,000 rows: sort %.3f ms (switch comparator %.3f ms), format %.3f ms (swprintf %.3f ms, %zu chars)\n",
+                      columnSortMs,
+                      switchSortMs,
+                      columnFormatMs,
+                      printfFormatMs,
+                      characters);
+
+        const double thresholdMs = 3.0;
+        const bool passed = columnSortMs <= thresholdMs && columnSortMs < switchSortMs && columnFormatMs < printfFormatMs;
+        if (!passed)
+        {
+            ReportFailure(L"Process column performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"ProcessColumns10kSort",
+                              columnSortMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    void TestColumnReduce()
+    {
+        // Values around the unsigned boundaries the SSE2 compares emulate,
+        // and every tail length after the vector blocks.
+        const std::uint64_t wide[] = {0, 1, 0x7fffffffULL, 0x80000000ULL, 0xffffffffULL, 0x100000000ULL,
+                                      0x7fffffffffffffffULL, 0x8000000000000000ULL, ~std::uint64_t{0}, 12345678901ULL};
+        for (std::size_t count = 0; count <= 41; ++count)
+        {
+            std::vector<std::uint64_t> values64(count);
+            std::vector<std::uint32_t> values32(count);
+            std::vector<std::uint8_t> selected(count);
+            for (std::size_t index = 0; index < count; ++index)
+            {
+                values64[index] = wide[(index * 7 + count) % std::size(wide)];
+                values32[index] = static_cast<std::uint32_t>(values64[index] ^ (values64[index] >> 29));
+                selected[index] = static_cast<std::uint8_t>((index * 5 + count) % 3 == 0 ? (index % 2 == 0 ? 1 : 255) : 0);
+            }
+
+            rvrse::core::ColumnSummary expected64;
+            rvrse::core::ColumnSummary expected32;
+            std::uint64_t unselected64 = 0;
+            std::uint64_t unselected32 = 0;
+            if (count != 0)
+            {
+                expected64.min = *std::min_element(values64.begin(), values64.end());
+                expected64.max = *std::max_element(values64.begin(), values64.end());
+                expected32.min = *std::min_element(values32.begin(), values32.end());
+                expected32.max = *std::max_element(values32.begin(), values32.end());
+            }
+            for (std::size_t index = 0; index < count; ++index)
+            {
+                expected64.sum += values64[index];
+                expected32.sum += values32[index];
+                unselected64 += selected[index] == 0 ? values64[index] : 0;
+                unselected32 += selected[index] == 0 ? values32[index] : 0;
+            }
+
+            const auto summary64 = rvrse::core::SummarizeColumn(values64);
+            const auto summary32 = rvrse::core::SummarizeColumn(values32);
+            if (summary64.sum != expected64.sum || summary64.min != expected64.min || summary64.max != expected64.max ||
+                summary32.sum != expected32.sum || summary32.min != expected32.min || summary32.max != expected32.max)
+            {
+                ReportFailure(L"SummarizeColumn() disagrees with a scalar pass.");
+                break;
+            }
+            if (rvrse::core::SumUnselected(values64, selected) != unselected64 ||
+                rvrse::core::SumUnselected(values32, selected) != unselected32)
+            {
+                ReportFailure(L"SumUnselected() disagrees with a scalar pass.");
+                break;
+            }
+        }
+
+        // Top-K against a stable sort, with plenty of ties.
+        std::vector<std::uint64_t> values(1003);
+        for (std::size_t index = 0; index < values.size(); ++index)
+        {
+            values[index] = index % 17 == 0 ? ~std::uint64_t{0} - index % 3 : (index * 7919) % 61;
+        }
+        std::vector<std::uint32_t> expected(values.size());
+        std::iota(expected.begin(), expected.end(), std::uint32_t{0});
+        std::stable_sort(expected.begin(), expected.end(), [&values](std::uint32_t lhs, std::uint32_t rhs)
+                         { return values[lhs] > values[rhs]; });
+        std::vector<std::uint32_t> top;
+        for (const std::size_t k : {std::size_t{0}, std::size_t{1}, std::size_t{3}, std::size_t{50}, std::size_t{80}, values.size(), values.size() + 5})
+        {
+            rvrse::core::TopColumnIndices(values, k, top);
+            const std::size_t kept = std::min(k, values.size());
+            if (top.size() != kept || !std::equal(top.begin(), top.end(), expected.begin()))
+            {
+                ReportFailure(L"TopColumnIndices() is not the stable top-K.");
+                break;
+            }
+        }
+
+        // Snapshots keep their arrays in PID order beside the entries.
+        auto processes = MakeSyntheticProcesses(9);
+        std::reverse(processes.begin(), processes.end());
+        const rvrse::core::ProcessSnapshot snapshot(processes);
+        const auto &arrays = snapshot.Arrays();
+        bool aligned = arrays.processIds.size() == snapshot.Processes().size() && arrays.userTime100ns.size() == snapshot.Processes().size();
+        for (std::size_t index = 0; aligned && index < snapshot.Processes().size(); ++index)
+        {
+            const auto &process = snapshot.Processes()[index];
+            aligned = arrays.processIds[index] == process.processId && arrays.threadCounts[index] == process.threadCount &&
+                      arrays.workingSetBytes[index] == process.workingSetBytes && arrays.privateBytes[index] == process.privateBytes &&
+                      arrays.kernelTime100ns[index] == process.kernelTime100ns && arrays.userTime100ns[index] == process.userTime100ns;
+        }
+        if (!aligned || !std::is_sorted(arrays.processIds.begin(), arrays.processIds.end()))
+        {
+            ReportFailure(L"ProcessSnapshot::Arrays() is not index-aligned with Processes().");
+        }
+    }
+
+    void BenchmarkColumnReduce()
+    {
+        const rvrse::core::ProcessSnapshot snapshot(MakeSyntheticProcesses(10000));
+        const auto &processes = snapshot.Processes();
+        const auto &arrays = snapshot.Arrays();
+
+        // Sum, minimum and maximum of threads, working set and private
+        // bytes: walking the entries as the summaries did, then over the
+        // arrays.
+        const int iterations = 200;
+        std::uint64_t checksum = 0;
+        const double entryMs = MeasureAverageMilliseconds([&]()
+                                                          {
+                                                              rvrse::core::ColumnSummary totals[3];
+                                                              for (auto &total : totals)
+                                                              {
+                                                                  total.min = ~std::uint64_t{0};
+                                                              }
+                                                              for (const auto &process : processes)
+                                                              {
+                                                                  const std::uint64_t values[3] = {process.threadCount, process.workingSetBytes, process.privateBytes};
+                                                                  for (int field = 0; field < 3; ++field)
+                                                                  {
+                                                                      totals[field].sum += values[field];
+                                                                      totals[field].min = std::min(totals[field].min, values[field]);
+                                                                      totals[field].max = std::max(totals[field].max, values[field]);
+                                                                  }
+                                                              }
+                                                              checksum += totals[0].sum + totals[1].sum + totals[2].sum + totals[1].max + totals[2].min; },
+                                                          iterations);
+        const double columnMs = MeasureAverageMilliseconds([&]()
+                                                           {
+                                                               const auto threads = rvrse::core::SummarizeColumn(arrays.threadCounts);
+                                                               const auto workingSet = rvrse::core::SummarizeColumn(arrays.workingSetBytes);
+                                                               const auto privateBytes = rvrse::core::SummarizeColumn(arrays.privateBytes);
+                                                               checksum += threads.sum + workingSet.sum + privateBytes.sum + workingSet.max + privateBytes.min; },
+                                                           iterations);
+
+        // The exporter's working-set top 50.
+        std::vector<std::uint32_t> ranking;
+        const double nthMs = MeasureAverageMilliseconds([&]()
+                                                        {
+                                                            ranking.resize(processes.size());
+                                                            std::iota(ranking.begin(), ranking.end(), std::uint32_t{0});
+                                                            std::nth_element(ranking.begin(), ranking.begin() + 50, ranking.end(), [&processes](std::uint32_t lhs, std::uint32_t rhs)
+                                                                             { return processes[lhs].workingSetBytes > processes[rhs].workingSetBytes; });
+                                                            checksum += ranking[0]; },
+                                                        iterations);
+        const double topMs = MeasureAverageMilliseconds([&]()
+                                                        {
+                                                            rvrse::core::TopColumnIndices(arrays.workingSetBytes, 50, ranking);
+                                                            checksum += ranking[0]; },
+                                                        iterations);
+
+        const auto perMicrosecond = [&processes](double ms)
+        { return ms > 0.0 ? static_cast<double>(processes.size()) / (ms * 1000.0) : 0.0; };
+        std::fwprintf(stdout,
+                      L"[PERF] Aggregating 10,000 processes: columns %.1f processes/us (entries %.1f), top 50 %.1f processes/us (nth_element %.1f) [%llu]\n",
+                      perMicrosecond(columnMs),
+                      perMicrosecond(entryMs),
+                      perMicrosecond(topMs),
+                      perMicrosecond(nthMs),
+                      static_cast<unsigned long long>(checksum % 10));
+
+        const double thresholdMs = 0.1;
+        const bool passed = columnMs <= thresholdMs && columnMs < entryMs && topMs < nthMs;
+        if (!passed)
+        {
+            ReportFailure(L"Column aggregation performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"ColumnReduce10kProcesses",
+                              columnMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    void TestStringInterner()
+    {
+        auto &interner = rvrse::core::StringInterner::Global();
+        const std::uint32_t first = interner.Intern(L"interner-test.exe");
+        if (first == rvrse::core::StringInterner::kEmptyId || interner.Intern(std::wstring(L"interner-test.exe")) != first ||
+            interner.Intern(L"interner-test.dll") == first || interner.Intern(L"") != rvrse::core::StringInterner::kEmptyId)
+        {
+            ReportFailure(L"StringInterner should give equal text one id and different text another.");
+        }
+        if (interner.Utf8(first) != "interner-test.exe" || std::strcmp(interner.Utf8(first).data(), "interner-test.exe") != 0 ||
+            std::wcscmp(interner.Wide(first).data(), L"interner-test.exe") != 0 ||
+            std::strcmp(interner.Utf8(rvrse::core::StringInterner::kEmptyId).data(), "") != 0 ||
+            std::wcscmp(interner.Wide(rvrse::core::StringInterner::kEmptyId).data(), L"") != 0)
+        {
+            ReportFailure(L"StringInterner should return the terminated text of an id.");
+        }
+
+        // Text is stored as UTF-8 whichever way it arrives; the wide copy is
+        // made once and then handed out again.
+        const std::uint32_t accented = interner.InternUtf8("interner-caf\xC3\xA9-\xF0\x9F\x98\x80.exe");
+        const std::wstring_view accentedWide = interner.Wide(accented);
+        const std::size_t wideBytes = interner.WideBytes();
+        if (interner.Intern(L"interner-caf\x00e9-\U0001F600.exe") != accented || accentedWide != L"interner-caf\x00e9-\U0001F600.exe" ||
+            interner.Wide(accented).data() != accentedWide.data() || interner.WideBytes() != wideBytes ||
+            interner.Utf8(accented) != "interner-caf\xC3\xA9-\xF0\x9F\x98\x80.exe")
+        {
+            ReportFailure(L"StringInterner should keep UTF-8 and convert each wide copy once.");
+        }
+        const rvrse::core::InternedString repaired = rvrse::core::InternedString::FromUtf8("interner-bad\xFF\xE2\x82");
+        if (repaired.Utf8() != "interner-bad\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD" ||
+            repaired.View() != L"interner-bad\xFFFD\xFFFD\xFFFD")
+        {
+            ReportFailure(L"StringInterner should store invalid UTF-8 with replacement characters.");
+        }
+
+        // A full pool refuses new text, and counts each refusal, but still
+        // finds what it holds.
+        rvrse::core::StringInterner small(3);
+        const std::uint32_t kept = small.Intern(L"interner-a");
+        small.Intern(L"interner-b");
+        if (small.Intern(L"interner-c") != rvrse::core::StringInterner::kEmptyId ||
+            small.Intern(L"interner-c") != rvrse::core::StringInterner::kEmptyId || small.Rejected() != 2 ||
+            small.Intern(L"interner-a") != kept || small.Rejected() != 2 || small.Size() != 3)
+        {
+            ReportFailure(L"A full StringInterner should count the text it refuses.");
+        }
+
+        const rvrse::core::InternedString name = L"interner-test.exe";
+        rvrse::core::InternedString copy;
+        copy = std::wstring_view(L"interner-test.exe!").substr(0, 17);
+        if (sizeof(rvrse::core::InternedString) != sizeof(std::uint32_t) || name.Id() != first || name != copy ||
+            name.View() != copy.View() || name.size() != 17 || !rvrse::core::InternedString().empty() || name.empty())
+        {
+            ReportFailure(L"InternedString should be a four-byte id that compares by identity.");
+        }
+
+        // Ids and text survive the table growing and text spilling into
+        // new chunks, including a string longer than a chunk.
+        std::vector<std::uint32_t> ids;
+        const std::wstring longText(40000, L'x');
+        const std::uint32_t longId = interner.Intern(longText);
+        for (int index = 0; index < 20000; ++index)
+        {
+            ids.push_back(interner.Intern(L"interner-grow-" + std::to_wstring(index)));
+        }
+        bool stable = interner.Wide(longId) == longText && interner.Utf8(first) == "interner-test.exe";
+        for (int index = 0; index < 20000 && stable; ++index)
+        {
+            const std::wstring text = L"interner-grow-" + std::to_wstring(index);
+            stable = interner.Intern(text) == ids[index] && interner.Wide(ids[index]) == text;
+        }
+        if (!stable || std::unordered_set<std::uint32_t>(ids.begin(), ids.end()).size() != ids.size())
+        {
+            ReportFailure(L"StringInterner ids should stay stable while the pool grows.");
+        }
+
+        // Threads interning the same new names agree on every id.
+        const int kThreads = 4;
+        const int kNames = 2000;
+        std::vector<std::vector<std::uint32_t>> seen(kThreads, std::vector<std::uint32_t>(kNames));
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < kThreads; ++thread)
+        {
+            workers.emplace_back([&seen, thread]()
+                                 {
+                                     for (int index = 0; index < kNames; ++index)
+                                     {
+                                         const int name = (index + thread * (kNames / kThreads)) % kNames;
+                                         seen[thread][name] = rvrse::core::StringInterner::Global().Intern(L"interner-race-" + std::to_wstring(name));
+                                     } });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        bool agreed = true;
+        for (int thread = 1; thread < kThreads && agreed; ++thread)
+        {
+            agreed = seen[thread] == seen[0];
+        }
+        if (!agreed)
+        {
+            ReportFailure(L"StringInterner should give concurrent callers the same id for the same text.");
+        }
+
+        // Captured names are interned: the same process keeps its id.
+        const auto own = GetCurrentProcessId();
+        const auto findOwn = [own](const rvrse::core::ProcessSnapshot &snapshot)
+        {
+            for (const auto &process : snapshot.Processes())
+            {
+                if (process.processId == own)
+                {
+                    return process.imageName;
+                }
+            }
+            return rvrse::core::InternedString();
+        };
+        const auto before = findOwn(rvrse::core::ProcessSnapshot::Capture({false}));
+        const auto after = findOwn(rvrse::core::ProcessSnapshot::Capture({false}));
+        if (before.empty() || before != after)
+        {
+            ReportFailure(L"Captured image names should intern to the same id across captures.");
+        }
+
+        const auto modules = rvrse::core::ProcessSnapshot::EnumerateModules(own);
+        const auto again = rvrse::core::ProcessSnapshot::EnumerateModules(own);
+        bool sameModules = !modules.empty() && modules.size() == again.size();
+        for (std::size_t index = 0; index < modules.size() && sameModules; ++index)
+        {
+            sameModules = modules[index].path == again[index].path && modules[index].name == again[index].name &&
+                          !modules[index].name.empty() && modules[index].path.View().find(modules[index].name.View()) != std::wstring_view::npos;
+        }
+        if (!sameModules)
+        {
+            ReportFailure(L"Module names and paths should intern to the same ids across enumerations.");
+        }
+    }
+
+    void BenchmarkStringInterner()
+    {
+        // A capture's names as they arrive: views into a native buffer, 2,000
+        // processes sharing a few hundred images.
+        const std::size_t count = 2000;
+        std::vector<std::wstring> source;
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            source.push_back(L"C:\\Program Files\\Vendor\\Product" + std::to_wstring(index % 300) + L"\\service-host.exe");
+        }
+
+        // Each capture fills fresh entries, then the exporters check every
+        // name against the previous generation.
+        const int iterations = 200;
+        std::size_t checksum = 0;
+        std::vector<std::wstring> previousCopies(count);
+        const double copyMs = MeasureAverageMilliseconds([&]()
+                                                         {
+                                                             std::vector<std::wstring> names;
+                                                             names.reserve(count);
+                                                             for (const auto &text : source)
+                                                             {
+                                                                 names.emplace_back(std::wstring_view(text));
+                                                             }
+                                                             const std::hash<std::wstring_view> hashName;
+                                                             for (std::size_t index = 0; index < count; ++index)
+                                                             {
+                                                                 checksum += hashName(names[index]) == hashName(previousCopies[index]);
+                                                             }
+                                                             previousCopies.swap(names); },
+                                                         iterations);
+
+        std::vector<rvrse::core::InternedString> previousIds(count);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            previousIds[index] = source[index];
+        }
+        const std::size_t storedBefore = rvrse::core::StringInterner::Global().Size();
+        const double internMs = MeasureAverageMilliseconds([&]()
+                                                           {
+                                                               std::vector<rvrse::core::InternedString> names;
+                                                               names.reserve(count);
+                                                               for (const auto &text : source)
+                                                               {
+                                                                   names.emplace_back(std::wstring_view(text));
+                                                               }
+                                                               for (std::size_t index = 0; index < count; ++index)
+                                                               {
+                                                                   checksum += names[index] == previousIds[index];
+                                                               }
+                                                               previousIds.swap(names); },
+                                                           iterations);
+        const bool steady = rvrse::core::StringInterner::Global().Size() == storedBefore;
+
+        std::fwprintf(stdout,
+                      L"[PERF] Naming 2,000 captured processes: interned %.3f ms, %zu bytes/name (copies %.3f ms, %zu bytes/name + heap) [%zu]\n",
+                      internMs,
+                      sizeof(rvrse::core::InternedString),
+                      copyMs,
+                      sizeof(std::wstring),
+                      checksum % 10);
+
+        const double thresholdMs = 0.5;
+        const bool passed = steady && internMs <= thresholdMs && internMs < copyMs;
+        if (!passed)
+        {
+            ReportFailure(L"String interning performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"StringInterner2kNames",
+                              internMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    void BenchmarkSnapshotTextBytes()
+    {
+        // A 2,000-process host: a few hundred distinct images, some with
+        // non-ASCII names, and the module paths a module view loads.
+        const std::size_t count = 2000;
+        std::vector<std::wstring> images;
+        for (std::size_t index = 0; index < 300; ++index)
+        {
+            images.push_back((index % 20 == 0 ? L"Caf\x00e9Sync" : L"ServiceHost") + std::to_wstring(index) + L".exe");
+        }
+        std::vector<std::wstring> modules;
+        for (std::size_t index = 0; index < 1500; ++index)
+        {
+            modules.push_back(L"C:\\Windows\\System32\\DriverStore\\FileRepository\\component" + std::to_wstring(index) + L".dll");
+        }
+
+        // Snapshot bytes: the entries, plus the distinct text the interner
+        // holds for them, as wchar_t before and as UTF-8 now.
+        rvrse::core::StringInterner interner;
+        std::size_t wideText = 0;
+        std::size_t utf8Text = 0;
+        for (const auto *texts : {&images, &modules})
+        {
+            for (const auto &text : *texts)
+            {
+                wideText += (text.size() + 1) * sizeof(wchar_t);
+                utf8Text += interner.Utf8(interner.Intern(text)).size() + 1;
+            }
+        }
+        const std::size_t entryBytes = count * sizeof(rvrse::core::ProcessEntry);
+
+        // Exporters now copy each name's stored UTF-8 instead of converting
+        // it every refresh.
+        const auto processes = MakeSyntheticProcesses(count);
+        const int iterations = 200;
+        std::string out;
+        const double convertMs = MeasureAverageMilliseconds([&]()
+                                                            {
+                                                                out.clear();
+                                                                for (const auto &process : processes)
+                                                                {
+                                                                    out += rvrse::common::WideToUtf8(process.imageName.View());
+                                                                }
+                                                            },
+                                                            iterations);
+        const std::size_t convertedSize = out.size();
+        const double copyMs = MeasureAverageMilliseconds([&]()
+                                                         {
+                                                             out.clear();
+                                                             for (const auto &process : processes)
+                                                             {
+                                                                 out += process.imageName.Utf8();
+                                                             }
+                                                         },
+                                                         iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] Snapshot text on a 2,000-process host: %zu bytes UTF-8 (was %zu as wchar_t), %zu bytes with entries (was %zu); exporting names %.3f ms (was %.3f ms converting)\n",
+                      utf8Text,
+                      wideText,
+                      entryBytes + utf8Text,
+                      entryBytes + wideText,
+                      copyMs,
+                      convertMs);
+
+        const double thresholdMs = 0.1;
+        const bool passed = utf8Text < wideText && out.size() == convertedSize &&
+                            interner.WideBytes() == 0 && copyMs <= thresholdMs;
+        if (!passed)
+        {
+            ReportFailure(L"Snapshot text size or export performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"SnapshotTextBytes2kProcesses",
+                              copyMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    void TestTerminalScreen()
+    {
+        rvrse::core::TerminalScreen screen;
+        screen.Resize(20, 5);
+        std::vector<rvrse::core::ScreenCell> terminal(100, rvrse::core::ScreenCell{U'#', rvrse::core::kScreenNormal});
+
+        screen.Put(0, 0, L"rvrse-top", rvrse::core::kScreenBold);
+        screen.Put(2, 3, L"caf\x00e9 \x2191");
+        std::string output;
+        screen.Render(output);
+        if (output.rfind("\x1b[0m\x1b[2J", 0) != 0 || !ApplyTerminalOutput(terminal, 20, output) || !SameScreen(screen, terminal))
+        {
+            ReportFailure(L"TerminalScreen first frame should clear and paint the screen.");
+        }
+
+        // Redrawing the same frame writes nothing, whether its text comes
+        // as wide characters or as UTF-8.
+        screen.Clear();
+        screen.Put(0, 0, L"rvrse-top", rvrse::core::kScreenBold);
+        screen.PutUtf8(2, 3, "caf\xC3\xA9 \xE2\x86\x91");
+        output.clear();
+        if (screen.Render(output) != 0 || !output.empty())
+        {
+            ReportFailure(L"TerminalScreen should emit nothing for an unchanged frame.");
+        }
+
+        screen.Put(5, 2, L"X");
+        output.clear();
+        if (screen.Render(output) != 1 || output.size() > 16 || !ApplyTerminalOutput(terminal, 20, output) || !SameScreen(screen, terminal))
+        {
+            ReportFailure(L"TerminalScreen should repaint only the changed cell.");
+        }
+
+        if (screen.Put(17, 1, L"abcdef") != 3 || screen.Put(0, 5, L"off screen") != 0)
+        {
+            ReportFailure(L"TerminalScreen::Put should clip at the screen edge.");
+        }
+        if (screen.PutUtf8(17, 1, "abcdef") != 3 || screen.PutUtf8(2, 4, "x\xE2\x82y\x80") != 4 || screen.At(3, 4).ch != U'?' ||
+            screen.At(4, 4).ch != U'y' || screen.At(5, 4).ch != U'?')
+        {
+            ReportFailure(L"TerminalScreen::PutUtf8 should clip at the edge and show malformed UTF-8 as '?'.");
+        }
+        screen.Put(0, 4, L"a\tb\x0007");
+        if (screen.At(1, 4).ch != U'?' || screen.At(3, 4).ch != U'?')
+        {
+            ReportFailure(L"TerminalScreen should show control characters as '?'.");
+        }
+
+        // Random edits with every attribute; the replayed terminal must
+        // always match the back buffer.
+        const wchar_t alphabet[] = L"abc XYZ0189\x00e9\x2191";
+        std::uint32_t seed = 12345;
+        const auto random = [&seed](std::uint32_t bound)
+        {
+            seed = seed * 1664525U + 1013904223U;
+            return (seed >> 8) % bound;
+        };
+        for (int frame = 0; frame < 300; ++frame)
+        {
+            if (frame % 100 == 50)
+            {
+                screen.Invalidate();
+            }
+            const int edits = static_cast<int>(random(12));
+            for (int edit = 0; edit < edits; ++edit)
+            {
+                std::wstring text;
+                for (std::uint32_t length = random(8); length > 0; --length)
+                {
+                    text.push_back(alphabet[random(static_cast<std::uint32_t>(std::size(alphabet) - 1))]);
+                }
+                screen.Put(static_cast<int>(random(20)), static_cast<int>(random(5)), text, static_cast<std::uint8_t>(random(8)));
+            }
+
+            output.clear();
+            screen.Render(output);
+            if (!ApplyTerminalOutput(terminal, 20, output) || !SameScreen(screen, terminal))
+            {
+                ReportFailure(L"TerminalScreen output diverged from its back buffer.");
+                break;
+            }
+        }
+    }
+
+    // One rvrse-top refresh minus the capture: CPU deltas, filter and sort
+    // of 2k processes, then a full 120x50 frame rendered through the
+    // damage-tracked screen.
+    void BenchmarkTopRefresh()
+    {
+        constexpr std::size_t kProcesses = 2000;
+        constexpr int kColumns = 120;
+        constexpr int kRows = 50;
+
+        auto entries = MakeSyntheticProcesses(kProcesses);
+        rvrse::core::ProcessView view;
+        view.SetSortLimit(kRows);
+        rvrse::core::TerminalScreen screen;
+        screen.Resize(kColumns, kRows);
+
+        auto timestamp = std::chrono::steady_clock::now();
+        std::size_t tick = 0;
+        std::string output;
+        std::uint64_t bytes = 0;
+
+        // rvrse-top's per-row text cache.
+        struct RowText
+        {
+            std::wstring text;
+            std::uint64_t rowHash = 0;
+            double cpuPercent = 0.0;
+            bool valid = false;
+        };
+        std::vector<RowText> rowText(kRows);
+        std::uint64_t formatted = 0;
+        const auto refresh = [&]()
+        {
+            // A few dozen busy processes per interval, as on a real server.
+            for (std::size_t busy = 0; busy < 40; ++busy)
+            {
+                entries[(tick * 37 + busy * 53) % kProcesses].userTime100ns += 100'000 * (busy + 1);
+            }
+            ++tick;
+            timestamp += std::chrono::seconds(1);
+            view.Update(entries, timestamp);
+
+            wchar_t line[256];
+            screen.Clear();
+            const auto &rows = view.Rows();
+            for (int row = 0; row < kRows && static_cast<std::size_t>(row) < rows.size(); ++row)
+            {
+                const auto &viewRow = rows[static_cast<std::size_t>(row)];
+                const auto &process = *viewRow.process;
+                RowText &text = rowText[static_cast<std::size_t>(row)];
+                if (!text.valid || text.rowHash != viewRow.rowHash || text.cpuPercent != viewRow.cpuPercent)
+                {
+                    wchar_t workingSet[rvrse::common::kFormatSizeCapacity];
+                    wchar_t privateBytes[rvrse::common::kFormatSizeCapacity];
+                    const int length = std::swprintf(line,
+                                                     std::size(line),
+                                                     L"%7u %6u %5.1f %4u %12ls %14ls  ",
+                                                     process.processId,
+                                                     process.parentProcessId,
+                                                     viewRow.cpuPercent,
+                                                     process.threadCount,
+                                                     rvrse::common::FormatSize(process.workingSetBytes, workingSet).data(),
+                                                     rvrse::common::FormatSize(process.privateBytes, privateBytes).data());
+                    text.text.assign(line, static_cast<std::size_t>(length));
+                    text.rowHash = viewRow.rowHash;
+                    text.cpuPercent = viewRow.cpuPercent;
+                    text.valid = true;
+                    ++formatted;
+                }
+                const int nameColumn = screen.Put(0, row, text.text);
+                screen.PutUtf8(nameColumn, row, process.imageName.Utf8());
+            }
+
+            output.clear();
+            screen.Render(output);
+            bytes += output.size();
+        };
+
+        refresh();
+        bytes = 0;
+        formatted = 0;
+
+        // 1% of a 1 s refresh interval is 10 ms; leave most of it to the
+        // capture itself.
+        const int iterations = 200;
+        const double thresholdMs = 2.0;
+        double averageMs = MeasureAverageMilliseconds(refresh, iterations);
+
+        std::fwprintf(stdout,
+                      L"[PERF] Top refresh avg: %.3f ms (%zu processes, %dx%d screen, %llu bytes and %llu rows formatted per frame)\n",
+                      averageMs,
+                      kProcesses,
+                      kColumns,
+                      kRows,
+                      static_cast<unsigned long long>(bytes / iterations),
+                      static_cast<unsigned long long>(formatted / iterations));
+        const bool passed = averageMs <= thresholdMs && bytes / iterations < static_cast<std::uint64_t>(kColumns * kRows);
+        if (!passed)
+        {
+            ReportFailure(L"Top refresh performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"TopRefresh",
+                              averageMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
+    }
+
+    // Generation t of the recorded history used by TestHistoryStore: PID 4's
+    // working set grows every frame, PID 8 uses half a core, PID 12 changes
+    // every 30 frames, PID 24 exits at t = 50 and burst.exe (PID 400) lives
+    // from t = 100 to t = 130 with a working set peaking at t = 120.
+    std::vector<rvrse::core::ProcessEntry> MakeHistoryGeneration(std::size_t t)
+    {
+        constexpr std::uint64_t kMegabyte = 1024ULL * 1024ULL;
+        auto processes = MakeSyntheticProcesses(40);
+        processes[0].workingSetBytes = (t + 1) * kMegabyte;
+        processes[1].userTime100ns += t * 5'000'000ULL;
+        processes[2].workingSetBytes = (t / 30 + 1) * 2 * kMegabyte;
+        if (t >= 50)
+        {
+            processes.erase(processes.begin() + 5);
+        }
+        if (t >= 100 && t <= 130)
+        {
+            rvrse::core::ProcessEntry burst;
+            burst.processId = 400;
+            burst.imageName = L"burst.exe";
+            burst.threadCount = 2;
+            burst.workingSetBytes = (t <= 120 ? t - 99 : 141 - t) * 45 * kMegabyte;
+            processes.push_back(burst);
+        }
+        return processes;
+    }
+
+    // PID 8 holds t / 10 + 1 handles, refreshed every 10 frames.
+    std::vector<rvrse::core::HandleEntry> MakeHistoryHandles(std::size_t t)
+    {
+        std::vector<rvrse::core::HandleEntry> handles(t / 10 + 1);
+        for (auto &handle : handles)
+        {
+            handle.processId = 8;
+        }
+        return handles;
+    }
+
+    bool RecordHistory(const std::filesystem::path &directory,
+                       std::int64_t startMs,
+                       std::size_t begin,
+                       std::size_t end,
+                       std::uint32_t keyframeInterval,
+                       const std::function<std::vector<rvrse::core::ProcessEntry>(std::size_t)> &generate,
+                       std::uint64_t *bytesWritten = nullptr)
+    {
+        rvrse::core::HistoryEncoder encoder(keyframeInterval);
+        rvrse::core::HistoryWriter writer(directory.wstring(), 0);
+        std::wstring error;
+        if (!writer.Open(error))
+        {
+            return false;
+        }
+
+        rvrse::core::NetworkSnapshot network;
+        rvrse::core::SystemMetrics metrics{};
+        rvrse::core::MetricsRegistry registry;
+        std::string body;
+        rvrse::core::HistoryFrameSummary summary;
+        for (std::size_t t = begin; t < end; ++t)
+        {
+            const rvrse::core::ProcessSnapshot processes(generate(t));
+            const bool handlesRefreshed = t % 10 == 0 || t == begin;
+            const rvrse::core::HandleSnapshot handles(handlesRefreshed ? MakeHistoryHandles(t) : std::vector<rvrse::core::HandleEntry>());
+            const auto timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(startMs + static_cast<std::int64_t>(t) * 1000));
+
+            encoder.Encode({t + 1, timestamp, processes, handles, network, metrics, registry, handlesRefreshed, false}, body, summary);
+            if (!writer.Append(summary, body))
+            {
+                return false;
+            }
+            if (bytesWritten)
+            {
+                *bytesWritten += body.size() + rvrse::core::history::kIndexEntryBytes;
+            }
+        }
+        return true;
+    }
+
+    void TestHistoryStore()
+    {
+        constexpr std::uint64_t kMegabyte = 1024ULL * 1024ULL;
+        constexpr std::size_t kFrames = 180;
+
+        // 2026-01-01 00:59:00 UTC: the second minute starts a new segment.
+        constexpr std::int64_t kStartMs = 1767229140000LL;
+        const auto directory = MakeTestLogDirectory(L"history");
+
+        // Two runs, the second appending to the segment the first one left
+        // with a torn index entry.
+        if (!RecordHistory(directory, kStartMs, 0, 90, 20, MakeHistoryGeneration))
+        {
+            ReportFailure(L"History recording failed.");
+            return;
+        }
+        {
+            std::ofstream torn(directory / L"history-20260101-01.rvx", std::ios::binary | std::ios::app);
+            torn.write("torn", 4);
+        }
+        if (!RecordHistory(directory, kStartMs, 90, kFrames, 20, MakeHistoryGeneration))
+        {
+            ReportFailure(L"History recording failed to reopen a segment.");
+            return;
+        }
+
+        const auto segments = rvrse::core::ListHistorySegments(directory.wstring());
+        std::vector<rvrse::core::HistoryFrameSummary> frames;
+        std::wstring error;
+        if (segments.size() != 2 || rvrse::core::history::SegmentName(segments[0].startMs) != L"history-20260101-00" ||
+            !rvrse::core::LoadHistoryIndex(segments[1], frames, error) || frames.size() != kFrames - 60 ||
+            (frames[30].flags & rvrse::core::history::kFrameKeyframe) == 0 || frames[30].intervalMs != 0 ||
+            frames[31].intervalMs != 1000)
+        {
+            ReportFailure(L"History segments or index entries are incorrect.");
+            return;
+        }
+
+        rvrse::core::HistoryReader reader(directory.wstring());
+        rvrse::core::HistoryQuery query;
+        query.fromMs = kStartMs;
+        query.toMs = kStartMs + static_cast<std::int64_t>(kFrames) * 1000;
+
+        // A process that changes every frame, then one that rarely does:
+        // only the frames with its records (and bloom false positives) are
+        // read.
+        std::vector<rvrse::core::HistorySeries> series;
+        query.process = L"4";
+        if (!reader.Series(query, series, error) || series.size() != 1 || series[0].name != L"process0.exe" ||
+            series[0].points.size() != kFrames || series[0].points.back().value != static_cast<double>(kFrames * kMegabyte) ||
+            series[0].points.back().timestampMs != kStartMs + static_cast<std::int64_t>(kFrames - 1) * 1000)
+        {
+            ReportFailure(L"History series of a changing process is incorrect.");
+        }
+
+        query.process = L"12";
+        if (!reader.Series(query, series, error) || series.size() != 1 || series[0].points.size() != 6 ||
+            series[0].points[2].value != static_cast<double>(6 * kMegabyte) || series[0].points[2].timestampMs != kStartMs + 60'000 ||
+            reader.Stats().framesRead >= kFrames / 3)
+        {
+            ReportFailure(L"History series did not skip frames without the process.");
+        }
+
+        // State at a window start between keyframes comes from the lead-in.
+        query.fromMs = kStartMs + 95'000;
+        if (!reader.Series(query, series, error) || series.size() != 1 || series[0].points.size() != 3 ||
+            series[0].points[0].timestampMs != query.fromMs || series[0].points[0].value != static_cast<double>(8 * kMegabyte))
+        {
+            ReportFailure(L"History series did not start from the state at the window start.");
+        }
+        query.fromMs = kStartMs;
+
+        query.process = L"24";
+        if (!reader.Series(query, series, error) || series.size() != 1 || series[0].points.size() != 1)
+        {
+            ReportFailure(L"History series of an exited process is incorrect.");
+        }
+
+        query.process = L"BURST";
+        query.metric = rvrse::core::HistoryMetric::WorkingSetBytes;
+        if (!reader.Series(query, series, error) || series.size() != 1 || series[0].processId != 400 || series[0].points.size() != 31)
+        {
+            ReportFailure(L"History series by name is incorrect.");
+        }
+
+        // burst.exe is born in a frame the threshold skips; its name comes
+        // from the resolution pass.
+        std::vector<rvrse::core::HistoryPeak> peaks;
+        query.process.clear();
+        query.over = 800.0 * static_cast<double>(kMegabyte);
+        if (!reader.Peaks(query, peaks, error) || peaks.size() != 1 || peaks[0].processId != 400 || peaks[0].name != L"burst.exe" ||
+            peaks[0].value != static_cast<double>(945 * kMegabyte) || peaks[0].timestampMs != kStartMs + 120'000 ||
+            peaks[0].firstOverMs != kStartMs + 117'000 || reader.Stats().framesRead >= kFrames / 4)
+        {
+            ReportFailure(L"History peaks over a threshold are incorrect.");
+        }
+
+        query.over = 0.0;
+        query.metric = rvrse::core::HistoryMetric::CpuPercent;
+        query.limit = 1;
+        if (!reader.Peaks(query, peaks, error) || peaks.size() != 1 || peaks[0].processId != 8 || std::fabs(peaks[0].value - 50.0) > 0.01)
+        {
+            ReportFailure(L"History CPU peaks are incorrect.");
+        }
+
+        query.metric = rvrse::core::HistoryMetric::Handles;
+        if (!reader.Peaks(query, peaks, error) || peaks.size() != 1 || peaks[0].processId != 8 || peaks[0].value != 18.0 ||
+            peaks[0].timestampMs != kStartMs + 170'000)
+        {
+            ReportFailure(L"History handle peaks are incorrect.");
+        }
+
+        // Top-N without a threshold skips frames below the Nth peak; compare
+        // with the peaks computed from the generations themselves.
+        query.metric = rvrse::core::HistoryMetric::WorkingSetBytes;
+        query.limit = 5;
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> expected;
+        for (std::size_t t = 0; t < kFrames; ++t)
+        {
+            for (const auto &process : MakeHistoryGeneration(t))
+            {
+                auto found = std::find_if(expected.begin(), expected.end(), [&process](const auto &entry)
+                                          { return entry.second == process.processId; });
+                if (found == expected.end())
+                {
+                    expected.emplace_back(process.workingSetBytes, process.processId);
+                }
+                else
+                {
+                    found->first = std::max(found->first, process.workingSetBytes);
+                }
+            }
+        }
+        std::sort(expected.begin(), expected.end(), [](const auto &lhs, const auto &rhs)
+                  { return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second; });
+        expected.resize(query.limit);
+
+        const bool peaksRead = reader.Peaks(query, peaks, error);
+        if (!peaksRead || peaks.size() != expected.size() ||
+            !std::equal(peaks.begin(), peaks.end(), expected.begin(), expected.end(), [](const rvrse::core::HistoryPeak &peak, const auto &entry)
+                        { return peak.processId == entry.second && peak.value == static_cast<double>(entry.first); }))
+        {
+            ReportFailure(L"History top-N peaks differ from a full scan.");
+        }
+
+        query.fromMs = query.toMs + 1;
+        if (reader.Series(query, series, error))
+        {
+            ReportFailure(L"History query accepted a window that ends before it starts.");
+        }
+    }
+
+    void BenchmarkHistoryQuery()
+    {
+        constexpr std::size_t kProcesses = 2000;
+        constexpr std::size_t kFrames = 3600;
+        constexpr std::int64_t kStartMs = 1767225600000LL;
+        const auto directory = MakeTestLogDirectory(L"history-benchmark");
+
+        // An hour at 1 s: every second a few dozen processes use CPU and a
+        // few dozen change their working set; one process starts and one
+        // exits every minute, and one balloons to 4 GB for half a minute.
+        auto base = MakeSyntheticProcesses(kProcesses);
+        const auto generate = [&base](std::size_t t)
+        {
+            auto processes = base;
+            for (std::size_t busy = 0; busy < 40; ++busy)
+            {
+                auto &process = processes[(t * 37 + busy * 53) % kProcesses];
+                process.userTime100ns += t * 100'000 * (busy + 1);
+                process.workingSetBytes += (t % 7) * 4096;
+            }
+            if (t >= 1800 && t < 1830)
+            {
+                processes[500].workingSetBytes = 4096ULL * 1024ULL * 1024ULL;
+            }
+            const std::size_t minute = t / 60;
+            processes.erase(processes.begin() + static_cast<std::ptrdiff_t>(minute % kProcesses));
+            rvrse::core::ProcessEntry started = base[minute % kProcesses];
+            started.processId = static_cast<std::uint32_t>(100'000 + minute);
+            processes.push_back(started);
+            return processes;
+        };
+
+        std::uint64_t bytesWritten = 0;
+        if (!RecordHistory(directory, kStartMs, 0, kFrames, 60, generate, &bytesWritten))
+        {
+            ReportFailure(L"History benchmark recording failed.");
+            return;
+        }
+
+        rvrse::core::HistoryReader reader(directory.wstring());
+        rvrse::core::HistoryQuery query;
+        query.fromMs = kStartMs;
+        query.toMs = kStartMs + static_cast<std::int64_t>(kFrames) * 1000;
+        query.process = L"400";
+        std::vector<rvrse::core::HistorySeries> series;
+        std::vector<rvrse::core::HistoryPeak> peaks;
+        std::wstring error;
+        bool succeeded = true;
+
+        const int iterations = 5;
+        const double seriesMs = MeasureAverageMilliseconds(
+            [&]()
+            { succeeded = reader.Series(query, series, error) && succeeded; },
+            iterations);
+        const auto seriesStats = reader.Stats();
+
+        query.process.clear();
+        query.over = 2048.0 * 1024.0 * 1024.0;
+        const double peaksMs = MeasureAverageMilliseconds(
+            [&]()
+            { succeeded = reader.Peaks(query, peaks, error) && succeeded; },
+            iterations);
+        const auto peaksStats = reader.Stats();
+        const std::size_t peaksFound = peaks.size();
+
+        // Reading every frame, for comparison.
+        query.over = 0.0;
+        query.limit = 0;
+        query.metric = rvrse::core::HistoryMetric::WorkingSetBytes;
+        const double fullScanMs = MeasureAverageMilliseconds(
+            [&]()
+            { succeeded = reader.Peaks(query, peaks, error) && succeeded; },
+            1);
+
+        std::fwprintf(stdout,
+                      L"[PERF] History query avg: %.3f ms series by PID (%llu of %zu frames read), %.3f ms peaks over "
+                      L"threshold (%llu read), %.1f ms full scan; %zu processes, %ls per hour, ~%.2f s per day of 1 s data\n",
+                      seriesMs,
+                      static_cast<unsigned long long>(seriesStats.framesRead),
+                      kFrames,
+                      peaksMs,
+                      static_cast<unsigned long long>(peaksStats.framesRead),
+                      fullScanMs,
+                      kProcesses,
+                      rvrse::common::FormatSize(bytesWritten).c_str(),
+                      seriesMs * 24.0 / 1000.0);
+
+        // A day is 24 of these hours: seconds, not minutes.
+        const double thresholdMs = 50.0;
+        const bool passed = succeeded && seriesMs <= thresholdMs && peaksMs <= thresholdMs && series.size() == 1 && peaksFound == 1 &&
+                            seriesStats.framesRead < kFrames / 5 && peaksStats.framesRead < kFrames / 5;
+        if (!passed)
+        {
+            ReportFailure(L"History query performance regression detected.");
+        }
+
+        RecordBenchmarkResult(L"HistoryQuery",
+                              seriesMs,
+                              thresholdMs,
+                              iterations,
+                              passed);
     }
 }
 
@@ -807,17 +6061,69 @@ int wmain(int argc, wchar_t **argv)
     TestFormatSize();
     TestFormatSizeMaxValues();
     TestStringHelpers();
+    TestUtfTranscoding();
     TestTimeFormatting();
+    BenchmarkFormatting();
     TestProcessSnapshot();
     TestProcessSnapshotEdgeCases();
+#if defined(__linux__)
+    TestProcStatParsing();
+#endif
+    TestProcessSnapshotGenerations();
+    TestSnapshotHandles();
+    TestRowChangeTracking();
     TestHandleSnapshot();
     TestHandleSnapshotAccessDenied();
     BenchmarkProcessSnapshot();
     BenchmarkHandleSnapshot();
     BenchmarkNetworkSnapshot();
     BenchmarkUtf8Conversion();
+    BenchmarkUtfTranscoding();
     TestPluginLoaderInitialization();
+    TestPluginLoaderParallelLoad();
+    TestDynamicLibrary();
+    TestMetricsRegistry();
+    BenchmarkMetricsRegistry();
+    TestSnapshotRing();
+    BenchmarkSnapshotRingPublish();
+    TestLogWriter();
+    BenchmarkLogWriter();
+    TestSystemMetricsSampler();
     TestNetworkSnapshot();
+    TestConnectionEntry();
+    BenchmarkConnectionTable();
+    TestCollectorConfig();
+    TestSelfUsageSampler();
+    TestCollector();
+    TestOpenMetricsExporter();
+    BenchmarkOpenMetricsRender();
+    TestJsonWriter();
+    TestNdjsonExporter();
+    BenchmarkNdjsonExport();
+    TestWireProtocol();
+    TestWireExporter();
+    BenchmarkWireProtocol();
+    TestFleetIndex();
+    TestFleetAggregator();
+    BenchmarkFleetQuery();
+    TestProcessView();
+    TestNameMatcher();
+    BenchmarkNameMatcher();
+    TestProcessQuery();
+    BenchmarkProcessQuery();
+    TestProcessOrder();
+    BenchmarkProcessOrder();
+    TestProcessColumns();
+    BenchmarkProcessColumns();
+    TestColumnReduce();
+    BenchmarkColumnReduce();
+    TestStringInterner();
+    BenchmarkStringInterner();
+    BenchmarkSnapshotTextBytes();
+    TestTerminalScreen();
+    BenchmarkTopRefresh();
+    TestHistoryStore();
+    BenchmarkHistoryQuery();
     TestDriverInterface();
 
     ExportBenchmarkTelemetry();
@@ -0,0 +1,112 @@
+// Fixture plugin for TestPluginLoaderParallelLoad. The test loads several
+// copies of this library under different file names; each copy behaves
+// according to its own name:
+//   - every copy counts itself in plugin.test_plugin.attempts;
+//   - a copy whose name contains "fail" then fails initialization;
+//   - the rest count themselves in plugin.test_plugin.initialized and write
+//     their name to the host log on every process snapshot, so the log
+//     records the order the loader calls its plugins in.
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include "rvrse/plugin_api.h"
+
+namespace
+{
+    // Long enough that initializing the copies one after another is
+    // measurably slower than initializing them in parallel.
+    constexpr std::chrono::milliseconds kInitializeDelay{100};
+
+    const RvrseHostServices *g_hostServices = nullptr;
+    std::wstring g_name;
+
+    std::wstring ModuleStem()
+    {
+#if defined(_WIN32)
+        wchar_t modulePath[MAX_PATH] = {0};
+        HMODULE module = nullptr;
+        if (!GetModuleHandleExW(
+                GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                reinterpret_cast<LPCWSTR>(&ModuleStem),
+                &module))
+        {
+            return {};
+        }
+
+        GetModuleFileNameW(module, modulePath, static_cast<DWORD>(std::size(modulePath)));
+        return std::filesystem::path(modulePath).stem().wstring();
+#else
+        Dl_info info{};
+        if (!dladdr(reinterpret_cast<void *>(&ModuleStem), &info) || !info.dli_fname)
+        {
+            return {};
+        }
+
+        return std::filesystem::path(info.dli_fname).stem().wstring();
+#endif
+    }
+
+    void OnProcessSnapshot(const RvrseProcessSnapshotView *, void *)
+    {
+        g_hostServices->WriteLog(g_hostServices->hostContext, RVRSE_LOG_INFO, g_name.c_str());
+    }
+}
+
+RVRSE_PLUGIN_EXPORT bool RvrsePluginInitialize(const RvrseHostServices *hostServices,
+                                               RvrsePluginInfo *outInfo,
+                                               RvrsePluginHooks *outHooks)
+{
+    if (!hostServices || !outInfo || !outHooks || hostServices->apiMinor < 3 || !hostServices->RegisterMetric ||
+        !hostServices->WriteLog)
+    {
+        return false;
+    }
+
+    g_hostServices = hostServices;
+    g_name = ModuleStem();
+
+    std::this_thread::sleep_for(kInitializeDelay);
+    hostServices->AddToCounter(hostServices->hostContext,
+                               hostServices->RegisterMetric(hostServices->hostContext,
+                                                            L"plugin.test_plugin.attempts",
+                                                            RVRSE_METRIC_COUNTER),
+                               1);
+    if (g_name.find(L"fail") != std::wstring::npos)
+    {
+        return false;
+    }
+
+    hostServices->AddToCounter(hostServices->hostContext,
+                               hostServices->RegisterMetric(hostServices->hostContext,
+                                                            L"plugin.test_plugin.initialized",
+                                                            RVRSE_METRIC_COUNTER),
+                               1);
+
+    static const wchar_t kAuthor[] = L"Rvrse Monitor";
+    static const wchar_t kVersion[] = L"1.0.0";
+
+    outInfo->name = g_name.c_str();
+    outInfo->author = kAuthor;
+    outInfo->version = kVersion;
+    outInfo->apiMajor = RVRSE_PLUGIN_API_VERSION_MAJOR;
+    outInfo->apiMinor = RVRSE_PLUGIN_API_VERSION_MINOR;
+
+    outHooks->OnProcessSnapshot = &OnProcessSnapshot;
+    outHooks->context = nullptr;
+    return true;
+}
+
+RVRSE_PLUGIN_EXPORT void RvrsePluginShutdown()
+{
+}